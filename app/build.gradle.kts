@@ -36,6 +36,10 @@ android {
     buildFeatures {
         prefab = true
     }
+    androidResources {
+        // 烘焙网格和KTX2纹理直接从APK中映射，不能压缩
+        noCompress += listOf("bmesh", "ktx2")
+    }
     externalNativeBuild {
         cmake {
             path = file("src/main/cpp/CMakeLists.txt")
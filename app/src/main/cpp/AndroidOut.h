@@ -1,11 +1,13 @@
 #ifndef ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
 #define ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
 
-#include <android/log.h>
 #include <sstream>
 
+#include "Log.h"
+
 /*!
  * 使用这个类将字符串记录到logcat中。注意，你应该使用std::endl来提交行。
+ * 新代码请使用Log.h中的LOGx宏，这个流只为兼容保留，提交的内容同样经由 @a Logger 异步输出。
  *
  * 示例：
  *  aout << "Hello World" << std::endl;
@@ -24,9 +26,9 @@ public:
     inline AndroidOut(const char *kLogTag) : logTag_(kLogTag) {}
 
 protected:
-    // 当同步输出流时，将字符串内容打印到logcat，并清空字符串缓冲
+    // 当同步输出流时，将字符串内容交给异步日志系统，并清空字符串缓冲
     virtual int sync() override {
-        __android_log_print(ANDROID_LOG_DEBUG, logTag_, "%s", str().c_str());
+        Logger::instance().writeMessage(LogLevel::Debug, logTag_, str().c_str());
         str("");
         return 0;
     }
@@ -0,0 +1,135 @@
+#include "AssetLoader.h"
+
+#include <chrono>
+
+namespace {
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+AssetLoader::AssetLoader(size_t threadCount) {
+    if (threadCount == 0) {
+        unsigned cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores - 1 : 1;
+    }
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    stop();
+}
+
+void AssetLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    jobAvailable_.notify_all();
+    for (auto &worker: workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    UploadNode *node = uploadHead_.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        UploadNode *next = node->next;
+        delete node;
+        node = next;
+    }
+    for (UploadNode *ready: readyUploads_) {
+        delete ready;
+    }
+    readyUploads_.clear();
+    // 丢弃的任务不再计入
+    pending_.store(0, std::memory_order_release);
+}
+
+void AssetLoader::submit(LoadJob job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        jobs_.push_back(std::move(job));
+    }
+    jobAvailable_.notify_one();
+}
+
+void AssetLoader::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        jobAvailable_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        LoadJob job = std::move(jobs_.front());
+        jobs_.pop_front();
+        activeJobs_++;
+        lock.unlock();
+
+        UploadTask upload = job();
+        if (upload) {
+            pushUpload(new UploadNode{std::move(upload), nullptr});
+        } else {
+            pending_.fetch_sub(1, std::memory_order_release);
+        }
+
+        lock.lock();
+        activeJobs_--;
+        if (jobs_.empty() && activeJobs_ == 0) {
+            loadsDone_.notify_all();
+        }
+    }
+}
+
+void AssetLoader::pushUpload(UploadNode *node) {
+    node->next = uploadHead_.load(std::memory_order_relaxed);
+    while (!uploadHead_.compare_exchange_weak(node->next, node,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+}
+
+size_t AssetLoader::pumpUploads(uint64_t budgetNs) {
+    // 栈里是后完成的在前，反转后接到已有任务的后面
+    UploadNode *node = uploadHead_.exchange(nullptr, std::memory_order_acquire);
+    UploadNode *reversed = nullptr;
+    while (node) {
+        UploadNode *next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+    for (; reversed; reversed = reversed->next) {
+        readyUploads_.push_back(reversed);
+    }
+    if (readyUploads_.empty()) {
+        return 0;
+    }
+
+    uint64_t start = nowNs();
+    size_t executed = 0;
+    do {
+        UploadNode *ready = readyUploads_.front();
+        readyUploads_.pop_front();
+        ready->task();
+        delete ready;
+        executed++;
+        pending_.fetch_sub(1, std::memory_order_release);
+    } while (!readyUploads_.empty() && nowNs() - start < budgetNs);
+    return executed;
+}
+
+void AssetLoader::waitForLoads() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    loadsDone_.wait(lock, [this] { return jobs_.empty() && activeJobs_ == 0; });
+}
@@ -0,0 +1,93 @@
+#ifndef ANDROIDGLINVESTIGATIONS_ASSETLOADER_H
+#define ANDROIDGLINVESTIGATIONS_ASSETLOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * 异步资源加载。
+ *
+ * 文件读取和解码在工作线程池中执行，不接触GL上下文。加载完成后产生的上传任务经无锁队列交给GL线程，
+ * GL线程每帧调用 @a pumpUploads 在时间预算内执行，避免一次加载大量资源时卡住一帧。
+ * 本身不依赖GL，上传任务做什么由调用方决定，主机上可以用桩实现测试。
+ */
+class AssetLoader {
+public:
+    //! 在GL线程执行的上传任务
+    using UploadTask = std::function<void()>;
+
+    //! 在工作线程执行的加载任务，返回空的UploadTask表示失败或不需要上传
+    using LoadJob = std::function<UploadTask()>;
+
+    /*!
+     * @param threadCount 工作线程数，0表示CPU核数减一（给GL线程留一个核），至少为1
+     */
+    explicit AssetLoader(size_t threadCount = 0);
+
+    //! 与 stop 相同
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader &) = delete;
+    AssetLoader &operator=(const AssetLoader &) = delete;
+
+    //! 提交一个加载任务，可以在任意线程调用
+    void submit(LoadJob job);
+
+    /*!
+     * 在GL线程调用，按提交完成的顺序执行上传任务，直到队列为空或用时超过预算。
+     * 只要有任务就至少执行一个，保证单个任务超出预算时也能推进
+     * @param budgetNs 本次调用的时间预算（纳秒）
+     * @return 执行的上传任务数
+     */
+    size_t pumpUploads(uint64_t budgetNs);
+
+    /*!
+     * @return 已提交但还没有完成的任务数，包括等待上传的任务。加载失败的任务在工作线程中就算完成
+     */
+    inline size_t pendingCount() const { return pending_.load(std::memory_order_acquire); }
+
+    //! 阻塞直到所有已提交的加载任务在工作线程中执行完毕，不等待上传
+    void waitForLoads();
+
+    inline size_t threadCount() const { return workers_.size(); }
+
+    /*!
+     * 丢弃还没开始的加载任务并等待进行中的任务结束。还没执行的上传任务直接销毁，不会被调用。
+     * 之后提交的任务直接丢弃，重复调用没有作用
+     */
+    void stop();
+
+private:
+    // 上传队列的节点，工作线程压入，GL线程一次取走全部
+    struct UploadNode {
+        UploadTask task;
+        UploadNode *next = nullptr;
+    };
+
+    void workerLoop();
+
+    // 多生产者/单消费者的无锁栈：push用CAS，消费者用exchange整体取走后反转成FIFO。
+    // 消费者从不单独弹出节点，所以没有ABA问题
+    void pushUpload(UploadNode *node);
+
+    std::mutex mutex_; // 保护jobs_、activeJobs_和stopping_
+    std::condition_variable jobAvailable_;
+    std::condition_variable loadsDone_;
+    std::deque<LoadJob> jobs_;
+    size_t activeJobs_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    std::atomic<UploadNode *> uploadHead_{nullptr};
+    std::deque<UploadNode *> readyUploads_; // 已经从无锁栈取出、按顺序等待执行的任务，只由GL线程访问
+    std::atomic<size_t> pending_{0};
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_ASSETLOADER_H
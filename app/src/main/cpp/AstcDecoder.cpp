@@ -0,0 +1,735 @@
+#include "AstcDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int kMaxWeights = 64;
+constexpr int kMaxColorValues = 18;
+
+// 整数序列编码的取值范围，下标就是规范中的量化等级
+struct IseRange {
+    int levels;
+    int trits;
+    int quints;
+    int bits;
+};
+
+const IseRange kRanges[] = {
+        {2, 0, 0, 1}, {3, 1, 0, 0}, {4, 0, 0, 2}, {5, 0, 1, 0}, {6, 1, 0, 1}, {8, 0, 0, 3},
+        {10, 0, 1, 1}, {12, 1, 0, 2}, {16, 0, 0, 4}, {20, 0, 1, 2}, {24, 1, 0, 3}, {32, 0, 0, 5},
+        {40, 0, 1, 3}, {48, 1, 0, 4}, {64, 0, 0, 6}, {80, 0, 1, 4}, {96, 1, 0, 5}, {128, 0, 0, 7},
+        {160, 0, 1, 5}, {192, 1, 0, 6}, {256, 0, 0, 8}};
+
+constexpr int kRangeCount = int(sizeof(kRanges) / sizeof(kRanges[0]));
+constexpr int kMinColorRange = 4; // 端点至少要能表示0..5
+
+int iseBitCount(const IseRange &range, int count) {
+    return range.bits * count + (range.trits ? (8 * count + 4) / 5 : 0) + (range.quints ? (7 * count + 2) / 3 : 0);
+}
+
+// 5个三进制数打包成8位、3个五进制数打包成7位的解码表，按规范的算法生成
+struct PackedTables {
+    uint8_t trits[256][5];
+    uint8_t quints[128][3];
+};
+
+inline int bit(int value, int index) { return (value >> index) & 1; }
+
+const PackedTables &packedTables() {
+    static const PackedTables tables = [] {
+        PackedTables t{};
+        for (int T = 0; T < 256; T++) {
+            int C;
+            int t4, t3, t2, t1, t0;
+            if (((T >> 2) & 7) == 7) {
+                C = ((T >> 5) & 7) << 2 | (T & 3);
+                t4 = 2;
+                t3 = 2;
+            } else {
+                C = T & 0x1F;
+                if (((T >> 5) & 3) == 3) {
+                    t4 = 2;
+                    t3 = bit(T, 7);
+                } else {
+                    t4 = bit(T, 7);
+                    t3 = (T >> 5) & 3;
+                }
+            }
+            if ((C & 3) == 3) {
+                t2 = 2;
+                t1 = bit(C, 4);
+                t0 = bit(C, 3) << 1 | (bit(C, 2) & ~bit(C, 3) & 1);
+            } else if (((C >> 2) & 3) == 3) {
+                t2 = 2;
+                t1 = 2;
+                t0 = C & 3;
+            } else {
+                t2 = bit(C, 4);
+                t1 = (C >> 2) & 3;
+                t0 = bit(C, 1) << 1 | (bit(C, 0) & ~bit(C, 1) & 1);
+            }
+            uint8_t *out = t.trits[T];
+            out[0] = uint8_t(t0);
+            out[1] = uint8_t(t1);
+            out[2] = uint8_t(t2);
+            out[3] = uint8_t(t3);
+            out[4] = uint8_t(t4);
+        }
+        for (int Q = 0; Q < 128; Q++) {
+            int q2, q1, q0;
+            if (((Q >> 1) & 3) == 3 && ((Q >> 5) & 3) == 0) {
+                q2 = bit(Q, 0) << 2 | (bit(Q, 4) & ~bit(Q, 0) & 1) << 1 | (bit(Q, 3) & ~bit(Q, 0) & 1);
+                q1 = 4;
+                q0 = 4;
+            } else {
+                int C;
+                if (((Q >> 1) & 3) == 3) {
+                    q2 = 4;
+                    C = ((Q >> 3) & 3) << 3 | (~(Q >> 5) & 3) << 1 | bit(Q, 0);
+                } else {
+                    q2 = (Q >> 5) & 3;
+                    C = Q & 0x1F;
+                }
+                if ((C & 7) == 5) {
+                    q1 = 4;
+                    q0 = (C >> 3) & 3;
+                } else {
+                    q1 = (C >> 3) & 3;
+                    q0 = C & 7;
+                }
+            }
+            uint8_t *out = t.quints[Q];
+            out[0] = uint8_t(q0);
+            out[1] = uint8_t(q1);
+            out[2] = uint8_t(q2);
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// 按小端位序读取，超出[0, end)的位读作0，截断的最后一组按规范相当于补0
+class BitReader {
+public:
+    BitReader(const uint8_t *data, int offset, int end) : data_(data), position_(offset), end_(end) {}
+
+    int read(int count) {
+        int available = std::min(count, end_ - position_);
+        if (available <= 0) {
+            position_ += count;
+            return 0;
+        }
+        // 一次最多读16位，跨越的字节不超过3个，也不会越过块的末尾
+        int first = position_ >> 3;
+        int last = (position_ + available - 1) >> 3;
+        uint32_t word = 0;
+        for (int i = first; i <= last; i++) {
+            word |= uint32_t(data_[i]) << ((i - first) * 8);
+        }
+        int value = int((word >> (position_ & 7)) & ((1u << available) - 1));
+        position_ += count;
+        return value;
+    }
+
+private:
+    const uint8_t *data_;
+    int position_;
+    int end_;
+};
+
+/*!
+ * 解码整数序列
+ * @param values 输出count个值，每个值的低位是直接存放的位，trit/quint在高位的“D”中
+ * @param digits 输出每个值的trit或quint
+ */
+void decodeIse(const IseRange &range, const uint8_t *data, int offset, int count, int *values, int *digits) {
+    const PackedTables &tables = packedTables();
+    BitReader reader(data, offset, offset + iseBitCount(range, count));
+    int n = range.bits;
+    if (range.trits) {
+        static const int kTritBits[5] = {2, 2, 1, 2, 1};
+        for (int group = 0; group < count; group += 5) {
+            int packed = 0;
+            int m[5];
+            for (int i = 0, shift = 0; i < 5; i++) {
+                m[i] = reader.read(n);
+                packed |= reader.read(kTritBits[i]) << shift;
+                shift += kTritBits[i];
+            }
+            for (int i = 0; i < 5 && group + i < count; i++) {
+                values[group + i] = m[i];
+                digits[group + i] = tables.trits[packed][i];
+            }
+        }
+    } else if (range.quints) {
+        static const int kQuintBits[3] = {3, 2, 2};
+        for (int group = 0; group < count; group += 3) {
+            int packed = 0;
+            int m[3];
+            for (int i = 0, shift = 0; i < 3; i++) {
+                m[i] = reader.read(n);
+                packed |= reader.read(kQuintBits[i]) << shift;
+                shift += kQuintBits[i];
+            }
+            for (int i = 0; i < 3 && group + i < count; i++) {
+                values[group + i] = m[i];
+                digits[group + i] = tables.quints[packed][i];
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            values[i] = reader.read(n);
+            digits[i] = 0;
+        }
+    }
+}
+
+// 按模式串生成反量化公式中的B，字母a..f依次是值的第0..5位，'0'是0，最左边是最高位
+int patternBits(const char *pattern, int value) {
+    int result = 0;
+    for (const char *p = pattern; *p; p++) {
+        result = (result << 1) | (*p == '0' ? 0 : bit(value, *p - 'a'));
+    }
+    return result;
+}
+
+// 位复制：把n位的值扩展到targetBits位
+int replicate(int value, int n, int targetBits) {
+    int result = 0;
+    int filled = 0;
+    while (filled < targetBits) {
+        int shift = targetBits - filled - n;
+        result |= shift >= 0 ? value << shift : value >> -shift;
+        filled += n;
+    }
+    return result;
+}
+
+//! 端点值反量化到0..255
+int unquantizeColor(const IseRange &range, int value, int digit) {
+    if (!range.trits && !range.quints) {
+        return replicate(value, range.bits, 8);
+    }
+    const char *pattern;
+    int C;
+    if (range.trits) {
+        static const char *kPatterns[] = {"", "000000000", "b000b0bb0", "cb000cbcb", "dcb000dcb", "edcb000ed",
+                                          "fedcb000f"};
+        static const int kC[] = {0, 204, 93, 44, 22, 11, 5};
+        pattern = kPatterns[range.bits];
+        C = kC[range.bits];
+    } else {
+        static const char *kPatterns[] = {"", "000000000", "b0000bb00", "cb0000cbc", "dcb0000dc", "edcb0000e"};
+        static const int kC[] = {0, 113, 54, 26, 13, 6};
+        pattern = kPatterns[range.bits];
+        C = kC[range.bits];
+    }
+    int A = bit(value, 0) ? 0x1FF : 0;
+    int T = digit * C + patternBits(pattern, value);
+    T ^= A;
+    return (A & 0x80) | (T >> 2);
+}
+
+//! 权重反量化到0..64
+int unquantizeWeight(const IseRange &range, int value, int digit) {
+    int result;
+    if (!range.trits && !range.quints) {
+        result = replicate(value, range.bits, 6);
+    } else if (range.bits == 0) {
+        // 只有三进制或五进制位时直接查表
+        static const int kTrits[3] = {0, 32, 63};
+        static const int kQuints[5] = {0, 16, 32, 47, 63};
+        result = range.trits ? kTrits[digit] : kQuints[digit];
+    } else {
+        const char *pattern;
+        int C;
+        if (range.trits) {
+            static const char *kPatterns[] = {"", "0000000", "b000b0b", "cb000cb"};
+            static const int kC[] = {0, 50, 23, 11};
+            pattern = kPatterns[range.bits];
+            C = kC[range.bits];
+        } else {
+            static const char *kPatterns[] = {"", "0000000", "b0000b0"};
+            static const int kC[] = {0, 28, 13};
+            pattern = kPatterns[range.bits];
+            C = kC[range.bits];
+        }
+        int A = bit(value, 0) ? 0x7F : 0;
+        int T = digit * C + patternBits(pattern, value);
+        T ^= A;
+        result = (A & 0x20) | (T >> 2);
+    }
+    return result > 32 ? result + 1 : result;
+}
+
+struct BlockMode {
+    int gridWidth;
+    int gridHeight;
+    bool dualPlane;
+    int weightRange; // kRanges的下标
+};
+
+bool decodeBlockMode(int mode, BlockMode &out) {
+    int R;
+    int A = (mode >> 5) & 3;
+    int B = (mode >> 7) & 3;
+    bool highPrecision = bit(mode, 9);
+    bool dualPlane = bit(mode, 10);
+    if ((mode & 3) != 0) {
+        R = (mode & 3) << 1 | bit(mode, 4);
+        switch ((mode >> 2) & 3) {
+            case 0:
+                out.gridWidth = B + 4;
+                out.gridHeight = A + 2;
+                break;
+            case 1:
+                out.gridWidth = B + 8;
+                out.gridHeight = A + 2;
+                break;
+            case 2:
+                out.gridWidth = A + 2;
+                out.gridHeight = B + 8;
+                break;
+            default:
+                if (bit(mode, 8)) {
+                    out.gridWidth = bit(mode, 7) + 2;
+                    out.gridHeight = A + 2;
+                } else {
+                    out.gridWidth = A + 2;
+                    out.gridHeight = bit(mode, 7) + 6;
+                }
+                break;
+        }
+    } else {
+        R = ((mode >> 2) & 3) << 1 | bit(mode, 4);
+        if (((mode >> 2) & 3) == 0) {
+            return false;
+        }
+        switch ((mode >> 7) & 3) {
+            case 0:
+                out.gridWidth = 12;
+                out.gridHeight = A + 2;
+                break;
+            case 1:
+                out.gridWidth = A + 2;
+                out.gridHeight = 12;
+                break;
+            case 2:
+                out.gridWidth = A + 6;
+                out.gridHeight = ((mode >> 9) & 3) + 6;
+                highPrecision = false;
+                dualPlane = false;
+                break;
+            default:
+                if (A == 0) {
+                    out.gridWidth = 6;
+                    out.gridHeight = 10;
+                } else if (A == 1) {
+                    out.gridWidth = 10;
+                    out.gridHeight = 6;
+                } else {
+                    return false;
+                }
+                break;
+        }
+    }
+    // R为2..7，低精度对应2..8个等级，高精度对应10..32个等级
+    static const int kLow[6] = {0, 1, 2, 3, 4, 5};
+    static const int kHigh[6] = {6, 7, 8, 9, 10, 11};
+    out.weightRange = highPrecision ? kHigh[R - 2] : kLow[R - 2];
+    out.dualPlane = dualPlane;
+    return true;
+}
+
+uint32_t hash52(uint32_t p) {
+    p ^= p >> 15;
+    p -= p << 17;
+    p += p << 7;
+    p += p << 4;
+    p ^= p >> 5;
+    p += p << 16;
+    p ^= p >> 7;
+    p ^= p >> 3;
+    p ^= p << 6;
+    p ^= p >> 17;
+    return p;
+}
+
+int selectPartition(int seed, int x, int y, int partitionCount, bool smallBlock) {
+    if (smallBlock) {
+        x <<= 1;
+        y <<= 1;
+    }
+    seed += (partitionCount - 1) * 1024;
+    uint32_t rnum = hash52(uint32_t(seed));
+    int seeds[8];
+    for (int i = 0; i < 8; i++) {
+        int s = int((rnum >> (i * 4)) & 0xF);
+        seeds[i] = s * s;
+    }
+    int sh1, sh2;
+    if (seed & 1) {
+        sh1 = seed & 2 ? 4 : 5;
+        sh2 = partitionCount == 3 ? 6 : 5;
+    } else {
+        sh1 = partitionCount == 3 ? 6 : 5;
+        sh2 = seed & 2 ? 4 : 5;
+    }
+    for (int i = 0; i < 8; i++) {
+        seeds[i] >>= (i & 1) ? sh2 : sh1;
+    }
+    // 2D块的z为0，seed9..12不参与
+    int a = (seeds[0] * x + seeds[1] * y + int(rnum >> 14)) & 0x3F;
+    int b = (seeds[2] * x + seeds[3] * y + int(rnum >> 10)) & 0x3F;
+    int c = (seeds[4] * x + seeds[5] * y + int(rnum >> 6)) & 0x3F;
+    int d = (seeds[6] * x + seeds[7] * y + int(rnum >> 2)) & 0x3F;
+    if (partitionCount < 4) {
+        d = 0;
+    }
+    if (partitionCount < 3) {
+        c = 0;
+    }
+    if (a >= b && a >= c && a >= d) {
+        return 0;
+    }
+    if (b >= c && b >= d) {
+        return 1;
+    }
+    return c >= d ? 2 : 3;
+}
+
+inline int clamp255(int value) { return std::min(255, std::max(0, value)); }
+
+// base+offset模式中把v1的最高位转移给v0，v1成为-32..31的有符号偏移
+inline void bitTransferSigned(int &a, int &b) {
+    b >>= 1;
+    b |= a & 0x80;
+    a >>= 1;
+    a &= 0x3F;
+    if (a & 0x20) {
+        a -= 0x40;
+    }
+}
+
+inline void blueContract(int *color) {
+    color[0] = (color[0] + color[2]) >> 1;
+    color[1] = (color[1] + color[2]) >> 1;
+}
+
+/*!
+ * 解码一对LDR端点
+ * @return HDR模式返回false
+ */
+bool decodeEndpoints(int mode, const int *v, int *e0, int *e1) {
+    switch (mode) {
+        case 0:
+            e0[0] = e0[1] = e0[2] = v[0];
+            e1[0] = e1[1] = e1[2] = v[1];
+            e0[3] = e1[3] = 255;
+            return true;
+        case 1: {
+            int l0 = (v[0] >> 2) | (v[1] & 0xC0);
+            int l1 = std::min(l0 + (v[1] & 0x3F), 255);
+            e0[0] = e0[1] = e0[2] = l0;
+            e1[0] = e1[1] = e1[2] = l1;
+            e0[3] = e1[3] = 255;
+            return true;
+        }
+        case 4:
+            e0[0] = e0[1] = e0[2] = v[0];
+            e1[0] = e1[1] = e1[2] = v[1];
+            e0[3] = v[2];
+            e1[3] = v[3];
+            return true;
+        case 5: {
+            int v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+            bitTransferSigned(v1, v0);
+            bitTransferSigned(v3, v2);
+            e0[0] = e0[1] = e0[2] = v0;
+            e1[0] = e1[1] = e1[2] = clamp255(v0 + v1);
+            e0[3] = v2;
+            e1[3] = clamp255(v2 + v3);
+            return true;
+        }
+        case 6:
+            for (int c = 0; c < 3; c++) {
+                e0[c] = (v[c] * v[3]) >> 8;
+                e1[c] = v[c];
+            }
+            e0[3] = e1[3] = 255;
+            return true;
+        case 8:
+        case 12: {
+            bool alpha = mode == 12;
+            int s0 = v[0] + v[2] + v[4];
+            int s1 = v[1] + v[3] + v[5];
+            for (int c = 0; c < 3; c++) {
+                e0[c] = v[c * 2];
+                e1[c] = v[c * 2 + 1];
+            }
+            e0[3] = alpha ? v[6] : 255;
+            e1[3] = alpha ? v[7] : 255;
+            if (s1 < s0) {
+                std::swap_ranges(e0, e0 + 4, e1);
+                blueContract(e0);
+                blueContract(e1);
+            }
+            return true;
+        }
+        case 9:
+        case 13: {
+            bool alpha = mode == 13;
+            int values[8];
+            std::copy(v, v + (alpha ? 8 : 6), values);
+            if (!alpha) {
+                values[6] = 255;
+                values[7] = 0;
+            }
+            for (int c = 0; c < (alpha ? 4 : 3); c++) {
+                bitTransferSigned(values[c * 2 + 1], values[c * 2]);
+            }
+            int offsetSum = values[1] + values[3] + values[5];
+            for (int c = 0; c < 4; c++) {
+                e0[c] = values[c * 2];
+                e1[c] = values[c * 2] + values[c * 2 + 1];
+            }
+            if (offsetSum < 0) {
+                std::swap_ranges(e0, e0 + 4, e1);
+                blueContract(e0);
+                blueContract(e1);
+            }
+            for (int c = 0; c < 4; c++) {
+                e0[c] = clamp255(e0[c]);
+                e1[c] = clamp255(e1[c]);
+            }
+            return true;
+        }
+        case 10:
+            for (int c = 0; c < 3; c++) {
+                e0[c] = (v[c] * v[3]) >> 8;
+                e1[c] = v[c];
+            }
+            e0[3] = v[4];
+            e1[3] = v[5];
+            return true;
+        default:
+            return false; // HDR
+    }
+}
+
+void fillColor(uint8_t *rgba, size_t stride, int width, int height, const uint8_t color[4]) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            memcpy(rgba + y * stride + x * 4, color, 4);
+        }
+    }
+}
+
+bool decodeVoidExtent(const uint8_t *block, int width, int height, bool srgb, uint8_t *rgba, size_t stride) {
+    // 第9位是HDR标志，第10、11位必须为1
+    if (bit(block[1], 1) || ((block[1] >> 2) & 3) != 3) {
+        return false;
+    }
+    uint8_t color[4];
+    for (int c = 0; c < 4; c++) {
+        int value = block[8 + c * 2] | block[9 + c * 2] << 8;
+        color[c] = uint8_t(srgb ? value >> 8 : (value + 128) / 257);
+    }
+    fillColor(rgba, stride, width, height, color);
+    return true;
+}
+
+bool decodeBlockImpl(const uint8_t *block, int width, int height, bool srgb, uint8_t *rgba, size_t stride) {
+    BitReader header(block, 0, 128);
+    int mode = header.read(11);
+    if ((mode & 0x1FF) == 0x1FC) {
+        return decodeVoidExtent(block, width, height, srgb, rgba, stride);
+    }
+    BlockMode blockMode{};
+    if (!decodeBlockMode(mode, blockMode) || blockMode.gridWidth > width || blockMode.gridHeight > height) {
+        return false;
+    }
+    int partitionCount = header.read(2) + 1;
+    int planeCount = blockMode.dualPlane ? 2 : 1;
+    int weightCount = blockMode.gridWidth * blockMode.gridHeight * planeCount;
+    const IseRange &weightRange = kRanges[blockMode.weightRange];
+    int weightBits = iseBitCount(weightRange, weightCount);
+    if (weightCount > kMaxWeights || weightBits < 24 || weightBits > 96
+        || (partitionCount == 4 && blockMode.dualPlane)) {
+        return false;
+    }
+
+    int partitionSeed = 0;
+    int endpointModes[4];
+    int colorStart;
+    int extraCemBits = 0;
+    if (partitionCount == 1) {
+        endpointModes[0] = header.read(4);
+        colorStart = 17;
+    } else {
+        partitionSeed = header.read(10);
+        int cem = header.read(6);
+        colorStart = 29;
+        if ((cem & 3) == 0) {
+            for (int p = 0; p < partitionCount; p++) {
+                endpointModes[p] = cem >> 2;
+            }
+        } else {
+            // 各分区的模式不同：基础类别加上每个分区的1位C和2位M，放不下的位在权重下方
+            extraCemBits = 3 * partitionCount - 4;
+            BitReader extra(block, 128 - weightBits - extraCemBits, 128 - weightBits);
+            int encoded = cem | extra.read(extraCemBits) << 6;
+            int baseClass = (encoded & 3) - 1;
+            for (int p = 0; p < partitionCount; p++) {
+                int C = bit(encoded, 2 + p);
+                int M = (encoded >> (2 + partitionCount + 2 * p)) & 3;
+                endpointModes[p] = (baseClass + C) << 2 | M;
+            }
+        }
+    }
+    int planeSelectorStart = 128 - weightBits - extraCemBits - (blockMode.dualPlane ? 2 : 0);
+    int planeComponent = -1;
+    if (blockMode.dualPlane) {
+        planeComponent = BitReader(block, planeSelectorStart, 128).read(2);
+    }
+
+    int colorValueCount = 0;
+    for (int p = 0; p < partitionCount; p++) {
+        colorValueCount += ((endpointModes[p] >> 2) + 1) * 2;
+    }
+    int colorBits = planeSelectorStart - colorStart;
+    if (colorValueCount > kMaxColorValues || colorBits < 0) {
+        return false;
+    }
+    int colorRange = kRangeCount - 1;
+    while (colorRange >= 0 && iseBitCount(kRanges[colorRange], colorValueCount) > colorBits) {
+        colorRange--;
+    }
+    if (colorRange < kMinColorRange) {
+        return false;
+    }
+
+    int values[kMaxWeights];
+    int digits[kMaxWeights];
+    decodeIse(kRanges[colorRange], block, colorStart, colorValueCount, values, digits);
+    int colors[kMaxColorValues];
+    for (int i = 0; i < colorValueCount; i++) {
+        colors[i] = unquantizeColor(kRanges[colorRange], values[i], digits[i]);
+    }
+    int endpoints[4][2][4];
+    for (int p = 0, offset = 0; p < partitionCount; p++) {
+        if (!decodeEndpoints(endpointModes[p], colors + offset, endpoints[p][0], endpoints[p][1])) {
+            return false;
+        }
+        offset += ((endpointModes[p] >> 2) + 1) * 2;
+    }
+
+    // 权重从块的最高位开始逆序存放
+    uint8_t reversed[16];
+    for (int i = 0; i < 16; i++) {
+        uint8_t b = block[15 - i];
+        b = uint8_t((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+        b = uint8_t((b & 0xCC) >> 2 | (b & 0x33) << 2);
+        b = uint8_t((b & 0xAA) >> 1 | (b & 0x55) << 1);
+        reversed[i] = b;
+    }
+    decodeIse(weightRange, reversed, 0, weightCount, values, digits);
+    // 多留一行加一个，插值时越界的邻居权重为0
+    int grid[2][kMaxWeights + 16] = {};
+    for (int i = 0; i < weightCount; i++) {
+        grid[i % planeCount][i / planeCount] = unquantizeWeight(weightRange, values[i], digits[i]);
+    }
+
+    int gridWidth = blockMode.gridWidth;
+    int gridHeight = blockMode.gridHeight;
+    // 权重网格插值的坐标只与列或行有关，先按列和行算好
+    int ds = (1024 + width / 2) / (width - 1);
+    int dt = (1024 + height / 2) / (height - 1);
+    int columnIndex[12], columnFraction[12], rowIndex[12], rowFraction[12];
+    for (int x = 0; x < width; x++) {
+        int gs = (ds * x * (gridWidth - 1) + 32) >> 6;
+        columnIndex[x] = gs >> 4;
+        columnFraction[x] = gs & 0xF;
+    }
+    for (int y = 0; y < height; y++) {
+        int gt = (dt * y * (gridHeight - 1) + 32) >> 6;
+        rowIndex[y] = (gt >> 4) * gridWidth;
+        rowFraction[y] = gt & 0xF;
+    }
+    // 端点扩展到16位：sRGB格式的端点低8位补0x80，其他格式做位复制
+    int expanded[4][2][4];
+    for (int p = 0; p < partitionCount; p++) {
+        for (int e = 0; e < 2; e++) {
+            for (int c = 0; c < 4; c++) {
+                int value = endpoints[p][e][c];
+                expanded[p][e][c] = srgb ? value << 8 | 0x80 : value << 8 | value;
+            }
+        }
+    }
+    bool smallBlock = width * height < 31;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int fs = columnFraction[x];
+            int ft = rowFraction[y];
+            int w11 = (fs * ft + 8) >> 4;
+            int w10 = ft - w11;
+            int w01 = fs - w11;
+            int w00 = 16 - fs - ft + w11;
+            int index = columnIndex[x] + rowIndex[y];
+            int weights[2];
+            for (int plane = 0; plane < planeCount; plane++) {
+                const int *g = grid[plane];
+                weights[plane] = (g[index] * w00 + g[index + 1] * w01 + g[index + gridWidth] * w10
+                                  + g[index + gridWidth + 1] * w11 + 8) >> 4;
+            }
+
+            int partition = partitionCount > 1 ? selectPartition(partitionSeed, x, y, partitionCount, smallBlock) : 0;
+            const int (*e)[4] = expanded[partition];
+            uint8_t *out = rgba + y * stride + x * 4;
+            for (int c = 0; c < 4; c++) {
+                int w = c == planeComponent ? weights[1] : weights[0];
+                int value = (e[0][c] * (64 - w) + e[1][c] * w + 32) >> 6;
+                out[c] = uint8_t(srgb ? value >> 8 : (value + 128) / 257);
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool AstcDecoder::decodeBlock(const uint8_t *block, int blockWidth, int blockHeight, bool srgb, uint8_t *rgba,
+                              size_t stride) {
+    if (decodeBlockImpl(block, blockWidth, blockHeight, srgb, rgba, stride)) {
+        return true;
+    }
+    static const uint8_t kErrorColor[4] = {255, 0, 255, 255};
+    fillColor(rgba, stride, blockWidth, blockHeight, kErrorColor);
+    return false;
+}
+
+size_t AstcDecoder::decodeImage(const uint8_t *data, int32_t width, int32_t height, int blockWidth, int blockHeight,
+                                bool srgb, uint8_t *rgba) {
+    size_t stride = size_t(width) * 4;
+    size_t errors = 0;
+    uint8_t scratch[12 * 12 * 4];
+    for (int32_t by = 0; by < height; by += blockHeight) {
+        for (int32_t bx = 0; bx < width; bx += blockWidth, data += 16) {
+            bool whole = bx + blockWidth <= width && by + blockHeight <= height;
+            uint8_t *target = whole ? rgba + size_t(by) * stride + size_t(bx) * 4 : scratch;
+            size_t targetStride = whole ? stride : size_t(blockWidth) * 4;
+            errors += !decodeBlock(data, blockWidth, blockHeight, srgb, target, targetStride);
+            if (!whole) {
+                int32_t w = std::min(blockWidth, width - bx);
+                int32_t h = std::min(blockHeight, height - by);
+                for (int32_t y = 0; y < h; y++) {
+                    memcpy(rgba + size_t(by + y) * stride + size_t(bx) * 4, scratch + y * targetStride,
+                           size_t(w) * 4);
+                }
+            }
+        }
+    }
+    return errors;
+}
@@ -0,0 +1,35 @@
+#ifndef ANDROIDGLINVESTIGATIONS_ASTCDECODER_H
+#define ANDROIDGLINVESTIGATIONS_ASTCDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * ASTC LDR 2D块的CPU解码器，设备没有GL_KHR_texture_compression_astc_ldr时用来转换成RGBA8。
+ *
+ * 支持规范中LDR配置的全部内容：1到4个分区、双权重平面、所有LDR端点模式、
+ * 三进制/五进制的整数序列编码、权重网格插值以及常量色块（void extent）。
+ * HDR端点模式和非法的块解码为规范规定的错误颜色（品红）。
+ */
+class AstcDecoder {
+public:
+    /*!
+     * 解码一个16字节的块
+     * @param blockWidth, blockHeight 块的尺寸，4到12
+     * @param srgb 按sRGB格式解码：端点扩展到16位时低8位补0x80，输出取高8位
+     * @param rgba 块左上角像素
+     * @param stride 输出的行距（字节）
+     * @return 块非法或使用HDR时返回false，此时输出为错误颜色
+     */
+    static bool decodeBlock(const uint8_t *block, int blockWidth, int blockHeight, bool srgb, uint8_t *rgba,
+                            size_t stride);
+
+    /*!
+     * 解码整幅图像，右边和下边超出图像的像素被丢弃
+     * @return 非法块的个数
+     */
+    static size_t decodeImage(const uint8_t *data, int32_t width, int32_t height, int blockWidth, int blockHeight,
+                              bool srgb, uint8_t *rgba);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_ASTCDECODER_H
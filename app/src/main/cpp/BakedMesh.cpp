@@ -0,0 +1,400 @@
+#include "BakedMesh.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "Checksum.h"
+#include "Log.h"
+#include "MeshWelder.h"
+
+namespace {
+
+constexpr size_t kSectionAlignment = 16;
+constexpr size_t kMeshletCullingArrays = 8; // centerX/Y/Z、radius、axisX/Y/Z、cutoff
+
+inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline size_t paddedMeshletCount(size_t count) {
+    return alignUp(count, 4);
+}
+
+inline size_t indexSize(uint32_t indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+uint32_t headerChecksum(BakedMeshHeader header) {
+    header.headerChecksum = 0;
+    return Checksum::crc32(&header, sizeof(header));
+}
+
+template<typename T>
+void appendBytes(std::vector<uint8_t> &out, const T *data, size_t count) {
+    auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+}
+
+} // namespace
+
+void BakedMeshWriter::addMesh(BakedMeshInput mesh) {
+    meshes_.push_back(std::move(mesh));
+}
+
+std::vector<uint8_t> BakedMeshWriter::serialize() const {
+    // 先把每一节的数据准备好，最后统一排布偏移
+    std::vector<std::pair<BakedSectionType, std::vector<uint8_t>>> sections;
+    sections.emplace_back(BakedSectionType::Meshes, std::vector<uint8_t>());
+    sections.emplace_back(BakedSectionType::Lods, std::vector<uint8_t>());
+    sections.emplace_back(BakedSectionType::Strings, std::vector<uint8_t>());
+    auto addSection = [&](BakedSectionType type, std::vector<uint8_t> data) {
+        sections.emplace_back(type, std::move(data));
+        return uint32_t(sections.size() - 1);
+    };
+
+    std::vector<BakedMeshRecord> records;
+    std::vector<BakedLod> lods;
+    std::vector<uint8_t> strings;
+    for (const BakedMeshInput &mesh: meshes_) {
+        assert(!mesh.lods.empty());
+        BakedMeshRecord record = {};
+        record.nameOffset = uint32_t(strings.size());
+        record.nameLength = uint32_t(mesh.name.size());
+        appendBytes(strings, mesh.name.data(), mesh.name.size());
+        record.mode = mesh.mode;
+        record.vertexCount = uint32_t(mesh.vertices.vertexCount);
+        record.indexType = mesh.vertices.vertexCount <= MeshWelder::kMaxShortIndexVertices
+                           ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        record.positionFormat = uint8_t(mesh.vertices.layout.positionFormat);
+        record.uvFormat = uint8_t(mesh.vertices.layout.uvFormat);
+        record.colorFormat = uint8_t(mesh.vertices.layout.colorFormat);
+        record.baseColor = mesh.baseColor;
+        memcpy(record.positionScale, mesh.vertices.positionScale.idx, sizeof(record.positionScale));
+        memcpy(record.positionOffset, mesh.vertices.positionOffset.idx, sizeof(record.positionOffset));
+        const Vec3 &boundsMin = mesh.bounds.min;
+        const Vec3 &boundsMax = mesh.bounds.max;
+        record.boundsMin[0] = boundsMin.x;
+        record.boundsMin[1] = boundsMin.y;
+        record.boundsMin[2] = boundsMin.z;
+        record.boundsMax[0] = boundsMax.x;
+        record.boundsMax[1] = boundsMax.y;
+        record.boundsMax[2] = boundsMax.z;
+
+        record.vertexSection = addSection(BakedSectionType::Vertices, mesh.vertices.data);
+
+        // 所有层次的索引依次存放，已经转换成上传格式
+        std::vector<uint8_t> indexData;
+        record.firstLod = uint32_t(lods.size());
+        record.lodCount = uint32_t(mesh.lods.size());
+        for (const LodLevel &level: mesh.lods) {
+            BakedLod lod = {};
+            lod.indexOffset = record.indexCount;
+            lod.indexCount = uint32_t(level.indices.size());
+            lod.error = level.error;
+            lods.push_back(lod);
+            record.indexCount += lod.indexCount;
+            if (record.indexType == GL_UNSIGNED_SHORT) {
+                std::vector<uint16_t> shortIndices(level.indices.begin(), level.indices.end());
+                appendBytes(indexData, shortIndices.data(), shortIndices.size());
+            } else {
+                appendBytes(indexData, level.indices.data(), level.indices.size());
+            }
+        }
+        record.indexSection = addSection(BakedSectionType::Indices, std::move(indexData));
+
+        record.meshletSection = BakedMeshRecord::kNoSection;
+        record.meshletCullingSection = BakedMeshRecord::kNoSection;
+        const MeshletMesh &meshlets = mesh.meshlets;
+        if (!meshlets.meshlets.empty()) {
+            assert(meshlets.indices == mesh.lods[0].indices);
+            record.meshletCount = uint32_t(meshlets.meshlets.size());
+            std::vector<uint8_t> meshletData;
+            appendBytes(meshletData, meshlets.meshlets.data(), meshlets.meshlets.size());
+            record.meshletSection = addSection(BakedSectionType::Meshlets, std::move(meshletData));
+
+            std::vector<uint8_t> cullingData;
+            for (const std::vector<float> *array: {
+                    &meshlets.centerX, &meshlets.centerY, &meshlets.centerZ, &meshlets.radius,
+                    &meshlets.axisX, &meshlets.axisY, &meshlets.axisZ, &meshlets.cutoff}) {
+                assert(array->size() == paddedMeshletCount(meshlets.meshlets.size()));
+                appendBytes(cullingData, array->data(), array->size());
+            }
+            record.meshletCullingSection = addSection(BakedSectionType::MeshletCulling, std::move(cullingData));
+        }
+        records.push_back(record);
+    }
+    appendBytes(sections[0].second, records.data(), records.size());
+    appendBytes(sections[1].second, lods.data(), lods.size());
+    sections[2].second = std::move(strings);
+
+    // 排布：文件头、节表，然后是按16字节对齐的各节数据
+    BakedMeshHeader header = {};
+    header.magic = BakedMeshHeader::kMagic;
+    header.version = BakedMeshHeader::kVersion;
+    header.headerSize = sizeof(BakedMeshHeader);
+    header.sectionCount = uint32_t(sections.size());
+    std::vector<BakedSection> table(sections.size());
+    size_t offset = sizeof(BakedMeshHeader) + sizeof(BakedSection) * sections.size();
+    for (size_t i = 0; i < sections.size(); i++) {
+        const std::vector<uint8_t> &data = sections[i].second;
+        offset = alignUp(offset, kSectionAlignment);
+        table[i].type = uint32_t(sections[i].first);
+        table[i].checksum = Checksum::crc32(data.data(), data.size());
+        table[i].offset = offset;
+        table[i].size = data.size();
+        offset += data.size();
+    }
+    header.fileSize = offset;
+    header.tableChecksum = Checksum::crc32(table.data(), sizeof(BakedSection) * table.size());
+    header.headerChecksum = headerChecksum(header);
+
+    std::vector<uint8_t> file(offset, 0);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), table.data(), sizeof(BakedSection) * table.size());
+    for (size_t i = 0; i < sections.size(); i++) {
+        const std::vector<uint8_t> &data = sections[i].second;
+        if (!data.empty()) {
+            memcpy(file.data() + table[i].offset, data.data(), data.size());
+        }
+    }
+    return file;
+}
+
+bool BakedMeshWriter::write(const std::string &path) const {
+    std::vector<uint8_t> data = serialize();
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        LOGE("无法创建文件 %s", path.c_str());
+        return false;
+    }
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        LOGE("写入 %s 失败", path.c_str());
+    }
+    return written;
+}
+
+bool BakedMeshFile::open(const std::string &path, bool verifyData) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        return false;
+    }
+    file_ = std::move(file);
+    if (!validate(verifyData)) {
+        LOGE("%s 不是有效的烘焙网格文件", path.c_str());
+        file_.reset();
+        return false;
+    }
+    return true;
+}
+
+#ifdef __ANDROID__
+bool BakedMeshFile::openAsset(AAssetManager *assetManager, const std::string &assetPath, bool verifyData) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->openAsset(assetManager, assetPath)) {
+        return false;
+    }
+    file_ = std::move(file);
+    if (!validate(verifyData)) {
+        LOGE("%s 不是有效的烘焙网格文件", assetPath.c_str());
+        file_.reset();
+        return false;
+    }
+    return true;
+}
+#endif
+
+bool BakedMeshFile::validate(bool verifyData) {
+    const uint8_t *data = file_->data();
+    size_t size = file_->size();
+    sections_.clear();
+    records_ = nullptr;
+    meshCount_ = 0;
+    lods_ = nullptr;
+    lodCount_ = 0;
+    strings_ = nullptr;
+    stringsSize_ = 0;
+
+    // 记录和层次表直接在映射上访问，要求至少4字节对齐（APK中未压缩的资源按4字节对齐）
+    if (size < sizeof(BakedMeshHeader) || reinterpret_cast<uintptr_t>(data) % alignof(BakedMeshRecord) != 0) {
+        LOGE("文件太小或没有对齐");
+        return false;
+    }
+    BakedMeshHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != BakedMeshHeader::kMagic || header.version != BakedMeshHeader::kVersion
+        || header.headerSize != sizeof(BakedMeshHeader)) {
+        LOGE("文件头不匹配: magic %08x 版本 %u", header.magic, header.version);
+        return false;
+    }
+    if (header.fileSize != size || headerChecksum(header) != header.headerChecksum) {
+        LOGE("文件头校验失败或文件被截断");
+        return false;
+    }
+    if (header.sectionCount > (size - sizeof(BakedMeshHeader)) / sizeof(BakedSection)) {
+        LOGE("节表越界");
+        return false;
+    }
+    const uint8_t *table = data + sizeof(BakedMeshHeader);
+    size_t tableSize = sizeof(BakedSection) * header.sectionCount;
+    if (Checksum::crc32(table, tableSize) != header.tableChecksum) {
+        LOGE("节表校验失败");
+        return false;
+    }
+    sections_.resize(header.sectionCount);
+    memcpy(sections_.data(), table, tableSize);
+    size_t dataStart = sizeof(BakedMeshHeader) + tableSize;
+    for (size_t i = 0; i < sections_.size(); i++) {
+        const BakedSection &section = sections_[i];
+        if (section.offset % kSectionAlignment != 0 || section.offset < dataStart || section.offset > size
+            || section.size > size - section.offset) {
+            LOGE("节 %zu 越界", i);
+            return false;
+        }
+        if (verifyData && Checksum::crc32(data + section.offset, section.size) != section.checksum) {
+            LOGE("节 %zu 的数据校验失败", i);
+            return false;
+        }
+    }
+
+    const BakedSection *meshes = findSection(BakedSectionType::Meshes);
+    const BakedSection *lods = findSection(BakedSectionType::Lods);
+    if (!meshes || !lods || meshes->size % sizeof(BakedMeshRecord) != 0 || lods->size % sizeof(BakedLod) != 0) {
+        LOGE("缺少网格或层次表");
+        return false;
+    }
+    records_ = reinterpret_cast<const BakedMeshRecord *>(data + meshes->offset);
+    meshCount_ = meshes->size / sizeof(BakedMeshRecord);
+    lods_ = reinterpret_cast<const BakedLod *>(data + lods->offset);
+    lodCount_ = lods->size / sizeof(BakedLod);
+    if (const BakedSection *strings = findSection(BakedSectionType::Strings)) {
+        strings_ = reinterpret_cast<const char *>(data + strings->offset);
+        stringsSize_ = strings->size;
+    }
+
+    auto sectionMatches = [&](uint32_t section, BakedSectionType type, uint64_t expectedSize) {
+        return section < sections_.size() && sections_[section].type == uint32_t(type)
+               && sections_[section].size == expectedSize;
+    };
+    for (size_t i = 0; i < meshCount_; i++) {
+        const BakedMeshRecord &record = records_[i];
+        bool valid = record.positionFormat <= uint8_t(PositionFormat::Snorm16)
+                     && record.uvFormat <= uint8_t(UVFormat::Unorm16)
+                     && record.colorFormat <= uint8_t(ColorFormat::Rgba8)
+                     && record.mode <= GL_TRIANGLE_FAN
+                     && (record.indexType == GL_UNSIGNED_INT
+                         || (record.indexType == GL_UNSIGNED_SHORT
+                             && record.vertexCount <= MeshWelder::kMaxShortIndexVertices))
+                     && uint64_t(record.nameOffset) + record.nameLength <= stringsSize_
+                     && record.lodCount > 0 && uint64_t(record.firstLod) + record.lodCount <= lodCount_;
+        valid = valid && sectionMatches(record.vertexSection, BakedSectionType::Vertices,
+                                        uint64_t(getVertexFormat(i).layout.stride) * record.vertexCount)
+                && sectionMatches(record.indexSection, BakedSectionType::Indices,
+                                  uint64_t(indexSize(record.indexType)) * record.indexCount);
+        for (uint32_t l = 0; valid && l < record.lodCount; l++) {
+            const BakedLod &lod = lods_[record.firstLod + l];
+            valid = uint64_t(lod.indexOffset) + lod.indexCount <= record.indexCount;
+        }
+        if (valid && record.meshletSection != BakedMeshRecord::kNoSection) {
+            valid = sectionMatches(record.meshletSection, BakedSectionType::Meshlets,
+                                   uint64_t(sizeof(Meshlet)) * record.meshletCount)
+                    && sectionMatches(record.meshletCullingSection, BakedSectionType::MeshletCulling,
+                                      uint64_t(sizeof(float)) * kMeshletCullingArrays
+                                      * paddedMeshletCount(record.meshletCount));
+            // 簇表很小，总是检查簇的范围，绘制时按它直接取索引
+            auto *meshlets = valid ? reinterpret_cast<const Meshlet *>(sectionData(record.meshletSection))
+                                   : nullptr;
+            const BakedLod &lod0 = lods_[record.firstLod];
+            for (uint32_t m = 0; valid && m < record.meshletCount; m++) {
+                valid = uint64_t(meshlets[m].indexOffset) + uint64_t(meshlets[m].triangleCount) * 3
+                        <= lod0.indexCount;
+            }
+        }
+        if (valid && verifyData) {
+            IndexStream indices;
+            indices.data = getIndexData(i);
+            indices.count = record.indexCount;
+            indices.type = record.indexType;
+            for (size_t n = 0; n < indices.count && valid; n++) {
+                valid = indices.fetch(n) < record.vertexCount;
+            }
+        }
+        if (!valid) {
+            LOGE("网格 %zu 的记录无效", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+const BakedSection *BakedMeshFile::findSection(BakedSectionType type) const {
+    for (const BakedSection &section: sections_) {
+        if (section.type == uint32_t(type)) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+const uint8_t *BakedMeshFile::sectionData(uint32_t section) const {
+    return file_->data() + sections_[section].offset;
+}
+
+std::string_view BakedMeshFile::getMeshName(size_t index) const {
+    const BakedMeshRecord &record = records_[index];
+    return record.nameLength ? std::string_view(strings_ + record.nameOffset, record.nameLength)
+                             : std::string_view();
+}
+
+QuantizedVertices BakedMeshFile::getVertexFormat(size_t index) const {
+    const BakedMeshRecord &record = records_[index];
+    QuantizedVertices format;
+    format.layout = VertexLayout::make(
+            PositionFormat(record.positionFormat), UVFormat(record.uvFormat), ColorFormat(record.colorFormat));
+    format.vertexCount = record.vertexCount;
+    memcpy(format.positionScale.idx, record.positionScale, sizeof(record.positionScale));
+    memcpy(format.positionOffset.idx, record.positionOffset, sizeof(record.positionOffset));
+    return format;
+}
+
+const uint8_t *BakedMeshFile::getVertexData(size_t index) const {
+    return sectionData(records_[index].vertexSection);
+}
+
+const uint8_t *BakedMeshFile::getIndexData(size_t index) const {
+    return sectionData(records_[index].indexSection);
+}
+
+const BakedLod *BakedMeshFile::getLods(size_t index) const {
+    return lods_ + records_[index].firstLod;
+}
+
+Aabb BakedMeshFile::getBounds(size_t index) const {
+    const BakedMeshRecord &record = records_[index];
+    Aabb bounds;
+    bounds.min = Vec3{record.boundsMin[0], record.boundsMin[1], record.boundsMin[2], 0.f};
+    bounds.max = Vec3{record.boundsMax[0], record.boundsMax[1], record.boundsMax[2], 0.f};
+    return bounds;
+}
+
+bool BakedMeshFile::getMeshlets(size_t index, MeshletMesh &out) const {
+    const BakedMeshRecord &record = records_[index];
+    if (record.meshletSection == BakedMeshRecord::kNoSection) {
+        return false;
+    }
+    auto *meshlets = reinterpret_cast<const Meshlet *>(sectionData(record.meshletSection));
+    out.meshlets.assign(meshlets, meshlets + record.meshletCount);
+    out.indices.clear();
+
+    size_t padded = paddedMeshletCount(record.meshletCount);
+    auto *arrays = reinterpret_cast<const float *>(sectionData(record.meshletCullingSection));
+    for (std::vector<float> *array: {
+            &out.centerX, &out.centerY, &out.centerZ, &out.radius,
+            &out.axisX, &out.axisY, &out.axisZ, &out.cutoff}) {
+        array->assign(arrays, arrays + padded);
+        arrays += padded;
+    }
+    return true;
+}
@@ -0,0 +1,206 @@
+#ifndef ANDROIDGLINVESTIGATIONS_BAKEDMESH_H
+#define ANDROIDGLINVESTIGATIONS_BAKEDMESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bounds.h"
+#include "LevelOfDetail.h"
+#include "MappedFile.h"
+#include "Meshlet.h"
+#include "VertexFormat.h"
+
+/*
+ * 烘焙网格文件（.bmesh）的格式。所有数值都是小端序，偏移从文件开头算起：
+ *
+ *   BakedMeshHeader
+ *   BakedSection[sectionCount]   节表
+ *   各节的数据，每节起点按16字节对齐
+ *
+ * 网格描述节（Meshes）是 BakedMeshRecord 数组，每个记录通过节表下标引用自己的顶点、索引、
+ * 簇和簇剔除数据。顶点已经是 VertexLayout 描述的交错格式，索引已经是上传用的16/32位格式，
+ * 加载时直接引用映射内存，不做任何转换。
+ *
+ * 版本号在格式不兼容时递增，读取器只接受完全相同的版本。
+ */
+
+constexpr uint32_t bakedFourCC(char a, char b, char c, char d) {
+    return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16)
+           | (uint32_t(uint8_t(d)) << 24);
+}
+
+//! 节的类型
+enum class BakedSectionType : uint32_t {
+    Meshes = bakedFourCC('M', 'E', 'S', 'H'),         // BakedMeshRecord[]
+    Lods = bakedFourCC('L', 'O', 'D', 'S'),           // BakedLod[]，所有网格共用
+    Strings = bakedFourCC('S', 'T', 'R', 'S'),        // 网格名等字符串，不以0结尾
+    Vertices = bakedFourCC('V', 'T', 'X', 'S'),       // 一个网格的交错顶点
+    Indices = bakedFourCC('I', 'D', 'X', 'S'),        // 一个网格所有层次的索引
+    Meshlets = bakedFourCC('M', 'L', 'T', 'S'),       // 一个网格的 Meshlet[]
+    MeshletCulling = bakedFourCC('M', 'L', 'C', 'L'), // 8个按分量存放的float数组，长度补齐到4的倍数
+};
+
+struct BakedMeshHeader {
+    static constexpr uint32_t kMagic = bakedFourCC('B', 'M', 'S', 'H');
+    static constexpr uint16_t kVersion = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;     // sizeof(BakedMeshHeader)
+    uint32_t sectionCount;
+    uint32_t tableChecksum;  // 节表的CRC-32
+    uint64_t fileSize;
+    uint32_t headerChecksum; // 本字段为0时整个文件头的CRC-32
+    uint32_t reserved;
+};
+
+struct BakedSection {
+    uint32_t type;     // BakedSectionType
+    uint32_t checksum; // 数据的CRC-32
+    uint64_t offset;   // 16字节对齐
+    uint64_t size;
+    uint64_t reserved;
+};
+
+//! 一个细节层次在网格索引中的范围
+struct BakedLod {
+    uint32_t indexOffset; // 以索引个数计
+    uint32_t indexCount;
+    float error;          // 物体空间中的误差
+    uint32_t reserved;
+};
+
+struct BakedMeshRecord {
+    static constexpr uint32_t kNoSection = 0xFFFFFFFFu;
+
+    uint32_t nameOffset; // 在Strings节中的范围
+    uint32_t nameLength;
+    uint32_t mode;       // GL绘制模式
+    uint32_t indexType;  // GL_UNSIGNED_SHORT或GL_UNSIGNED_INT
+    uint32_t vertexCount;
+    uint32_t indexCount; // 所有层次的索引总数
+    uint8_t positionFormat; // PositionFormat
+    uint8_t uvFormat;       // UVFormat
+    uint8_t colorFormat;    // ColorFormat
+    uint8_t reserved0;
+    uint32_t baseColor;     // 材质基础颜色，RGBA8，R在最低字节
+    float positionScale[3]; // 位置还原参数，见 QuantizedVertices
+    float positionOffset[3];
+    float boundsMin[3];     // 物体空间包围盒
+    float boundsMax[3];
+    uint32_t vertexSection;  // 节表下标
+    uint32_t indexSection;
+    uint32_t firstLod;       // 在Lods节中的范围，第0层误差为0
+    uint32_t lodCount;
+    uint32_t meshletSection; // 没有分簇时为kNoSection，有分簇时第0层索引按簇排列
+    uint32_t meshletCullingSection;
+    uint32_t meshletCount;
+    uint32_t reserved1;
+};
+
+static_assert(sizeof(BakedMeshHeader) == 32, "BakedMeshHeader的大小是格式的一部分");
+static_assert(sizeof(BakedSection) == 32, "BakedSection的大小是格式的一部分");
+static_assert(sizeof(BakedLod) == 16, "BakedLod的大小是格式的一部分");
+static_assert(sizeof(BakedMeshRecord) == 112, "BakedMeshRecord的大小是格式的一部分");
+static_assert(sizeof(Meshlet) == 44, "Meshlet直接写入文件，改动布局时要递增版本号");
+
+/*!
+ * 烘焙前的一个网格
+ */
+struct BakedMeshInput {
+    std::string name;
+    GLenum mode = GL_TRIANGLES;
+    QuantizedVertices vertices;
+    Aabb bounds = Aabb::empty();
+    std::vector<LodLevel> lods; // 至少一层；有分簇时第0层必须是meshlets.indices
+    MeshletMesh meshlets;       // 可以为空
+    uint32_t baseColor = 0xFFFFFFFFu;
+};
+
+/*!
+ * 把网格写成.bmesh文件，通常由主机上的meshbaker工具调用
+ */
+class BakedMeshWriter {
+public:
+    void addMesh(BakedMeshInput mesh);
+
+    /*!
+     * @return 文件无法写入时返回false并输出日志
+     */
+    bool write(const std::string &path) const;
+
+    //! 生成整个文件的内容
+    std::vector<uint8_t> serialize() const;
+
+private:
+    std::vector<BakedMeshInput> meshes_;
+};
+
+/*!
+ * 映射的.bmesh文件。打开时只检查文件头、节表和网格记录，顶点和索引留在映射中，
+ * 由 Model 直接引用；这些模型持有映射的共享所有权，可以比本对象活得更久。
+ */
+class BakedMeshFile {
+public:
+    /*!
+     * 映射并检查文件
+     * @param verifyData 为true时还会校验每一节的CRC并检查索引没有越界，需要读完整个文件
+     * @return 文件无效时返回false并输出日志
+     */
+    bool open(const std::string &path, bool verifyData = false);
+
+#ifdef __ANDROID__
+    //! 映射assets/目录中的文件，文件在APK中不能被压缩（见build.gradle.kts的noCompress）
+    bool openAsset(AAssetManager *assetManager, const std::string &assetPath, bool verifyData = false);
+#endif
+
+    inline size_t getMeshCount() const { return meshCount_; }
+
+    inline const BakedMeshRecord &getMesh(size_t index) const { return records_[index]; }
+
+    std::string_view getMeshName(size_t index) const;
+
+    //! 网格的顶点布局和还原参数，data为空，顶点数据用 getVertexData 取得
+    QuantizedVertices getVertexFormat(size_t index) const;
+
+    const uint8_t *getVertexData(size_t index) const;
+
+    const uint8_t *getIndexData(size_t index) const;
+
+    //! 网格的细节层次，个数为 getMesh(index).lodCount
+    const BakedLod *getLods(size_t index) const;
+
+    Aabb getBounds(size_t index) const;
+
+    /*!
+     * 拷贝网格的簇表。簇表只有索引数据的几十分之一，剔除需要的是独立的数组。
+     * 输出的indices为空，第0层的索引本身就是按簇排列的
+     * @return 网格没有分簇时返回false
+     */
+    bool getMeshlets(size_t index, MeshletMesh &out) const;
+
+    //! 映射的共享所有权，引用映射内存的对象持有它
+    inline const std::shared_ptr<const MappedFile> &getStorage() const { return file_; }
+
+private:
+    bool validate(bool verifyData);
+
+    const BakedSection *findSection(BakedSectionType type) const;
+
+    const uint8_t *sectionData(uint32_t section) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    std::vector<BakedSection> sections_; // 节表的拷贝，原文不一定8字节对齐
+    const BakedMeshRecord *records_ = nullptr;
+    size_t meshCount_ = 0;
+    const BakedLod *lods_ = nullptr;
+    size_t lodCount_ = 0;
+    const char *strings_ = nullptr;
+    size_t stringsSize_ = 0;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_BAKEDMESH_H
@@ -0,0 +1,364 @@
+#include "BatchTransform.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// Cephes sinf/cosf 使用的常量。DP1+DP2+DP3 以扩展精度表示π/4
+constexpr float kFourOverPi = 1.27323954473516f;
+constexpr float kDP1 = 0.78515625f;
+constexpr float kDP2 = 2.4187564849853515625e-4f;
+constexpr float kDP3 = 3.77489497744594108e-8f;
+constexpr float kSinP0 = -1.9515295891e-4f;
+constexpr float kSinP1 = 8.3321608736e-3f;
+constexpr float kSinP2 = -1.6666654611e-1f;
+constexpr float kCosP0 = 2.443315711809948e-5f;
+constexpr float kCosP1 = -1.388731625493765e-3f;
+constexpr float kCosP2 = 4.166664568298827e-2f;
+
+constexpr float kDegreesToRadians = float(M_PI / 180.0);
+
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsToFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 与SIMD版本相同的元素公式，两者都以Mat4::rotationEulerDegrees为准
+inline void assembleEuler(
+        float cx, float sx, float cy, float sy, float cz, float sz, Mat4 &out) {
+    out.m[0] = cy * cz - sy * sx * sz;
+    out.m[1] = -(cx * sz);
+    out.m[2] = sy * cz + cy * sx * sz;
+    out.m[3] = 0.f;
+    out.m[4] = cy * sz + sy * sx * cz;
+    out.m[5] = cx * cz;
+    out.m[6] = sy * sz - cy * sx * cz;
+    out.m[7] = 0.f;
+    out.m[8] = -(sy * cx);
+    out.m[9] = sx;
+    out.m[10] = cy * cx;
+    out.m[11] = 0.f;
+    out.m[12] = 0.f;
+    out.m[13] = 0.f;
+    out.m[14] = 0.f;
+    out.m[15] = 1.f;
+}
+
+#if VECMATH_SSE
+
+using F4 = __m128;
+
+inline F4 set1(float v) { return _mm_set1_ps(v); }
+inline F4 load(const float *p) { return _mm_loadu_ps(p); }
+inline void store(float *p, F4 v) { _mm_storeu_ps(p, v); }
+inline void storeAligned(float *p, F4 v) { _mm_store_ps(p, v); }
+inline F4 add(F4 a, F4 b) { return _mm_add_ps(a, b); }
+inline F4 sub(F4 a, F4 b) { return _mm_sub_ps(a, b); }
+inline F4 mul(F4 a, F4 b) { return _mm_mul_ps(a, b); }
+inline F4 neg(F4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+
+inline void transpose(F4 &r0, F4 &r1, F4 &r2, F4 &r3) {
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+inline void sinCos4(F4 x, F4 &outSin, F4 &outCos) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(int32_t(0x80000000u)));
+    __m128 signSin = _mm_and_ps(x, signMask);
+    x = _mm_andnot_ps(signMask, x);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(kFourOverPi)));
+    j = _mm_add_epi32(j, _mm_set1_epi32(1));
+    j = _mm_and_si128(j, _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    __m128 swapSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+    __m128i jCos = _mm_sub_epi32(j, _mm_set1_epi32(2));
+    __m128 signCos = _mm_castsi128_ps(
+            _mm_slli_epi32(_mm_andnot_si128(jCos, _mm_set1_epi32(4)), 29));
+    __m128 polyMask = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+    signSin = _mm_xor_ps(signSin, swapSin);
+
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(kDP1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(kDP2)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(kDP3)));
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 yc = _mm_mul_ps(_mm_set1_ps(kCosP0), z);
+    yc = _mm_add_ps(yc, _mm_set1_ps(kCosP1));
+    yc = _mm_mul_ps(yc, z);
+    yc = _mm_add_ps(yc, _mm_set1_ps(kCosP2));
+    yc = _mm_mul_ps(yc, z);
+    yc = _mm_mul_ps(yc, z);
+    yc = _mm_sub_ps(yc, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    yc = _mm_add_ps(yc, _mm_set1_ps(1.f));
+
+    __m128 ys = _mm_mul_ps(_mm_set1_ps(kSinP0), z);
+    ys = _mm_add_ps(ys, _mm_set1_ps(kSinP1));
+    ys = _mm_mul_ps(ys, z);
+    ys = _mm_add_ps(ys, _mm_set1_ps(kSinP2));
+    ys = _mm_mul_ps(ys, z);
+    ys = _mm_mul_ps(ys, x);
+    ys = _mm_add_ps(ys, x);
+
+    __m128 s = _mm_or_ps(_mm_and_ps(polyMask, ys), _mm_andnot_ps(polyMask, yc));
+    __m128 c = _mm_or_ps(_mm_and_ps(polyMask, yc), _mm_andnot_ps(polyMask, ys));
+    outSin = _mm_xor_ps(s, signSin);
+    outCos = _mm_xor_ps(c, signCos);
+}
+
+#elif VECMATH_NEON
+
+using F4 = float32x4_t;
+
+inline F4 set1(float v) { return vdupq_n_f32(v); }
+inline F4 load(const float *p) { return vld1q_f32(p); }
+inline void store(float *p, F4 v) { vst1q_f32(p, v); }
+inline void storeAligned(float *p, F4 v) { vst1q_f32(p, v); }
+inline F4 add(F4 a, F4 b) { return vaddq_f32(a, b); }
+inline F4 sub(F4 a, F4 b) { return vsubq_f32(a, b); }
+inline F4 mul(F4 a, F4 b) { return vmulq_f32(a, b); }
+inline F4 neg(F4 a) { return vnegq_f32(a); }
+
+inline void transpose(F4 &r0, F4 &r1, F4 &r2, F4 &r3) {
+    float32x4x2_t t01 = vtrnq_f32(r0, r1);
+    float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline void sinCos4(F4 x, F4 &outSin, F4 &outCos) {
+    uint32x4_t signSin = vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000u));
+    x = vabsq_f32(x);
+
+    int32x4_t j = vcvtq_s32_f32(vmulq_f32(x, vdupq_n_f32(kFourOverPi)));
+    j = vaddq_s32(j, vdupq_n_s32(1));
+    j = vandq_s32(j, vdupq_n_s32(~1));
+    float32x4_t y = vcvtq_f32_s32(j);
+
+    uint32x4_t swapSin = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(j, vdupq_n_s32(4))), 29);
+    int32x4_t jCos = vsubq_s32(j, vdupq_n_s32(2));
+    uint32x4_t signCos = vshlq_n_u32(vreinterpretq_u32_s32(vbicq_s32(vdupq_n_s32(4), jCos)), 29);
+    uint32x4_t polyMask = vceqq_s32(vandq_s32(j, vdupq_n_s32(2)), vdupq_n_s32(0));
+    signSin = veorq_u32(signSin, swapSin);
+
+    x = vsubq_f32(x, vmulq_f32(y, vdupq_n_f32(kDP1)));
+    x = vsubq_f32(x, vmulq_f32(y, vdupq_n_f32(kDP2)));
+    x = vsubq_f32(x, vmulq_f32(y, vdupq_n_f32(kDP3)));
+    float32x4_t z = vmulq_f32(x, x);
+
+    float32x4_t yc = vmulq_f32(vdupq_n_f32(kCosP0), z);
+    yc = vaddq_f32(yc, vdupq_n_f32(kCosP1));
+    yc = vmulq_f32(yc, z);
+    yc = vaddq_f32(yc, vdupq_n_f32(kCosP2));
+    yc = vmulq_f32(yc, z);
+    yc = vmulq_f32(yc, z);
+    yc = vsubq_f32(yc, vmulq_f32(z, vdupq_n_f32(0.5f)));
+    yc = vaddq_f32(yc, vdupq_n_f32(1.f));
+
+    float32x4_t ys = vmulq_f32(vdupq_n_f32(kSinP0), z);
+    ys = vaddq_f32(ys, vdupq_n_f32(kSinP1));
+    ys = vmulq_f32(ys, z);
+    ys = vaddq_f32(ys, vdupq_n_f32(kSinP2));
+    ys = vmulq_f32(ys, z);
+    ys = vmulq_f32(ys, x);
+    ys = vaddq_f32(ys, x);
+
+    float32x4_t s = vbslq_f32(polyMask, ys, yc);
+    float32x4_t c = vbslq_f32(polyMask, yc, ys);
+    outSin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(s), signSin));
+    outCos = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(c), signCos));
+}
+
+#endif
+
+#if VECMATH_SSE || VECMATH_NEON
+
+// 把4个物体的矩阵元素（每个寄存器是4个物体的同一元素）写成4个列主序矩阵
+inline void storeMatrices(
+        F4 m0, F4 m1, F4 m2, F4 m4, F4 m5, F4 m6, F4 m8, F4 m9, F4 m10, Mat4 *out) {
+    F4 zero = set1(0.f);
+    F4 c0 = m0, c1 = m1, c2 = m2, c3 = zero;
+    transpose(c0, c1, c2, c3);
+    storeAligned(out[0].m, c0);
+    storeAligned(out[1].m, c1);
+    storeAligned(out[2].m, c2);
+    storeAligned(out[3].m, c3);
+
+    c0 = m4, c1 = m5, c2 = m6, c3 = zero;
+    transpose(c0, c1, c2, c3);
+    storeAligned(out[0].m + 4, c0);
+    storeAligned(out[1].m + 4, c1);
+    storeAligned(out[2].m + 4, c2);
+    storeAligned(out[3].m + 4, c3);
+
+    c0 = m8, c1 = m9, c2 = m10, c3 = zero;
+    transpose(c0, c1, c2, c3);
+    storeAligned(out[0].m + 8, c0);
+    storeAligned(out[1].m + 8, c1);
+    storeAligned(out[2].m + 8, c2);
+    storeAligned(out[3].m + 8, c3);
+
+    // 第4列对所有旋转矩阵都是(0, 0, 0, 1)
+    static const float kLastColumn[4] = {0.f, 0.f, 0.f, 1.f};
+    F4 lastColumn = load(kLastColumn);
+    storeAligned(out[0].m + 12, lastColumn);
+    storeAligned(out[1].m + 12, lastColumn);
+    storeAligned(out[2].m + 12, lastColumn);
+    storeAligned(out[3].m + 12, lastColumn);
+}
+
+#endif
+
+} // namespace
+
+void BatchTransform::sinCosScalar(float radians, float &outSin, float &outCos) {
+    uint32_t signSin = floatBits(radians) & 0x80000000u;
+    float x = fabsf(radians);
+
+    auto j = int32_t(x * kFourOverPi);
+    j = (j + 1) & ~1;
+    auto y = float(j);
+
+    uint32_t swapSin = uint32_t(j & 4) << 29;
+    uint32_t signCos = uint32_t(~(j - 2) & 4) << 29;
+    bool usePolySin = (j & 2) == 0;
+    signSin ^= swapSin;
+
+    x = x - y * kDP1;
+    x = x - y * kDP2;
+    x = x - y * kDP3;
+    float z = x * x;
+
+    float yc = kCosP0 * z;
+    yc = yc + kCosP1;
+    yc = yc * z;
+    yc = yc + kCosP2;
+    yc = yc * z;
+    yc = yc * z;
+    yc = yc - z * 0.5f;
+    yc = yc + 1.f;
+
+    float ys = kSinP0 * z;
+    ys = ys + kSinP1;
+    ys = ys * z;
+    ys = ys + kSinP2;
+    ys = ys * z;
+    ys = ys * x;
+    ys = ys + x;
+
+    float s = usePolySin ? ys : yc;
+    float c = usePolySin ? yc : ys;
+    outSin = bitsToFloat(floatBits(s) ^ signSin);
+    outCos = bitsToFloat(floatBits(c) ^ signCos);
+}
+
+void BatchTransform::sinCos(const float *radians, float *outSin, float *outCos, size_t count) {
+    size_t i = 0;
+#if VECMATH_SSE || VECMATH_NEON
+    for (; i + 4 <= count; i += 4) {
+        F4 s, c;
+        sinCos4(load(radians + i), s, c);
+        if (outSin) {
+            store(outSin + i, s);
+        }
+        if (outCos) {
+            store(outCos + i, c);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        float s, c;
+        sinCosScalar(radians[i], s, c);
+        if (outSin) {
+            outSin[i] = s;
+        }
+        if (outCos) {
+            outCos[i] = c;
+        }
+    }
+}
+
+void BatchTransform::buildEulerRotations(
+        const float *xDegrees,
+        const float *yDegrees,
+        const float *zDegrees,
+        size_t count,
+        Mat4 *outMatrices) {
+    size_t i = 0;
+#if VECMATH_SSE || VECMATH_NEON
+    const F4 toRadians = set1(kDegreesToRadians);
+    for (; i + 4 <= count; i += 4) {
+        F4 sx, cx, sy, cy, sz, cz;
+        sinCos4(mul(load(xDegrees + i), toRadians), sx, cx);
+        sinCos4(mul(load(yDegrees + i), toRadians), sy, cy);
+        sinCos4(mul(load(zDegrees + i), toRadians), sz, cz);
+
+        F4 sysx = mul(sy, sx);
+        F4 cysx = mul(cy, sx);
+        storeMatrices(
+                sub(mul(cy, cz), mul(sysx, sz)),
+                neg(mul(cx, sz)),
+                add(mul(sy, cz), mul(cysx, sz)),
+                add(mul(cy, sz), mul(sysx, cz)),
+                mul(cx, cz),
+                sub(mul(sy, sz), mul(cysx, cz)),
+                neg(mul(sy, cx)),
+                sx,
+                mul(cy, cx),
+                outMatrices + i);
+    }
+#endif
+    for (; i < count; i++) {
+        float sx, cx, sy, cy, sz, cz;
+        sinCosScalar(xDegrees[i] * kDegreesToRadians, sx, cx);
+        sinCosScalar(yDegrees[i] * kDegreesToRadians, sy, cy);
+        sinCosScalar(zDegrees[i] * kDegreesToRadians, sz, cz);
+        assembleEuler(cx, sx, cy, sy, cz, sz, outMatrices[i]);
+    }
+}
+
+void BatchTransform::buildQuatRotations(
+        const float *qx,
+        const float *qy,
+        const float *qz,
+        const float *qw,
+        size_t count,
+        Mat4 *outMatrices) {
+    size_t i = 0;
+#if VECMATH_SSE || VECMATH_NEON
+    const F4 one = set1(1.f);
+    const F4 two = set1(2.f);
+    for (; i + 4 <= count; i += 4) {
+        F4 x = load(qx + i), y = load(qy + i), z = load(qz + i), w = load(qw + i);
+        F4 xx = mul(x, x), yy = mul(y, y), zz = mul(z, z);
+        F4 xy = mul(x, y), xz = mul(x, z), yz = mul(y, z);
+        F4 wx = mul(w, x), wy = mul(w, y), wz = mul(w, z);
+        storeMatrices(
+                sub(one, mul(two, add(yy, zz))),
+                mul(two, add(xy, wz)),
+                mul(two, sub(xz, wy)),
+                mul(two, sub(xy, wz)),
+                sub(one, mul(two, add(xx, zz))),
+                mul(two, add(yz, wx)),
+                mul(two, add(xz, wy)),
+                mul(two, sub(yz, wx)),
+                sub(one, mul(two, add(xx, yy))),
+                outMatrices + i);
+    }
+#endif
+    for (; i < count; i++) {
+        outMatrices[i] = Mat4::fromQuat(Quat{qx[i], qy[i], qz[i], qw[i]});
+    }
+}
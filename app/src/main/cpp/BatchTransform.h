@@ -0,0 +1,66 @@
+#ifndef ANDROIDGLINVESTIGATIONS_BATCHTRANSFORM_H
+#define ANDROIDGLINVESTIGATIONS_BATCHTRANSFORM_H
+
+#include <cstddef>
+
+#include "VecMath.h"
+
+/*!
+ * 面向大量动画物体的批量变换生成。
+ *
+ * 输入是按分量分开存放（SoA）的角度或四元数数组，输出是连续的列主序矩阵数组。
+ * 每次处理4个物体：先用向量化的sincos求出三角函数，再在寄存器中拼装矩阵元素，
+ * 最后通过4x4转置一次写出4个矩阵的同一列。
+ *
+ * sincos使用Cephes风格的实现：按π/4分象限，再用多项式逼近。
+ * 对 |x| <= 8192 弧度，与双精度结果相比最大绝对误差不超过 3e-7，
+ * 超出这个范围后由于分象限时的精度损失，误差会逐渐变大。
+ */
+class BatchTransform {
+public:
+    //! sincos在 |x| <= kSinCosMaxArgument 时的最大绝对误差
+    static constexpr float kSinCosMaxError = 3e-7f;
+    static constexpr float kSinCosMaxArgument = 8192.f;
+
+    /*!
+     * 批量计算正弦和余弦
+     * @param radians 输入角度（弧度）
+     * @param outSin 输出正弦，可以为null
+     * @param outCos 输出余弦，可以为null
+     * @param count 元素个数
+     */
+    static void sinCos(const float *radians, float *outSin, float *outCos, size_t count);
+
+    /*!
+     * 与SIMD版本运算顺序完全相同的标量sincos，用于处理尾部元素和验证
+     */
+    static void sinCosScalar(float radians, float &outSin, float &outCos);
+
+    /*!
+     * 批量生成欧拉角旋转矩阵，约定与 Utility::buildRotationMatrix3D 相同
+     * @param xDegrees 绕X轴的角度（度）
+     * @param yDegrees 绕Y轴的角度（度）
+     * @param zDegrees 绕Z轴的角度（度）
+     * @param count 物体个数
+     * @param outMatrices 输出矩阵数组，长度至少为count
+     */
+    static void buildEulerRotations(
+            const float *xDegrees,
+            const float *yDegrees,
+            const float *zDegrees,
+            size_t count,
+            Mat4 *outMatrices);
+
+    /*!
+     * 批量把单位四元数转换为旋转矩阵，结果与 Mat4::fromQuat 一致
+     */
+    static void buildQuatRotations(
+            const float *qx,
+            const float *qy,
+            const float *qz,
+            const float *qw,
+            size_t count,
+            Mat4 *outMatrices);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_BATCHTRANSFORM_H
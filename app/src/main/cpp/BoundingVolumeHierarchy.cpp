@@ -0,0 +1,338 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+BoundingVolumeHierarchy::ProxyId BoundingVolumeHierarchy::createProxy(const Aabb &bounds, uint32_t userData) {
+    ProxyId proxy;
+    if (!freeProxies_.empty()) {
+        proxy = freeProxies_.back();
+        freeProxies_.pop_back();
+    } else {
+        proxy = static_cast<ProxyId>(proxies_.size());
+        proxies_.push_back(kNull);
+        tightBounds_.emplace_back();
+        dirty_.push_back(0);
+    }
+
+    uint32_t leaf = allocateNode();
+    Node &node = nodes_[leaf];
+    node.box = expand(bounds, margin_);
+    node.children[0] = kNull;
+    node.children[1] = proxy;
+    node.userData = userData;
+    proxies_[proxy] = leaf;
+    tightBounds_[proxy] = bounds;
+    insertLeaf(leaf);
+    return proxy;
+}
+
+void BoundingVolumeHierarchy::destroyProxy(ProxyId proxy) {
+    assert(proxy < proxies_.size() && proxies_[proxy] != kNull);
+    uint32_t leaf = proxies_[proxy];
+    removeLeaf(leaf);
+    freeNode(leaf);
+    proxies_[proxy] = kNull;
+    dirty_[proxy] = 0;
+    freeProxies_.push_back(proxy);
+}
+
+bool BoundingVolumeHierarchy::moveProxy(ProxyId proxy, const Aabb &bounds) {
+    assert(proxy < proxies_.size() && proxies_[proxy] != kNull);
+    tightBounds_[proxy] = bounds;
+    uint32_t leaf = proxies_[proxy];
+    if (nodes_[leaf].box.contains(bounds)) {
+        return false;
+    }
+    // 先就地修正祖先的包围盒，保证剔除结果正确；树的结构留给update调整
+    nodes_[leaf].box = expand(bounds, margin_);
+    refit(nodes_[leaf].parent);
+    if (!dirty_[proxy]) {
+        dirty_[proxy] = 1;
+        dirtyProxies_.push_back(proxy);
+    }
+    return true;
+}
+
+size_t BoundingVolumeHierarchy::update(size_t maxReinsertions) {
+    size_t reinserted = 0;
+    while (reinserted < maxReinsertions && !dirtyProxies_.empty()) {
+        ProxyId proxy = dirtyProxies_.back();
+        dirtyProxies_.pop_back();
+        // 销毁的代理留在列表里，标志已经清除
+        if (!dirty_[proxy]) {
+            continue;
+        }
+        dirty_[proxy] = 0;
+        removeLeaf(proxies_[proxy]);
+        insertLeaf(proxies_[proxy]);
+        reinserted++;
+    }
+    if (getProxyCount() > 2 && internalArea_ > kRebuildCostRatio * builtArea_) {
+        rebuild();
+    }
+    return reinserted;
+}
+
+void BoundingVolumeHierarchy::rebuild() {
+    std::vector<Node> leaves;
+    leaves.reserve(getProxyCount());
+    if (root_ != kNull) {
+        std::vector<uint32_t> stack = {root_};
+        while (!stack.empty()) {
+            const Node &node = nodes_[stack.back()];
+            stack.pop_back();
+            if (node.isLeaf()) {
+                leaves.push_back(node);
+            } else {
+                stack.push_back(node.children[0]);
+                stack.push_back(node.children[1]);
+            }
+        }
+    }
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+    dirtyProxies_.clear();
+    freeNodes_.clear();
+    internalArea_ = 0.0;
+
+    std::vector<Node> nodes;
+    nodes.reserve(leaves.size() * 2);
+    root_ = leaves.empty() ? kNull : buildRange(leaves, 0, leaves.size(), kNull, nodes);
+    nodes_ = std::move(nodes);
+    builtArea_ = internalArea_;
+}
+
+size_t BoundingVolumeHierarchy::cull(const Frustum &frustum, std::vector<uint32_t> &outVisible) const {
+    outVisible.clear();
+    if (root_ == kNull) {
+        return 0;
+    }
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(root_);
+    std::vector<uint32_t> inside;
+
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        const Node &node = nodes_[index];
+        Containment containment = frustum.classify(node.box);
+        if (containment == Containment::Outside) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            // 扩大的盒与视锥相交时再用原始包围盒确认
+            if (containment == Containment::Inside
+                || frustum.classify(tightBounds_[node.proxy()]) != Containment::Outside) {
+                outVisible.push_back(node.userData);
+            }
+            continue;
+        }
+        if (containment == Containment::Intersecting) {
+            // 先访问children[0]，重建后它紧跟在父节点之后
+            stack.push_back(node.children[1]);
+            stack.push_back(node.children[0]);
+            continue;
+        }
+
+        // 整棵子树都在视锥内，不再测试
+        inside.push_back(index);
+        while (!inside.empty()) {
+            const Node &subtree = nodes_[inside.back()];
+            inside.pop_back();
+            if (subtree.isLeaf()) {
+                outVisible.push_back(subtree.userData);
+            } else {
+                inside.push_back(subtree.children[1]);
+                inside.push_back(subtree.children[0]);
+            }
+        }
+    }
+    return outVisible.size();
+}
+
+size_t BoundingVolumeHierarchy::computeHeight() const {
+    if (root_ == kNull) {
+        return 0;
+    }
+    size_t height = 0;
+    std::vector<std::pair<uint32_t, size_t>> stack = {{root_, 1}};
+    while (!stack.empty()) {
+        auto [index, depth] = stack.back();
+        stack.pop_back();
+        height = std::max(height, depth);
+        const Node &node = nodes_[index];
+        if (!node.isLeaf()) {
+            stack.push_back({node.children[0], depth + 1});
+            stack.push_back({node.children[1], depth + 1});
+        }
+    }
+    return height;
+}
+
+uint32_t BoundingVolumeHierarchy::allocateNode() {
+    if (!freeNodes_.empty()) {
+        uint32_t index = freeNodes_.back();
+        freeNodes_.pop_back();
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void BoundingVolumeHierarchy::freeNode(uint32_t node) {
+    if (!nodes_[node].isLeaf()) {
+        internalArea_ -= nodes_[node].box.surfaceArea();
+    }
+    nodes_[node].parent = kNull;
+    freeNodes_.push_back(node);
+}
+
+void BoundingVolumeHierarchy::setInternalBox(uint32_t node, const Aabb &box) {
+    internalArea_ += double(box.surfaceArea()) - double(nodes_[node].box.surfaceArea());
+    nodes_[node].box = box;
+}
+
+void BoundingVolumeHierarchy::refit(uint32_t node) {
+    while (node != kNull) {
+        const Node &current = nodes_[node];
+        Aabb box = merge(nodes_[current.children[0]].box, nodes_[current.children[1]].box);
+        // 包围盒没有变化时祖先也不会变化
+        if (memcmp(&box, &current.box, sizeof(Aabb)) == 0) {
+            break;
+        }
+        setInternalBox(node, box);
+        node = current.parent;
+    }
+}
+
+void BoundingVolumeHierarchy::insertLeaf(uint32_t leaf) {
+    if (root_ == kNull) {
+        root_ = leaf;
+        nodes_[leaf].parent = kNull;
+        return;
+    }
+
+    // 从根向下找代价最小的兄弟节点：与叶子合并后新增的表面积，加上所有祖先因此增大的表面积
+    const Aabb leafBox = nodes_[leaf].box;
+    uint32_t index = root_;
+    while (!nodes_[index].isLeaf()) {
+        const Node &node = nodes_[index];
+        float area = node.box.surfaceArea();
+        float combinedArea = merge(node.box, leafBox).surfaceArea();
+        // 在这里与叶子配对的代价
+        float cost = 2.f * combinedArea;
+        // 继续向下时本节点增大的面积
+        float inheritanceCost = 2.f * (combinedArea - area);
+
+        float childCost[2];
+        for (int i = 0; i < 2; i++) {
+            const Node &child = nodes_[node.children[i]];
+            float merged = merge(child.box, leafBox).surfaceArea();
+            childCost[i] = (child.isLeaf() ? merged : merged - child.box.surfaceArea()) + inheritanceCost;
+        }
+        if (cost < childCost[0] && cost < childCost[1]) {
+            break;
+        }
+        index = childCost[0] < childCost[1] ? node.children[0] : node.children[1];
+    }
+
+    uint32_t sibling = index;
+    uint32_t oldParent = nodes_[sibling].parent;
+    uint32_t newParent = allocateNode();
+    Node &parent = nodes_[newParent];
+    parent.parent = oldParent;
+    parent.children[0] = sibling;
+    parent.children[1] = leaf;
+    parent.userData = 0;
+    parent.box = merge(leafBox, nodes_[sibling].box);
+    internalArea_ += parent.box.surfaceArea();
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    if (oldParent == kNull) {
+        root_ = newParent;
+    } else {
+        Node &grandParent = nodes_[oldParent];
+        grandParent.children[grandParent.children[0] == sibling ? 0 : 1] = newParent;
+        refit(oldParent);
+    }
+}
+
+void BoundingVolumeHierarchy::removeLeaf(uint32_t leaf) {
+    if (leaf == root_) {
+        root_ = kNull;
+        return;
+    }
+    uint32_t parent = nodes_[leaf].parent;
+    uint32_t grandParent = nodes_[parent].parent;
+    uint32_t sibling = nodes_[parent].children[nodes_[parent].children[0] == leaf ? 1 : 0];
+
+    if (grandParent == kNull) {
+        root_ = sibling;
+        nodes_[sibling].parent = kNull;
+        freeNode(parent);
+    } else {
+        Node &grand = nodes_[grandParent];
+        grand.children[grand.children[0] == parent ? 0 : 1] = sibling;
+        nodes_[sibling].parent = grandParent;
+        freeNode(parent);
+        refit(grandParent);
+    }
+    nodes_[leaf].parent = kNull;
+}
+
+uint32_t BoundingVolumeHierarchy::buildRange(
+        std::vector<Node> &leaves,
+        size_t begin,
+        size_t end,
+        uint32_t parent,
+        std::vector<Node> &outNodes) {
+    const auto index = static_cast<uint32_t>(outNodes.size());
+    if (end - begin == 1) {
+        outNodes.push_back(leaves[begin]);
+        outNodes.back().parent = parent;
+        proxies_[leaves[begin].proxy()] = index;
+        return index;
+    }
+
+    // 沿质心分布最广的轴按中位数划分
+    Aabb centroids = Aabb::empty();
+    for (size_t i = begin; i < end; i++) {
+        const Aabb &box = leaves[i].box;
+        Vec3 center = {
+                (box.min.x + box.max.x) * 0.5f,
+                (box.min.y + box.max.y) * 0.5f,
+                (box.min.z + box.max.z) * 0.5f,
+                0.f};
+        centroids = merge(centroids, Aabb{center, center});
+    }
+    float extent[3] = {
+            centroids.max.x - centroids.min.x,
+            centroids.max.y - centroids.min.y,
+            centroids.max.z - centroids.min.z};
+    int axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : (extent[1] >= extent[2] ? 1 : 2);
+    auto centerOnAxis = [axis](const Node &leaf) {
+        const float *min = &leaf.box.min.x;
+        const float *max = &leaf.box.max.x;
+        return min[axis] + max[axis];
+    };
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(
+            leaves.begin() + begin, leaves.begin() + middle, leaves.begin() + end,
+            [&](const Node &a, const Node &b) { return centerOnAxis(a) < centerOnAxis(b); });
+
+    // 先放父节点再放子树，得到深度优先顺序
+    outNodes.emplace_back();
+    uint32_t left = buildRange(leaves, begin, middle, index, outNodes);
+    uint32_t right = buildRange(leaves, middle, end, index, outNodes);
+    Node &node = outNodes[index];
+    node.parent = parent;
+    node.children[0] = left;
+    node.children[1] = right;
+    node.userData = 0;
+    node.box = merge(outNodes[left].box, outNodes[right].box);
+    internalArea_ += node.box.surfaceArea();
+    return index;
+}
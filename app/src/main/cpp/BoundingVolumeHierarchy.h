@@ -0,0 +1,138 @@
+#ifndef ANDROIDGLINVESTIGATIONS_BOUNDINGVOLUMEHIERARCHY_H
+#define ANDROIDGLINVESTIGATIONS_BOUNDINGVOLUMEHIERARCHY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+
+/*!
+ * 动态包围盒层次（BVH），用于视锥剔除。
+ *
+ * 每个代理（叶子）保存物体的世界空间包围盒，向外扩大 @a margin 存入树中。物体移动后
+ * 只要新包围盒还在扩大的盒内，树完全不变；超出时重新扩大叶子并沿父节点向上修正（refit），
+ * 叶子同时记为待重新插入。@a update 每帧只重新插入有限个这样的叶子（增量重建），
+ * 整棵树的表面积代价比上次完整重建时增长太多时才完整重建。
+ *
+ * 插入使用表面积启发式（SAH）从根向下选择代价最小的兄弟节点；完整重建按质心中位数自顶向下划分，
+ * 并把节点按深度优先顺序重新排列，遍历时顺序访问内存。代理id与节点下标分开，重排不影响外部。
+ * 一次性加入大量代理后应调用 @a rebuild。
+ */
+class BoundingVolumeHierarchy {
+public:
+    using ProxyId = uint32_t;
+
+    static constexpr ProxyId kInvalidProxy = 0xFFFFFFFFu;
+
+    //! @a update 默认每次最多重新插入的叶子数
+    static constexpr size_t kDefaultReinsertions = 64;
+
+    //! 内部节点表面积之和超过上次完整重建时的这个倍数时完整重建
+    static constexpr float kRebuildCostRatio = 1.5f;
+
+    /*!
+     * @param margin 叶子包围盒向外扩大的距离，越大移动时越少修改树，但剔除越不精确
+     */
+    explicit BoundingVolumeHierarchy(float margin = 0.1f) : margin_(margin) {}
+
+    /*!
+     * 加入一个物体
+     * @param bounds 世界空间包围盒
+     * @param userData 剔除时输出的值，通常是物体在外部数组中的下标
+     */
+    ProxyId createProxy(const Aabb &bounds, uint32_t userData);
+
+    void destroyProxy(ProxyId proxy);
+
+    /*!
+     * 物体移动后更新包围盒
+     * @return 树是否被修改（新包围盒超出了扩大的盒）
+     */
+    bool moveProxy(ProxyId proxy, const Aabb &bounds);
+
+    /*!
+     * 增量重建：重新插入最多 @a maxReinsertions 个移动过的叶子，必要时完整重建
+     * @return 重新插入的叶子数
+     */
+    size_t update(size_t maxReinsertions = kDefaultReinsertions);
+
+    //! 完整重建整棵树，代理id不变
+    void rebuild();
+
+    /*!
+     * 视锥剔除，输出与视锥相交的代理的userData，顺序不确定
+     * @return 可见的代理数
+     */
+    size_t cull(const Frustum &frustum, std::vector<uint32_t> &outVisible) const;
+
+    inline uint32_t getUserData(ProxyId proxy) const {
+        return nodes_[proxies_[proxy]].userData;
+    }
+
+    //! 树中保存的扩大后的包围盒
+    inline const Aabb &getFatBounds(ProxyId proxy) const {
+        return nodes_[proxies_[proxy]].box;
+    }
+
+    inline size_t getProxyCount() const {
+        return proxies_.size() - freeProxies_.size();
+    }
+
+    //! 所有内部节点表面积之和，越小树的质量越好
+    inline double getCost() const {
+        return internalArea_;
+    }
+
+    //! 树的深度，只有根节点时为1，用于诊断
+    size_t computeHeight() const;
+
+private:
+    static constexpr uint32_t kNull = 0xFFFFFFFFu;
+
+    struct Node {
+        Aabb box;               // 叶子为扩大后的包围盒，内部节点为两个子节点的并
+        uint32_t parent;
+        uint32_t children[2];   // 叶子的children[0]为kNull，children[1]为代理id
+        uint32_t userData;
+
+        inline bool isLeaf() const { return children[0] == kNull; }
+
+        inline ProxyId proxy() const { return children[1]; }
+    };
+
+    uint32_t allocateNode();
+
+    void freeNode(uint32_t node);
+
+    //! 设置内部节点的包围盒并维护表面积之和
+    void setInternalBox(uint32_t node, const Aabb &box);
+
+    //! 从 @a node 开始向上重新计算内部节点的包围盒
+    void refit(uint32_t node);
+
+    void insertLeaf(uint32_t leaf);
+
+    void removeLeaf(uint32_t leaf);
+
+    /*!
+     * 把 @a leaves 的 [begin, end) 构建成子树，按深度优先顺序追加到 @a outNodes
+     * @return 子树的根在 @a outNodes 中的下标
+     */
+    uint32_t buildRange(std::vector<Node> &leaves, size_t begin, size_t end, uint32_t parent,
+                        std::vector<Node> &outNodes);
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;
+    std::vector<uint32_t> proxies_;      // 代理id到叶子节点下标，销毁的代理为kNull
+    std::vector<uint32_t> freeProxies_;
+    std::vector<Aabb> tightBounds_;      // 按代理id存放的原始包围盒，最终判断时使用
+    std::vector<uint8_t> dirty_;         // 按代理id标记：移动过，等待重新插入
+    std::vector<ProxyId> dirtyProxies_;
+    uint32_t root_ = kNull;
+    float margin_;
+    double internalArea_ = 0.0; // 内部节点表面积之和
+    double builtArea_ = 0.0;    // 上次完整重建后的表面积之和
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_BOUNDINGVOLUMEHIERARCHY_H
@@ -0,0 +1,185 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 从列主序矩阵的第row行与第3行组合出一个平面：sign为+1或-1
+Vec4 extractPlane(const Mat4 &m, int row, float sign) {
+    Vec4 plane = {
+            m.m[3] + sign * m.m[row],
+            m.m[7] + sign * m.m[4 + row],
+            m.m[11] + sign * m.m[8 + row],
+            m.m[15] + sign * m.m[12 + row]};
+    float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    if (length > 0.f) {
+        plane.x /= length;
+        plane.y /= length;
+        plane.z /= length;
+        plane.w /= length;
+    }
+    return plane;
+}
+
+#if VECMATH_SSE
+
+using F4 = __m128;
+
+inline F4 load(const float *p) { return _mm_load_ps(p); }
+inline F4 set1(float v) { return _mm_set1_ps(v); }
+inline F4 add(F4 a, F4 b) { return _mm_add_ps(a, b); }
+inline F4 sub(F4 a, F4 b) { return _mm_sub_ps(a, b); }
+inline F4 mul(F4 a, F4 b) { return _mm_mul_ps(a, b); }
+inline F4 abs4(F4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+// 各通道小于0时对应位为1
+inline int negativeBits(F4 a) { return _mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps())); }
+
+#elif VECMATH_NEON
+
+using F4 = float32x4_t;
+
+inline F4 load(const float *p) { return vld1q_f32(p); }
+inline F4 set1(float v) { return vdupq_n_f32(v); }
+inline F4 add(F4 a, F4 b) { return vaddq_f32(a, b); }
+inline F4 sub(F4 a, F4 b) { return vsubq_f32(a, b); }
+inline F4 mul(F4 a, F4 b) { return vmulq_f32(a, b); }
+inline F4 abs4(F4 a) { return vabsq_f32(a); }
+inline int negativeBits(F4 a) {
+    static const int32_t kShifts[4] = {-31, -30, -29, -28};
+    uint32x4_t bits = vshlq_u32(vcltq_f32(a, vdupq_n_f32(0.f)), vld1q_s32(kShifts));
+    return int(vaddvq_u32(bits));
+}
+
+#endif
+
+} // namespace
+
+Aabb Aabb::empty() {
+    return Aabb{
+            Vec3{INFINITY, INFINITY, INFINITY, 0.f},
+            Vec3{-INFINITY, -INFINITY, -INFINITY, 0.f}};
+}
+
+Aabb Aabb::fromVertices(const std::vector<Vertex> &vertices) {
+    Aabb box = empty();
+    for (const Vertex &vertex: vertices) {
+        const Vector3 &p = vertex.position;
+        box.min = Vec3{std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z), 0.f};
+        box.max = Vec3{std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z), 0.f};
+    }
+    return box;
+}
+
+Aabb Aabb::fromStreams(const VertexStreams &streams) {
+    Aabb box = empty();
+    for (size_t i = 0; i < streams.count; i++) {
+        Vector3 p = streams.fetchPosition(i);
+        box.min = Vec3{std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z), 0.f};
+        box.max = Vec3{std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z), 0.f};
+    }
+    return box;
+}
+
+Aabb expand(const Aabb &box, float margin) {
+    return Aabb{
+            Vec3{box.min.x - margin, box.min.y - margin, box.min.z - margin, 0.f},
+            Vec3{box.max.x + margin, box.max.y + margin, box.max.z + margin, 0.f}};
+}
+
+Aabb transformAabb(const Aabb &box, const Mat4 &matrix) {
+    if (box.isEmpty()) {
+        return box;
+    }
+    float center[3] = {
+            (box.min.x + box.max.x) * 0.5f,
+            (box.min.y + box.max.y) * 0.5f,
+            (box.min.z + box.max.z) * 0.5f};
+    float extent[3] = {
+            (box.max.x - box.min.x) * 0.5f,
+            (box.max.y - box.min.y) * 0.5f,
+            (box.max.z - box.min.z) * 0.5f};
+    float newCenter[3];
+    float newExtent[3];
+    for (int row = 0; row < 3; row++) {
+        newCenter[row] = matrix.m[12 + row];
+        newExtent[row] = 0.f;
+        for (int col = 0; col < 3; col++) {
+            float element = matrix.m[col * 4 + row];
+            newCenter[row] += element * center[col];
+            newExtent[row] += std::fabs(element) * extent[col];
+        }
+    }
+    return Aabb{
+            Vec3{newCenter[0] - newExtent[0], newCenter[1] - newExtent[1], newCenter[2] - newExtent[2], 0.f},
+            Vec3{newCenter[0] + newExtent[0], newCenter[1] + newExtent[1], newCenter[2] + newExtent[2], 0.f}};
+}
+
+Frustum Frustum::fromMatrix(const Mat4 &clip) {
+    Frustum frustum;
+    frustum.planes[0] = extractPlane(clip, 0, 1.f);  // 左
+    frustum.planes[1] = extractPlane(clip, 0, -1.f); // 右
+    frustum.planes[2] = extractPlane(clip, 1, 1.f);  // 下
+    frustum.planes[3] = extractPlane(clip, 1, -1.f); // 上
+    frustum.planes[4] = extractPlane(clip, 2, 1.f);  // 近
+    frustum.planes[5] = extractPlane(clip, 2, -1.f); // 远
+    for (int i = 0; i < 8; i++) {
+        // 补齐的平面法线为0、偏移为正，任何点都在它内侧
+        Vec4 plane = i < 6 ? frustum.planes[i] : Vec4{0.f, 0.f, 0.f, 1.f};
+        frustum.planeX[i] = plane.x;
+        frustum.planeY[i] = plane.y;
+        frustum.planeZ[i] = plane.z;
+        frustum.planeW[i] = plane.w;
+    }
+    return frustum;
+}
+
+Containment Frustum::classify(const Aabb &box) const {
+#if VECMATH_SSE || VECMATH_NEON
+    F4 half = set1(0.5f);
+    F4 cx = set1((box.min.x + box.max.x) * 0.5f);
+    F4 cy = set1((box.min.y + box.max.y) * 0.5f);
+    F4 cz = set1((box.min.z + box.max.z) * 0.5f);
+    F4 ex = mul(sub(set1(box.max.x), set1(box.min.x)), half);
+    F4 ey = mul(sub(set1(box.max.y), set1(box.min.y)), half);
+    F4 ez = mul(sub(set1(box.max.z), set1(box.min.z)), half);
+
+    int outside = 0;
+    int intersecting = 0;
+    for (int group = 0; group < 8; group += 4) {
+        F4 px = load(planeX + group);
+        F4 py = load(planeY + group);
+        F4 pz = load(planeZ + group);
+        // 中心到平面的距离，以及盒在平面法线上投影的半径
+        F4 distance = add(add(mul(px, cx), mul(py, cy)), add(mul(pz, cz), load(planeW + group)));
+        F4 radius = add(add(mul(abs4(px), ex), mul(abs4(py), ey)), mul(abs4(pz), ez));
+        outside |= negativeBits(add(distance, radius));
+        intersecting |= negativeBits(sub(distance, radius));
+    }
+    if (outside) {
+        return Containment::Outside;
+    }
+    return intersecting ? Containment::Intersecting : Containment::Inside;
+#else
+    return classifyScalar(box);
+#endif
+}
+
+Containment Frustum::classifyScalar(const Aabb &box) const {
+    float cx = (box.min.x + box.max.x) * 0.5f;
+    float cy = (box.min.y + box.max.y) * 0.5f;
+    float cz = (box.min.z + box.max.z) * 0.5f;
+    float ex = (box.max.x - box.min.x) * 0.5f;
+    float ey = (box.max.y - box.min.y) * 0.5f;
+    float ez = (box.max.z - box.min.z) * 0.5f;
+    bool intersecting = false;
+    for (int i = 0; i < 8; i++) {
+        float distance = (planeX[i] * cx + planeY[i] * cy) + (planeZ[i] * cz + planeW[i]);
+        float radius = (std::fabs(planeX[i]) * ex + std::fabs(planeY[i]) * ey) + std::fabs(planeZ[i]) * ez;
+        if (distance + radius < 0.f) {
+            return Containment::Outside;
+        }
+        intersecting |= distance - radius < 0.f;
+    }
+    return intersecting ? Containment::Intersecting : Containment::Inside;
+}
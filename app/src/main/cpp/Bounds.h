@@ -0,0 +1,93 @@
+#ifndef ANDROIDGLINVESTIGATIONS_BOUNDS_H
+#define ANDROIDGLINVESTIGATIONS_BOUNDS_H
+
+#include <algorithm>
+#include <vector>
+
+#include "VecMath.h"
+#include "VertexFormat.h"
+
+/*!
+ * 轴对齐包围盒。min的某个分量大于max时表示空盒
+ */
+struct Aabb {
+    Vec3 min;
+    Vec3 max;
+
+    //! 空盒，与任何盒合并后得到那个盒
+    static Aabb empty();
+
+    //! 顶点位置的包围盒
+    static Aabb fromVertices(const std::vector<Vertex> &vertices);
+
+    //! 外部顶点流中位置的包围盒
+    static Aabb fromStreams(const VertexStreams &streams);
+
+    inline bool isEmpty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    inline bool contains(const Aabb &other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+               && max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    //! 表面积，用于表面积启发式（SAH）
+    inline float surfaceArea() const {
+        float dx = max.x - min.x, dy = max.y - min.y, dz = max.z - min.z;
+        return 2.f * (dx * dy + dy * dz + dz * dx);
+    }
+};
+
+//! 两个盒的并
+inline Aabb merge(const Aabb &a, const Aabb &b) {
+    return Aabb{
+            Vec3{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z), 0.f},
+            Vec3{std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z), 0.f}};
+}
+
+//! 每个方向向外扩大 @a margin
+Aabb expand(const Aabb &box, float margin);
+
+/*!
+ * 变换后的包围盒（Arvo的方法）：中心按矩阵变换，半长取矩阵元素绝对值加权。
+ * 结果包住变换后的原盒，但对旋转来说不是最紧的
+ */
+Aabb transformAabb(const Aabb &box, const Mat4 &matrix);
+
+//! 包围盒与视锥的关系
+enum class Containment {
+    Outside,
+    Intersecting,
+    Inside,
+};
+
+/*!
+ * 由裁剪矩阵提取的六个平面。平面法线已归一化并指向视锥内部
+ */
+struct Frustum {
+    Vec4 planes[6]; // 左、右、下、上、近、远
+
+    // 按分量存放的平面，补齐到8个，补齐的平面总是包含整个空间
+    alignas(16) float planeX[8];
+    alignas(16) float planeY[8];
+    alignas(16) float planeZ[8];
+    alignas(16) float planeW[8];
+
+    /*!
+     * Gribb-Hartmann方法提取平面。传入投影*视图矩阵得到世界空间的视锥，
+     * 再乘上模型矩阵得到物体空间的视锥
+     * @param clip 列主序的裁剪矩阵
+     */
+    static Frustum fromMatrix(const Mat4 &clip);
+
+    /*!
+     * 包围盒与视锥的关系。只按平面判断，个别在视锥角落外侧的盒会被当作相交，结果是保守的
+     */
+    Containment classify(const Aabb &box) const;
+
+    //! 标量参考实现，与 @a classify 结果一致
+    Containment classifyScalar(const Aabb &box) const;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_BOUNDS_H
@@ -0,0 +1,179 @@
+#include "Checksum.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "VecMath.h"
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CHECKSUM_ARM_CRC 1
+#endif
+
+// Adler-32的向量实现：pmaddubsw需要SSSE3
+#if VECMATH_SSE && defined(__SSSE3__)
+#include <tmmintrin.h>
+#define CHECKSUM_ADLER_SSSE3 1
+#elif VECMATH_NEON
+#define CHECKSUM_ADLER_NEON 1
+#endif
+
+namespace {
+
+#if !CHECKSUM_ARM_CRC
+constexpr uint32_t kPolynomial = 0xEDB88320u; // 反转后的IEEE多项式
+
+// 8张表：tables[k][b]是字节b后面再跟k个0字节的CRC，一次可以合并8个字节
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+CrcTables makeTables() {
+    CrcTables tables{};
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1u)));
+        }
+        tables[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; b++) {
+        for (size_t k = 1; k < 8; k++) {
+            uint32_t previous = tables[k - 1][b];
+            tables[k][b] = (previous >> 8) ^ tables[0][previous & 0xFFu];
+        }
+    }
+    return tables;
+}
+#endif
+
+} // namespace
+
+uint32_t Checksum::crc32(const void *data, size_t size, uint32_t crc) {
+    auto *bytes = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+#if CHECKSUM_ARM_CRC
+    for (; size >= 8; size -= 8, bytes += 8) {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    for (; size > 0; size--) {
+        crc = __crc32b(crc, *bytes++);
+    }
+#else
+    static const CrcTables kTables = makeTables();
+    for (; size >= 8; size -= 8, bytes += 8) {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, bytes, sizeof(low));
+        memcpy(&high, bytes + 4, sizeof(high));
+        low ^= crc;
+        crc = kTables[7][low & 0xFFu] ^ kTables[6][(low >> 8) & 0xFFu]
+              ^ kTables[5][(low >> 16) & 0xFFu] ^ kTables[4][low >> 24]
+              ^ kTables[3][high & 0xFFu] ^ kTables[2][(high >> 8) & 0xFFu]
+              ^ kTables[1][(high >> 16) & 0xFFu] ^ kTables[0][high >> 24];
+    }
+    for (; size > 0; size--) {
+        crc = (crc >> 8) ^ kTables[0][(crc ^ *bytes++) & 0xFFu];
+    }
+#endif
+    return ~crc;
+}
+
+uint32_t Checksum::adler32(const void *data, size_t size, uint32_t adler) {
+    constexpr uint32_t kBase = 65521;
+    // s2在取模前不溢出32位的最大字节数
+    constexpr size_t kMaxRun = 5552;
+    auto *bytes = static_cast<const uint8_t *>(data);
+    uint32_t s1 = adler & 0xFFFFu;
+    uint32_t s2 = adler >> 16;
+#if CHECKSUM_ADLER_SSSE3 || CHECKSUM_ADLER_NEON
+    // 每次处理32字节：s1加上各字节之和，s2加上32*s1再加上各字节乘以32..1的权重
+    constexpr size_t kBlock = 32;
+    size_t blocks = size / kBlock;
+    size -= blocks * kBlock;
+    while (blocks > 0) {
+        size_t n = std::min(blocks, kMaxRun / kBlock);
+        blocks -= n;
+#if CHECKSUM_ADLER_SSSE3
+        const __m128i weightsHigh = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+        const __m128i weightsLow = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi16(1);
+        // previous累计每块开始时的s1，最后乘32加到s2
+        __m128i previous = _mm_set_epi32(0, 0, 0, int32_t(s1 * n));
+        __m128i sum2 = _mm_set_epi32(0, 0, 0, int32_t(s2));
+        __m128i sum1 = zero;
+        for (size_t i = 0; i < n; i++, bytes += kBlock) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + 16));
+            previous = _mm_add_epi32(previous, sum1);
+            sum1 = _mm_add_epi32(sum1, _mm_add_epi32(_mm_sad_epu8(a, zero), _mm_sad_epu8(b, zero)));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_maddubs_epi16(a, weightsHigh), ones));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_maddubs_epi16(b, weightsLow), ones));
+        }
+        sum2 = _mm_add_epi32(sum2, _mm_slli_epi32(previous, 5));
+        sum1 = _mm_add_epi32(sum1, _mm_shuffle_epi32(sum1, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum2 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum2 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += uint32_t(_mm_cvtsi128_si32(sum1));
+        s2 = uint32_t(_mm_cvtsi128_si32(sum2));
+#else
+        static const uint16_t kWeights[32] = {32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                              16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+        uint32x4_t sum2 = vsetq_lane_u32(s1 * uint32_t(n), vdupq_n_u32(0), 0);
+        uint32x4_t sum1 = vdupq_n_u32(0);
+        // 每一列的字节和，n不超过173块，不会超出16位
+        uint16x8_t columns[4] = {vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0)};
+        for (size_t i = 0; i < n; i++, bytes += kBlock) {
+            uint8x16_t a = vld1q_u8(bytes);
+            uint8x16_t b = vld1q_u8(bytes + 16);
+            sum2 = vaddq_u32(sum2, sum1);
+            sum1 = vpadalq_u16(sum1, vpadalq_u8(vpaddlq_u8(a), b));
+            columns[0] = vaddw_u8(columns[0], vget_low_u8(a));
+            columns[1] = vaddw_u8(columns[1], vget_high_u8(a));
+            columns[2] = vaddw_u8(columns[2], vget_low_u8(b));
+            columns[3] = vaddw_u8(columns[3], vget_high_u8(b));
+        }
+        sum2 = vshlq_n_u32(sum2, 5);
+        for (int c = 0; c < 4; c++) {
+            sum2 = vmlal_u16(sum2, vget_low_u16(columns[c]), vld1_u16(kWeights + c * 8));
+            sum2 = vmlal_u16(sum2, vget_high_u16(columns[c]), vld1_u16(kWeights + c * 8 + 4));
+        }
+        s1 += vaddvq_u32(sum1);
+        s2 += vaddvq_u32(sum2);
+#endif
+        s1 %= kBase;
+        s2 %= kBase;
+    }
+#endif
+    while (size > 0) {
+        size_t run = std::min(size, kMaxRun);
+        size -= run;
+        for (; run >= 8; run -= 8, bytes += 8) {
+            s1 += bytes[0];
+            s2 += s1;
+            s1 += bytes[1];
+            s2 += s1;
+            s1 += bytes[2];
+            s2 += s1;
+            s1 += bytes[3];
+            s2 += s1;
+            s1 += bytes[4];
+            s2 += s1;
+            s1 += bytes[5];
+            s2 += s1;
+            s1 += bytes[6];
+            s2 += s1;
+            s1 += bytes[7];
+            s2 += s1;
+        }
+        for (; run > 0; run--) {
+            s1 += *bytes++;
+            s2 += s1;
+        }
+        s1 %= kBase;
+        s2 %= kBase;
+    }
+    return s1 | (s2 << 16);
+}
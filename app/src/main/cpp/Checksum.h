@@ -0,0 +1,26 @@
+#ifndef ANDROIDGLINVESTIGATIONS_CHECKSUM_H
+#define ANDROIDGLINVESTIGATIONS_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * 校验和
+ */
+class Checksum {
+public:
+    /*!
+     * CRC-32（IEEE 802.3，与zlib相同）。支持CRC指令的ARM64上使用硬件指令，其他平台用查表法每次处理8字节
+     * @param crc 上一段数据的结果，用于分段计算；从头开始时为0
+     */
+    static uint32_t crc32(const void *data, size_t size, uint32_t crc = 0);
+
+    /*!
+     * Adler-32（zlib流末尾的校验和）。每5552字节才取一次模，中间只做加法；
+     * SSSE3/NEON每次处理32字节，字节和与加权和分别累加
+     * @param adler 上一段数据的结果，用于分段计算；从头开始时为1
+     */
+    static uint32_t adler32(const void *data, size_t size, uint32_t adler = 1);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_CHECKSUM_H
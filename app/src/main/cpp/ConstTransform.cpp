@@ -0,0 +1,95 @@
+#include "ConstTransform.h"
+
+#include "Log.h"
+
+// ---------------------------------------------------------------------------
+// 编译期检查：这些断言失败时编译直接报错
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr bool nearlyEqual(double a, double b, double tolerance) {
+    return (a - b) <= tolerance && (b - a) <= tolerance;
+}
+
+// 三角函数在特殊角上的取值
+static_assert(nearlyEqual(ConstTransform::sin(0.0), 0.0, 1e-12), "sin(0)");
+static_assert(nearlyEqual(ConstTransform::sin(ConstTransform::kPi / 6), 0.5, 1e-12), "sin(30°)");
+static_assert(nearlyEqual(ConstTransform::sin(ConstTransform::kPi / 2), 1.0, 1e-12), "sin(90°)");
+static_assert(nearlyEqual(ConstTransform::cos(ConstTransform::kPi / 3), 0.5, 1e-12), "cos(60°)");
+static_assert(nearlyEqual(ConstTransform::cos(ConstTransform::kPi), -1.0, 1e-12), "cos(180°)");
+static_assert(nearlyEqual(ConstTransform::sin(-ConstTransform::kPi / 4), -0.70710678118654752, 1e-12),
+              "sin(-45°)");
+// 大角度依赖折叠到[-π, π]
+static_assert(nearlyEqual(ConstTransform::sin(ConstTransform::kPi * 20.5), 1.0, 1e-9), "sin(20.5π)");
+static_assert(nearlyEqual(ConstTransform::cos(-ConstTransform::kPi * 7), -1.0, 1e-9), "cos(-7π)");
+
+constexpr Mat4 kIdentity = ConstTransform::identity();
+static_assert(kIdentity(0, 0) == 1.f && kIdentity(1, 1) == 1.f && kIdentity(2, 2) == 1.f
+              && kIdentity(3, 3) == 1.f && kIdentity(1, 0) == 0.f && kIdentity(0, 3) == 0.f,
+              "identity");
+
+// 与Renderer使用的投影参数相同：半高2，近平面-1，远平面1
+constexpr Mat4 kOrtho = ConstTransform::orthographic(2.f, 2.f, -1.f, 1.f);
+static_assert(kOrtho(0, 0) == 0.25f && kOrtho(1, 1) == 0.5f && kOrtho(2, 2) == -1.f
+              && kOrtho(2, 3) == 0.f && kOrtho(3, 3) == 1.f, "orthographic");
+
+constexpr Mat4 kTranslation = ConstTransform::translation(1.f, 2.f, 3.f);
+static_assert(kTranslation(0, 3) == 1.f && kTranslation(1, 3) == 2.f && kTranslation(2, 3) == 3.f,
+              "translation");
+
+// 平移后再缩放等价于直接构造的矩阵
+static_assert(ConstTransform::nearlyEqual(
+        ConstTransform::multiply(kTranslation, ConstTransform::scale(2.f, 2.f, 2.f)),
+        Mat4{{2.f, 0.f, 0.f, 0.f,
+              0.f, 2.f, 0.f, 0.f,
+              0.f, 0.f, 2.f, 0.f,
+              1.f, 2.f, 3.f, 1.f}}, 0.f), "translation * scale");
+
+// 绕Z轴旋转90度把x轴转到y轴
+constexpr Mat4 kRotationZ90 = ConstTransform::rotationZDegrees(90.f);
+static_assert(nearlyEqual(kRotationZ90(1, 0), 1.0, 1e-7) && nearlyEqual(kRotationZ90(0, 0), 0.0, 1e-7),
+              "rotationZ");
+
+// 欧拉角只有Z分量时与绕Z轴的反向旋转相同（见 Mat4::rotationEulerDegrees 的约定）
+static_assert(ConstTransform::nearlyEqual(
+        ConstTransform::rotationEulerDegrees(0.f, 0.f, -90.f), kRotationZ90, 1e-7f), "euler z");
+
+// 旋转矩阵乘以其转置应为单位矩阵
+constexpr Mat4 kEuler = ConstTransform::rotationEulerDegrees(30.f, 45.f, 60.f);
+constexpr Mat4 kEulerTransposed = {{
+        kEuler.m[0], kEuler.m[4], kEuler.m[8], kEuler.m[12],
+        kEuler.m[1], kEuler.m[5], kEuler.m[9], kEuler.m[13],
+        kEuler.m[2], kEuler.m[6], kEuler.m[10], kEuler.m[14],
+        kEuler.m[3], kEuler.m[7], kEuler.m[11], kEuler.m[15]}};
+static_assert(ConstTransform::nearlyEqual(
+        ConstTransform::multiply(kEuler, kEulerTransposed), kIdentity, 1e-6f), "euler orthonormal");
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// 运行期检查：与Mat4的运行期构造函数比较
+// ---------------------------------------------------------------------------
+
+bool ConstTransform::verifyAgainstRuntime() {
+    constexpr float kTolerance = 1e-6f;
+    bool ok = true;
+    auto check = [&ok](const char *name, const Mat4 &baked, const Mat4 &runtime) {
+        if (!nearlyEqual(baked, runtime, kTolerance)) {
+            LOGE("编译期矩阵 %s 与运行期结果不一致", name);
+            ok = false;
+        }
+    };
+
+    check("identity", kIdentity, Mat4::identity());
+    check("orthographic", kOrtho, Mat4::orthographic(2.f, 2.f, -1.f, 1.f));
+    check("translation", kTranslation, Mat4::translation(1.f, 2.f, 3.f));
+    check("scale", scale(0.5f, 2.f, 3.f), Mat4::scale(0.5f, 2.f, 3.f));
+    for (int angle = -720; angle <= 720; angle += 15) {
+        check("rotationZ", rotationZDegrees(float(angle)),
+              Mat4::rotationZ(float(angle) * float(kPi / 180.0)));
+        check("rotationEuler", rotationEulerDegrees(float(angle), float(angle) * 0.5f, 17.f),
+              Mat4::rotationEulerDegrees(float(angle), float(angle) * 0.5f, 17.f));
+    }
+    return ok;
+}
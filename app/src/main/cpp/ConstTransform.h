@@ -0,0 +1,160 @@
+#ifndef ANDROIDGLINVESTIGATIONS_CONSTTRANSFORM_H
+#define ANDROIDGLINVESTIGATIONS_CONSTTRANSFORM_H
+
+#include "VecMath.h"
+
+/*!
+ * 可以在编译期求值的变换矩阵构造函数。
+ *
+ * 参数全部是常量时，结果在编译期算好并直接放进二进制文件，运行期没有任何计算。
+ * 三角函数用double精度的泰勒多项式实现，在[-π/2, π/2]上的截断误差小于1e-11，
+ * 转成float后与<cmath>的结果最多相差1个ulp。
+ * 结果与 @a Mat4 的运行期构造函数一致，见 ConstTransform.cpp 中的检查。
+ */
+class ConstTransform {
+public:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    //! 编译期正弦，参数为弧度
+    static constexpr double sin(double x) {
+        x = wrapToPi(x);
+        // 利用 sin(π - x) = sin(x) 把参数折叠到[-π/2, π/2]
+        if (x > kPi / 2) {
+            x = kPi - x;
+        } else if (x < -kPi / 2) {
+            x = -kPi - x;
+        }
+        // 泰勒级数展开到x^17
+        double x2 = x * x;
+        double term = x;
+        double sum = x;
+        for (int n = 1; n <= 8; n++) {
+            term *= -x2 / double((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    //! 编译期余弦，参数为弧度
+    static constexpr double cos(double x) {
+        return sin(x + kPi / 2);
+    }
+
+    static constexpr Mat4 identity() {
+        Mat4 result{};
+        result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.f;
+        return result;
+    }
+
+    static constexpr Mat4 orthographic(float halfHeight, float aspect, float near, float far) {
+        float halfWidth = halfHeight * aspect;
+        Mat4 result{};
+        result.m[0] = 1.f / halfWidth;
+        result.m[5] = 1.f / halfHeight;
+        result.m[10] = -2.f / (far - near);
+        result.m[14] = -(far + near) / (far - near);
+        result.m[15] = 1.f;
+        return result;
+    }
+
+    static constexpr Mat4 translation(float x, float y, float z) {
+        Mat4 result = identity();
+        result.m[12] = x;
+        result.m[13] = y;
+        result.m[14] = z;
+        return result;
+    }
+
+    static constexpr Mat4 scale(float x, float y, float z) {
+        Mat4 result{};
+        result.m[0] = x;
+        result.m[5] = y;
+        result.m[10] = z;
+        result.m[15] = 1.f;
+        return result;
+    }
+
+    //! 绕Z轴旋转，角度以度为单位，与 Mat4::rotationZ 一致
+    static constexpr Mat4 rotationZDegrees(float angleDegrees) {
+        double radians = angleDegrees * (kPi / 180.0);
+        float c = float(cos(radians));
+        float s = float(sin(radians));
+        Mat4 result = identity();
+        result.m[0] = c;
+        result.m[1] = s;
+        result.m[4] = -s;
+        result.m[5] = c;
+        return result;
+    }
+
+    //! 与 Mat4::rotationEulerDegrees 和 Utility::buildRotationMatrix3D 相同约定的欧拉角旋转
+    static constexpr Mat4 rotationEulerDegrees(
+            float angleXDegrees,
+            float angleYDegrees,
+            float angleZDegrees) {
+        float cx = float(cos(angleXDegrees * (kPi / 180.0)));
+        float sx = float(sin(angleXDegrees * (kPi / 180.0)));
+        float cy = float(cos(angleYDegrees * (kPi / 180.0)));
+        float sy = float(sin(angleYDegrees * (kPi / 180.0)));
+        float cz = float(cos(angleZDegrees * (kPi / 180.0)));
+        float sz = float(sin(angleZDegrees * (kPi / 180.0)));
+
+        Mat4 result{};
+        result.m[0] = cy * cz - sy * sx * sz;
+        result.m[1] = -cx * sz;
+        result.m[2] = sy * cz + cy * sx * sz;
+
+        result.m[4] = cy * sz + sy * sx * cz;
+        result.m[5] = cx * cz;
+        result.m[6] = sy * sz - cy * sx * cz;
+
+        result.m[8] = -sy * cx;
+        result.m[9] = sx;
+        result.m[10] = cy * cx;
+
+        result.m[15] = 1.f;
+        return result;
+    }
+
+    //! 编译期矩阵乘法，运算顺序与 multiplyScalar 相同
+    static constexpr Mat4 multiply(const Mat4 &a, const Mat4 &b) {
+        Mat4 result{};
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+                float r = a.m[row] * b.m[col * 4];
+                r = r + a.m[4 + row] * b.m[col * 4 + 1];
+                r = r + a.m[8 + row] * b.m[col * 4 + 2];
+                r = r + a.m[12 + row] * b.m[col * 4 + 3];
+                result.m[col * 4 + row] = r;
+            }
+        }
+        return result;
+    }
+
+    //! 两个矩阵的所有元素之差都不超过tolerance时返回true
+    static constexpr bool nearlyEqual(const Mat4 &a, const Mat4 &b, float tolerance) {
+        for (int i = 0; i < 16; i++) {
+            float diff = a.m[i] - b.m[i];
+            if (diff > tolerance || diff < -tolerance) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*!
+     * 在运行期把编译期构造函数与 @a Mat4 的运行期版本逐一比较，供调试版本在启动时调用
+     * @return 全部一致时返回true
+     */
+    static bool verifyAgainstRuntime();
+
+private:
+    // 把任意弧度折叠到[-π, π]
+    static constexpr double wrapToPi(double x) {
+        double turns = x / (2 * kPi);
+        auto whole = static_cast<long long>(turns >= 0 ? turns + 0.5 : turns - 0.5);
+        return x - double(whole) * (2 * kPi);
+    }
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_CONSTTRANSFORM_H
@@ -0,0 +1,229 @@
+#include "Etc2Decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// ETC1/ETC2独立和差分模式的亮度修正表，像素索引0..3依次是 +a, +b, -a, -b
+const int kModifiers[8][2] = {
+        {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+// T和H模式的距离表
+const int kDistances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+const int kAlphaModifiers[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14},
+        {-3, -7, -10, -13, 2, 6, 9, 12},
+        {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12},
+        {-3, -6, -8, -12, 2, 5, 7, 11},
+        {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10},
+        {-3, -5, -8, -11, 2, 4, 7, 10},
+        {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},
+        {-2, -4, -8, -10, 1, 3, 7, 9},
+        {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},
+        {-1, -2, -3, -10, 0, 1, 2, 9},
+        {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+inline uint64_t readBigEndian64(const uint8_t *p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline uint32_t bits(uint64_t value, int high, int low) {
+    return uint32_t((value >> low) & ((uint64_t(1) << (high - low + 1)) - 1));
+}
+
+inline uint8_t clamp255(int value) {
+    return uint8_t(std::min(255, std::max(0, value)));
+}
+
+inline int extend4(uint32_t value) { return int((value << 4) | value); }
+
+inline int extend5(uint32_t value) { return int((value << 3) | (value >> 2)); }
+
+inline int extend6(uint32_t value) { return int((value << 2) | (value >> 4)); }
+
+inline int extend7(uint32_t value) { return int((value << 1) | (value >> 6)); }
+
+// 像素(x, y)的2位索引：高位在31..16，低位在15..0，按列优先编号
+inline int pixelIndex(uint64_t block, int x, int y) {
+    int bit = x * 4 + y;
+    return int(((block >> (bit + 16)) & 1) << 1 | ((block >> bit) & 1));
+}
+
+inline void writePixel(uint8_t *rgba, size_t stride, int x, int y, int r, int g, int b) {
+    uint8_t *p = rgba + y * stride + x * 4;
+    p[0] = clamp255(r);
+    p[1] = clamp255(g);
+    p[2] = clamp255(b);
+    p[3] = 255;
+}
+
+void decodeIndividualOrDifferential(uint64_t block, bool differential, uint8_t *rgba, size_t stride) {
+    int base[2][3];
+    if (differential) {
+        for (int c = 0; c < 3; c++) {
+            int high = 63 - c * 8;
+            uint32_t value = bits(block, high, high - 4);
+            int delta = int(bits(block, high - 5, high - 7) << 29) >> 29;
+            base[0][c] = extend5(value);
+            base[1][c] = extend5(uint32_t(int(value) + delta));
+        }
+    } else {
+        for (int c = 0; c < 3; c++) {
+            int high = 63 - c * 8;
+            base[0][c] = extend4(bits(block, high, high - 3));
+            base[1][c] = extend4(bits(block, high - 4, high - 7));
+        }
+    }
+    int tables[2] = {int(bits(block, 39, 37)), int(bits(block, 36, 34))};
+    bool flip = (block >> 32) & 1;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            int sub = flip ? (y >= 2) : (x >= 2);
+            int index = pixelIndex(block, x, y);
+            int modifier = kModifiers[tables[sub]][index & 1];
+            if (index & 2) {
+                modifier = -modifier;
+            }
+            writePixel(rgba, stride, x, y, base[sub][0] + modifier, base[sub][1] + modifier,
+                       base[sub][2] + modifier);
+        }
+    }
+}
+
+void decodePaintColors(uint64_t block, const int paint[4][3], uint8_t *rgba, size_t stride) {
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const int *color = paint[pixelIndex(block, x, y)];
+            writePixel(rgba, stride, x, y, color[0], color[1], color[2]);
+        }
+    }
+}
+
+void decodeT(uint64_t block, uint8_t *rgba, size_t stride) {
+    int c1[3] = {extend4(bits(block, 60, 59) << 2 | bits(block, 57, 56)),
+                 extend4(bits(block, 55, 52)), extend4(bits(block, 51, 48))};
+    int c2[3] = {extend4(bits(block, 47, 44)), extend4(bits(block, 43, 40)), extend4(bits(block, 39, 36))};
+    int d = kDistances[bits(block, 35, 34) << 1 | bits(block, 32, 32)];
+    int paint[4][3];
+    for (int c = 0; c < 3; c++) {
+        paint[0][c] = c1[c];
+        paint[1][c] = std::min(255, c2[c] + d);
+        paint[2][c] = c2[c];
+        paint[3][c] = std::max(0, c2[c] - d);
+    }
+    decodePaintColors(block, paint, rgba, stride);
+}
+
+void decodeH(uint64_t block, uint8_t *rgba, size_t stride) {
+    uint32_t r1 = bits(block, 62, 59);
+    uint32_t g1 = bits(block, 58, 56) << 1 | bits(block, 52, 52);
+    uint32_t b1 = bits(block, 51, 51) << 3 | bits(block, 49, 47);
+    uint32_t r2 = bits(block, 46, 43);
+    uint32_t g2 = bits(block, 42, 39);
+    uint32_t b2 = bits(block, 38, 35);
+    // 距离索引的最低位由两个颜色的大小关系隐含
+    uint32_t order = (r1 << 8 | g1 << 4 | b1) >= (r2 << 8 | g2 << 4 | b2) ? 1 : 0;
+    int d = kDistances[bits(block, 34, 34) << 2 | bits(block, 32, 32) << 1 | order];
+    int c1[3] = {extend4(r1), extend4(g1), extend4(b1)};
+    int c2[3] = {extend4(r2), extend4(g2), extend4(b2)};
+    int paint[4][3];
+    for (int c = 0; c < 3; c++) {
+        paint[0][c] = std::min(255, c1[c] + d);
+        paint[1][c] = std::max(0, c1[c] - d);
+        paint[2][c] = std::min(255, c2[c] + d);
+        paint[3][c] = std::max(0, c2[c] - d);
+    }
+    decodePaintColors(block, paint, rgba, stride);
+}
+
+void decodePlanar(uint64_t block, uint8_t *rgba, size_t stride) {
+    int origin[3] = {extend6(bits(block, 62, 57)),
+                     extend7(bits(block, 56, 56) << 6 | bits(block, 54, 49)),
+                     extend6(bits(block, 48, 48) << 5 | bits(block, 44, 43) << 3 | bits(block, 41, 39))};
+    int horizontal[3] = {extend6(bits(block, 38, 34) << 1 | bits(block, 32, 32)),
+                         extend7(bits(block, 31, 25)), extend6(bits(block, 24, 19))};
+    int vertical[3] = {extend6(bits(block, 18, 13)), extend7(bits(block, 12, 6)), extend6(bits(block, 5, 0))};
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            int color[3];
+            for (int c = 0; c < 3; c++) {
+                color[c] = (x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+            }
+            writePixel(rgba, stride, x, y, color[0], color[1], color[2]);
+        }
+    }
+}
+
+} // namespace
+
+void Etc2Decoder::decodeRgbBlock(const uint8_t *data, uint8_t *rgba, size_t stride) {
+    uint64_t block = readBigEndian64(data);
+    if (!((block >> 33) & 1)) {
+        decodeIndividualOrDifferential(block, false, rgba, stride);
+        return;
+    }
+    // 差分模式下某个通道相加溢出时，依次表示T、H和平面模式
+    auto overflows = [block](int high) {
+        int value = int(bits(block, high, high - 4));
+        int delta = int(bits(block, high - 5, high - 7) << 29) >> 29;
+        return value + delta < 0 || value + delta > 31;
+    };
+    if (overflows(63)) {
+        decodeT(block, rgba, stride);
+    } else if (overflows(55)) {
+        decodeH(block, rgba, stride);
+    } else if (overflows(47)) {
+        decodePlanar(block, rgba, stride);
+    } else {
+        decodeIndividualOrDifferential(block, true, rgba, stride);
+    }
+}
+
+void Etc2Decoder::decodeAlphaBlock(const uint8_t *data, uint8_t *rgba, size_t stride) {
+    uint64_t block = readBigEndian64(data);
+    int base = int(bits(block, 63, 56));
+    int multiplier = int(bits(block, 55, 52));
+    const int *modifiers = kAlphaModifiers[bits(block, 51, 48)];
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            int shift = 45 - (x * 4 + y) * 3;
+            rgba[y * stride + x * 4 + 3] = clamp255(base + modifiers[(block >> shift) & 7] * multiplier);
+        }
+    }
+}
+
+void Etc2Decoder::decodeImage(const uint8_t *data, int32_t width, int32_t height, bool hasAlpha, uint8_t *rgba) {
+    size_t blockBytes = hasAlpha ? 16 : 8;
+    size_t stride = size_t(width) * 4;
+    uint8_t scratch[4 * 4 * 4];
+    for (int32_t by = 0; by < height; by += 4) {
+        for (int32_t bx = 0; bx < width; bx += 4, data += blockBytes) {
+            bool whole = bx + 4 <= width && by + 4 <= height;
+            uint8_t *target = whole ? rgba + size_t(by) * stride + size_t(bx) * 4 : scratch;
+            size_t targetStride = whole ? stride : 16;
+            decodeRgbBlock(data + (hasAlpha ? 8 : 0), target, targetStride);
+            if (hasAlpha) {
+                decodeAlphaBlock(data, target, targetStride);
+            }
+            if (!whole) {
+                // 图像边缘不满4x4的块，只复制图像内的部分
+                int32_t w = std::min(4, width - bx);
+                int32_t h = std::min(4, height - by);
+                for (int32_t y = 0; y < h; y++) {
+                    memcpy(rgba + size_t(by + y) * stride + size_t(bx) * 4, scratch + y * 16, size_t(w) * 4);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef ANDROIDGLINVESTIGATIONS_ETC2DECODER_H
+#define ANDROIDGLINVESTIGATIONS_ETC2DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * ETC2/EAC块的CPU解码器，GPU不能采样这些格式时用来转换成RGBA8。
+ *
+ * 颜色块支持ETC1的独立/差分模式和ETC2新增的T、H、平面模式；alpha块为EAC。
+ * 每个块是4x4像素，像素按列优先编号，块数据按大端序存放。
+ */
+class Etc2Decoder {
+public:
+    /*!
+     * 解码8字节的RGB块，alpha写为255
+     * @param rgba 块左上角像素
+     * @param stride 输出的行距（字节）
+     */
+    static void decodeRgbBlock(const uint8_t *block, uint8_t *rgba, size_t stride);
+
+    //! 解码8字节的EAC alpha块，只写每个像素的第4个字节
+    static void decodeAlphaBlock(const uint8_t *block, uint8_t *rgba, size_t stride);
+
+    /*!
+     * 解码整幅图像
+     * @param hasAlpha true时每块16字节（EAC alpha在前），否则每块8字节
+     * @param rgba 输出width * height * 4字节，右边和下边超出图像的像素被丢弃
+     */
+    static void decodeImage(const uint8_t *data, int32_t width, int32_t height, bool hasAlpha, uint8_t *rgba);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_ETC2DECODER_H
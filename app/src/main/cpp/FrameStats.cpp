@@ -0,0 +1,133 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Log.h"
+
+void FrameHistogram::add(uint64_t valueNs) {
+    size_t bucket = std::min<uint64_t>(valueNs / kBucketWidthNs, kBucketCount - 1);
+    buckets_[bucket]++;
+    count_++;
+    max_ = std::max(max_, valueNs);
+}
+
+void FrameHistogram::reset() {
+    buckets_.fill(0);
+    count_ = 0;
+    max_ = 0;
+}
+
+uint64_t FrameHistogram::percentile(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    // 需要覆盖的样本数，至少为1，这样p0返回第一个非空桶
+    auto target = std::max<uint64_t>(1, uint64_t(std::ceil(percentile / 100.0 * double(count_))));
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        accumulated += buckets_[i];
+        if (accumulated >= target) {
+            // 桶上界不应超过真实最大值
+            return std::min<uint64_t>((i + 1) * kBucketWidthNs, max_);
+        }
+    }
+    return max_;
+}
+
+FrameStats::FrameStats(Clock clock, uint64_t vsyncPeriodNs, uint64_t dumpIntervalNs)
+        : clock_(std::move(clock)),
+          vsyncPeriodNs_(vsyncPeriodNs),
+          dumpIntervalNs_(dumpIntervalNs) {
+    lastDumpNs_ = clock_();
+}
+
+void FrameStats::beginFrame() {
+    previousFrameBeginNs_ = frameBeginNs_;
+    frameBeginNs_ = clock_();
+}
+
+void FrameStats::beginSwap() {
+    swapBeginNs_ = clock_();
+}
+
+void FrameStats::endSwap() {
+    uint64_t now = clock_();
+    recordFrame(
+            swapBeginNs_ - frameBeginNs_,
+            now - swapBeginNs_,
+            previousFrameBeginNs_ ? frameBeginNs_ - previousFrameBeginNs_ : 0);
+}
+
+void FrameStats::recordFrame(uint64_t cpuTimeNs, uint64_t swapTimeNs, uint64_t intervalNs) {
+    cpuTime_.add(cpuTimeNs);
+    swapTime_.add(swapTimeNs);
+    if (intervalNs == 0 || vsyncPeriodNs_ == 0) {
+        return;
+    }
+
+    frameInterval_.add(intervalNs);
+
+    // 间隔超过1.5个周期视为卡顿，错过的垂直同步数按四舍五入后的周期数减一计算
+    if (intervalNs * 2 > vsyncPeriodNs_ * 3) {
+        jankFrames_++;
+        missedVsyncs_ += (intervalNs + vsyncPeriodNs_ / 2) / vsyncPeriodNs_ - 1;
+    }
+}
+
+FrameStats::Summary FrameStats::getSummary() const {
+    auto metric = [](const FrameHistogram &histogram) {
+        return Metric{
+                histogram.percentile(50),
+                histogram.percentile(90),
+                histogram.percentile(99),
+                histogram.getMax()};
+    };
+    return Summary{
+            cpuTime_.getCount(),
+            metric(cpuTime_),
+            metric(swapTime_),
+            metric(frameInterval_),
+            jankFrames_,
+            missedVsyncs_};
+}
+
+void FrameStats::reset() {
+    cpuTime_.reset();
+    swapTime_.reset();
+    frameInterval_.reset();
+    jankFrames_ = 0;
+    missedVsyncs_ = 0;
+}
+
+bool FrameStats::dumpIfDue() {
+    if (dumpIntervalNs_ == 0) {
+        return false;
+    }
+    uint64_t now = clock_();
+    if (now - lastDumpNs_ < dumpIntervalNs_) {
+        return false;
+    }
+    lastDumpNs_ = now;
+    logSummary(getSummary());
+    reset();
+    return true;
+}
+
+void FrameStats::logSummary(const Summary &summary) {
+    auto ms = [](uint64_t ns) { return double(ns) / 1e6; };
+    LOGI("帧统计: %llu 帧, 卡顿 %llu 帧, 错过垂直同步 %llu 次",
+         static_cast<unsigned long long>(summary.frameCount),
+         static_cast<unsigned long long>(summary.jankFrames),
+         static_cast<unsigned long long>(summary.missedVsyncs));
+    LOGI("  CPU帧时间 p50 %.2fms p90 %.2fms p99 %.2fms max %.2fms",
+         ms(summary.cpuTime.p50Ns), ms(summary.cpuTime.p90Ns),
+         ms(summary.cpuTime.p99Ns), ms(summary.cpuTime.maxNs));
+    LOGI("  交换时间 p50 %.2fms p90 %.2fms p99 %.2fms max %.2fms",
+         ms(summary.swapTime.p50Ns), ms(summary.swapTime.p90Ns),
+         ms(summary.swapTime.p99Ns), ms(summary.swapTime.maxNs));
+    LOGI("  帧间隔 p50 %.2fms p90 %.2fms p99 %.2fms max %.2fms",
+         ms(summary.frameInterval.p50Ns), ms(summary.frameInterval.p90Ns),
+         ms(summary.frameInterval.p99Ns), ms(summary.frameInterval.maxNs));
+}
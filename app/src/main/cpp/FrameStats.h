@@ -0,0 +1,132 @@
+#ifndef ANDROIDGLINVESTIGATIONS_FRAMESTATS_H
+#define ANDROIDGLINVESTIGATIONS_FRAMESTATS_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/*!
+ * 固定大小的耗时直方图。桶宽 @a kBucketWidthNs，超出范围的样本落在最后一个桶里，
+ * 但最大值单独精确记录。
+ */
+class FrameHistogram {
+public:
+    static constexpr uint64_t kBucketWidthNs = 250000; // 0.25毫秒
+    static constexpr size_t kBucketCount = 400;        // 覆盖0到100毫秒
+
+    void add(uint64_t valueNs);
+
+    void reset();
+
+    /*!
+     * @param percentile 0到100之间的百分位
+     * @return 该百分位所在桶的上界（纳秒），没有样本时返回0
+     */
+    uint64_t percentile(double percentile) const;
+
+    inline uint64_t getMax() const { return max_; }
+
+    inline uint64_t getCount() const { return count_; }
+
+    //! 第index个桶中的样本数
+    inline uint32_t getBucket(size_t index) const { return buckets_[index]; }
+
+private:
+    std::array<uint32_t, kBucketCount> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+/*!
+ * 帧耗时统计与卡顿检测。
+ *
+ * 每帧依次调用 beginFrame、beginSwap、endSwap，统计三项指标：
+ * CPU帧时间（beginFrame到beginSwap）、交换时间（beginSwap到endSwap）和
+ * 相邻两帧beginFrame之间的间隔。帧间隔超过垂直同步周期的1.5倍即视为错过了垂直同步。
+ *
+ * 时间来源通过构造参数注入，测试时可以传入合成时钟。
+ */
+class FrameStats {
+public:
+    //! 返回单调时间（纳秒）的时钟
+    using Clock = std::function<uint64_t()>;
+
+    //! 单项指标的汇总
+    struct Metric {
+        uint64_t p50Ns;
+        uint64_t p90Ns;
+        uint64_t p99Ns;
+        uint64_t maxNs;
+    };
+
+    //! 所有指标的汇总
+    struct Summary {
+        uint64_t frameCount;     // 统计的帧数
+        Metric cpuTime;          // CPU帧时间
+        Metric swapTime;         // eglSwapBuffers耗时
+        Metric frameInterval;    // 帧间隔
+        uint64_t jankFrames;     // 至少错过一次垂直同步的帧数
+        uint64_t missedVsyncs;   // 错过的垂直同步总数
+    };
+
+    /*!
+     * @param clock 时间来源
+     * @param vsyncPeriodNs 垂直同步周期，默认60Hz
+     * @param dumpIntervalNs 周期性输出汇总的间隔，为0时不输出
+     */
+    explicit FrameStats(
+            Clock clock,
+            uint64_t vsyncPeriodNs = 16666667,
+            uint64_t dumpIntervalNs = 5000000000ull);
+
+    void beginFrame();
+
+    void beginSwap();
+
+    void endSwap();
+
+    /*!
+     * 直接记录一帧的各项耗时，不经过时钟。interval为0表示没有前一帧
+     */
+    void recordFrame(uint64_t cpuTimeNs, uint64_t swapTimeNs, uint64_t intervalNs);
+
+    inline void setVsyncPeriod(uint64_t vsyncPeriodNs) { vsyncPeriodNs_ = vsyncPeriodNs; }
+
+    inline uint64_t getVsyncPeriod() const { return vsyncPeriodNs_; }
+
+    /*!
+     * @return 自上次reset以来的汇总
+     */
+    Summary getSummary() const;
+
+    void reset();
+
+    /*!
+     * 距离上一次输出超过了dumpIntervalNs时把汇总写入日志并重置统计
+     * @return 本次是否输出了汇总
+     */
+    bool dumpIfDue();
+
+    /*!
+     * 把汇总写入日志
+     */
+    static void logSummary(const Summary &summary);
+
+private:
+    Clock clock_;
+    uint64_t vsyncPeriodNs_;
+    uint64_t dumpIntervalNs_;
+
+    uint64_t frameBeginNs_ = 0;
+    uint64_t previousFrameBeginNs_ = 0;
+    uint64_t swapBeginNs_ = 0;
+    uint64_t lastDumpNs_ = 0;
+
+    FrameHistogram cpuTime_;
+    FrameHistogram swapTime_;
+    FrameHistogram frameInterval_;
+    uint64_t jankFrames_ = 0;
+    uint64_t missedVsyncs_ = 0;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_FRAMESTATS_H
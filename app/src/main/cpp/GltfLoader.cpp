@@ -0,0 +1,1065 @@
+#include "GltfLoader.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include "Log.h"
+#include "MeshoptDecoder.h"
+
+namespace {
+
+constexpr uint32_t kGlbMagic = 0x46546C67;     // "glTF"
+constexpr uint32_t kGlbVersion = 2;
+constexpr uint32_t kChunkJson = 0x4E4F534A;    // "JSON"
+constexpr uint32_t kChunkBin = 0x004E4942;     // "BIN\0"
+constexpr size_t kGlbHeaderSize = 12;
+constexpr size_t kChunkHeaderSize = 8;
+
+// 打开uri指向的外部文件
+using FileOpener = std::function<bool(const std::string &path, MappedFile &file)>;
+
+// 一段连续内存
+struct Span {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+inline uint32_t readU32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t componentSize(GLenum componentType) {
+    switch (componentType) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+// KHR_mesh_quantization允许顶点属性使用的8/16位整数分量
+bool isQuantizedComponent(GLenum componentType) {
+    return componentType == GL_BYTE || componentType == GL_UNSIGNED_BYTE || componentType == GL_SHORT
+           || componentType == GL_UNSIGNED_SHORT;
+}
+
+uint32_t componentCount(std::string_view type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+bool decodeBase64(const char *begin, const char *end, std::vector<uint8_t> &out) {
+    static const auto kTable = [] {
+        std::array<int8_t, 256> table{};
+        table.fill(-1);
+        const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; i++) {
+            table[uint8_t(alphabet[i])] = int8_t(i);
+        }
+        return table;
+    }();
+    out.clear();
+    out.reserve((end - begin) / 4 * 3);
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (const char *p = begin; p < end && *p != '='; p++) {
+        int8_t value = kTable[uint8_t(*p)];
+        if (value < 0) {
+            return false;
+        }
+        bits = (bits << 6) | uint32_t(value);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            out.push_back(uint8_t(bits >> bitCount));
+        }
+    }
+    return true;
+}
+
+// 解析GLB容器，输出JSON块和可选的BIN块
+bool parseGlb(const MappedFile &file, Span &json, Span &bin) {
+    const uint8_t *data = file.data();
+    size_t size = file.size();
+    if (size < kGlbHeaderSize + kChunkHeaderSize) {
+        LOGE("GLB文件太小: %zu字节", size);
+        return false;
+    }
+    uint32_t version = readU32(data + 4);
+    uint32_t length = readU32(data + 8);
+    if (version != kGlbVersion) {
+        LOGE("不支持的GLB版本 %u", version);
+        return false;
+    }
+    if (length > size) {
+        LOGE("GLB头中的长度 %u 超过文件大小 %zu", length, size);
+        return false;
+    }
+
+    size_t offset = kGlbHeaderSize;
+    int chunkIndex = 0;
+    while (offset + kChunkHeaderSize <= length) {
+        uint32_t chunkLength = readU32(data + offset);
+        uint32_t chunkType = readU32(data + offset + 4);
+        offset += kChunkHeaderSize;
+        if (chunkLength > length - offset) {
+            LOGE("GLB块 %d 越界: 长度 %u，剩余 %zu", chunkIndex, chunkLength, length - offset);
+            return false;
+        }
+        if (chunkIndex == 0 && chunkType != kChunkJson) {
+            LOGE("GLB的第一个块不是JSON");
+            return false;
+        }
+        if (chunkType == kChunkJson && chunkIndex == 0) {
+            json = Span{data + offset, chunkLength};
+        } else if (chunkType == kChunkBin && chunkIndex == 1) {
+            bin = Span{data + offset, chunkLength};
+        }
+        // 块长度应当4字节对齐，其他类型的块按规范忽略
+        offset += (chunkLength + 3u) & ~size_t(3);
+        chunkIndex++;
+    }
+    return json.data != nullptr;
+}
+
+constexpr int64_t kAbsent = -1;  // 字段不存在
+constexpr int64_t kInvalid = -2; // 字段存在但不是非负整数
+
+// 下面是glTF JSON的类型化描述，解析时一遍填充，之后再检查下标和范围
+struct BufferDesc {
+    std::string_view uri;
+    bool hasUri = false;
+    int64_t byteLength = kAbsent;
+    bool fallback = false; // EXT_meshopt_compression的回退缓冲，只被压缩的bufferView引用，不加载
+};
+
+// EXT_meshopt_compression：压缩数据的范围和解码参数，解码结果就是所在bufferView的内容
+struct MeshoptDesc {
+    bool present = false;
+    int64_t buffer = kAbsent;
+    int64_t byteOffset = 0;
+    int64_t byteLength = kAbsent;
+    int64_t byteStride = kAbsent;
+    int64_t count = kAbsent;
+    std::string_view mode;
+    std::string_view filter = "NONE";
+};
+
+struct BufferViewDesc {
+    int64_t buffer = kAbsent;
+    int64_t byteOffset = 0;
+    int64_t byteLength = kAbsent;
+    int64_t byteStride = 0;
+    MeshoptDesc meshopt;
+};
+
+struct AccessorDesc {
+    int64_t bufferView = kAbsent;
+    int64_t byteOffset = 0;
+    int64_t count = kAbsent;
+    int64_t componentType = kAbsent;
+    uint32_t components = 0;
+    bool normalized = false;
+    bool sparse = false;
+};
+
+struct PrimitiveDesc {
+    int64_t position = kAbsent;
+    int64_t texcoord = kAbsent;
+    int64_t normal = kAbsent;
+    int64_t indices = kAbsent;
+    int64_t material = kAbsent;
+    int64_t mode = GL_TRIANGLES;
+};
+
+struct MeshDesc {
+    std::string_view name;
+    size_t firstPrimitive = 0; // 在 Document::primitives 中的范围
+    size_t primitiveCount = 0;
+};
+
+struct ImageDesc {
+    std::string_view uri;
+    std::string_view mimeType;
+    int64_t bufferView = kAbsent;
+};
+
+struct MaterialDesc {
+    std::string_view name;
+    float baseColorFactor[4] = {1.f, 1.f, 1.f, 1.f};
+    int64_t baseColorTexture = kAbsent;
+};
+
+struct NodeDesc {
+    GltfNode node; // 名字和变换直接填好，mesh和子节点检查后再填
+    int64_t mesh = kAbsent;
+    size_t firstChild = 0; // 在 Document::nodeChildren 中的范围
+    size_t childCount = 0;
+};
+
+struct SceneDesc {
+    size_t firstNode = 0; // 在 Document::sceneNodes 中的范围
+    size_t nodeCount = 0;
+};
+
+// 整个glTF JSON的描述，变长的子数组都展开到共享的扁平数组中
+struct Document {
+    std::string_view version;
+    std::vector<BufferDesc> buffers;
+    std::vector<BufferViewDesc> bufferViews;
+    std::vector<AccessorDesc> accessors;
+    std::vector<MeshDesc> meshes;
+    std::vector<PrimitiveDesc> primitives;
+    std::vector<ImageDesc> images;
+    std::vector<int64_t> textureSources;
+    std::vector<MaterialDesc> materials;
+    std::vector<NodeDesc> nodes;
+    std::vector<int64_t> nodeChildren;
+    std::vector<SceneDesc> scenes;
+    std::vector<int64_t> sceneNodes;
+    int64_t scene = kAbsent;
+};
+
+// 读取对象，每个成员交给member处理。不是对象时忽略整个值，与缺失等价
+template<typename Member>
+bool readObject(JsonReader &json, Member &&member) {
+    if (json.peek() != JsonType::Object) {
+        return json.skipValue();
+    }
+    json.beginObject();
+    std::string_view key;
+    while (json.nextKey(key)) {
+        if (!member(key)) {
+            return false;
+        }
+    }
+    return json.ok();
+}
+
+// 读取数组，每个元素交给element处理。不是数组时忽略整个值
+template<typename Element>
+bool readArray(JsonReader &json, Element &&element) {
+    if (json.peek() != JsonType::Array) {
+        return json.skipValue();
+    }
+    json.beginArray();
+    while (json.nextElement()) {
+        if (!element()) {
+            return false;
+        }
+    }
+    return json.ok();
+}
+
+// 读取下标、长度等非负整数，值不是非负整数时记为kInvalid
+bool readIndex(JsonReader &json, int64_t &out) {
+    if (json.peek() != JsonType::Number) {
+        out = kInvalid;
+        return json.skipValue();
+    }
+    double value;
+    if (!json.readNumber(value)) {
+        return false;
+    }
+    // 2^53以内的整数都能用double精确表示
+    out = value >= 0. && value <= 9007199254740992. && value == std::floor(value) ? int64_t(value) : kInvalid;
+    return true;
+}
+
+bool readText(JsonReader &json, std::string_view &out) {
+    if (json.peek() != JsonType::String) {
+        return json.skipValue();
+    }
+    return json.readString(out);
+}
+
+bool readFlag(JsonReader &json, bool &out) {
+    if (json.peek() != JsonType::Bool) {
+        return json.skipValue();
+    }
+    return json.readBool(out);
+}
+
+// 读取定长的数字数组，长度或元素类型不对时保持原值
+bool readFloats(JsonReader &json, float *out, size_t count) {
+    float values[16];
+    size_t read = 0;
+    bool valid = true;
+    bool ok = readArray(json, [&] {
+        if (read == count || json.peek() != JsonType::Number) {
+            valid = false;
+            return json.skipValue();
+        }
+        return json.readFloat(values[read++]);
+    });
+    if (ok && valid && read == count) {
+        std::copy(values, values + count, out);
+    }
+    return ok;
+}
+
+// 读取下标数组，追加到out中
+bool readIndices(JsonReader &json, std::vector<int64_t> &out) {
+    return readArray(json, [&] {
+        out.push_back(kAbsent);
+        return readIndex(json, out.back());
+    });
+}
+
+bool readBuffer(JsonReader &json, Document &doc) {
+    BufferDesc &buffer = doc.buffers.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "uri") {
+            buffer.hasUri = true;
+            return readText(json, buffer.uri);
+        }
+        if (key == "byteLength") return readIndex(json, buffer.byteLength);
+        if (key == "extensions") {
+            return readObject(json, [&](std::string_view name) {
+                if (name != "EXT_meshopt_compression") {
+                    return json.skipValue();
+                }
+                return readObject(json, [&](std::string_view field) {
+                    return field == "fallback" ? readFlag(json, buffer.fallback) : json.skipValue();
+                });
+            });
+        }
+        return json.skipValue();
+    });
+}
+
+bool readMeshopt(JsonReader &json, MeshoptDesc &meshopt) {
+    meshopt.present = true;
+    return readObject(json, [&](std::string_view key) {
+        if (key == "buffer") return readIndex(json, meshopt.buffer);
+        if (key == "byteOffset") return readIndex(json, meshopt.byteOffset);
+        if (key == "byteLength") return readIndex(json, meshopt.byteLength);
+        if (key == "byteStride") return readIndex(json, meshopt.byteStride);
+        if (key == "count") return readIndex(json, meshopt.count);
+        if (key == "mode") return readText(json, meshopt.mode);
+        if (key == "filter") return readText(json, meshopt.filter);
+        return json.skipValue();
+    });
+}
+
+bool readBufferView(JsonReader &json, Document &doc) {
+    BufferViewDesc &view = doc.bufferViews.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "buffer") return readIndex(json, view.buffer);
+        if (key == "byteOffset") return readIndex(json, view.byteOffset);
+        if (key == "byteLength") return readIndex(json, view.byteLength);
+        if (key == "byteStride") return readIndex(json, view.byteStride);
+        if (key == "extensions") {
+            return readObject(json, [&](std::string_view name) {
+                return name == "EXT_meshopt_compression" ? readMeshopt(json, view.meshopt) : json.skipValue();
+            });
+        }
+        return json.skipValue();
+    });
+}
+
+bool readAccessor(JsonReader &json, Document &doc) {
+    AccessorDesc &accessor = doc.accessors.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "bufferView") return readIndex(json, accessor.bufferView);
+        if (key == "byteOffset") return readIndex(json, accessor.byteOffset);
+        if (key == "count") return readIndex(json, accessor.count);
+        if (key == "componentType") return readIndex(json, accessor.componentType);
+        if (key == "normalized") return readFlag(json, accessor.normalized);
+        if (key == "type") {
+            std::string_view type;
+            bool ok = readText(json, type);
+            accessor.components = componentCount(type);
+            return ok;
+        }
+        if (key == "sparse") accessor.sparse = true;
+        return json.skipValue();
+    });
+}
+
+bool readPrimitive(JsonReader &json, Document &doc) {
+    PrimitiveDesc &primitive = doc.primitives.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "attributes") {
+            return readObject(json, [&](std::string_view name) {
+                if (name == "POSITION") return readIndex(json, primitive.position);
+                if (name == "TEXCOORD_0") return readIndex(json, primitive.texcoord);
+                if (name == "NORMAL") return readIndex(json, primitive.normal);
+                return json.skipValue();
+            });
+        }
+        if (key == "indices") return readIndex(json, primitive.indices);
+        if (key == "material") return readIndex(json, primitive.material);
+        if (key == "mode") return readIndex(json, primitive.mode);
+        return json.skipValue();
+    });
+}
+
+bool readMesh(JsonReader &json, Document &doc) {
+    MeshDesc &mesh = doc.meshes.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "name") return readText(json, mesh.name);
+        if (key == "primitives") {
+            mesh.firstPrimitive = doc.primitives.size();
+            bool ok = readArray(json, [&] { return readPrimitive(json, doc); });
+            mesh.primitiveCount = doc.primitives.size() - mesh.firstPrimitive;
+            return ok;
+        }
+        return json.skipValue();
+    });
+}
+
+bool readImage(JsonReader &json, Document &doc) {
+    ImageDesc &image = doc.images.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "uri") return readText(json, image.uri);
+        if (key == "mimeType") return readText(json, image.mimeType);
+        if (key == "bufferView") return readIndex(json, image.bufferView);
+        return json.skipValue();
+    });
+}
+
+bool readTexture(JsonReader &json, Document &doc) {
+    int64_t &source = doc.textureSources.emplace_back(kAbsent);
+    return readObject(json, [&](std::string_view key) {
+        return key == "source" ? readIndex(json, source) : json.skipValue();
+    });
+}
+
+bool readMaterial(JsonReader &json, Document &doc) {
+    MaterialDesc &material = doc.materials.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "name") return readText(json, material.name);
+        if (key == "pbrMetallicRoughness") {
+            return readObject(json, [&](std::string_view name) {
+                if (name == "baseColorFactor") return readFloats(json, material.baseColorFactor, 4);
+                if (name == "baseColorTexture") {
+                    return readObject(json, [&](std::string_view field) {
+                        return field == "index" ? readIndex(json, material.baseColorTexture) : json.skipValue();
+                    });
+                }
+                return json.skipValue();
+            });
+        }
+        return json.skipValue();
+    });
+}
+
+bool readNode(JsonReader &json, Document &doc) {
+    NodeDesc &node = doc.nodes.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "name") return readText(json, node.node.name);
+        if (key == "mesh") return readIndex(json, node.mesh);
+        if (key == "children") {
+            node.firstChild = doc.nodeChildren.size();
+            bool ok = readIndices(json, doc.nodeChildren);
+            node.childCount = doc.nodeChildren.size() - node.firstChild;
+            return ok;
+        }
+        if (key == "translation") return readFloats(json, node.node.translation, 3);
+        if (key == "rotation") return readFloats(json, node.node.rotation, 4);
+        if (key == "scale") return readFloats(json, node.node.scale, 3);
+        if (key == "matrix") {
+            node.node.hasMatrix = true;
+            return readFloats(json, node.node.matrix, 16);
+        }
+        return json.skipValue();
+    });
+}
+
+bool readScene(JsonReader &json, Document &doc) {
+    SceneDesc &scene = doc.scenes.emplace_back();
+    return readObject(json, [&](std::string_view key) {
+        if (key == "nodes") {
+            scene.firstNode = doc.sceneNodes.size();
+            bool ok = readIndices(json, doc.sceneNodes);
+            scene.nodeCount = doc.sceneNodes.size() - scene.firstNode;
+            return ok;
+        }
+        return json.skipValue();
+    });
+}
+
+// 一遍读完整个JSON，顶层成员可以按任意顺序出现
+bool readDocument(JsonReader &json, Document &doc) {
+    if (json.peek() != JsonType::Object) {
+        return json.fail("glTF的顶层不是对象");
+    }
+    // 每种数组元素的读取函数
+    using ElementReader = bool (*)(JsonReader &, Document &);
+    auto readElements = [&](ElementReader element) {
+        return readArray(json, [&] { return element(json, doc); });
+    };
+    bool ok = readObject(json, [&](std::string_view key) {
+        if (key == "asset") {
+            return readObject(json, [&](std::string_view name) {
+                return name == "version" ? readText(json, doc.version) : json.skipValue();
+            });
+        }
+        if (key == "buffers") return readElements(readBuffer);
+        if (key == "bufferViews") return readElements(readBufferView);
+        if (key == "accessors") return readElements(readAccessor);
+        if (key == "meshes") return readElements(readMesh);
+        if (key == "images") return readElements(readImage);
+        if (key == "textures") return readElements(readTexture);
+        if (key == "materials") return readElements(readMaterial);
+        if (key == "nodes") return readElements(readNode);
+        if (key == "scenes") return readElements(readScene);
+        if (key == "scene") return readIndex(json, doc.scene);
+        return json.skipValue();
+    });
+    return ok && json.finish();
+}
+
+class SceneParser {
+public:
+    SceneParser(GltfScene &scene, const FileOpener &openFile) : scene_(scene), openFile_(openFile) {}
+
+    bool parse(const Span &jsonText, const Span &glbBin) {
+        JsonReader json(reinterpret_cast<const char *>(jsonText.data), jsonText.size, scene_.strings);
+        if (!readDocument(json, doc_)) {
+            LOGE("glTF JSON解析失败: %s（偏移 %zu）", json.error(), json.errorOffset());
+            return false;
+        }
+        if (doc_.version.empty() || doc_.version[0] != '2') {
+            LOGE("不是glTF 2.0文件");
+            return false;
+        }
+        return parseBuffers(glbBin) && parseBufferViews() && parseImages() && parseMaterials() && parseMeshes()
+               && parseNodes();
+    }
+
+private:
+    bool parseBuffers(const Span &glbBin) {
+        for (size_t i = 0; i < doc_.buffers.size(); i++) {
+            const BufferDesc &buffer = doc_.buffers[i];
+            if (buffer.byteLength < 0) {
+                LOGE("缓冲 %zu 的byteLength无效", i);
+                return false;
+            }
+            Span span;
+            if (buffer.fallback) {
+                // 回退缓冲只用来给不支持压缩的加载器占位，数据为空，只保留长度用于检查范围
+                buffers_.push_back(Span{nullptr, size_t(buffer.byteLength)});
+                continue;
+            }
+            if (!buffer.hasUri) {
+                // 没有uri的第0个缓冲就是GLB的BIN块
+                if (i != 0 || !glbBin.data) {
+                    LOGE("缓冲 %zu 没有uri也不是GLB的BIN块", i);
+                    return false;
+                }
+                span = glbBin;
+            } else if (buffer.uri.compare(0, 5, "data:") == 0) {
+                size_t comma = buffer.uri.find(";base64,");
+                if (comma == std::string_view::npos) {
+                    LOGE("缓冲 %zu 的data uri不是base64编码", i);
+                    return false;
+                }
+                // base64文本直接在JSON原文上解码，不先拷贝成字符串
+                auto &decoded = scene_.decodedBuffers.emplace_back();
+                if (!decodeBase64(buffer.uri.data() + comma + 8, buffer.uri.data() + buffer.uri.size(), decoded)) {
+                    LOGE("缓冲 %zu 的base64数据无效", i);
+                    return false;
+                }
+                span = Span{decoded.data(), decoded.size()};
+            } else {
+                MappedFile file;
+                if (!openFile_(scene_.baseDirectory + std::string(buffer.uri), file)) {
+                    return false;
+                }
+                span = Span{file.data(), file.size()};
+                scene_.files.push_back(std::move(file));
+            }
+            if (span.size < size_t(buffer.byteLength)) {
+                LOGE("缓冲 %zu 实际只有 %zu 字节，声明为 %lld 字节", i, span.size, (long long) buffer.byteLength);
+                return false;
+            }
+            span.size = size_t(buffer.byteLength);
+            buffers_.push_back(span);
+        }
+        return true;
+    }
+
+    bool parseBufferViews() {
+        for (size_t i = 0; i < doc_.bufferViews.size(); i++) {
+            const BufferViewDesc &view = doc_.bufferViews[i];
+            if (view.buffer < 0 || size_t(view.buffer) >= buffers_.size() || view.byteOffset < 0
+                || view.byteLength < 0 || view.byteStride < 0
+                || size_t(view.byteOffset) > buffers_[view.buffer].size
+                || size_t(view.byteLength) > buffers_[view.buffer].size - size_t(view.byteOffset)) {
+                LOGE("bufferView %zu 越界", i);
+                return false;
+            }
+            Span span{buffers_[view.buffer].data + view.byteOffset, size_t(view.byteLength)};
+            if (view.meshopt.present) {
+                if (!decodeMeshopt(i, view, span)) {
+                    return false;
+                }
+            } else if (!buffers_[view.buffer].data) {
+                LOGE("bufferView %zu 引用了回退缓冲但没有压缩", i);
+                return false;
+            }
+            bufferViews_.push_back(BufferView{span, size_t(view.byteStride)});
+        }
+        return true;
+    }
+
+    // 解码EXT_meshopt_compression压缩的bufferView，结果存在场景的decodedBuffers中
+    bool decodeMeshopt(size_t index, const BufferViewDesc &view, Span &out) {
+        const MeshoptDesc &meshopt = view.meshopt;
+        MeshoptMode mode;
+        if (meshopt.mode == "ATTRIBUTES") {
+            mode = MeshoptMode::Attributes;
+        } else if (meshopt.mode == "TRIANGLES") {
+            mode = MeshoptMode::Triangles;
+        } else if (meshopt.mode == "INDICES") {
+            mode = MeshoptMode::Indices;
+        } else {
+            LOGE("bufferView %zu 的meshopt模式 %.*s 不支持", index, int(meshopt.mode.size()), meshopt.mode.data());
+            return false;
+        }
+        MeshoptFilter filter;
+        if (meshopt.filter == "NONE") {
+            filter = MeshoptFilter::None;
+        } else if (meshopt.filter == "OCTAHEDRAL") {
+            filter = MeshoptFilter::Octahedral;
+        } else if (meshopt.filter == "QUATERNION") {
+            filter = MeshoptFilter::Quaternion;
+        } else if (meshopt.filter == "EXPONENTIAL") {
+            filter = MeshoptFilter::Exponential;
+        } else {
+            LOGE("bufferView %zu 的meshopt过滤器 %.*s 不支持", index, int(meshopt.filter.size()),
+                 meshopt.filter.data());
+            return false;
+        }
+
+        if (meshopt.buffer < 0 || size_t(meshopt.buffer) >= buffers_.size() || !buffers_[meshopt.buffer].data
+            || meshopt.byteOffset < 0 || meshopt.byteLength < 0 || meshopt.byteStride <= 0 || meshopt.count < 0
+            || size_t(meshopt.byteOffset) > buffers_[meshopt.buffer].size
+            || size_t(meshopt.byteLength) > buffers_[meshopt.buffer].size - size_t(meshopt.byteOffset)
+            || size_t(meshopt.count) > size_t(view.byteLength) / size_t(meshopt.byteStride)
+            || (mode != MeshoptMode::Attributes && filter != MeshoptFilter::None)) {
+            LOGE("bufferView %zu 的meshopt参数无效", index);
+            return false;
+        }
+
+        const uint8_t *source = buffers_[meshopt.buffer].data + meshopt.byteOffset;
+        auto size = size_t(meshopt.byteLength);
+        auto count = size_t(meshopt.count);
+        auto stride = size_t(meshopt.byteStride);
+        auto &decoded = scene_.decodedBuffers.emplace_back(size_t(view.byteLength));
+        bool ok = false;
+        switch (mode) {
+            case MeshoptMode::Attributes:
+                ok = MeshoptDecoder::decodeVertexBuffer(decoded.data(), count, stride, source, size)
+                     && MeshoptDecoder::applyFilter(filter, decoded.data(), count, stride);
+                break;
+            case MeshoptMode::Triangles:
+                ok = MeshoptDecoder::decodeIndexBuffer(decoded.data(), count, stride, source, size);
+                break;
+            case MeshoptMode::Indices:
+                ok = MeshoptDecoder::decodeIndexSequence(decoded.data(), count, stride, source, size);
+                break;
+        }
+        if (!ok) {
+            LOGE("bufferView %zu 的meshopt数据无效", index);
+            return false;
+        }
+        out = Span{decoded.data(), decoded.size()};
+        return true;
+    }
+
+    bool parseImages() {
+        for (size_t i = 0; i < doc_.images.size(); i++) {
+            const ImageDesc &image = doc_.images[i];
+            GltfImage out;
+            out.mimeType = image.mimeType;
+            if (image.bufferView != kAbsent) {
+                if (image.bufferView < 0 || size_t(image.bufferView) >= bufferViews_.size()) {
+                    LOGE("图像 %zu 的bufferView无效", i);
+                    return false;
+                }
+                out.data = bufferViews_[image.bufferView].span.data;
+                out.size = bufferViews_[image.bufferView].span.size;
+            } else {
+                out.uri = image.uri;
+            }
+            scene_.images.push_back(out);
+        }
+
+        // 纹理只是图像加采样器，这里直接解析到图像
+        for (int64_t source: doc_.textureSources) {
+            textureImages_.push_back(
+                    source >= 0 && size_t(source) < scene_.images.size() ? int32_t(source) : -1);
+        }
+        return true;
+    }
+
+    bool parseMaterials() {
+        for (const MaterialDesc &material: doc_.materials) {
+            GltfMaterial out;
+            out.name = material.name;
+            std::copy(material.baseColorFactor, material.baseColorFactor + 4, out.baseColorFactor);
+            int64_t texture = material.baseColorTexture;
+            if (texture >= 0 && size_t(texture) < textureImages_.size()) {
+                out.baseColorImage = textureImages_[texture];
+            }
+            scene_.materials.push_back(out);
+        }
+        return true;
+    }
+
+    // 解析访问器并检查所有元素都在bufferView范围内，失败时返回无效的访问器
+    GltfAccessor accessor(int64_t index) {
+        GltfAccessor out;
+        if (index < 0 || size_t(index) >= doc_.accessors.size()) {
+            return out;
+        }
+        const AccessorDesc &desc = doc_.accessors[index];
+        if (desc.sparse) {
+            LOGW("访问器 %lld 是稀疏访问器，不支持", (long long) index);
+            return out;
+        }
+        auto componentType = GLenum(std::max<int64_t>(desc.componentType, 0));
+        size_t elementSize = componentSize(componentType) * desc.components;
+        if (desc.bufferView < 0 || size_t(desc.bufferView) >= bufferViews_.size() || desc.byteOffset < 0
+            || desc.count <= 0 || elementSize == 0) {
+            LOGW("访问器 %lld 无效", (long long) index);
+            return out;
+        }
+        const BufferView &bufferView = bufferViews_[desc.bufferView];
+        size_t stride = bufferView.stride ? bufferView.stride : elementSize;
+        size_t count = size_t(desc.count);
+        // 先用除法检查数量，避免 stride * count 溢出
+        if (stride < elementSize || size_t(desc.byteOffset) > bufferView.span.size
+            || (bufferView.span.size - size_t(desc.byteOffset)) / stride < count - 1
+            || size_t(desc.byteOffset) + stride * (count - 1) + elementSize > bufferView.span.size) {
+            LOGW("访问器 %lld 越界", (long long) index);
+            return out;
+        }
+        out.data = bufferView.span.data + desc.byteOffset;
+        out.count = count;
+        out.stride = stride;
+        out.componentType = componentType;
+        out.components = desc.components;
+        out.normalized = desc.normalized;
+        return out;
+    }
+
+    bool parseMeshes() {
+        for (size_t m = 0; m < doc_.meshes.size(); m++) {
+            const MeshDesc &mesh = doc_.meshes[m];
+            GltfMesh out;
+            out.name = mesh.name;
+            for (size_t p = 0; p < mesh.primitiveCount; p++) {
+                const PrimitiveDesc &primitive = doc_.primitives[mesh.firstPrimitive + p];
+                GltfPrimitive result;
+                result.position = accessor(primitive.position);
+                if (!result.position.isValid() || result.position.components != 3
+                    || (result.position.componentType != GL_FLOAT
+                        && !isQuantizedComponent(result.position.componentType))) {
+                    LOGW("网格 %zu 图元 %zu 没有有效的POSITION，跳过", m, p);
+                    continue;
+                }
+                if (primitive.texcoord != kAbsent) {
+                    result.uv = accessor(primitive.texcoord);
+                    bool supported = result.uv.components == 2
+                                     && (result.uv.componentType == GL_FLOAT
+                                         || isQuantizedComponent(result.uv.componentType));
+                    if (!supported || result.uv.count != result.position.count) {
+                        LOGW("网格 %zu 图元 %zu 的TEXCOORD_0格式不支持，忽略", m, p);
+                        result.uv = GltfAccessor();
+                    }
+                }
+                if (primitive.normal != kAbsent) {
+                    result.normal = accessor(primitive.normal);
+                    GLenum type = result.normal.componentType;
+                    bool supported = type == GL_FLOAT
+                                     || (result.normal.normalized && (type == GL_BYTE || type == GL_SHORT));
+                    if (!supported || result.normal.components != 3 || result.normal.count != result.position.count) {
+                        result.normal = GltfAccessor();
+                    }
+                }
+                if (primitive.indices != kAbsent) {
+                    result.indices = accessor(primitive.indices);
+                    GLenum type = result.indices.componentType;
+                    // 索引必须紧密排列，且不能超出顶点范围
+                    bool supported = result.indices.isValid() && result.indices.components == 1
+                                     && (type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT
+                                         || type == GL_UNSIGNED_INT)
+                                     && result.indices.stride == componentSize(type);
+                    if (supported) {
+                        IndexStream stream = result.indexStream();
+                        for (size_t i = 0; i < stream.count && supported; i++) {
+                            supported = stream.fetch(i) < result.position.count;
+                        }
+                    }
+                    if (!supported) {
+                        LOGW("网格 %zu 图元 %zu 的索引无效，跳过", m, p);
+                        continue;
+                    }
+                }
+                result.material = primitive.material >= 0 && size_t(primitive.material) < scene_.materials.size()
+                                  ? int32_t(primitive.material) : -1;
+                if (primitive.mode < 0 || primitive.mode > GL_TRIANGLE_FAN) {
+                    LOGW("网格 %zu 图元 %zu 的mode %lld 无效，跳过", m, p, (long long) primitive.mode);
+                    continue;
+                }
+                result.mode = GLenum(primitive.mode);
+                out.primitives.push_back(result);
+            }
+            scene_.meshes.push_back(std::move(out));
+        }
+        return true;
+    }
+
+    // 节点必须构成森林：每个节点最多一个父节点且没有环，不满足的子节点关系被丢弃
+    bool parseNodes() {
+        size_t nodeCount = doc_.nodes.size();
+        std::vector<int64_t> parents(nodeCount, kAbsent);
+        for (size_t i = 0; i < nodeCount; i++) {
+            const NodeDesc &node = doc_.nodes[i];
+            for (size_t c = 0; c < node.childCount; c++) {
+                int64_t child = doc_.nodeChildren[node.firstChild + c];
+                if (child < 0 || size_t(child) >= nodeCount || parents[child] != kAbsent) {
+                    LOGW("节点 %zu 的子节点 %lld 无效或已有父节点，忽略", i, (long long) child);
+                    continue;
+                }
+                parents[child] = int64_t(i);
+            }
+        }
+
+        // 沿父节点向上走，回到本次路径上的节点说明有环，断开路径上最后一个节点
+        std::vector<uint8_t> state(nodeCount, 0); // 0未访问，1在当前路径上，2已完成
+        std::vector<size_t> path;
+        for (size_t i = 0; i < nodeCount; i++) {
+            path.clear();
+            int64_t node = int64_t(i);
+            while (node >= 0 && state[node] == 0) {
+                state[node] = 1;
+                path.push_back(size_t(node));
+                node = parents[node];
+            }
+            if (node >= 0 && state[node] == 1) {
+                LOGW("节点 %zu 处的层级有环，断开它和父节点的关系", path.back());
+                parents[path.back()] = kAbsent;
+            }
+            for (size_t visited: path) {
+                state[visited] = 2;
+            }
+        }
+
+        scene_.nodes.reserve(nodeCount);
+        for (size_t i = 0; i < nodeCount; i++) {
+            const NodeDesc &desc = doc_.nodes[i];
+            GltfNode node = desc.node;
+            node.mesh = desc.mesh >= 0 && size_t(desc.mesh) < scene_.meshes.size() ? int32_t(desc.mesh) : -1;
+            node.firstChild = uint32_t(scene_.nodeChildren.size());
+            for (size_t c = 0; c < desc.childCount; c++) {
+                int64_t child = doc_.nodeChildren[desc.firstChild + c];
+                if (child >= 0 && size_t(child) < nodeCount && parents[child] == int64_t(i)) {
+                    scene_.nodeChildren.push_back(uint32_t(child));
+                }
+            }
+            node.childCount = uint32_t(scene_.nodeChildren.size()) - node.firstChild;
+            scene_.nodes.push_back(node);
+        }
+
+        // 默认场景的根节点；没有场景时把所有没有父节点的节点当作根节点
+        int64_t sceneIndex = doc_.scene >= 0 ? doc_.scene : 0;
+        if (size_t(sceneIndex) < doc_.scenes.size()) {
+            const SceneDesc &scene = doc_.scenes[sceneIndex];
+            for (size_t n = 0; n < scene.nodeCount; n++) {
+                int64_t root = doc_.sceneNodes[scene.firstNode + n];
+                if (root >= 0 && size_t(root) < nodeCount && parents[root] == kAbsent) {
+                    scene_.rootNodes.push_back(uint32_t(root));
+                }
+            }
+        } else if (doc_.scenes.empty()) {
+            for (size_t i = 0; i < nodeCount; i++) {
+                if (parents[i] == kAbsent) {
+                    scene_.rootNodes.push_back(uint32_t(i));
+                }
+            }
+        }
+        return true;
+    }
+
+    struct BufferView {
+        Span span;
+        size_t stride;
+    };
+
+    GltfScene &scene_;
+    const FileOpener &openFile_;
+    Document doc_;
+    std::vector<Span> buffers_;
+    std::vector<BufferView> bufferViews_;
+    std::vector<int32_t> textureImages_; // 纹理下标到图像下标
+};
+
+std::unique_ptr<GltfScene> parseScene(
+        MappedFile file,
+        const std::string &baseDirectory,
+        const FileOpener &openFile) {
+    Span json{file.data(), file.size()};
+    Span bin;
+    if (file.size() >= 4 && readU32(file.data()) == kGlbMagic) {
+        if (!parseGlb(file, json, bin)) {
+            return nullptr;
+        }
+    }
+
+    auto scene = std::make_unique<GltfScene>();
+    scene->baseDirectory = baseDirectory;
+    // 先转移所有权，BIN块和JSON仍然指向同一段映射
+    scene->files.push_back(std::move(file));
+    SceneParser parser(*scene, openFile);
+    if (!parser.parse(json, bin)) {
+        return nullptr;
+    }
+    return scene;
+}
+
+std::string directoryOf(const std::string &path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+} // namespace
+
+VertexStreams GltfPrimitive::vertexStreams() const {
+    VertexStreams streams;
+    streams.count = position.count;
+    streams.position = position.data;
+    streams.positionStride = position.stride;
+    streams.positionType = position.componentType;
+    streams.positionNormalized = position.normalized;
+    if (uv.isValid()) {
+        streams.uv = uv.data;
+        streams.uvStride = uv.stride;
+        streams.uvType = uv.componentType;
+        streams.uvNormalized = uv.normalized;
+    }
+    return streams;
+}
+
+IndexStream GltfPrimitive::indexStream() const {
+    IndexStream stream;
+    if (indices.isValid()) {
+        stream.data = indices.data;
+        stream.count = indices.count;
+        stream.type = indices.componentType;
+    } else {
+        stream.count = position.count;
+    }
+    return stream;
+}
+
+std::unique_ptr<GltfScene> GltfLoader::load(const std::string &path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return nullptr;
+    }
+    return parse(std::move(file), directoryOf(path));
+}
+
+std::unique_ptr<GltfScene> GltfLoader::parse(MappedFile file, const std::string &baseDirectory) {
+    FileOpener openFile = [](const std::string &path, MappedFile &out) { return out.open(path); };
+    return parseScene(std::move(file), baseDirectory, openFile);
+}
+
+#ifdef __ANDROID__
+std::unique_ptr<GltfScene> GltfLoader::loadAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    FileOpener openAsset = [assetManager](const std::string &path, MappedFile &out) {
+        return out.openAsset(assetManager, path);
+    };
+    MappedFile file;
+    if (!openAsset(assetPath, file)) {
+        return nullptr;
+    }
+    return parseScene(std::move(file), directoryOf(assetPath), openAsset);
+}
+
+std::vector<Model> GltfLoader::createModels(const GltfScene &scene, const TextureLoader &textureLoader) {
+    std::vector<std::shared_ptr<TextureAsset>> imageTextures(scene.images.size());
+    std::vector<bool> imageLoaded(scene.images.size(), false);
+    std::map<uint32_t, std::shared_ptr<TextureAsset>> solidTextures; // 按RGBA8颜色缓存的纯色纹理
+
+    auto solidTexture = [&](const float *factor) {
+        uint8_t rgba[4];
+        for (int c = 0; c < 4; c++) {
+            rgba[c] = uint8_t(std::lround(std::min(1.f, std::max(0.f, factor[c])) * 255.f));
+        }
+        uint32_t key = rgba[0] | (rgba[1] << 8) | (rgba[2] << 16) | (uint32_t(rgba[3]) << 24);
+        auto &texture = solidTextures[key];
+        if (!texture) {
+            texture = TextureAsset::createSolidColorTexture(rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+        return texture;
+    };
+
+    auto materialTexture = [&](int32_t materialIndex) {
+        static const float kWhite[4] = {1.f, 1.f, 1.f, 1.f};
+        if (materialIndex < 0) {
+            return solidTexture(kWhite);
+        }
+        const GltfMaterial &material = scene.materials[materialIndex];
+        int32_t image = material.baseColorImage;
+        if (image >= 0) {
+            if (!imageLoaded[image]) {
+                const GltfImage &source = scene.images[image];
+                imageTextures[image] = source.data
+                                       ? TextureAsset::loadFromMemory(source.data, source.size)
+                                       : textureLoader(source);
+                imageLoaded[image] = true;
+            }
+            if (imageTextures[image]) {
+                return imageTextures[image];
+            }
+        }
+        return solidTexture(material.baseColorFactor);
+    };
+
+    std::vector<Model> models;
+    for (const GltfMesh &mesh: scene.meshes) {
+        for (const GltfPrimitive &primitive: mesh.primitives) {
+            VertexStreams streams = primitive.vertexStreams();
+            // 重复平铺的uv超出[0, 1]，不能用unorm16存储；归一化的无符号整数一定在范围内
+            bool uvInUnitRange = true;
+            bool uvUnsignedNormalized = streams.uvNormalized
+                                        && (streams.uvType == GL_UNSIGNED_BYTE || streams.uvType == GL_UNSIGNED_SHORT);
+            for (size_t i = 0; i < streams.count && uvInUnitRange && !uvUnsignedNormalized && streams.uv; i++) {
+                Vector2 uv = streams.fetchUV(i);
+                uvInUnitRange = uv.u >= 0.f && uv.u <= 1.f && uv.v >= 0.f && uv.v <= 1.f;
+            }
+            VertexLayout layout = VertexLayout::make(
+                    PositionFormat::Snorm16,
+                    uvInUnitRange ? UVFormat::Unorm16 : UVFormat::Float32,
+                    ColorFormat::None);
+            models.emplace_back(
+                    streams, primitive.indexStream(), materialTexture(primitive.material), primitive.mode, layout);
+        }
+    }
+    return models;
+}
+#endif
@@ -0,0 +1,144 @@
+#ifndef ANDROIDGLINVESTIGATIONS_GLTFLOADER_H
+#define ANDROIDGLINVESTIGATIONS_GLTFLOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JsonReader.h"
+#include "MappedFile.h"
+#include "VertexFormat.h"
+
+#ifdef __ANDROID__
+#include "Model.h"
+#endif
+
+/*!
+ * 解析后的访问器：直接指向映射内存中的第一个元素，已经合并了bufferView和accessor的偏移
+ */
+struct GltfAccessor {
+    const uint8_t *data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;              // 相邻元素的字节距离，bufferView没有byteStride时为元素大小
+    GLenum componentType = GL_FLOAT; // 数值与glTF的componentType相同
+    uint32_t components = 0;        // SCALAR为1，VEC2为2，依此类推
+    bool normalized = false;
+
+    inline bool isValid() const { return data != nullptr; }
+};
+
+struct GltfPrimitive {
+    GltfAccessor position; // VEC3 float或8/16位整数（KHR_mesh_quantization），必需
+    GltfAccessor uv;       // TEXCOORD_0，VEC2 float或8/16位整数，整数可以不归一化
+    GltfAccessor normal;   // VEC3 float或归一化的byte/short
+    GltfAccessor indices;  // SCALAR ubyte/ushort/uint，无效时按顶点顺序绘制
+    int32_t material = -1;
+    GLenum mode = GL_TRIANGLES; // glTF的mode与GL绘制模式数值相同
+
+    //! 可以直接交给 VertexFormat::quantize 或 Model 构造函数的顶点流
+    VertexStreams vertexStreams() const;
+
+    IndexStream indexStream() const;
+};
+
+struct GltfMesh {
+    std::string_view name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+/*!
+ * 图像：uri指向外部文件，或者data指向缓冲中的编码数据（GLB内嵌或bufferView）
+ */
+struct GltfImage {
+    std::string_view uri;
+    std::string_view mimeType;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+struct GltfMaterial {
+    std::string_view name;
+    float baseColorFactor[4] = {1.f, 1.f, 1.f, 1.f};
+    int32_t baseColorImage = -1; // 已经通过textures解析到images中的下标
+};
+
+/*!
+ * 场景节点。hasMatrix为true时用matrix，否则用TRS，都是相对父节点的局部变换
+ */
+struct GltfNode {
+    std::string_view name;
+    int32_t mesh = -1;
+    uint32_t firstChild = 0; // 子节点在 GltfScene::nodeChildren 中的起始位置
+    uint32_t childCount = 0;
+    float translation[3] = {0.f, 0.f, 0.f};
+    float rotation[4] = {0.f, 0.f, 0.f, 1.f}; // 四元数，xyzw
+    float scale[3] = {1.f, 1.f, 1.f};
+    float matrix[16] = {1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f}; // 列主序
+    bool hasMatrix = false;
+};
+
+/*!
+ * 一个glTF/GLB文件解析后的内容。访问器、内嵌图像和所有字符串都指向本对象持有的
+ * 映射内存或字符串arena，本对象销毁后这些指针失效
+ */
+struct GltfScene {
+    std::vector<GltfMesh> meshes;
+    std::vector<GltfMaterial> materials;
+    std::vector<GltfImage> images;
+    std::vector<GltfNode> nodes;
+    std::vector<uint32_t> nodeChildren; // 所有节点的子节点下标，已经检查过范围且没有环
+    std::vector<uint32_t> rootNodes;    // 默认场景的根节点
+    std::string baseDirectory; // 解析相对uri的目录，以'/'结尾或为空
+
+    std::vector<MappedFile> files; // 主文件和外部.bin文件的映射
+    std::vector<std::vector<uint8_t>> decodedBuffers; // data: URI的base64和meshopt压缩解码出的数据
+    StringArena strings; // 含转义字符的字符串解码后存放在这里，其余字符串直接指向JSON原文
+};
+
+/*!
+ * glTF 2.0 / GLB加载器。文件通过mmap映射，GLB的BIN块和外部.bin文件都不拷贝，
+ * 访问器的byteOffset和bufferView的byteStride直接体现在 GltfAccessor 中。
+ * JSON用 JsonReader 一遍读入类型化的描述结构，不构建DOM。
+ * 所有下标和范围都会检查，越界的访问器或图元会被跳过并输出日志。
+ * 支持EXT_meshopt_compression（压缩的bufferView在加载时用 MeshoptDecoder 解码，回退缓冲不加载）
+ * 和KHR_mesh_quantization（整数顶点属性），不支持稀疏访问器（sparse）和其他扩展。
+ */
+class GltfLoader {
+public:
+    /*!
+     * 加载.gltf或.glb文件，按文件头的magic区分
+     * @return 文件无法读取或JSON/GLB结构无效时返回nullptr
+     */
+    static std::unique_ptr<GltfScene> load(const std::string &path);
+
+    /*!
+     * 解析已经映射好的文件
+     * @param file 映射的文件，所有权转移给返回的场景
+     * @param baseDirectory 解析相对uri的目录
+     */
+    static std::unique_ptr<GltfScene> parse(MappedFile file, const std::string &baseDirectory);
+
+#ifdef __ANDROID__
+    /*!
+     * 加载assets/目录中的.gltf或.glb，外部.bin和图像也从assets读取
+     */
+    static std::unique_ptr<GltfScene> loadAsset(AAssetManager *assetManager, const std::string &assetPath);
+
+    //! 根据图像创建纹理，返回nullptr时使用材质的基础颜色
+    using TextureLoader = std::function<std::shared_ptr<TextureAsset>(const GltfImage &image)>;
+
+    /*!
+     * 为所有网格的所有图元创建模型，顶点和索引直接从映射内存量化上传。
+     * 纹理按图像缓存，同一图像只创建一次
+     * @param scene 加载的场景
+     * @param textureLoader 外部uri图像的加载方式；内嵌图像总是用 TextureAsset::loadFromMemory
+     */
+    static std::vector<Model> createModels(const GltfScene &scene, const TextureLoader &textureLoader);
+#endif
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_GLTFLOADER_H
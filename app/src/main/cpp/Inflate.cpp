@@ -0,0 +1,517 @@
+#include "Inflate.h"
+
+#include <cstring>
+#include <memory>
+
+#include "Checksum.h"
+
+namespace {
+
+constexpr int kMaxCodeLength = 15;
+constexpr int kLitLenBits = 11;
+constexpr int kDistanceBits = 8;
+constexpr int kPrecodeBits = 7;
+constexpr int kLitLenSymbols = 288;
+constexpr int kDistanceSymbols = 32;
+
+// 一级表加上最坏情况下的二级表：每个超长码的前缀最多一张，每张 2^(15-一级位数) 项
+constexpr size_t kLitLenTableSize = (1u << kLitLenBits) + kLitLenSymbols * (1u << (kMaxCodeLength - kLitLenBits));
+constexpr size_t kDistanceTableSize =
+        (1u << kDistanceBits) + kDistanceSymbols * (1u << (kMaxCodeLength - kDistanceBits));
+constexpr size_t kPrecodeTableSize = 1u << kPrecodeBits;
+
+/*
+ * 表项布局：低4位是要消耗的码长，4~7位是额外位数（二级表项为二级表的位数），8~9位是种类，高16位是值。
+ * 码长为0的表项表示不完整的码中没有分配的码字，解到它说明流已损坏
+ */
+enum EntryKind : uint32_t {
+    kLiteral = 0,   // 值是字面量字节，或码长码的符号
+    kBase = 1,      // 值是长度或距离的基数，后面跟额外位
+    kEndOfBlock = 2,
+    kSubtable = 3,  // 值是二级表的起始下标
+};
+
+inline uint32_t makeEntry(uint32_t bits, uint32_t extra, uint32_t kind, uint32_t value) {
+    return bits | (extra << 4) | (kind << 8) | (value << 16);
+}
+
+inline uint32_t entryBits(uint32_t entry) { return entry & 0xFu; }
+
+inline uint32_t entryExtra(uint32_t entry) { return (entry >> 4) & 0xFu; }
+
+inline uint32_t entryKind(uint32_t entry) { return (entry >> 8) & 0x3u; }
+
+inline uint32_t entryValue(uint32_t entry) { return entry >> 16; }
+
+//! 种类为字面量且码长不为0，一次比较完成
+inline bool isLiteral(uint32_t entry) { return (entry & 0x30Fu) - 1u < 15u; }
+
+constexpr uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+                                      99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5,
+                                      0};
+constexpr uint16_t kDistanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11,
+                                        11, 12, 12, 13, 13};
+
+enum class Alphabet {
+    Precode,
+    LitLen,
+    Distance,
+};
+
+/*!
+ * 符号解码后的表项内容（码长在建表时填入）
+ * @return 没有意义的符号（字面量/长度的286、287，距离的30、31）返回false
+ */
+bool symbolEntry(Alphabet alphabet, uint32_t symbol, uint32_t &entry) {
+    switch (alphabet) {
+        case Alphabet::Precode:
+            entry = makeEntry(0, 0, kLiteral, symbol);
+            return true;
+        case Alphabet::LitLen:
+            if (symbol < 256) {
+                entry = makeEntry(0, 0, kLiteral, symbol);
+                return true;
+            }
+            if (symbol == 256) {
+                entry = makeEntry(0, 0, kEndOfBlock, 0);
+                return true;
+            }
+            symbol -= 257;
+            if (symbol >= 29) {
+                return false;
+            }
+            entry = makeEntry(0, kLengthExtra[symbol], kBase, kLengthBase[symbol]);
+            return true;
+        case Alphabet::Distance:
+            if (symbol >= 30) {
+                return false;
+            }
+            entry = makeEntry(0, kDistanceExtra[symbol], kBase, kDistanceBase[symbol]);
+            return true;
+    }
+    return false;
+}
+
+inline uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; i++, code >>= 1) {
+        reversed = (reversed << 1) | (code & 1u);
+    }
+    return reversed;
+}
+
+/*!
+ * 由码长构造范式Huffman码的解码表。DEFLATE从低位开始读码字，所以表的下标是位反转后的码字
+ * @return 码长超额（不是前缀码）时返回false；不完整的码允许，没有分配的码字解码时报错
+ */
+bool buildTable(const uint8_t *lengths, int count, Alphabet alphabet, int tableBits, uint32_t *table,
+                size_t capacity) {
+    int counts[kMaxCodeLength + 1] = {};
+    for (int i = 0; i < count; i++) {
+        counts[lengths[i]]++;
+    }
+    counts[0] = 0;
+    int left = 1;
+    int maxLength = 0;
+    for (int length = 1; length <= kMaxCodeLength; length++) {
+        left = (left << 1) - counts[length];
+        if (left < 0) {
+            return false;
+        }
+        if (counts[length] > 0) {
+            maxLength = length;
+        }
+    }
+    // 按(码长, 符号)排序，这正是范式码分配码字的顺序
+    int offsets[kMaxCodeLength + 2] = {};
+    for (int length = 1; length <= kMaxCodeLength; length++) {
+        offsets[length + 1] = offsets[length] + counts[length];
+    }
+    uint16_t sorted[kLitLenSymbols];
+    for (int symbol = 0; symbol < count; symbol++) {
+        if (lengths[symbol] != 0) {
+            sorted[offsets[lengths[symbol]]++] = uint16_t(symbol);
+        }
+    }
+
+    const size_t primarySize = size_t(1) << tableBits;
+    memset(table, 0, primarySize * sizeof(uint32_t));
+    const int subBits = maxLength > tableBits ? maxLength - tableBits : 0;
+    size_t next = primarySize;
+    uint32_t code = 0;
+    int index = 0;
+    for (int length = 1; length <= maxLength; length++, code <<= 1) {
+        for (int n = 0; n < counts[length]; n++, code++) {
+            uint32_t entry = 0;
+            bool valid = symbolEntry(alphabet, sorted[index++], entry);
+            uint32_t reversed = reverseBits(code, length);
+            if (length <= tableBits) {
+                entry = valid ? entry | uint32_t(length) : 0;
+                for (size_t i = reversed; i < primarySize; i += size_t(1) << length) {
+                    table[i] = entry;
+                }
+                continue;
+            }
+            // 超长的码：一级表按低tableBits位指向二级表，二级表用剩下的位索引
+            uint32_t prefix = reversed & uint32_t(primarySize - 1);
+            if (table[prefix] == 0) {
+                size_t subSize = size_t(1) << subBits;
+                if (next + subSize > capacity) {
+                    return false;
+                }
+                memset(table + next, 0, subSize * sizeof(uint32_t));
+                table[prefix] = makeEntry(uint32_t(tableBits), uint32_t(subBits), kSubtable, uint32_t(next));
+                next += subSize;
+            }
+            uint32_t *subtable = table + entryValue(table[prefix]);
+            int rest = length - tableBits;
+            entry = valid ? entry | uint32_t(rest) : 0;
+            for (size_t i = reversed >> tableBits; i < (size_t(1) << subBits); i += size_t(1) << rest) {
+                subtable[i] = entry;
+            }
+        }
+    }
+    return true;
+}
+
+struct FixedTables {
+    uint32_t litLen[kLitLenTableSize];
+    uint32_t distance[kDistanceTableSize];
+};
+
+const FixedTables &fixedTables() {
+    static const FixedTables tables = [] {
+        FixedTables t{};
+        uint8_t lengths[kLitLenSymbols];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        buildTable(lengths, kLitLenSymbols, Alphabet::LitLen, kLitLenBits, t.litLen, kLitLenTableSize);
+        memset(lengths, 5, kDistanceSymbols);
+        buildTable(lengths, kDistanceSymbols, Alphabet::Distance, kDistanceBits, t.distance, kDistanceTableSize);
+        return t;
+    }();
+    return tables;
+}
+
+/*!
+ * 从低位开始读取的位流。剩余输入不足8字节时逐字节补充，越过末尾的部分补0并计数，
+ * 流结束时检查这些0没有被真正用到
+ */
+class BitReader {
+public:
+    BitReader(const uint8_t *data, size_t size) : begin_(data), in_(data), end_(data + size) {}
+
+    //! 补充到至少56位
+    inline void refill() {
+        if (end_ - in_ >= 8) {
+            uint64_t word;
+            memcpy(&word, in_, sizeof(word));
+            // 只有整字节计入，高位多读的部分在下次补充时会以相同的值再次或进来
+            bits_ |= word << count_;
+            in_ += (63 - count_) >> 3;
+            count_ |= 56;
+            return;
+        }
+        while (count_ < 56) {
+            uint64_t byte = 0;
+            if (in_ < end_) {
+                byte = *in_++;
+            } else {
+                overrun_++;
+            }
+            bits_ |= byte << count_;
+            count_ += 8;
+        }
+    }
+
+    inline uint32_t take(uint32_t n) {
+        auto value = uint32_t(bits_ & ((uint64_t(1) << n) - 1));
+        bits_ >>= n;
+        count_ -= n;
+        return value;
+    }
+
+    //! 用表解出一个符号并消耗它的码长，返回表项；调用前必须有至少15位
+    inline uint32_t decode(const uint32_t *table, int tableBits) {
+        uint32_t entry = table[bits_ & ((uint64_t(1) << tableBits) - 1)];
+        if (entryKind(entry) == kSubtable) {
+            take(uint32_t(tableBits));
+            entry = table[entryValue(entry) + (bits_ & ((uint64_t(1) << entryExtra(entry)) - 1))];
+        }
+        take(entryBits(entry));
+        return entry;
+    }
+
+    //! 丢弃到字节边界，把位缓冲中剩余的整字节退回输入，用于存储块
+    inline bool alignToByte() {
+        take(count_ & 7u);
+        size_t buffered = count_ / 8;
+        if (buffered < overrun_) {
+            return false;
+        }
+        in_ -= buffered - overrun_;
+        overrun_ = 0;
+        bits_ = 0;
+        count_ = 0;
+        return true;
+    }
+
+    //! @return 位缓冲中没有用到越过末尾的字节
+    inline bool withinInput() const { return count_ >= overrun_ * 8; }
+
+    //! 已经用到的输入字节数，不满一字节的部分算作一字节
+    inline size_t consumed() const { return size_t(in_ - begin_) - (count_ - overrun_ * 8) / 8; }
+
+    inline const uint8_t *&input() { return in_; }
+
+    inline const uint8_t *end() const { return end_; }
+
+private:
+    const uint8_t *begin_;
+    const uint8_t *in_;
+    const uint8_t *end_;
+    uint64_t bits_ = 0;
+    uint32_t count_ = 0;
+    size_t overrun_ = 0;
+};
+
+/*!
+ * 拷贝回溯的length字节。距离至少8时每次拷贝8字节，源总是在已经写完的区域；
+ * 调用者保证末尾有足够的余量时才走这条路径
+ */
+inline void copyMatch(uint8_t *out, size_t distance, size_t length, bool hasSlack) {
+    const uint8_t *src = out - distance;
+    if (distance >= 8 && hasSlack) {
+        uint8_t *end = out + length;
+        do {
+            uint64_t word;
+            memcpy(&word, src, sizeof(word));
+            memcpy(out, &word, sizeof(word));
+            src += 8;
+            out += 8;
+        } while (out < end);
+    } else if (distance == 1) {
+        memset(out, *src, length);
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            out[i] = src[i];
+        }
+    }
+}
+
+class Inflater {
+public:
+    Inflater(const uint8_t *data, size_t size, uint8_t *out, size_t outSize)
+            : reader_(data, size), outBegin_(out), out_(out), outEnd_(out + outSize) {}
+
+    bool run(size_t *consumed) {
+        bool last = false;
+        while (!last) {
+            reader_.refill();
+            last = reader_.take(1) != 0;
+            uint32_t type = reader_.take(2);
+            bool ok;
+            switch (type) {
+                case 0:
+                    ok = storedBlock();
+                    break;
+                case 1:
+                    ok = huffmanBlock(fixedTables().litLen, fixedTables().distance);
+                    break;
+                case 2:
+                    ok = dynamicBlock();
+                    break;
+                default:
+                    ok = false;
+                    break;
+            }
+            if (!ok || !reader_.withinInput()) {
+                return false;
+            }
+        }
+        if (consumed) {
+            *consumed = reader_.consumed();
+        }
+        return out_ == outEnd_;
+    }
+
+private:
+    bool storedBlock() {
+        if (!reader_.alignToByte()) {
+            return false;
+        }
+        const uint8_t *&in = reader_.input();
+        if (reader_.end() - in < 4) {
+            return false;
+        }
+        uint32_t length = in[0] | (uint32_t(in[1]) << 8);
+        uint32_t inverse = in[2] | (uint32_t(in[3]) << 8);
+        in += 4;
+        if (length != (~inverse & 0xFFFFu) || size_t(reader_.end() - in) < length
+            || size_t(outEnd_ - out_) < length) {
+            return false;
+        }
+        memcpy(out_, in, length);
+        in += length;
+        out_ += length;
+        return true;
+    }
+
+    bool dynamicBlock() {
+        static constexpr uint8_t kPrecodeOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1,
+                                                      15};
+        reader_.refill();
+        uint32_t litLenCount = reader_.take(5) + 257;
+        uint32_t distanceCount = reader_.take(5) + 1;
+        uint32_t precodeCount = reader_.take(4) + 4;
+        if (litLenCount > 286 || distanceCount > 30) {
+            return false;
+        }
+        uint8_t precodeLengths[19] = {};
+        for (uint32_t i = 0; i < precodeCount; i++) {
+            reader_.refill();
+            precodeLengths[kPrecodeOrder[i]] = uint8_t(reader_.take(3));
+        }
+        uint32_t precode[kPrecodeTableSize];
+        if (!buildTable(precodeLengths, 19, Alphabet::Precode, kPrecodeBits, precode, kPrecodeTableSize)) {
+            return false;
+        }
+
+        // 两张表的码长连续编码，重复码可以跨越两者的边界
+        uint8_t lengths[kLitLenSymbols + kDistanceSymbols] = {};
+        uint32_t total = litLenCount + distanceCount;
+        for (uint32_t i = 0; i < total;) {
+            reader_.refill();
+            uint32_t entry = reader_.decode(precode, kPrecodeBits);
+            if (entryBits(entry) == 0) {
+                return false;
+            }
+            uint32_t symbol = entryValue(entry);
+            if (symbol < 16) {
+                lengths[i++] = uint8_t(symbol);
+                continue;
+            }
+            uint8_t value = 0;
+            uint32_t repeat;
+            if (symbol == 16) {
+                if (i == 0) {
+                    return false;
+                }
+                value = lengths[i - 1];
+                repeat = 3 + reader_.take(2);
+            } else if (symbol == 17) {
+                repeat = 3 + reader_.take(3);
+            } else {
+                repeat = 11 + reader_.take(7);
+            }
+            if (repeat > total - i) {
+                return false;
+            }
+            memset(lengths + i, value, repeat);
+            i += repeat;
+        }
+        if (lengths[256] == 0) {
+            return false;
+        }
+        return buildTable(lengths, int(litLenCount), Alphabet::LitLen, kLitLenBits, litLen_, kLitLenTableSize)
+               && buildTable(lengths + litLenCount, int(distanceCount), Alphabet::Distance, kDistanceBits,
+                             distance_, kDistanceTableSize)
+               && huffmanBlock(litLen_, distance_);
+    }
+
+    bool huffmanBlock(const uint32_t *litLen, const uint32_t *distance) {
+        constexpr size_t kSlack = 258 + 8;
+        // 位缓冲和输出指针放在局部变量中：写出的字节可能与成员别名，否则每写一个字节都要重新读取它们
+        BitReader reader = reader_;
+        uint8_t *out = out_;
+        for (;;) {
+            // 补充后至少56位：连续的字面量每个最多15位，一次补充可以解出3个；
+            // 长度/距离对最多 15+5+15+13 = 48 位，前面有字面量时先再补充一次
+            reader.refill();
+            uint32_t entry = reader.decode(litLen, kLitLenBits);
+            if (isLiteral(entry)) {
+                if (out == outEnd_) {
+                    return false;
+                }
+                *out++ = uint8_t(entryValue(entry));
+                entry = reader.decode(litLen, kLitLenBits);
+                if (isLiteral(entry)) {
+                    if (out == outEnd_) {
+                        return false;
+                    }
+                    *out++ = uint8_t(entryValue(entry));
+                    entry = reader.decode(litLen, kLitLenBits);
+                    if (isLiteral(entry)) {
+                        if (out == outEnd_) {
+                            return false;
+                        }
+                        *out++ = uint8_t(entryValue(entry));
+                        continue;
+                    }
+                }
+                reader.refill();
+            }
+            if (entryKind(entry) == kEndOfBlock) {
+                break;
+            }
+            if (entryBits(entry) == 0) {
+                return false;
+            }
+            size_t length = entryValue(entry) + reader.take(entryExtra(entry));
+            entry = reader.decode(distance, kDistanceBits);
+            if (entryBits(entry) == 0) {
+                return false;
+            }
+            size_t offset = entryValue(entry) + reader.take(entryExtra(entry));
+            size_t room = size_t(outEnd_ - out);
+            if (offset > size_t(out - outBegin_) || length > room) {
+                return false;
+            }
+            copyMatch(out, offset, length, room >= kSlack);
+            out += length;
+        }
+        reader_ = reader;
+        out_ = out;
+        return true;
+    }
+
+    BitReader reader_;
+    uint8_t *outBegin_;
+    uint8_t *out_;
+    uint8_t *outEnd_;
+    uint32_t litLen_[kLitLenTableSize];
+    uint32_t distance_[kDistanceTableSize];
+};
+
+} // namespace
+
+bool Inflate::deflate(const uint8_t *data, size_t size, uint8_t *out, size_t outSize, size_t *consumed) {
+    // 解码表约44KB，不放在调用者的栈上
+    auto inflater = std::make_unique<Inflater>(data, size, out, outSize);
+    return inflater->run(consumed);
+}
+
+bool Inflate::zlib(const uint8_t *data, size_t size, uint8_t *out, size_t outSize) {
+    if (size < 6) {
+        return false;
+    }
+    // CMF：压缩方法8（DEFLATE），窗口不超过32KB；FLG：不能有预设字典，头部按31取模的校验
+    uint32_t method = data[0];
+    uint32_t flags = data[1];
+    if ((method & 0x0Fu) != 8 || (method >> 4) > 7 || (flags & 0x20u) != 0 || ((method << 8) | flags) % 31 != 0) {
+        return false;
+    }
+    size_t consumed = 0;
+    if (!deflate(data + 2, size - 6, out, outSize, &consumed)) {
+        return false;
+    }
+    const uint8_t *trailer = data + 2 + consumed;
+    uint32_t expected = (uint32_t(trailer[0]) << 24) | (uint32_t(trailer[1]) << 16) | (uint32_t(trailer[2]) << 8)
+                        | trailer[3];
+    return Checksum::adler32(out, outSize) == expected;
+}
@@ -0,0 +1,33 @@
+#ifndef ANDROIDGLINVESTIGATIONS_INFLATE_H
+#define ANDROIDGLINVESTIGATIONS_INFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * DEFLATE（RFC 1951）和zlib（RFC 1950）解压，用于PNG的图像数据。
+ *
+ * 解压后的大小必须事先知道（PNG可以由尺寸算出），整个流一次解压到调用者的缓冲中，
+ * 回溯直接读已经输出的数据，没有滑动窗口和流式状态。
+ * 解码循环每次从输入读8字节把64位的位缓冲补到56位以上，足够解出一个完整的长度/距离对；
+ * Huffman码先查11位（字面量/长度）或8位（距离）的一级表，更长的码再查一次二级表。
+ * 所有读写都检查边界，损坏或截断的输入返回false，不会越界访问。
+ */
+class Inflate {
+public:
+    /*!
+     * 解压zlib流并校验Adler-32
+     * @param outSize 解压后的确切大小，流解压出的长度与它不符时失败
+     * @return 流无效、长度不符或校验和错误时返回false，此时输出内容未定义
+     */
+    static bool zlib(const uint8_t *data, size_t size, uint8_t *out, size_t outSize);
+
+    /*!
+     * 解压原始的DEFLATE流
+     * @param consumed 不为空时输出流占用的输入字节数，最后一个字节可能只用了一部分
+     */
+    static bool deflate(const uint8_t *data, size_t size, uint8_t *out, size_t outSize,
+                        size_t *consumed = nullptr);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_INFLATE_H
@@ -0,0 +1,572 @@
+#include "JsonReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "VecMath.h"
+
+namespace {
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// 字符串中需要特别处理的字符：结尾引号、转义和不允许出现的控制字符
+inline bool isStringSpecial(char c) {
+    return c == '"' || c == '\\' || static_cast<uint8_t>(c) < 0x20;
+}
+
+#if VECMATH_NEON
+// 把比较结果压成每字节4位的64位掩码，第一个命中的字节下标为 ctz / 4
+inline uint64_t nibbleMask(uint8x16_t match) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+}
+#endif
+
+const char *skipWhitespace(const char *p, const char *end) {
+    // 压缩过的JSON里几乎没有空白，先检查一个字节
+    if (p < end && !isWhitespace(*p)) {
+        return p;
+    }
+#if VECMATH_NEON
+    while (end - p >= 16) {
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        uint8x16_t space = vorrq_u8(vceqq_u8(bytes, vdupq_n_u8(' ')), vceqq_u8(bytes, vdupq_n_u8('\n')));
+        space = vorrq_u8(space, vorrq_u8(vceqq_u8(bytes, vdupq_n_u8('\r')), vceqq_u8(bytes, vdupq_n_u8('\t'))));
+        uint64_t mask = nibbleMask(vmvnq_u8(space));
+        if (mask) {
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+        p += 16;
+    }
+#elif VECMATH_SSE
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+        space = _mm_or_si128(space, _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')),
+                                                 _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))));
+        auto mask = static_cast<uint32_t>(~_mm_movemask_epi8(space)) & 0xFFFFu;
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && isWhitespace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// 返回第一个需要特别处理的字符的位置，没有时返回end
+const char *findStringSpecial(const char *p, const char *end) {
+#if VECMATH_NEON
+    while (end - p >= 16) {
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        uint8x16_t special = vorrq_u8(vceqq_u8(bytes, vdupq_n_u8('"')), vceqq_u8(bytes, vdupq_n_u8('\\')));
+        special = vorrq_u8(special, vcltq_u8(bytes, vdupq_n_u8(0x20)));
+        uint64_t mask = nibbleMask(special);
+        if (mask) {
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+        p += 16;
+    }
+#elif VECMATH_SSE
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')),
+                                       _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\')));
+        // SSE2没有无符号比较，用 max(x, 0x1F) == 0x1F 判断 x <= 0x1F
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(bytes, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(special, control)));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && !isStringSpecial(*p)) {
+        p++;
+    }
+    return p;
+}
+
+bool parseHex4(const char *p, uint32_t &out) {
+    out = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        out = (out << 4) | digit;
+    }
+    return true;
+}
+
+char *encodeUtf8(uint32_t codePoint, char *out) {
+    if (codePoint < 0x80) {
+        *out++ = char(codePoint);
+    } else if (codePoint < 0x800) {
+        *out++ = char(0xC0 | (codePoint >> 6));
+        *out++ = char(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        *out++ = char(0xE0 | (codePoint >> 12));
+        *out++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = char(0x80 | (codePoint & 0x3F));
+    } else {
+        *out++ = char(0xF0 | (codePoint >> 18));
+        *out++ = char(0x80 | ((codePoint >> 12) & 0x3F));
+        *out++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = char(0x80 | (codePoint & 0x3F));
+    }
+    return out;
+}
+
+// 10^0..10^22 都能用double精确表示
+constexpr double kPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+constexpr int kMaxMantissaDigits = 19; // uint64能容纳的十进制位数
+
+} // namespace
+
+char *StringArena::allocate(size_t size) {
+    if (size > remaining_) {
+        if (size > blockSize_ / 4) {
+            // 大字符串单独分配，不浪费当前块的剩余空间
+            blocks_.emplace_back(new char[size]);
+            return blocks_.back().get();
+        }
+        blocks_.emplace_back(new char[blockSize_]);
+        cursor_ = blocks_.back().get();
+        remaining_ = blockSize_;
+    }
+    char *result = cursor_;
+    cursor_ += size;
+    remaining_ -= size;
+    return result;
+}
+
+std::string_view StringArena::store(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    char *copy = allocate(text.size());
+    memcpy(copy, text.data(), text.size());
+    return {copy, text.size()};
+}
+
+JsonReader::JsonReader(const char *data, size_t size, StringArena &arena)
+        : begin_(data), cursor_(data), end_(data + size), arena_(arena) {
+    // 跳过UTF-8 BOM
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        cursor_ += 3;
+    }
+}
+
+bool JsonReader::fail(const char *message) {
+    if (!error_) {
+        error_ = message;
+        errorOffset_ = size_t(cursor_ - begin_);
+    }
+    return false;
+}
+
+JsonType JsonReader::peek() {
+    if (!ok()) {
+        return JsonType::Invalid;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    if (cursor_ == end_) {
+        return JsonType::Invalid;
+    }
+    switch (*cursor_) {
+        case '{':
+            return JsonType::Object;
+        case '[':
+            return JsonType::Array;
+        case '"':
+            return JsonType::String;
+        case 't':
+        case 'f':
+            return JsonType::Bool;
+        case 'n':
+            return JsonType::Null;
+        default:
+            return *cursor_ == '-' || isDigit(*cursor_) ? JsonType::Number : JsonType::Invalid;
+    }
+}
+
+bool JsonReader::expect(char c, const char *message) {
+    if (!ok()) {
+        return false;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    if (cursor_ == end_ || *cursor_ != c) {
+        return fail(message);
+    }
+    cursor_++;
+    return true;
+}
+
+bool JsonReader::beginObject() {
+    if (!expect('{', "应为对象")) {
+        return false;
+    }
+    if (++depth_ > kMaxDepth) {
+        return fail("嵌套太深");
+    }
+    first_ = true;
+    return true;
+}
+
+bool JsonReader::nextKey(std::string_view &key) {
+    if (!ok()) {
+        return false;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    if (cursor_ == end_) {
+        return fail("对象没有结束");
+    }
+    if (*cursor_ == '}') {
+        cursor_++;
+        depth_--;
+        first_ = false;
+        return false;
+    }
+    if (!first_) {
+        if (*cursor_ != ',') {
+            return fail("对象成员之间缺少','");
+        }
+        cursor_++;
+    }
+    first_ = false;
+    return readString(key) && expect(':', "键之后缺少':'");
+}
+
+bool JsonReader::beginArray() {
+    if (!expect('[', "应为数组")) {
+        return false;
+    }
+    if (++depth_ > kMaxDepth) {
+        return fail("嵌套太深");
+    }
+    first_ = true;
+    return true;
+}
+
+bool JsonReader::nextElement() {
+    if (!ok()) {
+        return false;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    if (cursor_ == end_) {
+        return fail("数组没有结束");
+    }
+    if (*cursor_ == ']') {
+        cursor_++;
+        depth_--;
+        first_ = false;
+        return false;
+    }
+    if (!first_) {
+        if (*cursor_ != ',') {
+            return fail("数组元素之间缺少','");
+        }
+        cursor_++;
+    }
+    first_ = false;
+    return true;
+}
+
+bool JsonReader::scanString(const char *&contentBegin, const char *&contentEnd, bool &escaped) {
+    if (!ok()) {
+        return false;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    if (cursor_ == end_ || *cursor_ != '"') {
+        return fail("应为字符串");
+    }
+    contentBegin = ++cursor_;
+    escaped = false;
+    const char *p = findStringSpecial(cursor_, end_);
+    while (p < end_ && *p == '\\') {
+        escaped = true;
+        // 转义后的字符（包括'"'）不会结束字符串。这里就检查转义是否有效，skipValue 跳过的字符串
+        // 与 readString 读取的字符串接受同样的输入
+        if (end_ - p < 2) {
+            p = end_;
+            break;
+        }
+        char code = p[1];
+        uint32_t codePoint;
+        if (code == 'u' ? end_ - p < 6 || !parseHex4(p + 2, codePoint)
+                        : code != '"' && code != '\\' && code != '/' && code != 'b' && code != 'f' && code != 'n'
+                          && code != 'r' && code != 't') {
+            cursor_ = p + 1;
+            return fail(code == 'u' ? "无效的\\u转义" : "无效的转义字符");
+        }
+        p = findStringSpecial(p + 2, end_);
+    }
+    if (p == end_ || *p != '"') {
+        cursor_ = std::min(p, end_);
+        return fail(p == end_ ? "字符串没有结束" : "字符串中有控制字符");
+    }
+    contentEnd = p;
+    cursor_ = p + 1;
+    return true;
+}
+
+bool JsonReader::readString(std::string_view &out) {
+    const char *begin;
+    const char *end;
+    bool escaped;
+    if (!scanString(begin, end, escaped)) {
+        return false;
+    }
+    if (!escaped) {
+        out = std::string_view(begin, size_t(end - begin));
+        return true;
+    }
+
+    // 解码后不会比原文长：\uXXXX最多3字节，代理对的12个字符最多4字节
+    char *decoded = arena_.allocate(size_t(end - begin));
+    char *write = decoded;
+    for (const char *p = begin; p < end;) {
+        if (*p != '\\') {
+            *write++ = *p++;
+            continue;
+        }
+        char code = p[1];
+        p += 2;
+        switch (code) {
+            case '"':
+            case '\\':
+            case '/':
+                *write++ = code;
+                break;
+            case 'b':
+                *write++ = '\b';
+                break;
+            case 'f':
+                *write++ = '\f';
+                break;
+            case 'n':
+                *write++ = '\n';
+                break;
+            case 'r':
+                *write++ = '\r';
+                break;
+            case 't':
+                *write++ = '\t';
+                break;
+            case 'u': {
+                uint32_t codePoint;
+                if (end - p < 4 || !parseHex4(p, codePoint)) {
+                    cursor_ = p;
+                    return fail("无效的\\u转义");
+                }
+                p += 4;
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                    uint32_t low;
+                    if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && parseHex4(p + 2, low)
+                        && low >= 0xDC00 && low < 0xE000) {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    } else {
+                        codePoint = 0xFFFD;
+                    }
+                } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+                    // 不成对的低位代理
+                    codePoint = 0xFFFD;
+                }
+                write = encodeUtf8(codePoint, write);
+                break;
+            }
+            default:
+                cursor_ = p - 1;
+                return fail("无效的转义字符");
+        }
+    }
+    out = std::string_view(decoded, size_t(write - decoded));
+    return true;
+}
+
+bool JsonReader::readNumber(double &value) {
+    if (!ok()) {
+        return false;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    const char *start = cursor_;
+    const char *p = cursor_;
+    bool negative = false;
+    if (p < end_ && *p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p == end_ || !isDigit(*p)) {
+        return fail("无效的数字");
+    }
+
+    // 最多保留19位有效数字，更多的位数只记录数量级
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int64_t exponent = 0;
+    bool truncated = false;
+    if (*p == '0') {
+        p++;
+        if (p < end_ && isDigit(*p)) {
+            cursor_ = p;
+            return fail("数字不能有前导0");
+        }
+    } else {
+        for (; p < end_ && isDigit(*p); p++) {
+            if (digits < kMaxMantissaDigits) {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                digits++;
+            } else {
+                exponent++;
+                truncated = truncated || *p != '0';
+            }
+        }
+    }
+    if (p < end_ && *p == '.') {
+        p++;
+        if (p == end_ || !isDigit(*p)) {
+            cursor_ = p;
+            return fail("小数点后缺少数字");
+        }
+        for (; p < end_ && isDigit(*p); p++) {
+            if (digits < kMaxMantissaDigits) {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                // 前导0不占有效位
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                truncated = truncated || *p != '0';
+            }
+        }
+    }
+    if (p < end_ && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end_ && (*p == '+' || *p == '-')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if (p == end_ || !isDigit(*p)) {
+            cursor_ = p;
+            return fail("指数缺少数字");
+        }
+        int64_t explicitExponent = 0;
+        for (; p < end_ && isDigit(*p); p++) {
+            // 超过这个量级的结果总是0或无穷大
+            explicitExponent = std::min<int64_t>(explicitExponent * 10 + (*p - '0'), 100000);
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    cursor_ = p;
+
+    if (!truncated && mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        // Clinger快速路径：尾数和10的幂都能精确表示，一次乘除的结果是正确舍入的
+        auto m = double(mantissa);
+        value = exponent < 0 ? m / kPow10[-exponent] : m * kPow10[exponent];
+        value = negative ? -value : value;
+    } else {
+        // 罕见情况交给strtod，输入不以0结尾所以需要拷贝
+        std::string text(start, size_t(p - start));
+        value = strtod(text.c_str(), nullptr);
+        if (std::isinf(value)) {
+            cursor_ = start;
+            return fail("数字超出范围");
+        }
+    }
+    return true;
+}
+
+bool JsonReader::readFloat(float &out) {
+    double value;
+    if (!readNumber(value)) {
+        return false;
+    }
+    out = float(value);
+    return true;
+}
+
+bool JsonReader::readLiteral(const char *literal, size_t length) {
+    if (size_t(end_ - cursor_) < length || memcmp(cursor_, literal, length) != 0) {
+        return fail("无效的字面量");
+    }
+    cursor_ += length;
+    return true;
+}
+
+bool JsonReader::readBool(bool &out) {
+    JsonType type = peek();
+    if (type != JsonType::Bool) {
+        return fail("应为布尔值");
+    }
+    out = *cursor_ == 't';
+    return out ? readLiteral("true", 4) : readLiteral("false", 5);
+}
+
+bool JsonReader::skipValue() {
+    switch (peek()) {
+        case JsonType::Object: {
+            beginObject();
+            std::string_view key;
+            while (nextKey(key)) {
+                skipValue();
+            }
+            return ok();
+        }
+        case JsonType::Array:
+            beginArray();
+            while (nextElement()) {
+                skipValue();
+            }
+            return ok();
+        case JsonType::String: {
+            const char *begin;
+            const char *end;
+            bool escaped;
+            return scanString(begin, end, escaped);
+        }
+        case JsonType::Number: {
+            double value;
+            return readNumber(value);
+        }
+        case JsonType::Bool: {
+            bool value;
+            return readBool(value);
+        }
+        case JsonType::Null:
+            return readLiteral("null", 4);
+        default:
+            return fail(cursor_ == end_ ? "JSON意外结束" : "应为JSON值");
+    }
+}
+
+bool JsonReader::finish() {
+    if (!ok()) {
+        return false;
+    }
+    cursor_ = skipWhitespace(cursor_, end_);
+    return cursor_ == end_ || fail("JSON之后有多余内容");
+}
@@ -0,0 +1,133 @@
+#ifndef ANDROIDGLINVESTIGATIONS_JSONREADER_H
+#define ANDROIDGLINVESTIGATIONS_JSONREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*!
+ * 按块分配的字符串存储。分配出的内存在arena销毁前一直有效，不单独释放
+ */
+class StringArena {
+public:
+    explicit StringArena(size_t blockSize = 4096) : blockSize_(blockSize) {}
+
+    StringArena(const StringArena &) = delete;
+
+    StringArena &operator=(const StringArena &) = delete;
+
+    StringArena(StringArena &&) = default;
+
+    StringArena &operator=(StringArena &&) = default;
+
+    //! 分配size字节，不初始化
+    char *allocate(size_t size);
+
+    //! 拷贝一段字符串，返回指向arena内的视图
+    std::string_view store(std::string_view text);
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char *cursor_ = nullptr;
+    size_t remaining_ = 0;
+    size_t blockSize_;
+};
+
+enum class JsonType {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object,
+    Invalid
+};
+
+/*!
+ * 流式（拉取式）JSON解析器，直接在输入内存上工作，不构建DOM。
+ * 调用方按自己期望的结构依次读取，不关心的值用 skipValue 跳过：
+ *
+ *     reader.beginObject();
+ *     std::string_view key;
+ *     while (reader.nextKey(key)) {
+ *         if (key == "count") reader.readInt(count); else reader.skipValue();
+ *     }
+ *
+ * 不含转义的字符串直接指向输入，含转义的字符串解码到 StringArena 中，
+ * 两种情况下返回的视图都在输入和arena有效期间有效。
+ * 第一次出错后解析器进入错误状态，之后所有读取都返回false，最后检查 ok() 即可。
+ * 字符串扫描和空白跳过在有SSE2/NEON时每次处理16字节。
+ */
+class JsonReader {
+public:
+    //! 嵌套深度上限，防止恶意输入耗尽栈
+    static constexpr int kMaxDepth = 128;
+
+    JsonReader(const char *data, size_t size, StringArena &arena);
+
+    //! 下一个值的类型，不消耗输入
+    JsonType peek();
+
+    //! 读取'{'，之后用 nextKey 遍历成员
+    bool beginObject();
+
+    /*!
+     * 读取下一个成员的键和':'，调用方随后必须读取或跳过对应的值
+     * @return 遇到'}'（同时消耗它）或出错时返回false
+     */
+    bool nextKey(std::string_view &key);
+
+    //! 读取'['，之后用 nextElement 遍历元素
+    bool beginArray();
+
+    /*!
+     * 移动到下一个数组元素，调用方随后必须读取或跳过这个元素
+     * @return 遇到']'（同时消耗它）或出错时返回false
+     */
+    bool nextElement();
+
+    bool readString(std::string_view &out);
+
+    bool readNumber(double &value);
+
+    bool readFloat(float &out);
+
+    bool readBool(bool &out);
+
+    //! 跳过下一个任意类型的值，同样会检查语法
+    bool skipValue();
+
+    //! 确认顶层值之后只剩空白
+    bool finish();
+
+    //! 标记一个语义错误（例如类型不符），使解析器进入错误状态
+    bool fail(const char *message);
+
+    inline bool ok() const { return error_ == nullptr; }
+
+    inline const char *error() const { return error_; }
+
+    //! 出错位置相对输入开头的字节偏移
+    inline size_t errorOffset() const { return errorOffset_; }
+
+private:
+    bool expect(char c, const char *message);
+
+    bool readLiteral(const char *literal, size_t length);
+
+    //! 找到字符串内容的范围并移过结尾的引号，不解码转义
+    bool scanString(const char *&contentBegin, const char *&contentEnd, bool &escaped);
+
+    const char *begin_;
+    const char *cursor_;
+    const char *end_;
+    StringArena &arena_;
+    bool first_ = false; // 刚进入对象或数组，下一个成员前不需要逗号
+    int depth_ = 0;
+    const char *error_ = nullptr;
+    size_t errorOffset_ = 0;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_JSONREADER_H
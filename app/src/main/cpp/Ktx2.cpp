@@ -0,0 +1,291 @@
+#include "Ktx2.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Log.h"
+
+#if TEXTURE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// 数据格式描述中用到的常量，见Khronos Data Format规范
+constexpr uint32_t kDfdVersion = 2;
+constexpr uint32_t kColorModelRgbsda = 1;
+constexpr uint32_t kColorModelEtc2 = 161;
+constexpr uint32_t kColorModelAstc = 162;
+constexpr uint32_t kPrimariesBt709 = 1;
+constexpr uint32_t kTransferLinear = 1;
+constexpr uint32_t kTransferSrgb = 2;
+constexpr uint32_t kChannelAlpha = 15;
+constexpr uint32_t kChannelEtc2Color = 2;
+constexpr uint32_t kSampleLinear = 0x10; // sRGB格式中alpha通道不经过传递函数
+
+inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void appendU32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(uint8_t(value >> (i * 8)));
+    }
+}
+
+/*!
+ * 生成只有一个基本描述块的DFD，读取时不解析它，格式完全由vkFormat决定
+ */
+std::vector<uint8_t> basicDfd(const TextureFormat &format, bool supercompressed) {
+    struct Sample {
+        uint32_t channel;
+        uint32_t bitOffset;
+        uint32_t bitLength;
+    };
+    // 逐个追加；用初始化列表整体赋值时GCC在 -Wall 下会误报 -Wnonnull
+    std::vector<Sample> samples;
+    samples.reserve(4);
+    uint32_t colorModel = kColorModelRgbsda;
+    switch (format.codec) {
+        case TextureCodec::Rgba8:
+            samples.push_back({0, 0, 8});
+            samples.push_back({1, 8, 8});
+            samples.push_back({2, 16, 8});
+            samples.push_back({kChannelAlpha, 24, 8});
+            break;
+        case TextureCodec::Etc2:
+            colorModel = kColorModelEtc2;
+            if (format.hasAlpha) {
+                samples.push_back({kChannelAlpha, 0, 64});
+                samples.push_back({kChannelEtc2Color, 64, 64});
+            } else {
+                samples.push_back({kChannelEtc2Color, 0, 64});
+            }
+            break;
+        case TextureCodec::Astc:
+            colorModel = kColorModelAstc;
+            samples.push_back({0, 0, 128});
+            break;
+    }
+    uint32_t blockSize = 24 + 16 * uint32_t(samples.size());
+    std::vector<uint8_t> dfd;
+    appendU32(dfd, 4 + blockSize);
+    appendU32(dfd, 0); // vendorId = Khronos，descriptorType = 基本格式
+    appendU32(dfd, kDfdVersion | (blockSize << 16));
+    appendU32(dfd, colorModel | (kPrimariesBt709 << 8) | ((format.srgb ? kTransferSrgb : kTransferLinear) << 16));
+    appendU32(dfd, uint32_t(format.blockWidth - 1) | (uint32_t(format.blockHeight - 1) << 8));
+    appendU32(dfd, supercompressed ? 0 : format.blockBytes);
+    appendU32(dfd, 0);
+    for (const Sample &sample: samples) {
+        uint32_t channelType = sample.channel;
+        if (format.srgb && sample.channel == kChannelAlpha) {
+            channelType |= kSampleLinear;
+        }
+        appendU32(dfd, sample.bitOffset | ((sample.bitLength - 1) << 16) | (channelType << 24));
+        appendU32(dfd, 0); // 采样位置
+        appendU32(dfd, 0); // sampleLower
+        appendU32(dfd, format.codec == TextureCodec::Rgba8 ? 255 : 0xFFFFFFFFu);
+    }
+    return dfd;
+}
+
+} // namespace
+
+Ktx2Writer::Ktx2Writer(const TextureFormat &format, int32_t width, int32_t height)
+        : format_(format), width_(width), height_(height) {}
+
+void Ktx2Writer::addLevel(std::vector<uint8_t> data) {
+    levels_.push_back(std::move(data));
+}
+
+bool Ktx2Writer::serialize(std::vector<uint8_t> &out) const {
+    if (levels_.empty()) {
+        LOGE("KTX2文件至少要有一个层级");
+        return false;
+    }
+    bool supercompressed = zstdLevel_ > 0;
+    std::vector<std::vector<uint8_t>> compressed(supercompressed ? levels_.size() : 0);
+    for (size_t i = 0; i < levels_.size(); i++) {
+        int32_t width = std::max<int32_t>(1, width_ >> i);
+        int32_t height = std::max<int32_t>(1, height_ >> i);
+        size_t expected = format_.levelSize(width, height);
+        if (levels_[i].size() != expected) {
+            LOGE("%s 第%zu层 %dx%d 应为 %zu 字节，实际 %zu 字节", format_.name, i, width, height, expected,
+                 levels_[i].size());
+            return false;
+        }
+        if (supercompressed) {
+#if TEXTURE_ZSTD
+            compressed[i].resize(ZSTD_compressBound(expected));
+            size_t size = ZSTD_compress(compressed[i].data(), compressed[i].size(), levels_[i].data(), expected,
+                                        zstdLevel_);
+            if (ZSTD_isError(size)) {
+                LOGE("zstd压缩第%zu层失败: %s", i, ZSTD_getErrorName(size));
+                return false;
+            }
+            compressed[i].resize(size);
+#else
+            LOGE("本构建没有zstd支持（TEXTURE_ZSTD）");
+            return false;
+#endif
+        }
+    }
+
+    std::vector<uint8_t> dfd = basicDfd(format_, supercompressed);
+    Ktx2Header header = {};
+    memcpy(header.identifier, Ktx2Header::kIdentifier, sizeof(header.identifier));
+    header.vkFormat = format_.vkFormat;
+    header.typeSize = 1;
+    header.pixelWidth = uint32_t(width_);
+    header.pixelHeight = uint32_t(height_);
+    header.faceCount = 1;
+    header.levelCount = uint32_t(levels_.size());
+    header.supercompressionScheme = uint32_t(supercompressed ? Ktx2Supercompression::Zstd
+                                                             : Ktx2Supercompression::None);
+    header.dfdByteOffset = uint32_t(sizeof(Ktx2Header) + sizeof(Ktx2Level) * levels_.size());
+    header.dfdByteLength = uint32_t(dfd.size());
+
+    // 规范要求从最小的层级开始存放；没有超压缩时每层按块大小和4的最小公倍数对齐
+    size_t alignment = supercompressed ? 1 : std::max<size_t>(4, format_.blockBytes);
+    std::vector<Ktx2Level> index(levels_.size());
+    size_t offset = header.dfdByteOffset + dfd.size();
+    for (size_t i = levels_.size(); i-- > 0;) {
+        const std::vector<uint8_t> &data = supercompressed ? compressed[i] : levels_[i];
+        offset = alignUp(offset, alignment);
+        index[i].byteOffset = offset;
+        index[i].byteLength = data.size();
+        index[i].uncompressedByteLength = levels_[i].size();
+        offset += data.size();
+    }
+
+    out.assign(offset, 0);
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), index.data(), sizeof(Ktx2Level) * index.size());
+    memcpy(out.data() + header.dfdByteOffset, dfd.data(), dfd.size());
+    for (size_t i = 0; i < levels_.size(); i++) {
+        const std::vector<uint8_t> &data = supercompressed ? compressed[i] : levels_[i];
+        memcpy(out.data() + index[i].byteOffset, data.data(), data.size());
+    }
+    return true;
+}
+
+bool Ktx2Writer::write(const std::string &path) const {
+    std::vector<uint8_t> data;
+    if (!serialize(data)) {
+        return false;
+    }
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        LOGE("无法创建文件 %s", path.c_str());
+        return false;
+    }
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        LOGE("写入 %s 失败", path.c_str());
+    }
+    return written;
+}
+
+bool Ktx2File::isKtx2(const uint8_t *data, size_t size) {
+    return size >= sizeof(Ktx2Header::kIdentifier)
+           && memcmp(data, Ktx2Header::kIdentifier, sizeof(Ktx2Header::kIdentifier)) == 0;
+}
+
+bool Ktx2File::zstdSupported() {
+#if TEXTURE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Ktx2File::parse(const uint8_t *data, size_t size) {
+    data_ = nullptr;
+    size_ = 0;
+    format_ = nullptr;
+    levels_.clear();
+
+    if (size < sizeof(Ktx2Header) || !isKtx2(data, size)) {
+        LOGE("不是KTX2文件");
+        return false;
+    }
+    Ktx2Header header;
+    memcpy(&header, data, sizeof(header));
+    const TextureFormat *format = TextureFormat::find(header.vkFormat);
+    if (!format) {
+        LOGE("不支持的VkFormat %u", header.vkFormat);
+        return false;
+    }
+    // GLES设备的纹理尺寸上限不超过16384，同时限制了zstd解压时分配的内存
+    constexpr uint32_t kMaxDimension = 1u << 14;
+    if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelWidth > kMaxDimension
+        || header.pixelHeight > kMaxDimension) {
+        LOGE("纹理尺寸无效: %ux%u", header.pixelWidth, header.pixelHeight);
+        return false;
+    }
+    if (header.pixelDepth != 0 || header.layerCount > 1 || header.faceCount != 1) {
+        LOGE("只支持单个2D纹理: 深度 %u 层数 %u 面数 %u", header.pixelDepth, header.layerCount, header.faceCount);
+        return false;
+    }
+    auto scheme = Ktx2Supercompression(header.supercompressionScheme);
+    if (scheme != Ktx2Supercompression::None && (scheme != Ktx2Supercompression::Zstd || !zstdSupported())) {
+        LOGE("不支持的超压缩方式 %u", header.supercompressionScheme);
+        return false;
+    }
+    uint32_t maxLevels = 1;
+    while ((std::max(header.pixelWidth, header.pixelHeight) >> maxLevels) > 0) {
+        maxLevels++;
+    }
+    uint32_t levelCount = std::max<uint32_t>(1, header.levelCount);
+    if (levelCount > maxLevels || sizeof(Ktx2Header) + sizeof(Ktx2Level) * levelCount > size) {
+        LOGE("层级数 %u 无效", header.levelCount);
+        return false;
+    }
+
+    width_ = int32_t(header.pixelWidth);
+    height_ = int32_t(header.pixelHeight);
+    levels_.resize(levelCount);
+    memcpy(levels_.data(), data + sizeof(Ktx2Header), sizeof(Ktx2Level) * levelCount);
+    for (size_t i = 0; i < levels_.size(); i++) {
+        const Ktx2Level &level = levels_[i];
+        uint64_t expected = format->levelSize(levelWidth(i), levelHeight(i));
+        bool inFile = level.byteOffset <= size && level.byteLength <= size - level.byteOffset;
+        bool sizeMatches = level.uncompressedByteLength == expected
+                           && (scheme != Ktx2Supercompression::None || level.byteLength == expected);
+        if (!inFile || !sizeMatches || level.byteLength == 0) {
+            LOGE("第%zu层的范围无效: 偏移 %llu 长度 %llu 解压后 %llu", i,
+                 (unsigned long long) level.byteOffset, (unsigned long long) level.byteLength,
+                 (unsigned long long) level.uncompressedByteLength);
+            levels_.clear();
+            return false;
+        }
+    }
+    data_ = data;
+    size_ = size;
+    format_ = format;
+    supercompression_ = scheme;
+    return true;
+}
+
+bool Ktx2File::levelData(size_t level, std::vector<uint8_t> &scratch, const uint8_t *&out) const {
+    const Ktx2Level &entry = levels_[level];
+    const uint8_t *source = data_ + entry.byteOffset;
+    if (supercompression_ == Ktx2Supercompression::None) {
+        out = source;
+        return true;
+    }
+#if TEXTURE_ZSTD
+    scratch.resize(entry.uncompressedByteLength);
+    size_t size = ZSTD_decompress(scratch.data(), scratch.size(), source, entry.byteLength);
+    if (ZSTD_isError(size) || size != scratch.size()) {
+        LOGE("zstd解压第%zu层失败: %s", level, ZSTD_isError(size) ? ZSTD_getErrorName(size) : "长度不符");
+        return false;
+    }
+    out = scratch.data();
+    return true;
+#else
+    (void) scratch;
+    return false;
+#endif
+}
@@ -0,0 +1,147 @@
+#ifndef ANDROIDGLINVESTIGATIONS_KTX2_H
+#define ANDROIDGLINVESTIGATIONS_KTX2_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TextureFormat.h"
+
+/*
+ * KTX 2.0纹理容器（.ktx2）。所有数值都是小端序，偏移从文件开头算起：
+ *
+ *   Ktx2Header
+ *   Ktx2Level[levelCount]        层级索引，第0层是最大的层级
+ *   数据格式描述（DFD）
+ *   键值数据、超压缩全局数据（本实现不写，读取时忽略）
+ *   各层级的数据，从最小的层级开始存放
+ *
+ * 只支持单个2D图像（没有数组层、立方体面和深度）。超压缩只支持zstd，每个层级单独压缩；
+ * 编译时没有定义TEXTURE_ZSTD的构建无法读写zstd压缩的文件。
+ */
+
+//! 超压缩方式
+enum class Ktx2Supercompression : uint32_t {
+    None = 0,
+    Zstd = 2,
+};
+
+struct Ktx2Header {
+    static constexpr uint8_t kIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    uint8_t identifier[12];
+    uint32_t vkFormat;    // TextureFormat::vkFormat
+    uint32_t typeSize;    // 数据的字节序单位，8位格式和块压缩格式都是1
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;  // 2D纹理为0
+    uint32_t layerCount;  // 不是数组时为0
+    uint32_t faceCount;   // 1
+    uint32_t levelCount;  // 0表示只有第0层、需要运行时生成mip
+    uint32_t supercompressionScheme; // Ktx2Supercompression
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct Ktx2Level {
+    uint64_t byteOffset;
+    uint64_t byteLength;             // 文件中的长度，超压缩时是压缩后的长度
+    uint64_t uncompressedByteLength; // 解压后的长度
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "Ktx2Header的大小是格式的一部分");
+static_assert(sizeof(Ktx2Level) == 24, "Ktx2Level的大小是格式的一部分");
+
+/*!
+ * 把已经编码好的层级写成.ktx2文件，通常由主机上的ktx2encoder工具调用
+ */
+class Ktx2Writer {
+public:
+    Ktx2Writer(const TextureFormat &format, int32_t width, int32_t height);
+
+    /*!
+     * 按从大到小的顺序添加层级，第i层的尺寸是 max(1, width >> i) x max(1, height >> i)
+     */
+    void addLevel(std::vector<uint8_t> data);
+
+    /*!
+     * 用zstd压缩每个层级
+     * @param level zstd的压缩级别，0表示不压缩
+     */
+    inline void setZstdLevel(int level) { zstdLevel_ = level; }
+
+    /*!
+     * @return 文件无法写入或压缩失败时返回false并输出日志
+     */
+    bool write(const std::string &path) const;
+
+    /*!
+     * 生成整个文件的内容
+     * @return 层级尺寸不符或压缩失败时返回false并输出日志
+     */
+    bool serialize(std::vector<uint8_t> &out) const;
+
+private:
+    const TextureFormat &format_;
+    int32_t width_;
+    int32_t height_;
+    std::vector<std::vector<uint8_t>> levels_;
+    int zstdLevel_ = 0;
+};
+
+/*!
+ * 解析内存中的.ktx2文件。文件数据由调用者持有，必须比本对象活得更久；
+ * 解析时检查文件头、层级索引和每个层级的大小，不复制数据。
+ */
+class Ktx2File {
+public:
+    //! @return 数据是否以KTX2的标识开头
+    static bool isKtx2(const uint8_t *data, size_t size);
+
+    //! @return 本构建能否读写zstd超压缩的文件
+    static bool zstdSupported();
+
+    /*!
+     * @return 文件无效、格式不支持或使用了不支持的超压缩时返回false并输出日志
+     */
+    bool parse(const uint8_t *data, size_t size);
+
+    inline const TextureFormat &format() const { return *format_; }
+
+    inline int32_t width() const { return width_; }
+
+    inline int32_t height() const { return height_; }
+
+    inline size_t levelCount() const { return levels_.size(); }
+
+    inline Ktx2Supercompression supercompression() const { return supercompression_; }
+
+    inline int32_t levelWidth(size_t level) const { return std::max<int32_t>(1, width_ >> level); }
+
+    inline int32_t levelHeight(size_t level) const { return std::max<int32_t>(1, height_ >> level); }
+
+    /*!
+     * 取得一个层级的数据。没有超压缩时直接指向文件数据，否则解压到scratch中
+     * @param scratch 解压缓冲区，可以在各层级之间复用
+     * @param out 输出数据地址，长度是 format().levelSize(levelWidth(level), levelHeight(level))
+     * @return 解压失败时返回false并输出日志
+     */
+    bool levelData(size_t level, std::vector<uint8_t> &scratch, const uint8_t *&out) const;
+
+private:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    const TextureFormat *format_ = nullptr;
+    int32_t width_ = 0;
+    int32_t height_ = 0;
+    Ktx2Supercompression supercompression_ = Ktx2Supercompression::None;
+    std::vector<Ktx2Level> levels_;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_KTX2_H
@@ -0,0 +1,67 @@
+#include "LevelOfDetail.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<LodLevel> LevelOfDetail::buildChain(
+        const std::vector<Vertex> &vertices,
+        const std::vector<Index> &indices,
+        size_t maxLevels,
+        float reduction,
+        const SimplifyOptions &options) {
+    std::vector<LodLevel> levels;
+    if (maxLevels == 0) {
+        return levels;
+    }
+    levels.push_back(LodLevel{indices, 0.f});
+
+    while (levels.size() < maxLevels) {
+        const LodLevel &previous = levels.back();
+        size_t targetIndexCount = size_t(float(previous.indices.size() / 3) * reduction) * 3;
+        auto simplified = MeshSimplifier::simplify(vertices, previous.indices, targetIndexCount, options);
+
+        // 减少得太少说明已经到了误差上限或者无法继续收缩
+        if (simplified.indices.empty()
+            || simplified.indices.size() > previous.indices.size() * 9 / 10) {
+            break;
+        }
+        // 每层从上一层简化，相对原始网格的误差不超过两次误差之和
+        float error = previous.error + simplified.error;
+        levels.push_back(LodLevel{std::move(simplified.indices), error});
+    }
+    return levels;
+}
+
+float LevelOfDetail::pixelsPerUnitPerspective(float distance, float fovY, float viewportHeight) {
+    if (distance <= 0.f) {
+        return INFINITY;
+    }
+    return viewportHeight / (2.f * distance * std::tan(0.5f * fovY));
+}
+
+float LevelOfDetail::pixelsPerUnitOrthographic(float halfHeight, float viewportHeight) {
+    return viewportHeight / (2.f * halfHeight);
+}
+
+float LevelOfDetail::maxAxisScale(const Mat4 &matrix) {
+    float maxLength2 = 0.f;
+    for (int column = 0; column < 3; column++) {
+        const float *axis = &matrix.m[column * 4];
+        maxLength2 = std::max(maxLength2, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    }
+    return std::sqrt(maxLength2);
+}
+
+size_t LevelOfDetail::selectLevel(
+        const std::vector<float> &levelErrors,
+        float pixelsPerUnit,
+        float thresholdPixels) {
+    size_t level = 0;
+    for (size_t i = 1; i < levelErrors.size(); i++) {
+        if (levelErrors[i] * pixelsPerUnit > thresholdPixels) {
+            break;
+        }
+        level = i;
+    }
+    return level;
+}
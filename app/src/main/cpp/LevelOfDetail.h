@@ -0,0 +1,69 @@
+#ifndef ANDROIDGLINVESTIGATIONS_LEVELOFDETAIL_H
+#define ANDROIDGLINVESTIGATIONS_LEVELOFDETAIL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "MeshSimplifier.h"
+#include "VecMath.h"
+
+/*!
+ * 一个细节层次：共用原始顶点缓冲的索引列表，以及它相对原始网格的误差
+ */
+struct LodLevel {
+    std::vector<Index> indices;
+    float error = 0.f; // 物体空间中的误差
+};
+
+/*!
+ * 细节层次链的生成与选择
+ */
+class LevelOfDetail {
+public:
+    /*!
+     * 导入时生成细节层次链。第0层是原始网格，之后每层从上一层简化，三角形数是上一层的 @a reduction 倍，
+     * 误差取上一层误差与本次简化误差之和。某一层减少不到10%时停止。
+     * @param maxLevels 最多生成的层数（包括第0层）
+     * @param reduction 每层三角形数相对上一层的比例
+     */
+    static std::vector<LodLevel> buildChain(
+            const std::vector<Vertex> &vertices,
+            const std::vector<Index> &indices,
+            size_t maxLevels,
+            float reduction = 0.5f,
+            const SimplifyOptions &options = SimplifyOptions());
+
+    /*!
+     * 透视投影下物体空间中一个单位在屏幕上的像素数
+     * @param distance 物体到相机的距离
+     * @param fovY 垂直视野（弧度）
+     * @param viewportHeight 视口高度（像素）
+     */
+    static float pixelsPerUnitPerspective(float distance, float fovY, float viewportHeight);
+
+    /*!
+     * 正交投影下物体空间中一个单位在屏幕上的像素数
+     * @param halfHeight 投影矩阵的半高
+     * @param viewportHeight 视口高度（像素）
+     */
+    static float pixelsPerUnitOrthographic(float halfHeight, float viewportHeight);
+
+    /*!
+     * 矩阵左上3x3部分的最大轴向缩放，用于把物体空间误差换算到世界空间
+     */
+    static float maxAxisScale(const Mat4 &matrix);
+
+    /*!
+     * 选择投影到屏幕上误差不超过阈值的最粗的层次
+     * @param levelErrors 每层的物体空间误差，按层次从细到粗排列
+     * @param pixelsPerUnit 物体空间一个单位对应的像素数，已包含物体的缩放
+     * @param thresholdPixels 允许的屏幕空间误差（像素）
+     * @return 层次编号
+     */
+    static size_t selectLevel(
+            const std::vector<float> &levelErrors,
+            float pixelsPerUnit,
+            float thresholdPixels = 1.f);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_LEVELOFDETAIL_H
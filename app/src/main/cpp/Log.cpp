@@ -0,0 +1,304 @@
+#include "Log.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+namespace {
+
+//! 每个线程环形缓冲区的记录数，必须是2的幂
+constexpr uint32_t kRingCapacity = 256;
+
+//! 后台线程在没有flush请求时的唤醒间隔
+constexpr auto kDrainInterval = std::chrono::milliseconds(5);
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t currentThreadId() {
+    static thread_local uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+char levelLetter(LogLevel level) {
+    static constexpr char kLetters[] = {'V', 'D', 'I', 'W', 'E', '-'};
+    return kLetters[static_cast<uint8_t>(level)];
+}
+
+// 把记录格式化成一行文本，Stdout和File输出端共用
+void printRecord(FILE *file, const LogRecord &record) {
+    fprintf(file, "%llu.%06llu %c/%s(%u): %s\n",
+            static_cast<unsigned long long>(record.timestampNs / 1000000000ull),
+            static_cast<unsigned long long>((record.timestampNs / 1000ull) % 1000000ull),
+            levelLetter(record.level),
+            record.tag,
+            record.threadId,
+            record.message);
+}
+
+} // namespace
+
+/*!
+ * 单生产者/单消费者环形缓冲区。生产者是拥有它的线程，消费者是后台排空线程。
+ * head_只由生产者写，tail_只由消费者写
+ */
+struct Logger::ThreadBuffer {
+    LogRecord records[kRingCapacity];
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<bool> alive{true}; // 所属线程退出后为false，排空后可被回收
+
+    // 生产者：取得下一个可写槽位，缓冲区满时返回null
+    inline LogRecord *acquire() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= kRingCapacity) {
+            return nullptr;
+        }
+        return &records[h & (kRingCapacity - 1)];
+    }
+
+    // 生产者：发布刚写好的槽位
+    inline void commit() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 消费者：把所有已发布的记录交给输出端，返回处理的条数
+    uint32_t drainTo(LogSink *sink) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        for (uint32_t i = t; i != h; ++i) {
+            if (sink) {
+                sink->write(records[i & (kRingCapacity - 1)]);
+            }
+        }
+        tail.store(h, std::memory_order_release);
+        return h - t;
+    }
+
+    inline bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+    }
+};
+
+struct Logger::Impl {
+    std::mutex mutex; // 保护buffers、sink以及flush相关的计数
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::unique_ptr<LogSink> sink;
+    uint64_t flushRequested = 0;
+    uint64_t flushCompleted = 0;
+    bool running = true;
+    std::thread worker;
+};
+
+namespace {
+
+// 线程退出时通知后台线程该缓冲区可以在排空后回收
+struct ThreadBufferHolder {
+    std::shared_ptr<void> buffer;
+    std::atomic<bool> *alive = nullptr;
+
+    ~ThreadBufferHolder() {
+        if (alive) {
+            alive->store(false, std::memory_order_release);
+        }
+    }
+};
+
+} // namespace
+
+Logger &Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+        : level_(static_cast<uint8_t>(LogLevel::Debug)),
+          dropped_(0),
+          impl_(new Impl) {
+#ifdef __ANDROID__
+    impl_->sink = std::make_unique<LogcatSink>();
+#else
+    impl_->sink = std::make_unique<StdoutSink>();
+#endif
+    impl_->worker = std::thread([this] { drainLoop(); });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->running = false;
+    }
+    impl_->wake.notify_one();
+    if (impl_->worker.joinable()) {
+        impl_->worker.join();
+    }
+}
+
+void Logger::setSink(std::unique_ptr<LogSink> sink) {
+    flush();
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->sink.swap(sink);
+}
+
+Logger::ThreadBuffer *Logger::threadBuffer() {
+    static thread_local ThreadBufferHolder holder;
+    if (!holder.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        {
+            std::lock_guard<std::mutex> lock(impl_->mutex);
+            impl_->buffers.push_back(buffer);
+        }
+        holder.alive = &buffer->alive;
+        holder.buffer = buffer;
+    }
+    return static_cast<ThreadBuffer *>(holder.buffer.get());
+}
+
+void Logger::write(LogLevel level, const char *tag, const char *format, ...) {
+    if (!isEnabled(level)) {
+        return;
+    }
+    auto *buffer = threadBuffer();
+    auto *record = buffer->acquire();
+    if (!record) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(record->message, LogRecord::kMaxMessageLength, format, args);
+    va_end(args);
+
+    record->timestampNs = nowNs();
+    record->threadId = currentThreadId();
+    record->level = level;
+    record->tag = tag;
+    buffer->commit();
+}
+
+void Logger::writeMessage(LogLevel level, const char *tag, const char *message) {
+    if (!isEnabled(level)) {
+        return;
+    }
+    auto *buffer = threadBuffer();
+    auto *record = buffer->acquire();
+    if (!record) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    strncpy(record->message, message, LogRecord::kMaxMessageLength - 1);
+    record->message[LogRecord::kMaxMessageLength - 1] = '\0';
+
+    record->timestampNs = nowNs();
+    record->threadId = currentThreadId();
+    record->level = level;
+    record->tag = tag;
+    buffer->commit();
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(impl_->mutex);
+    if (!impl_->running) {
+        return;
+    }
+    uint64_t ticket = ++impl_->flushRequested;
+    impl_->wake.notify_one();
+    impl_->drained.wait(lock, [this, ticket] {
+        return impl_->flushCompleted >= ticket || !impl_->running;
+    });
+}
+
+void Logger::drainLoop() {
+    std::unique_lock<std::mutex> lock(impl_->mutex);
+    for (;;) {
+        uint64_t ticket = impl_->flushRequested;
+        bool stopping = !impl_->running;
+
+        // 排空所有线程的缓冲区，并回收已经退出且为空的线程缓冲区
+        uint32_t written = 0;
+        auto &buffers = impl_->buffers;
+        for (size_t i = 0; i < buffers.size();) {
+            written += buffers[i]->drainTo(impl_->sink.get());
+            if (!buffers[i]->alive.load(std::memory_order_acquire) && buffers[i]->empty()) {
+                buffers[i] = std::move(buffers.back());
+                buffers.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        if (written && impl_->sink) {
+            impl_->sink->flush();
+        }
+
+        impl_->flushCompleted = ticket;
+        impl_->drained.notify_all();
+
+        if (stopping) {
+            break;
+        }
+        impl_->wake.wait_for(lock, kDrainInterval, [this, ticket] {
+            return impl_->flushRequested != ticket || !impl_->running;
+        });
+    }
+}
+
+#ifdef __ANDROID__
+
+void LogcatSink::write(const LogRecord &record) {
+    static constexpr int kPriorities[] = {
+            ANDROID_LOG_VERBOSE,
+            ANDROID_LOG_DEBUG,
+            ANDROID_LOG_INFO,
+            ANDROID_LOG_WARN,
+            ANDROID_LOG_ERROR,
+            ANDROID_LOG_ERROR,
+    };
+    __android_log_write(kPriorities[static_cast<uint8_t>(record.level)], record.tag, record.message);
+}
+
+#endif
+
+void StdoutSink::write(const LogRecord &record) {
+    printRecord(stdout, record);
+}
+
+void StdoutSink::flush() {
+    fflush(stdout);
+}
+
+FileSink::FileSink(const std::string &path) : file_(fopen(path.c_str(), "a")) {}
+
+FileSink::~FileSink() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void FileSink::write(const LogRecord &record) {
+    if (file_) {
+        printRecord(file_, record);
+    }
+}
+
+void FileSink::flush() {
+    if (file_) {
+        fflush(file_);
+    }
+}
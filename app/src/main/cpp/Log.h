@@ -0,0 +1,199 @@
+#ifndef ANDROIDGLINVESTIGATIONS_LOG_H
+#define ANDROIDGLINVESTIGATIONS_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+/*!
+ * 日志级别，数值越大越严重。Off 用于关闭全部输出
+ */
+enum class LogLevel : uint8_t {
+    Verbose = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Off = 5,
+};
+
+/*!
+ * 编译期最低日志级别（数值同LogLevel）。低于该级别的LOGx调用点在编译期被整体裁掉，
+ * 参数也不会被求值。可以在CMake中通过 -DLOG_COMPILE_LEVEL=N 覆盖
+ */
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL 2
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+constexpr LogLevel kLogCompileLevel = static_cast<LogLevel>(LOG_COMPILE_LEVEL);
+
+//! 默认的log标签，与原先AndroidOut使用的标签保持一致
+#ifndef LOG_TAG
+#define LOG_TAG "AO"
+#endif
+
+/*!
+ * 单条日志记录。定长，便于放入无锁环形缓冲区而不需要堆分配
+ */
+struct LogRecord {
+    static constexpr size_t kMaxMessageLength = 232;
+
+    uint64_t timestampNs; // 单调时钟时间戳（纳秒）
+    uint32_t threadId;    // 写入线程的系统线程id
+    LogLevel level;       // 日志级别
+    const char *tag;      // 日志标签，必须指向静态存储期的字符串
+    char message[kMaxMessageLength]; // 已格式化的消息，以'\0'结尾
+};
+
+/*!
+ * 日志输出端。由后台线程调用，实现不需要考虑线程安全
+ */
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    /*!
+     * 输出一条日志
+     * @param record 要输出的记录
+     */
+    virtual void write(const LogRecord &record) = 0;
+
+    /*!
+     * 一批记录输出完毕后调用，可用于刷新文件缓冲
+     */
+    virtual void flush() {}
+};
+
+#ifdef __ANDROID__
+
+//! 输出到logcat
+class LogcatSink : public LogSink {
+public:
+    void write(const LogRecord &record) override;
+};
+
+#endif
+
+//! 输出到标准输出，主要用于Linux上的工具和测试
+class StdoutSink : public LogSink {
+public:
+    void write(const LogRecord &record) override;
+
+    void flush() override;
+};
+
+//! 输出到文件，文件无法打开时所有记录被丢弃
+class FileSink : public LogSink {
+public:
+    explicit FileSink(const std::string &path);
+
+    ~FileSink() override;
+
+    void write(const LogRecord &record) override;
+
+    void flush() override;
+
+private:
+    FILE *file_;
+};
+
+/*!
+ * 异步日志系统。
+ *
+ * 每个写日志的线程拥有自己的单生产者/单消费者环形缓冲区，写入只做一次格式化和两次原子操作，
+ * 不加锁也不做系统调用。后台线程定期把所有缓冲区排空到当前的 @a LogSink。
+ * 缓冲区满时新记录会被丢弃并计数，而不会阻塞渲染线程。
+ */
+class Logger {
+public:
+    /*!
+     * @return 全局唯一的日志实例，首次调用时启动后台线程
+     */
+    static Logger &instance();
+
+    /*!
+     * 设置运行期日志级别，低于该级别的记录在格式化之前就被丢弃
+     */
+    inline void setLevel(LogLevel level) {
+        level_.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+
+    inline LogLevel getLevel() const {
+        return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+    }
+
+    inline bool isEnabled(LogLevel level) const {
+        return static_cast<uint8_t>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * 替换输出端。旧的输出端会在排空当前所有记录之后才被销毁
+     * @param sink 新的输出端，为null时日志被丢弃
+     */
+    void setSink(std::unique_ptr<LogSink> sink);
+
+    /*!
+     * 格式化并写入一条日志。通常不直接调用，而是使用LOGx宏
+     */
+    void write(LogLevel level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+    /*!
+     * 写入一条已经格式化好的消息，超长部分会被截断
+     */
+    void writeMessage(LogLevel level, const char *tag, const char *message);
+
+    /*!
+     * 阻塞直到调用之前写入的记录全部交给了输出端
+     */
+    void flush();
+
+    /*!
+     * @return 因缓冲区满而被丢弃的记录数
+     */
+    inline uint64_t getDroppedCount() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    ~Logger();
+
+private:
+    struct ThreadBuffer;
+    struct Impl;
+
+    Logger();
+
+    ThreadBuffer *threadBuffer();
+
+    void drainLoop();
+
+    std::atomic<uint8_t> level_;
+    std::atomic<uint64_t> dropped_;
+    std::unique_ptr<Impl> impl_;
+};
+
+/*!
+ * 日志宏。级别低于LOG_COMPILE_LEVEL的调用点在编译期消失；
+ * 其余调用点在运行期级别关闭时只有一次relaxed原子读
+ */
+#define LOG_AT(lvl, ...) \
+    do { \
+        if ((lvl) >= kLogCompileLevel \
+            && Logger::instance().isEnabled(lvl)) { \
+            Logger::instance().write(lvl, LOG_TAG, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOGV(...) LOG_AT(LogLevel::Verbose, __VA_ARGS__)
+#define LOGD(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOGI(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOGW(...) LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOGE(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+#endif //ANDROIDGLINVESTIGATIONS_LOG_H
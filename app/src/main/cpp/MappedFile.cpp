@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        mapping_ = other.mapping_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapping_ = nullptr;
+#ifdef __ANDROID__
+        asset_ = other.asset_;
+        other.asset_ = nullptr;
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("无法打开文件 %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat info = {};
+    if (fstat(fd, &info) != 0) {
+        LOGE("无法读取文件信息 %s: %s", path.c_str(), strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ == 0) {
+        // 空文件不能映射，用一个非空指针表示已打开
+        static const uint8_t kEmpty = 0;
+        data_ = &kEmpty;
+        ::close(fd);
+        return true;
+    }
+    void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符就不再需要
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        LOGE("无法映射文件 %s: %s", path.c_str(), strerror(errno));
+        size_ = 0;
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<const uint8_t *>(mapping);
+    return true;
+}
+
+#ifdef __ANDROID__
+bool MappedFile::openAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    close();
+    asset_ = AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
+    if (!asset_) {
+        LOGE("无法打开资源 %s", assetPath.c_str());
+        return false;
+    }
+    data_ = static_cast<const uint8_t *>(AAsset_getBuffer(asset_));
+    size_ = static_cast<size_t>(AAsset_getLength(asset_));
+    if (!data_) {
+        LOGE("无法映射资源 %s", assetPath.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+#endif
+
+void MappedFile::close() {
+    if (mapping_) {
+        munmap(mapping_, size_);
+        mapping_ = nullptr;
+    }
+#ifdef __ANDROID__
+    if (asset_) {
+        AAsset_close(asset_);
+        asset_ = nullptr;
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MAPPEDFILE_H
+#define ANDROIDGLINVESTIGATIONS_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+/*!
+ * 只读映射的文件。普通文件用mmap映射，Android资源用AAsset_getBuffer取得
+ * （未压缩的资源由系统直接映射APK，同样没有拷贝）。析构时解除映射
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    /*!
+     * 映射文件系统中的文件
+     * @return 失败时返回false并输出日志
+     */
+    bool open(const std::string &path);
+
+#ifdef __ANDROID__
+    /*!
+     * 映射assets/目录中的资源
+     * @return 失败时返回false并输出日志
+     */
+    bool openAsset(AAssetManager *assetManager, const std::string &assetPath);
+#endif
+
+    void close();
+
+    inline const uint8_t *data() const { return data_; }
+
+    inline size_t size() const { return size_; }
+
+    inline bool isOpen() const { return data_ != nullptr; }
+
+private:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    void *mapping_ = nullptr;  // mmap返回的地址，munmap时使用
+#ifdef __ANDROID__
+    AAsset *asset_ = nullptr;
+#endif
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MAPPEDFILE_H
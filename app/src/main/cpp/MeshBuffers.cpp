@@ -0,0 +1,154 @@
+#include "MeshBuffers.h"
+
+#include <utility>
+
+namespace {
+
+GLenum glUsage(BufferUsage usage) {
+    switch (usage) {
+        case BufferUsage::Static:
+            return GL_STATIC_DRAW;
+        case BufferUsage::Dynamic:
+            return GL_DYNAMIC_DRAW;
+        case BufferUsage::Stream:
+            return GL_STREAM_DRAW;
+    }
+    return GL_STATIC_DRAW;
+}
+
+/*!
+ * 设置并启用布局中存在且着色器用到的属性
+ * @param base 客户端数组的地址，或者顶点缓冲绑定在GL_ARRAY_BUFFER时的0（属性指针是缓冲内的偏移）
+ */
+void enableAttributes(const VertexLayout &layout, uintptr_t base, const VertexAttributeLocations &locations) {
+    auto enableAttribute = [&](GLint location, const VertexAttribute &attribute) {
+        if (location == -1 || !attribute.isPresent()) {
+            return;
+        }
+        glVertexAttribPointer(
+                location,
+                attribute.components,
+                attribute.type,
+                attribute.normalized,
+                layout.stride,
+                reinterpret_cast<const void *>(base + attribute.offset));
+        glEnableVertexAttribArray(location);
+    };
+    enableAttribute(locations.position, layout.position);
+    enableAttribute(locations.uv, layout.uv);
+    enableAttribute(locations.color, layout.color);
+}
+
+} // namespace
+
+MeshBuffers::~MeshBuffers() {
+    release();
+}
+
+MeshBuffers::MeshBuffers(MeshBuffers &&other) noexcept {
+    *this = std::move(other);
+}
+
+MeshBuffers &MeshBuffers::operator=(MeshBuffers &&other) noexcept {
+    if (this != &other) {
+        release();
+        vertexBuffer_ = std::exchange(other.vertexBuffer_, 0);
+        indexBuffer_ = std::exchange(other.indexBuffer_, 0);
+        vertexArray_ = std::exchange(other.vertexArray_, 0);
+        arrayLocations_ = other.arrayLocations_;
+        vertexBytes_ = std::exchange(other.vertexBytes_, 0);
+        indexBytes_ = std::exchange(other.indexBytes_, 0);
+        usage_ = other.usage_;
+    }
+    return *this;
+}
+
+void MeshBuffers::upload(const void *vertices, size_t vertexBytes, const void *indices, size_t indexBytes,
+                         BufferUsage usage) {
+    release();
+    usage_ = usage;
+    vertexBytes_ = vertexBytes;
+    indexBytes_ = indexBytes;
+
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    vertexBuffer_ = buffers[0];
+    indexBuffer_ = buffers[1];
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertexBytes), vertices, glUsage(usage));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // 索引缓冲的绑定属于当前VAO，先解绑，以免改掉别的模型的VAO
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+    // 索引只随细节层次一起生成，不会逐帧修改
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indexBytes), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffers::updateVertices(size_t offset, const void *data, size_t size) {
+    if (!vertexBuffer_ || offset + size > vertexBytes_) {
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    if (usage_ == BufferUsage::Stream && offset == 0 && size == vertexBytes_) {
+        // 重新分配存储并写入，驱动可以在GPU读完之前把旧存储留给它
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(size), data, GL_STREAM_DRAW);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size), data);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffers::bindVertexArray(const VertexLayout &layout, const VertexAttributeLocations &locations) const {
+    if (vertexArray_ && arrayLocations_ == locations) {
+        glBindVertexArray(vertexArray_);
+        return;
+    }
+    if (vertexArray_) {
+        glDeleteVertexArrays(1, &vertexArray_);
+    }
+    glGenVertexArrays(1, &vertexArray_);
+    arrayLocations_ = locations;
+    glBindVertexArray(vertexArray_);
+
+    // 属性指针记录的是绑定时的GL_ARRAY_BUFFER，之后这个绑定本身不属于VAO
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    enableAttributes(layout, 0, locations);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+}
+
+void MeshBuffers::bindClientArrays(const VertexLayout &layout, const uint8_t *vertices,
+                                   const VertexAttributeLocations &locations) {
+    glBindVertexArray(0);
+    enableAttributes(layout, reinterpret_cast<uintptr_t>(vertices), locations);
+}
+
+void MeshBuffers::unbindClientArrays(const VertexLayout &layout, const VertexAttributeLocations &locations) {
+    auto disableAttribute = [](GLint location, const VertexAttribute &attribute) {
+        if (location != -1 && attribute.isPresent()) {
+            glDisableVertexAttribArray(location);
+        }
+    };
+    disableAttribute(locations.color, layout.color);
+    disableAttribute(locations.uv, layout.uv);
+    disableAttribute(locations.position, layout.position);
+}
+
+void MeshBuffers::release() {
+    if (vertexArray_) {
+        glDeleteVertexArrays(1, &vertexArray_);
+        vertexArray_ = 0;
+    }
+    if (vertexBuffer_) {
+        GLuint buffers[2] = {vertexBuffer_, indexBuffer_};
+        glDeleteBuffers(2, buffers);
+        vertexBuffer_ = 0;
+        indexBuffer_ = 0;
+    }
+    arrayLocations_ = VertexAttributeLocations{};
+    vertexBytes_ = 0;
+    indexBytes_ = 0;
+}
@@ -0,0 +1,106 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHBUFFERS_H
+#define ANDROIDGLINVESTIGATIONS_MESHBUFFERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <GLES3/gl3.h>
+
+#include "VertexFormat.h"
+
+enum class BufferUsage : uint8_t {
+    Static,  // 上传一次，之后不再修改（GL_STATIC_DRAW）
+    Dynamic, // 偶尔更新一部分（GL_DYNAMIC_DRAW），更新时原地覆盖
+    Stream,  // 几乎每帧整体重写（GL_STREAM_DRAW），整体更新时重新分配存储，不等GPU读完旧数据
+};
+
+//! 着色器中顶点属性的位置，-1表示着色器没有这个属性
+struct VertexAttributeLocations {
+    GLint position = -1;
+    GLint uv = -1;
+    GLint color = -1;
+
+    inline bool operator==(const VertexAttributeLocations &other) const {
+        return position == other.position && uv == other.uv && color == other.color;
+    }
+};
+
+/*!
+ * 模型在GPU上的顶点缓冲、索引缓冲和记录属性格式的VAO。
+ *
+ * 缓冲在加载时创建一次，绘制时只需绑定VAO再调用glDrawElements，索引用缓冲内的字节偏移，
+ * 驱动不再每次绘制拷贝客户端数组，也不再逐个启用和禁用属性。
+ * VAO在第一次绑定时按顶点布局和着色器的属性位置创建，位置改变时重新创建。
+ * 只能在GL线程使用，析构时删除GL对象
+ */
+class MeshBuffers {
+public:
+    MeshBuffers() = default;
+
+    ~MeshBuffers();
+
+    MeshBuffers(const MeshBuffers &) = delete;
+
+    MeshBuffers &operator=(const MeshBuffers &) = delete;
+
+    MeshBuffers(MeshBuffers &&other) noexcept;
+
+    MeshBuffers &operator=(MeshBuffers &&other) noexcept;
+
+    /*!
+     * 创建顶点和索引缓冲并上传数据，已有的缓冲先删除
+     * @param vertices 交错的顶点数据
+     * @param indices 所有细节层次的索引，绘制时按字节偏移选择
+     */
+    void upload(const void *vertices, size_t vertexBytes, const void *indices, size_t indexBytes,
+                BufferUsage usage);
+
+    /*!
+     * 覆盖顶点缓冲中从offset开始的size字节。
+     * Stream用途且覆盖整个缓冲时先丢弃旧存储（orphan），GPU可能还在读的旧数据不会造成等待
+     */
+    void updateVertices(size_t offset, const void *data, size_t size);
+
+    /*!
+     * 绑定VAO，之后可以直接用 glDrawElements 绘制，索引参数是缓冲内的字节偏移
+     * @param layout 顶点缓冲的布局
+     * @param locations 当前着色器的属性位置
+     */
+    void bindVertexArray(const VertexLayout &layout, const VertexAttributeLocations &locations) const;
+
+    /*!
+     * 没有上传的网格：绑定默认VAO，把客户端数组设置到属性上并启用。
+     * 之后 glDrawElements 的索引参数是内存地址，驱动每次绘制都要拷贝用到的顶点和全部索引
+     */
+    static void bindClientArrays(const VertexLayout &layout, const uint8_t *vertices,
+                                 const VertexAttributeLocations &locations);
+
+    //! 禁用 @a bindClientArrays 启用的属性
+    static void unbindClientArrays(const VertexLayout &layout, const VertexAttributeLocations &locations);
+
+    //! 删除所有GL对象
+    void release();
+
+    inline bool isUploaded() const {
+        return vertexBuffer_ != 0;
+    }
+
+    //! 缓冲占用的显存字节数
+    inline size_t getByteSize() const {
+        return vertexBytes_ + indexBytes_;
+    }
+
+    inline BufferUsage getUsage() const {
+        return usage_;
+    }
+
+private:
+    GLuint vertexBuffer_ = 0;
+    GLuint indexBuffer_ = 0;
+    mutable GLuint vertexArray_ = 0; // 第一次绑定时创建
+    mutable VertexAttributeLocations arrayLocations_; // 创建VAO时的属性位置
+    size_t vertexBytes_ = 0;
+    size_t indexBytes_ = 0;
+    BufferUsage usage_ = BufferUsage::Static;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHBUFFERS_H
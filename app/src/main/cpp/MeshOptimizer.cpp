@@ -0,0 +1,340 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+/*!
+ * 用时间戳模拟FIFO缓存：每次未命中时间加1，
+ * 顶点在缓存中当且仅当 time - cacheTime[v] <= cacheSize。
+ * 把time增加cacheSize + 1即可清空缓存。
+ */
+class FifoCache {
+public:
+    FifoCache(size_t vertexCount, size_t cacheSize)
+            : cacheTime_(vertexCount, 0),
+              cacheSize_(cacheSize),
+              time_(cacheSize + 1) {}
+
+    //! 访问顶点，未命中时返回true
+    inline bool access(Index vertex) {
+        if (time_ - cacheTime_[vertex] > cacheSize_) {
+            cacheTime_[vertex] = time_++;
+            return true;
+        }
+        return false;
+    }
+
+    inline void flush() {
+        time_ += cacheSize_ + 1;
+    }
+
+private:
+    std::vector<size_t> cacheTime_;
+    size_t cacheSize_;
+    size_t time_;
+};
+
+// 每个顶点引用它的三角形列表，按CSR格式存放
+struct Adjacency {
+    std::vector<uint32_t> offsets;   // 长度vertexCount + 1
+    std::vector<uint32_t> triangles;
+
+    Adjacency(const std::vector<Index> &indices, size_t vertexCount)
+            : offsets(vertexCount + 1, 0),
+              triangles(indices.size()) {
+        for (Index index: indices) {
+            offsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+};
+
+} // namespace
+
+VertexCacheStatistics MeshOptimizer::analyzeVertexCache(
+        const std::vector<Index> &indices,
+        size_t vertexCount,
+        size_t cacheSize) {
+    assert(indices.size() % 3 == 0);
+    VertexCacheStatistics statistics;
+    if (indices.empty() || vertexCount == 0) {
+        return statistics;
+    }
+
+    FifoCache cache(vertexCount, cacheSize);
+    for (Index index: indices) {
+        statistics.vertexTransforms += cache.access(index);
+    }
+    statistics.acmr = float(statistics.vertexTransforms) / float(indices.size() / 3);
+    statistics.atvr = float(statistics.vertexTransforms) / float(vertexCount);
+    return statistics;
+}
+
+// Sander等人的Tipsify：围绕一个扇心顶点输出它所有剩余的三角形，
+// 再从刚输出的顶点中挑一个仍在缓存中且剩余三角形足够少的作为下一个扇心
+void MeshOptimizer::optimizeVertexCache(
+        std::vector<Index> &indices,
+        size_t vertexCount,
+        size_t cacheSize) {
+    assert(indices.size() % 3 == 0);
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    Adjacency adjacency(indices, vertexCount);
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    std::vector<size_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<Index> deadEnd;
+    std::vector<Index> candidates;
+    std::vector<Index> output;
+    output.reserve(indices.size());
+
+    size_t time = cacheSize + 1;
+    size_t cursor = 0;
+
+    // 从死胡同栈或按顺序找下一个还有剩余三角形的顶点
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnd.empty()) {
+            Index vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        while (cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) {
+                return static_cast<int64_t>(cursor);
+            }
+            cursor++;
+        }
+        return -1;
+    };
+
+    int64_t fanning = skipDeadEnd();
+    while (fanning >= 0) {
+        candidates.clear();
+
+        for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+            uint32_t triangle = adjacency.triangles[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            for (int corner = 0; corner < 3; corner++) {
+                Index vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTime[vertex] > cacheSize) {
+                    cacheTime[vertex] = time++;
+                }
+            }
+            emitted[triangle] = 1;
+        }
+
+        // 优先选择在输出它剩余的三角形后仍会留在缓存中、且最早进入缓存的顶点
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for (Index vertex: candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            size_t age = time - cacheTime[vertex];
+            if (age + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = static_cast<int64_t>(age);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+        fanning = next >= 0 ? next : skipDeadEnd();
+    }
+
+    assert(output.size() == indices.size());
+    indices.swap(output);
+}
+
+// 思路与Sander等人的线性时间过度绘制优化相同：
+// 先把缓存优化后的三角形序列按缓存刷新点切成簇，再按允许的ACMR损失进一步细分，
+// 最后按“簇中心相对网格中心的偏移在簇法线上的投影”从大到小排序，朝外的簇先画。
+void MeshOptimizer::optimizeOverdraw(
+        std::vector<Index> &indices,
+        const std::vector<Vertex> &vertices,
+        float threshold,
+        size_t cacheSize) {
+    assert(indices.size() % 3 == 0);
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // 硬边界：三个顶点全部未命中的三角形，通常意味着开始了网格的新区域
+    std::vector<size_t> hardBoundaries;
+    {
+        FifoCache cache(vertices.size(), cacheSize);
+        for (size_t t = 0; t < triangleCount; t++) {
+            int misses = cache.access(indices[t * 3])
+                         + cache.access(indices[t * 3 + 1])
+                         + cache.access(indices[t * 3 + 2]);
+            if (misses == 3 || t == 0) {
+                hardBoundaries.push_back(t);
+            }
+        }
+        hardBoundaries.push_back(triangleCount);
+    }
+
+    // 软边界：在每个硬簇内，一旦从簇起点开始的ACMR降到阈值以下就切开
+    std::vector<size_t> clusters;
+    {
+        FifoCache cache(vertices.size(), cacheSize);
+        for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+            size_t start = hardBoundaries[h];
+            size_t end = hardBoundaries[h + 1];
+
+            cache.flush();
+            size_t clusterMisses = 0;
+            for (size_t t = start; t < end; t++) {
+                for (int corner = 0; corner < 3; corner++) {
+                    clusterMisses += cache.access(indices[t * 3 + corner]);
+                }
+            }
+            float clusterThreshold = threshold * float(clusterMisses) / float(end - start);
+
+            cache.flush();
+            clusters.push_back(start);
+            size_t runningMisses = 0;
+            size_t runningStart = start;
+            for (size_t t = start; t < end; t++) {
+                for (int corner = 0; corner < 3; corner++) {
+                    runningMisses += cache.access(indices[t * 3 + corner]);
+                }
+                if (t + 1 < end
+                    && float(runningMisses) / float(t + 1 - runningStart) <= clusterThreshold) {
+                    clusters.push_back(t + 1);
+                    cache.flush();
+                    runningMisses = 0;
+                    runningStart = t + 1;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+
+    const size_t clusterCount = clusters.size() - 1;
+    if (clusterCount < 2) {
+        return;
+    }
+
+    // 网格中心
+    double meshCenter[3] = {0.0, 0.0, 0.0};
+    for (Index index: indices) {
+        for (int axis = 0; axis < 3; axis++) {
+            meshCenter[axis] += vertices[index].position.idx[axis];
+        }
+    }
+    for (double &value: meshCenter) {
+        value /= double(indices.size());
+    }
+
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        double center[3] = {0.0, 0.0, 0.0};
+        double normal[3] = {0.0, 0.0, 0.0};
+        double totalArea = 0.0;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const Vector3 &p0 = vertices[indices[t * 3]].position;
+            const Vector3 &p1 = vertices[indices[t * 3 + 1]].position;
+            const Vector3 &p2 = vertices[indices[t * 3 + 2]].position;
+            double e1[3] = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+            double e2[3] = {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+            double n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                           e1[2] * e2[0] - e1[0] * e2[2],
+                           e1[0] * e2[1] - e1[1] * e2[0]};
+            // 叉积长度是面积的两倍，这里只需要相对权重
+            double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int axis = 0; axis < 3; axis++) {
+                center[axis] += area * (p0.idx[axis] + p1.idx[axis] + p2.idx[axis]) / 3.0;
+                normal[axis] += n[axis];
+            }
+            totalArea += area;
+        }
+
+        double normalLength = std::sqrt(
+                normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (totalArea <= 0.0 || normalLength <= 0.0) {
+            sortKey[c] = 0.f;
+            continue;
+        }
+        double key = 0.0;
+        for (int axis = 0; axis < 3; axis++) {
+            key += (center[axis] / totalArea - meshCenter[axis]) * normal[axis] / normalLength;
+        }
+        sortKey[c] = float(key);
+    }
+
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sortKey](size_t a, size_t b) {
+        return sortKey[a] > sortKey[b];
+    });
+
+    std::vector<Index> output;
+    output.reserve(indices.size());
+    for (size_t c: order) {
+        output.insert(output.end(),
+                      indices.begin() + clusters[c] * 3,
+                      indices.begin() + clusters[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+size_t MeshOptimizer::optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<Index> &indices) {
+    constexpr uint32_t kUnused = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(vertices.size(), kUnused);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (Index &index: indices) {
+        if (remap[index] == kUnused) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = static_cast<Index>(remap[index]);
+    }
+    vertices.swap(reordered);
+    return vertices.size();
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(
+        std::vector<Vertex> &vertices,
+        std::vector<Index> &indices,
+        size_t cacheSize) {
+    Report report;
+    report.before = analyzeVertexCache(indices, vertices.size(), cacheSize);
+
+    optimizeVertexCache(indices, vertices.size(), cacheSize);
+    optimizeOverdraw(indices, vertices, kDefaultOverdrawThreshold, cacheSize);
+    optimizeVertexFetch(vertices, indices);
+
+    report.after = analyzeVertexCache(indices, vertices.size(), cacheSize);
+    return report;
+}
@@ -0,0 +1,85 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHOPTIMIZER_H
+#define ANDROIDGLINVESTIGATIONS_MESHOPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "VertexFormat.h"
+
+/*!
+ * 顶点后变换缓存的统计结果
+ */
+struct VertexCacheStatistics {
+    size_t vertexTransforms = 0; // 缓存未命中、需要执行顶点着色器的次数
+    float acmr = 0.f;            // 平均每个三角形的未命中次数，理想值接近0.5
+    float atvr = 0.f;            // 未命中次数除以顶点数，理想值为1
+};
+
+/*!
+ * 导入时在CPU上运行的网格优化，只处理三角形列表（GL_TRIANGLES）。
+ *
+ * 推荐的顺序与 @a optimize 相同：
+ * 1. 顶点缓存优化（Tipsify），让相邻三角形尽量复用刚变换过的顶点；
+ * 2. 过度绘制优化，在不明显破坏缓存命中率的前提下把朝外的三角形簇排在前面；
+ * 3. 顶点读取优化，按索引首次出现的顺序重排顶点，同时丢掉未被引用的顶点。
+ */
+class MeshOptimizer {
+public:
+    //! 统计和优化时假设的FIFO缓存大小，与常见移动GPU接近
+    static constexpr size_t kDefaultCacheSize = 16;
+
+    //! 过度绘制优化允许ACMR变差的比例
+    static constexpr float kDefaultOverdrawThreshold = 1.05f;
+
+    struct Report {
+        VertexCacheStatistics before;
+        VertexCacheStatistics after;
+    };
+
+    /*!
+     * 用FIFO缓存模拟统计索引缓冲的ACMR/ATVR
+     * @param indices 三角形列表的索引
+     * @param vertexCount 顶点数
+     * @param cacheSize 缓存大小
+     */
+    static VertexCacheStatistics analyzeVertexCache(
+            const std::vector<Index> &indices,
+            size_t vertexCount,
+            size_t cacheSize = kDefaultCacheSize);
+
+    /*!
+     * Tipsify顶点缓存优化，就地重排三角形顺序
+     */
+    static void optimizeVertexCache(
+            std::vector<Index> &indices,
+            size_t vertexCount,
+            size_t cacheSize = kDefaultCacheSize);
+
+    /*!
+     * 过度绘制优化。应在 @a optimizeVertexCache 之后调用，
+     * 它只在缓存优化结果的基础上调整三角形簇的顺序。
+     * @param threshold 允许ACMR变差的比例，1.0表示只使用缓存刷新点作为簇边界
+     */
+    static void optimizeOverdraw(
+            std::vector<Index> &indices,
+            const std::vector<Vertex> &vertices,
+            float threshold = kDefaultOverdrawThreshold,
+            size_t cacheSize = kDefaultCacheSize);
+
+    /*!
+     * 按索引首次出现的顺序重排顶点并改写索引，未被引用的顶点会被删除
+     * @return 重排后的顶点数
+     */
+    static size_t optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<Index> &indices);
+
+    /*!
+     * 依次执行以上三步
+     * @return 优化前后的缓存统计
+     */
+    static Report optimize(
+            std::vector<Vertex> &vertices,
+            std::vector<Index> &indices,
+            size_t cacheSize = kDefaultCacheSize);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHOPTIMIZER_H
@@ -0,0 +1,823 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+// 二次误差的维度：3个位置分量和2个uv分量
+constexpr int kDimensions = 5;
+
+enum class VertexKind : uint8_t {
+    Manifold, // 内部顶点，可以收缩到任意相邻顶点
+    Border,   // 开放边界上的顶点，只能沿边界收缩
+    Locked    // uv接缝、非流形或者被要求锁定的顶点
+};
+
+/*!
+ * 5维二次型：Q(x) = xᵀAx + b·x + c，A只保存上三角部分。
+ * weight是累加的权重，求值时除以它得到加权平均的平方误差。
+ * 求值时各项会大幅抵消，用float时小于1e-4左右的距离会被舍入误差淹没，所以用double保存。
+ */
+struct Quadric {
+    double a[kDimensions * (kDimensions + 1) / 2];
+    double b[kDimensions];
+    double c;
+    double weight;
+
+    // 累加 weight * (v·x + d)²
+    void addSquaredForm(const float v[kDimensions], float d, float formWeight) {
+        int k = 0;
+        for (int i = 0; i < kDimensions; i++) {
+            for (int j = i; j < kDimensions; j++) {
+                a[k++] += formWeight * v[i] * v[j];
+            }
+            b[i] += formWeight * 2.f * d * v[i];
+        }
+        c += formWeight * d * d;
+    }
+
+    void add(const Quadric &other) {
+        for (size_t i = 0; i < sizeof(a) / sizeof(a[0]); i++) {
+            a[i] += other.a[i];
+        }
+        for (int i = 0; i < kDimensions; i++) {
+            b[i] += other.b[i];
+        }
+        c += other.c;
+        weight += other.weight;
+    }
+
+    float evaluate(const float x[kDimensions]) const {
+        double result = c;
+        int k = 0;
+        for (int i = 0; i < kDimensions; i++) {
+            result += a[k++] * x[i] * x[i];
+            for (int j = i + 1; j < kDimensions; j++) {
+                result += 2.f * a[k++] * x[i] * x[j];
+            }
+            result += b[i] * x[i];
+        }
+        // 浮点误差可能让结果略小于0
+        return weight > 0.0 ? float(std::max(0.0, result / weight)) : 0.f;
+    }
+};
+
+struct Vec3d {
+    float x, y, z;
+};
+
+inline Vec3d sub(const Vec3d &a, const Vec3d &b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+
+inline Vec3d cross(const Vec3d &a, const Vec3d &b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float dot(const Vec3d &a, const Vec3d &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline Vec3d madd(const Vec3d &a, const Vec3d &b, float s) { return {a.x + b.x * s, a.y + b.y * s, a.z + b.z * s}; }
+
+inline float length(const Vec3d &a) { return std::sqrt(dot(a, a)); }
+
+// 点到线段的距离
+float segmentDistance(const Vec3d &p, const Vec3d &a, const Vec3d &b) {
+    Vec3d ab = sub(b, a);
+    float length2 = dot(ab, ab);
+    float t = length2 > 0.f ? std::min(1.f, std::max(0.f, dot(sub(p, a), ab) / length2)) : 0.f;
+    return length(sub(p, madd(a, ab, t)));
+}
+
+//! 投影平面上的点。很扁的三角形上重心坐标对舍入误差很敏感，所以平面上的计算用double
+struct Point2 {
+    double x, y;
+};
+
+//! 星形中的一个三角形，v[0]是被收缩的顶点
+struct StarTriangle {
+    Index v[3];
+};
+
+inline double cross2(const Point2 &o, const Point2 &a, const Point2 &b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/*!
+ * 一次收缩前后局部表面之间距离的上界（Cohen等人的逐次映射）。
+ *
+ * 收缩前的星形（from的所有相邻三角形）和收缩后的星形（把from换成to）投影到同一个平面上，
+ * 投影相同的点互相对应，两个星形都是这个平面上的高度场时这是一一映射。每对新旧三角形投影的交集
+ * 是凸多边形，两个表面在上面的差是仿射函数，它的长度在多边形的顶点上取到最大值。
+ * 开放边界上的收缩中，投影区域相差一个三角形(from, 起点, 终点)：只属于旧星形时，上面的点对应到
+ * 新的边界线段上最近的点；只属于新星形时，沿新边界的方向分段线性地对应到旧的两段边界上。
+ * 同样在裁剪出的多边形顶点上取最大值。
+ */
+class StarMapping {
+public:
+    /*!
+     * @param triangles from的相邻三角形，每个都按原来的绕序把from放在第一个
+     * @return 距离的上界；投影后有三角形翻转或退化、无法建立映射时返回负数
+     */
+    float distance(const std::vector<StarTriangle> &triangles, Index from, Index to,
+                   const std::vector<float> &points) {
+        points_ = &points;
+        // 投影方向取旧星形按面积加权的法线
+        Vec3d normal = {0.f, 0.f, 0.f};
+        for (const StarTriangle &tri: triangles) {
+            Vec3d p0 = position(tri.v[0]);
+            Vec3d n = cross(sub(position(tri.v[1]), p0), sub(position(tri.v[2]), p0));
+            normal = {normal.x + n.x, normal.y + n.y, normal.z + n.z};
+        }
+        float normalLength = length(normal);
+        if (!(normalLength > 0.f)) {
+            return -1.f;
+        }
+        n_ = {normal.x / normalLength, normal.y / normalLength, normal.z / normalLength};
+        // 与法线垂直的两个轴
+        Vec3d axis = std::fabs(n_.x) < 0.6f ? Vec3d{1.f, 0.f, 0.f} : Vec3d{0.f, 1.f, 0.f};
+        Vec3d u = cross(n_, axis);
+        float uLength = length(u);
+        u_ = {u.x / uLength, u.y / uLength, u.z / uLength};
+        v_ = cross(n_, u_);
+
+        // 旧星形的环：内部顶点是闭合的环，边界顶点是从起点到终点的一段
+        Index start = kNone;
+        Index end = kNone;
+        oldTriangles_.clear();
+        newTriangles_.clear();
+        for (const StarTriangle &tri: triangles) {
+            bool hasPrevious = false;
+            bool hasNext = false;
+            for (const StarTriangle &other: triangles) {
+                hasPrevious = hasPrevious || other.v[2] == tri.v[1];
+                hasNext = hasNext || other.v[1] == tri.v[2];
+            }
+            start = hasPrevious ? start : tri.v[1];
+            end = hasNext ? end : tri.v[2];
+            if (!project(tri.v[0], tri.v[1], tri.v[2], oldTriangles_)) {
+                return -1.f;
+            }
+            if (tri.v[1] != to && tri.v[2] != to && !project(to, tri.v[1], tri.v[2], newTriangles_)) {
+                return -1.f;
+            }
+        }
+
+        float result = 0.f;
+        for (const Projected &before: oldTriangles_) {
+            for (const Projected &after: newTriangles_) {
+                if (before.lower.x > after.upper.x || after.lower.x > before.upper.x
+                    || before.lower.y > after.upper.y || after.lower.y > before.upper.y
+                    || clip(before, after.p) == 0) {
+                    continue;
+                }
+                for (size_t i = 0; i < polygonSize_; i++) {
+                    result = std::max(result, length(sub(lift(before, polygon_[i]), lift(after, polygon_[i]))));
+                }
+            }
+        }
+        if (start == kNone) {
+            return result;
+        }
+        if (to != start && to != end) {
+            return -1.f;
+        }
+
+        Point2 fromPoint = projectPoint(from);
+        Point2 startPoint = projectPoint(start);
+        Point2 endPoint = projectPoint(end);
+        if (cross2(fromPoint, startPoint, endPoint) > 0.0) {
+            // 三角形只属于旧星形，旧表面上的点对应到新的边界线段(start, end)上
+            const Point2 ear[3] = {fromPoint, startPoint, endPoint};
+            for (const Projected &before: oldTriangles_) {
+                clip(before, ear);
+                for (size_t i = 0; i < polygonSize_; i++) {
+                    result = std::max(result, segmentDistance(lift(before, polygon_[i]),
+                                                              position(start), position(end)));
+                }
+            }
+        } else {
+            // 三角形只属于新星形，新表面上的点按在新边界(start, end)方向上的投影参数t对应到旧边界上：
+            // from的投影参数处对应from，两边分别线性对应到(start, from)和(from, end)上，
+            // 在t = 0、from的参数和1处分段，每段上距离是仿射函数的长度，最大值在分段后的多边形顶点上
+            const Point2 ear[3] = {fromPoint, endPoint, startPoint};
+            border_[0] = position(start);
+            border_[1] = position(from);
+            border_[2] = position(end);
+            origin_ = startPoint;
+            Point2 direction = {endPoint.x - startPoint.x, endPoint.y - startPoint.y};
+            double squaredLength = direction.x * direction.x + direction.y * direction.y;
+            if (!(squaredLength > 0.0)) {
+                return -1.f;
+            }
+            direction_ = {direction.x / squaredLength, direction.y / squaredLength};
+            breaks_[0] = 0.0;
+            breaks_[1] = std::min(std::max(parameter(fromPoint), 0.0), 1.0);
+            breaks_[2] = 1.0;
+            for (const Projected &after: newTriangles_) {
+                clip(after, ear);
+                for (size_t i = 0; i < polygonSize_; i++) {
+                    const Point2 &current = polygon_[i];
+                    const Point2 &next = polygon_[(i + 1) % polygonSize_];
+                    result = std::max(result, borderDistance(after, current));
+                    double tCurrent = parameter(current);
+                    double tNext = parameter(next);
+                    for (double t: breaks_) {
+                        if ((tCurrent < t) != (tNext < t)) {
+                            double s = (t - tCurrent) / (tNext - tCurrent);
+                            Point2 crossing = {current.x + (next.x - current.x) * s,
+                                               current.y + (next.y - current.y) * s};
+                            result = std::max(result, borderDistance(after, crossing));
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Projected {
+        Point2 p[3];
+        Vec3d q[3];
+        Point2 lower, upper; // 投影的包围盒
+    };
+
+    Vec3d position(Index v) const {
+        const float *point = &(*points_)[v * kDimensions];
+        return Vec3d{point[0], point[1], point[2]};
+    }
+
+    Point2 projectPoint(Index v) const {
+        Vec3d p = position(v);
+        return Point2{double(p.x) * u_.x + double(p.y) * u_.y + double(p.z) * u_.z,
+                      double(p.x) * v_.x + double(p.y) * v_.y + double(p.z) * v_.z};
+    }
+
+    //! 投影平面上的点在新边界(start, end)方向上的参数，start处为0，end处为1
+    double parameter(const Point2 &x) const {
+        return (x.x - origin_.x) * direction_.x + (x.y - origin_.y) * direction_.y;
+    }
+
+    //! 新三角形上的点到它在旧边界上对应点的距离
+    float borderDistance(const Projected &after, const Point2 &x) const {
+        double t = parameter(x);
+        Vec3d mapped;
+        if (t <= breaks_[0]) {
+            mapped = border_[0];
+        } else if (t < breaks_[1]) {
+            mapped = madd(border_[0], sub(border_[1], border_[0]), float(t / breaks_[1]));
+        } else if (t < breaks_[2]) {
+            mapped = madd(border_[1], sub(border_[2], border_[1]),
+                          float((t - breaks_[1]) / (1.0 - breaks_[1])));
+        } else {
+            mapped = border_[2];
+        }
+        return length(sub(lift(after, x), mapped));
+    }
+
+    //! 投影后必须是逆时针的非退化三角形
+    bool project(Index a, Index b, Index c, std::vector<Projected> &out) const {
+        Projected tri;
+        const Index corners[3] = {a, b, c};
+        for (int i = 0; i < 3; i++) {
+            tri.q[i] = position(corners[i]);
+            tri.p[i] = projectPoint(corners[i]);
+        }
+        if (!(cross2(tri.p[0], tri.p[1], tri.p[2]) > 0.0)) {
+            return false;
+        }
+        tri.lower = {std::min({tri.p[0].x, tri.p[1].x, tri.p[2].x}), std::min({tri.p[0].y, tri.p[1].y, tri.p[2].y})};
+        tri.upper = {std::max({tri.p[0].x, tri.p[1].x, tri.p[2].x}), std::max({tri.p[0].y, tri.p[1].y, tri.p[2].y})};
+        out.push_back(tri);
+        return true;
+    }
+
+    //! 投影平面上的点在三角形上对应的点。裁剪出的顶点因为舍入可能稍微落在三角形外，把重心坐标限制在三角形内
+    static Vec3d lift(const Projected &tri, const Point2 &x) {
+        double w0 = std::max(cross2(x, tri.p[1], tri.p[2]), 0.0);
+        double w1 = std::max(cross2(x, tri.p[2], tri.p[0]), 0.0);
+        double w2 = std::max(cross2(x, tri.p[0], tri.p[1]), 0.0);
+        double sum = w0 + w1 + w2;
+        if (sum > 0.0) {
+            w0 /= sum;
+            w1 /= sum;
+            w2 /= sum;
+        } else {
+            w0 = w1 = w2 = 1.0 / 3.0;
+        }
+        return Vec3d{float(tri.q[0].x * w0 + tri.q[1].x * w1 + tri.q[2].x * w2),
+                     float(tri.q[0].y * w0 + tri.q[1].y * w1 + tri.q[2].y * w2),
+                     float(tri.q[0].z * w0 + tri.q[1].z * w1 + tri.q[2].z * w2)};
+    }
+
+    //! 用逆时针的三角形 @a window 裁剪 @a tri 的投影，结果在polygon_中
+    size_t clip(const Projected &tri, const Point2 window[3]) {
+        polygonSize_ = 3;
+        std::copy(tri.p, tri.p + 3, polygon_);
+        for (int edge = 0; edge < 3 && polygonSize_ > 0; edge++) {
+            const Point2 &a = window[edge];
+            const Point2 &b = window[(edge + 1) % 3];
+            Point2 input[kMaxPolygon];
+            size_t inputSize = polygonSize_;
+            std::copy(polygon_, polygon_ + inputSize, input);
+            polygonSize_ = 0;
+            for (size_t i = 0; i < inputSize; i++) {
+                const Point2 &current = input[i];
+                const Point2 &next = input[(i + 1) % inputSize];
+                double sideCurrent = cross2(a, b, current);
+                double sideNext = cross2(a, b, next);
+                if (sideCurrent >= 0.0) {
+                    polygon_[polygonSize_++] = current;
+                }
+                if ((sideCurrent < 0.0) != (sideNext < 0.0)) {
+                    double t = sideCurrent / (sideCurrent - sideNext);
+                    polygon_[polygonSize_++] = Point2{current.x + (next.x - current.x) * t,
+                                                      current.y + (next.y - current.y) * t};
+                }
+            }
+        }
+        return polygonSize_;
+    }
+
+    // 三角形被三个半平面裁剪后最多6个顶点
+    static constexpr size_t kMaxPolygon = 8;
+
+    const std::vector<float> *points_ = nullptr;
+    Vec3d n_, u_, v_;
+    std::vector<Projected> oldTriangles_;
+    std::vector<Projected> newTriangles_;
+    Point2 polygon_[kMaxPolygon];
+    size_t polygonSize_ = 0;
+    // 开放边界上的对应关系：旧边界start、from、end三个顶点，新边界的起点、方向和分段参数
+    Vec3d border_[3];
+    Point2 origin_, direction_;
+    double breaks_[3];
+};
+
+// 顶点到三角形的邻接表，CSR格式
+struct Adjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    void build(const std::vector<Index> &indices, size_t vertexCount) {
+        offsets.assign(vertexCount + 1, 0);
+        triangles.resize(indices.size());
+        for (Index index: indices) {
+            offsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+};
+
+// 三角形t中是否存在有向边from->to
+inline bool hasDirectedEdge(const std::vector<Index> &indices, uint32_t t, Index from, Index to) {
+    const Index *tri = &indices[t * 3];
+    return (tri[0] == from && tri[1] == to)
+           || (tri[1] == from && tri[2] == to)
+           || (tri[2] == from && tri[0] == to);
+}
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    float cost;
+};
+
+/*!
+ * 按代价升序的基数排序。代价都是非负的有限float，它们的位模式作为无符号整数比较时顺序与数值相同，
+ * 分三趟按11位排序，比比较排序快得多。
+ */
+void sortByCost(std::vector<Collapse> &collapses, std::vector<Collapse> &scratch) {
+    constexpr int kBits = 11;
+    constexpr uint32_t kBuckets = 1u << kBits;
+    scratch.resize(collapses.size());
+    std::vector<uint32_t> histogram(kBuckets);
+
+    for (int shift = 0; shift < 32; shift += kBits) {
+        std::fill(histogram.begin(), histogram.end(), 0);
+        for (const Collapse &collapse: collapses) {
+            uint32_t key;
+            memcpy(&key, &collapse.cost, sizeof(key));
+            histogram[(key >> shift) & (kBuckets - 1)]++;
+        }
+        uint32_t sum = 0;
+        for (uint32_t &count: histogram) {
+            uint32_t current = count;
+            count = sum;
+            sum += current;
+        }
+        for (const Collapse &collapse: collapses) {
+            uint32_t key;
+            memcpy(&key, &collapse.cost, sizeof(key));
+            scratch[histogram[(key >> shift) & (kBuckets - 1)]++] = collapse;
+        }
+        collapses.swap(scratch);
+    }
+}
+
+} // namespace
+
+SimplifyResult MeshSimplifier::simplify(
+        const std::vector<Vertex> &vertices,
+        const std::vector<Index> &indices,
+        size_t targetIndexCount,
+        const SimplifyOptions &options) {
+    assert(indices.size() % 3 == 0);
+    const size_t vertexCount = vertices.size();
+
+    SimplifyResult result;
+    result.indices = indices;
+    if (indices.size() <= targetIndexCount || indices.empty()) {
+        return result;
+    }
+
+    // 把位置归一化到单位包围盒，让误差与网格尺寸无关，也改善float精度
+    float minimum[3] = {INFINITY, INFINITY, INFINITY};
+    float maximum[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (Index index: indices) {
+        for (int axis = 0; axis < 3; axis++) {
+            minimum[axis] = std::min(minimum[axis], vertices[index].position.idx[axis]);
+            maximum[axis] = std::max(maximum[axis], vertices[index].position.idx[axis]);
+        }
+    }
+    float extent = std::max({maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2]});
+    if (extent <= 0.f) {
+        return result;
+    }
+    const float scale = 1.f / extent;
+
+    // 每个顶点的5维坐标：归一化位置 + 加权后的uv
+    std::vector<float> points(vertexCount * kDimensions);
+    for (size_t v = 0; v < vertexCount; v++) {
+        float *point = &points[v * kDimensions];
+        for (int axis = 0; axis < 3; axis++) {
+            point[axis] = (vertices[v].position.idx[axis] - minimum[axis]) * scale;
+        }
+        point[3] = vertices[v].uv.u * options.attributeWeight;
+        point[4] = vertices[v].uv.v * options.attributeWeight;
+    }
+    auto position = [&points](Index v) {
+        const float *point = &points[v * kDimensions];
+        return Vec3d{point[0], point[1], point[2]};
+    };
+
+    Adjacency adjacency;
+    adjacency.build(result.indices, vertexCount);
+
+    // ---- 顶点分类 ----
+    std::vector<VertexKind> kind(vertexCount, VertexKind::Manifold);
+    {
+        // 位置完全相同的多个顶点就是uv接缝，锁定它们
+        std::unordered_map<uint64_t, uint32_t> firstAtPosition;
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        for (Index index: indices) {
+            referenced[index] = 1;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            if (!referenced[v]) {
+                continue;
+            }
+            uint32_t bits[3];
+            memcpy(bits, vertices[v].position.idx, sizeof(bits));
+            uint64_t key = (uint64_t(bits[0]) * 0x9E3779B97F4A7C15ull)
+                           ^ (uint64_t(bits[1]) * 0xC2B2AE3D27D4EB4Full)
+                           ^ (uint64_t(bits[2]) * 0x165667B19E3779F9ull);
+            auto inserted = firstAtPosition.emplace(key, static_cast<uint32_t>(v));
+            if (!inserted.second) {
+                uint32_t first = inserted.first->second;
+                // 哈希相同但位置不同时只是冲突，保守起见同样锁定
+                kind[v] = VertexKind::Locked;
+                kind[first] = VertexKind::Locked;
+            }
+        }
+
+        std::vector<uint8_t> openEdges(vertexCount, 0);
+        for (size_t t = 0; t < result.indices.size() / 3; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                Index a = result.indices[t * 3 + corner];
+                Index b = result.indices[t * 3 + (corner + 1) % 3];
+                uint32_t sharing = 0;
+                for (uint32_t i = adjacency.offsets[a]; i < adjacency.offsets[a + 1]; i++) {
+                    const Index *tri = &result.indices[adjacency.triangles[i] * 3];
+                    sharing += tri[0] == b || tri[1] == b || tri[2] == b;
+                }
+                if (sharing == 1) {
+                    openEdges[a] = static_cast<uint8_t>(std::min(255, openEdges[a] + 1));
+                    openEdges[b] = static_cast<uint8_t>(std::min(255, openEdges[b] + 1));
+                } else if (sharing > 2) {
+                    kind[a] = VertexKind::Locked;
+                    kind[b] = VertexKind::Locked;
+                }
+            }
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            if (kind[v] == VertexKind::Locked || openEdges[v] == 0) {
+                continue;
+            }
+            kind[v] = openEdges[v] == 2 && !options.lockBorder ? VertexKind::Border : VertexKind::Locked;
+        }
+    }
+
+    // ---- 二次误差 ----
+    std::vector<Quadric> quadrics(vertexCount);
+    memset(quadrics.data(), 0, quadrics.size() * sizeof(Quadric));
+
+    // 边界约束单独保存并单独求值，否则会被数量多得多的三角形平面平均掉。
+    // 只有边界顶点需要，按需分配
+    std::vector<uint32_t> borderSlot(vertexCount, kNone);
+    std::vector<Quadric> borderQuadrics;
+    auto borderQuadric = [&](Index v) -> Quadric & {
+        if (borderSlot[v] == kNone) {
+            borderSlot[v] = static_cast<uint32_t>(borderQuadrics.size());
+            borderQuadrics.emplace_back();
+            memset(&borderQuadrics.back(), 0, sizeof(Quadric));
+        }
+        return borderQuadrics[borderSlot[v]];
+    };
+    auto collapseCost = [&](Index from, Index to) {
+        const float *target = &points[to * kDimensions];
+        float cost = quadrics[from].evaluate(target);
+        if (borderSlot[from] != kNone) {
+            cost = std::max(cost, borderQuadrics[borderSlot[from]].evaluate(target));
+        }
+        return cost;
+    };
+    for (size_t t = 0; t < result.indices.size() / 3; t++) {
+        const Index *tri = &result.indices[t * 3];
+        Vec3d p0 = position(tri[0]);
+        Vec3d e1 = sub(position(tri[1]), p0);
+        Vec3d e2 = sub(position(tri[2]), p0);
+        Vec3d normal = cross(e1, e2);
+        float length2 = dot(normal, normal);
+        if (length2 <= 0.f) {
+            continue;
+        }
+        float length = std::sqrt(length2);
+        float area = 0.5f * length;
+
+        Quadric quadric;
+        memset(&quadric, 0, sizeof(quadric));
+
+        // 到三角形平面的距离
+        Vec3d n = {normal.x / length, normal.y / length, normal.z / length};
+        float plane[kDimensions] = {n.x, n.y, n.z, 0.f, 0.f};
+        quadric.addSquaredForm(plane, -dot(n, p0), area);
+
+        // uv在三角形上线性插值：s(p) = g·p + d，误差为 (g·p + d - s)²
+        Vec3d e2xn = cross(e2, normal);
+        Vec3d nxe1 = cross(normal, e1);
+        for (int component = 0; component < 2; component++) {
+            float s0 = points[tri[0] * kDimensions + 3 + component];
+            float s1 = points[tri[1] * kDimensions + 3 + component];
+            float s2 = points[tri[2] * kDimensions + 3 + component];
+            Vec3d gradient = {
+                    ((s1 - s0) * e2xn.x + (s2 - s0) * nxe1.x) / length2,
+                    ((s1 - s0) * e2xn.y + (s2 - s0) * nxe1.y) / length2,
+                    ((s1 - s0) * e2xn.z + (s2 - s0) * nxe1.z) / length2};
+            float form[kDimensions] = {gradient.x, gradient.y, gradient.z, 0.f, 0.f};
+            form[3 + component] = -1.f;
+            quadric.addSquaredForm(form, s0 - dot(gradient, p0), area);
+        }
+        quadric.weight = area;
+
+        for (int corner = 0; corner < 3; corner++) {
+            quadrics[tri[corner]].add(quadric);
+        }
+
+        // 开放边界：加一个包含这条边、垂直于三角形的约束平面
+        for (int corner = 0; corner < 3; corner++) {
+            Index a = tri[corner];
+            Index b = tri[(corner + 1) % 3];
+            if (kind[a] == VertexKind::Manifold || kind[b] == VertexKind::Manifold) {
+                continue;
+            }
+            bool open = true;
+            for (uint32_t i = adjacency.offsets[b]; i < adjacency.offsets[b + 1] && open; i++) {
+                open = !hasDirectedEdge(result.indices, adjacency.triangles[i], b, a);
+            }
+            if (!open) {
+                continue;
+            }
+            Vec3d edge = sub(position(b), position(a));
+            Vec3d perpendicular = cross(edge, n);
+            float perpendicularLength = std::sqrt(dot(perpendicular, perpendicular));
+            if (perpendicularLength <= 0.f) {
+                continue;
+            }
+            Vec3d pn = {perpendicular.x / perpendicularLength,
+                        perpendicular.y / perpendicularLength,
+                        perpendicular.z / perpendicularLength};
+            float borderPlane[kDimensions] = {pn.x, pn.y, pn.z, 0.f, 0.f};
+            float weight = std::sqrt(dot(edge, edge));
+            Quadric border;
+            memset(&border, 0, sizeof(border));
+            border.addSquaredForm(borderPlane, -dot(pn, position(a)), weight);
+            border.weight = weight;
+            borderQuadric(a).add(border);
+            borderQuadric(b).add(border);
+        }
+    }
+
+    // ---- 分轮收缩 ----
+    // 二次误差只用来给收缩排序，报告的误差是保守的几何上界：每个三角形记录它到原网格双向距离的上界，
+    // 一次收缩后的新三角形取被改动的三角形的最大上界，再加上这次收缩前后局部表面之间距离的上界（见StarMapping）
+    const float errorLimit = options.targetError;
+    float maxError = 0.f;
+    std::vector<float> triangleError(result.indices.size() / 3, 0.f);
+    std::vector<uint8_t> triangleTouched;
+    std::vector<StarTriangle> starTriangles;
+    StarMapping starMapping;
+    std::vector<Collapse> candidates;
+    std::vector<Collapse> sortScratch;
+    std::vector<uint32_t> collapseTo(vertexCount, kNone);
+    std::vector<uint8_t> touched(vertexCount, 0);
+    bool errorLimitReached = false;
+
+    while (result.indices.size() > targetIndexCount && !errorLimitReached) {
+        adjacency.build(result.indices, vertexCount);
+
+        // 收集候选边：内部边只取a < b的方向，开放边界边只出现一次所以总是保留
+        candidates.clear();
+        for (size_t t = 0; t < result.indices.size() / 3; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                Index a = result.indices[t * 3 + corner];
+                Index b = result.indices[t * 3 + (corner + 1) % 3];
+                if (kind[a] == VertexKind::Locked && kind[b] == VertexKind::Locked) {
+                    continue;
+                }
+                // 内部顶点没有开放边，只有两端都不是内部顶点时才需要检查
+                bool open = false;
+                if (kind[a] != VertexKind::Manifold && kind[b] != VertexKind::Manifold) {
+                    open = true;
+                    for (uint32_t i = adjacency.offsets[b]; i < adjacency.offsets[b + 1] && open; i++) {
+                        open = !hasDirectedEdge(result.indices, adjacency.triangles[i], b, a);
+                    }
+                }
+                if (!open && a > b) {
+                    continue;
+                }
+
+                // 边界顶点只能沿开放边界收缩到另一个边界顶点上
+                auto allowed = [&](Index from, Index to) {
+                    switch (kind[from]) {
+                        case VertexKind::Manifold:
+                            return true;
+                        case VertexKind::Border:
+                            return open && kind[to] == VertexKind::Border;
+                        case VertexKind::Locked:
+                            return false;
+                    }
+                    return false;
+                };
+
+                Collapse best = {kNone, kNone, INFINITY};
+                if (allowed(a, b)) {
+                    best = {a, b, collapseCost(a, b)};
+                }
+                if (allowed(b, a)) {
+                    float cost = collapseCost(b, a);
+                    if (cost < best.cost) {
+                        best = {b, a, cost};
+                    }
+                }
+                if (best.from != kNone) {
+                    candidates.push_back(best);
+                }
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        sortByCost(candidates, sortScratch);
+
+        // 每次收缩大约减少两个三角形
+        size_t triangleGoal = (result.indices.size() - targetIndexCount) / 3;
+        size_t collapseGoal = std::max<size_t>(1, triangleGoal / 2);
+        size_t collapses = 0;
+        std::fill(touched.begin(), touched.end(), 0);
+        triangleTouched.assign(result.indices.size() / 3, 0);
+
+        // 很多候选边会因为端点已参与本轮收缩而被跳过，所以本轮的误差目标放宽到第collapseGoal条候选的1.5倍；
+        // 平均每次收缩会挡住约6条候选边，至少完成目标的1/6之后才按这个目标提前结束本轮
+        float passErrorGoal = collapseGoal < candidates.size()
+                              ? 1.5f * candidates[collapseGoal].cost : INFINITY;
+
+        for (const Collapse &collapse: candidates) {
+            if (collapses >= collapseGoal) {
+                break;
+            }
+            if (collapse.cost > errorLimit * errorLimit) {
+                errorLimitReached = true;
+                break;
+            }
+            if (collapse.cost > passErrorGoal && collapses > collapseGoal / 6) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+
+            // from的1环邻域上的三角形（星形）被替换为把from换成to的三角形，1环本身不变。
+            // 含有to的旧三角形退化消失，没有另一个含有它第三个顶点的旧三角形时拒绝收缩（耳朵或孤立三角形）。
+            // 同时拒绝会让相邻三角形翻转或退化的收缩、星形在本轮已经被改动过的收缩，以及无法建立映射的收缩
+            const uint32_t *star = adjacency.triangles.data() + adjacency.offsets[collapse.from];
+            const uint32_t *starEnd = adjacency.triangles.data() + adjacency.offsets[collapse.from + 1];
+            Vec3d origin = position(collapse.from);
+            Vec3d target = position(collapse.to);
+            float starError = 0.f;
+            bool rejected = false;
+            starTriangles.clear();
+            for (const uint32_t *t = star; t != starEnd && !rejected; t++) {
+                const Index *tri = &result.indices[*t * 3];
+                rejected = triangleTouched[*t] != 0;
+                starError = std::max(starError, triangleError[*t]);
+                int corner = tri[0] == collapse.from ? 0 : (tri[1] == collapse.from ? 1 : 2);
+                Index a = tri[(corner + 1) % 3];
+                Index b = tri[(corner + 2) % 3];
+                starTriangles.push_back({{collapse.from, a, b}});
+                if (a == collapse.to || b == collapse.to) {
+                    Index third = a == collapse.to ? b : a;
+                    bool covered = false;
+                    for (const uint32_t *other = star; other != starEnd && !covered; other++) {
+                        const Index *o = &result.indices[*other * 3];
+                        covered = (o[0] == third || o[1] == third || o[2] == third)
+                                  && o[0] != collapse.to && o[1] != collapse.to && o[2] != collapse.to;
+                    }
+                    rejected = rejected || !covered;
+                    continue;
+                }
+                Vec3d p1 = position(a);
+                Vec3d p2 = position(b);
+                Vec3d before = cross(sub(p1, origin), sub(p2, origin));
+                Vec3d after = cross(sub(p1, target), sub(p2, target));
+                rejected = rejected || dot(before, after) <= 0.f;
+            }
+            if (rejected) {
+                continue;
+            }
+            float distance = starMapping.distance(starTriangles, collapse.from, collapse.to, points);
+            if (distance < 0.f) {
+                continue;
+            }
+
+            float error = starError + distance;
+            if (error > errorLimit) {
+                continue;
+            }
+
+            collapseTo[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            if (borderSlot[collapse.from] != kNone && borderSlot[collapse.to] != kNone) {
+                borderQuadrics[borderSlot[collapse.to]].add(borderQuadrics[borderSlot[collapse.from]]);
+            }
+            touched[collapse.from] = 1;
+            touched[collapse.to] = 1;
+            for (const uint32_t *t = star; t != starEnd; t++) {
+                triangleTouched[*t] = 1;
+                triangleError[*t] = error;
+            }
+            maxError = std::max(maxError, error);
+            collapses++;
+        }
+        if (collapses == 0) {
+            break;
+        }
+
+        // 改写索引并删除退化的三角形
+        size_t write = 0;
+        for (size_t i = 0; i < result.indices.size(); i += 3) {
+            Index tri[3];
+            for (int corner = 0; corner < 3; corner++) {
+                Index v = result.indices[i + corner];
+                tri[corner] = collapseTo[v] != kNone ? collapseTo[v] : v;
+            }
+            if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+                continue;
+            }
+            triangleError[write / 3] = triangleError[i / 3];
+            result.indices[write++] = tri[0];
+            result.indices[write++] = tri[1];
+            result.indices[write++] = tri[2];
+        }
+        result.indices.resize(write);
+        triangleError.resize(write / 3);
+        for (size_t v = 0; v < vertexCount; v++) {
+            if (touched[v]) {
+                collapseTo[v] = kNone;
+            }
+        }
+    }
+
+    result.error = maxError * extent;
+    return result;
+}
@@ -0,0 +1,65 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHSIMPLIFIER_H
+#define ANDROIDGLINVESTIGATIONS_MESHSIMPLIFIER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "VertexFormat.h"
+
+/*!
+ * 网格简化的参数
+ */
+struct SimplifyOptions {
+    //! 允许的最大误差，相对于网格包围盒的最长边
+    float targetError = 0.05f;
+
+    //! uv误差相对位置误差的权重，0表示只考虑几何形状
+    float attributeWeight = 0.5f;
+
+    //! 是否完全锁定开放边界上的顶点；否则边界顶点只能沿边界收缩
+    bool lockBorder = false;
+};
+
+/*!
+ * 简化结果
+ */
+struct SimplifyResult {
+    std::vector<Index> indices;
+    float error = 0.f; // 简化结果与原网格之间双向距离（Hausdorff距离）的上界，单位与输入顶点坐标相同
+};
+
+/*!
+ * 基于二次误差度量（QEM）的网格简化，只处理三角形列表。
+ *
+ * 采用顶点受限的边收缩：一条边收缩时直接合并到它的一个端点上，
+ * 所以简化结果只改写索引，所有细节层次可以共用同一份顶点缓冲。
+ *
+ * 每个顶点的二次误差由相邻三角形按面积加权累加而成，除了到平面的距离，
+ * 还包括uv在三角形上线性插值的误差（Hoppe的属性二次误差），
+ * 开放边界额外加上垂直于三角形的约束平面，使边界形状得以保留。
+ * uv接缝（位置相同、属性不同的顶点）和非流形顶点不会被移动。
+ *
+ * 收缩分轮进行：每轮收集所有候选边并按代价排序，每个顶点每轮最多参与一次收缩，
+ * 直到达到目标索引数、误差超过上限或者没有可收缩的边。
+ *
+ * 二次误差只决定收缩的顺序。报告的误差和误差上限用的是保守的几何上界：每个三角形记录它与原网格之间
+ * 双向距离的上界，每次收缩按收缩前后局部表面之间距离的上界单调累加，边界收缩和带uv权重的收缩也一样，
+ * 所以实际距离不会超过报告的误差。
+ */
+class MeshSimplifier {
+public:
+    /*!
+     * 简化网格
+     * @param vertices 顶点
+     * @param indices 三角形列表索引
+     * @param targetIndexCount 目标索引数
+     * @param options 简化参数
+     */
+    static SimplifyResult simplify(
+            const std::vector<Vertex> &vertices,
+            const std::vector<Index> &indices,
+            size_t targetIndexCount,
+            const SimplifyOptions &options = SimplifyOptions());
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHSIMPLIFIER_H
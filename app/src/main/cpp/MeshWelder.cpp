@@ -0,0 +1,467 @@
+#include "MeshWelder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+struct Cell {
+    int64_t x, y, z;
+};
+
+/*!
+ * 焊接的分格和比较规则。格子边长是容差的两倍，容差范围在每个轴上最多跨两个格子
+ */
+class WeldGrid {
+public:
+    WeldGrid(const std::vector<Vertex> &vertices, const WeldOptions &options)
+            : vertices_(vertices),
+              options_(options) {}
+
+    uint64_t keyOf(uint32_t vertex) const {
+        return hash(cellOf(vertices_[vertex].position));
+    }
+
+    //! 对容差范围覆盖的每个格子调用 @a visit(key)
+    template<typename Visit>
+    void forEachNearbyKey(uint32_t vertex, Visit &&visit) const {
+        const Vector3 &position = vertices_[vertex].position;
+        float epsilon = options_.positionEpsilon;
+        Cell low = cellOf(Vector3{{position.x - epsilon, position.y - epsilon, position.z - epsilon}});
+        Cell high = cellOf(Vector3{{position.x + epsilon, position.y + epsilon, position.z + epsilon}});
+        for (int64_t z = low.z; z <= high.z; z++) {
+            for (int64_t y = low.y; y <= high.y; y++) {
+                for (int64_t x = low.x; x <= high.x; x++) {
+                    visit(hash(Cell{x, y, z}));
+                }
+            }
+        }
+    }
+
+    bool matches(uint32_t a, uint32_t b) const {
+        const Vertex &va = vertices_[a];
+        const Vertex &vb = vertices_[b];
+        for (int axis = 0; axis < 3; axis++) {
+            if (std::fabs(va.position.idx[axis] - vb.position.idx[axis]) > options_.positionEpsilon) {
+                return false;
+            }
+        }
+        if (options_.uvEpsilon >= 0.f) {
+            for (int component = 0; component < 2; component++) {
+                if (std::fabs(va.uv.idx[component] - vb.uv.idx[component]) > options_.uvEpsilon) {
+                    return false;
+                }
+            }
+        }
+        return !options_.compareColor || va.color == vb.color;
+    }
+
+    //! 键所属的分区，用乘积的高位，低位在三个轴之间混合得不够
+    static size_t partitionOf(uint64_t key, size_t partitionCount) {
+        return static_cast<size_t>(key >> 40) % partitionCount;
+    }
+
+private:
+    Cell cellOf(const Vector3 &position) const {
+        if (options_.positionEpsilon > 0.f) {
+            float inverse = 0.5f / options_.positionEpsilon;
+            return Cell{static_cast<int64_t>(std::floor(position.x * inverse)),
+                        static_cast<int64_t>(std::floor(position.y * inverse)),
+                        static_cast<int64_t>(std::floor(position.z * inverse))};
+        }
+        // 不允许误差时直接用位模式分格，+0和-0视为相同
+        auto bits = [](float value) -> int64_t {
+            if (value == 0.f) {
+                return 0;
+            }
+            uint32_t result;
+            memcpy(&result, &value, sizeof(result));
+            return result;
+        };
+        return Cell{bits(position.x), bits(position.y), bits(position.z)};
+    }
+
+    static uint64_t hash(const Cell &cell) {
+        // 不同的大质数打散三个轴，哈希冲突只会让格子里多出几个顶点，不影响正确性
+        return static_cast<uint64_t>(cell.x) * 0x9E3779B97F4A7C15ull
+               ^ static_cast<uint64_t>(cell.y) * 0xC2B2AE3D27D4EB4Full
+               ^ static_cast<uint64_t>(cell.z) * 0x165667B19E3779F9ull;
+    }
+
+    const std::vector<Vertex> &vertices_;
+    const WeldOptions &options_;
+};
+
+/*!
+ * 一个范围内顺序去重用的空间哈希。每个格子里的顶点用next数组串成链表，
+ * 链表按插入顺序反向排列，查找时取下标最小的匹配项。
+ */
+class SpatialHash {
+public:
+    SpatialHash(const WeldGrid &grid, size_t begin, size_t end)
+            : grid_(grid),
+              begin_(begin),
+              next_(end - begin, kNone) {
+        heads_.reserve(end - begin);
+    }
+
+    //! 查找容差内相同的已插入顶点，找不到时返回kNone
+    uint32_t find(uint32_t vertex) const {
+        uint32_t best = kNone;
+        grid_.forEachNearbyKey(vertex, [&](uint64_t key) {
+            auto it = heads_.find(key);
+            if (it == heads_.end()) {
+                return;
+            }
+            for (uint32_t other = it->second; other != kNone; other = next_[other - begin_]) {
+                if (other < best && grid_.matches(vertex, other)) {
+                    best = other;
+                }
+            }
+        });
+        return best;
+    }
+
+    void insert(uint32_t vertex) {
+        auto result = heads_.emplace(grid_.keyOf(vertex), vertex);
+        if (!result.second) {
+            next_[vertex - begin_] = result.first->second;
+            result.first->second = vertex;
+        }
+    }
+
+private:
+    const WeldGrid &grid_;
+    size_t begin_;
+    std::unordered_map<uint64_t, uint32_t> heads_;
+    std::vector<uint32_t> next_;
+};
+
+/*!
+ * 一个分区的格子表：开放寻址的哈希表把格子的键映射到 vertices_ 中的一段，
+ * 段内是落在这个格子里的顶点，按下标升序排列。建好后只读，可以被多个线程同时查询
+ */
+class CellTable {
+public:
+    /*!
+     * 收集键属于第 @a partition 个分区的顶点
+     * @param vertices 升序排列的顶点
+     * @param keys 与 @a vertices 一一对应的格子的键
+     */
+    void build(const std::vector<uint32_t> &vertices, const std::vector<uint64_t> &keys,
+               size_t partition, size_t partitionCount) {
+        std::vector<uint32_t> owned;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (WeldGrid::partitionOf(keys[i], partitionCount) == partition) {
+                owned.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        // 装载率不超过一半
+        size_t capacity = 16;
+        shift_ = 60;
+        while (capacity < owned.size() * 2) {
+            capacity *= 2;
+            shift_--;
+        }
+        slots_.assign(capacity, Slot{0, kNone, 0});
+        // 每个格子16位的过滤位图能放进缓存，大部分空格子不用访问哈希表
+        filter_.assign(capacity / 8 + 1, 0);
+        filterShift_ = shift_ - 3;
+        // 先数每个格子的顶点数，再按前缀和分段，begin先指向段尾，倒序填入后段内是升序。
+        // 大部分格子只有一个顶点，直接记在槽里，查询时少一次访存
+        for (uint32_t i: owned) {
+            slotOf(keys[i]).count++;
+            size_t bit = filterBit(keys[i]);
+            filter_[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+        uint32_t offset = 0;
+        for (Slot &slot: slots_) {
+            if (slot.begin != kNone && slot.count > 1) {
+                offset += slot.count;
+                slot.begin = offset;
+            }
+        }
+        vertices_.resize(offset);
+        for (auto it = owned.rbegin(); it != owned.rend(); ++it) {
+            Slot &slot = slotOf(keys[*it]);
+            if (slot.count == 1) {
+                slot.begin = vertices[*it];
+            } else {
+                vertices_[--slot.begin] = vertices[*it];
+            }
+        }
+    }
+
+    //! 格子里的顶点，没有时返回空区间
+    std::pair<const uint32_t *, const uint32_t *> find(uint64_t key) const {
+        size_t bit = filterBit(key);
+        if (!(filter_[bit / 64] >> (bit % 64) & 1)) {
+            return {nullptr, nullptr};
+        }
+        for (size_t i = key * 0x9E3779B97F4A7C15ull >> shift_;; i = (i + 1) & (slots_.size() - 1)) {
+            const Slot &slot = slots_[i];
+            if (slot.begin == kNone) {
+                return {nullptr, nullptr};
+            }
+            if (slot.key == key) {
+                const uint32_t *begin = slot.count == 1 ? &slot.begin : vertices_.data() + slot.begin;
+                return {begin, begin + slot.count};
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t key;
+        uint32_t begin; // kNone表示空槽；只有一个顶点时就是这个顶点
+        uint32_t count;
+    };
+
+    size_t filterBit(uint64_t key) const {
+        return key * 0xD6E8FEB86659FD93ull >> filterShift_;
+    }
+
+    //! 查找键所在的槽，没有时占用一个空槽
+    Slot &slotOf(uint64_t key) {
+        for (size_t i = key * 0x9E3779B97F4A7C15ull >> shift_;; i = (i + 1) & (slots_.size() - 1)) {
+            Slot &slot = slots_[i];
+            if (slot.begin == kNone) {
+                slot.key = key;
+                slot.begin = 0;
+                return slot;
+            }
+            if (slot.key == key) {
+                return slot;
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> vertices_;
+    std::vector<uint64_t> filter_;
+    unsigned shift_ = 60;
+    unsigned filterShift_ = 57;
+};
+
+//! 用 @a count 个线程执行 task(0..count-1)，只有一个任务时直接在当前线程执行
+template<typename Task>
+void runTasks(size_t count, Task &&task) {
+    if (count == 1) {
+        task(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back(task, i);
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+// 每个图元占用的索引数
+size_t primitiveSize(GLenum mode) {
+    switch (mode) {
+        case GL_TRIANGLES:
+            return 3;
+        case GL_LINES:
+            return 2;
+        case GL_POINTS:
+            return 1;
+        default:
+            // 条带和扇形共享顶点，无法在不改写拓扑的情况下切分
+            assert(false && "只支持GL_TRIANGLES、GL_LINES和GL_POINTS");
+            return 3;
+    }
+}
+
+//! 按 @a remap 压缩顶点数组并改写索引，保持代表顶点（remap[v] == v）的原有顺序
+size_t compact(std::vector<Vertex> &vertices, std::vector<Index> &indices, const std::vector<uint32_t> &remap) {
+    std::vector<uint32_t> compacted(vertices.size(), kNone);
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    for (size_t v = 0; v < vertices.size(); v++) {
+        if (remap[v] == v) {
+            compacted[v] = static_cast<uint32_t>(welded.size());
+            welded.push_back(vertices[v]);
+        }
+    }
+    for (Index &index: indices) {
+        index = compacted[remap[index]];
+    }
+    vertices.swap(welded);
+    return vertices.size();
+}
+
+} // namespace
+
+size_t MeshWelder::weld(
+        std::vector<Vertex> &vertices,
+        std::vector<Index> &indices,
+        const WeldOptions &options) {
+    const size_t vertexCount = vertices.size();
+    if (vertexCount == 0) {
+        return 0;
+    }
+
+    size_t taskCount = options.threadCount ? options.threadCount
+                                           : std::max(1u, std::thread::hardware_concurrency());
+    // 每个任务的顶点太少时线程开销大于收益
+    taskCount = std::max<size_t>(1, std::min(taskCount, vertexCount / 4096));
+    const size_t rangeSize = (vertexCount + taskCount - 1) / taskCount;
+    const WeldGrid grid(vertices, options);
+
+    // 第一步：各范围并行地顺序去重，local指向范围内的代表顶点
+    std::vector<uint32_t> local(vertexCount);
+    std::vector<std::vector<uint32_t>> representatives(taskCount);
+    runTasks(taskCount, [&](size_t task) {
+        size_t begin = task * rangeSize;
+        size_t end = std::min(vertexCount, begin + rangeSize);
+        SpatialHash hash(grid, begin, end);
+        for (size_t v = begin; v < end; v++) {
+            uint32_t match = hash.find(static_cast<uint32_t>(v));
+            if (match == kNone) {
+                hash.insert(static_cast<uint32_t>(v));
+                representatives[task].push_back(static_cast<uint32_t>(v));
+                local[v] = static_cast<uint32_t>(v);
+            } else {
+                local[v] = match;
+            }
+        }
+    });
+    if (taskCount == 1) {
+        return compact(vertices, indices, local);
+    }
+
+    // 第二步：合并各范围的代表顶点。格子按键分成互不相交的分区，每个线程为一个分区建表；
+    // 再并行地为每个代表顶点找出前面的范围里容差内相同的所有代表顶点，按下标升序排列
+    std::vector<uint32_t> merged;
+    for (const auto &list: representatives) {
+        merged.insert(merged.end(), list.begin(), list.end());
+    }
+    std::vector<uint64_t> keys(merged.size());
+    const size_t mergedRange = (merged.size() + taskCount - 1) / taskCount;
+    runTasks(taskCount, [&](size_t task) {
+        size_t end = std::min(merged.size(), (task + 1) * mergedRange);
+        for (size_t i = task * mergedRange; i < end; i++) {
+            keys[i] = grid.keyOf(merged[i]);
+        }
+    });
+    std::vector<CellTable> tables(taskCount);
+    runTasks(taskCount, [&](size_t task) {
+        tables[task].build(merged, keys, task, taskCount);
+    });
+    std::vector<uint32_t> matchCounts(merged.size());
+    std::vector<std::vector<uint32_t>> matches(taskCount);
+    runTasks(taskCount, [&](size_t task) {
+        std::vector<uint32_t> &found = matches[task];
+        size_t end = std::min(merged.size(), (task + 1) * mergedRange);
+        for (size_t i = task * mergedRange; i < end; i++) {
+            uint32_t v = merged[i];
+            size_t first = found.size();
+            // 同一范围内的代表顶点互不相同，只需要找前面的范围
+            uint32_t limit = static_cast<uint32_t>(v / rangeSize * rangeSize);
+            if (limit > 0) {
+                grid.forEachNearbyKey(v, [&](uint64_t key) {
+                    auto cell = tables[WeldGrid::partitionOf(key, taskCount)].find(key);
+                    for (const uint32_t *other = cell.first; other != cell.second && *other < limit; other++) {
+                        if (grid.matches(v, *other)) {
+                            found.push_back(*other);
+                        }
+                    }
+                });
+            }
+            // 不同格子的顶点互不重复，合并后排序即可
+            std::sort(found.begin() + long(first), found.end());
+            matchCounts[i] = static_cast<uint32_t>(found.size() - first);
+        }
+    });
+    tables = std::vector<CellTable>();
+
+    // 第三步：按顺序扫描一次代表顶点，合并到最早的、容差内相同的全局代表顶点上，不再查表；
+    // 其余顶点随所在范围的代表顶点合并
+    std::vector<uint32_t> remap(vertexCount);
+    for (size_t task = 0; task < taskCount; task++) {
+        const uint32_t *candidate = matches[task].data();
+        size_t end = std::min(merged.size(), (task + 1) * mergedRange);
+        for (size_t i = task * mergedRange; i < end; i++) {
+            uint32_t v = merged[i];
+            remap[v] = v;
+            for (uint32_t k = 0; k < matchCounts[i] && remap[v] == v; k++) {
+                if (remap[candidate[k]] == candidate[k]) {
+                    remap[v] = candidate[k];
+                }
+            }
+            candidate += matchCounts[i];
+        }
+    }
+    runTasks(taskCount, [&](size_t task) {
+        size_t end = std::min(vertexCount, (task + 1) * rangeSize);
+        for (size_t v = task * rangeSize; v < end; v++) {
+            remap[v] = remap[local[v]];
+        }
+    });
+    return compact(vertices, indices, remap);
+}
+
+std::vector<MeshChunk> MeshWelder::split(
+        const std::vector<Vertex> &vertices,
+        const std::vector<Index> &indices,
+        GLenum mode,
+        size_t maxVertices) {
+    const size_t stride = primitiveSize(mode);
+    assert(indices.size() % stride == 0);
+    assert(maxVertices >= stride);
+
+    std::vector<MeshChunk> chunks;
+    std::vector<uint32_t> localIndex(vertices.size(), kNone);
+    std::vector<uint32_t> touched;
+
+    auto startChunk = [&]() {
+        for (uint32_t vertex: touched) {
+            localIndex[vertex] = kNone;
+        }
+        touched.clear();
+        chunks.emplace_back();
+    };
+    startChunk();
+
+    for (size_t i = 0; i < indices.size(); i += stride) {
+        // 统计这个图元会新增多少个顶点，放不下就开始新块
+        size_t added = 0;
+        for (size_t corner = 0; corner < stride; corner++) {
+            Index vertex = indices[i + corner];
+            bool duplicate = false;
+            for (size_t previous = 0; previous < corner; previous++) {
+                duplicate |= indices[i + previous] == vertex;
+            }
+            added += localIndex[vertex] == kNone && !duplicate;
+        }
+        if (chunks.back().vertices.size() + added > maxVertices) {
+            startChunk();
+        }
+
+        MeshChunk &chunk = chunks.back();
+        for (size_t corner = 0; corner < stride; corner++) {
+            Index vertex = indices[i + corner];
+            if (localIndex[vertex] == kNone) {
+                localIndex[vertex] = static_cast<uint32_t>(chunk.vertices.size());
+                chunk.vertices.push_back(vertices[vertex]);
+                touched.push_back(vertex);
+            }
+            chunk.indices.push_back(localIndex[vertex]);
+        }
+    }
+
+    if (chunks.back().indices.empty()) {
+        chunks.pop_back();
+    }
+    return chunks;
+}
@@ -0,0 +1,62 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHWELDER_H
+#define ANDROIDGLINVESTIGATIONS_MESHWELDER_H
+
+#include <cstddef>
+#include <vector>
+#include <GLES3/gl3.h>
+
+#include "VertexFormat.h"
+
+/*!
+ * 顶点焊接的容差设置
+ */
+struct WeldOptions {
+    float positionEpsilon = 1e-6f; // 位置逐分量的最大差值，0表示按位完全相等
+    float uvEpsilon = 1e-6f;       // uv逐分量的最大差值，小于0表示不比较uv
+    bool compareColor = true;      // 颜色是否必须完全相同
+    size_t threadCount = 0;        // 线程数，0表示使用硬件线程数
+};
+
+/*!
+ * 切分后的一个子网格，索引是子网格内部的局部索引
+ */
+struct MeshChunk {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+};
+
+/*!
+ * 顶点焊接与网格切分
+ */
+class MeshWelder {
+public:
+    //! 16位索引最多能寻址的顶点数
+    static constexpr size_t kMaxShortIndexVertices = 65536;
+
+    /*!
+     * 基于空间哈希的顶点焊接：把容差内相同的顶点合并为一个，并改写索引。
+     *
+     * 顶点按下标分成与线程数相同的范围，各范围并行地在范围内顺序去重；
+     * 再把各范围的代表顶点按格子的键分区，各线程并行地为自己的分区建表并查找容差内相同的代表顶点，
+     * 最后只对代表顶点顺序扫描一次，不再查表。每个顶点总是合并到顺序上最早的、容差内相同的代表顶点上。
+     * 由于容差比较不具有传递性，线程数不同时结果可能略有差别；只有一个线程时等价于顺序的贪心焊接。
+     *
+     * @return 焊接后的顶点数
+     */
+    static size_t weld(
+            std::vector<Vertex> &vertices,
+            std::vector<Index> &indices,
+            const WeldOptions &options = WeldOptions());
+
+    /*!
+     * 把网格切分成每块不超过 @a maxVertices 个顶点的子网格，图元不会被拆开
+     * @param mode 图元类型，决定每个图元占用的索引个数
+     */
+    static std::vector<MeshChunk> split(
+            const std::vector<Vertex> &vertices,
+            const std::vector<Index> &indices,
+            GLenum mode,
+            size_t maxVertices = kMaxShortIndexVertices);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHWELDER_H
@@ -0,0 +1,497 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <thread>
+
+#include "Bounds.h"
+
+namespace {
+
+constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+// 不做背面剔除的法线锥：法线的最大夹角接近90度时锥已经没有意义
+constexpr float kMinConeDot = 0.1f;
+
+// 裁剪矩阵 = 投影 * 模型，提取出的平面就在物体空间中
+void extractFrustum(const Mat4 &viewProjection, const Mat4 &model, Vec4 planes[6]) {
+    Frustum frustum = Frustum::fromMatrix(viewProjection * model);
+    std::copy(frustum.planes, frustum.planes + 6, planes);
+}
+
+struct Point {
+    float x, y, z;
+};
+
+inline Point positionOf(const std::vector<Vertex> &vertices, Index index) {
+    const Vector3 &p = vertices[index].position;
+    return Point{p.x, p.y, p.z};
+}
+
+inline float distance2(const Point &a, const Point &b) {
+    float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Ritter包围球：先用两个相距较远的点确定初始球，再逐点扩大
+void computeSphere(const std::vector<Point> &points, Meshlet &meshlet) {
+    Point first = points[0];
+    Point a = first;
+    for (const Point &p: points) {
+        if (distance2(p, first) > distance2(a, first)) {
+            a = p;
+        }
+    }
+    Point b = a;
+    for (const Point &p: points) {
+        if (distance2(p, a) > distance2(b, a)) {
+            b = p;
+        }
+    }
+    Point center = {(a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f};
+    float radius = std::sqrt(distance2(a, b)) * 0.5f;
+    for (const Point &p: points) {
+        float d = std::sqrt(distance2(p, center));
+        if (d > radius) {
+            float newRadius = (radius + d) * 0.5f;
+            float k = (newRadius - radius) / d;
+            center.x += (p.x - center.x) * k;
+            center.y += (p.y - center.y) * k;
+            center.z += (p.z - center.z) * k;
+            radius = newRadius;
+        }
+    }
+    meshlet.center[0] = center.x;
+    meshlet.center[1] = center.y;
+    meshlet.center[2] = center.z;
+    meshlet.radius = radius;
+}
+
+void computeCone(const std::vector<Point> &normals, Meshlet &meshlet) {
+    Point axis = {0.f, 0.f, 0.f};
+    for (const Point &n: normals) {
+        axis.x += n.x;
+        axis.y += n.y;
+        axis.z += n.z;
+    }
+    float length = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    meshlet.coneCutoff = 1.f;
+    if (length <= 0.f) {
+        return;
+    }
+    axis = {axis.x / length, axis.y / length, axis.z / length};
+    float minDot = 1.f;
+    for (const Point &n: normals) {
+        minDot = std::min(minDot, n.x * axis.x + n.y * axis.y + n.z * axis.z);
+    }
+    meshlet.coneAxis[0] = axis.x;
+    meshlet.coneAxis[1] = axis.y;
+    meshlet.coneAxis[2] = axis.z;
+    if (minDot > kMinConeDot) {
+        // 所有法线与轴的夹角都不超过acos(minDot)，剔除条件里用这个角的正弦
+        meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+    }
+}
+
+#if VECMATH_SSE
+
+using F4 = __m128;
+using M4 = __m128;
+
+inline F4 load(const float *p) { return _mm_loadu_ps(p); }
+inline F4 set1(float v) { return _mm_set1_ps(v); }
+inline F4 add(F4 a, F4 b) { return _mm_add_ps(a, b); }
+inline F4 sub(F4 a, F4 b) { return _mm_sub_ps(a, b); }
+inline F4 mul(F4 a, F4 b) { return _mm_mul_ps(a, b); }
+inline F4 sqrt4(F4 a) { return _mm_sqrt_ps(a); }
+inline M4 maskAll() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+inline M4 maskNone() { return _mm_setzero_ps(); }
+inline M4 greater(F4 a, F4 b) { return _mm_cmpgt_ps(a, b); }
+inline M4 maskAnd(M4 a, M4 b) { return _mm_and_ps(a, b); }
+inline M4 maskAndNot(M4 a, M4 b) { return _mm_andnot_ps(b, a); } // a & ~b
+inline int maskBits(M4 m) { return _mm_movemask_ps(m); }
+
+#elif VECMATH_NEON
+
+using F4 = float32x4_t;
+using M4 = uint32x4_t;
+
+inline F4 load(const float *p) { return vld1q_f32(p); }
+inline F4 set1(float v) { return vdupq_n_f32(v); }
+inline F4 add(F4 a, F4 b) { return vaddq_f32(a, b); }
+inline F4 sub(F4 a, F4 b) { return vsubq_f32(a, b); }
+inline F4 mul(F4 a, F4 b) { return vmulq_f32(a, b); }
+inline F4 sqrt4(F4 a) { return vsqrtq_f32(a); }
+inline M4 maskAll() { return vdupq_n_u32(0xFFFFFFFFu); }
+inline M4 maskNone() { return vdupq_n_u32(0); }
+inline M4 greater(F4 a, F4 b) { return vcgtq_f32(a, b); }
+inline M4 maskAnd(M4 a, M4 b) { return vandq_u32(a, b); }
+inline M4 maskAndNot(M4 a, M4 b) { return vbicq_u32(a, b); } // a & ~b
+inline int maskBits(M4 m) {
+    static const int32_t kShifts[4] = {-31, -30, -29, -28};
+    uint32x4_t bits = vshlq_u32(m, vld1q_s32(kShifts));
+    return int(vaddvq_u32(bits));
+}
+
+#endif
+
+// 测试[begin, end)之间的簇组（每组4个簇），返回可见簇数
+size_t cullGroups(
+        const MeshletMesh &mesh,
+        const CullingView &view,
+        size_t beginGroup,
+        size_t endGroup,
+        uint8_t *visible) {
+    const size_t meshletCount = mesh.meshlets.size();
+    size_t visibleCount = 0;
+
+#if VECMATH_SSE || VECMATH_NEON
+    for (size_t group = beginGroup; group < endGroup; group++) {
+        size_t base = group * 4;
+        F4 cx = load(&mesh.centerX[base]);
+        F4 cy = load(&mesh.centerY[base]);
+        F4 cz = load(&mesh.centerZ[base]);
+        F4 r = load(&mesh.radius[base]);
+        F4 negativeR = sub(set1(0.f), r);
+
+        // 视锥：到每个平面的有向距离都要大于-r
+        M4 inside = maskAll();
+        for (const Vec4 &plane: view.planes) {
+            F4 d = add(add(mul(cx, set1(plane.x)), mul(cy, set1(plane.y))),
+                       add(mul(cz, set1(plane.z)), set1(plane.w)));
+            inside = maskAnd(inside, greater(d, negativeR));
+        }
+
+        // 法线锥
+        F4 ax = load(&mesh.axisX[base]);
+        F4 ay = load(&mesh.axisY[base]);
+        F4 az = load(&mesh.axisZ[base]);
+        F4 cutoff = load(&mesh.cutoff[base]);
+        M4 backfacing;
+        if (!view.backfaceCulling) {
+            backfacing = maskNone();
+        } else if (view.isOrthographic) {
+            F4 d = add(add(mul(ax, set1(view.viewDirection.x)), mul(ay, set1(view.viewDirection.y))),
+                       mul(az, set1(view.viewDirection.z)));
+            backfacing = greater(d, cutoff);
+        } else {
+            F4 dx = sub(cx, set1(view.cameraPosition.x));
+            F4 dy = sub(cy, set1(view.cameraPosition.y));
+            F4 dz = sub(cz, set1(view.cameraPosition.z));
+            F4 length = sqrt4(add(add(mul(dx, dx), mul(dy, dy)), mul(dz, dz)));
+            F4 d = add(add(mul(dx, ax), mul(dy, ay)), mul(dz, az));
+            backfacing = greater(d, add(mul(cutoff, length), r));
+        }
+
+        int bits = maskBits(maskAndNot(inside, backfacing));
+        for (size_t lane = 0; lane < 4 && base + lane < meshletCount; lane++) {
+            uint8_t isVisible = (bits >> lane) & 1;
+            visible[base + lane] = isVisible;
+            visibleCount += isVisible;
+        }
+    }
+#else
+    for (size_t i = beginGroup * 4; i < std::min(endGroup * 4, meshletCount); i++) {
+        float cx = mesh.centerX[i], cy = mesh.centerY[i], cz = mesh.centerZ[i], r = mesh.radius[i];
+        bool inside = true;
+        for (const Vec4 &plane: view.planes) {
+            inside &= cx * plane.x + cy * plane.y + cz * plane.z + plane.w > -r;
+        }
+        bool backfacing;
+        if (!view.backfaceCulling) {
+            backfacing = false;
+        } else if (view.isOrthographic) {
+            float d = mesh.axisX[i] * view.viewDirection.x
+                      + mesh.axisY[i] * view.viewDirection.y
+                      + mesh.axisZ[i] * view.viewDirection.z;
+            backfacing = d > mesh.cutoff[i];
+        } else {
+            float dx = cx - view.cameraPosition.x;
+            float dy = cy - view.cameraPosition.y;
+            float dz = cz - view.cameraPosition.z;
+            float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+            float d = dx * mesh.axisX[i] + dy * mesh.axisY[i] + dz * mesh.axisZ[i];
+            backfacing = d > mesh.cutoff[i] * length + r;
+        }
+        visible[i] = inside && !backfacing;
+        visibleCount += visible[i];
+    }
+#endif
+    return visibleCount;
+}
+
+} // namespace
+
+CullingView CullingView::perspective(
+        const Mat4 &viewProjection,
+        const Mat4 &model,
+        const Vec3 &cameraPosition) {
+    CullingView view;
+    extractFrustum(viewProjection, model, view.planes);
+    Mat4 inverseModel;
+    if (!inverse(model, inverseModel)) {
+        inverseModel = Mat4::identity();
+    }
+    view.cameraPosition = transformPoint(inverseModel, cameraPosition);
+    view.viewDirection = Vec3{0.f, 0.f, -1.f, 0.f};
+    view.isOrthographic = false;
+    return view;
+}
+
+CullingView CullingView::orthographic(
+        const Mat4 &viewProjection,
+        const Mat4 &model,
+        const Vec3 &viewDirection) {
+    CullingView view;
+    extractFrustum(viewProjection, model, view.planes);
+    Mat4 inverseModel;
+    if (!inverse(model, inverseModel)) {
+        inverseModel = Mat4::identity();
+    }
+    // 方向向量w为0，不受平移影响
+    Vec4 direction = inverseModel * Vec4{viewDirection.x, viewDirection.y, viewDirection.z, 0.f};
+    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+    if (length > 0.f) {
+        direction.x /= length;
+        direction.y /= length;
+        direction.z /= length;
+    }
+    view.viewDirection = Vec3{direction.x, direction.y, direction.z, 0.f};
+    view.cameraPosition = Vec3{0.f, 0.f, 0.f, 0.f};
+    view.isOrthographic = true;
+    return view;
+}
+
+MeshletMesh MeshletBuilder::build(
+        const std::vector<Vertex> &vertices,
+        const std::vector<Index> &indices,
+        size_t maxVertices,
+        size_t maxTriangles) {
+    assert(indices.size() % 3 == 0);
+    assert(maxVertices >= 3 && maxTriangles >= 1);
+    const size_t triangleCount = indices.size() / 3;
+    const size_t vertexCount = vertices.size();
+
+    MeshletMesh mesh;
+    mesh.indices.reserve(indices.size());
+
+    // 顶点到三角形的邻接表
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    std::vector<uint32_t> adjacent(indices.size());
+    for (Index index: indices) {
+        offsets[index + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            adjacent[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(vertexCount, kNone); // 顶点当前属于哪个簇
+    std::vector<uint32_t> candidates;
+    std::vector<Point> points;
+    std::vector<Point> normals;
+    size_t seed = 0;
+
+    while (true) {
+        while (seed < triangleCount && emitted[seed]) {
+            seed++;
+        }
+        if (seed == triangleCount) {
+            break;
+        }
+
+        const auto meshletIndex = static_cast<uint32_t>(mesh.meshlets.size());
+        Meshlet meshlet;
+        meshlet.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+        points.clear();
+        normals.clear();
+        candidates.clear();
+        Point sum = {0.f, 0.f, 0.f};
+
+        auto newVertices = [&](uint32_t triangle) {
+            uint32_t count = 0;
+            for (int corner = 0; corner < 3; corner++) {
+                count += vertexMeshlet[indices[triangle * 3 + corner]] != meshletIndex;
+            }
+            return count;
+        };
+
+        auto addTriangle = [&](uint32_t triangle) {
+            emitted[triangle] = 1;
+            const Index *tri = &indices[triangle * 3];
+            for (int corner = 0; corner < 3; corner++) {
+                Index v = tri[corner];
+                mesh.indices.push_back(v);
+                if (vertexMeshlet[v] != meshletIndex) {
+                    vertexMeshlet[v] = meshletIndex;
+                    Point p = positionOf(vertices, v);
+                    points.push_back(p);
+                    sum = {sum.x + p.x, sum.y + p.y, sum.z + p.z};
+                    meshlet.vertexCount++;
+                }
+                for (uint32_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                    if (!emitted[adjacent[i]]) {
+                        candidates.push_back(adjacent[i]);
+                    }
+                }
+            }
+            meshlet.triangleCount++;
+
+            Point p0 = positionOf(vertices, tri[0]);
+            Point p1 = positionOf(vertices, tri[1]);
+            Point p2 = positionOf(vertices, tri[2]);
+            Point e1 = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+            Point e2 = {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+            Point n = {e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x};
+            float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+            if (length > 0.f) {
+                normals.push_back(Point{n.x / length, n.y / length, n.z / length});
+            }
+        };
+
+        addTriangle(static_cast<uint32_t>(seed));
+
+        while (meshlet.triangleCount < maxTriangles) {
+            // 在相邻三角形中选新增顶点最少、离簇中心最近的一个
+            float inverseCount = 1.f / float(meshlet.vertexCount);
+            Point centroid = {sum.x * inverseCount, sum.y * inverseCount, sum.z * inverseCount};
+            uint32_t best = kNone;
+            uint32_t bestNew = 4;
+            float bestDistance = INFINITY;
+            size_t write = 0;
+            for (uint32_t triangle: candidates) {
+                if (emitted[triangle]) {
+                    continue;
+                }
+                candidates[write++] = triangle;
+                uint32_t added = newVertices(triangle);
+                if (meshlet.vertexCount + added > maxVertices || added > bestNew) {
+                    continue;
+                }
+                const Index *tri = &indices[triangle * 3];
+                Point p0 = positionOf(vertices, tri[0]);
+                Point p1 = positionOf(vertices, tri[1]);
+                Point p2 = positionOf(vertices, tri[2]);
+                Point center = {(p0.x + p1.x + p2.x) / 3.f, (p0.y + p1.y + p2.y) / 3.f, (p0.z + p1.z + p2.z) / 3.f};
+                float d = distance2(center, centroid);
+                if (added < bestNew || d < bestDistance) {
+                    best = triangle;
+                    bestNew = added;
+                    bestDistance = d;
+                }
+            }
+            candidates.resize(write);
+            if (best == kNone) {
+                break;
+            }
+            addTriangle(best);
+        }
+
+        computeSphere(points, meshlet);
+        computeCone(normals, meshlet);
+        mesh.meshlets.push_back(meshlet);
+    }
+
+    // 按分量存放剔除数据，补齐到4的倍数。补齐的簇半径为0、不能背面剔除，结果不会被输出
+    size_t padded = (mesh.meshlets.size() + 3) & ~size_t(3);
+    for (auto *array: {&mesh.centerX, &mesh.centerY, &mesh.centerZ, &mesh.radius,
+                       &mesh.axisX, &mesh.axisY, &mesh.axisZ}) {
+        array->assign(padded, 0.f);
+    }
+    mesh.cutoff.assign(padded, 1.f);
+    for (size_t i = 0; i < mesh.meshlets.size(); i++) {
+        const Meshlet &meshlet = mesh.meshlets[i];
+        mesh.centerX[i] = meshlet.center[0];
+        mesh.centerY[i] = meshlet.center[1];
+        mesh.centerZ[i] = meshlet.center[2];
+        mesh.radius[i] = meshlet.radius;
+        mesh.axisX[i] = meshlet.coneAxis[0];
+        mesh.axisY[i] = meshlet.coneAxis[1];
+        mesh.axisZ[i] = meshlet.coneAxis[2];
+        mesh.cutoff[i] = meshlet.coneCutoff;
+    }
+    return mesh;
+}
+
+size_t MeshletCuller::cull(
+        const MeshletMesh &mesh,
+        const CullingView &view,
+        std::vector<uint8_t> &outVisible,
+        size_t threadCount) {
+    const size_t meshletCount = mesh.meshlets.size();
+    outVisible.resize(meshletCount);
+    if (meshletCount == 0) {
+        return 0;
+    }
+
+    const size_t groupCount = (meshletCount + 3) / 4;
+    size_t workers = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, meshletCount / kMinMeshletsPerThread));
+    if (workers == 1) {
+        return cullGroups(mesh, view, 0, groupCount, outVisible.data());
+    }
+
+    const size_t groupsPerWorker = (groupCount + workers - 1) / workers;
+    std::vector<size_t> visibleCounts(workers, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t worker = 0; worker < workers; worker++) {
+        size_t begin = worker * groupsPerWorker;
+        size_t end = std::min(groupCount, begin + groupsPerWorker);
+        threads.emplace_back([&, worker, begin, end]() {
+            visibleCounts[worker] = cullGroups(mesh, view, begin, end, outVisible.data());
+        });
+    }
+    size_t visibleCount = 0;
+    for (size_t worker = 0; worker < workers; worker++) {
+        threads[worker].join();
+        visibleCount += visibleCounts[worker];
+    }
+    return visibleCount;
+}
+
+size_t MeshletCuller::buildDrawRanges(
+        const MeshletMesh &mesh,
+        const std::vector<uint8_t> &visible,
+        std::vector<DrawRange> &outRanges) {
+    outRanges.clear();
+    size_t triangles = 0;
+    for (size_t i = 0; i < mesh.meshlets.size(); i++) {
+        if (!visible[i]) {
+            continue;
+        }
+        const Meshlet &meshlet = mesh.meshlets[i];
+        uint32_t count = meshlet.triangleCount * 3;
+        triangles += meshlet.triangleCount;
+        // 簇在索引缓冲中是连续的，相邻的可见簇合并成一次绘制
+        if (!outRanges.empty()
+            && outRanges.back().indexOffset + outRanges.back().indexCount == meshlet.indexOffset) {
+            outRanges.back().indexCount += count;
+        } else {
+            outRanges.push_back(DrawRange{meshlet.indexOffset, count});
+        }
+    }
+    return triangles;
+}
+
+void MeshletCuller::compactIndices(
+        const MeshletMesh &mesh,
+        const std::vector<uint8_t> &visible,
+        std::vector<Index> &outIndices) {
+    outIndices.clear();
+    for (size_t i = 0; i < mesh.meshlets.size(); i++) {
+        if (!visible[i]) {
+            continue;
+        }
+        const Meshlet &meshlet = mesh.meshlets[i];
+        auto begin = mesh.indices.begin() + meshlet.indexOffset;
+        outIndices.insert(outIndices.end(), begin, begin + meshlet.triangleCount * 3);
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHLET_H
+#define ANDROIDGLINVESTIGATIONS_MESHLET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VecMath.h"
+#include "VertexFormat.h"
+
+/*!
+ * 一个簇：索引缓冲中连续的一段三角形，以及用于剔除的包围球和法线锥
+ */
+struct Meshlet {
+    uint32_t indexOffset = 0;   // 在MeshletMesh::indices中的起始位置
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;   // 簇引用的不同顶点数
+
+    float center[3] = {0.f, 0.f, 0.f}; // 包围球
+    float radius = 0.f;
+
+    float coneAxis[3] = {0.f, 0.f, 1.f}; // 法线锥轴
+    float coneCutoff = 1.f; // 法线锥半角的正弦，1表示法线过于分散，不能做背面剔除
+};
+
+/*!
+ * 分簇后的网格。indices已经按簇重排，每个簇的三角形连续存放，仍然使用原始的顶点编号，
+ * 所以可以直接作为Model的索引缓冲。
+ *
+ * 剔除用的数据另外按分量分开存放，每4个簇一组，方便SIMD一次测试4个簇。
+ */
+struct MeshletMesh {
+    std::vector<Meshlet> meshlets;
+    std::vector<Index> indices;
+
+    // 按分量存放的剔除数据，长度向上补齐到4的倍数，补齐部分不会被输出
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ, cutoff;
+};
+
+/*!
+ * 一段要绘制的索引范围
+ */
+struct DrawRange {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+};
+
+/*!
+ * 物体空间中的剔除参数。由投影矩阵和模型矩阵直接提取，不需要变换每个簇的包围球
+ */
+struct CullingView {
+    Vec4 planes[6];       // 物体空间中的视锥平面，法线已归一化并指向视锥内部
+    Vec3 cameraPosition;  // 透视投影时的相机位置（物体空间）
+    Vec3 viewDirection;   // 正交投影时的视线方向（物体空间，单位向量）
+    bool isOrthographic = false;
+    bool backfaceCulling = true; // 没有开启GL_CULL_FACE时背面也会被看到，这时不能用法线锥剔除
+
+    /*!
+     * @param viewProjection 投影矩阵乘以视图矩阵
+     * @param model 模型矩阵
+     * @param cameraPosition 世界空间中的相机位置
+     */
+    static CullingView perspective(const Mat4 &viewProjection, const Mat4 &model, const Vec3 &cameraPosition);
+
+    /*!
+     * @param viewProjection 投影矩阵乘以视图矩阵
+     * @param model 模型矩阵
+     * @param viewDirection 世界空间中的视线方向
+     */
+    static CullingView orthographic(const Mat4 &viewProjection, const Mat4 &model, const Vec3 &viewDirection);
+};
+
+/*!
+ * 簇的构建与剔除
+ */
+class MeshletBuilder {
+public:
+    static constexpr size_t kMaxVertices = 64;
+    static constexpr size_t kMaxTriangles = 124;
+
+    /*!
+     * 把三角形列表切分成簇。每个簇从一个种子三角形开始，贪心地加入与簇相邻、
+     * 新增顶点最少且离簇中心最近的三角形，直到顶点数或三角形数达到上限。
+     * 输入最好先经过 MeshOptimizer::optimizeVertexCache，种子会按索引顺序选取。
+     */
+    static MeshletMesh build(
+            const std::vector<Vertex> &vertices,
+            const std::vector<Index> &indices,
+            size_t maxVertices = kMaxVertices,
+            size_t maxTriangles = kMaxTriangles);
+};
+
+class MeshletCuller {
+public:
+    //! 每个线程至少处理的簇数，簇太少时不值得开线程
+    static constexpr size_t kMinMeshletsPerThread = 4096;
+
+    /*!
+     * 剔除整个簇：包围球在视锥外，或者法线锥表明簇内所有三角形都背对相机（需要开启背面剔除）
+     * @param mesh 分簇后的网格
+     * @param view 物体空间中的剔除参数
+     * @param outVisible 输出每个簇是否可见，长度为簇数
+     * @param threadCount 线程数，0表示使用硬件线程数
+     * @return 可见的簇数
+     */
+    static size_t cull(
+            const MeshletMesh &mesh,
+            const CullingView &view,
+            std::vector<uint8_t> &outVisible,
+            size_t threadCount = 0);
+
+    /*!
+     * 把可见簇的索引范围合并成尽量少的绘制范围
+     * @return 可见的三角形数
+     */
+    static size_t buildDrawRanges(
+            const MeshletMesh &mesh,
+            const std::vector<uint8_t> &visible,
+            std::vector<DrawRange> &outRanges);
+
+    /*!
+     * 把可见簇的索引拷贝成一个紧凑的索引缓冲
+     */
+    static void compactIndices(
+            const MeshletMesh &mesh,
+            const std::vector<uint8_t> &visible,
+            std::vector<Index> &outIndices);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHLET_H
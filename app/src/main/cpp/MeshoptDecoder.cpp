@@ -0,0 +1,617 @@
+#include "MeshoptDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "VecMath.h"
+
+// pshufb需要SSSE3，Android的x86和x86_64 ABI都保证支持
+#if VECMATH_SSE && defined(__SSSE3__)
+#define MESHOPT_SSSE3 1
+#include <tmmintrin.h>
+#elif VECMATH_NEON
+#define MESHOPT_NEON 1
+#endif
+
+namespace {
+
+constexpr uint8_t kVertexHeader = 0xA0;
+constexpr uint8_t kIndexHeader = 0xE0;
+constexpr uint8_t kSequenceHeader = 0xD0;
+constexpr int kMaxIndexVersion = 1;
+
+constexpr size_t kVertexBlockSizeBytes = 8192;
+constexpr size_t kVertexBlockMaxSize = 256;
+constexpr size_t kByteGroupSize = 16;
+// 解码一组最多读取的字节数（8字节选择位 + 16字节数据）。每组开始前检查剩余长度，
+// 组内就不再检查；码流末尾至少有32字节的尾部，合法输入总能满足
+constexpr size_t kByteGroupDecodeLimit = 24;
+constexpr size_t kTailMinSize = 32;
+
+// 一块顶点的个数：数据不超过8KB，且是16的倍数
+size_t vertexBlockSize(size_t stride) {
+    size_t size = (kVertexBlockSizeBytes / stride) & ~(kByteGroupSize - 1);
+    return std::min(size, kVertexBlockMaxSize);
+}
+
+inline uint8_t unzigzag8(uint8_t value) {
+    return uint8_t((0 - (value & 1)) ^ (value >> 1));
+}
+
+inline uint32_t readU32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 每组16个值先存每个值的2或4位选择位，选择位全为1表示真实值在后面单独存放
+template<int Bits>
+const uint8_t *decodePackedGroup(const uint8_t *data, uint8_t *out) {
+    constexpr int kPerByte = 8 / Bits;
+    constexpr uint8_t kSentinel = (1u << Bits) - 1u;
+    const uint8_t *extra = data + kByteGroupSize / kPerByte;
+    for (size_t i = 0; i < kByteGroupSize; i += kPerByte) {
+        uint8_t byte = *data++;
+        for (int k = 0; k < kPerByte; k++) {
+            auto value = uint8_t(byte >> (8 - Bits));
+            byte = uint8_t(byte << Bits);
+            out[i + k] = value == kSentinel ? *extra : value;
+            extra += value == kSentinel;
+        }
+    }
+    return extra;
+}
+
+#if MESHOPT_SSSE3 || MESHOPT_NEON
+// 8个选择位命中情况（每位表示该值是否单独存放）对应的字节重排表和单独存放的字节数
+struct ShuffleTables {
+    uint8_t shuffle[256][8];
+    uint8_t count[256];
+};
+
+constexpr ShuffleTables makeShuffleTables() {
+    ShuffleTables tables{};
+    for (int mask = 0; mask < 256; mask++) {
+        uint8_t count = 0;
+        for (int i = 0; i < 8; i++) {
+            bool escaped = (mask >> i) & 1;
+            // 0x80在pshufb中输出0，在vtbl中也超出表的范围输出0
+            tables.shuffle[mask][i] = escaped ? count : 0x80;
+            count += escaped;
+        }
+        tables.count[mask] = count;
+    }
+    return tables;
+}
+
+constexpr ShuffleTables kShuffleTables = makeShuffleTables();
+#endif
+
+#if MESHOPT_SSSE3
+// 命中掩码为sentinel的值从extra中按顺序取出，其余保留选择位本身
+const uint8_t *finishGroup(const uint8_t *extra, __m128i selectors, uint8_t sentinel, uint8_t *out) {
+    __m128i escaped = _mm_cmpeq_epi8(selectors, _mm_set1_epi8(char(sentinel)));
+    int bits = _mm_movemask_epi8(escaped);
+    int mask0 = bits & 0xFF;
+    int mask1 = bits >> 8;
+    __m128i low = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(kShuffleTables.shuffle[mask0]));
+    __m128i high = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(kShuffleTables.shuffle[mask1]));
+    // 后8个值的额外字节接在前8个之后
+    high = _mm_add_epi8(high, _mm_set1_epi8(char(kShuffleTables.count[mask0])));
+    __m128i rest = _mm_loadu_si128(reinterpret_cast<const __m128i *>(extra));
+    __m128i values = _mm_shuffle_epi8(rest, _mm_unpacklo_epi64(low, high));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_or_si128(values, _mm_andnot_si128(escaped, selectors)));
+    return extra + kShuffleTables.count[mask0] + kShuffleTables.count[mask1];
+}
+
+const uint8_t *decodeBytesGroup(const uint8_t *data, uint8_t *out, int bitsLog2) {
+    switch (bitsLog2) {
+        case 0:
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_setzero_si128());
+            return data;
+        case 1: {
+            // 4字节选择位展开成16个2位值，每个字节的高位在前
+            __m128i packed = _mm_cvtsi32_si128(int(readU32(data)));
+            __m128i nibbles = _mm_unpacklo_epi8(_mm_srli_epi16(packed, 4), packed);
+            __m128i pairs = _mm_unpacklo_epi8(_mm_srli_epi16(nibbles, 2), nibbles);
+            return finishGroup(data + 4, _mm_and_si128(pairs, _mm_set1_epi8(3)), 3, out);
+        }
+        case 2: {
+            __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(data));
+            __m128i nibbles = _mm_unpacklo_epi8(_mm_srli_epi16(packed, 4), packed);
+            return finishGroup(data + 8, _mm_and_si128(nibbles, _mm_set1_epi8(15)), 15, out);
+        }
+        default:
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(data)));
+            return data + kByteGroupSize;
+    }
+}
+#elif MESHOPT_NEON
+const uint8_t *finishGroup(const uint8_t *extra, uint8x16_t selectors, uint8_t sentinel, uint8_t *out) {
+    static const uint8_t kBits[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t escaped = vceqq_u8(selectors, vdupq_n_u8(sentinel));
+    uint8x8_t bits = vld1_u8(kBits);
+    int mask0 = vaddv_u8(vand_u8(vget_low_u8(escaped), bits));
+    int mask1 = vaddv_u8(vand_u8(vget_high_u8(escaped), bits));
+    uint8x8_t low = vtbl1_u8(vld1_u8(extra), vld1_u8(kShuffleTables.shuffle[mask0]));
+    uint8x8_t high = vtbl1_u8(vld1_u8(extra + kShuffleTables.count[mask0]), vld1_u8(kShuffleTables.shuffle[mask1]));
+    vst1q_u8(out, vbslq_u8(escaped, vcombine_u8(low, high), selectors));
+    return extra + kShuffleTables.count[mask0] + kShuffleTables.count[mask1];
+}
+
+const uint8_t *decodeBytesGroup(const uint8_t *data, uint8_t *out, int bitsLog2) {
+    switch (bitsLog2) {
+        case 0:
+            vst1q_u8(out, vdupq_n_u8(0));
+            return data;
+        case 1: {
+            uint8x8_t packed = vreinterpret_u8_u32(vdup_n_u32(readU32(data)));
+            uint8x8_t nibbles = vzip_u8(vshr_n_u8(packed, 4), packed).val[0];
+            uint8x8x2_t pairs = vzip_u8(vshr_n_u8(nibbles, 2), nibbles);
+            uint8x16_t selectors = vandq_u8(vcombine_u8(pairs.val[0], pairs.val[1]), vdupq_n_u8(3));
+            return finishGroup(data + 4, selectors, 3, out);
+        }
+        case 2: {
+            uint8x8_t packed = vld1_u8(data);
+            uint8x8x2_t nibbles = vzip_u8(vshr_n_u8(packed, 4), packed);
+            uint8x16_t selectors = vandq_u8(vcombine_u8(nibbles.val[0], nibbles.val[1]), vdupq_n_u8(15));
+            return finishGroup(data + 8, selectors, 15, out);
+        }
+        default:
+            vst1q_u8(out, vld1q_u8(data));
+            return data + kByteGroupSize;
+    }
+}
+#else
+const uint8_t *decodeBytesGroup(const uint8_t *data, uint8_t *out, int bitsLog2) {
+    switch (bitsLog2) {
+        case 0:
+            memset(out, 0, kByteGroupSize);
+            return data;
+        case 1:
+            return decodePackedGroup<2>(data, out);
+        case 2:
+            return decodePackedGroup<4>(data, out);
+        default:
+            memcpy(out, data, kByteGroupSize);
+            return data + kByteGroupSize;
+    }
+}
+#endif
+
+// 一个字节通道：每4组共用一个字节的头，每组2位表示这组的编码方式
+const uint8_t *decodeBytes(const uint8_t *data, const uint8_t *end, uint8_t *out, size_t size) {
+    size_t headerSize = (size / kByteGroupSize + 3) / 4;
+    if (size_t(end - data) < headerSize) {
+        return nullptr;
+    }
+    const uint8_t *header = data;
+    data += headerSize;
+    for (size_t i = 0; i < size; i += kByteGroupSize) {
+        if (size_t(end - data) < kByteGroupDecodeLimit) {
+            return nullptr;
+        }
+        size_t group = i / kByteGroupSize;
+        int bitsLog2 = (header[group / 4] >> ((group % 4) * 2)) & 3;
+        data = decodeBytesGroup(data, out + i, bitsLog2);
+    }
+    return data;
+}
+
+/*
+ * 把4个字节通道的差值还原成顶点：每个通道的值是相对上一个顶点同一字节的zigzag差值。
+ * out指向第一个顶点的这4个字节，last是上一块最后一个顶点的这4个字节
+ */
+#if MESHOPT_SSSE3
+inline __m128i unzigzag(__m128i value) {
+    __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi8(1)));
+    return _mm_xor_si128(sign, _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7F)));
+}
+
+void reconstructChannels(const uint8_t (*deltas)[kVertexBlockMaxSize], uint8_t *out, size_t count, size_t stride,
+                         const uint8_t *last) {
+    __m128i previous = _mm_set1_epi32(int(readU32(last)));
+    for (size_t i = 0; i < count; i += 16) {
+        __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas[0] + i));
+        __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas[1] + i));
+        __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas[2] + i));
+        __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas[3] + i));
+        // 转置成每个32位元素是一个顶点的4个字节
+        __m128i t0 = _mm_unpacklo_epi8(r0, r1);
+        __m128i t1 = _mm_unpackhi_epi8(r0, r1);
+        __m128i t2 = _mm_unpacklo_epi8(r2, r3);
+        __m128i t3 = _mm_unpackhi_epi8(r2, r3);
+        __m128i groups[4] = {
+                _mm_unpacklo_epi16(t0, t2), _mm_unpackhi_epi16(t0, t2),
+                _mm_unpacklo_epi16(t1, t3), _mm_unpackhi_epi16(t1, t3)};
+        for (int g = 0; g < 4; g++) {
+            // 4个顶点内做前缀和，再加上前一个顶点
+            __m128i value = unzigzag(groups[g]);
+            value = _mm_add_epi8(value, _mm_slli_si128(value, 4));
+            value = _mm_add_epi8(value, _mm_slli_si128(value, 8));
+            value = _mm_add_epi8(value, previous);
+            previous = _mm_shuffle_epi32(value, 0xFF);
+
+            alignas(16) uint32_t vertices[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(vertices), value);
+            size_t first = i + g * 4;
+            size_t n = first < count ? std::min<size_t>(4, count - first) : 0;
+            for (size_t v = 0; v < n; v++) {
+                memcpy(out + (first + v) * stride, &vertices[v], sizeof(uint32_t));
+            }
+        }
+    }
+}
+#elif MESHOPT_NEON
+inline uint8x16_t unzigzag(uint8x16_t value) {
+    int8x16_t sign = vnegq_s8(vreinterpretq_s8_u8(vandq_u8(value, vdupq_n_u8(1))));
+    return veorq_u8(vreinterpretq_u8_s8(sign), vshrq_n_u8(value, 1));
+}
+
+void reconstructChannels(const uint8_t (*deltas)[kVertexBlockMaxSize], uint8_t *out, size_t count, size_t stride,
+                         const uint8_t *last) {
+    uint8x16_t previous = vreinterpretq_u8_u32(vdupq_n_u32(readU32(last)));
+    uint8x16_t zero = vdupq_n_u8(0);
+    for (size_t i = 0; i < count; i += 16) {
+        uint8x16x2_t t01 = vzipq_u8(vld1q_u8(deltas[0] + i), vld1q_u8(deltas[1] + i));
+        uint8x16x2_t t23 = vzipq_u8(vld1q_u8(deltas[2] + i), vld1q_u8(deltas[3] + i));
+        uint16x8x2_t low = vzipq_u16(vreinterpretq_u16_u8(t01.val[0]), vreinterpretq_u16_u8(t23.val[0]));
+        uint16x8x2_t high = vzipq_u16(vreinterpretq_u16_u8(t01.val[1]), vreinterpretq_u16_u8(t23.val[1]));
+        uint8x16_t groups[4] = {
+                vreinterpretq_u8_u16(low.val[0]), vreinterpretq_u8_u16(low.val[1]),
+                vreinterpretq_u8_u16(high.val[0]), vreinterpretq_u8_u16(high.val[1])};
+        for (int g = 0; g < 4; g++) {
+            uint8x16_t value = unzigzag(groups[g]);
+            value = vaddq_u8(value, vextq_u8(zero, value, 12));
+            value = vaddq_u8(value, vextq_u8(zero, value, 8));
+            value = vaddq_u8(value, previous);
+            previous = vreinterpretq_u8_u32(vdupq_laneq_u32(vreinterpretq_u32_u8(value), 3));
+
+            uint32_t vertices[4];
+            vst1q_u32(vertices, vreinterpretq_u32_u8(value));
+            size_t first = i + g * 4;
+            size_t n = first < count ? std::min<size_t>(4, count - first) : 0;
+            for (size_t v = 0; v < n; v++) {
+                memcpy(out + (first + v) * stride, &vertices[v], sizeof(uint32_t));
+            }
+        }
+    }
+}
+#else
+void reconstructChannels(const uint8_t (*deltas)[kVertexBlockMaxSize], uint8_t *out, size_t count, size_t stride,
+                         const uint8_t *last) {
+    for (size_t channel = 0; channel < 4; channel++) {
+        uint8_t previous = last[channel];
+        for (size_t i = 0; i < count; i++) {
+            previous = uint8_t(previous + unzigzag8(deltas[channel][i]));
+            out[i * stride + channel] = previous;
+        }
+    }
+}
+#endif
+
+const uint8_t *decodeVertexBlock(const uint8_t *data, const uint8_t *end, uint8_t *out, size_t count, size_t stride,
+                                 uint8_t *last) {
+    uint8_t deltas[4][kVertexBlockMaxSize];
+    size_t alignedCount = (count + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+    // stride是4的倍数，每次还原4个字节通道
+    for (size_t k = 0; k < stride; k += 4) {
+        for (auto &channel: deltas) {
+            data = decodeBytes(data, end, channel, alignedCount);
+            if (!data) {
+                return nullptr;
+            }
+        }
+        reconstructChannels(deltas, out + k, count, stride, last + k);
+    }
+    memcpy(last, out + (count - 1) * stride, stride);
+    return data;
+}
+
+uint32_t decodeVByte(const uint8_t *&data) {
+    uint8_t lead = *data++;
+    if (lead < 128) {
+        return lead;
+    }
+    // 最多5字节，调用方保证可读
+    uint32_t result = lead & 127u;
+    for (int shift = 7; shift <= 28; shift += 7) {
+        uint8_t group = *data++;
+        result |= uint32_t(group & 127u) << shift;
+        if (group < 128) {
+            break;
+        }
+    }
+    return result;
+}
+
+inline uint32_t decodeIndex(const uint8_t *&data, uint32_t last) {
+    uint32_t value = decodeVByte(data);
+    return last + ((value >> 1) ^ (0u - (value & 1u)));
+}
+
+inline void writeIndex(void *destination, size_t position, size_t indexSize, uint32_t index) {
+    auto *out = static_cast<uint8_t *>(destination) + position * indexSize;
+    if (indexSize == 2) {
+        auto value = uint16_t(index);
+        memcpy(out, &value, sizeof(value));
+    } else {
+        memcpy(out, &index, sizeof(index));
+    }
+}
+
+template<typename T>
+void decodeOctahedral(uint8_t *data, size_t count) {
+    const auto maxValue = float((1 << (sizeof(T) * 8 - 1)) - 1);
+    for (size_t i = 0; i < count; i++) {
+        T v[4];
+        memcpy(v, data + i * sizeof(v), sizeof(v));
+        // 第3个分量存的是1.0，借此还原z
+        auto x = float(v[0]);
+        auto y = float(v[1]);
+        float z = float(v[2]) - std::fabs(x) - std::fabs(y);
+        // z < 0时折回下半球
+        float t = std::min(z, 0.f);
+        x += x >= 0.f ? t : -t;
+        y += y >= 0.f ? t : -t;
+        float length = std::sqrt(x * x + y * y + z * z);
+        float scale = length > 0.f ? maxValue / length : 0.f;
+        v[0] = T(int(x * scale + (x >= 0.f ? 0.5f : -0.5f)));
+        v[1] = T(int(y * scale + (y >= 0.f ? 0.5f : -0.5f)));
+        v[2] = T(int(z * scale + (z >= 0.f ? 0.5f : -0.5f)));
+        memcpy(data + i * sizeof(v), v, sizeof(v));
+    }
+}
+
+void decodeQuaternion(uint8_t *data, size_t count) {
+    const float kScale = 1.f / std::sqrt(2.f);
+    for (size_t i = 0; i < count; i++) {
+        int16_t v[4];
+        memcpy(v, data + i * sizeof(v), sizeof(v));
+        // 第4个分量的高位是量化精度，低2位是省略的最大分量的下标
+        int bits = v[3] | 3;
+        float scale = kScale / float(bits);
+        float x = std::min(1.f, std::max(-1.f, float(v[0]) * scale));
+        float y = std::min(1.f, std::max(-1.f, float(v[1]) * scale));
+        float z = std::min(1.f, std::max(-1.f, float(v[2]) * scale));
+        float ww = 1.f - x * x - y * y - z * z;
+        float w = std::sqrt(std::max(ww, 0.f));
+        int maxComponent = v[3] & 3;
+        int16_t out[4];
+        out[(maxComponent + 1) & 3] = int16_t(int(x * 32767.f + (x >= 0.f ? 0.5f : -0.5f)));
+        out[(maxComponent + 2) & 3] = int16_t(int(y * 32767.f + (y >= 0.f ? 0.5f : -0.5f)));
+        out[(maxComponent + 3) & 3] = int16_t(int(z * 32767.f + (z >= 0.f ? 0.5f : -0.5f)));
+        out[maxComponent] = int16_t(int(w * 32767.f + 0.5f));
+        memcpy(data + i * sizeof(out), out, sizeof(out));
+    }
+}
+
+void decodeExponential(uint8_t *data, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = readU32(data + i * sizeof(v));
+        // 低24位是有符号尾数，高8位是有符号指数
+        int32_t mantissa = int32_t(v << 8) >> 8;
+        int32_t exponent = int32_t(v) >> 24;
+        // 等价于ldexp(mantissa, exponent)，直接拼出2^exponent
+        uint32_t powerBits = uint32_t(exponent + 127) << 23;
+        float power;
+        memcpy(&power, &powerBits, sizeof(power));
+        float value = power * float(mantissa);
+        memcpy(data + i * sizeof(v), &value, sizeof(value));
+    }
+}
+
+} // namespace
+
+bool MeshoptDecoder::decodeVertexBuffer(
+        void *destination, size_t count, size_t stride, const uint8_t *data, size_t size) {
+    if (stride == 0 || stride > 256 || stride % 4 != 0) {
+        return false;
+    }
+    size_t tailSize = std::max(stride, kTailMinSize);
+    if (size < 1 + tailSize || (data[0] & 0xF0) != kVertexHeader || (data[0] & 0x0F) != 0) {
+        return false;
+    }
+    const uint8_t *end = data + size;
+    // 尾部存的是第一个顶点，作为第一块差分的基准
+    uint8_t last[256];
+    memcpy(last, end - stride, stride);
+
+    auto *out = static_cast<uint8_t *>(destination);
+    const uint8_t *cursor = data + 1;
+    size_t blockSize = vertexBlockSize(stride);
+    for (size_t offset = 0; offset < count; offset += blockSize) {
+        cursor = decodeVertexBlock(cursor, end, out + offset * stride, std::min(blockSize, count - offset), stride,
+                                   last);
+        if (!cursor) {
+            return false;
+        }
+    }
+    return size_t(end - cursor) == tailSize;
+}
+
+bool MeshoptDecoder::decodeIndexBuffer(
+        void *destination, size_t count, size_t indexSize, const uint8_t *data, size_t size) {
+    if (count % 3 != 0 || (indexSize != 2 && indexSize != 4)) {
+        return false;
+    }
+    // 每个三角形至少1字节，末尾是16字节的辅助码表
+    if (size < 1 + count / 3 + 16 || (data[0] & 0xF0) != kIndexHeader) {
+        return false;
+    }
+    int version = data[0] & 0x0F;
+    if (version > kMaxIndexVersion) {
+        return false;
+    }
+
+    uint32_t edgeFifo[16][2];
+    uint32_t vertexFifo[16];
+    memset(edgeFifo, 0xFF, sizeof(edgeFifo));
+    memset(vertexFifo, 0xFF, sizeof(vertexFifo));
+    size_t edgeOffset = 0;
+    size_t vertexOffset = 0;
+    auto pushEdge = [&](uint32_t a, uint32_t b) {
+        edgeFifo[edgeOffset][0] = a;
+        edgeFifo[edgeOffset][1] = b;
+        edgeOffset = (edgeOffset + 1) & 15;
+    };
+    auto pushVertex = [&](uint32_t v, bool condition = true) {
+        vertexFifo[vertexOffset] = v;
+        vertexOffset = (vertexOffset + condition) & 15;
+    };
+    auto writeTriangle = [&](size_t i, uint32_t a, uint32_t b, uint32_t c) {
+        writeIndex(destination, i + 0, indexSize, a);
+        writeIndex(destination, i + 1, indexSize, b);
+        writeIndex(destination, i + 2, indexSize, c);
+    };
+
+    uint32_t next = 0; // 下一个第一次出现的顶点
+    uint32_t last = 0; // 上一个单独编码的顶点，单独编码的顶点相对它做差分
+    // 第1版中13和14表示last-1和last+1
+    uint32_t fecMax = version >= 1 ? 13 : 15;
+    const uint8_t *code = data + 1;
+    const uint8_t *cursor = code + count / 3;
+    const uint8_t *safeEnd = data + size - 16;
+    const uint8_t *codeAuxTable = safeEnd;
+
+    for (size_t i = 0; i < count; i += 3) {
+        // 每个三角形最多读16字节（1字节辅助码加3个最长5字节的下标），后面的码表保证不越界
+        if (cursor > safeEnd) {
+            return false;
+        }
+        uint8_t codeTri = *code++;
+        if (codeTri < 0xF0) {
+            // 复用边FIFO中的一条边，第三个顶点来自顶点FIFO、next或单独编码
+            uint32_t fe = codeTri >> 4;
+            uint32_t a = edgeFifo[(edgeOffset - 1 - fe) & 15][0];
+            uint32_t b = edgeFifo[(edgeOffset - 1 - fe) & 15][1];
+            uint32_t fec = codeTri & 15;
+            if (fec < fecMax) {
+                uint32_t c = fec == 0 ? next : vertexFifo[(vertexOffset - 1 - fec) & 15];
+                bool isNew = fec == 0;
+                next += isNew;
+                writeTriangle(i, a, b, c);
+                pushVertex(c, isNew);
+                pushEdge(c, b);
+                pushEdge(a, c);
+            } else {
+                // fec - (fec ^ 3)把13、14变成-1、1
+                uint32_t c = fec != 15 ? last + (fec - (fec ^ 3)) : decodeIndex(cursor, last);
+                last = c;
+                writeTriangle(i, a, b, c);
+                pushVertex(c);
+                pushEdge(c, b);
+                pushEdge(a, c);
+            }
+        } else if (codeTri < 0xFE) {
+            // 三个顶点都不在边FIFO中，b和c的来源查码表，a总是next
+            uint8_t codeAux = codeAuxTable[codeTri & 15];
+            uint32_t feb = codeAux >> 4;
+            uint32_t fec = codeAux & 15;
+            uint32_t a = next++;
+            uint32_t b = feb == 0 ? next : vertexFifo[(vertexOffset - feb) & 15];
+            next += feb == 0;
+            uint32_t c = fec == 0 ? next : vertexFifo[(vertexOffset - fec) & 15];
+            next += fec == 0;
+            writeTriangle(i, a, b, c);
+            pushVertex(a);
+            pushVertex(b, feb == 0);
+            pushVertex(c, fec == 0);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        } else {
+            // 辅助码单独存一个字节，0xFF表示a也单独编码
+            uint8_t codeAux = *cursor++;
+            uint32_t fea = codeTri == 0xFE ? 0 : 15;
+            uint32_t feb = codeAux >> 4;
+            uint32_t fec = codeAux & 15;
+            // 辅助码为0但没有走码表表示重新从0开始编号
+            if (codeAux == 0) {
+                next = 0;
+            }
+            uint32_t a = fea == 0 ? next++ : 0;
+            uint32_t b = feb == 0 ? next++ : vertexFifo[(vertexOffset - feb) & 15];
+            uint32_t c = fec == 0 ? next++ : vertexFifo[(vertexOffset - fec) & 15];
+            if (fea == 15) {
+                last = a = decodeIndex(cursor, last);
+            }
+            if (feb == 15) {
+                last = b = decodeIndex(cursor, last);
+            }
+            if (fec == 15) {
+                last = c = decodeIndex(cursor, last);
+            }
+            writeTriangle(i, a, b, c);
+            pushVertex(a);
+            pushVertex(b, feb == 0 || feb == 15);
+            pushVertex(c, fec == 0 || fec == 15);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+    }
+    // 数据应当正好读到码表前
+    return cursor == safeEnd;
+}
+
+bool MeshoptDecoder::decodeIndexSequence(
+        void *destination, size_t count, size_t indexSize, const uint8_t *data, size_t size) {
+    if (indexSize != 2 && indexSize != 4) {
+        return false;
+    }
+    // 每个下标至少1字节，末尾有4字节的0
+    if (size < 1 + count + 4 || (data[0] & 0xF0) != kSequenceHeader || (data[0] & 0x0F) > kMaxIndexVersion) {
+        return false;
+    }
+    const uint8_t *cursor = data + 1;
+    const uint8_t *safeEnd = data + size - 4;
+    uint32_t last[2] = {0, 0};
+    for (size_t i = 0; i < count; i++) {
+        // 一个下标最多5字节，末尾的4字节保证不越界
+        if (cursor >= safeEnd) {
+            return false;
+        }
+        uint32_t value = decodeVByte(cursor);
+        // 最低位选择相对哪个基准做差分
+        uint32_t baseline = value & 1;
+        value >>= 1;
+        uint32_t index = last[baseline] + ((value >> 1) ^ (0u - (value & 1u)));
+        last[baseline] = index;
+        writeIndex(destination, i, indexSize, index);
+    }
+    return cursor == safeEnd;
+}
+
+bool MeshoptDecoder::applyFilter(MeshoptFilter filter, void *data, size_t count, size_t stride) {
+    auto *bytes = static_cast<uint8_t *>(data);
+    switch (filter) {
+        case MeshoptFilter::None:
+            return true;
+        case MeshoptFilter::Octahedral:
+            if (stride == 4) {
+                decodeOctahedral<int8_t>(bytes, count);
+                return true;
+            }
+            if (stride == 8) {
+                decodeOctahedral<int16_t>(bytes, count);
+                return true;
+            }
+            return false;
+        case MeshoptFilter::Quaternion:
+            if (stride != 8) {
+                return false;
+            }
+            decodeQuaternion(bytes, count);
+            return true;
+        case MeshoptFilter::Exponential:
+            if (stride % 4 != 0) {
+                return false;
+            }
+            decodeExponential(bytes, count * (stride / 4));
+            return true;
+    }
+    return false;
+}
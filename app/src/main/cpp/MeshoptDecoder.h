@@ -0,0 +1,55 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHOPTDECODER_H
+#define ANDROIDGLINVESTIGATIONS_MESHOPTDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+//! EXT_meshopt_compression的压缩模式
+enum class MeshoptMode {
+    Attributes, // 顶点属性，按字节通道做差分后变长编码
+    Triangles,  // 三角形列表的索引，按边/顶点FIFO编码
+    Indices     // 任意索引序列，按两个基准做差分编码
+};
+
+//! 解码后再施加的过滤器，只用于Attributes模式
+enum class MeshoptFilter {
+    None,
+    Octahedral,  // 八面体编码的单位向量，4个int8或int16
+    Quaternion,  // 省略最大分量的单位四元数，4个int16
+    Exponential  // 共享指数的浮点数，每个分量一个int32
+};
+
+/*!
+ * EXT_meshopt_compression的解码器，码流格式与meshoptimizer库第0版（属性）和第1版（索引）相同。
+ *
+ * 属性解码在有SSSE3或NEON时每次处理16字节，其他平台使用逐字节的标量实现，两者结果一致。
+ * 所有读取都检查边界，损坏或截断的输入返回false，不会越界访问。
+ */
+class MeshoptDecoder {
+public:
+    /*!
+     * 解码顶点属性
+     * @param destination 输出count * stride字节
+     * @param stride 元素大小，4的倍数且不超过256
+     * @return 码流无效或长度不符时返回false，此时输出内容未定义
+     */
+    static bool decodeVertexBuffer(void *destination, size_t count, size_t stride, const uint8_t *data, size_t size);
+
+    /*!
+     * 解码三角形列表的索引
+     * @param indexSize 2或4
+     * @param count 索引个数，必须是3的倍数
+     */
+    static bool decodeIndexBuffer(void *destination, size_t count, size_t indexSize, const uint8_t *data, size_t size);
+
+    //! 解码任意索引序列（INDICES模式）
+    static bool decodeIndexSequence(void *destination, size_t count, size_t indexSize, const uint8_t *data, size_t size);
+
+    /*!
+     * 在已经解码的属性上原地施加过滤器
+     * @return stride不符合过滤器的要求时返回false
+     */
+    static bool applyFilter(MeshoptFilter filter, void *data, size_t count, size_t stride);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHOPTDECODER_H
@@ -1,76 +1,293 @@
 #ifndef ANDROIDGLINVESTIGATIONS_MODEL_H
 #define ANDROIDGLINVESTIGATIONS_MODEL_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <vector>
+#include "BakedMesh.h"
+#include "Bounds.h"
+#include "MeshBuffers.h"
+#include "Meshlet.h"
+#include "MeshWelder.h"
 #include "TextureAsset.h" // 引入纹理资产的头文件
-
-// 三维向量或位置数据的表示
-union Vector3 {
-    struct {
-        float x, y, z; // 代表三维空间中的坐标或向量的分量
-    };
-    float idx[3]; // 通过索引访问相同的数据
-};
-
-// 二维向量，常用于纹理坐标
-union Vector2 {
-    struct {
-        float x, y; // 二维空间中的点或向量的通用表示
-    };
-    struct {
-        float u, v; // 纹理坐标的表示，u为纹理的水平坐标，v为垂直坐标
-    };
-    float idx[2]; // 通过索引访问相同的数据
-};
-
-struct Vector4 {
-    float r, g, b, a;
-};
-
-struct Vertex {
-    Vector3 position; // Vertex position
-    Vector2 uv;       // Texture coordinates
-    Vector4 color;    // Vertex color
-
-    // Updated constructor to include color initialization
-    Vertex(const Vector3 &inPosition, const Vector2 &inUV)
-            : position(inPosition), uv(inUV) {}
-};
-
-typedef uint16_t Index; // 定义索引类型，用于索引缓冲
+#include "TransformHierarchy.h"
+#include "VertexFormat.h"
 
 // 模型类，包含顶点、索引和纹理资产
 class Model {
 public:
-    // 模型的构造函数，接收顶点列表、索引列表、纹理资源和可选的绘制模式
+    // 模型的构造函数，接收顶点列表、索引列表、纹理资源、绘制模式和顶点布局
+    // 顶点在构造时按布局量化，之后只保留紧凑的交错数据
+    // 顶点数不超过65536时索引自动存为16位，否则存为32位
     Model(
-            std::vector<Vertex> vertices,
-            std::vector<Index> indices,
+            const std::vector<Vertex> &vertices,
+            const std::vector<Index> &indices,
             std::shared_ptr<TextureAsset> spTexture,
-            GLenum mode) // 默认绘制模式为GL_TRIANGLES
-            : vertices_(std::move(vertices)),
-              indices_(std::move(indices)),
+            GLenum mode,
+            const VertexLayout &layout = VertexLayout::compact())
+            : vertices_(VertexFormat::quantize(vertices, layout)),
+              bounds_(Aabb::fromVertices(vertices)),
+              indexType_(vertices.size() <= MeshWelder::kMaxShortIndexVertices
+                         ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT),
+              spTexture_(std::move(spTexture)),
+              mode_(mode), // 初始化绘制模式
+              transformNode_(TransformHierarchy::kInvalidNode) {
+        addLevelOfDetail(indices, 0.f);
+    }
+
+    /*!
+     * 直接从外部内存（例如映射的glTF缓冲）构造，顶点读出后立即量化，不生成中间数组
+     */
+    Model(
+            const VertexStreams &vertices,
+            const IndexStream &indices,
+            std::shared_ptr<TextureAsset> spTexture,
+            GLenum mode,
+            const VertexLayout &layout = VertexLayout::compact())
+            : vertices_(VertexFormat::quantize(vertices, layout)),
+              bounds_(Aabb::fromStreams(vertices)),
+              indexType_(vertices.count <= MeshWelder::kMaxShortIndexVertices
+                         ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT),
+              spTexture_(std::move(spTexture)),
+              mode_(mode),
+              transformNode_(TransformHierarchy::kInvalidNode) {
+        addLevelOfDetail(indices, 0.f);
+    }
+
+    /*!
+     * 引用烘焙文件中的网格，顶点和索引都留在文件映射中，不做拷贝和转换。
+     * 模型持有映射的共享所有权，@a file 可以先于模型销毁
+     */
+    Model(const BakedMeshFile &file, size_t meshIndex, std::shared_ptr<TextureAsset> spTexture)
+            : vertices_(file.getVertexFormat(meshIndex)),
+              bounds_(file.getBounds(meshIndex)),
+              indexType_(file.getMesh(meshIndex).indexType),
               spTexture_(std::move(spTexture)),
-              mode_(mode) {} // 初始化绘制模式
+              mode_(file.getMesh(meshIndex).mode),
+              transformNode_(TransformHierarchy::kInvalidNode),
+              storage_(file.getStorage()),
+              externalVertices_(file.getVertexData(meshIndex)),
+              externalIndices_(file.getIndexData(meshIndex)) {
+        const BakedLod *lods = file.getLods(meshIndex);
+        for (uint32_t i = 0; i < file.getMesh(meshIndex).lodCount; i++) {
+            lods_.push_back(LodRange{lods[i].indexOffset * getIndexSize(), lods[i].indexCount});
+            lodErrors_.push_back(lods[i].error);
+        }
+        file.getMeshlets(meshIndex, meshlets_);
+    }
+
+    /*!
+     * 追加一个更粗的细节层次，它与第0层共用顶点缓冲
+     * @param indices 该层次的索引
+     * @param error 该层次在物体空间中的误差
+     */
+    void addLevelOfDetail(const std::vector<Index> &indices, float error) {
+        IndexStream stream;
+        stream.data = reinterpret_cast<const uint8_t *>(indices.data());
+        stream.count = indices.size();
+        stream.type = GL_UNSIGNED_INT;
+        addLevelOfDetail(stream, error);
+    }
+
+    //! 从外部内存追加细节层次，索引直接转换成上传格式
+    void addLevelOfDetail(const IndexStream &indices, float error) {
+        assert(!externalIndices_ && "烘焙模型的索引在文件映射中，不能追加层次");
+        assert(!cpuDataReleased_ && "CPU上的索引已经释放，不能追加层次");
+        size_t indexSize = getIndexSize();
+        size_t offset = indexData_.size();
+        indexData_.resize(offset + indices.count * indexSize);
+        if (indexType_ == GL_UNSIGNED_INT && indices.type == GL_UNSIGNED_INT && indices.data) {
+            memcpy(indexData_.data() + offset, indices.data, indices.count * indexSize);
+        } else if (indexType_ == GL_UNSIGNED_SHORT) {
+            auto *out = reinterpret_cast<uint16_t *>(indexData_.data() + offset);
+            for (size_t i = 0; i < indices.count; i++) {
+                out[i] = static_cast<uint16_t>(indices.fetch(i));
+            }
+        } else {
+            auto *out = reinterpret_cast<uint32_t *>(indexData_.data() + offset);
+            for (size_t i = 0; i < indices.count; i++) {
+                out[i] = indices.fetch(i);
+            }
+        }
+        lods_.push_back(LodRange{offset, indices.count});
+        lodErrors_.push_back(error);
+    }
+
+    /*!
+     * 为偏好16位索引的GPU把网格切成多个模型，每个模型都能用16位索引
+     * 只支持GL_TRIANGLES、GL_LINES和GL_POINTS
+     */
+    static std::vector<Model> createShortIndexed(
+            const std::vector<Vertex> &vertices,
+            const std::vector<Index> &indices,
+            const std::shared_ptr<TextureAsset> &spTexture,
+            GLenum mode,
+            const VertexLayout &layout = VertexLayout::compact()) {
+        std::vector<Model> models;
+        for (const auto &chunk: MeshWelder::split(vertices, indices, mode)) {
+            models.emplace_back(chunk.vertices, chunk.indices, spTexture, mode, layout);
+        }
+        return models;
+    }
 
     // 获取OpenGL绘制模式的方法
     inline GLenum getMode() const {
         return mode_;
     }
 
-    // 获取顶点数据的只读访问方法
-    inline const Vertex *getVertexData() const {
-        return vertices_.data();
+    // 获取交错顶点数据的只读访问方法，格式由getVertexLayout描述。CPU数据释放后返回nullptr
+    inline const uint8_t *getVertexData() const {
+        return externalVertices_ ? externalVertices_ : vertices_.data.data();
     }
 
-    // 获取索引数量的方法
+    // 顶点数据的总字节数，CPU数据释放后不变
+    inline size_t getVertexByteSize() const {
+        return vertices_.vertexCount * vertices_.layout.stride;
+    }
+
+    inline const VertexLayout &getVertexLayout() const {
+        return vertices_.layout;
+    }
+
+    // 量化后的顶点及还原参数。烘焙模型的data为空，顶点数据用getVertexData取得
+    inline const QuantizedVertices &getQuantizedVertices() const {
+        return vertices_;
+    }
+
+    // 物体空间的包围盒，由原始顶点在构造时计算
+    inline const Aabb &getBounds() const {
+        return bounds_;
+    }
+
+    // 获取当前细节层次的索引数量
     inline const size_t getIndexCount() const {
-        return indices_.size();
+        return lods_[currentLod_].count;
+    }
+
+    // 索引类型，GL_UNSIGNED_SHORT或GL_UNSIGNED_INT
+    inline GLenum getIndexType() const {
+        return indexType_;
     }
 
-    // 获取索引数据的只读访问方法
-    inline const Index *getIndexData() const {
-        return indices_.data();
+    // 单个索引的字节数
+    inline size_t getIndexSize() const {
+        return indexType_ == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    }
+
+    // 获取当前细节层次的索引数据，元素类型由getIndexType决定。CPU数据释放后返回nullptr
+    inline const void *getIndexData() const {
+        if (cpuDataReleased_) {
+            return nullptr;
+        }
+        return (externalIndices_ ? externalIndices_ : indexData_.data()) + lods_[currentLod_].offset;
+    }
+
+    // 当前细节层次在所有层次的索引中的字节偏移，也就是在索引缓冲中的偏移
+    inline size_t getIndexByteOffset() const {
+        return lods_[currentLod_].offset;
+    }
+
+    // 所有细节层次的索引的总字节数
+    inline size_t getIndexByteSize() const {
+        size_t size = 0;
+        for (const LodRange &lod: lods_) {
+            size = std::max(size, lod.offset + lod.count * getIndexSize());
+        }
+        return size;
+    }
+
+    /*!
+     * 把顶点和所有细节层次的索引上传到GPU缓冲，之后绘制只绑定VAO，不再传客户端数组。必须在GL线程调用
+     * @param usage 之后是否会用 updateVertices 修改顶点
+     */
+    void uploadBuffers(BufferUsage usage = BufferUsage::Static) {
+        assert(!cpuDataReleased_);
+        buffers_.upload(getVertexData(), getVertexByteSize(),
+                        externalIndices_ ? externalIndices_ : indexData_.data(), getIndexByteSize(), usage);
+    }
+
+    /*!
+     * 上传后释放CPU上的顶点和索引（烘焙模型释放对文件映射的引用）。包围盒、细节层次的范围和
+     * 分簇的包围信息保留，视锥剔除和按簇剔除照常工作；之后不能再追加细节层次或调用
+     * MeshletCuller::compactIndices
+     */
+    void releaseCpuData() {
+        assert(buffers_.isUploaded() && "释放前必须先上传");
+        std::vector<uint8_t>().swap(vertices_.data);
+        std::vector<uint8_t>().swap(indexData_);
+        std::vector<Index>().swap(meshlets_.indices);
+        storage_.reset();
+        externalVertices_ = nullptr;
+        externalIndices_ = nullptr;
+        cpuDataReleased_ = true;
+    }
+
+    /*!
+     * 替换全部顶点（个数和布局不变），例如在CPU上做的变形动画。顶点重新量化，包围盒随之更新；
+     * 已上传时写入顶点缓冲，Stream用途会重新分配存储。CPU数据已释放时不再保留副本
+     */
+    void updateVertices(const std::vector<Vertex> &vertices) {
+        assert(vertices.size() == vertices_.vertexCount && !externalVertices_);
+        QuantizedVertices quantized = VertexFormat::quantize(vertices, vertices_.layout);
+        bounds_ = Aabb::fromVertices(vertices);
+        if (buffers_.isUploaded()) {
+            buffers_.updateVertices(0, quantized.data.data(), quantized.data.size());
+        }
+        if (cpuDataReleased_) {
+            std::vector<uint8_t>().swap(quantized.data);
+        }
+        vertices_ = std::move(quantized);
+    }
+
+    // GPU上的缓冲，uploadBuffers 之前为空
+    inline const MeshBuffers &getBuffers() const {
+        return buffers_;
+    }
+
+    /*!
+     * glDrawElements的索引参数：已上传时是当前层次在索引缓冲中的字节偏移，否则是客户端指针
+     */
+    inline const void *getIndexPointer() const {
+        return buffers_.isUploaded() ? reinterpret_cast<const void *>(uintptr_t(getIndexByteOffset()))
+                                     : getIndexData();
+    }
+
+    // 细节层次的数量，至少为1
+    inline size_t getLodCount() const {
+        return lods_.size();
+    }
+
+    // 每个细节层次在物体空间中的误差，第0层为0
+    inline const std::vector<float> &getLodErrors() const {
+        return lodErrors_;
+    }
+
+    inline size_t getLod() const {
+        return currentLod_;
+    }
+
+    // 选择之后绘制使用的细节层次
+    inline void setLod(size_t lod) {
+        currentLod_ = lod < lods_.size() ? lod : lods_.size() - 1;
+    }
+
+    /*!
+     * 设置第0层的分簇信息，用于按簇剔除。第0层的索引必须就是 @a meshlets 重排后的索引
+     */
+    inline void setMeshlets(MeshletMesh meshlets) {
+        assert(meshlets.indices.size() == lods_[0].count);
+        meshlets_ = std::move(meshlets);
+    }
+
+    // 第0层是否分过簇
+    inline bool hasMeshlets() const {
+        return !meshlets_.meshlets.empty();
+    }
+
+    // 烘焙模型的簇表不含indices，第0层的索引本身就是按簇排列的
+    inline const MeshletMesh &getMeshlets() const {
+        return meshlets_;
     }
 
     // 获取纹理资源的方法
@@ -78,11 +295,41 @@ public:
         return *spTexture_;
     }
 
+    // 模型在变换层级中对应的节点，kInvalidNode表示不做变换
+    inline TransformHierarchy::NodeId getTransformNode() const {
+        return transformNode_;
+    }
+
+    inline void setTransformNode(TransformHierarchy::NodeId node) {
+        transformNode_ = node;
+    }
+
 private:
-    std::vector<Vertex> vertices_; // 存储模型顶点的容器
-    std::vector<Index> indices_;   // 存储顶点索引的容器
+    // 一个细节层次在indexData_中的范围
+    struct LodRange {
+        size_t offset; // 字节偏移
+        size_t count;  // 索引个数
+    };
+
+    QuantizedVertices vertices_;   // 量化后的模型顶点
+    Aabb bounds_;                  // 物体空间的包围盒
+    GLenum indexType_;             // 索引类型
+    std::vector<uint8_t> indexData_; // 所有细节层次的索引，依次存放
+    std::vector<LodRange> lods_;   // 每个细节层次的索引范围
+    std::vector<float> lodErrors_; // 每个细节层次的误差
+    size_t currentLod_ = 0;        // 当前绘制的细节层次
+    MeshletMesh meshlets_;         // 第0层的分簇，没有分簇时为空
     std::shared_ptr<TextureAsset> spTexture_; // 模型纹理的智能指针
     GLenum mode_; // OpenGL绘制模式
+    TransformHierarchy::NodeId transformNode_; // 模型的变换节点
+
+    // 烘焙模型的顶点和索引直接指向文件映射，storage_保证映射有效；其他模型这些都为空
+    std::shared_ptr<const void> storage_;
+    const uint8_t *externalVertices_ = nullptr;
+    const uint8_t *externalIndices_ = nullptr;
+
+    MeshBuffers buffers_;           // GPU上的顶点、索引缓冲和VAO
+    bool cpuDataReleased_ = false;  // releaseCpuData 之后为true
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_MODEL_H
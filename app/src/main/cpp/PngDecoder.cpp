@@ -0,0 +1,931 @@
+#include "PngDecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Checksum.h"
+#include "Inflate.h"
+#include "Log.h"
+#include "VecMath.h"
+
+// pshufb需要SSSE3，Android的x86和x86_64 ABI都保证支持
+#if VECMATH_SSE && defined(__SSSE3__)
+#define PNG_SSSE3 1
+#include <tmmintrin.h>
+#elif VECMATH_NEON
+#define PNG_NEON 1
+#endif
+
+namespace {
+
+constexpr uint8_t kSignature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+// 与KTX2相同的尺寸上限，同时限制了解压缓冲的大小
+constexpr uint32_t kMaxDimension = 1u << 14;
+
+constexpr uint32_t chunkType(char a, char b, char c, char d) {
+    return (uint32_t(uint8_t(a)) << 24) | (uint32_t(uint8_t(b)) << 16) | (uint32_t(uint8_t(c)) << 8) | uint8_t(d);
+}
+
+constexpr uint32_t kChunkIhdr = chunkType('I', 'H', 'D', 'R');
+constexpr uint32_t kChunkPlte = chunkType('P', 'L', 'T', 'E');
+constexpr uint32_t kChunkTrns = chunkType('t', 'R', 'N', 'S');
+constexpr uint32_t kChunkIdat = chunkType('I', 'D', 'A', 'T');
+constexpr uint32_t kChunkIend = chunkType('I', 'E', 'N', 'D');
+
+inline uint32_t readBigEndian32(const uint8_t *p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+inline uint16_t readBigEndian16(const uint8_t *p) {
+    return uint16_t((p[0] << 8) | p[1]);
+}
+
+//! 隔行扫描的一遍：从(xStart, yStart)开始，每隔xStep列、yStep行取一个像素
+struct Pass {
+    uint32_t xStart;
+    uint32_t yStart;
+    uint32_t xStep;
+    uint32_t yStep;
+
+    inline uint32_t width(uint32_t imageWidth) const {
+        return imageWidth > xStart ? (imageWidth - xStart + xStep - 1) / xStep : 0;
+    }
+
+    inline uint32_t height(uint32_t imageHeight) const {
+        return imageHeight > yStart ? (imageHeight - yStart + yStep - 1) / yStep : 0;
+    }
+};
+
+constexpr Pass kAdam7[7] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4},
+                            {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}};
+constexpr Pass kProgressive = {0, 0, 1, 1};
+
+int channelCount(PngColorType colorType) {
+    switch (colorType) {
+        case PngColorType::Gray:
+        case PngColorType::Palette:
+            return 1;
+        case PngColorType::GrayAlpha:
+            return 2;
+        case PngColorType::Rgb:
+            return 3;
+        case PngColorType::Rgba:
+            return 4;
+    }
+    return 0;
+}
+
+bool isValidDepth(PngColorType colorType, uint8_t depth) {
+    switch (colorType) {
+        case PngColorType::Gray:
+            return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+        case PngColorType::Palette:
+            return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+        case PngColorType::Rgb:
+        case PngColorType::GrayAlpha:
+        case PngColorType::Rgba:
+            return depth == 8 || depth == 16;
+    }
+    return false;
+}
+
+//! 解析后的块，像素数据仍指向文件
+struct PngChunks {
+    PngInfo info;
+    int channels = 0;
+    uint8_t palette[256 * 4]; // RGBA，PLTE之外的索引为不透明黑色
+    bool hasPalette = false;
+    bool hasKey = false;      // 灰度或RGB图像的tRNS：等于key的像素完全透明
+    uint16_t key[3] = {};
+    const uint8_t *firstIdat = nullptr; // 第一个IDAT块的长度字段
+    size_t idatChunks = 0;
+    size_t idatBytes = 0;
+
+    //! 一行过滤数据的字节数（不含过滤类型字节）
+    inline size_t rowBytes(uint32_t width) const {
+        return (size_t(width) * size_t(channels) * info.bitDepth + 7) / 8;
+    }
+};
+
+bool parseHeader(const uint8_t *data, size_t size, PngInfo &info) {
+    // 签名、IHDR的长度和类型、13字节的内容和CRC
+    if (size < 8 + 8 + 13 + 4 || !PngDecoder::isPng(data, size)) {
+        LOGE("不是PNG图像");
+        return false;
+    }
+    const uint8_t *chunk = data + 8;
+    if (readBigEndian32(chunk) != 13 || readBigEndian32(chunk + 4) != kChunkIhdr) {
+        LOGE("PNG的第一个块不是IHDR");
+        return false;
+    }
+    const uint8_t *body = chunk + 8;
+    uint32_t width = readBigEndian32(body);
+    uint32_t height = readBigEndian32(body + 4);
+    info.bitDepth = body[8];
+    info.colorType = PngColorType(body[9]);
+    uint8_t compression = body[10];
+    uint8_t filter = body[11];
+    uint8_t interlace = body[12];
+    if (width == 0 || height == 0 || width > kMaxDimension || height > kMaxDimension) {
+        LOGE("PNG尺寸无效: %ux%u", width, height);
+        return false;
+    }
+    if (channelCount(info.colorType) == 0 || !isValidDepth(info.colorType, info.bitDepth) || compression != 0
+        || filter != 0 || interlace > 1) {
+        LOGE("不支持的PNG格式: 颜色类型 %u 位深 %u 压缩 %u 过滤 %u 隔行 %u", body[9], info.bitDepth, compression,
+             filter, interlace);
+        return false;
+    }
+    info.width = int32_t(width);
+    info.height = int32_t(height);
+    info.interlaced = interlace == 1;
+    info.hasAlpha = info.colorType == PngColorType::GrayAlpha || info.colorType == PngColorType::Rgba;
+    return true;
+}
+
+bool parseChunks(const uint8_t *data, size_t size, PngChunks &png) {
+    if (!parseHeader(data, size, png.info)) {
+        return false;
+    }
+    png.channels = channelCount(png.info.colorType);
+    for (int i = 0; i < 256; i++) {
+        const uint8_t opaqueBlack[4] = {0, 0, 0, 255};
+        memcpy(png.palette + i * 4, opaqueBlack, 4);
+    }
+    bool previousWasIdat = false;
+    size_t offset = 8;
+    while (offset + 12 <= size) {
+        const uint8_t *chunk = data + offset;
+        uint32_t length = readBigEndian32(chunk);
+        uint32_t type = readBigEndian32(chunk + 4);
+        if (length > size - offset - 12) {
+            LOGE("PNG块超出文件末尾");
+            return false;
+        }
+        const uint8_t *body = chunk + 8;
+        bool used = type == kChunkIhdr || type == kChunkPlte || type == kChunkTrns || type == kChunkIdat
+                    || type == kChunkIend;
+        // 不用的辅助块（gAMA、iCCP、文本等）不校验，与AImageDecoder一样忽略色彩空间信息
+        if (used && Checksum::crc32(chunk + 4, length + 4) != readBigEndian32(body + length)) {
+            LOGE("PNG块 %.4s 的CRC错误", reinterpret_cast<const char *>(chunk + 4));
+            return false;
+        }
+        offset += 12 + size_t(length);
+        if (type == kChunkIend) {
+            break;
+        }
+        if (png.idatChunks > 0 && (type == kChunkPlte || type == kChunkTrns)) {
+            LOGE("PNG的 %.4s 块在IDAT之后", reinterpret_cast<const char *>(chunk + 4));
+            return false;
+        }
+        if (type == kChunkIhdr) {
+            if (chunk != data + 8) {
+                LOGE("PNG有多个IHDR块");
+                return false;
+            }
+        } else if (type == kChunkPlte) {
+            if (length == 0 || length % 3 != 0 || length / 3 > 256) {
+                LOGE("PNG调色板长度无效: %u", length);
+                return false;
+            }
+            for (uint32_t i = 0; i < length / 3; i++) {
+                memcpy(png.palette + i * 4, body + i * 3, 3);
+            }
+            png.hasPalette = true;
+        } else if (type == kChunkTrns) {
+            // 与libpng一样，长度不符或用于有alpha通道的图像的tRNS被忽略
+            PngColorType colorType = png.info.colorType;
+            if (colorType == PngColorType::Palette && length <= 256) {
+                for (uint32_t i = 0; i < length; i++) {
+                    png.palette[i * 4 + 3] = body[i];
+                }
+                png.info.hasAlpha = length > 0;
+            } else if (colorType == PngColorType::Gray && length == 2) {
+                png.key[0] = readBigEndian16(body);
+                png.hasKey = png.info.hasAlpha = true;
+            } else if (colorType == PngColorType::Rgb && length == 6) {
+                for (int c = 0; c < 3; c++) {
+                    png.key[c] = readBigEndian16(body + c * 2);
+                }
+                png.hasKey = png.info.hasAlpha = true;
+            }
+        } else if (type == kChunkIdat) {
+            if (png.idatChunks > 0 && !previousWasIdat) {
+                LOGE("PNG的IDAT块不连续");
+                return false;
+            }
+            if (png.idatChunks == 0) {
+                png.firstIdat = chunk;
+            }
+            png.idatChunks++;
+            png.idatBytes += length;
+        } else if ((chunk[4] & 0x20) == 0) {
+            // 类型首字母大写的是解码必需的关键块
+            LOGE("不支持的PNG关键块 %.4s", reinterpret_cast<const char *>(chunk + 4));
+            return false;
+        }
+        previousWasIdat = type == kChunkIdat;
+    }
+    if (png.idatChunks == 0) {
+        LOGE("PNG没有图像数据");
+        return false;
+    }
+    if (png.info.colorType == PngColorType::Palette && !png.hasPalette) {
+        LOGE("调色板PNG没有PLTE块");
+        return false;
+    }
+    return true;
+}
+
+inline uint8_t paethPredictor(int a, int b, int c) {
+    int pa = std::abs(b - c);
+    int pb = std::abs(a - c);
+    int pc = std::abs(a + b - 2 * c);
+    if (pa <= pb && pa <= pc) {
+        return uint8_t(a);
+    }
+    return uint8_t(pb <= pc ? b : c);
+}
+
+//! c * a / 255 四舍五入，对所有8位输入精确
+inline uint8_t multiplyAlpha(uint32_t c, uint32_t a) {
+    uint32_t t = c * a + 128;
+    return uint8_t((t + (t >> 8)) >> 8);
+}
+
+struct ScalarOps {
+    static void sub(uint8_t *row, size_t rowBytes, size_t bpp) {
+        for (size_t i = bpp; i < rowBytes; i++) {
+            row[i] = uint8_t(row[i] + row[i - bpp]);
+        }
+    }
+
+    static void up(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        for (size_t i = 0; i < rowBytes; i++) {
+            row[i] = uint8_t(row[i] + prior[i]);
+        }
+    }
+
+    static void average(uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+        for (size_t i = 0; i < bpp; i++) {
+            row[i] = uint8_t(row[i] + (prior[i] >> 1));
+        }
+        for (size_t i = bpp; i < rowBytes; i++) {
+            row[i] = uint8_t(row[i] + ((row[i - bpp] + prior[i]) >> 1));
+        }
+    }
+
+    static void paeth(uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+        for (size_t i = 0; i < bpp; i++) {
+            row[i] = uint8_t(row[i] + prior[i]);
+        }
+        for (size_t i = bpp; i < rowBytes; i++) {
+            row[i] = uint8_t(row[i] + paethPredictor(row[i - bpp], prior[i], prior[i - bpp]));
+        }
+    }
+
+    static void expandRgb(const uint8_t *src, uint8_t *dst, size_t count) {
+        for (size_t i = 0; i < count; i++, src += 3, dst += 4) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = 255;
+        }
+    }
+
+    static void expandGray(const uint8_t *src, uint8_t *dst, size_t count) {
+        for (size_t i = 0; i < count; i++, dst += 4) {
+            dst[0] = dst[1] = dst[2] = src[i];
+            dst[3] = 255;
+        }
+    }
+
+    static void premultiply(uint8_t *rgba, size_t count) {
+        for (size_t i = 0; i < count; i++, rgba += 4) {
+            for (int c = 0; c < 3; c++) {
+                rgba[c] = multiplyAlpha(rgba[c], rgba[3]);
+            }
+        }
+    }
+};
+
+#if PNG_SSSE3
+
+/*!
+ * 读一个像素。3字节的像素在行内还有第4个字节时直接读4字节（多出的字节不用），
+ * 按3字节拼起来会经过栈上的临时变量，每个像素都有一次存储转发失败
+ */
+template<size_t Bpp>
+inline __m128i loadPixel(const uint8_t *p, const uint8_t *end) {
+    uint32_t v = 0;
+    if (Bpp == 4 || p + 4 <= end) {
+        memcpy(&v, p, 4);
+    } else {
+        memcpy(&v, p, Bpp);
+    }
+    return _mm_cvtsi32_si128(int32_t(v));
+}
+
+template<size_t Bpp>
+inline void storePixel(uint8_t *p, __m128i v) {
+    auto x = uint32_t(_mm_cvtsi128_si32(v));
+    memcpy(p, &x, Bpp);
+}
+
+inline __m128i blend(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+struct SimdOps : ScalarOps {
+    static void sub(uint8_t *row, size_t rowBytes, size_t bpp) {
+        if (bpp == 4) {
+            sub4(row, rowBytes);
+        } else if (bpp == 3) {
+            sub3(row, rowBytes);
+        } else {
+            ScalarOps::sub(row, rowBytes, bpp);
+        }
+    }
+
+    static void up(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        size_t i = 0;
+        for (; i + 16 <= rowBytes; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(prior + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i), _mm_add_epi8(x, b));
+        }
+        ScalarOps::up(row + i, prior + i, rowBytes - i);
+    }
+
+    static void average(uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+        if (bpp == 4) {
+            averagePixels<4>(row, prior, rowBytes);
+        } else if (bpp == 3) {
+            averagePixels<3>(row, prior, rowBytes);
+        } else {
+            ScalarOps::average(row, prior, rowBytes, bpp);
+        }
+    }
+
+    static void paeth(uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+        if (bpp == 4) {
+            paethPixels<4>(row, prior, rowBytes);
+        } else if (bpp == 3) {
+            paethPixels<3>(row, prior, rowBytes);
+        } else {
+            ScalarOps::paeth(row, prior, rowBytes, bpp);
+        }
+    }
+
+    static void expandRgb(const uint8_t *src, uint8_t *dst, size_t count) {
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(int32_t(0xFF000000u));
+        size_t i = 0;
+        // 每次读16字节只用前12字节，要求后面还有至少6个像素
+        for (; i + 6 <= count; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+            x = _mm_or_si128(_mm_shuffle_epi8(x, shuffle), alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), x);
+        }
+        ScalarOps::expandRgb(src + i * 3, dst + i * 4, count - i);
+    }
+
+    static void expandGray(const uint8_t *src, uint8_t *dst, size_t count) {
+        const __m128i alpha = _mm_set1_epi32(int32_t(0xFF000000u));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i low = _mm_unpacklo_epi8(g, g);
+            __m128i high = _mm_unpackhi_epi8(g, g);
+            auto *out = reinterpret_cast<__m128i *>(dst + i * 4);
+            _mm_storeu_si128(out, _mm_or_si128(_mm_unpacklo_epi16(low, low), alpha));
+            _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(low, low), alpha));
+            _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(high, high), alpha));
+            _mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(high, high), alpha));
+        }
+        ScalarOps::expandGray(src + i, dst + i * 4, count - i);
+    }
+
+    static void premultiply(uint8_t *rgba, size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        // alpha通道乘255，按同一公式得到的还是原值
+        const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+        const __m128i alpha255 = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto *p = reinterpret_cast<__m128i *>(rgba + i * 4);
+            __m128i x = _mm_loadu_si128(p);
+            __m128i halves[2] = {_mm_unpacklo_epi8(x, zero), _mm_unpackhi_epi8(x, zero)};
+            for (__m128i &h: halves) {
+                __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(h, 0xFF), 0xFF);
+                a = _mm_or_si128(_mm_and_si128(a, colorMask), alpha255);
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(h, a), round);
+                h = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            }
+            _mm_storeu_si128(p, _mm_packus_epi16(halves[0], halves[1]));
+        }
+        ScalarOps::premultiply(rgba + i * 4, count - i);
+    }
+
+private:
+    // Sub是前缀和：一次读4个像素，按像素宽度错位相加两次，再加上前一组的最后一个像素
+    static void sub4(uint8_t *row, size_t rowBytes) {
+        __m128i last = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= rowBytes; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi8(x, last);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i), x);
+            last = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        for (i = std::max<size_t>(i, 4); i < rowBytes; i++) {
+            row[i] = uint8_t(row[i] + row[i - 4]);
+        }
+    }
+
+    //! RGB每次处理4个像素（12字节），只写回这12字节，后面的原始数据还没有反过滤
+    static void sub3(uint8_t *row, size_t rowBytes) {
+        const __m128i spread = _mm_setr_epi8(9, 10, 11, 9, 10, 11, 9, 10, 11, 9, 10, 11, 9, 10, 11, 9);
+        __m128i last = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= rowBytes; i += 12) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 3));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 6));
+            x = _mm_add_epi8(x, last);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(row + i), x);
+            auto tail = uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(x, 8)));
+            memcpy(row + i + 8, &tail, 4);
+            last = _mm_shuffle_epi8(x, spread);
+        }
+        for (i = std::max<size_t>(i, 3); i < rowBytes; i++) {
+            row[i] = uint8_t(row[i] + row[i - 3]);
+        }
+    }
+
+    template<size_t Bpp>
+    static void averagePixels(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i a = _mm_setzero_si128();
+        for (size_t i = 0; i < rowBytes; i += Bpp) {
+            __m128i b = loadPixel<Bpp>(prior + i, prior + rowBytes);
+            // pavgb向上取整，减去两数之和的最低位得到向下取整的平均
+            __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(loadPixel<Bpp>(row + i, row + rowBytes), average);
+            storePixel<Bpp>(row + i, a);
+        }
+    }
+
+    template<size_t Bpp>
+    static void paethPixels(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i a = zero;
+        __m128i c = zero;
+        for (size_t i = 0; i < rowBytes; i += Bpp) {
+            __m128i b = _mm_unpacklo_epi8(loadPixel<Bpp>(prior + i, prior + rowBytes), zero);
+            __m128i pa = _mm_sub_epi16(b, c);
+            __m128i pb = _mm_sub_epi16(a, c);
+            __m128i pc = _mm_abs_epi16(_mm_add_epi16(pa, pb));
+            pa = _mm_abs_epi16(pa);
+            pb = _mm_abs_epi16(pb);
+            __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+            __m128i predictor = blend(_mm_cmpeq_epi16(smallest, pa), a,
+                                       blend(_mm_cmpeq_epi16(smallest, pb), b, c));
+            __m128i x = _mm_add_epi8(loadPixel<Bpp>(row + i, row + rowBytes), _mm_packus_epi16(predictor, predictor));
+            storePixel<Bpp>(row + i, x);
+            a = _mm_unpacklo_epi8(x, zero);
+            c = b;
+        }
+    }
+};
+
+#elif PNG_NEON
+
+//! 读一个像素，3字节的像素在行内还有第4个字节时直接读4字节，原因同SSE版本
+template<size_t Bpp>
+inline uint8x8_t loadPixel(const uint8_t *p, const uint8_t *end) {
+    uint32_t v = 0;
+    if (Bpp == 4 || p + 4 <= end) {
+        memcpy(&v, p, 4);
+    } else {
+        memcpy(&v, p, Bpp);
+    }
+    return vreinterpret_u8_u32(vdup_n_u32(v));
+}
+
+template<size_t Bpp>
+inline void storePixel(uint8_t *p, uint8x8_t v) {
+    uint32_t x = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+    memcpy(p, &x, Bpp);
+}
+
+inline uint8x8_t paethPredictor(uint8x8_t a, uint8x8_t b, uint8x8_t c) {
+    uint16x8_t pa = vabdl_u8(b, c);
+    uint16x8_t pb = vabdl_u8(a, c);
+    uint16x8_t pc = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+    uint8x8_t useA = vmovn_u16(vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+    uint8x8_t useB = vmovn_u16(vcleq_u16(pb, pc));
+    return vbsl_u8(useA, a, vbsl_u8(useB, b, c));
+}
+
+struct SimdOps : ScalarOps {
+    static void sub(uint8_t *row, size_t rowBytes, size_t bpp) {
+        if (bpp == 4) {
+            subPixels<4>(row, rowBytes);
+        } else if (bpp == 3) {
+            subPixels<3>(row, rowBytes);
+        } else {
+            ScalarOps::sub(row, rowBytes, bpp);
+        }
+    }
+
+    static void up(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        size_t i = 0;
+        for (; i + 16 <= rowBytes; i += 16) {
+            vst1q_u8(row + i, vaddq_u8(vld1q_u8(row + i), vld1q_u8(prior + i)));
+        }
+        ScalarOps::up(row + i, prior + i, rowBytes - i);
+    }
+
+    static void average(uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+        if (bpp == 4) {
+            averagePixels<4>(row, prior, rowBytes);
+        } else if (bpp == 3) {
+            averagePixels<3>(row, prior, rowBytes);
+        } else {
+            ScalarOps::average(row, prior, rowBytes, bpp);
+        }
+    }
+
+    static void paeth(uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+        if (bpp == 4) {
+            paethPixels<4>(row, prior, rowBytes);
+        } else if (bpp == 3) {
+            paethPixels<3>(row, prior, rowBytes);
+        } else {
+            ScalarOps::paeth(row, prior, rowBytes, bpp);
+        }
+    }
+
+    static void expandRgb(const uint8_t *src, uint8_t *dst, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint8x8x3_t rgb = vld3_u8(src + i * 3);
+            uint8x8x4_t rgba = {{rgb.val[0], rgb.val[1], rgb.val[2], vdup_n_u8(255)}};
+            vst4_u8(dst + i * 4, rgba);
+        }
+        ScalarOps::expandRgb(src + i * 3, dst + i * 4, count - i);
+    }
+
+    static void expandGray(const uint8_t *src, uint8_t *dst, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint8x8_t g = vld1_u8(src + i);
+            uint8x8x4_t rgba = {{g, g, g, vdup_n_u8(255)}};
+            vst4_u8(dst + i * 4, rgba);
+        }
+        ScalarOps::expandGray(src + i, dst + i * 4, count - i);
+    }
+
+    static void premultiply(uint8_t *rgba, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint8x8x4_t p = vld4_u8(rgba + i * 4);
+            for (int c = 0; c < 3; c++) {
+                // (t + ((t + 128) >> 8) + 128) >> 8，与标量公式相同
+                uint16x8_t t = vmull_u8(p.val[c], p.val[3]);
+                p.val[c] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+            }
+            vst4_u8(rgba + i * 4, p);
+        }
+        ScalarOps::premultiply(rgba + i * 4, count - i);
+    }
+
+private:
+    template<size_t Bpp>
+    static void subPixels(uint8_t *row, size_t rowBytes) {
+        uint8x8_t a = vdup_n_u8(0);
+        for (size_t i = 0; i < rowBytes; i += Bpp) {
+            a = vadd_u8(loadPixel<Bpp>(row + i, row + rowBytes), a);
+            storePixel<Bpp>(row + i, a);
+        }
+    }
+
+    template<size_t Bpp>
+    static void averagePixels(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        uint8x8_t a = vdup_n_u8(0);
+        for (size_t i = 0; i < rowBytes; i += Bpp) {
+            a = vadd_u8(loadPixel<Bpp>(row + i, row + rowBytes), vhadd_u8(a, loadPixel<Bpp>(prior + i, prior + rowBytes)));
+            storePixel<Bpp>(row + i, a);
+        }
+    }
+
+    template<size_t Bpp>
+    static void paethPixels(uint8_t *row, const uint8_t *prior, size_t rowBytes) {
+        uint8x8_t a = vdup_n_u8(0);
+        uint8x8_t c = a;
+        for (size_t i = 0; i < rowBytes; i += Bpp) {
+            uint8x8_t b = loadPixel<Bpp>(prior + i, prior + rowBytes);
+            a = vadd_u8(loadPixel<Bpp>(row + i, row + rowBytes), paethPredictor(a, b, c));
+            storePixel<Bpp>(row + i, a);
+            c = b;
+        }
+    }
+};
+
+#else
+
+using SimdOps = ScalarOps;
+
+#endif
+
+template<typename Ops>
+bool unfilterRow(uint8_t filter, uint8_t *row, const uint8_t *prior, size_t rowBytes, size_t bpp) {
+    switch (filter) {
+        case 0:
+            return true;
+        case 1:
+            Ops::sub(row, rowBytes, bpp);
+            return true;
+        case 2:
+            Ops::up(row, prior, rowBytes);
+            return true;
+        case 3:
+            Ops::average(row, prior, rowBytes, bpp);
+            return true;
+        case 4:
+            Ops::paeth(row, prior, rowBytes, bpp);
+            return true;
+        default:
+            return false;
+    }
+}
+
+//! 第index个样本的原始值
+inline uint32_t sampleAt(const uint8_t *row, size_t index, uint32_t depth) {
+    switch (depth) {
+        case 8:
+            return row[index];
+        case 16:
+            return readBigEndian16(row + index * 2);
+        default: {
+            size_t bit = index * depth;
+            uint32_t shift = 8 - depth - uint32_t(bit & 7);
+            return (row[bit >> 3] >> shift) & ((1u << depth) - 1);
+        }
+    }
+}
+
+//! 把样本缩放到8位：16位四舍五入（v / 257），低位深按比例扩展到0~255
+inline uint8_t toByte(uint32_t value, uint32_t depth) {
+    switch (depth) {
+        case 16:
+            return uint8_t((value * 255 + 32895) >> 16);
+        case 8:
+            return uint8_t(value);
+        default:
+            return uint8_t(value * (255 / ((1u << depth) - 1)));
+    }
+}
+
+/*!
+ * 逐行输出：把反过滤后的一行展开成RGBA8，再按选项做sRGB转换和预乘
+ */
+template<typename Ops>
+class RowWriter {
+public:
+    RowWriter(const PngChunks &png, const PngDecodeOptions &options)
+            : png_(png), premultiply_(options.premultiply && png.info.hasAlpha),
+              toLinear_(options.srgbToLinear ? linearTable().data() : nullptr) {}
+
+    void write(const uint8_t *src, uint8_t *dst, size_t width) const {
+        expand(src, dst, width);
+        if (toLinear_) {
+            for (size_t i = 0; i < width; i++) {
+                uint8_t *p = dst + i * 4;
+                p[0] = toLinear_[p[0]];
+                p[1] = toLinear_[p[1]];
+                p[2] = toLinear_[p[2]];
+            }
+        }
+        if (premultiply_) {
+            Ops::premultiply(dst, width);
+        }
+    }
+
+private:
+    static const std::array<uint8_t, 256> &linearTable() {
+        static const std::array<uint8_t, 256> table = [] {
+            std::array<uint8_t, 256> t{};
+            for (int i = 0; i < 256; i++) {
+                double c = i / 255.0;
+                double linear = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+                t[i] = uint8_t(std::lround(linear * 255.0));
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    void expand(const uint8_t *src, uint8_t *dst, size_t width) const {
+        const uint32_t depth = png_.info.bitDepth;
+        const PngColorType colorType = png_.info.colorType;
+        // 常见的8位格式走专门的路径，其余（低位深、16位、tRNS色键）逐样本处理
+        if (depth == 8 && !png_.hasKey) {
+            switch (colorType) {
+                case PngColorType::Rgba:
+                    memcpy(dst, src, width * 4);
+                    return;
+                case PngColorType::Rgb:
+                    Ops::expandRgb(src, dst, width);
+                    return;
+                case PngColorType::Gray:
+                    Ops::expandGray(src, dst, width);
+                    return;
+                case PngColorType::Palette:
+                    for (size_t x = 0; x < width; x++) {
+                        memcpy(dst + x * 4, png_.palette + size_t(src[x]) * 4, 4);
+                    }
+                    return;
+                case PngColorType::GrayAlpha:
+                    for (size_t x = 0; x < width; x++, dst += 4) {
+                        dst[0] = dst[1] = dst[2] = src[x * 2];
+                        dst[3] = src[x * 2 + 1];
+                    }
+                    return;
+            }
+        }
+        for (size_t x = 0; x < width; x++, dst += 4) {
+            switch (colorType) {
+                case PngColorType::Palette:
+                    memcpy(dst, png_.palette + size_t(sampleAt(src, x, depth)) * 4, 4);
+                    break;
+                case PngColorType::Gray: {
+                    uint32_t gray = sampleAt(src, x, depth);
+                    dst[0] = dst[1] = dst[2] = toByte(gray, depth);
+                    dst[3] = png_.hasKey && gray == png_.key[0] ? 0 : 255;
+                    break;
+                }
+                case PngColorType::GrayAlpha:
+                    dst[0] = dst[1] = dst[2] = toByte(sampleAt(src, x * 2, depth), depth);
+                    dst[3] = toByte(sampleAt(src, x * 2 + 1, depth), depth);
+                    break;
+                case PngColorType::Rgb: {
+                    bool matches = png_.hasKey;
+                    for (size_t c = 0; c < 3; c++) {
+                        uint32_t value = sampleAt(src, x * 3 + c, depth);
+                        matches = matches && value == png_.key[c];
+                        dst[c] = toByte(value, depth);
+                    }
+                    dst[3] = matches ? 0 : 255;
+                    break;
+                }
+                case PngColorType::Rgba:
+                    for (size_t c = 0; c < 4; c++) {
+                        dst[c] = toByte(sampleAt(src, x * 4 + c, depth), depth);
+                    }
+                    break;
+            }
+        }
+    }
+
+    const PngChunks &png_;
+    bool premultiply_;
+    const uint8_t *toLinear_;
+};
+
+template<typename Ops>
+bool decodeImage(const uint8_t *data, size_t size, uint8_t *rgba, size_t stride, StagingBufferPool &pool,
+                 const PngDecodeOptions &options) {
+    PngChunks png;
+    if (!parseChunks(data, size, png)) {
+        return false;
+    }
+    const PngInfo &info = png.info;
+    if (stride < size_t(info.width) * 4) {
+        LOGE("输出行距 %zu 小于PNG的宽度 %d", stride, info.width);
+        return false;
+    }
+    const auto width = uint32_t(info.width);
+    const auto height = uint32_t(info.height);
+    const Pass *passes = info.interlaced ? kAdam7 : &kProgressive;
+    const size_t passCount = info.interlaced ? 7 : 1;
+    // 反过滤按字节进行，低位深时左边的“像素”按1字节算
+    const size_t bpp = std::max<size_t>(1, size_t(png.channels) * info.bitDepth / 8);
+    size_t filteredSize = 0;
+    size_t maxRowBytes = 0;
+    for (size_t p = 0; p < passCount; p++) {
+        uint32_t passWidth = passes[p].width(width);
+        uint32_t passHeight = passes[p].height(height);
+        if (passWidth > 0 && passHeight > 0) {
+            filteredSize += size_t(passHeight) * (png.rowBytes(passWidth) + 1);
+            maxRowBytes = std::max(maxRowBytes, png.rowBytes(passWidth));
+        }
+    }
+
+    // 多个IDAT块拼接成连续的zlib流，只有一个块时直接使用文件中的数据
+    std::vector<uint8_t> joined;
+    const uint8_t *stream = png.firstIdat + 8;
+    if (png.idatChunks > 1) {
+        joined = pool.acquire(png.idatBytes);
+        const uint8_t *chunk = png.firstIdat;
+        uint8_t *out = joined.data();
+        for (size_t i = 0; i < png.idatChunks; i++) {
+            uint32_t length = readBigEndian32(chunk);
+            memcpy(out, chunk + 8, length);
+            out += length;
+            chunk += 12 + size_t(length);
+        }
+        stream = joined.data();
+    }
+    std::vector<uint8_t> filtered = pool.acquire(filteredSize);
+    bool ok = Inflate::zlib(stream, png.idatBytes, filtered.data(), filteredSize);
+    pool.release(std::move(joined));
+    if (!ok) {
+        LOGE("PNG图像数据解压失败");
+        pool.release(std::move(filtered));
+        return false;
+    }
+
+    // 每一遍第一行的上一行视为全0；隔行时另需一行RGBA再分散到输出
+    std::vector<uint8_t> scratch = pool.acquire(maxRowBytes + (info.interlaced ? size_t(width) * 4 : 0));
+    memset(scratch.data(), 0, maxRowBytes);
+    uint8_t *passRow = scratch.data() + maxRowBytes;
+    const RowWriter<Ops> writer(png, options);
+    uint8_t *cursor = filtered.data();
+    for (size_t p = 0; p < passCount && ok; p++) {
+        const Pass &pass = passes[p];
+        uint32_t passWidth = pass.width(width);
+        uint32_t passHeight = pass.height(height);
+        if (passWidth == 0 || passHeight == 0) {
+            continue;
+        }
+        size_t rowBytes = png.rowBytes(passWidth);
+        const uint8_t *prior = scratch.data();
+        for (uint32_t y = 0; y < passHeight; y++) {
+            uint8_t filter = cursor[0];
+            uint8_t *row = cursor + 1;
+            if (!unfilterRow<Ops>(filter, row, prior, rowBytes, bpp)) {
+                LOGE("PNG行过滤类型 %u 无效", filter);
+                ok = false;
+                break;
+            }
+            uint8_t *out = rgba + size_t(pass.yStart + y * pass.yStep) * stride;
+            if (!info.interlaced) {
+                writer.write(row, out, passWidth);
+            } else {
+                writer.write(row, passRow, passWidth);
+                for (uint32_t x = 0; x < passWidth; x++) {
+                    memcpy(out + size_t(pass.xStart + x * pass.xStep) * 4, passRow + size_t(x) * 4, 4);
+                }
+            }
+            prior = row;
+            cursor = row + rowBytes;
+        }
+    }
+    pool.release(std::move(scratch));
+    pool.release(std::move(filtered));
+    return ok;
+}
+
+} // namespace
+
+bool PngDecoder::isPng(const uint8_t *data, size_t size) {
+    return size >= sizeof(kSignature) && memcmp(data, kSignature, sizeof(kSignature)) == 0;
+}
+
+bool PngDecoder::readInfo(const uint8_t *data, size_t size, PngInfo &info) {
+    if (!parseHeader(data, size, info)) {
+        return false;
+    }
+    // tRNS在IDAT之前，只看块头，不校验CRC
+    size_t offset = 8;
+    while (!info.hasAlpha && offset + 12 <= size) {
+        uint32_t length = readBigEndian32(data + offset);
+        uint32_t type = readBigEndian32(data + offset + 4);
+        if (type == kChunkIdat || type == kChunkIend || length > size - offset - 12) {
+            break;
+        }
+        info.hasAlpha = type == kChunkTrns && length > 0 && info.colorType != PngColorType::Rgba
+                        && info.colorType != PngColorType::GrayAlpha;
+        offset += 12 + size_t(length);
+    }
+    return true;
+}
+
+bool PngDecoder::decode(const uint8_t *data, size_t size, uint8_t *rgba, size_t stride, StagingBufferPool &pool,
+                        const PngDecodeOptions &options) {
+    return decodeImage<SimdOps>(data, size, rgba, stride, pool, options);
+}
+
+bool PngDecoder::decodeScalar(const uint8_t *data, size_t size, uint8_t *rgba, size_t stride,
+                              StagingBufferPool &pool, const PngDecodeOptions &options) {
+    return decodeImage<ScalarOps>(data, size, rgba, stride, pool, options);
+}
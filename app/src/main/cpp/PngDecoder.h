@@ -0,0 +1,68 @@
+#ifndef ANDROIDGLINVESTIGATIONS_PNGDECODER_H
+#define ANDROIDGLINVESTIGATIONS_PNGDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "StagingBufferPool.h"
+
+enum class PngColorType : uint8_t {
+    Gray = 0,
+    Rgb = 2,
+    Palette = 3,
+    GrayAlpha = 4,
+    Rgba = 6,
+};
+
+//! IHDR中的图像信息
+struct PngInfo {
+    int32_t width = 0;
+    int32_t height = 0;
+    uint8_t bitDepth = 0;
+    PngColorType colorType = PngColorType::Rgba;
+    bool interlaced = false; // Adam7隔行
+    bool hasAlpha = false;   // 有alpha通道或tRNS块
+};
+
+struct PngDecodeOptions {
+    bool premultiply = false;   // 颜色在编码空间乘alpha，与 AlphaMode::Premultiplied 和AImageDecoder的默认输出相同
+    bool srgbToLinear = false;  // 把sRGB编码的颜色换算成线性值（仍是8位，暗部会损失精度），alpha不变，先于预乘
+};
+
+/*!
+ * 不依赖AImageDecoder的PNG解码器，在设备和主机上结果相同，可以在主机上测试和做性能分析。
+ *
+ * 支持所有标准的颜色类型和位深（含调色板、tRNS、16位）以及Adam7隔行，输出统一为RGBA8：
+ * 16位按四舍五入缩到8位，低位深灰度按比例扩展，与libpng的expand + scale_16一致。
+ * 过滤数据由 Inflate 一次解压到池中的缓冲，再逐行就地反过滤：Up每次处理16字节，
+ * 8位RGB/RGBA的Sub用前缀和每次处理4个像素，Avg和Paeth逐像素但整个像素放在一个SSE/NEON寄存器中。
+ * 展开到RGBA、sRGB转换和预乘在同一次逐行输出中完成，行数据还在缓存里。
+ * 块的CRC都会校验，不认识的关键块和损坏的数据返回false
+ */
+class PngDecoder {
+public:
+    //! @return 数据是否以PNG签名开头
+    static bool isPng(const uint8_t *data, size_t size);
+
+    /*!
+     * 读取IHDR，并查看IDAT之前有没有tRNS块，不解压图像数据
+     * @return 不是PNG、IHDR无效或尺寸超过16384时返回false
+     */
+    static bool readInfo(const uint8_t *data, size_t size, PngInfo &info);
+
+    /*!
+     * 解码成RGBA8
+     * @param rgba 输出，至少 stride * height 字节，可以是池中取出的缓冲
+     * @param stride 输出的行距，不小于 width * 4
+     * @param pool 解压和拼接IDAT用的临时缓冲从这里取出，用完归还
+     * @return 失败时输出内容未定义
+     */
+    static bool decode(const uint8_t *data, size_t size, uint8_t *rgba, size_t stride, StagingBufferPool &pool,
+                       const PngDecodeOptions &options = {});
+
+    //! 与 decode 逐字节一致的标量实现，用于对比测试和基准测试
+    static bool decodeScalar(const uint8_t *data, size_t size, uint8_t *rgba, size_t stride,
+                             StagingBufferPool &pool, const PngDecodeOptions &options = {});
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_PNGDECODER_H
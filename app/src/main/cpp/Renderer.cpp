@@ -2,35 +2,42 @@
 
 #include <game-activity/native_app_glue/android_native_app_glue.h>
 #include <GLES3/gl3.h>
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <android/imagedecoder.h>
 
-#include "AndroidOut.h"
+#include "Bounds.h"
+#include "ConstTransform.h"
+#include "LevelOfDetail.h"
+#include "Log.h"
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+#include "MeshWelder.h"
 #include "Shader.h"
 #include "Utility.h"
 #include "TextureAsset.h"
+#include "TextureAtlas.h"
+#include "Trace.h"
 
 //! 执行glGetString并将结果输出到logcat
-#define PRINT_GL_STRING(s) {aout << #s": "<< glGetString(s) << std::endl;}
+#define PRINT_GL_STRING(s) LOGI(#s": %s", (const char *) glGetString(s))
 
 /*!
  * @brief 如果glGetString返回一个由空格分隔的元素列表，将每个元素打印在新行上
  *
  * 通过创建输入c风格字符串的istringstream来工作。然后使用它来创建一个vector，
- * vector中的每个元素都是输入字符串中的新元素。最后使用foreach循环将其输出到logcat，
- * 使用@a aout
+ * vector中的每个元素都是输入字符串中的新元素。最后使用foreach循环将其逐行输出到logcat
  */
 #define PRINT_GL_STRING_AS_LIST(s) { \
 std::istringstream extensionStream((const char *) glGetString(s));\
 std::vector<std::string> extensionList(\
         std::istream_iterator<std::string>{extensionStream},\
         std::istream_iterator<std::string>());\
-aout << #s":\n";\
+LOGI(#s":");\
 for (auto& extension: extensionList) {\
-    aout << extension << "\n";\
+    LOGI("%s", extension.c_str());\
 }\
-aout << std::endl;\
 }
 
 //! cornflower blue的颜色。可以直接发送到glClearColor
@@ -40,20 +47,24 @@ aout << std::endl;\
 static const char *vertex = R"vertex(#version 300 es
 in vec3 inPosition;
 in vec2 inUV;
+in vec4 inColor;
 
 out vec2 fragUV;
 out vec4 fragColor;
 
 uniform mat4 uProjection;
-uniform mat4 uRotation; // 新增旋转矩阵uniform
+uniform mat4 uModel; // 模型的世界矩阵
+uniform vec3 uPositionScale;  // 量化位置的还原缩放
+uniform vec3 uPositionOffset; // 量化位置的还原偏移
 
 void main() {
     fragUV = inUV;
+    vec3 position = inPosition * uPositionScale + uPositionOffset;
 
     // 基于顶点Y位置生成颜色
-    float y = (inPosition.y + 1.0) / 2.0; // 归一化Y坐标
-    fragColor = vec4(y, 1.0 - y, 0.5 + 0.5 * sin(3.14 * y), 1.0); // 生成颜色
-    gl_Position = uProjection * uRotation * vec4(inPosition, 1.0); // 应用旋转
+    float y = (position.y + 1.0) / 2.0; // 归一化Y坐标
+    fragColor = inColor * vec4(y, 1.0 - y, 0.5 + 0.5 * sin(3.14 * y), 1.0); // 生成颜色
+    gl_Position = uProjection * uModel * vec4(position, 1.0); // 应用模型变换
 }
 )vertex";
 
@@ -92,8 +103,30 @@ static constexpr float kProjectionNearPlane = -1.f;
  */
 static constexpr float kProjectionFarPlane = 1.f;
 
+/*!
+ * 每帧在GL线程上传异步加载资源的时间预算（纳秒）。单个纹理超出预算时仍然会上传，下一帧再继续
+ */
+static constexpr uint64_t kUploadBudgetNs = 2000000;
+
+/*!
+ * 宽高比为1时的正交投影矩阵，在编译期生成。实际的宽高比只影响第一个元素，运行期再修正
+ */
+static constexpr Mat4 kSquareProjectionMatrix = ConstTransform::orthographic(
+        kProjectionHalfHeight,
+        1.f,
+        kProjectionNearPlane,
+        kProjectionFarPlane);
+
 Renderer::~Renderer() {
-    aout << "执行函数 ~Renderer" << std::endl;
+    LOGV("执行函数 ~Renderer");
+    // 网格缓冲、纹理和着色器析构时调用glDelete*，必须趁上下文还是当前上下文时释放，成员析构时已经太晚。
+    // 先停止加载线程并丢弃还没执行的上传任务，再释放模型持有的句柄，最后销毁缓存中的纹理，
+    // 流送的纹理随之从流送器移除
+    assetLoader_.stop();
+    models_.clear();
+    textureCache_.clear();
+    shader_.reset();
+
     if (display_ != EGL_NO_DISPLAY) {
         eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
         if (context_ != EGL_NO_CONTEXT) {
@@ -110,7 +143,20 @@ Renderer::~Renderer() {
 }
 
 void Renderer::render() {
-    aout << "执行函数 render" << std::endl;
+    LOGV("执行函数 render");
+    TRACE_ZONE("render");
+    frameStats_.beginFrame();
+
+    // 上传工作线程已经解码好的资源，还没就绪的纹理继续用占位纹理绘制
+    if (assetsLoading_) {
+        TRACE_ZONE("uploadAssets");
+        assetLoader_.pumpUploads(kUploadBudgetNs);
+        if (assetLoader_.pendingCount() == 0) {
+            assetsLoading_ = false;
+            LOGI("异步资源全部就绪，距初始化 %.2f ms", (Trace::now() - initStartNs_) / 1e6);
+        }
+    }
+
     // 检查渲染区域的大小是否有变化。在使用沉浸模式时，这是每帧都必须做的，
     // 因为你不会收到其他通知来告诉你的渲染区域已经改变。
     updateRenderArea();
@@ -118,21 +164,14 @@ void Renderer::render() {
     // 渲染区域改变时，投影矩阵也需要更新。即使你从示例的正交投影矩阵改变，
     // 你的纵横比可能也已经改变。
     if (shaderNeedsNewProjectionMatrix_) {
-        // 在栈上分配的占位符投影矩阵。列主内存布局
-        float projectionMatrix[16] = {0};
-
-        // 为2D渲染构建正交投影矩阵
-        Utility::buildOrthographicMatrix(
-                projectionMatrix,
-                kProjectionHalfHeight,
-                float(width_) / height_,
-                kProjectionNearPlane,
-                kProjectionFarPlane);
+        // 为2D渲染构建正交投影矩阵。只有x方向的缩放依赖宽高比，其余元素在编译期已经算好
+        projectionMatrix_ = kSquareProjectionMatrix;
+        projectionMatrix_.m[0] /= float(width_) / height_;
 
         // 将矩阵发送到着色器
         // 注意：着色器必须是激活的才能工作。由于我们在这个演示中只有一个着色器，
         // 我们可以假设它是激活的。
-        shader_->setProjectionMatrix(projectionMatrix);
+        shader_->setProjectionMatrix(projectionMatrix_.m);
 
         // 确保矩阵不是每帧都生成
         shaderNeedsNewProjectionMatrix_ = false;
@@ -142,32 +181,101 @@ void Renderer::render() {
     rotationAngle_ += 1.0f; // 每帧旋转1度，你可以根据需要调整这个值
     if(rotationAngle_ >= 360.0f) rotationAngle_ -= 360.0f; // 防止溢出
 
-    // 计算旋转矩阵
-    float rotationMatrix[16];
-    // Utility::buildRotationMatrix(rotationMatrix, rotationAngle_);
-    Utility::buildRotationMatrix3D(rotationMatrix, rotationAngle_, rotationAngle_, rotationAngle_);
+    // 旋转立方体的根节点，描边是它的子节点，会跟着一起转
+    transforms_.setLocalRotation(
+            cubeNode_,
+            Quat::fromEulerDegrees(rotationAngle_, rotationAngle_, rotationAngle_));
 
-    // 设置旋转矩阵uniform
-    shader_->setRotationMatrix(rotationMatrix);
+    // 只重新计算被修改过的子树
+    transforms_.update();
 
     // 清除颜色缓冲区
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // 渲染所有模型。这个示例中没有深度测试，所以模型按提供的顺序接受。
+    // 渲染视锥内的模型。这个示例中没有深度测试，所以模型按提供的顺序接受。
     // 但是示例EGL设置请求了一个24位深度缓冲区，所以你可以在initRenderer的最后配置它
     if (!models_.empty()) {
-        for (const auto &model: models_) {
-            shader_->drawModel(model);
+        // 更新模型的世界空间包围盒，只有移出扩大的包围盒时才会修改BVH
+        for (size_t i = 0; i < models_.size(); i++) {
+            bvh_.moveProxy(modelProxies_[i], transformAabb(models_[i].getBounds(), getWorldMatrix(models_[i])));
         }
+        bvh_.update();
+
+        // 视图矩阵是单位矩阵，投影矩阵提取出的就是世界空间的视锥
+        bvh_.cull(Frustum::fromMatrix(projectionMatrix_), visibleModels_);
+        // BVH输出的顺序不确定，没有深度测试时需要按提供的顺序绘制
+        std::sort(visibleModels_.begin(), visibleModels_.end());
+
+        float pixelsPerUnit = LevelOfDetail::pixelsPerUnitOrthographic(
+                kProjectionHalfHeight, float(height_));
+        // 帧开始时上传过纹理，绑定状态已经改变
+        shader_->resetTextureBinding();
+        for (uint32_t index: visibleModels_) {
+            auto &model = models_[index];
+            const Mat4 &world = getWorldMatrix(model);
+            float worldPixelsPerUnit = pixelsPerUnit * LevelOfDetail::maxAxisScale(world);
+
+            // 按投影到屏幕上的误差选择细节层次
+            if (model.getLodCount() > 1) {
+                model.setLod(LevelOfDetail::selectLevel(model.getLodErrors(), worldPixelsPerUnit));
+            }
+
+            // 假定纹理铺满包围盒的最长边，估算它在屏幕上的像素数，流送器据此决定需要的mip层级
+            const Aabb &bounds = model.getBounds();
+            float extent = std::max({bounds.max.x - bounds.min.x,
+                                     bounds.max.y - bounds.min.y,
+                                     bounds.max.z - bounds.min.z});
+            model.getTexture().reportUsage(extent * worldPixelsPerUnit);
+
+            shader_->setModelMatrix(world.m);
+
+            // 第0层分过簇时先在CPU上剔除视锥外的簇，只绘制剩下的索引范围
+            if (model.getLod() == 0 && model.hasMeshlets()) {
+                CullingView view = CullingView::orthographic(
+                        projectionMatrix_, world, Vec3{0.f, 0.f, -1.f, 0.f});
+                // 示例没有开启GL_CULL_FACE，背面也会被看到
+                view.backfaceCulling = false;
+                MeshletCuller::cull(model.getMeshlets(), view, meshletVisibility_);
+                MeshletCuller::buildDrawRanges(model.getMeshlets(), meshletVisibility_, drawRanges_);
+                shader_->drawModel(model, drawRanges_);
+            } else {
+                shader_->drawModel(model);
+            }
+        }
+        TRACE_COUNTER("textureBinds", double(shader_->getTextureBindCount()));
+    }
+
+    // 根据本帧的使用情况提升或淘汰纹理的mip层级，新上传的层级下一帧生效
+    {
+        TRACE_ZONE("textureStreaming");
+        textureCache_.collect();
+        textureStreamer_.update();
+        TRACE_COUNTER("textureResidentMB", textureStreamer_.stats().residentBytes / (1024.0 * 1024.0));
+        TRACE_COUNTER("texturePendingUploads", double(textureStreamer_.stats().pendingUploads));
+        TRACE_COUNTER("textureEvictions", double(textureStreamer_.stats().evictions));
+        TRACE_COUNTER("textureCacheHits", double(textureCache_.stats().hits));
+        TRACE_COUNTER("textureCacheMisses", double(textureCache_.stats().misses));
+        TRACE_COUNTER("textureCacheEvictions", double(textureCache_.stats().evictions));
     }
 
     // 展示渲染的图像。这是一个隐式的glFlush。
-    auto swapResult = eglSwapBuffers(display_, surface_);
-    assert(swapResult == EGL_TRUE);
+    frameStats_.beginSwap();
+    {
+        TRACE_ZONE("eglSwapBuffers");
+        auto swapResult = eglSwapBuffers(display_, surface_);
+        assert(swapResult == EGL_TRUE);
+    }
+    frameStats_.endSwap();
+    if (!firstFrameDone_) {
+        firstFrameDone_ = true;
+        LOGI("首帧耗时 %.2f ms（从初始化开始）", (Trace::now() - initStartNs_) / 1e6);
+    }
+    frameStats_.dumpIfDue();
 }
 
 void Renderer::initRenderer() {
-    aout << "执行函数 initRenderer" << std::endl;
+    LOGV("执行函数 initRenderer");
+    initStartNs_ = Trace::now();
     // 选择你的渲染属性
     constexpr
     EGLint attribs[] = {
@@ -205,15 +313,14 @@ void Renderer::initRenderer() {
                     && eglGetConfigAttrib(display, config, EGL_BLUE_SIZE, &blue)
                     && eglGetConfigAttrib(display, config, EGL_DEPTH_SIZE, &depth)) {
 
-                    aout << "找到配置 " << red << ", " << green << ", " << blue << ", "
-                         << depth << std::endl;
+                    LOGD("找到配置 %d, %d, %d, %d", red, green, blue, depth);
                     return red == 8 && green == 8 && blue == 8 && depth == 24;
                 }
                 return false;
             });
 
-    aout << "找到 " << numConfigs << " 个配置" << std::endl;
-    aout << "选择了 " << config << std::endl;
+    LOGD("找到 %d 个配置", numConfigs);
+    LOGD("选择了 %p", config);
 
     // 创建合适的窗口表面
     EGLint format;
@@ -241,8 +348,15 @@ void Renderer::initRenderer() {
     PRINT_GL_STRING(GL_VERSION);
     PRINT_GL_STRING_AS_LIST(GL_EXTENSIONS);
 
+    // 加载KTX2纹理前确定哪些压缩格式可以直接上传
+    TextureAsset::detectCompressedFormats();
+
+    // 调试版本启动时确认编译期生成的矩阵与运行期构造函数一致
+    assert(ConstTransform::verifyAgainstRuntime());
+
     shader_ = std::unique_ptr<Shader>(
-            Shader::loadShader(vertex, fragment, "inPosition", "inUV", "uProjection"));
+            Shader::loadShader(vertex, fragment, "inPosition", "inUV", "uProjection", "uModel",
+                                     "inColor", "uPositionScale", "uPositionOffset"));
     assert(shader_);
 
     // 注意：这个演示中只有一个着色器，所以我将在这里激活它。对于更复杂的游戏
@@ -262,7 +376,7 @@ void Renderer::initRenderer() {
 
 
 void Renderer::updateRenderArea() {
-    aout << "执行函数 updateViewportAndProjectionMatrix" << std::endl;
+    LOGV("执行函数 updateViewportAndProjectionMatrix");
     EGLint width;
     eglQuerySurface(display_, surface_, EGL_WIDTH, &width);
 
@@ -281,7 +395,7 @@ void Renderer::updateRenderArea() {
 
 
 void Renderer::updateViewportAndProjectionMatrix() {
-    aout << "执行函数 updateViewportAndProjectionMatrix" << std::endl;
+    LOGV("执行函数 updateViewportAndProjectionMatrix");
     EGLint width;
     eglQuerySurface(display_, surface_, EGL_WIDTH, &width);
 
@@ -319,7 +433,7 @@ void Renderer::updateViewportAndProjectionMatrix() {
  * 然后通过索引定义了构成正方形的两个三角形。此外，函数加载了一个名为"android_robot.png"的纹理图像，
  * 并将这个纹理应用到正方形上。最后，创建的模型会被添加到模型列表中，以便后续渲染。
  *
- * 注意：此示例没有实现纹理管理，如果重用图像，应注意避免重复加载。
+ * 纹理都经过 textureCache_ 加载，重复使用同一路径或同一颜色时共享同一个纹理。
  *
  * @param 无
  * @return 无
@@ -327,7 +441,7 @@ void Renderer::updateViewportAndProjectionMatrix() {
 
 
 void Renderer::createModels() {
-    aout << "执行函数 createModels" << std::endl;
+    LOGV("执行函数 createModels");
 
     // 定义立方体的尺寸
     float size = 0.5f; // 立方体边长的一半
@@ -392,22 +506,89 @@ void Renderer::createModels() {
             0, 4, 1, 5, 2, 6, 3, 7  // Connecting edges
     };
 
-    // 加载一个图像纹理
+    // 在工作线程加载图像纹理并生成mip链，先上传mip尾，更精细的层级按屏幕尺寸流送。
+    // 上传前用透明的占位纹理，立方体只显示顶点颜色
     auto assetManager = app_->activity->assetManager;
-    auto spAndroidRobotTexture = TextureAsset::loadAsset(assetManager, "android_robot.png");
+    auto spAndroidRobotTexture = textureCache_.loadAssetStreamed(
+            assetLoader_, textureStreamer_, assetManager, "android_robot.png",
+            textureCache_.solidColor(0, 0, 0, 0));
+
+    // 立方体和它的描边共用一个变换：描边节点挂在立方体节点下面，局部变换为单位变换
+    cubeNode_ = transforms_.createNode();
+    auto borderNode = transforms_.createNode(cubeNode_);
+
+    // 立方体每个面的uv不同，焊接只会合并uv也相同的顶点
+    size_t cubeVertexCount = vertices.size();
+    MeshWelder::weld(vertices, indices);
+    LOGI("立方体顶点焊接: %zu -> %zu", cubeVertexCount, vertices.size());
+
+    // 描边使用纯色纹理，不需要比较uv，焊接后只剩8个角点
+    WeldOptions borderWeld;
+    borderWeld.uvEpsilon = -1.f;
+    MeshWelder::weld(borderVertices, borderIndices, borderWeld);
+
+    // 导入时优化立方体的三角形和顶点顺序（描边已经复制了原始顶点，不受影响）
+    auto report = MeshOptimizer::optimize(vertices, indices);
+    LOGI("立方体网格优化: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+         report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+
+    // 生成细节层次。立方体的顶点都在uv接缝上，简化器不会移动它们，这里只会得到第0层
+    auto lods = LevelOfDetail::buildChain(vertices, indices, 4);
+
+    // 第0层按簇重排索引，绘制时按簇剔除
+    auto meshlets = MeshletBuilder::build(vertices, indices);
+    LOGI("立方体分簇: %zu 个簇", meshlets.meshlets.size());
 
     // 创建并添加立方体模型
-    models_.emplace_back(vertices, indices, spAndroidRobotTexture, GL_TRIANGLES);
+    models_.emplace_back(vertices, meshlets.indices, spAndroidRobotTexture, GL_TRIANGLES);
+    models_.back().setTransformNode(cubeNode_);
+    models_.back().setMeshlets(std::move(meshlets));
+    for (size_t level = 1; level < lods.size(); level++) {
+        MeshOptimizer::optimizeVertexCache(lods[level].indices, vertices.size());
+        models_.back().addLevelOfDetail(lods[level].indices, lods[level].error);
+    }
 
-    // 创建纯色纹理
-    auto spGoldTexture = TextureAsset::createSolidColorTexture(255, 215, 0, 255);
+    // 纯色和其他小纹理排进图集，用同一页面的模型连续绘制时不再切换纹理。
+    // 描边的uv改写到页面中金色像素的区域
+    static const uint8_t kGold[4] = {255, 215, 0, 255};
+    AtlasOptions atlasOptions;
+    atlasOptions.mipOptions = TextureAsset::colorMipOptions();
+    AtlasLayout atlasLayout;
+    std::vector<MipChain> atlasPages;
+    std::shared_ptr<TextureAsset> spGoldTexture;
+    if (TextureAtlas::build({AtlasImage{1, 1, kGold}}, atlasOptions, atlasLayout, atlasPages)) {
+        spGoldTexture = TextureAsset::upload(atlasPages[0]);
+        TextureAtlas::remapUVs(borderVertices, atlasLayout.regions[0]);
+    } else {
+        spGoldTexture = textureCache_.solidColor(kGold[0], kGold[1], kGold[2], kGold[3]);
+    }
 
     // 创建并添加立方体的描边模型
     models_.emplace_back(borderVertices, borderIndices, spGoldTexture, GL_LINES);
+    models_.back().setTransformNode(borderNode);
+
+    // 几何数据上传到GPU缓冲，之后每次绘制只绑定VAO；CPU上的副本不再需要，释放掉
+    for (auto &model: models_) {
+        model.uploadBuffers(BufferUsage::Static);
+        model.releaseCpuData();
+    }
+
+    // 模型都加入BVH后完整构建一次。世界矩阵要到第一次update后才有效，先用物体空间的包围盒
+    for (size_t i = 0; i < models_.size(); i++) {
+        modelProxies_.push_back(bvh_.createProxy(models_[i].getBounds(), uint32_t(i)));
+    }
+    bvh_.rebuild();
+}
+
+const Mat4 &Renderer::getWorldMatrix(const Model &model) const {
+    static constexpr Mat4 kIdentity = ConstTransform::identity();
+    auto node = model.getTransformNode();
+    return node == TransformHierarchy::kInvalidNode ? kIdentity : transforms_.getWorldMatrix(node);
 }
 
 void Renderer::handleInput() {
-    aout << "执行函数 handleInput" << std::endl;
+    LOGV("执行函数 handleInput");
+    TRACE_ZONE("handleInput");
     // 处理所有排队的输入
     auto *inputBuffer = android_app_swap_input_buffers(app_);
     if (!inputBuffer) {
@@ -423,7 +604,6 @@ void Renderer::handleInput() {
         // 查找指针索引，掩码和位移使其变成一个可读值。
         auto pointerIndex = (action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK)
                 >> AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
-        aout << "指针: ";
 
         // 获取这个事件的x和y位置，如果它不是ACTION_MOVE。
         auto &pointer = motionEvent.pointers[pointerIndex];
@@ -434,8 +614,7 @@ void Renderer::handleInput() {
         switch (action & AMOTION_EVENT_ACTION_MASK) {
             case AMOTION_EVENT_ACTION_DOWN:
             case AMOTION_EVENT_ACTION_POINTER_DOWN:
-                aout << "(" << pointer.id << ", " << x << ", " << y << ") "
-                     << "指针按下";
+                LOGD("指针: (%d, %f, %f) 指针按下", pointer.id, x, y);
                 break;
 
             case AMOTION_EVENT_ACTION_CANCEL:
@@ -444,8 +623,7 @@ void Renderer::handleInput() {
                 // 代码故意穿透。
             case AMOTION_EVENT_ACTION_UP:
             case AMOTION_EVENT_ACTION_POINTER_UP:
-                aout << "(" << pointer.id << ", " << x << ", " << y << ") "
-                     << "指针抬起";
+                LOGD("指针: (%d, %f, %f) 指针抬起", pointer.id, x, y);
                 break;
 
             case AMOTION_EVENT_ACTION_MOVE:
@@ -456,17 +634,12 @@ void Renderer::handleInput() {
                     pointer = motionEvent.pointers[index];
                     x = GameActivityPointerAxes_getX(&pointer);
                     y = GameActivityPointerAxes_getY(&pointer);
-                    aout << "(" << pointer.id << ", " << x << ", " << y << ")";
-
-                    if (index != (motionEvent.pointerCount - 1)) aout << ",";
-                    aout << " ";
+                    LOGD("指针: (%d, %f, %f) 指针移动", pointer.id, x, y);
                 }
-                aout << "指针移动";
                 break;
             default:
-                aout << "未知的MotionEvent动作: " << action;
+                LOGD("指针: 未知的MotionEvent动作: %d", action);
         }
-        aout << std::endl;
     }
     // 清除此缓冲区中的运动输入计数，以便主线程重新使用。
     android_app_clear_motion_events(inputBuffer);
@@ -474,22 +647,20 @@ void Renderer::handleInput() {
     // 处理输入键事件。
     for (auto i = 0; i < inputBuffer->keyEventsCount; i++) {
         auto &keyEvent = inputBuffer->keyEvents[i];
-        aout << "键: " << keyEvent.keyCode << " ";
         switch (keyEvent.action) {
             case AKEY_EVENT_ACTION_DOWN:
-                aout << "键按下";
+                LOGD("键: %d 键按下", keyEvent.keyCode);
                 break;
             case AKEY_EVENT_ACTION_UP:
-                aout << "键抬起";
+                LOGD("键: %d 键抬起", keyEvent.keyCode);
                 break;
             case AKEY_EVENT_ACTION_MULTIPLE:
                 // 从Android API级别29开始已弃用。
-                aout << "多个键动作";
+                LOGD("键: %d 多个键动作", keyEvent.keyCode);
                 break;
             default:
-                aout << "未知的KeyEvent动作: " << keyEvent.action;
+                LOGD("键: %d 未知的KeyEvent动作: %d", keyEvent.keyCode, keyEvent.action);
         }
-        aout << std::endl;
     }
     // 同样清除键输入计数。
     android_app_clear_key_events(inputBuffer);
@@ -4,8 +4,14 @@
 #include <EGL/egl.h>
 #include <memory>
 
+#include "AssetLoader.h"
+#include "BoundingVolumeHierarchy.h"
+#include "FrameStats.h"
 #include "Model.h"
 #include "Shader.h"
+#include "TextureCache.h"
+#include "Trace.h"
+#include "TransformHierarchy.h"
 
 struct android_app;
 
@@ -23,7 +29,8 @@ public:
             context_(EGL_NO_CONTEXT),
             width_(0),
             height_(0),
-            shaderNeedsNewProjectionMatrix_(true) {
+            shaderNeedsNewProjectionMatrix_(true),
+            frameStats_(Trace::now) {
         initRenderer();
     }
 
@@ -41,6 +48,11 @@ public:
      */
     void render();
 
+    /*!
+     * @return 帧耗时统计，可用于查询帧节奏或设置回归阈值
+     */
+    inline const FrameStats &getFrameStats() const { return frameStats_; }
+
 private:
     /*!
      * 执行必要的OpenGL初始化。如果你想改变你的EGL上下文或应用范围的设置，可以自定义这个函数。
@@ -59,6 +71,11 @@ private:
      */
     void createModels();
 
+    /*!
+     * @return 模型的世界矩阵，没有变换节点的模型为单位矩阵
+     */
+    const Mat4 &getWorldMatrix(const Model &model) const;
+
     android_app *app_; // 指向android_app的指针
     EGLDisplay display_; // EGL显示设备
     EGLSurface surface_; // EGL表面
@@ -67,9 +84,32 @@ private:
     EGLint height_; // 视口高度
 
     bool shaderNeedsNewProjectionMatrix_; // 标记是否需要新的投影矩阵
+    Mat4 projectionMatrix_ = Mat4::identity(); // 当前的投影矩阵，按簇剔除时使用
 
     std::unique_ptr<Shader> shader_; // 着色器
+
+    // 流送器和缓存要比引用它们的纹理活得久，所以声明在models_之前
+    GlTextureStreamBackend textureBackend_;
+    TextureStreamer textureStreamer_{textureBackend_}; // 按屏幕尺寸逐级上传纹理的mip，超出预算时按LRU淘汰
+    TextureCache textureCache_; // 按路径/颜色去重的纹理缓存，缓存中的流送纹理引用textureStreamer_
     std::vector<Model> models_; // 模型集合
+
+    AssetLoader assetLoader_; // 在工作线程读取和解码纹理，每帧在GL线程按预算上传
+    uint64_t initStartNs_ = 0; // initRenderer开始的时间，用于统计首帧和资源就绪的耗时
+    bool firstFrameDone_ = false;
+    bool assetsLoading_ = true; // 还有异步资源没有上传
+
+    TransformHierarchy transforms_; // 所有模型的变换层级
+    TransformHierarchy::NodeId cubeNode_ = TransformHierarchy::kInvalidNode; // 旋转立方体的根节点
+
+    BoundingVolumeHierarchy bvh_; // 所有模型的世界空间包围盒，用于视锥剔除
+    std::vector<BoundingVolumeHierarchy::ProxyId> modelProxies_; // 每个模型在bvh_中的代理
+    std::vector<uint32_t> visibleModels_; // 视锥剔除后可见的模型下标，每帧复用
+
+    std::vector<uint8_t> meshletVisibility_; // 按簇剔除的结果，每帧复用
+    std::vector<DrawRange> drawRanges_;      // 可见簇合并后的绘制范围，每帧复用
+
+    FrameStats frameStats_; // 帧耗时统计，每隔几秒输出一次汇总
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_RENDERER_H
@@ -1,7 +1,8 @@
 #include "Shader.h"
 
-#include "AndroidOut.h"
+#include "Log.h"
 #include "Model.h"
+#include "Trace.h"
 #include "Utility.h"
 
 // 加载着色器的静态函数
@@ -10,8 +11,12 @@ Shader *Shader::loadShader(
         const std::string &fragmentSource,
         const std::string &positionAttributeName,
         const std::string &uvAttributeName,
-        const std::string &projectionMatrixUniformName) {
-    aout << "执行函数 loadShader" << std::endl;
+        const std::string &projectionMatrixUniformName,
+        const std::string &modelMatrixUniformName,
+        const std::string &colorAttributeName,
+        const std::string &positionScaleUniformName,
+        const std::string &positionOffsetUniformName) {
+    LOGV("执行函数 loadShader");
     Shader *shader = nullptr;
 
     // 加载顶点着色器
@@ -46,7 +51,7 @@ Shader *Shader::loadShader(
             if (logLength) {
                 GLchar *log = new GLchar[logLength];
                 glGetProgramInfoLog(program, logLength, nullptr, log);
-                aout << "程序链接失败:\n" << log << std::endl;
+                LOGE("程序链接失败:\n%s", log);
                 delete[] log;
             }
 
@@ -58,17 +63,36 @@ Shader *Shader::loadShader(
             GLint projectionMatrixUniform = glGetUniformLocation(
                     program,
                     projectionMatrixUniformName.c_str());
+            GLint modelMatrixUniform = glGetUniformLocation(
+                    program,
+                    modelMatrixUniformName.c_str());
+            GLint colorAttribute = glGetAttribLocation(
+                    program,
+                    colorAttributeName.c_str());
+            GLint positionScaleUniform = glGetUniformLocation(
+                    program,
+                    positionScaleUniformName.c_str());
+            GLint positionOffsetUniform = glGetUniformLocation(
+                    program,
+                    positionOffsetUniformName.c_str());
 
-            // 如果所有属性都找到了，创建新的着色器
+            // 如果所有必需的属性都找到了，创建新的着色器（颜色属性是可选的）
             if (positionAttribute != -1
                 && uvAttribute != -1
-                && projectionMatrixUniform != -1) {
+                && projectionMatrixUniform != -1
+                && modelMatrixUniform != -1
+                && positionScaleUniform != -1
+                && positionOffsetUniform != -1) {
 
                 shader = new Shader(
                         program,
                         positionAttribute,
                         uvAttribute,
-                        projectionMatrixUniform);
+                        projectionMatrixUniform,
+                        modelMatrixUniform,
+                        colorAttribute,
+                        positionScaleUniform,
+                        positionOffsetUniform);
             } else {
                 glDeleteProgram(program);
             }
@@ -84,7 +108,7 @@ Shader *Shader::loadShader(
 
 // 加载单个着色器的函数
 GLuint Shader::loadShader(GLenum shaderType, const std::string &shaderSource) {
-    aout << "执行函数 loadShader" << std::endl;
+    LOGV("执行函数 loadShader");
     Utility::assertGlError();
     GLuint shader = glCreateShader(shaderType);
     if (shader) {
@@ -104,7 +128,7 @@ GLuint Shader::loadShader(GLenum shaderType, const std::string &shaderSource) {
             if (infoLength) {
                 auto *infoLog = new GLchar[infoLength];
                 glGetShaderInfoLog(shader, infoLength, nullptr, infoLog);
-                aout << "编译失败:\n" << infoLog << std::endl;
+                LOGE("编译失败:\n%s", infoLog);
                 delete[] infoLog;
             }
 
@@ -117,45 +141,102 @@ GLuint Shader::loadShader(GLenum shaderType, const std::string &shaderSource) {
 
 // 激活着色器程序
 void Shader::activate() const {
-    aout << "执行函数 activate" << std::endl;
+    LOGV("执行函数 activate");
     glUseProgram(program_);
 }
 
 // 取消激活着色器程序
 void Shader::deactivate() const {
-    aout << "执行函数 deactivate" << std::endl;
+    LOGV("执行函数 deactivate");
     glUseProgram(0);
 }
 
-void Shader::setRotationMatrix(const float* rotationMatrix) {
-    GLint rotationMatrixUniform = glGetUniformLocation(program_, "uRotation");
-    glUniformMatrix4fv(rotationMatrixUniform, 1, GL_FALSE, rotationMatrix);
+// 设置模型矩阵，uniform位置在加载时已经查询好
+void Shader::setModelMatrix(const float *modelMatrix) const {
+    glUniformMatrix4fv(modelMatrix_, 1, GL_FALSE, modelMatrix);
 }
-void Shader::drawModel(const Model &model) const {
-    aout << "执行函数 drawModel" << std::endl;
 
-    // 设置顶点属性
-    glVertexAttribPointer(position_, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), model.getVertexData());
-    glEnableVertexAttribArray(position_);
+void Shader::resetTextureBinding() const {
+    boundTexture_ = 0;
+    textureBindCount_ = 0;
+}
 
-    // 设置UV属性
-    glVertexAttribPointer(uv_, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), ((uint8_t *)model.getVertexData()) + sizeof(Vector3));
-    glEnableVertexAttribArray(uv_);
+void Shader::drawModel(const Model &model) const {
+    LOGV("执行函数 drawModel");
+    TRACE_ZONE("drawModel");
 
-    // 设置纹理
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, model.getTexture().getTextureID());
+    bindModel(model);
 
     // 使用模型指定的绘制模式绘制
-    glDrawElements(model.getMode(), model.getIndexCount(), GL_UNSIGNED_SHORT, model.getIndexData());
+    glDrawElements(model.getMode(), model.getIndexCount(), model.getIndexType(), model.getIndexPointer());
+
+    unbindModel(model);
+}
 
-    // 禁用属性
-    glDisableVertexAttribArray(uv_);
-    glDisableVertexAttribArray(position_);
+void Shader::drawModel(const Model &model, const std::vector<DrawRange> &ranges) const {
+    LOGV("执行函数 drawModel");
+    TRACE_ZONE("drawModel");
+    if (ranges.empty()) {
+        return;
+    }
+
+    bindModel(model);
+
+    // 已上传的模型这里是索引缓冲中的偏移，不能按指针做运算
+    auto indexBase = reinterpret_cast<uintptr_t>(model.getIndexPointer());
+    size_t indexSize = model.getIndexSize();
+    for (const DrawRange &range: ranges) {
+        glDrawElements(
+                model.getMode(),
+                range.indexCount,
+                model.getIndexType(),
+                reinterpret_cast<const void *>(indexBase + range.indexOffset * indexSize));
+    }
+
+    unbindModel(model);
+}
+
+void Shader::bindModel(const Model &model) const {
+    const auto &quantized = model.getQuantizedVertices();
+    const VertexLayout &layout = quantized.layout;
+    VertexAttributeLocations locations{position_, uv_, color_};
+    if (model.getBuffers().isUploaded()) {
+        // VAO记录了属性格式、顶点缓冲和索引缓冲，一次绑定就恢复全部顶点状态
+        model.getBuffers().bindVertexArray(layout, locations);
+    } else {
+        // 没有上传的模型使用客户端数组，驱动每次绘制都要拷贝顶点和索引
+        MeshBuffers::bindClientArrays(layout, model.getVertexData(), locations);
+    }
+
+    // 没有颜色数据时使用常量白色
+    if (color_ != -1 && !layout.color.isPresent()) {
+        glVertexAttrib4f(color_, 1.f, 1.f, 1.f, 1.f);
+    }
+
+    // 量化后的位置在着色器里还原
+    glUniform3fv(positionScale_, 1, quantized.positionScale.idx);
+    glUniform3fv(positionOffset_, 1, quantized.positionOffset.idx);
+
+    // 设置纹理。与上一个模型相同的纹理（例如同一个图集页面）不再重复绑定
+    GLuint texture = model.getTexture().getTextureID();
+    if (texture != boundTexture_) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        boundTexture_ = texture;
+        textureBindCount_++;
+    }
+}
+
+void Shader::unbindModel(const Model &model) const {
+    // VAO中的属性一直保持启用，只有客户端数组需要禁用
+    if (!model.getBuffers().isUploaded()) {
+        MeshBuffers::unbindClientArrays(
+                model.getQuantizedVertices().layout, VertexAttributeLocations{position_, uv_, color_});
+    }
 }
 
 // 设置投影矩阵
 void Shader::setProjectionMatrix(float *projectionMatrix) const {
-    aout << "执行函数 setProjectionMatrix" << std::endl;
+    LOGV("执行函数 setProjectionMatrix");
     glUniformMatrix4fv(projectionMatrix_, 1, false, projectionMatrix);
 }
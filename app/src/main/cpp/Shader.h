@@ -1,10 +1,13 @@
 #ifndef ANDROIDGLINVESTIGATIONS_SHADER_H
 #define ANDROIDGLINVESTIGATIONS_SHADER_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <GLES3/gl3.h>
 
 class Model;
+struct DrawRange;
 
 /*!
  * 代表一个简单的着色器程序的类。它包含顶点和片段组件。
@@ -22,7 +25,11 @@ public:
      * @param fragmentSource 片段程序的完整源代码
      * @param positionAttributeName 顶点程序中位置属性的名称
      * @param uvAttributeName 顶点程序中uv坐标属性的名称
-     * @param projectionMatrixUniformName 模型/视图/投影矩阵uniform的名称
+     * @param projectionMatrixUniformName 投影矩阵uniform的名称
+     * @param modelMatrixUniformName 模型矩阵uniform的名称
+     * @param colorAttributeName 顶点颜色属性的名称，着色器中可以没有这个属性
+     * @param positionScaleUniformName 位置反量化缩放uniform的名称
+     * @param positionOffsetUniformName 位置反量化偏移uniform的名称
      * @return 成功时返回一个有效的Shader，否则返回null。
      */
     static Shader *loadShader(
@@ -30,7 +37,11 @@ public:
             const std::string &fragmentSource,
             const std::string &positionAttributeName,
             const std::string &uvAttributeName,
-            const std::string &projectionMatrixUniformName);
+            const std::string &projectionMatrixUniformName,
+            const std::string &modelMatrixUniformName,
+            const std::string &colorAttributeName,
+            const std::string &positionScaleUniformName,
+            const std::string &positionOffsetUniformName);
 
     inline ~Shader() {
         if (program_) {
@@ -50,20 +61,52 @@ public:
     void deactivate() const;
 
     /*!
-     * 渲染单个模型
+     * 渲染单个模型。调用过 Model::uploadBuffers 的模型只绑定VAO再绘制，否则使用客户端数组
      * @param model 要渲染的模型
      */
     void drawModel(const Model &model) const;
 
+    /*!
+     * 只渲染模型当前细节层次中的若干段索引，通常来自 MeshletCuller::buildDrawRanges
+     * @param model 要渲染的模型
+     * @param ranges 要绘制的索引范围，以索引个数计
+     */
+    void drawModel(const Model &model, const std::vector<DrawRange> &ranges) const;
+
     /*!
      * 在着色器中设置模型/视图/投影矩阵。
      * @param projectionMatrix 十六个浮点数，列优先，定义了一个OpenGL投影矩阵。
      */
     void setProjectionMatrix(float *projectionMatrix) const;
 
-    void setRotationMatrix(const float *rotationMatrix);
+    /*!
+     * 设置当前绘制的模型的世界矩阵
+     * @param modelMatrix 十六个浮点数，列优先
+     */
+    void setModelMatrix(const float *modelMatrix) const;
+
+    /*!
+     * 忘记记录的纹理绑定，下一次绘制一定会重新绑定。
+     * 其他代码（例如纹理上传）改变过绑定之后、开始绘制之前调用，同时把绑定计数清零
+     */
+    void resetTextureBinding() const;
+
+    //! @return 上次 resetTextureBinding 以来实际绑定纹理的次数，连续绘制同一纹理（图集页面）的模型只算一次
+    inline uint32_t getTextureBindCount() const {
+        return textureBindCount_;
+    }
 
 private:
+    /*!
+     * 绑定模型的VAO（没有上传的模型按顶点布局设置客户端数组）、uniform和纹理
+     */
+    void bindModel(const Model &model) const;
+
+    /*!
+     * 禁用 @a bindModel 为客户端数组启用的属性，VAO不需要禁用
+     */
+    void unbindModel(const Model &model) const;
+
     /*!
      * 加载给定类型的着色器的辅助函数
      * @param shaderType OpenGL着色器类型。应该是GL_VERTEX_SHADER或GL_FRAGMENT_SHADER之一
@@ -78,21 +121,39 @@ private:
      * @param position 位置的属性位置
      * @param uv uv坐标的属性位置
      * @param projectionMatrix 投影矩阵的uniform位置
+     * @param modelMatrix 模型矩阵的uniform位置
+     * @param color 顶点颜色属性的位置，-1表示没有
+     * @param positionScale 位置反量化缩放的uniform位置
+     * @param positionOffset 位置反量化偏移的uniform位置
      */
     constexpr Shader(
             GLuint program,
             GLint position,
             GLint uv,
-            GLint projectionMatrix)
+            GLint projectionMatrix,
+            GLint modelMatrix,
+            GLint color,
+            GLint positionScale,
+            GLint positionOffset)
             : program_(program),
               position_(position),
               uv_(uv),
-              projectionMatrix_(projectionMatrix) {}
+              projectionMatrix_(projectionMatrix),
+              modelMatrix_(modelMatrix),
+              color_(color),
+              positionScale_(positionScale),
+              positionOffset_(positionOffset) {}
 
     GLuint program_; // 着色器程序ID
     GLint position_; // 位置属性位置
     GLint uv_; // UV属性位置
     GLint projectionMatrix_; // 投影矩阵uniform位置
+    GLint modelMatrix_; // 模型矩阵uniform位置
+    GLint color_; // 顶点颜色属性位置
+    GLint positionScale_; // 位置反量化缩放uniform位置
+    GLint positionOffset_; // 位置反量化偏移uniform位置
+    mutable GLuint boundTexture_ = 0; // 上一次绘制绑定的纹理
+    mutable uint32_t textureBindCount_ = 0;
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_SHADER_H
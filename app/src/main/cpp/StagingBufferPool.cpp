@@ -0,0 +1,71 @@
+#include "StagingBufferPool.h"
+
+#include <algorithm>
+
+StagingBufferPool::StagingBufferPool(size_t maxPooledBytes) : maxPooledBytes_(maxPooledBytes) {}
+
+std::vector<uint8_t> StagingBufferPool::acquire(size_t size, size_t capacity) {
+    capacity = std::max(capacity, size);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 选能放下size的最小缓冲，大缓冲留给大图像
+        size_t best = free_.size();
+        for (size_t i = 0; i < free_.size(); i++) {
+            if (free_[i].size() >= size && (best == free_.size() || free_[i].size() < free_[best].size())) {
+                best = i;
+            }
+        }
+        if (best != free_.size()) {
+            std::vector<uint8_t> buffer = std::move(free_[best]);
+            free_[best] = std::move(free_.back());
+            free_.pop_back();
+            pooledBytes_ -= buffer.size();
+            reuseCount_++;
+            // 池中的缓冲大小等于容量，缩小不会初始化内存
+            buffer.resize(size);
+            return buffer;
+        }
+    }
+    std::vector<uint8_t> buffer;
+    buffer.reserve(capacity);
+    buffer.resize(size);
+    return buffer;
+}
+
+void StagingBufferPool::release(std::vector<uint8_t> buffer) {
+    if (buffer.capacity() == 0) {
+        return;
+    }
+    // 撑满容量，之后 acquire 只缩小，不再为超出size的部分填零
+    buffer.resize(buffer.capacity());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pooledBytes_ + buffer.size() > maxPooledBytes_) {
+        return;
+    }
+    pooledBytes_ += buffer.size();
+    free_.push_back(std::move(buffer));
+}
+
+void StagingBufferPool::trim() {
+    std::vector<std::vector<uint8_t>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers.swap(free_);
+        pooledBytes_ = 0;
+    }
+}
+
+size_t StagingBufferPool::pooledBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pooledBytes_;
+}
+
+size_t StagingBufferPool::reuseCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reuseCount_;
+}
+
+StagingBufferPool &StagingBufferPool::shared() {
+    static StagingBufferPool pool;
+    return pool;
+}
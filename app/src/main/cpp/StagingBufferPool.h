@@ -0,0 +1,55 @@
+#ifndef ANDROIDGLINVESTIGATIONS_STAGINGBUFFERPOOL_H
+#define ANDROIDGLINVESTIGATIONS_STAGINGBUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/*!
+ * 复用解码用的大块内存：PNG解压后的过滤数据、整幅RGBA图像和它的mip链。
+ * 连续加载纹理时每张图都要几MB的临时内存，从池中取出、上传后归还，不再每次向系统申请。
+ *
+ * 缓冲以std::vector的形式借出，可以直接移入 MipChain。线程安全，可以在加载线程和GL线程同时使用
+ */
+class StagingBufferPool {
+public:
+    /*!
+     * @param maxPooledBytes 池中最多保留的空闲字节数，超出时归还的缓冲直接释放
+     */
+    explicit StagingBufferPool(size_t maxPooledBytes = size_t(64) << 20);
+
+    StagingBufferPool(const StagingBufferPool &) = delete;
+
+    StagingBufferPool &operator=(const StagingBufferPool &) = delete;
+
+    /*!
+     * 取出一个大小为size的缓冲，内容未定义
+     * @param capacity 预计之后会增长到的大小（例如加上mip链），池中没有合适的缓冲时按它分配
+     */
+    std::vector<uint8_t> acquire(size_t size, size_t capacity = 0);
+
+    //! 归还缓冲，空的缓冲直接丢弃
+    void release(std::vector<uint8_t> buffer);
+
+    //! 释放池中所有空闲缓冲
+    void trim();
+
+    //! @return 池中空闲缓冲的总容量
+    size_t pooledBytes() const;
+
+    //! @return acquire 复用了池中缓冲的次数，用于统计和测试
+    size_t reuseCount() const;
+
+    //! 纹理加载共用的池
+    static StagingBufferPool &shared();
+
+private:
+    mutable std::mutex mutex_; // 保护以下所有成员
+    std::vector<std::vector<uint8_t>> free_;
+    size_t pooledBytes_ = 0;
+    size_t maxPooledBytes_;
+    size_t reuseCount_ = 0;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_STAGINGBUFFERPOOL_H
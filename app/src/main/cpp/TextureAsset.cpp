@@ -1,159 +1,496 @@
 #include "TextureAsset.h"
-#include "AndroidOut.h"
+#include "AssetLoader.h"
+#include "Ktx2.h"
+#include "Log.h"
+#include "PngDecoder.h"
+#include "StagingBufferPool.h"
 #include "Utility.h"
-#include "jsoncpp/json/json.h"
 
+#include <algorithm>
 #include <android/imagedecoder.h>
-#include <fstream>
-#include <iostream>
+#include <cstring>
 #include <vector>
 #include <string>
 
-// 加载资源的函数，使用共享指针管理TextureAsset资源
-std::shared_ptr<TextureAsset>
-TextureAsset::loadAsset(AAssetManager *assetManager, const std::string &assetPath) {
-    aout << "执行函数 loadAsset" << std::endl;
-    // 从资产管理器获取图像
-    auto pAndroidRobotPng = AAssetManager_open(
-            assetManager,
-            assetPath.c_str(),
-            AASSET_MODE_BUFFER);
-
-    // 创建解码器将其转换为纹理
-    AImageDecoder *pAndroidDecoder = nullptr;
-    auto result = AImageDecoder_createFromAAsset(pAndroidRobotPng, &pAndroidDecoder);
-    assert(result == ANDROID_IMAGE_DECODER_SUCCESS);
+namespace {
 
-    // 确保输出是8位每通道的RGBA格式
-    AImageDecoder_setAndroidBitmapFormat(pAndroidDecoder, ANDROID_BITMAP_FORMAT_RGBA_8888);
-
-    // 获取图像头信息，帮助进行设置
-    const AImageDecoderHeaderInfo *pAndroidHeader = nullptr;
-    pAndroidHeader = AImageDecoder_getHeaderInfo(pAndroidDecoder);
+//! 整条mip链的字节数，解码时按它预留缓冲，生成mip链时不再重新分配
+size_t mipChainBytes(int32_t width, int32_t height) {
+    size_t total = 0;
+    for (int32_t w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        total += size_t(w) * size_t(h) * 4;
+        if (w == 1 && h == 1) {
+            return total;
+        }
+    }
+}
 
-    // 重要的度量用于发送到GL
-    auto width = AImageDecoderHeaderInfo_getWidth(pAndroidHeader);
-    auto height = AImageDecoderHeaderInfo_getHeight(pAndroidHeader);
-    auto stride = AImageDecoder_getMinimumStride(pAndroidDecoder);
+//! 整体上传后不再需要CPU上的像素，归还给池供下一张纹理使用
+void releasePixels(MipChain &chain) {
+    StagingBufferPool::shared().release(std::move(chain.pixels));
+    chain.levels.clear();
+}
 
-    // 获取图像的位图数据
-    auto upAndroidImageData = std::make_unique<std::vector<uint8_t>>(height * stride);
-    auto decodeResult = AImageDecoder_decodeImage(
-            pAndroidDecoder,
-            upAndroidImageData->data(),
-            stride,
-            upAndroidImageData->size());
-    assert(decodeResult == ANDROID_IMAGE_DECODER_SUCCESS);
+void setSamplerParameters(bool mipmapped) {
+    // 设置为边缘紧贴，如果不这样做在进行Alpha混合时会得到奇怪的结果
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
 
-    // 获取OpenGL纹理
+/*!
+ * 用CPU生成好的mip链创建纹理
+ * @return 纹理ID
+ */
+GLuint uploadMipChain(const MipChain &chain) {
+    const auto &top = chain.levels[0];
     GLuint textureId;
     glGenTextures(1, &textureId);
     glBindTexture(GL_TEXTURE_2D, textureId);
 
-    // 设置为边缘紧贴，如果不这样做在进行Alpha混合时会得到奇怪的结果
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // 不可变存储一次分配全部层级，之后逐级上传CPU生成好的数据
+    glTexStorage2D(GL_TEXTURE_2D, GLsizei(chain.levels.size()), GL_RGBA8, top.width, top.height);
+    for (size_t level = 0; level < chain.levels.size(); level++) {
+        const auto &mip = chain.levels[level];
+        glTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, mip.width, mip.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, chain.levelData(level));
+    }
+    setSamplerParameters(true);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return textureId;
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+/*!
+ * 以文件中的格式上传KTX2纹理的全部层级
+ * @return 纹理ID
+ */
+GLuint uploadCompressedImage(const CompressedImage &image) {
+    const TextureFormat &format = *image.format;
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
 
-    // 将纹理加载到显存
-    glTexImage2D(
-            GL_TEXTURE_2D, // 目标
-            0, // mip级别
-            GL_RGBA, // 内部格式，通常建议使用BGR
-            width, // 纹理宽度
-            height, // 纹理高度
-            0, // 边界（总是0）
-            GL_RGBA, // 格式
-            GL_UNSIGNED_BYTE, // 类型
-            upAndroidImageData->data() // 上传的数据
-    );
-
-    // 生成mip层级。对于2D来说不是很需要，但最好这样做
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // 不可变存储的层级数就是文件中的层级数，mip链不到1x1时纹理也是完整的
+    glTexStorage2D(GL_TEXTURE_2D, GLsizei(image.levels.size()), format.glInternalFormat, image.width, image.height);
+    for (size_t level = 0; level < image.levels.size(); level++) {
+        GLsizei width = std::max(1, image.width >> level);
+        GLsizei height = std::max(1, image.height >> level);
+        const CompressedImage::Level &mip = image.levels[level];
+        if (format.isCompressed()) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, width, height, format.glInternalFormat,
+                                      GLsizei(mip.size), mip.data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, mip.data);
+        }
+    }
+    setSamplerParameters(image.levels.size() > 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return textureId;
+}
 
-    // 清理辅助工具
-    AImageDecoder_delete(pAndroidDecoder);
-    AAsset_close(pAndroidRobotPng);
+} // namespace
 
-    // 创建共享指针，以便易于/自动清理
-    return std::shared_ptr<TextureAsset>(new TextureAsset(textureId));
+std::atomic<bool> TextureAsset::astcSupported_{false};
+
+size_t CompressedImage::byteSize() const {
+    size_t bytes = 0;
+    for (const Level &level: levels) {
+        bytes += level.size;
+    }
+    return bytes;
 }
 
-void TextureAsset::processGltfFile(const std::string& gltfFilename) {
-    std::ifstream jsonFile(gltfFilename, std::ios::binary);
-    Json::Value json;
+// 加载资源的函数，使用共享指针管理TextureAsset资源
+std::shared_ptr<TextureAsset>
+TextureAsset::loadAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    LOGV("执行函数 loadAsset");
+    if (isKtx2Path(assetPath)) {
+        CompressedImage image;
+        if (!readKtx2Asset(assetManager, assetPath, image)) {
+            return nullptr;
+        }
+        return isFormatSupported(*image.format) ? upload(image) : upload(decompress(image));
+    }
+    DecodedImage image;
+    if (!decodeAsset(assetManager, assetPath, image)) {
+        return nullptr;
+    }
+    MipChain chain = TextureBaker::buildMipChain(image.width, image.height, std::move(image.pixels),
+                                                 colorMipOptions());
+    auto spTexture = upload(chain);
+    releasePixels(chain);
+    return spTexture;
+}
 
-    try {
-        jsonFile >> json;
-    } catch (const std::exception& e) {
-        std::cerr << "Json parsing error: " << e.what() << std::endl;
+std::shared_ptr<TextureAsset> TextureAsset::loadFromMemory(const uint8_t *data, size_t size) {
+    LOGV("执行函数 loadFromMemory");
+    DecodedImage image;
+    if (!decodeFromMemory(data, size, image)) {
+        return nullptr;
     }
-    jsonFile.close();
+    MipChain chain = TextureBaker::buildMipChain(image.width, image.height, std::move(image.pixels),
+                                                 colorMipOptions());
+    auto spTexture = upload(chain);
+    releasePixels(chain);
+    return spTexture;
+}
 
-    std::string binFilename = json["buffers"][0]["uri"].asString();
-    std::ifstream binFile(binFilename, std::ios::binary | std::ios::ate);
-    size_t binLength = binFile.tellg();
-    binFile.seekg(0);
+std::shared_ptr<TextureAsset> TextureAsset::loadAssetAsync(
+        AssetLoader &loader,
+        AAssetManager *assetManager,
+        const std::string &assetPath,
+        std::shared_ptr<TextureAsset> placeholder) {
+    auto spTexture = create(0);
+    spTexture->spPlaceholder_ = std::move(placeholder);
+
+    // 任务只持有弱引用，纹理在加载完成前被释放时跳过解码和上传
+    std::weak_ptr<TextureAsset> weakTexture = spTexture;
+    loader.submit([weakTexture, assetManager, assetPath]() -> AssetLoader::UploadTask {
+        if (weakTexture.expired()) {
+            return nullptr;
+        }
+        if (isKtx2Path(assetPath)) {
+            return loadKtx2Job(weakTexture, assetManager, assetPath, false);
+        }
+        DecodedImage image;
+        if (!decodeAsset(assetManager, assetPath, image)) {
+            return nullptr;
+        }
+        // mip链也在工作线程生成，GL线程只上传
+        auto chain = std::make_shared<MipChain>(TextureBaker::buildMipChain(
+                image.width, image.height, std::move(image.pixels), colorMipOptions()));
+        return [weakTexture, chain]() {
+            if (auto spTexture = weakTexture.lock()) {
+                spTexture->finishUpload(uploadMipChain(*chain), chain->bytesFrom(0));
+            }
+            releasePixels(*chain);
+        };
+    });
+    return spTexture;
+}
+
+std::shared_ptr<TextureAsset> TextureAsset::loadAssetStreamed(
+        AssetLoader &loader,
+        TextureStreamer &streamer,
+        AAssetManager *assetManager,
+        const std::string &assetPath,
+        std::shared_ptr<TextureAsset> placeholder) {
+    auto spTexture = create(0);
+    spTexture->spPlaceholder_ = std::move(placeholder);
+    spTexture->streamer_ = &streamer;
+
+    std::weak_ptr<TextureAsset> weakTexture = spTexture;
+    loader.submit([weakTexture, assetManager, assetPath]() -> AssetLoader::UploadTask {
+        if (weakTexture.expired()) {
+            return nullptr;
+        }
+        if (isKtx2Path(assetPath)) {
+            return loadKtx2Job(weakTexture, assetManager, assetPath, true);
+        }
+        DecodedImage image;
+        if (!decodeAsset(assetManager, assetPath, image)) {
+            return nullptr;
+        }
+        // 拆成每层一块内存，流送器上传一层就释放一层；连续的缓冲立即归还给池
+        MipChain chain = TextureBaker::buildMipChain(image.width, image.height, std::move(image.pixels),
+                                                     colorMipOptions());
+        auto streamed = std::make_shared<StreamedMipChain>(StreamedMipChain::split(chain));
+        releasePixels(chain);
+        return [weakTexture, streamed]() {
+            if (auto spTexture = weakTexture.lock()) {
+                spTexture->streamId_ = spTexture->streamer_->add(std::move(*streamed));
+                spTexture->spPlaceholder_.reset();
+            }
+        };
+    });
+    return spTexture;
+}
+
+std::function<void()> TextureAsset::loadKtx2Job(const std::weak_ptr<TextureAsset> &weakTexture,
+                                                AAssetManager *assetManager, const std::string &assetPath,
+                                                bool streamed) {
+    auto image = std::make_shared<CompressedImage>();
+    if (!readKtx2Asset(assetManager, assetPath, *image)) {
+        return nullptr;
+    }
+    // 流送器只处理RGBA8的mip链；GPU支持的压缩纹理本身已经小很多，整体上传
+    if (isFormatSupported(*image->format) && !(streamed && !image->format->isCompressed())) {
+        return [weakTexture, image]() {
+            if (auto spTexture = weakTexture.lock()) {
+                spTexture->finishUpload(uploadCompressedImage(*image), image->byteSize());
+            }
+        };
+    }
+    auto chain = std::make_shared<MipChain>(decompress(*image));
+    if (chain->levels.empty()) {
+        return nullptr;
+    }
+    if (streamed) {
+        auto levels = std::make_shared<StreamedMipChain>(StreamedMipChain::split(*chain));
+        return [weakTexture, levels]() {
+            if (auto spTexture = weakTexture.lock()) {
+                spTexture->streamId_ = spTexture->streamer_->add(std::move(*levels));
+                spTexture->spPlaceholder_.reset();
+            }
+        };
+    }
+    return [weakTexture, chain]() {
+        if (auto spTexture = weakTexture.lock()) {
+            spTexture->finishUpload(uploadMipChain(*chain), chain->bytesFrom(0));
+        }
+        releasePixels(*chain);
+    };
+}
 
-    std::vector<char> bin(binLength);
-    binFile.read(bin.data(), binLength);
-    binFile.close();
+void TextureAsset::finishUpload(GLuint textureId, size_t byteSize) {
+    textureID_ = textureId;
+    byteSize_ = byteSize;
+    // 不再需要占位纹理
+    spPlaceholder_.reset();
+}
 
-    Json::Value& primitive = json["meshes"][0]["primitives"][0];
-    Json::Value& positionAccessor = json["accessors"][primitive["attributes"]["POSITION"].asInt()];
-    Json::Value& bufferView = json["bufferViews"][positionAccessor["bufferView"].asInt()];
+bool TextureAsset::readKtx2Asset(AAssetManager *assetManager, const std::string &assetPath, CompressedImage &image) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->openAsset(assetManager, assetPath)) {
+        return false;
+    }
+    Ktx2File ktx2;
+    if (!ktx2.parse(file->data(), file->size())) {
+        LOGE("无法读取KTX2纹理 %s", assetPath.c_str());
+        return false;
+    }
+    const TextureFormat &format = ktx2.format();
+    image.format = &format;
+    image.width = ktx2.width();
+    image.height = ktx2.height();
+    image.levels.clear();
+    image.storage.clear();
+    image.file.reset();
+
+    bool supercompressed = ktx2.supercompression() != Ktx2Supercompression::None;
+    std::vector<uint8_t> scratch;
+    for (size_t level = 0; level < ktx2.levelCount(); level++) {
+        const uint8_t *data = nullptr;
+        if (!ktx2.levelData(level, scratch, data)) {
+            LOGE("无法解压KTX2纹理 %s", assetPath.c_str());
+            return false;
+        }
+        size_t size = format.levelSize(ktx2.levelWidth(level), ktx2.levelHeight(level));
+        if (supercompressed) {
+            image.storage.insert(image.storage.end(), data, data + size);
+        }
+        image.levels.push_back({data, size});
+    }
+    if (supercompressed) {
+        // 所有层级解压完后storage不再增长，这时才能取地址
+        const uint8_t *data = image.storage.data();
+        for (CompressedImage::Level &level: image.levels) {
+            level.data = data;
+            data += level.size;
+        }
+    } else {
+        image.file = std::move(file);
+    }
+    return true;
+}
 
-    float* buffer = (float*)(bin.data() + bufferView["byteOffset"].asInt());
+MipChain TextureAsset::decompress(const CompressedImage &image) {
+    const TextureFormat &format = *image.format;
+    std::vector<uint8_t> top(size_t(image.width) * image.height * 4);
+    if (!format.decompress(image.levels[0].data, image.levels[0].size, image.width, image.height, top.data())) {
+        return MipChain();
+    }
+    size_t fullLevels = 1;
+    while ((std::max(image.width, image.height) >> fullLevels) > 0) {
+        fullLevels++;
+    }
+    if (image.levels.size() < fullLevels) {
+        // 文件中的mip链不完整，在CPU上重新生成
+        return TextureBaker::buildMipChain(image.width, image.height, std::move(top), colorMipOptions());
+    }
+    MipChain chain = MipChain::allocate(image.width, image.height, std::move(top));
+    for (size_t level = 1; level < chain.levels.size(); level++) {
+        const MipChain::Level &mip = chain.levels[level];
+        if (!format.decompress(image.levels[level].data, image.levels[level].size, mip.width, mip.height,
+                               chain.pixels.data() + mip.offset)) {
+            return MipChain();
+        }
+    }
+    return chain;
+}
 
-    for (int i = 0; i < positionAccessor["count"].asInt(); ++i) {
-        std::cout << "(" << buffer[i*3] << ", " << buffer[i*3 + 1] << ", " << buffer[i*3 + 2] << ")" << std::endl;
+void TextureAsset::detectCompressedFormats() {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    bool astc = false;
+    for (GLint i = 0; i < count && !astc; i++) {
+        auto name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+        astc = name && strcmp(name, "GL_KHR_texture_compression_astc_ldr") == 0;
     }
+    astcSupported_ = astc;
+    LOGI("压缩纹理: ETC2 支持，ASTC %s", astc ? "支持" : "不支持，ASTC纹理将在CPU上解码");
+}
 
-    std::cout << "Vertices: " << positionAccessor["count"].asInt() << std::endl;
+bool TextureAsset::isFormatSupported(const TextureFormat &format) {
+    switch (format.codec) {
+        case TextureCodec::Rgba8:
+        case TextureCodec::Etc2:
+            return true;
+        case TextureCodec::Astc:
+            return astcSupported_;
+    }
+    return false;
 }
 
-void TextureAsset::processGlbFile(const std::string& glbFilename) {
-    std::ifstream binFile(glbFilename, std::ios::binary);
-    binFile.seekg(12);
+bool TextureAsset::isKtx2Path(const std::string &assetPath) {
+    static const std::string kExtension = ".ktx2";
+    return assetPath.size() >= kExtension.size()
+           && assetPath.compare(assetPath.size() - kExtension.size(), kExtension.size(), kExtension) == 0;
+}
 
-    uint32_t jsonLength;
-    binFile.read(reinterpret_cast<char*>(&jsonLength), sizeof(jsonLength));
+bool TextureAsset::decodeAsset(AAssetManager *assetManager, const std::string &assetPath, DecodedImage &image) {
+    // 资源以缓冲模式打开，未压缩存放的资源直接映射，解码器读映射的数据
+    MappedFile file;
+    if (!file.openAsset(assetManager, assetPath)) {
+        return false;
+    }
+    if (!decodeEncoded(file.data(), file.size(), image)) {
+        LOGE("无法解码纹理资源 %s", assetPath.c_str());
+        return false;
+    }
+    return true;
+}
 
-    std::string jsonStr(jsonLength, ' ');
-    binFile.seekg(20);
-    binFile.read(&jsonStr[0], jsonLength);
+bool TextureAsset::decodeFromMemory(const uint8_t *data, size_t size, DecodedImage &image) {
+    if (!decodeEncoded(data, size, image)) {
+        LOGE("无法解码内存中的图像（%zu字节）", size);
+        return false;
+    }
+    return true;
+}
 
-    Json::Value json;
-    Json::Reader reader;
-    if (!reader.parse(jsonStr, json)) {
-        std::cerr << "Problem parsing json: " << jsonStr << std::endl;
+bool TextureAsset::decodeEncoded(const uint8_t *data, size_t size, DecodedImage &image) {
+    if (!PngDecoder::isPng(data, size)) {
+        // JPEG、WebP等其他格式
+        AImageDecoder *pDecoder = nullptr;
+        return AImageDecoder_createFromBuffer(data, size, &pDecoder) == ANDROID_IMAGE_DECODER_SUCCESS
+               && decodeWith(pDecoder, image);
+    }
+    PngInfo info;
+    if (!PngDecoder::readInfo(data, size, info)) {
+        return false;
+    }
+    // 与AImageDecoder的设置相同：不预乘，保持sRGB编码，gamma校正留给mip生成
+    StagingBufferPool &pool = StagingBufferPool::shared();
+    image.width = info.width;
+    image.height = info.height;
+    size_t stride = size_t(info.width) * 4;
+    image.pixels = pool.acquire(stride * size_t(info.height), mipChainBytes(info.width, info.height));
+    if (!PngDecoder::decode(data, size, image.pixels.data(), stride, pool)) {
+        pool.release(std::move(image.pixels));
+        return false;
     }
+    return true;
+}
+
+bool TextureAsset::decodeWith(AImageDecoder *pAndroidDecoder, DecodedImage &image) {
+    // 确保输出是8位每通道的RGBA格式
+    AImageDecoder_setAndroidBitmapFormat(pAndroidDecoder, ANDROID_BITMAP_FORMAT_RGBA_8888);
+    // 默认输出预乘alpha，而渲染器按GL_SRC_ALPHA混合，mip生成也需要知道颜色的形式
+    AImageDecoder_setUnpremultipliedRequired(pAndroidDecoder, true);
+
+    // 获取图像头信息，帮助进行设置
+    const AImageDecoderHeaderInfo *pAndroidHeader = nullptr;
+    pAndroidHeader = AImageDecoder_getHeaderInfo(pAndroidDecoder);
 
-    uint32_t binLength;
-    binFile.read(reinterpret_cast<char*>(&binLength), sizeof(binLength));
-    binFile.seekg(sizeof(uint32_t), std::ios_base::cur);
+    // 重要的度量用于发送到GL
+    image.width = AImageDecoderHeaderInfo_getWidth(pAndroidHeader);
+    image.height = AImageDecoderHeaderInfo_getHeight(pAndroidHeader);
 
-    std::vector<char> bin(binLength);
-    binFile.read(bin.data(), binLength);
+    // RGBA_8888的最小行距就是宽度乘4，解码结果逐行紧密排列
+    auto stride = AImageDecoder_getMinimumStride(pAndroidDecoder);
+    StagingBufferPool &pool = StagingBufferPool::shared();
+    image.pixels = pool.acquire(image.height * stride, mipChainBytes(image.width, image.height));
+    auto decodeResult = AImageDecoder_decodeImage(
+            pAndroidDecoder,
+            image.pixels.data(),
+            stride,
+            image.pixels.size());
 
-    Json::Value& primitive = json["meshes"][0]["primitives"][0];
-    Json::Value& positionAccessor = json["accessors"][primitive["attributes"]["POSITION"].asInt()];
-    Json::Value& bufferView = json["bufferViews"][positionAccessor["bufferView"].asInt()];
+    // 清理辅助工具
+    AImageDecoder_delete(pAndroidDecoder);
+    if (decodeResult != ANDROID_IMAGE_DECODER_SUCCESS) {
+        pool.release(std::move(image.pixels));
+        return false;
+    }
+    return true;
+}
 
-    float* buffer = (float*)(bin.data() + bufferView["byteOffset"].asInt());
+MipBakeOptions TextureAsset::colorMipOptions() {
+    MipBakeOptions options;
+    options.filter = MipFilter::Kaiser;
+    options.srgb = true;
+    options.alphaMode = AlphaMode::Straight;
+    return options;
+}
 
-    for (int i = 0; i < positionAccessor["count"].asInt(); ++i) {
-        std::cout << "(" << buffer[i*3] << ", " << buffer[i*3 + 1] << ", " << buffer[i*3 + 2] << ")" << std::endl;
+std::shared_ptr<TextureAsset> TextureAsset::upload(const MipChain &chain) {
+    if (chain.levels.empty()) {
+        return nullptr;
     }
+    // 创建共享指针，以便易于/自动清理
+    auto spTexture = create(uploadMipChain(chain));
+    spTexture->byteSize_ = chain.bytesFrom(0);
+    return spTexture;
+}
 
-    std::cout << "Vertices: " << positionAccessor["count"].asInt() << std::endl;
+std::shared_ptr<TextureAsset> TextureAsset::upload(const CompressedImage &image) {
+    if (image.levels.empty()) {
+        return nullptr;
+    }
+    auto spTexture = create(uploadCompressedImage(image));
+    spTexture->byteSize_ = image.byteSize();
+    return spTexture;
 }
 
 TextureAsset::~TextureAsset() {
-    aout << "执行函数 ~TextureAsset" << std::endl;
+    LOGV("执行函数 ~TextureAsset");
+    if (streamId_ != TextureStreamer::kInvalidTexture) {
+        streamer_->remove(streamId_);
+        return;
+    }
     // 释放纹理资源
     glDeleteTextures(1, &textureID_);
     textureID_ = 0;
 }
+
+uint32_t GlTextureStreamBackend::create(const std::vector<MipChain::Level> &levels) {
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    // 整条mip链的不可变存储只分配这一次，之后只上传新驻留的层级并移动GL_TEXTURE_BASE_LEVEL
+    glTexStorage2D(GL_TEXTURE_2D, GLsizei(levels.size()), GL_RGBA8, levels[0].width, levels[0].height);
+    setSamplerParameters(true);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return textureId;
+}
+
+void GlTextureStreamBackend::upload(uint32_t handle, size_t level, const MipChain::Level &mip,
+                                    const uint8_t *pixels) {
+    glBindTexture(GL_TEXTURE_2D, handle);
+    glTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, mip.width, mip.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GlTextureStreamBackend::setBaseLevel(uint32_t handle, size_t level) {
+    // 比基础层级更精细的层级不参与采样，也不影响纹理的完整性，数据可以还没上传
+    glBindTexture(GL_TEXTURE_2D, handle);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, GLint(level));
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GlTextureStreamBackend::destroy(uint32_t handle) {
+    GLuint textureId = handle;
+    glDeleteTextures(1, &textureId);
+}
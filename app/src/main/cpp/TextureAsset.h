@@ -1,17 +1,59 @@
 #ifndef ANDROIDGLINVESTIGATIONS_TEXTUREASSET_H
 #define ANDROIDGLINVESTIGATIONS_TEXTUREASSET_H
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <android/asset_manager.h>
+#include <android/imagedecoder.h>
 #include <GLES3/gl3.h>
 #include <string>
 #include <vector>
 
+#include "MappedFile.h"
+#include "TextureBaker.h"
+#include "TextureFormat.h"
+#include "TextureStreamer.h"
+
+class AssetLoader;
+
+/*!
+ * 解码后的RGBA8图像，颜色没有预乘alpha。解码不需要GL上下文，可以在工作线程中完成，之后在GL线程上传
+ */
+struct DecodedImage {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> pixels; // 逐行紧密排列，每像素4字节
+};
+
+/*!
+ * 从KTX2文件读出的纹理，层级已经解除超压缩，可以直接交给glCompressedTexImage2D。
+ * 没有超压缩时层级直接指向映射的文件，不做拷贝
+ */
+struct CompressedImage {
+    struct Level {
+        const uint8_t *data;
+        size_t size;
+    };
+
+    const TextureFormat *format = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<Level> levels; // 第0层最大，可以不到1x1就结束
+    std::shared_ptr<MappedFile> file;
+    std::vector<uint8_t> storage; // zstd解压后的层级
+
+    //! 所有层级的字节数，也就是显存占用
+    size_t byteSize() const;
+};
+
 // 纹理资源类
 class TextureAsset {
 public:
     /*!
-     * 从assets/目录加载一个纹理资源
+     * 从assets/目录加载一个纹理资源。PNG由内置的 PngDecoder 解码，JPEG等其他图像交给AImageDecoder，
+     * mip链由 TextureBaker 在CPU上生成，像素缓冲从 StagingBufferPool::shared 取出，上传后归还；
+     * .ktx2文件使用其中的层级，GPU支持其格式时以压缩格式上传，否则在CPU上解码成RGBA8
      * @param assetManager 用于加载资源的AssetManager
      * @param assetPath 资源的路径
      * @return 返回一个纹理资源的共享指针，资源会在清理时被回收
@@ -19,15 +61,123 @@ public:
     static std::shared_ptr<TextureAsset>
     loadAsset(AAssetManager *assetManager, const std::string &assetPath);
 
-    void processGltfFile(const std::string &gltfFilename);
-    void processGlbFile(const std::string &glbFilename);
+    /*!
+     * 从内存中的PNG/JPEG等编码图像创建纹理，例如glTF中嵌入的图像
+     * @param data 编码后的图像数据
+     * @param size 数据字节数
+     * @return 解码失败时返回nullptr
+     */
+    static std::shared_ptr<TextureAsset> loadFromMemory(const uint8_t *data, size_t size);
+
+    /*!
+     * 在工作线程中读取、解码纹理并生成mip链，在GL线程上传。返回的纹理立即可用，上传完成前使用placeholder的纹理ID
+     * @param loader 执行读取和解码的加载器，上传在GL线程调用 AssetLoader::pumpUploads 时进行
+     * @param placeholder 上传完成前代替的纹理，解码失败时一直使用它
+     * @return 纹理句柄。上传前被释放的纹理不会再上传
+     */
+    static std::shared_ptr<TextureAsset> loadAssetAsync(
+            AssetLoader &loader,
+            AAssetManager *assetManager,
+            const std::string &assetPath,
+            std::shared_ptr<TextureAsset> placeholder);
+
+    /*!
+     * 流送加载：在工作线程解码并生成完整的mip链，拆成每层一块内存后交给流送器。流送器立即上传mip尾，
+     * 更精细的层级按 @a reportUsage 的反馈逐级上传，上传后释放CPU上的副本。上传前使用placeholder的纹理ID。
+     * 流送器只处理RGBA8，GPU支持的压缩KTX2纹理不经过流送器，整体上传
+     * @param streamer 流送器，生命周期必须长于返回的纹理
+     */
+    static std::shared_ptr<TextureAsset> loadAssetStreamed(
+            AssetLoader &loader,
+            TextureStreamer &streamer,
+            AAssetManager *assetManager,
+            const std::string &assetPath,
+            std::shared_ptr<TextureAsset> placeholder);
+
+    /*!
+     * 读取并解码assets/中的图像，不调用GL，可以在任意线程执行。
+     * image.pixels 取自 StagingBufferPool::shared ，容量已经预留到整条mip链
+     * @return 资源不存在或解码失败时返回false
+     */
+    static bool decodeAsset(AAssetManager *assetManager, const std::string &assetPath, DecodedImage &image);
+
+    //! 解码内存中的PNG/JPEG等编码图像，不调用GL，缓冲的来源与 decodeAsset 相同
+    static bool decodeFromMemory(const uint8_t *data, size_t size, DecodedImage &image);
+
+    /*!
+     * 读取assets/中的.ktx2文件并解除超压缩，不调用GL，可以在任意线程执行
+     * @return 文件无效、格式不支持或解压失败时返回false
+     */
+    static bool readKtx2Asset(AAssetManager *assetManager, const std::string &assetPath, CompressedImage &image);
+
+    /*!
+     * 在CPU上把压缩纹理解码成RGBA8的mip链，用于GPU不支持该格式的情况。
+     * 文件中的层级完整时逐级解码，否则只解码第0层并由 TextureBaker 生成其余层级
+     */
+    static MipChain decompress(const CompressedImage &image);
+
+    /*!
+     * 查询GPU支持的压缩格式，必须在GL上下文创建后、加载KTX2纹理前在GL线程调用一次。
+     * ETC2是GLES 3.0的核心格式，ASTC需要GL_KHR_texture_compression_astc_ldr扩展
+     */
+    static void detectCompressedFormats();
+
+    //! @return GPU能否直接使用该格式，可以在任意线程调用
+    static bool isFormatSupported(const TextureFormat &format);
+
+    //! @return 路径是否以.ktx2结尾
+    static bool isKtx2Path(const std::string &assetPath);
+
+    //! 颜色纹理生成mip链的选项：sRGB、直通alpha，与GL_SRC_ALPHA混合一致
+    static MipBakeOptions colorMipOptions();
+
+    /*!
+     * 上传预先生成的mip链，不再调用glGenerateMipmap。必须在GL线程调用
+     */
+    static std::shared_ptr<TextureAsset> upload(const MipChain &chain);
+
+    /*!
+     * 用glCompressedTexSubImage2D上传压缩纹理的全部层级，格式必须被GPU支持。必须在GL线程调用
+     */
+    static std::shared_ptr<TextureAsset> upload(const CompressedImage &image);
 
     ~TextureAsset(); // 析构函数，用于资源清理
 
     /*!
      * @return 返回用于OpenGL的纹理ID
      */
-    constexpr GLuint getTextureID() const { return textureID_; }
+    inline GLuint getTextureID() const {
+        if (streamId_ != TextureStreamer::kInvalidTexture) {
+            return streamer_->handle(streamId_);
+        }
+        return textureID_ != 0 || !spPlaceholder_ ? textureID_ : spPlaceholder_->getTextureID();
+    }
+
+    //! @return 异步加载的纹理是否已经上传，同步创建的纹理总是true
+    inline bool isReady() const { return textureID_ != 0 || streamId_ != TextureStreamer::kInvalidTexture; }
+
+    /*!
+     * @return 纹理占用的显存字节数（包括mip层级），上传前为0。只能在GL线程调用
+     */
+    inline size_t getByteSize() const {
+        return streamId_ != TextureStreamer::kInvalidTexture ? streamer_->residentBytes(streamId_) : byteSize_;
+    }
+
+    /*!
+     * 不再引用占位纹理，还没上传的纹理之后的纹理ID为0。
+     * 占位纹理可能是 TextureCache 的句柄，缓存销毁前用它断开缓存内纹理之间的引用
+     */
+    inline void releasePlaceholder() { spPlaceholder_.reset(); }
+
+    /*!
+     * 报告纹理本帧在屏幕上的大小，流送的纹理据此决定驻留层级，其他纹理忽略
+     * @param screenPixels 纹理长边映射到屏幕上的像素数
+     */
+    inline void reportUsage(float screenPixels) const {
+        if (streamId_ != TextureStreamer::kInvalidTexture) {
+            streamer_->reportUsage(streamId_, screenPixels);
+        }
+    }
 
     // 创建一个单色的纹理
     static std::shared_ptr<TextureAsset> createSolidColorTexture(GLubyte r, GLubyte g, GLubyte b, GLubyte a) {
@@ -49,16 +199,59 @@ public:
         glBindTexture(GL_TEXTURE_2D, 0);
 
         // 创建并返回TextureAsset对象
-        return create(textureId);
+        auto spTexture = create(textureId);
+        spTexture->byteSize_ = sizeof(pixel);
+        return spTexture;
     }
 
 private:
+    //! PNG用 PngDecoder 解码，其他格式交给AImageDecoder，失败时不输出日志
+    static bool decodeEncoded(const uint8_t *data, size_t size, DecodedImage &image);
+
+    /*!
+     * 用解码器解码到RGBA8图像，之后删除解码器
+     */
+    static bool decodeWith(AImageDecoder *pDecoder, DecodedImage &image);
+
+    /*!
+     * 异步加载.ktx2的工作线程部分：读取文件，GPU不支持其格式时在这里解码
+     * @param streamed 为true时RGBA8的结果交给纹理的流送器
+     * @return 在GL线程执行的上传任务，失败时为空
+     */
+    static std::function<void()> loadKtx2Job(const std::weak_ptr<TextureAsset> &weakTexture,
+                                              AAssetManager *assetManager, const std::string &assetPath,
+                                              bool streamed);
+
+    //! 上传完成后替换占位纹理
+    void finishUpload(GLuint textureId, size_t byteSize);
+
     inline TextureAsset(GLuint textureId) : textureID_(textureId) {} // 构造函数，私有化以限制创建方式
     static std::shared_ptr<TextureAsset> create(GLuint textureId) {
         return std::shared_ptr<TextureAsset>(new TextureAsset(textureId));
     }
 
-    GLuint textureID_; // OpenGL纹理ID
+    GLuint textureID_; // OpenGL纹理ID，异步加载的纹理上传前为0
+    std::shared_ptr<TextureAsset> spPlaceholder_; // 异步加载完成前代替的纹理
+    size_t byteSize_ = 0; // 非流送纹理的显存字节数
+    TextureStreamer *streamer_ = nullptr; // 流送的纹理由流送器管理GL纹理
+    TextureStreamer::TextureId streamId_ = TextureStreamer::kInvalidTexture;
+
+    static std::atomic<bool> astcSupported_; // 由 detectCompressedFormats 设置
+};
+
+/*!
+ * TextureStreamer 的GL后端：加入时按整条mip链分配一次不可变存储，之后逐层上传，
+ * 用GL_TEXTURE_BASE_LEVEL限制采样的最精细层级
+ */
+class GlTextureStreamBackend : public TextureStreamBackend {
+public:
+    uint32_t create(const std::vector<MipChain::Level> &levels) override;
+
+    void upload(uint32_t handle, size_t level, const MipChain::Level &mip, const uint8_t *pixels) override;
+
+    void setBaseLevel(uint32_t handle, size_t level) override;
+
+    void destroy(uint32_t handle) override;
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_TEXTUREASSET_H
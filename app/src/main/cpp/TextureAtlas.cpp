@@ -0,0 +1,357 @@
+#include "TextureAtlas.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+// 排布以对齐单位为一格，坐标和尺寸都是格数
+struct Cell {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+/*!
+ * 天际线排布：记录已放置的图形成的上轮廓，新的图放在使它顶边最低的位置，轮廓以下的空洞不再使用
+ */
+class SkylinePacker {
+public:
+    SkylinePacker(int32_t width, int32_t height) : width_(width), height_(height), skyline_{{0, 0, width}} {}
+
+    bool insert(int32_t width, int32_t height, Cell &cell) {
+        size_t bestIndex = skyline_.size();
+        int32_t bestTop = INT32_MAX;
+        int32_t bestY = 0;
+        for (size_t i = 0; i < skyline_.size(); i++) {
+            int32_t y;
+            // 顶边相同时靠左，段是按x排列的，先找到的就是最左的
+            if (fit(i, width, height, y) && y + height < bestTop) {
+                bestIndex = i;
+                bestTop = y + height;
+                bestY = y;
+            }
+        }
+        if (bestIndex == skyline_.size()) {
+            return false;
+        }
+        cell = {skyline_[bestIndex].x, bestY, width, height};
+        place(bestIndex, cell);
+        return true;
+    }
+
+private:
+    struct Segment {
+        int32_t x;
+        int32_t y;
+        int32_t width;
+    };
+
+    // 从第index段的左端开始放宽为width的图，y是它下方各段的最高点
+    bool fit(size_t index, int32_t width, int32_t height, int32_t &y) const {
+        int32_t left = skyline_[index].x;
+        if (left + width > width_) {
+            return false;
+        }
+        y = 0;
+        for (size_t i = index; i < skyline_.size() && skyline_[i].x < left + width; i++) {
+            y = std::max(y, skyline_[i].y);
+            if (y + height > height_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void place(size_t index, const Cell &cell) {
+        int32_t right = cell.x + cell.width;
+        skyline_.insert(skyline_.begin() + index, Segment{cell.x, cell.y + cell.height, cell.width});
+        // 被新段盖住的段删掉，部分盖住的截短
+        size_t i = index + 1;
+        while (i < skyline_.size() && skyline_[i].x < right) {
+            Segment &segment = skyline_[i];
+            if (segment.x + segment.width <= right) {
+                skyline_.erase(skyline_.begin() + i);
+                continue;
+            }
+            segment.width -= right - segment.x;
+            segment.x = right;
+            break;
+        }
+        // 合并高度相同的相邻段
+        for (size_t j = 0; j + 1 < skyline_.size();) {
+            if (skyline_[j].y == skyline_[j + 1].y) {
+                skyline_[j].width += skyline_[j + 1].width;
+                skyline_.erase(skyline_.begin() + j + 1);
+            } else {
+                j++;
+            }
+        }
+    }
+
+    int32_t width_;
+    int32_t height_;
+    std::vector<Segment> skyline_; // 按x排列，覆盖整个页面宽度
+};
+
+/*!
+ * 最大矩形排布：记录所有极大的空闲矩形（可以互相重叠），按短边剩余最少选择位置，
+ * 放置后切分与它相交的空闲矩形，再删去被其他空闲矩形包含的
+ */
+class MaxRectsPacker {
+public:
+    MaxRectsPacker(int32_t width, int32_t height) : free_{{0, 0, width, height}} {}
+
+    bool insert(int32_t width, int32_t height, Cell &cell) {
+        int32_t bestTop = INT32_MAX;
+        int32_t bestX = INT32_MAX;
+        for (const Cell &rect: free_) {
+            if (rect.width < width || rect.height < height) {
+                continue;
+            }
+            // 顶边最低，其次最靠左
+            int32_t top = rect.y + height;
+            if (top < bestTop || (top == bestTop && rect.x < bestX)) {
+                bestTop = top;
+                bestX = rect.x;
+                cell = {rect.x, rect.y, width, height};
+            }
+        }
+        if (bestTop == INT32_MAX) {
+            return false;
+        }
+        place(cell);
+        return true;
+    }
+
+private:
+    static bool intersects(const Cell &a, const Cell &b) {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    static bool contains(const Cell &outer, const Cell &inner) {
+        return inner.x >= outer.x && inner.y >= outer.y
+               && inner.x + inner.width <= outer.x + outer.width
+               && inner.y + inner.height <= outer.y + outer.height;
+    }
+
+    void place(const Cell &used) {
+        split_.clear();
+        size_t kept = 0;
+        for (const Cell &rect: free_) {
+            if (!intersects(rect, used)) {
+                free_[kept++] = rect;
+                continue;
+            }
+            // 空闲矩形在已用矩形四边以外的部分，最多4个
+            if (used.x > rect.x) {
+                split_.push_back({rect.x, rect.y, used.x - rect.x, rect.height});
+            }
+            if (used.x + used.width < rect.x + rect.width) {
+                int32_t right = used.x + used.width;
+                split_.push_back({right, rect.y, rect.x + rect.width - right, rect.height});
+            }
+            if (used.y > rect.y) {
+                split_.push_back({rect.x, rect.y, rect.width, used.y - rect.y});
+            }
+            if (used.y + used.height < rect.y + rect.height) {
+                int32_t bottom = used.y + used.height;
+                split_.push_back({rect.x, bottom, rect.width, rect.y + rect.height - bottom});
+            }
+        }
+        free_.resize(kept);
+        // 原有的空闲矩形互不包含，新切出的矩形又都在某个原有矩形之内，所以原有的不会被新的包含，
+        // 只需删去被其他矩形包含的新矩形；相同的新矩形保留第一个
+        for (size_t i = 0; i < split_.size(); i++) {
+            const Cell &piece = split_[i];
+            bool redundant = false;
+            for (size_t j = 0; j < kept && !redundant; j++) {
+                redundant = contains(free_[j], piece);
+            }
+            for (size_t j = 0; j < split_.size() && !redundant; j++) {
+                redundant = j != i && contains(split_[j], piece) && (j < i || !contains(piece, split_[j]));
+            }
+            if (!redundant) {
+                free_.push_back(piece);
+            }
+        }
+    }
+
+    std::vector<Cell> free_;
+    std::vector<Cell> split_; // place 中切分用的缓冲，每次复用
+};
+
+int32_t roundUp(int32_t value, int32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/*!
+ * 按尺寸从大到小依次放进第一个放得下的页面，都放不下时开新页
+ * @param boxes 每张图外框的格数，输出时填上位置
+ * @param boxPages 输出每张图所在的页
+ * @return 页数
+ */
+template<typename Packer>
+uint32_t packBoxes(std::vector<Cell> &boxes, const std::vector<uint32_t> &order, int32_t pageCells,
+                   std::vector<uint32_t> &boxPages) {
+    std::vector<Packer> packers;
+    for (uint32_t index: order) {
+        Cell &box = boxes[index];
+        uint32_t page = 0;
+        while (page < packers.size() && !packers[page].insert(box.width, box.height, box)) {
+            page++;
+        }
+        if (page == packers.size()) {
+            packers.emplace_back(pageCells, pageCells);
+            packers.back().insert(box.width, box.height, box);
+        }
+        boxPages[index] = page;
+    }
+    return uint32_t(packers.size());
+}
+
+/*!
+ * 把图拷进页面中的外框，外框里图以外的部分都复制最近的边缘像素
+ */
+void copyExtruded(const AtlasImage &image, uint8_t *page, int32_t pageWidth,
+                  int32_t boxX, int32_t boxY, int32_t boxWidth, int32_t boxHeight, int32_t padding) {
+    size_t rowBytes = size_t(image.width) * 4;
+    for (int32_t row = 0; row < boxHeight; row++) {
+        int32_t sourceRow = std::min(std::max(row - padding, 0), image.height - 1);
+        const uint8_t *source = image.rgba + size_t(sourceRow) * rowBytes;
+        uint8_t *out = page + (size_t(boxY + row) * size_t(pageWidth) + size_t(boxX)) * 4;
+        int32_t right = boxWidth - padding - image.width;
+        for (int32_t i = 0; i < padding; i++) {
+            memcpy(out + i * 4, source, 4);
+        }
+        memcpy(out + padding * 4, source, rowBytes);
+        uint8_t *tail = out + (padding + image.width) * 4;
+        for (int32_t i = 0; i < right; i++) {
+            memcpy(tail + i * 4, source + rowBytes - 4, 4);
+        }
+    }
+}
+
+} // namespace
+
+bool TextureAtlas::pack(const std::vector<AtlasImage> &images, const AtlasOptions &options, AtlasLayout &layout) {
+    int32_t padding = std::max(0, options.padding);
+    int32_t alignment = 1;
+    layout.mipLevels = 1;
+    while (alignment * 2 <= padding) {
+        alignment *= 2;
+        layout.mipLevels++;
+    }
+    int32_t pageCells = options.maxPageSize / alignment;
+
+    std::vector<Cell> boxes(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        const AtlasImage &image = images[i];
+        if (image.width <= 0 || image.height <= 0) {
+            LOGE("图集中第%zu张图的尺寸无效: %dx%d", i, image.width, image.height);
+            return false;
+        }
+        Cell &box = boxes[i];
+        box.width = roundUp(image.width + padding * 2, alignment) / alignment;
+        box.height = roundUp(image.height + padding * 2, alignment) / alignment;
+        if (box.width > pageCells || box.height > pageCells) {
+            LOGE("图集中第%zu张图加上间隔超过页面大小: %dx%d > %d", i, image.width, image.height,
+                 options.maxPageSize);
+            return false;
+        }
+    }
+
+    // 长边大的先放，长边相同时短边大的先放
+    std::vector<uint32_t> order(images.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        int32_t longA = std::max(boxes[a].width, boxes[a].height);
+        int32_t longB = std::max(boxes[b].width, boxes[b].height);
+        if (longA != longB) {
+            return longA > longB;
+        }
+        return std::min(boxes[a].width, boxes[a].height) > std::min(boxes[b].width, boxes[b].height);
+    });
+
+    std::vector<uint32_t> boxPages(images.size());
+    uint32_t pageCount = options.packing == AtlasPacking::Skyline
+                         ? packBoxes<SkylinePacker>(boxes, order, pageCells, boxPages)
+                         : packBoxes<MaxRectsPacker>(boxes, order, pageCells, boxPages);
+
+    // 每页裁到实际用到的范围，仍是对齐单位的倍数
+    layout.pages.assign(pageCount, AtlasPage{});
+    for (size_t i = 0; i < images.size(); i++) {
+        AtlasPage &page = layout.pages[boxPages[i]];
+        page.width = std::max(page.width, (boxes[i].x + boxes[i].width) * alignment);
+        page.height = std::max(page.height, (boxes[i].y + boxes[i].height) * alignment);
+        page.imagePixels += size_t(images[i].width) * size_t(images[i].height);
+    }
+
+    layout.regions.resize(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        const AtlasPage &page = layout.pages[boxPages[i]];
+        AtlasRegion &region = layout.regions[i];
+        region.page = boxPages[i];
+        region.x = boxes[i].x * alignment + padding;
+        region.y = boxes[i].y * alignment + padding;
+        region.width = images[i].width;
+        region.height = images[i].height;
+        region.uvScale = Vector2{float(region.width) / float(page.width), float(region.height) / float(page.height)};
+        region.uvOffset = Vector2{float(region.x) / float(page.width), float(region.y) / float(page.height)};
+    }
+    return true;
+}
+
+bool TextureAtlas::build(const std::vector<AtlasImage> &images, const AtlasOptions &options,
+                         AtlasLayout &layout, std::vector<MipChain> &pages) {
+    if (!pack(images, options, layout)) {
+        return false;
+    }
+    int32_t padding = std::max(0, options.padding);
+    int32_t alignment = 1 << (layout.mipLevels - 1);
+
+    std::vector<std::vector<uint8_t>> pixels(layout.pages.size());
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i].assign(size_t(layout.pages[i].width) * size_t(layout.pages[i].height) * 4, 0);
+    }
+    for (size_t i = 0; i < images.size(); i++) {
+        const AtlasImage &image = images[i];
+        if (!image.rgba) {
+            LOGE("图集中第%zu张图没有像素", i);
+            return false;
+        }
+        const AtlasRegion &region = layout.regions[i];
+        copyExtruded(image, pixels[region.page].data(), layout.pages[region.page].width,
+                     region.x - padding, region.y - padding,
+                     roundUp(image.width + padding * 2, alignment), roundUp(image.height + padding * 2, alignment),
+                     padding);
+    }
+
+    // 盒式滤波只合并对齐的2x2块，宽滤波器会跨过外框读到相邻的图
+    MipBakeOptions mipOptions = options.mipOptions;
+    mipOptions.filter = MipFilter::Box;
+    pages.clear();
+    for (size_t i = 0; i < pixels.size(); i++) {
+        const AtlasPage &page = layout.pages[i];
+        pages.push_back(TextureBaker::buildMipChain(page.width, page.height, std::move(pixels[i]), mipOptions));
+        MipChain &chain = pages.back();
+        if (chain.levels.size() > layout.mipLevels) {
+            chain.pixels.resize(chain.levels[layout.mipLevels].offset);
+            chain.levels.resize(layout.mipLevels);
+        }
+    }
+    return true;
+}
+
+void TextureAtlas::remapUVs(std::vector<Vertex> &vertices, const AtlasRegion &region) {
+    for (Vertex &vertex: vertices) {
+        Vector2 uv{std::min(std::max(vertex.uv.u, 0.f), 1.f), std::min(std::max(vertex.uv.v, 0.f), 1.f)};
+        vertex.uv = region.transform(uv);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TEXTUREATLAS_H
+#define ANDROIDGLINVESTIGATIONS_TEXTUREATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TextureBaker.h"
+#include "VertexFormat.h"
+
+enum class AtlasPacking {
+    Skyline,  // 天际线，放在最低的位置；只记录轮廓，排布很快，尺寸相近的图空间利用率也不错
+    MaxRects, // 最大矩形，短边最佳适配；记录所有空闲矩形，更省空间，但图多时更慢
+};
+
+struct AtlasOptions {
+    int32_t maxPageSize = 2048; // 页面的最大边长，最后每页按实际用到的范围裁小
+    int32_t padding = 4;        // 每张图四周复制边缘像素的宽度（第0层的像素）
+    AtlasPacking packing = AtlasPacking::MaxRects;
+    MipBakeOptions mipOptions;  // 生成页面mip链的选项，滤波器总是使用 MipFilter::Box
+};
+
+/*!
+ * 一张图在图集中的位置
+ */
+struct AtlasRegion {
+    uint32_t page = 0;
+    int32_t x = 0;      // 在页面第0层中的像素矩形，不含四周的间隔
+    int32_t y = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    Vector2 uvScale{1.f, 1.f}; // 原来[0, 1]的uv乘以uvScale再加uvOffset就是页面中的uv
+    Vector2 uvOffset{0.f, 0.f};
+
+    inline Vector2 transform(const Vector2 &uv) const {
+        return Vector2{uv.u * uvScale.u + uvOffset.u, uv.v * uvScale.v + uvOffset.v};
+    }
+};
+
+struct AtlasPage {
+    int32_t width = 0;
+    int32_t height = 0;
+    size_t imagePixels = 0; // 页面中各图（不含间隔）的像素总数，用于统计利用率
+};
+
+struct AtlasLayout {
+    std::vector<AtlasRegion> regions; // 与输入的图一一对应
+    std::vector<AtlasPage> pages;
+    uint32_t mipLevels = 1;           // 每页mip链的层数，最粗的一层里每张图仍有至少1个像素的间隔
+};
+
+//! 输入的图，像素不被持有
+struct AtlasImage {
+    int32_t width = 0;
+    int32_t height = 0;
+    const uint8_t *rgba = nullptr; // 逐行紧密排列的RGBA8，只排布时可以为空
+};
+
+/*!
+ * 把许多小纹理排进共享的页面，共用一个页面的模型可以连续绘制而不切换纹理。
+ *
+ * 每张图四周复制边缘像素作为间隔，防止双线性过滤读到相邻的图。间隔为p时，
+ * 图连同间隔的外框按不超过p的最大2的幂A对齐、尺寸补齐到A的倍数，第k层的2x2盒式滤波
+ * 只会合并同一个外框里的像素，每张图在第k层还有 p / 2^k 个像素的间隔。
+ * mip链截断到间隔还剩1个像素的那一层（A=4时共3层），更粗的层会混入相邻的图。
+ *
+ * 页面使用GL_CLAMP_TO_EDGE，图集里的纹理不能依赖重复寻址，uv必须在[0, 1]内。
+ * 不调用GL，可以在工作线程或主机上的离线工具中运行
+ */
+class TextureAtlas {
+public:
+    /*!
+     * 只排布尺寸，不处理像素
+     * @return 有图连同间隔超过 maxPageSize 时返回false
+     */
+    static bool pack(const std::vector<AtlasImage> &images, const AtlasOptions &options, AtlasLayout &layout);
+
+    /*!
+     * 排布所有图，把像素连同间隔拷进页面，再生成每页截断后的mip链
+     * @param pages 输出，与 layout.pages 一一对应，可以直接交给 TextureAsset::upload
+     * @return 失败时返回false
+     */
+    static bool build(const std::vector<AtlasImage> &images, const AtlasOptions &options,
+                      AtlasLayout &layout, std::vector<MipChain> &pages);
+
+    /*!
+     * 把顶点的uv改写成页面中的uv，超出[0, 1]的uv先截断，不会采样到相邻的图。
+     * 在构造 Model 之前调用，量化布局的uv仍在[0, 1]内
+     */
+    static void remapUVs(std::vector<Vertex> &vertices, const AtlasRegion &region);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TEXTUREATLAS_H
@@ -0,0 +1,418 @@
+#include "TextureBaker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "VecMath.h"
+
+namespace {
+
+constexpr int kMaxTaps = 6;
+constexpr int kPad = 3;            // 横向缓冲两侧复制的边缘像素数，6抽头在宽度为1时也不会越界
+constexpr int kRingRows = 8;       // 纵向窗口最多6行，环形缓冲取2的幂
+constexpr int kEncodeSteps = 4095; // 线性->sRGB查找表按sqrt(线性值)均匀分布，暗部足够精细
+constexpr int kCoverageBins = 4096;
+constexpr float kTinyAlpha = 1e-20f;
+
+struct FilterKernel {
+    int taps;
+    int offset; // 第一个抽头相对源像素2x的偏移
+    float weights[kMaxTaps];
+};
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+FilterKernel makeKaiserKernel() {
+    const double kPi = 3.14159265358979323846;
+    const double kBeta = 4.0;
+    const double kRadius = 3.0;
+    FilterKernel kernel{kMaxTaps, -2, {}};
+    double weights[kMaxTaps];
+    double total = 0.0;
+    for (int k = 0; k < kMaxTaps; k++) {
+        // 抽头到输出像素中心（源坐标2x+0.5）的距离，缩小一半时sinc的截止频率也减半
+        double d = k - 2.5;
+        double x = d / 2.0;
+        double sinc = std::sin(kPi * x) / (kPi * x);
+        double t = d / kRadius;
+        weights[k] = sinc * besselI0(kBeta * std::sqrt(1.0 - t * t)) / besselI0(kBeta);
+        total += weights[k];
+    }
+    for (int k = 0; k < kMaxTaps; k++) {
+        kernel.weights[k] = float(weights[k] / total);
+    }
+    return kernel;
+}
+
+const FilterKernel &kernelFor(MipFilter filter) {
+    static const FilterKernel kBox{2, 0, {0.5f, 0.5f}};
+    static const FilterKernel kKaiser = makeKaiserKernel();
+    return filter == MipFilter::Kaiser ? kKaiser : kBox;
+}
+
+struct ColorTables {
+    float toLinear[256];                 // sRGB编码 -> 线性
+    float toUnit[256];                   // i / 255
+    uint8_t toSrgb[kEncodeSteps + 1];    // 下标为 sqrt(线性值) * 4095 四舍五入
+};
+
+const ColorTables &colorTables() {
+    static const ColorTables tables = [] {
+        ColorTables t{};
+        for (int i = 0; i < 256; i++) {
+            double c = i / 255.0;
+            t.toLinear[i] = float(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+            t.toUnit[i] = float(c);
+        }
+        for (int i = 0; i <= kEncodeSteps; i++) {
+            double s = double(i) / kEncodeSteps;
+            double linear = s * s;
+            double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+            t.toSrgb[i] = uint8_t(std::lround(std::min(1.0, std::max(0.0, c)) * 255.0));
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// 标量实现与SIMD实现使用完全相同的运算顺序，结果逐位一致
+struct ScalarOps {
+    struct F4 {
+        float v[4];
+    };
+
+    static inline F4 load(const float *p) { return F4{{p[0], p[1], p[2], p[3]}}; }
+
+    static inline void store(float *p, F4 a) {
+        for (int i = 0; i < 4; i++) p[i] = a.v[i];
+    }
+
+    static inline F4 set1(float x) { return F4{{x, x, x, x}}; }
+
+    static inline F4 splatAlpha(F4 a) { return set1(a.v[3]); }
+
+    static inline F4 add(F4 a, F4 b) {
+        for (int i = 0; i < 4; i++) a.v[i] += b.v[i];
+        return a;
+    }
+
+    static inline F4 mul(F4 a, F4 b) {
+        for (int i = 0; i < 4; i++) a.v[i] *= b.v[i];
+        return a;
+    }
+
+    static inline F4 div(F4 a, F4 b) {
+        for (int i = 0; i < 4; i++) a.v[i] /= b.v[i];
+        return a;
+    }
+
+    static inline F4 min(F4 a, F4 b) {
+        for (int i = 0; i < 4; i++) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+
+    static inline F4 max(F4 a, F4 b) {
+        for (int i = 0; i < 4; i++) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+
+    static inline F4 sqrt(F4 a) {
+        for (int i = 0; i < 4; i++) a.v[i] = std::sqrt(a.v[i]);
+        return a;
+    }
+
+    // 向零截断，输入总是非负
+    static inline void toInt(F4 a, int32_t *out) {
+        for (int i = 0; i < 4; i++) out[i] = int32_t(a.v[i]);
+    }
+};
+
+#if VECMATH_SSE
+
+struct SimdOps {
+    using F4 = __m128;
+
+    static inline F4 load(const float *p) { return _mm_loadu_ps(p); }
+    static inline void store(float *p, F4 a) { _mm_storeu_ps(p, a); }
+    static inline F4 set1(float x) { return _mm_set1_ps(x); }
+    static inline F4 splatAlpha(F4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)); }
+    static inline F4 add(F4 a, F4 b) { return _mm_add_ps(a, b); }
+    static inline F4 mul(F4 a, F4 b) { return _mm_mul_ps(a, b); }
+    static inline F4 div(F4 a, F4 b) { return _mm_div_ps(a, b); }
+    static inline F4 min(F4 a, F4 b) { return _mm_min_ps(a, b); }
+    static inline F4 max(F4 a, F4 b) { return _mm_max_ps(a, b); }
+    static inline F4 sqrt(F4 a) { return _mm_sqrt_ps(a); }
+    static inline void toInt(F4 a, int32_t *out) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_cvttps_epi32(a));
+    }
+};
+
+#elif VECMATH_NEON
+
+struct SimdOps {
+    using F4 = float32x4_t;
+
+    static inline F4 load(const float *p) { return vld1q_f32(p); }
+    static inline void store(float *p, F4 a) { vst1q_f32(p, a); }
+    static inline F4 set1(float x) { return vdupq_n_f32(x); }
+    static inline F4 splatAlpha(F4 a) { return vdupq_laneq_f32(a, 3); }
+    static inline F4 add(F4 a, F4 b) { return vaddq_f32(a, b); }
+    static inline F4 mul(F4 a, F4 b) { return vmulq_f32(a, b); }
+    static inline F4 div(F4 a, F4 b) { return vdivq_f32(a, b); }
+    static inline F4 min(F4 a, F4 b) { return vminq_f32(a, b); }
+    static inline F4 max(F4 a, F4 b) { return vmaxq_f32(a, b); }
+    static inline F4 sqrt(F4 a) { return vsqrtq_f32(a); }
+    static inline void toInt(F4 a, int32_t *out) { vst1q_s32(out, vcvtq_s32_f32(a)); }
+};
+
+#else
+
+using SimdOps = ScalarOps;
+
+#endif
+
+/*!
+ * 把一行RGBA8解码成线性、预乘的float
+ */
+void decodeRow(const uint8_t *src, float *dst, int32_t count, const MipBakeOptions &options) {
+    const ColorTables &tables = colorTables();
+    const float *color = options.srgb ? tables.toLinear : tables.toUnit;
+    bool straight = options.alphaMode == AlphaMode::Straight;
+    for (int32_t i = 0; i < count; i++, src += 4, dst += 4) {
+        uint8_t alpha8 = src[3];
+        float alpha = tables.toUnit[alpha8];
+        for (int c = 0; c < 3; c++) {
+            if (straight) {
+                dst[c] = color[src[c]] * alpha;
+            } else if (options.srgb) {
+                // 输入在编码空间预乘，先还原编码值再转到线性空间预乘
+                int unpremultiplied = alpha8 ? std::min(255, (src[c] * 255 + alpha8 / 2) / alpha8) : 0;
+                dst[c] = tables.toLinear[unpremultiplied] * alpha;
+            } else {
+                dst[c] = tables.toUnit[src[c]];
+            }
+        }
+        dst[3] = alpha;
+    }
+}
+
+// 生成下一层的源层级：浮点层级直接取行，第0层按需解码到环形缓冲
+struct LevelSource {
+    int32_t width;
+    int32_t height;
+    const float *pixels;
+    const uint8_t *rgba;
+    const MipBakeOptions *options;
+    float *ring;
+    int32_t ringRows[kRingRows];
+
+    const float *row(int32_t y) {
+        size_t stride = size_t(width) * 4;
+        if (pixels) {
+            return pixels + size_t(y) * stride;
+        }
+        int slot = y & (kRingRows - 1);
+        float *dst = ring + slot * stride;
+        if (ringRows[slot] != y) {
+            decodeRow(rgba + size_t(y) * stride, dst, width, *options);
+            ringRows[slot] = y;
+        }
+        return dst;
+    }
+};
+
+/*!
+ * 先纵向把源层级的若干行合成一行放进column，再横向生成一行目标像素。
+ * 结果截断到[0, 1]且颜色不超过alpha，Kaiser的负瓣不会产生非法的预乘颜色
+ */
+template<typename Ops>
+void downsample(LevelSource &source, const FilterKernel &kernel, float *dst, int32_t width, int32_t height,
+                float *column) {
+    using F4 = typename Ops::F4;
+    F4 weights[kMaxTaps];
+    for (int t = 0; t < kernel.taps; t++) {
+        weights[t] = Ops::set1(kernel.weights[t]);
+    }
+    const F4 zero = Ops::set1(0.f);
+    const F4 one = Ops::set1(1.f);
+    const int32_t sourceWidth = source.width;
+    float *middle = column + kPad * 4;
+
+    for (int32_t y = 0; y < height; y++) {
+        const float *rows[kMaxTaps];
+        for (int t = 0; t < kernel.taps; t++) {
+            int32_t sy = source.height > 1 ? 2 * y + kernel.offset + t : 0;
+            rows[t] = source.row(std::min(std::max(sy, 0), source.height - 1));
+        }
+        for (int32_t x = 0; x < sourceWidth; x++) {
+            F4 sum = Ops::mul(Ops::load(rows[0] + x * 4), weights[0]);
+            for (int t = 1; t < kernel.taps; t++) {
+                sum = Ops::add(sum, Ops::mul(Ops::load(rows[t] + x * 4), weights[t]));
+            }
+            Ops::store(middle + x * 4, sum);
+        }
+        // 两侧复制边缘像素，横向滤波不需要逐个钳位下标
+        for (int p = 1; p <= kPad; p++) {
+            std::copy(middle, middle + 4, middle - p * 4);
+            std::copy(middle + (sourceWidth - 1) * 4, middle + sourceWidth * 4, middle + (sourceWidth - 1 + p) * 4);
+        }
+
+        float *out = dst + size_t(y) * width * 4;
+        for (int32_t x = 0; x < width; x++) {
+            const float *p = middle + (2 * x + kernel.offset) * 4;
+            F4 sum = Ops::mul(Ops::load(p), weights[0]);
+            for (int t = 1; t < kernel.taps; t++) {
+                sum = Ops::add(sum, Ops::mul(Ops::load(p + t * 4), weights[t]));
+            }
+            sum = Ops::min(Ops::max(sum, zero), one);
+            Ops::store(out + x * 4, Ops::min(sum, Ops::splatAlpha(sum)));
+        }
+    }
+}
+
+/*!
+ * 把线性、预乘的float层级编码回RGBA8
+ * @param alphaScale 保持覆盖率时对alpha（连同预乘的颜色）的缩放
+ */
+template<typename Ops>
+void encodeLevel(const float *src, uint8_t *dst, size_t count, const MipBakeOptions &options, float alphaScale) {
+    using F4 = typename Ops::F4;
+    const ColorTables &tables = colorTables();
+    const F4 scale = Ops::set1(alphaScale);
+    const F4 zero = Ops::set1(0.f);
+    const F4 one = Ops::set1(1.f);
+    const F4 tiny = Ops::set1(kTinyAlpha);
+    const F4 half = Ops::set1(0.5f);
+    const F4 colorSteps = Ops::set1(options.srgb ? float(kEncodeSteps) : 255.f);
+    const F4 alphaSteps = Ops::set1(255.f);
+    const bool straight = options.alphaMode == AlphaMode::Straight;
+    // sRGB的预乘输出也要先除以alpha，在编码空间重新预乘
+    const bool divide = options.srgb || straight;
+    const bool premultiplyEncoded = options.srgb && !straight;
+
+    for (size_t i = 0; i < count; i++, src += 4, dst += 4) {
+        F4 v = Ops::min(Ops::max(Ops::mul(Ops::load(src), scale), zero), one);
+        F4 alpha = Ops::splatAlpha(v);
+        v = Ops::min(v, alpha);
+        F4 color = divide ? Ops::min(Ops::div(v, Ops::max(alpha, tiny)), one) : v;
+        if (options.srgb) {
+            color = Ops::sqrt(color);
+        }
+        int32_t colorSteps4[4];
+        int32_t alphaSteps4[4];
+        Ops::toInt(Ops::add(Ops::mul(color, colorSteps), half), colorSteps4);
+        Ops::toInt(Ops::add(Ops::mul(alpha, alphaSteps), half), alphaSteps4);
+
+        int32_t alpha8 = alphaSteps4[3];
+        for (int c = 0; c < 3; c++) {
+            int32_t value = options.srgb ? tables.toSrgb[colorSteps4[c]] : colorSteps4[c];
+            dst[c] = uint8_t(premultiplyEncoded ? (value * alpha8 + 127) / 255 : value);
+        }
+        dst[3] = uint8_t(alpha8);
+    }
+}
+
+/*!
+ * 找到让本层覆盖率最接近目标的alpha缩放。用alpha直方图从高往低累计，找到覆盖目标像素数的阈值t，
+ * 缩放为cutoff / t，这样alpha不低于t的像素缩放后正好通过alpha测试
+ */
+float coverageScale(const float *pixels, size_t count, float cutoff, float coverage) {
+    size_t target = size_t(double(coverage) * double(count) + 0.5);
+    if (target == 0) {
+        return 1.f;
+    }
+    std::vector<uint32_t> histogram(kCoverageBins, 0);
+    for (size_t i = 0; i < count; i++) {
+        histogram[std::min(kCoverageBins - 1, int(pixels[i * 4 + 3] * (kCoverageBins - 1)))]++;
+    }
+    size_t covered = 0;
+    int bin = kCoverageBins - 1;
+    for (; bin > 0; bin--) {
+        size_t previous = covered;
+        covered += histogram[bin];
+        if (covered >= target) {
+            // 很多像素的alpha相同时无法正好命中目标，取更接近的一侧
+            if (target - previous < covered - target && bin < kCoverageBins - 1) {
+                bin++;
+            }
+            break;
+        }
+    }
+    float threshold = std::max(float(bin), 0.5f) / float(kCoverageBins - 1);
+    return cutoff / threshold;
+}
+
+template<typename Ops>
+MipChain bake(int32_t width, int32_t height, std::vector<uint8_t> rgba, const MipBakeOptions &options) {
+    MipChain chain = MipChain::allocate(width, height, std::move(rgba));
+    if (chain.levels.size() <= 1) {
+        return chain;
+    }
+    const FilterKernel &kernel = kernelFor(options.filter);
+    bool preserveCoverage = options.alphaCutoff > 0.f;
+    float coverage = preserveCoverage
+                     ? TextureBaker::alphaCoverage(chain.pixels.data(), width, height, options.alphaCutoff)
+                     : 0.f;
+
+    // 每层的浮点副本保持未缩放的alpha，覆盖率缩放只作用于编码结果，不会逐级累积
+    std::vector<float> column((size_t(width) + 2 * kPad) * 4);
+    std::vector<float> ring(size_t(kRingRows) * width * 4);
+    std::vector<float> source;
+    std::vector<float> target;
+    LevelSource levelSource{width, height, nullptr, chain.pixels.data(), &options, ring.data(), {}};
+    std::fill(std::begin(levelSource.ringRows), std::end(levelSource.ringRows), -1);
+
+    for (size_t level = 1; level < chain.levels.size(); level++) {
+        const MipChain::Level &mip = chain.levels[level];
+        size_t count = size_t(mip.width) * size_t(mip.height);
+        target.resize(count * 4);
+        downsample<Ops>(levelSource, kernel, target.data(), mip.width, mip.height, column.data());
+        float scale = preserveCoverage ? coverageScale(target.data(), count, options.alphaCutoff, coverage) : 1.f;
+        encodeLevel<Ops>(target.data(), chain.pixels.data() + mip.offset, count, options, scale);
+
+        std::swap(source, target);
+        levelSource.width = mip.width;
+        levelSource.height = mip.height;
+        levelSource.pixels = source.data();
+    }
+    return chain;
+}
+
+} // namespace
+
+MipChain TextureBaker::buildMipChain(
+        int32_t width,
+        int32_t height,
+        std::vector<uint8_t> rgba,
+        const MipBakeOptions &options) {
+    return bake<SimdOps>(width, height, std::move(rgba), options);
+}
+
+MipChain TextureBaker::buildMipChainScalar(
+        int32_t width,
+        int32_t height,
+        std::vector<uint8_t> rgba,
+        const MipBakeOptions &options) {
+    return bake<ScalarOps>(width, height, std::move(rgba), options);
+}
+
+float TextureBaker::alphaCoverage(const uint8_t *rgba, int32_t width, int32_t height, float cutoff) {
+    size_t count = size_t(width) * size_t(height);
+    if (count == 0) {
+        return 0.f;
+    }
+    const float *unit = colorTables().toUnit;
+    size_t covered = 0;
+    for (size_t i = 0; i < count; i++) {
+        covered += unit[rgba[i * 4 + 3]] >= cutoff;
+    }
+    return float(double(covered) / double(count));
+}
@@ -0,0 +1,58 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TEXTUREBAKER_H
+#define ANDROIDGLINVESTIGATIONS_TEXTUREBAKER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "TextureStreamer.h"
+
+enum class MipFilter {
+    Box,    // 2x2平均
+    Kaiser, // 6抽头的Kaiser窗sinc，比盒式滤波锐利，负瓣造成的过冲会被截断
+};
+
+enum class AlphaMode {
+    Straight,      // 颜色没有乘alpha，AImageDecoder设置了unpremultiplied时的输出
+    Premultiplied, // 颜色已经在编码空间乘过alpha
+};
+
+struct MipBakeOptions {
+    MipFilter filter = MipFilter::Kaiser;
+    bool srgb = true;                        // 颜色通道按sRGB编码，在线性空间滤波；法线等数据纹理应为false
+    AlphaMode alphaMode = AlphaMode::Straight; // 输入和输出的alpha形式，滤波总是在预乘空间进行
+    float alphaCutoff = 0.f;                 // 大于0时按这个alpha测试阈值保持每一级的覆盖率，用于镂空纹理
+};
+
+/*!
+ * 在CPU上生成纹理的完整mip链，代替上传后的glGenerateMipmap。
+ *
+ * 每个像素展开成4个float放进一个SIMD寄存器（SSE或NEON），先纵向后横向做可分离滤波。
+ * 第0层逐行解码到环形缓冲，之后每层只保留一份浮点副本用于生成下一层，额外内存约为原图字节数的1.25倍。
+ * 不调用GL，可以在工作线程或主机上的离线工具中运行
+ */
+class TextureBaker {
+public:
+    /*!
+     * 生成mip链，尺寸规则与 MipChain::build 相同，第0层就是原图
+     * @param rgba 逐行紧密排列的RGBA8像素，会被移入结果
+     */
+    static MipChain buildMipChain(
+            int32_t width,
+            int32_t height,
+            std::vector<uint8_t> rgba,
+            const MipBakeOptions &options = {});
+
+    //! 与 buildMipChain 逐位一致的标量实现，用于对比测试和基准测试
+    static MipChain buildMipChainScalar(
+            int32_t width,
+            int32_t height,
+            std::vector<uint8_t> rgba,
+            const MipBakeOptions &options = {});
+
+    /*!
+     * @return 图像中alpha不低于cutoff的像素比例
+     */
+    static float alphaCoverage(const uint8_t *rgba, int32_t width, int32_t height, float cutoff);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TEXTUREBAKER_H
@@ -0,0 +1,196 @@
+#include "TextureCache.h"
+
+#include <cstdio>
+
+#include "AssetLoader.h"
+#include "Log.h"
+
+TextureCache::TextureCache(size_t releasedBudget) : releasedBudget_(releasedBudget) {}
+
+TextureCache::~TextureCache() {
+    // 加载失败或还没完成的纹理仍持有占位纹理的句柄，句柄释放时会回调 onReleased 访问 entries_，
+    // 必须在 entries_ 析构之前先放掉它们
+    for (auto &item: entries_) {
+        if (item.second.owner) {
+            item.second.owner->releasePlaceholder();
+        }
+    }
+    size_t live = entries_.size() - lru_.size();
+    if (live > 0) {
+        LOGW("纹理缓存销毁时还有 %zu 个纹理的句柄没有释放", live);
+    }
+}
+
+std::shared_ptr<TextureAsset> TextureCache::acquireLocked(const std::string &key, Entry &entry) {
+    if (auto handle = entry.handle.lock()) {
+        return handle;
+    }
+    // 句柄全部释放（释放通知可能还没到），发出新一代句柄，旧一代迟到的通知会被忽略
+    if (entry.released) {
+        lru_.erase(entry.lruPosition);
+        if (entry.measured) {
+            releasedBytes_ -= entry.bytes;
+        }
+        entry.released = false;
+        entry.measured = false;
+    }
+    entry.generation++;
+    std::shared_ptr<TextureAsset> handle(entry.owner.get(), Releaser{this, key, entry.generation});
+    entry.handle = handle;
+    return handle;
+}
+
+std::shared_ptr<TextureAsset> TextureCache::find(const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    hits_++;
+    return acquireLocked(key, it->second);
+}
+
+std::shared_ptr<TextureAsset> TextureCache::getOrLoad(const std::string &key, const Loader &loader) {
+    if (auto texture = find(key)) {
+        return texture;
+    }
+    // 加载在锁外进行，只有GL线程会插入，不会有两个线程同时加载同一个键
+    std::shared_ptr<TextureAsset> owner = loader();
+    if (!owner) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry &entry = entries_[key];
+    if (!entry.owner) {
+        entry.owner = std::move(owner);
+    }
+    return acquireLocked(key, entry);
+}
+
+void TextureCache::onReleased(const std::string &key, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.generation != generation || it->second.released) {
+        return;
+    }
+    Entry &entry = it->second;
+    entry.released = true;
+    entry.measured = false;
+    lru_.push_front(key);
+    entry.lruPosition = lru_.begin();
+}
+
+void TextureCache::collect() {
+    std::vector<std::shared_ptr<TextureAsset>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 新释放的纹理都在列表前面，遇到已经统计过的就可以停止
+        for (const auto &key: lru_) {
+            Entry &entry = entries_.find(key)->second;
+            if (entry.measured) {
+                break;
+            }
+            entry.bytes = entry.owner->getByteSize();
+            entry.measured = true;
+            releasedBytes_ += entry.bytes;
+        }
+        while (releasedBytes_ > releasedBudget_ && !lru_.empty()) {
+            auto it = entries_.find(lru_.back());
+            releasedBytes_ -= it->second.bytes;
+            evicted.push_back(std::move(it->second.owner));
+            entries_.erase(it);
+            lru_.pop_back();
+            evictions_++;
+        }
+    }
+    // 在锁外销毁，TextureAsset的析构函数会调用GL
+}
+
+void TextureCache::clear() {
+    // 先断开占位纹理的引用，被引用的纹理的句柄随之释放。释放通知需要加锁，所以在锁外进行
+    std::vector<std::shared_ptr<TextureAsset>> owners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &item: entries_) {
+            if (item.second.owner) {
+                owners.push_back(item.second.owner);
+            }
+        }
+    }
+    for (auto &owner: owners) {
+        owner->releasePlaceholder();
+    }
+    owners.clear();
+
+    size_t live = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (!it->second.handle.expired()) {
+                live++;
+                ++it;
+                continue;
+            }
+            owners.push_back(std::move(it->second.owner));
+            it = entries_.erase(it);
+        }
+        // 留下的纹理都还有句柄，不在已释放列表中
+        lru_.clear();
+        releasedBytes_ = 0;
+    }
+    if (live > 0) {
+        LOGW("清空纹理缓存时还有 %zu 个纹理的句柄没有释放", live);
+    }
+    // 纹理在锁外销毁
+    owners.clear();
+}
+
+void TextureCache::setReleasedBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    releasedBudget_ = bytes;
+}
+
+TextureCacheStats TextureCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TextureCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.releasedCount = lru_.size();
+    stats.liveCount = entries_.size() - lru_.size();
+    stats.releasedBytes = releasedBytes_;
+    return stats;
+}
+
+std::shared_ptr<TextureAsset> TextureCache::loadAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    return getOrLoad(assetPath, [&] { return TextureAsset::loadAsset(assetManager, assetPath); });
+}
+
+std::shared_ptr<TextureAsset> TextureCache::loadAssetAsync(
+        AssetLoader &loader,
+        AAssetManager *assetManager,
+        const std::string &assetPath,
+        std::shared_ptr<TextureAsset> placeholder) {
+    return getOrLoad(assetPath, [&] {
+        return TextureAsset::loadAssetAsync(loader, assetManager, assetPath, std::move(placeholder));
+    });
+}
+
+std::shared_ptr<TextureAsset> TextureCache::loadAssetStreamed(
+        AssetLoader &loader,
+        TextureStreamer &streamer,
+        AAssetManager *assetManager,
+        const std::string &assetPath,
+        std::shared_ptr<TextureAsset> placeholder) {
+    return getOrLoad(assetPath, [&] {
+        return TextureAsset::loadAssetStreamed(loader, streamer, assetManager, assetPath, std::move(placeholder));
+    });
+}
+
+std::shared_ptr<TextureAsset> TextureCache::solidColor(GLubyte r, GLubyte g, GLubyte b, GLubyte a) {
+    // '#'开头的键不会和assets/中的路径冲突
+    char key[16];
+    snprintf(key, sizeof(key), "#%02x%02x%02x%02x", r, g, b, a);
+    return getOrLoad(key, [&] { return TextureAsset::createSolidColorTexture(r, g, b, a); });
+}
@@ -0,0 +1,135 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TEXTURECACHE_H
+#define ANDROIDGLINVESTIGATIONS_TEXTURECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TextureAsset.h"
+
+class AssetLoader;
+
+/*!
+ * 纹理缓存统计
+ */
+struct TextureCacheStats {
+    size_t hits = 0;          // 找到已有纹理的次数，包括从已释放列表中取回
+    size_t misses = 0;        // 没有找到、需要加载（或find返回空）的次数
+    size_t evictions = 0;     // 已释放纹理因超出预算被销毁的次数
+    size_t liveCount = 0;     // 还有句柄在使用的纹理数
+    size_t releasedCount = 0; // 句柄已全部释放、留在LRU中的纹理数
+    size_t releasedBytes = 0; // LRU中纹理的显存字节数（在 collect 中统计）
+};
+
+/*!
+ * 按路径（纯色纹理按颜色）去重的纹理缓存。
+ *
+ * 调用方拿到的是共享句柄，同一个键的所有句柄指向同一个纹理。句柄全部释放后纹理不会立即销毁，
+ * 而是进入LRU列表，再次请求时直接取回；LRU中纹理的总字节数超出预算时从最久没用的开始销毁。
+ *
+ * @a find 可以在任意线程调用，供后台加载器查询已有纹理。加载新纹理需要GL，只能在GL线程进行。
+ * 句柄可以在任意线程释放，统计大小和销毁纹理都推迟到GL线程每帧调用的 @a collect 中。
+ * 缓存的生命周期必须长于它发出的所有句柄；缓存内纹理互相持有的占位纹理句柄在析构时先行释放
+ */
+class TextureCache {
+public:
+    using Loader = std::function<std::shared_ptr<TextureAsset>()>;
+
+    /*!
+     * @param releasedBudget 已释放纹理最多保留的字节数
+     */
+    explicit TextureCache(size_t releasedBudget = 16u << 20);
+
+    ~TextureCache();
+
+    TextureCache(const TextureCache &) = delete;
+    TextureCache &operator=(const TextureCache &) = delete;
+
+    //! 查找已有纹理，不存在时返回nullptr。线程安全
+    std::shared_ptr<TextureAsset> find(const std::string &key);
+
+    /*!
+     * 查找纹理，不存在时调用loader加载并缓存。只能在GL线程调用
+     * @return loader失败时返回nullptr，失败不会被缓存
+     */
+    std::shared_ptr<TextureAsset> getOrLoad(const std::string &key, const Loader &loader);
+
+    //! 缓存版的 TextureAsset::loadAsset，键为资源路径
+    std::shared_ptr<TextureAsset> loadAsset(AAssetManager *assetManager, const std::string &assetPath);
+
+    //! 缓存版的 TextureAsset::loadAssetAsync
+    std::shared_ptr<TextureAsset> loadAssetAsync(
+            AssetLoader &loader,
+            AAssetManager *assetManager,
+            const std::string &assetPath,
+            std::shared_ptr<TextureAsset> placeholder);
+
+    //! 缓存版的 TextureAsset::loadAssetStreamed
+    std::shared_ptr<TextureAsset> loadAssetStreamed(
+            AssetLoader &loader,
+            TextureStreamer &streamer,
+            AAssetManager *assetManager,
+            const std::string &assetPath,
+            std::shared_ptr<TextureAsset> placeholder);
+
+    //! 缓存版的 TextureAsset::createSolidColorTexture，键由颜色生成
+    std::shared_ptr<TextureAsset> solidColor(GLubyte r, GLubyte g, GLubyte b, GLubyte a);
+
+    /*!
+     * 在GL线程每帧调用：统计新释放纹理的大小，销毁超出预算的已释放纹理
+     */
+    void collect();
+
+    /*!
+     * 销毁所有句柄已经全部释放的纹理，包括占位纹理之间的引用。只能在GL线程调用，
+     * 渲染器在销毁GL上下文之前用它删除缓存中的GL纹理。仍有句柄的纹理留在缓存中
+     */
+    void clear();
+
+    //! 修改已释放纹理的预算，下一次 collect 时生效
+    void setReleasedBudget(size_t bytes);
+
+    TextureCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<TextureAsset> owner; // 缓存自己持有的引用，销毁它才会删除GL纹理
+        std::weak_ptr<TextureAsset> handle;  // 发给调用方的句柄，全部释放后过期
+        uint64_t generation = 0;             // 每次发出新句柄时递增，用来忽略旧句柄迟到的释放通知
+        bool released = false;
+        bool measured = false;               // released时是否已经在collect中统计过大小
+        size_t bytes = 0;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    // 句柄的删除器：不删除纹理，只通知缓存句柄已经全部释放
+    struct Releaser {
+        TextureCache *cache;
+        std::string key;
+        uint64_t generation;
+
+        void operator()(TextureAsset *) const { cache->onReleased(key, generation); }
+    };
+
+    //! 调用时必须持有mutex_
+    std::shared_ptr<TextureAsset> acquireLocked(const std::string &key, Entry &entry);
+
+    void onReleased(const std::string &key, uint64_t generation);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_; // 已释放纹理的键，前面是最近释放的
+    size_t releasedBudget_;
+    size_t releasedBytes_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t evictions_ = 0;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TEXTURECACHE_H
@@ -0,0 +1,96 @@
+#include "TextureFormat.h"
+
+#include <algorithm>
+#include <GLES2/gl2ext.h>
+
+#include "AstcDecoder.h"
+#include "Etc2Decoder.h"
+#include "Log.h"
+
+namespace {
+
+// ASTC的VkFormat和GL格式都按下面的块尺寸顺序连续编号，每个尺寸先UNORM后SRGB
+constexpr uint32_t kVkAstcFirst = 157;
+
+#define ASTC_FORMATS(w, h, i) \
+    {kVkAstcFirst + (i) * 2, TextureCodec::Astc, w, h, 16, false, true, GLenum(GL_COMPRESSED_RGBA_ASTC_4x4_KHR + (i)), \
+     "ASTC_" #w "x" #h "_UNORM"}, \
+    {kVkAstcFirst + (i) * 2 + 1, TextureCodec::Astc, w, h, 16, true, true, GLenum(GL_COMPRESSED_RGBA_ASTC_4x4_KHR + (i)), \
+     "ASTC_" #w "x" #h "_SRGB"}
+
+const TextureFormat kFormats[] = {
+        {37, TextureCodec::Rgba8, 1, 1, 4, false, true, GL_RGBA8, "R8G8B8A8_UNORM"},
+        {43, TextureCodec::Rgba8, 1, 1, 4, true, true, GL_RGBA8, "R8G8B8A8_SRGB"},
+        {147, TextureCodec::Etc2, 4, 4, 8, false, false, GL_COMPRESSED_RGB8_ETC2, "ETC2_R8G8B8_UNORM"},
+        {148, TextureCodec::Etc2, 4, 4, 8, true, false, GL_COMPRESSED_RGB8_ETC2, "ETC2_R8G8B8_SRGB"},
+        {151, TextureCodec::Etc2, 4, 4, 16, false, true, GL_COMPRESSED_RGBA8_ETC2_EAC, "ETC2_R8G8B8A8_UNORM"},
+        {152, TextureCodec::Etc2, 4, 4, 16, true, true, GL_COMPRESSED_RGBA8_ETC2_EAC, "ETC2_R8G8B8A8_SRGB"},
+        ASTC_FORMATS(4, 4, 0),
+        ASTC_FORMATS(5, 4, 1),
+        ASTC_FORMATS(5, 5, 2),
+        ASTC_FORMATS(6, 5, 3),
+        ASTC_FORMATS(6, 6, 4),
+        ASTC_FORMATS(8, 5, 5),
+        ASTC_FORMATS(8, 6, 6),
+        ASTC_FORMATS(8, 8, 7),
+        ASTC_FORMATS(10, 5, 8),
+        ASTC_FORMATS(10, 6, 9),
+        ASTC_FORMATS(10, 8, 10),
+        ASTC_FORMATS(10, 10, 11),
+        ASTC_FORMATS(12, 10, 12),
+        ASTC_FORMATS(12, 12, 13),
+};
+
+#undef ASTC_FORMATS
+
+} // namespace
+
+const TextureFormat *TextureFormat::find(uint32_t vkFormat) {
+    for (const auto &format: kFormats) {
+        if (format.vkFormat == vkFormat) {
+            return &format;
+        }
+    }
+    return nullptr;
+}
+
+const TextureFormat *TextureFormat::find(TextureCodec codec, int blockWidth, int blockHeight, bool srgb,
+                                         bool hasAlpha) {
+    for (const auto &format: kFormats) {
+        // ASTC的每个格式都带alpha，按需要的alpha过滤只对ETC2有意义
+        if (format.codec == codec && format.blockWidth == blockWidth && format.blockHeight == blockHeight
+            && format.srgb == srgb && (format.hasAlpha == hasAlpha || codec == TextureCodec::Astc)) {
+            return &format;
+        }
+    }
+    return nullptr;
+}
+
+size_t TextureFormat::levelSize(int32_t width, int32_t height) const {
+    size_t blocksX = (size_t(width) + blockWidth - 1) / blockWidth;
+    size_t blocksY = (size_t(height) + blockHeight - 1) / blockHeight;
+    return blocksX * blocksY * blockBytes;
+}
+
+bool TextureFormat::decompress(const uint8_t *data, size_t size, int32_t width, int32_t height, uint8_t *rgba) const {
+    if (size != levelSize(width, height)) {
+        LOGE("%s 层级 %dx%d 应为 %zu 字节，实际 %zu 字节", name, width, height, levelSize(width, height), size);
+        return false;
+    }
+    switch (codec) {
+        case TextureCodec::Rgba8:
+            std::copy(data, data + size, rgba);
+            return true;
+        case TextureCodec::Etc2:
+            Etc2Decoder::decodeImage(data, width, height, hasAlpha, rgba);
+            return true;
+        case TextureCodec::Astc: {
+            size_t errors = AstcDecoder::decodeImage(data, width, height, blockWidth, blockHeight, srgb, rgba);
+            if (errors > 0) {
+                LOGW("%s 层级 %dx%d 有 %zu 个非法或HDR块", name, width, height, errors);
+            }
+            return true;
+        }
+    }
+    return false;
+}
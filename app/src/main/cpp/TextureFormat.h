@@ -0,0 +1,51 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TEXTUREFORMAT_H
+#define ANDROIDGLINVESTIGATIONS_TEXTUREFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <GLES3/gl3.h>
+
+//! 纹理数据的编码方式
+enum class TextureCodec {
+    Rgba8, // 未压缩
+    Etc2,  // ETC2 RGB，或带EAC alpha的RGBA
+    Astc,  // ASTC LDR
+};
+
+/*!
+ * KTX2中用到的纹理格式，按Vulkan的VkFormat编号查找。
+ *
+ * sRGB格式上传时使用对应的UNORM内部格式：渲染管线在gamma空间中着色（见 TextureBaker），
+ * 与RGBA8纹理保持一致，块数据本身两者相同
+ */
+struct TextureFormat {
+    uint32_t vkFormat;
+    TextureCodec codec;
+    uint8_t blockWidth;
+    uint8_t blockHeight;
+    uint8_t blockBytes;
+    bool srgb;
+    bool hasAlpha;
+    GLenum glInternalFormat; // Rgba8为GL_RGBA8，其他为glCompressedTexImage2D的格式
+    const char *name;
+
+    //! @return 不支持的格式返回nullptr
+    static const TextureFormat *find(uint32_t vkFormat);
+
+    //! @return 按编码方式、块尺寸和sRGB查找，找不到返回nullptr
+    static const TextureFormat *find(TextureCodec codec, int blockWidth, int blockHeight, bool srgb, bool hasAlpha);
+
+    inline bool isCompressed() const { return codec != TextureCodec::Rgba8; }
+
+    //! @return 一个层级的字节数，不满一块的边缘按整块计
+    size_t levelSize(int32_t width, int32_t height) const;
+
+    /*!
+     * 在CPU上把一个层级解码成RGBA8，用于GPU不支持该格式的情况
+     * @param rgba 输出width * height * 4字节
+     * @return 数据长度不符时返回false；ASTC的非法块解码为品红并输出警告，仍返回true
+     */
+    bool decompress(const uint8_t *data, size_t size, int32_t width, int32_t height, uint8_t *rgba) const;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TEXTUREFORMAT_H
@@ -0,0 +1,272 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+MipChain MipChain::allocate(int32_t width, int32_t height, std::vector<uint8_t> rgba) {
+    MipChain chain;
+    if (width <= 0 || height <= 0) {
+        return chain;
+    }
+    size_t total = 0;
+    for (int32_t w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        size_t size = size_t(w) * size_t(h) * 4;
+        chain.levels.push_back({w, h, total, size});
+        total += size;
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+    chain.pixels = std::move(rgba);
+    chain.pixels.resize(total);
+    return chain;
+}
+
+MipChain MipChain::build(int32_t width, int32_t height, std::vector<uint8_t> rgba) {
+    MipChain chain = allocate(width, height, std::move(rgba));
+
+    for (size_t level = 1; level < chain.levels.size(); level++) {
+        const Level &source = chain.levels[level - 1];
+        const Level &target = chain.levels[level];
+        const uint8_t *src = chain.pixels.data() + source.offset;
+        uint8_t *dst = chain.pixels.data() + target.offset;
+        // 奇数尺寸时最后一行/列的像素不参与，与按下取整的尺寸规则一致；某一维已经是1时两次采样同一行/列
+        size_t rowStride = size_t(source.width) * 4;
+        size_t dx = source.width > 1 ? 4 : 0;
+        size_t dy = source.height > 1 ? rowStride : 0;
+        for (int32_t y = 0; y < target.height; y++) {
+            const uint8_t *row = src + size_t(source.height > 1 ? 2 * y : y) * rowStride;
+            for (int32_t x = 0; x < target.width; x++) {
+                const uint8_t *p = row + size_t(source.width > 1 ? 2 * x : x) * 4;
+                for (int c = 0; c < 4; c++) {
+                    *dst++ = uint8_t((p[c] + p[c + dx] + p[c + dy] + p[c + dx + dy] + 2) / 4);
+                }
+            }
+        }
+    }
+    return chain;
+}
+
+size_t MipChain::bytesFrom(size_t first) const {
+    size_t bytes = 0;
+    for (size_t level = first; level < levels.size(); level++) {
+        bytes += levels[level].size;
+    }
+    return bytes;
+}
+
+StreamedMipChain StreamedMipChain::split(const MipChain &chain) {
+    StreamedMipChain streamed;
+    streamed.levels = chain.levels;
+    streamed.levelPixels.reserve(chain.levels.size());
+    for (size_t level = 0; level < chain.levels.size(); level++) {
+        const uint8_t *data = chain.levelData(level);
+        streamed.levelPixels.emplace_back(data, data + chain.levels[level].size);
+    }
+    return streamed;
+}
+
+TextureStreamer::TextureStreamer(TextureStreamBackend &backend, const TextureStreamerOptions &options)
+        : backend_(backend), options_(options) {}
+
+TextureStreamer::~TextureStreamer() {
+    for (auto &texture: textures_) {
+        if (isLive(texture)) {
+            backend_.destroy(texture.handle);
+        }
+    }
+}
+
+TextureStreamer::TextureId TextureStreamer::add(StreamedMipChain chain) {
+    if (chain.levels.empty() || chain.levelPixels.size() != chain.levels.size()) {
+        return kInvalidTexture;
+    }
+    TextureId id;
+    if (!freeIds_.empty()) {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+    } else {
+        id = TextureId(textures_.size());
+        textures_.emplace_back();
+    }
+
+    Texture &texture = textures_[id];
+    texture = Texture{};
+    texture.levels = std::move(chain.levels);
+    texture.levelPixels = std::move(chain.levelPixels);
+    size_t tail = 0;
+    while (tail + 1 < texture.levels.size()
+           && std::max(texture.levels[tail].width, texture.levels[tail].height) > options_.tailSize) {
+        tail++;
+    }
+    texture.tailLevel = tail;
+    texture.desiredLevel = tail;
+    texture.residentLevel = tail;
+    texture.uploadedLevel = texture.levels.size();
+    texture.lastUsedFrame = frame_;
+    texture.handle = backend_.create(texture.levels);
+
+    size_t storage = bytesFrom(texture, 0);
+    stats_.storageBytes += storage;
+    stats_.cpuBytes += storage;
+    uploadLevels(texture, tail);
+    backend_.setBaseLevel(texture.handle, tail);
+    stats_.residentBytes += bytesFrom(texture, tail);
+    stats_.textureCount++;
+    return id;
+}
+
+void TextureStreamer::remove(TextureId id) {
+    if (id >= textures_.size() || !isLive(textures_[id])) {
+        return;
+    }
+    Texture &texture = textures_[id];
+    backend_.destroy(texture.handle);
+    stats_.residentBytes -= bytesFrom(texture, texture.residentLevel);
+    stats_.storageBytes -= bytesFrom(texture, 0);
+    stats_.cpuBytes -= bytesFrom(texture, 0) - bytesFrom(texture, texture.uploadedLevel);
+    stats_.textureCount--;
+    texture = Texture{};
+    freeIds_.push_back(id);
+}
+
+void TextureStreamer::reportUsage(TextureId id, float screenPixels) {
+    if (id >= textures_.size() || !isLive(textures_[id])) {
+        return;
+    }
+    Texture &texture = textures_[id];
+    if (texture.lastUsedFrame != frame_) {
+        texture.lastUsedFrame = frame_;
+        texture.screenPixels = 0.f;
+    }
+    texture.screenPixels = std::max(texture.screenPixels, screenPixels);
+
+    // 每个屏幕像素对应不超过一个纹素的最精细层级
+    const auto &base = texture.levels[0];
+    float texels = float(std::max(base.width, base.height));
+    size_t level = 0;
+    if (texture.screenPixels < texels) {
+        level = texture.screenPixels > 0.f
+                ? size_t(std::floor(std::log2(texels / texture.screenPixels)))
+                : texture.tailLevel;
+    }
+    texture.desiredLevel = std::min(level, texture.tailLevel);
+}
+
+size_t TextureStreamer::bytesFrom(const Texture &texture, size_t first) {
+    size_t bytes = 0;
+    for (size_t level = first; level < texture.levels.size(); level++) {
+        bytes += texture.levels[level].size;
+    }
+    return bytes;
+}
+
+size_t TextureStreamer::uploadBytes(const Texture &texture, size_t level) {
+    return level < texture.uploadedLevel ? bytesFrom(texture, level) - bytesFrom(texture, texture.uploadedLevel) : 0;
+}
+
+void TextureStreamer::uploadLevels(Texture &texture, size_t level) {
+    while (texture.uploadedLevel > level) {
+        size_t next = texture.uploadedLevel - 1;
+        const MipChain::Level &mip = texture.levels[next];
+        backend_.upload(texture.handle, next, mip, texture.levelPixels[next].data());
+        // 存储中的数据在纹理移除前一直有效，CPU副本不再需要
+        std::vector<uint8_t>().swap(texture.levelPixels[next]);
+        stats_.cpuBytes -= mip.size;
+        stats_.uploadedBytes += mip.size;
+        texture.uploadedLevel = next;
+    }
+}
+
+void TextureStreamer::setResidentLevel(Texture &texture, size_t level) {
+    uploadLevels(texture, level);
+    backend_.setBaseLevel(texture.handle, level);
+    stats_.residentBytes -= bytesFrom(texture, texture.residentLevel);
+    stats_.residentBytes += bytesFrom(texture, level);
+    texture.residentLevel = level;
+}
+
+TextureStreamer::Texture *TextureStreamer::findVictim(const Texture *exclude) {
+    // 纹理数量不多，线性扫描即可
+    Texture *victim = nullptr;
+    for (auto &texture: textures_) {
+        if (!isLive(texture) || &texture == exclude || texture.residentLevel >= texture.tailLevel) {
+            continue;
+        }
+        bool usedThisFrame = texture.lastUsedFrame == frame_;
+        if (usedThisFrame && texture.residentLevel >= texture.desiredLevel) {
+            continue;
+        }
+        if (!victim || texture.lastUsedFrame < victim->lastUsedFrame
+            || (texture.lastUsedFrame == victim->lastUsedFrame
+                && bytesFrom(texture, texture.residentLevel) > bytesFrom(*victim, victim->residentLevel))) {
+            victim = &texture;
+        }
+    }
+    return victim;
+}
+
+void TextureStreamer::update() {
+    // 先把超出的部分淘汰掉，预算可能在运行期被调小
+    while (stats_.residentBytes > options_.memoryBudget) {
+        Texture *victim = findVictim(nullptr);
+        if (!victim) {
+            break;
+        }
+        setResidentLevel(*victim, victim->residentLevel + 1);
+        stats_.evictions++;
+    }
+
+    // 本帧用到且需要更精细层级的纹理，差距大的优先，其次是屏幕上更大的
+    candidates_.clear();
+    for (TextureId id = 0; id < textures_.size(); id++) {
+        const Texture &texture = textures_[id];
+        if (isLive(texture) && texture.lastUsedFrame == frame_ && texture.desiredLevel < texture.residentLevel) {
+            candidates_.push_back(id);
+        }
+    }
+    std::sort(candidates_.begin(), candidates_.end(), [this](TextureId a, TextureId b) {
+        const Texture &ta = textures_[a];
+        const Texture &tb = textures_[b];
+        size_t gapA = ta.residentLevel - ta.desiredLevel;
+        size_t gapB = tb.residentLevel - tb.desiredLevel;
+        return gapA != gapB ? gapA > gapB : ta.screenPixels > tb.screenPixels;
+    });
+
+    size_t uploaded = 0;
+    size_t pending = candidates_.size();
+    for (TextureId id: candidates_) {
+        Texture &texture = textures_[id];
+        size_t level = texture.residentLevel - 1;
+        // 以前上传过、后来被淘汰的层级还在存储中，提升时不需要上传
+        size_t upload = uploadBytes(texture, level);
+        if (uploaded > 0 && uploaded + upload > options_.uploadBytesPerFrame) {
+            break;
+        }
+        size_t growth = texture.levels[level].size;
+        while (stats_.residentBytes + growth > options_.memoryBudget) {
+            Texture *victim = findVictim(&texture);
+            if (!victim) {
+                break;
+            }
+            setResidentLevel(*victim, victim->residentLevel + 1);
+            stats_.evictions++;
+        }
+        if (stats_.residentBytes + growth > options_.memoryBudget) {
+            // 本帧用到的纹理已经占满预算，保持当前层级
+            continue;
+        }
+        setResidentLevel(texture, level);
+        stats_.promotions++;
+        uploaded += upload;
+        if (texture.residentLevel == texture.desiredLevel) {
+            pending--;
+        }
+    }
+    stats_.pendingUploads = pending;
+    frame_++;
+}
+
+TextureStreamerStats TextureStreamer::stats() const {
+    return stats_;
+}
@@ -0,0 +1,198 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TEXTURESTREAMER_H
+#define ANDROIDGLINVESTIGATIONS_TEXTURESTREAMER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * CPU上生成的完整mip链，RGBA8，所有层级依次排列在同一块内存中
+ */
+struct MipChain {
+    struct Level {
+        int32_t width;
+        int32_t height;
+        size_t offset; // 在pixels中的字节偏移
+        size_t size;   // 字节数
+    };
+
+    std::vector<Level> levels; // 第0层是原图，最后一层是1x1（图集页面的mip链会提前截断）
+    std::vector<uint8_t> pixels;
+
+    /*!
+     * 从原图用2x2盒式滤波逐级生成mip链，尺寸规则与glGenerateMipmap相同（每级减半并向下取整，最小为1）。
+     * 直接平均编码后的字节，不做gamma校正；颜色纹理用 TextureBaker::buildMipChain
+     * @param rgba 逐行紧密排列的RGBA8像素，会被移入结果
+     */
+    static MipChain build(int32_t width, int32_t height, std::vector<uint8_t> rgba);
+
+    //! 按上面的尺寸规则排列所有层级并分配内存，第0层是rgba，其余层级未填充
+    static MipChain allocate(int32_t width, int32_t height, std::vector<uint8_t> rgba);
+
+    inline const uint8_t *levelData(size_t level) const { return pixels.data() + levels[level].offset; }
+
+    //! 从first层到最后一层的总字节数，也就是以first为最精细层时的显存占用
+    size_t bytesFrom(size_t first) const;
+};
+
+/*!
+ * 交给 TextureStreamer 的mip链。每层单独分配，流送器上传一层后就释放它在CPU上的副本
+ */
+struct StreamedMipChain {
+    std::vector<MipChain::Level> levels; // 只用尺寸和字节数，offset没有意义
+    std::vector<std::vector<uint8_t>> levelPixels;
+
+    //! 把连续排列的mip链拆成每层一块内存，可以在工作线程调用
+    static StreamedMipChain split(const MipChain &chain);
+};
+
+/*!
+ * 纹理流送的图形后端。实现负责创建和释放真正的纹理，主机上可以用桩实现测试驻留策略
+ */
+class TextureStreamBackend {
+public:
+    virtual ~TextureStreamBackend() = default;
+
+    /*!
+     * 按整条mip链分配纹理存储，不上传数据
+     * @param levels 各层的尺寸，第0层最大
+     * @return 后端的纹理句柄，不能为0
+     */
+    virtual uint32_t create(const std::vector<MipChain::Level> &levels) = 0;
+
+    //! 上传一层的数据
+    virtual void upload(uint32_t handle, size_t level, const MipChain::Level &mip, const uint8_t *pixels) = 0;
+
+    //! 设置采样用的最精细层级，更精细的层级不再被采样
+    virtual void setBaseLevel(uint32_t handle, size_t level) = 0;
+
+    //! 释放 create 返回的句柄
+    virtual void destroy(uint32_t handle) = 0;
+};
+
+struct TextureStreamerOptions {
+    size_t memoryBudget = 64u << 20;        // 所有纹理驻留层级的字节数上限，超出时按LRU淘汰最精细的层
+    size_t uploadBytesPerFrame = 4u << 20; // 每帧最多上传的字节数，每帧至少提升一个纹理
+    int32_t tailSize = 64;                 // 长边不超过它的层级组成mip尾，加入时立即上传且从不淘汰
+};
+
+/*!
+ * 纹理驻留统计
+ */
+struct TextureStreamerStats {
+    size_t textureCount = 0;
+    size_t residentBytes = 0;  // 所有纹理当前驻留层级的字节数
+    size_t storageBytes = 0;   // 所有纹理按整条mip链分配的存储字节数
+    size_t cpuBytes = 0;       // CPU上还没上传过的层级的字节数
+    size_t pendingUploads = 0; // 本帧用到、但驻留层级还比需要的粗的纹理数
+    size_t uploadedBytes = 0;  // 累计上传的字节数，每层最多上传一次
+    size_t promotions = 0;     // 累计提升一级的次数
+    size_t evictions = 0;      // 累计因预算淘汰一级的次数
+};
+
+/*!
+ * 纹理流送的驻留策略。
+ *
+ * 纹理加入时只上传mip尾，之后按渲染器每帧反馈的屏幕尺寸决定需要的最精细层级，
+ * 在 @a update 中每次提升一级，从粗到细逐步流送。总驻留字节数超出预算时，
+ * 从最久没有使用的纹理开始淘汰最精细的一层，本帧用到的纹理只在驻留层级比需要的更精细时才会被淘汰。
+ *
+ * GLES 3没有稀疏纹理，也不能只释放不可变存储的一部分，所以纹理加入时按整条mip链分配一次存储，
+ * 驻留层级只是后端的最精细采样层级：提升时只上传新的一层，淘汰时只把最精细的一层移出采样范围。
+ * 被淘汰的层级数据仍在存储中，再次提升时不需要上传。每层上传后立即释放CPU上的副本，
+ * CPU上只留着还没上传过的层级。所有方法只能在GL线程调用
+ */
+class TextureStreamer {
+public:
+    using TextureId = uint32_t;
+    static constexpr TextureId kInvalidTexture = UINT32_MAX;
+
+    /*!
+     * @param backend 图形后端，生命周期必须长于流送器
+     */
+    TextureStreamer(TextureStreamBackend &backend, const TextureStreamerOptions &options = {});
+
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    /*!
+     * 加入一个纹理，分配整条mip链的存储并立即上传它的mip尾
+     * @param chain 完整的mip链，流送器持有还没上传的层级直到上传或 remove
+     */
+    TextureId add(StreamedMipChain chain);
+
+    //! 释放纹理的后端句柄和还没上传的层级
+    void remove(TextureId id);
+
+    /*!
+     * 报告纹理本帧在屏幕上的大小，同一帧多次报告时取最大值
+     * @param screenPixels 纹理长边映射到屏幕上的像素数
+     */
+    void reportUsage(TextureId id, float screenPixels);
+
+    /*!
+     * 每帧绘制之后调用：按预算淘汰和提升驻留层级，然后进入下一帧
+     */
+    void update();
+
+    //! @return 纹理当前的后端句柄
+    inline uint32_t handle(TextureId id) const { return textures_[id].handle; }
+
+    //! @return 纹理当前驻留的最精细层级
+    inline size_t residentLevel(TextureId id) const { return textures_[id].residentLevel; }
+
+    //! @return 纹理当前驻留层级的字节数
+    inline size_t residentBytes(TextureId id) const { return bytesFrom(textures_[id], textures_[id].residentLevel); }
+
+    //! @return 按最近一次报告的屏幕尺寸需要的最精细层级
+    inline size_t desiredLevel(TextureId id) const { return textures_[id].desiredLevel; }
+
+    //! 修改内存预算，下一次 update 时生效
+    inline void setMemoryBudget(size_t bytes) { options_.memoryBudget = bytes; }
+
+    TextureStreamerStats stats() const;
+
+private:
+    struct Texture {
+        std::vector<MipChain::Level> levels; // 为空表示空闲的槽位
+        std::vector<std::vector<uint8_t>> levelPixels; // 已经上传过的层级为空
+        uint32_t handle = 0;
+        size_t residentLevel = 0;
+        size_t uploadedLevel = 0;  // 存储中有数据的最精细层级，从它到最后一层都已上传
+        size_t desiredLevel = 0;
+        size_t tailLevel = 0;      // mip尾的第一层，驻留层级不会比它更粗
+        float screenPixels = 0.f;  // 本帧报告的最大屏幕尺寸
+        uint64_t lastUsedFrame = 0;
+    };
+
+    inline bool isLive(const Texture &texture) const { return !texture.levels.empty(); }
+
+    static size_t bytesFrom(const Texture &texture, size_t first);
+
+    //! 把level提升到驻留层级需要上传的字节数
+    static size_t uploadBytes(const Texture &texture, size_t level);
+
+    //! 上传还没上传过的、不比level粗的层级，并释放它们的CPU副本
+    void uploadLevels(Texture &texture, size_t level);
+
+    //! 把level设为最精细的采样层级，需要时先上传
+    void setResidentLevel(Texture &texture, size_t level);
+
+    /*!
+     * 找一个可以淘汰一层的纹理：驻留层级比mip尾精细，并且本帧没有用到或者驻留得比需要的更精细。
+     * 优先选最久没有使用的，其次选驻留字节数多的
+     */
+    Texture *findVictim(const Texture *exclude);
+
+    TextureStreamBackend &backend_;
+    TextureStreamerOptions options_;
+    std::vector<Texture> textures_;
+    std::vector<TextureId> freeIds_;
+    std::vector<TextureId> candidates_; // update中待提升的纹理，每帧复用
+    uint64_t frame_ = 1;
+    TextureStreamerStats stats_;
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TEXTURESTREAMER_H
@@ -0,0 +1,240 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+std::atomic<bool> Trace::enabled_{false};
+
+namespace {
+
+/*!
+ * 缓冲区中的一个事件。字段都是原子变量，导出线程可以在所属线程覆盖它的同时读取而不构成数据竞争；
+ * sequence 在写入过程中为奇数，写完后为 2 * (事件序号 + 1)，读取前后两次一致才说明读到的是完整的事件
+ */
+struct EventSlot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> timestampNs{0};
+    std::atomic<uint64_t> durationNs{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> valueBits{0}; // double的位模式
+    std::atomic<uint8_t> type{0};
+};
+
+/*!
+ * 单个线程的事件缓冲区。只有所属线程写入，导出时由其他线程读取
+ */
+struct ThreadEvents {
+    std::unique_ptr<EventSlot[]> slots{new EventSlot[Trace::kEventsPerThread]};
+    std::atomic<uint64_t> written{0};      // 累计写入的事件数，只由所属线程修改，超过容量后循环覆盖
+    std::atomic<uint64_t> clearedBefore{0}; // clear() 时的 written，导出从这里开始，只由其他线程修改
+    uint32_t threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+    std::atomic<const char *> threadName{nullptr};
+
+    inline void push(const Trace::Event &event) {
+        uint64_t index = written.load(std::memory_order_relaxed);
+        EventSlot &slot = slots[index % Trace::kEventsPerThread];
+        slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t valueBits;
+        memcpy(&valueBits, &event.value, sizeof(valueBits));
+        slot.timestampNs.store(event.timestampNs, std::memory_order_relaxed);
+        slot.durationNs.store(event.durationNs, std::memory_order_relaxed);
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.valueBits.store(valueBits, std::memory_order_relaxed);
+        slot.type.store(uint8_t(event.type), std::memory_order_relaxed);
+        slot.sequence.store(index * 2 + 2, std::memory_order_release);
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    /*!
+     * 读取第index个事件
+     * @return 事件还没写完或已经被覆盖时返回false
+     */
+    inline bool read(uint64_t index, Trace::Event &event) const {
+        const EventSlot &slot = slots[index % Trace::kEventsPerThread];
+        if (slot.sequence.load(std::memory_order_acquire) != index * 2 + 2) {
+            return false;
+        }
+        event.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+        event.name = slot.name.load(std::memory_order_relaxed);
+        uint64_t valueBits = slot.valueBits.load(std::memory_order_relaxed);
+        memcpy(&event.value, &valueBits, sizeof(valueBits));
+        event.type = Trace::EventType(slot.type.load(std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == index * 2 + 2;
+    }
+};
+
+// 所有线程的缓冲区。线程退出后缓冲区仍然保留，以便导出其事件
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadEvents &threadEvents() {
+    static thread_local std::shared_ptr<ThreadEvents> local;
+    if (!local) {
+        local = std::make_shared<ThreadEvents>();
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(local);
+    }
+    return *local;
+}
+
+// 把字符串按JSON规则转义后写出。事件名一般是简单的ASCII常量，这里只处理必要的字符
+void writeJsonString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const char *c = text; *c; ++c) {
+        switch (*c) {
+            case '"':
+                fputs("\\\"", file);
+                break;
+            case '\\':
+                fputs("\\\\", file);
+                break;
+            case '\n':
+                fputs("\\n", file);
+                break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20) {
+                    fprintf(file, "\\u%04x", *c);
+                } else {
+                    fputc(*c, file);
+                }
+        }
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+void Trace::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Trace::now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+void Trace::setThreadName(const char *name) {
+    threadEvents().threadName.store(name, std::memory_order_relaxed);
+}
+
+void Trace::recordZone(const char *name, uint64_t startNs, uint64_t endNs) {
+    threadEvents().push(Event{startNs, endNs - startNs, name, 0.0, EventType::Complete});
+}
+
+void Trace::recordCounter(const char *name, double value) {
+    threadEvents().push(Event{now(), 0, name, value, EventType::Counter});
+}
+
+void Trace::recordFrameMark() {
+    threadEvents().push(Event{now(), 0, "Frame", 0.0, EventType::Instant});
+}
+
+void Trace::clear() {
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    // written 只由所属线程修改，这里只移动导出的起点
+    for (auto &thread: reg.threads) {
+        thread->clearedBefore.store(thread->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool Trace::exportJson(const std::string &path) {
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) {
+        LOGE("无法写入trace文件 %s", path.c_str());
+        return false;
+    }
+
+    const int pid = getpid();
+    size_t eventCount = 0;
+    bool first = true;
+    auto separator = [&first, file] {
+        if (!first) {
+            fputs(",\n", file);
+        }
+        first = false;
+    };
+
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto &thread: reg.threads) {
+        const char *threadName = thread->threadName.load(std::memory_order_relaxed);
+        if (threadName) {
+            separator();
+            fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                    pid, thread->threadId);
+            writeJsonString(file, threadName);
+            fputs("}}", file);
+        }
+
+        // 缓冲区写满后只有最近kEventsPerThread个事件有效
+        uint64_t written = thread->written.load(std::memory_order_acquire);
+        uint64_t begin = written > kEventsPerThread ? written - kEventsPerThread : 0;
+        begin = std::max(begin, thread->clearedBefore.load(std::memory_order_relaxed));
+        for (uint64_t i = begin; i < written; ++i) {
+            // 导出期间所属线程可能继续写入并覆盖最旧的事件，读到一半被覆盖的事件跳过
+            Event event;
+            if (!thread->read(i, event)) {
+                continue;
+            }
+            separator();
+            fputs("{\"name\":", file);
+            writeJsonString(file, event.name);
+            // trace-event格式的时间单位是微秒，保留三位小数即纳秒精度
+            fprintf(file, ",\"pid\":%d,\"tid\":%u,\"ts\":%" PRIu64 ".%03u",
+                    pid, thread->threadId,
+                    event.timestampNs / 1000, unsigned(event.timestampNs % 1000));
+            switch (event.type) {
+                case EventType::Complete:
+                    fprintf(file, ",\"ph\":\"X\",\"dur\":%" PRIu64 ".%03u}",
+                            event.durationNs / 1000, unsigned(event.durationNs % 1000));
+                    break;
+                case EventType::Counter:
+                    fputs(",\"ph\":\"C\",\"args\":{", file);
+                    writeJsonString(file, event.name);
+                    // JSON没有NaN和无穷大，非有限值写成null
+                    if (std::isfinite(event.value)) {
+                        fprintf(file, ":%.17g}}", event.value);
+                    } else {
+                        fputs(":null}}", file);
+                    }
+                    break;
+                case EventType::Instant:
+                    fputs(",\"ph\":\"i\",\"s\":\"g\"}", file);
+                    break;
+            }
+            ++eventCount;
+        }
+    }
+
+    fputs("\n]}\n", file);
+    bool ok = ferror(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    LOGI("导出了 %zu 个trace事件到 %s", eventCount, path.c_str());
+    return ok;
+}
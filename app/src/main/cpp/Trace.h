@@ -0,0 +1,148 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TRACE_H
+#define ANDROIDGLINVESTIGATIONS_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*!
+ * 编译期开关。为0时所有TRACE_宏展开为空；默认编译进来，运行期再决定是否记录
+ */
+#ifndef TRACE_COMPILED_IN
+#define TRACE_COMPILED_IN 1
+#endif
+
+/*!
+ * 轻量级的性能追踪。
+ *
+ * 每个线程在第一次记录时分配一个固定大小的事件缓冲区，之后的记录只写入这个缓冲区，
+ * 不加锁、不分配内存。缓冲区写满后从头覆盖最旧的事件，所以可以长时间开启，
+ * 需要时导出最近一段时间的数据。导出格式为Chrome trace-event JSON，
+ * 可以直接在 chrome://tracing 或 ui.perfetto.dev 中打开。
+ *
+ * 运行期关闭时，每个记录点只有一次relaxed原子读和一个分支。
+ */
+class Trace {
+public:
+    //! 事件类型，对应trace-event格式中的ph字段
+    enum class EventType : uint8_t {
+        Complete, // 'X'，带持续时间的区间
+        Counter,  // 'C'，计数器采样
+        Instant,  // 'i'，瞬时事件，用作帧标记
+    };
+
+    //! 单个事件，名字必须指向静态存储期的字符串
+    struct Event {
+        uint64_t timestampNs;
+        uint64_t durationNs;
+        const char *name;
+        double value;
+        EventType type;
+    };
+
+    //! 每个线程缓冲区可容纳的事件数
+    static constexpr uint32_t kEventsPerThread = 16384;
+
+    inline static bool isEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * 开始或停止记录。停止后已记录的事件保留，可以继续导出
+     */
+    static void setEnabled(bool enabled);
+
+    /*!
+     * @return 单调时钟的当前时间（纳秒）
+     */
+    static uint64_t now();
+
+    /*!
+     * 为当前线程设置在trace中显示的名字
+     * @param name 线程名，必须指向静态存储期的字符串
+     */
+    static void setThreadName(const char *name);
+
+    /*!
+     * 记录一个已经结束的区间
+     */
+    static void recordZone(const char *name, uint64_t startNs, uint64_t endNs);
+
+    /*!
+     * 记录一个计数器采样
+     */
+    static void recordCounter(const char *name, double value);
+
+    /*!
+     * 记录一帧的结束
+     */
+    static void recordFrameMark();
+
+    /*!
+     * 清空所有线程缓冲区中的事件，之后的导出只包含此后记录的事件
+     */
+    static void clear();
+
+    /*!
+     * 把所有线程当前缓冲区中的事件写成Chrome trace-event JSON文件。
+     * 可以在其他线程正在记录时调用，导出期间被覆盖或还没写完的事件不包含在内
+     *
+     * @param path 输出文件路径
+     * @return 成功写入返回true
+     */
+    static bool exportJson(const std::string &path);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+/*!
+ * RAII区间。构造时记录开始时间，析构时写入一个Complete事件。
+ * 构造时追踪处于关闭状态则整个区间被忽略
+ */
+class TraceZone {
+public:
+    inline explicit TraceZone(const char *name)
+            : name_(name),
+              startNs_(Trace::isEnabled() ? Trace::now() : 0) {}
+
+    inline ~TraceZone() {
+        if (startNs_) {
+            Trace::recordZone(name_, startNs_, Trace::now());
+        }
+    }
+
+    TraceZone(const TraceZone &) = delete;
+
+    TraceZone &operator=(const TraceZone &) = delete;
+
+private:
+    const char *name_;
+    uint64_t startNs_;
+};
+
+#if TRACE_COMPILED_IN
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+//! 在当前作用域内记录一个名为name的区间
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone_, __LINE__)(name)
+
+//! 记录一个计数器采样
+#define TRACE_COUNTER(name, value) \
+    do { if (Trace::isEnabled()) Trace::recordCounter(name, value); } while (0)
+
+//! 标记一帧的结束
+#define TRACE_FRAME_MARK() \
+    do { if (Trace::isEnabled()) Trace::recordFrameMark(); } while (0)
+
+#else
+
+#define TRACE_ZONE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_FRAME_MARK() do {} while (0)
+
+#endif
+
+#endif //ANDROIDGLINVESTIGATIONS_TRACE_H
@@ -0,0 +1,163 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+TransformHierarchy::NodeId TransformHierarchy::createNode(NodeId parent) {
+    auto id = static_cast<NodeId>(slotOf_.size());
+    auto slot = static_cast<uint32_t>(idOf_.size());
+
+    uint32_t parentSlot = kInvalidNode;
+    uint32_t depth = 0;
+    if (parent != kInvalidNode) {
+        assert(parent < slotOf_.size());
+        parentSlot = slotOf_[parent];
+        depth = depth_[parentSlot] + 1;
+    }
+
+    // 追加在末尾总能保证父节点在前；只有深度比末尾节点浅时才破坏按层连续的顺序
+    if (!depth_.empty() && depth < depth_.back()) {
+        layoutDirty_ = true;
+    }
+
+    translation_.push_back(Vec3{0.f, 0.f, 0.f, 0.f});
+    rotation_.push_back(Quat::identity());
+    scale_.push_back(Vec3{1.f, 1.f, 1.f, 0.f});
+    world_.push_back(Mat4::identity());
+    parent_.push_back(parentSlot);
+    depth_.push_back(depth);
+    dirty_.push_back(1);
+    changed_.push_back(0);
+    idOf_.push_back(id);
+    slotOf_.push_back(slot);
+    return id;
+}
+
+void TransformHierarchy::setLocalTranslation(NodeId node, const Vec3 &translation) {
+    translation_[slotOf_[node]] = translation;
+    markDirty(node);
+}
+
+void TransformHierarchy::setLocalRotation(NodeId node, const Quat &rotation) {
+    rotation_[slotOf_[node]] = rotation;
+    markDirty(node);
+}
+
+void TransformHierarchy::setLocalScale(NodeId node, const Vec3 &scale) {
+    scale_[slotOf_[node]] = scale;
+    markDirty(node);
+}
+
+void TransformHierarchy::setLocalTRS(
+        NodeId node,
+        const Vec3 &translation,
+        const Quat &rotation,
+        const Vec3 &scale) {
+    uint32_t slot = slotOf_[node];
+    translation_[slot] = translation;
+    rotation_[slot] = rotation;
+    scale_[slot] = scale;
+    dirty_[slot] = 1;
+}
+
+void TransformHierarchy::reserve(size_t count) {
+    translation_.reserve(count);
+    rotation_.reserve(count);
+    scale_.reserve(count);
+    world_.reserve(count);
+    parent_.reserve(count);
+    depth_.reserve(count);
+    dirty_.reserve(count);
+    changed_.reserve(count);
+    idOf_.reserve(count);
+    slotOf_.reserve(count);
+}
+
+size_t TransformHierarchy::update() {
+    if (layoutDirty_) {
+        rebuildLayout();
+    }
+
+    // 父节点总在子节点之前，一次顺序遍历即可把修改传播到整棵子树
+    size_t recomputed = 0;
+    const size_t count = idOf_.size();
+    for (size_t slot = 0; slot < count; slot++) {
+        uint32_t parentSlot = parent_[slot];
+        bool parentChanged = parentSlot != kInvalidNode && changed_[parentSlot];
+        if (!dirty_[slot] && !parentChanged) {
+            changed_[slot] = 0;
+            continue;
+        }
+
+        Mat4 local = Mat4::fromTRS(translation_[slot], rotation_[slot], scale_[slot]);
+        world_[slot] = parentSlot == kInvalidNode ? local : world_[parentSlot] * local;
+        dirty_[slot] = 0;
+        changed_[slot] = 1;
+        recomputed++;
+    }
+    return recomputed;
+}
+
+void TransformHierarchy::rebuildLayout() {
+    const auto count = static_cast<uint32_t>(idOf_.size());
+
+    // 先按深度做稳定的计数排序
+    uint32_t maxDepth = *std::max_element(depth_.begin(), depth_.end());
+    std::vector<uint32_t> levelStart(maxDepth + 2, 0);
+    for (uint32_t slot = 0; slot < count; slot++) {
+        levelStart[depth_[slot] + 1]++;
+    }
+    for (uint32_t level = 1; level < levelStart.size(); level++) {
+        levelStart[level] += levelStart[level - 1];
+    }
+    std::vector<uint32_t> order(count);
+    {
+        std::vector<uint32_t> cursor(levelStart.begin(), levelStart.end() - 1);
+        for (uint32_t slot = 0; slot < count; slot++) {
+            order[cursor[depth_[slot]]++] = slot;
+        }
+    }
+
+    // 再逐层按父节点的新位置稳定排序，让兄弟节点连续存放
+    std::vector<uint32_t> newSlot(count);
+    for (uint32_t level = 0; level <= maxDepth; level++) {
+        auto begin = order.begin() + levelStart[level];
+        auto end = order.begin() + levelStart[level + 1];
+        if (level > 0) {
+            std::stable_sort(begin, end, [this, &newSlot](uint32_t a, uint32_t b) {
+                return newSlot[parent_[a]] < newSlot[parent_[b]];
+            });
+        }
+        for (auto it = begin; it != end; ++it) {
+            newSlot[*it] = static_cast<uint32_t>(it - order.begin());
+        }
+    }
+
+    auto permute = [&order](auto &values) {
+        std::remove_reference_t<decltype(values)> permuted;
+        permuted.reserve(values.capacity());
+        for (uint32_t oldSlot: order) {
+            permuted.push_back(values[oldSlot]);
+        }
+        values.swap(permuted);
+    };
+    permute(translation_);
+    permute(rotation_);
+    permute(scale_);
+    permute(world_);
+    permute(depth_);
+    permute(dirty_);
+    permute(changed_);
+    permute(idOf_);
+    permute(parent_);
+    for (auto &parentSlot: parent_) {
+        if (parentSlot != kInvalidNode) {
+            parentSlot = newSlot[parentSlot];
+        }
+    }
+    for (uint32_t slot = 0; slot < count; slot++) {
+        slotOf_[idOf_[slot]] = slot;
+    }
+    layoutDirty_ = false;
+}
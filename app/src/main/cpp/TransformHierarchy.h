@@ -0,0 +1,87 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TRANSFORMHIERARCHY_H
+#define ANDROIDGLINVESTIGATIONS_TRANSFORMHIERARCHY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "VecMath.h"
+
+/*!
+ * 变换层级（场景图）。
+ *
+ * 每个节点有局部的平移/旋转/缩放、父节点和缓存的世界矩阵。节点数据按广度优先顺序
+ * 连续存放（父节点总在子节点之前），所以 @a update 只需要一次顺序遍历：
+ * 只有被修改过的节点及其子树会重新计算世界矩阵，其余节点只检查一个标志字节。
+ *
+ * 外部使用稳定的 @a NodeId 引用节点，内部存储位置在结构变化后可能重排。
+ */
+class TransformHierarchy {
+public:
+    using NodeId = uint32_t;
+
+    static constexpr NodeId kInvalidNode = 0xFFFFFFFFu;
+
+    /*!
+     * 创建一个节点，初始局部变换为单位变换
+     * @param parent 父节点，kInvalidNode表示根节点
+     * @return 新节点的id
+     */
+    NodeId createNode(NodeId parent = kInvalidNode);
+
+    void setLocalTranslation(NodeId node, const Vec3 &translation);
+
+    void setLocalRotation(NodeId node, const Quat &rotation);
+
+    void setLocalScale(NodeId node, const Vec3 &scale);
+
+    void setLocalTRS(NodeId node, const Vec3 &translation, const Quat &rotation, const Vec3 &scale);
+
+    /*!
+     * 重新计算所有被修改过的子树的世界矩阵
+     * @return 本次重新计算的节点数
+     */
+    size_t update();
+
+    /*!
+     * @return 节点的世界矩阵，在 @a update 之后有效
+     */
+    inline const Mat4 &getWorldMatrix(NodeId node) const {
+        return world_[slotOf_[node]];
+    }
+
+    inline NodeId getParent(NodeId node) const {
+        uint32_t parentSlot = parent_[slotOf_[node]];
+        return parentSlot == kInvalidNode ? kInvalidNode : idOf_[parentSlot];
+    }
+
+    inline size_t size() const { return idOf_.size(); }
+
+    /*!
+     * 预留容量，避免批量创建节点时反复扩容
+     */
+    void reserve(size_t count);
+
+private:
+    // 按深度重排存储，使父节点总在子节点之前且同一层的节点连续
+    void rebuildLayout();
+
+    inline void markDirty(NodeId node) {
+        dirty_[slotOf_[node]] = 1;
+    }
+
+    // 以下数组都按存储位置（slot）索引
+    std::vector<Vec3> translation_;
+    std::vector<Quat> rotation_;
+    std::vector<Vec3> scale_;
+    std::vector<Mat4> world_;
+    std::vector<uint32_t> parent_; // 父节点的slot，根节点为kInvalidNode
+    std::vector<uint32_t> depth_;
+    std::vector<uint8_t> dirty_;   // 局部变换被修改过
+    std::vector<uint8_t> changed_; // 本次update中世界矩阵发生了变化，用于向子节点传播
+    std::vector<NodeId> idOf_;     // slot -> NodeId
+
+    std::vector<uint32_t> slotOf_; // NodeId -> slot
+    bool layoutDirty_ = false;     // 新节点是否破坏了广度优先顺序
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TRANSFORMHIERARCHY_H
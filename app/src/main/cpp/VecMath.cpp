@@ -0,0 +1,413 @@
+#include "VecMath.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr float kDegreesToRadians = float(M_PI / 180.0);
+
+#if VECMATH_SSE || VECMATH_NEON
+
+// 求逆用到的四通道运算，两个后端共用同一份算法
+#if VECMATH_SSE
+using Float4 = __m128;
+
+inline Float4 load4(const float *p) { return _mm_load_ps(p); }
+
+inline void store4(float *p, Float4 v) { _mm_store_ps(p, v); }
+
+inline Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+
+inline Float4 sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+
+inline Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+
+inline Float4 div4(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+
+inline Float4 set4(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+
+inline float lane0(Float4 v) { return _mm_cvtss_f32(v); }
+
+// 结果为 (a[x], a[y], b[z], b[w])
+#define VECMATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#else
+using Float4 = float32x4_t;
+
+inline Float4 load4(const float *p) { return vld1q_f32(p); }
+
+inline void store4(float *p, Float4 v) { vst1q_f32(p, v); }
+
+inline Float4 add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+
+inline Float4 sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+
+inline Float4 mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+
+inline Float4 div4(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+
+inline Float4 set4(float x, float y, float z, float w) {
+    const float values[4] = {x, y, z, w};
+    return vld1q_f32(values);
+}
+
+inline float lane0(Float4 v) { return vgetq_lane_f32(v, 0); }
+
+// NEON没有通用的四通道重排指令，由编译器按下标选出 dup/ext/zip/uzp/rev 的组合
+#define VECMATH_SHUFFLE(a, b, x, y, z, w) __builtin_shufflevector(a, b, x, y, (z) + 4, (w) + 4)
+#endif
+
+#define VECMATH_SWIZZLE(a, x, y, z, w) VECMATH_SHUFFLE(a, a, x, y, z, w)
+
+// 2x2矩阵按 (x00, x01, x10, x11) 存放在一个向量中，adj表示伴随矩阵
+
+// a * b
+inline Float4 mat2Mul(Float4 a, Float4 b) {
+    return add4(mul4(a, VECMATH_SWIZZLE(b, 0, 3, 0, 3)),
+                mul4(VECMATH_SWIZZLE(a, 1, 0, 3, 2), VECMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(a) * b
+inline Float4 mat2AdjMul(Float4 a, Float4 b) {
+    return sub4(mul4(VECMATH_SWIZZLE(a, 3, 3, 0, 0), b),
+                mul4(VECMATH_SWIZZLE(a, 1, 1, 2, 2), VECMATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adj(b)
+inline Float4 mat2MulAdj(Float4 a, Float4 b) {
+    return sub4(mul4(a, VECMATH_SWIZZLE(b, 3, 0, 3, 0)),
+                mul4(VECMATH_SWIZZLE(a, 1, 0, 3, 2), VECMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+#endif
+
+} // namespace
+
+Quat Quat::fromAxisAngle(const Vec3 &axis, float angleRadians) {
+    float s = sinf(angleRadians * 0.5f);
+    return Quat{axis.x * s, axis.y * s, axis.z * s, cosf(angleRadians * 0.5f)};
+}
+
+Quat Quat::fromEulerDegrees(float angleXDegrees, float angleYDegrees, float angleZDegrees) {
+    // buildRotationMatrix3D的三个基础矩阵都是按列主序解释的标准旋转矩阵的转置，
+    // 等价于绕各轴旋转负角度，组合顺序为 Y * X * Z
+    Quat qx = fromAxisAngle(Vec3{1.f, 0.f, 0.f, 0.f}, -angleXDegrees * kDegreesToRadians);
+    Quat qy = fromAxisAngle(Vec3{0.f, 1.f, 0.f, 0.f}, -angleYDegrees * kDegreesToRadians);
+    Quat qz = fromAxisAngle(Vec3{0.f, 0.f, 1.f, 0.f}, -angleZDegrees * kDegreesToRadians);
+    return qy * qx * qz;
+}
+
+Mat4 Mat4::identity() {
+    Mat4 result = {};
+    result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.f;
+    return result;
+}
+
+Mat4 Mat4::fromArray(const float *values) {
+    Mat4 result;
+    for (int i = 0; i < 16; i++) {
+        result.m[i] = values[i];
+    }
+    return result;
+}
+
+Mat4 Mat4::translation(float x, float y, float z) {
+    Mat4 result = identity();
+    result.m[12] = x;
+    result.m[13] = y;
+    result.m[14] = z;
+    return result;
+}
+
+Mat4 Mat4::scale(float x, float y, float z) {
+    Mat4 result = {};
+    result.m[0] = x;
+    result.m[5] = y;
+    result.m[10] = z;
+    result.m[15] = 1.f;
+    return result;
+}
+
+Mat4 Mat4::rotationZ(float angleRadians) {
+    float c = cosf(angleRadians);
+    float s = sinf(angleRadians);
+    Mat4 result = identity();
+    result.m[0] = c;
+    result.m[1] = s;
+    result.m[4] = -s;
+    result.m[5] = c;
+    return result;
+}
+
+Mat4 Mat4::rotationEulerDegrees(float angleXDegrees, float angleYDegrees, float angleZDegrees) {
+    float ax = angleXDegrees * kDegreesToRadians;
+    float ay = angleYDegrees * kDegreesToRadians;
+    float az = angleZDegrees * kDegreesToRadians;
+    float cx = cosf(ax), sx = sinf(ax);
+    float cy = cosf(ay), sy = sinf(ay);
+    float cz = cosf(az), sz = sinf(az);
+
+    // 展开 Ry(-y) * Rx(-x) * Rz(-z)，结果按列主序存放
+    Mat4 result;
+    result.m[0] = cy * cz - sy * sx * sz;
+    result.m[1] = -cx * sz;
+    result.m[2] = sy * cz + cy * sx * sz;
+    result.m[3] = 0.f;
+
+    result.m[4] = cy * sz + sy * sx * cz;
+    result.m[5] = cx * cz;
+    result.m[6] = sy * sz - cy * sx * cz;
+    result.m[7] = 0.f;
+
+    result.m[8] = -sy * cx;
+    result.m[9] = sx;
+    result.m[10] = cy * cx;
+    result.m[11] = 0.f;
+
+    result.m[12] = 0.f;
+    result.m[13] = 0.f;
+    result.m[14] = 0.f;
+    result.m[15] = 1.f;
+    return result;
+}
+
+Mat4 Mat4::fromQuat(const Quat &q) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    Mat4 result;
+    result.m[0] = 1.f - 2.f * (yy + zz);
+    result.m[1] = 2.f * (xy + wz);
+    result.m[2] = 2.f * (xz - wy);
+    result.m[3] = 0.f;
+
+    result.m[4] = 2.f * (xy - wz);
+    result.m[5] = 1.f - 2.f * (xx + zz);
+    result.m[6] = 2.f * (yz + wx);
+    result.m[7] = 0.f;
+
+    result.m[8] = 2.f * (xz + wy);
+    result.m[9] = 2.f * (yz - wx);
+    result.m[10] = 1.f - 2.f * (xx + yy);
+    result.m[11] = 0.f;
+
+    result.m[12] = 0.f;
+    result.m[13] = 0.f;
+    result.m[14] = 0.f;
+    result.m[15] = 1.f;
+    return result;
+}
+
+Mat4 Mat4::fromTRS(const Vec3 &translation, const Quat &rotation, const Vec3 &scale) {
+    Mat4 result = fromQuat(rotation);
+    for (int row = 0; row < 3; row++) {
+        result.m[row] *= scale.x;
+        result.m[4 + row] *= scale.y;
+        result.m[8 + row] *= scale.z;
+    }
+    result.m[12] = translation.x;
+    result.m[13] = translation.y;
+    result.m[14] = translation.z;
+    return result;
+}
+
+Mat4 Mat4::orthographic(float halfHeight, float aspect, float near, float far) {
+    float halfWidth = halfHeight * aspect;
+    Mat4 result = {};
+    result.m[0] = 1.f / halfWidth;
+    result.m[5] = 1.f / halfHeight;
+    result.m[10] = -2.f / (far - near);
+    result.m[14] = -(far + near) / (far - near);
+    result.m[15] = 1.f;
+    return result;
+}
+
+Mat4 Mat4::perspective(float fovYDegrees, float aspect, float near, float far) {
+    float f = 1.0f / tanf(fovYDegrees * kDegreesToRadians / 2.0f); // 焦距
+    float rangeInv = 1.0f / (near - far);
+    Mat4 result = {};
+    result.m[0] = f / aspect;
+    result.m[5] = f;
+    result.m[10] = (far + near) * rangeInv;
+    result.m[11] = -1.0f;
+    result.m[14] = 2.0f * far * near * rangeInv;
+    return result;
+}
+
+void transformBatchScalar(const Mat4 &a, const Vec4 *in, Vec4 *out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = transformScalar(a, in[i]);
+    }
+}
+
+void transformBatch(const Mat4 &a, const Vec4 *in, Vec4 *out, size_t count) {
+    size_t i = 0;
+#if VECMATH_SSE && defined(__AVX__)
+    // 一次处理两个向量：每个128位通道各放一个，矩阵列在两个通道中重复。
+    // Vec4只保证16字节对齐，两个向量的读写不一定对齐到32字节
+    __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.m));
+    __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.m + 4));
+    __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.m + 8));
+    __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.m + 12));
+    for (; i + 2 <= count; i += 2) {
+        __m256 v = _mm256_loadu_ps(&in[i].x);
+        __m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF)));
+        _mm256_storeu_ps(&out[i].x, r);
+    }
+#elif VECMATH_SSE
+    __m128 c0 = _mm_load_ps(a.m);
+    __m128 c1 = _mm_load_ps(a.m + 4);
+    __m128 c2 = _mm_load_ps(a.m + 8);
+    __m128 c3 = _mm_load_ps(a.m + 12);
+    for (; i < count; i++) {
+        __m128 v = _mm_load_ps(&in[i].x);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xAA)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xFF)));
+        _mm_store_ps(&out[i].x, r);
+    }
+#elif VECMATH_NEON
+    float32x4_t c0 = vld1q_f32(a.m);
+    float32x4_t c1 = vld1q_f32(a.m + 4);
+    float32x4_t c2 = vld1q_f32(a.m + 8);
+    float32x4_t c3 = vld1q_f32(a.m + 12);
+    for (; i < count; i++) {
+        float32x4_t v = vld1q_f32(&in[i].x);
+        float32x4_t r = vmulq_laneq_f32(c0, v, 0);
+        r = vaddq_f32(r, vmulq_laneq_f32(c1, v, 1));
+        r = vaddq_f32(r, vmulq_laneq_f32(c2, v, 2));
+        r = vaddq_f32(r, vmulq_laneq_f32(c3, v, 3));
+        vst1q_f32(&out[i].x, r);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = transformScalar(a, in[i]);
+    }
+}
+
+bool inverseScalar(const Mat4 &a, Mat4 &out) {
+    // 余子式展开，m为列主序
+    const float *m = a.m;
+    float inv[16];
+
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15]
+             + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15]
+             - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15]
+             + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14]
+              - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15]
+             - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15]
+             + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15]
+             - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14]
+              + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15]
+             + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15]
+             - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15]
+              + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14]
+              - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11]
+             - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11]
+             + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11]
+              - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10]
+              + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.f) {
+        return false;
+    }
+
+    float invDet = 1.f / det;
+    for (int i = 0; i < 16; i++) {
+        out.m[i] = inv[i] * invDet;
+    }
+    return true;
+}
+
+bool inverse(const Mat4 &a, Mat4 &out) {
+#if VECMATH_SSE || VECMATH_NEON
+    // 分块求逆。四列当作四行读入得到的是转置矩阵，它的逆按行存放就是原矩阵的逆按列存放。
+    // 记 M = | A B |，则 M^-1 = 1/|M| * | X Y |，X、Y、Z、W 是下面各式结果的伴随矩阵
+    //        | C D |                    | Z W |
+    Float4 r0 = load4(a.m);
+    Float4 r1 = load4(a.m + 4);
+    Float4 r2 = load4(a.m + 8);
+    Float4 r3 = load4(a.m + 12);
+    Float4 blockA = VECMATH_SHUFFLE(r0, r1, 0, 1, 0, 1);
+    Float4 blockB = VECMATH_SHUFFLE(r0, r1, 2, 3, 2, 3);
+    Float4 blockC = VECMATH_SHUFFLE(r2, r3, 0, 1, 0, 1);
+    Float4 blockD = VECMATH_SHUFFLE(r2, r3, 2, 3, 2, 3);
+
+    // 四个块的行列式 (|A|, |B|, |C|, |D|)
+    Float4 blockDets = sub4(mul4(VECMATH_SHUFFLE(r0, r2, 0, 2, 0, 2), VECMATH_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+                            mul4(VECMATH_SHUFFLE(r0, r2, 1, 3, 1, 3), VECMATH_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    Float4 detA = VECMATH_SWIZZLE(blockDets, 0, 0, 0, 0);
+    Float4 detB = VECMATH_SWIZZLE(blockDets, 1, 1, 1, 1);
+    Float4 detC = VECMATH_SWIZZLE(blockDets, 2, 2, 2, 2);
+    Float4 detD = VECMATH_SWIZZLE(blockDets, 3, 3, 3, 3);
+
+    Float4 adjDC = mat2AdjMul(blockD, blockC);
+    Float4 adjAB = mat2AdjMul(blockA, blockB);
+    // adj(X) = |D|A - B adj(D)C，adj(W) = |A|D - C adj(A)B
+    Float4 x = sub4(mul4(detD, blockA), mat2Mul(blockB, adjDC));
+    Float4 w = sub4(mul4(detA, blockD), mat2Mul(blockC, adjAB));
+    // adj(Y) = |B|C - D adj(adj(A)B)，adj(Z) = |C|B - A adj(adj(D)C)
+    Float4 y = sub4(mul4(detB, blockC), mat2MulAdj(blockD, adjAB));
+    Float4 z = sub4(mul4(detC, blockB), mat2MulAdj(blockA, adjDC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)，迹的四项加到每个通道
+    Float4 trace = mul4(adjAB, VECMATH_SWIZZLE(adjDC, 0, 2, 1, 3));
+    trace = add4(trace, VECMATH_SWIZZLE(trace, 1, 0, 3, 2));
+    trace = add4(trace, VECMATH_SWIZZLE(trace, 2, 3, 0, 1));
+    Float4 det = sub4(add4(mul4(detA, detD), mul4(detB, detC)), trace);
+    if (lane0(det) == 0.f) {
+        return false;
+    }
+
+    // 乘以 (1, -1, -1, 1) / |M| 同时完成伴随矩阵的取负，取伴随矩阵的重排并入最后的存储
+    Float4 invDet = div4(set4(1.f, -1.f, -1.f, 1.f), det);
+    x = mul4(x, invDet);
+    y = mul4(y, invDet);
+    z = mul4(z, invDet);
+    w = mul4(w, invDet);
+    store4(out.m, VECMATH_SHUFFLE(x, y, 3, 1, 3, 1));
+    store4(out.m + 4, VECMATH_SHUFFLE(x, y, 2, 0, 2, 0));
+    store4(out.m + 8, VECMATH_SHUFFLE(z, w, 3, 1, 3, 1));
+    store4(out.m + 12, VECMATH_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+#else
+    return inverseScalar(a, out);
+#endif
+}
+
+Quat operator*(const Quat &a, const Quat &b) {
+    return Quat{
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+Quat normalize(const Quat &q) {
+    float lengthSquared = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    if (lengthSquared == 0.f) {
+        return Quat::identity();
+    }
+    float invLength = 1.f / sqrtf(lengthSquared);
+    return Quat{q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength};
+}
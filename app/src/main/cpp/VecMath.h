@@ -0,0 +1,263 @@
+#ifndef ANDROIDGLINVESTIGATIONS_VECMATH_H
+#define ANDROIDGLINVESTIGATIONS_VECMATH_H
+
+#include <cstddef>
+
+#if defined(__aarch64__)
+#define VECMATH_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(__x86_64__)
+#define VECMATH_SSE 1
+#include <immintrin.h>
+#endif
+
+/*!
+ * 小型向量/矩阵数学库。所有类型都按16字节对齐，矩阵为列主序，可以直接传给glUniformMatrix4fv。
+ *
+ * ARM64上使用NEON，x86上使用SSE（批量变换在有AVX时使用AVX），其他平台使用标量实现。
+ * SIMD实现与带Scalar后缀的标量参考实现按完全相同的顺序做乘法和加法，
+ * 在关闭浮点收缩（-ffp-contract=off）的前提下结果逐位一致；求逆例外，见 inverse。
+ */
+
+struct alignas(16) Vec3 {
+    float x, y, z;
+    float pad; // 补齐到16字节，保证SIMD整行读写安全
+};
+
+struct alignas(16) Vec4 {
+    float x, y, z, w;
+};
+
+//! 单位四元数表示的旋转，w为实部
+struct alignas(16) Quat {
+    float x, y, z, w;
+
+    static inline Quat identity() { return Quat{0.f, 0.f, 0.f, 1.f}; }
+
+    /*!
+     * @param axis 旋转轴，必须已归一化
+     * @param angleRadians 旋转角度（弧度）
+     */
+    static Quat fromAxisAngle(const Vec3 &axis, float angleRadians);
+
+    /*!
+     * 按与 Utility::buildRotationMatrix3D 相同的约定从欧拉角构造四元数
+     */
+    static Quat fromEulerDegrees(float angleXDegrees, float angleYDegrees, float angleZDegrees);
+};
+
+//! 4x4矩阵，列主序：m[col * 4 + row]
+struct alignas(16) Mat4 {
+    float m[16];
+
+    static Mat4 identity();
+
+    static Mat4 fromArray(const float *values);
+
+    inline void store(float *out) const {
+        for (int i = 0; i < 16; i++) {
+            out[i] = m[i];
+        }
+    }
+
+    constexpr float operator()(int row, int col) const { return m[col * 4 + row]; }
+
+    static Mat4 translation(float x, float y, float z);
+
+    static Mat4 scale(float x, float y, float z);
+
+    static Mat4 rotationZ(float angleRadians);
+
+    /*!
+     * 与 Utility::buildRotationMatrix3D 的结果一致的欧拉角旋转矩阵，直接用闭式解生成，
+     * 不需要构造三个矩阵再相乘
+     */
+    static Mat4 rotationEulerDegrees(float angleXDegrees, float angleYDegrees, float angleZDegrees);
+
+    static Mat4 fromQuat(const Quat &q);
+
+    /*!
+     * 由平移、旋转、缩放组合成 T * R * S
+     */
+    static Mat4 fromTRS(const Vec3 &translation, const Quat &rotation, const Vec3 &scale);
+
+    static Mat4 orthographic(float halfHeight, float aspect, float near, float far);
+
+    static Mat4 perspective(float fovYDegrees, float aspect, float near, float far);
+};
+
+//! 当前编译所用的SIMD后端名字，便于在日志和基准测试中区分
+#if VECMATH_NEON
+constexpr const char *kVecMathBackend = "neon";
+#elif VECMATH_SSE && defined(__AVX__)
+constexpr const char *kVecMathBackend = "sse+avx";
+#elif VECMATH_SSE
+constexpr const char *kVecMathBackend = "sse";
+#else
+constexpr const char *kVecMathBackend = "scalar";
+#endif
+
+// ---------------------------------------------------------------------------
+// 标量参考实现
+// ---------------------------------------------------------------------------
+
+inline Mat4 multiplyScalar(const Mat4 &a, const Mat4 &b) {
+    Mat4 result;
+    for (int col = 0; col < 4; col++) {
+        const float *bc = b.m + col * 4;
+        for (int row = 0; row < 4; row++) {
+            float r = a.m[row] * bc[0];
+            r = r + a.m[4 + row] * bc[1];
+            r = r + a.m[8 + row] * bc[2];
+            r = r + a.m[12 + row] * bc[3];
+            result.m[col * 4 + row] = r;
+        }
+    }
+    return result;
+}
+
+inline Mat4 transposeScalar(const Mat4 &a) {
+    Mat4 result;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            result.m[row * 4 + col] = a.m[col * 4 + row];
+        }
+    }
+    return result;
+}
+
+inline Vec4 transformScalar(const Mat4 &a, const Vec4 &v) {
+    float out[4];
+    for (int row = 0; row < 4; row++) {
+        float r = a.m[row] * v.x;
+        r = r + a.m[4 + row] * v.y;
+        r = r + a.m[8 + row] * v.z;
+        r = r + a.m[12 + row] * v.w;
+        out[row] = r;
+    }
+    return Vec4{out[0], out[1], out[2], out[3]};
+}
+
+void transformBatchScalar(const Mat4 &a, const Vec4 *in, Vec4 *out, size_t count);
+
+//! 余子式展开求逆，参数和返回值与 inverse 相同
+bool inverseScalar(const Mat4 &a, Mat4 &out);
+
+// ---------------------------------------------------------------------------
+// SIMD实现
+// ---------------------------------------------------------------------------
+
+inline Mat4 operator*(const Mat4 &a, const Mat4 &b) {
+#if VECMATH_NEON
+    float32x4_t a0 = vld1q_f32(a.m);
+    float32x4_t a1 = vld1q_f32(a.m + 4);
+    float32x4_t a2 = vld1q_f32(a.m + 8);
+    float32x4_t a3 = vld1q_f32(a.m + 12);
+    Mat4 result;
+    for (int col = 0; col < 4; col++) {
+        // 整列读入寄存器，按通道广播，不逐个从内存读取标量
+        float32x4_t bc = vld1q_f32(b.m + col * 4);
+        float32x4_t r = vmulq_laneq_f32(a0, bc, 0);
+        r = vaddq_f32(r, vmulq_laneq_f32(a1, bc, 1));
+        r = vaddq_f32(r, vmulq_laneq_f32(a2, bc, 2));
+        r = vaddq_f32(r, vmulq_laneq_f32(a3, bc, 3));
+        vst1q_f32(result.m + col * 4, r);
+    }
+    return result;
+#elif VECMATH_SSE
+    __m128 a0 = _mm_load_ps(a.m);
+    __m128 a1 = _mm_load_ps(a.m + 4);
+    __m128 a2 = _mm_load_ps(a.m + 8);
+    __m128 a3 = _mm_load_ps(a.m + 12);
+    Mat4 result;
+    for (int col = 0; col < 4; col++) {
+        // 整列读入寄存器后用shufps广播，_mm_set1_ps会逐个从内存读取标量再广播
+        __m128 bc = _mm_load_ps(b.m + col * 4);
+        __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_store_ps(result.m + col * 4, r);
+    }
+    return result;
+#else
+    return multiplyScalar(a, b);
+#endif
+}
+
+inline Mat4 transpose(const Mat4 &a) {
+#if VECMATH_NEON
+    // vld4q按4路交错读取，恰好得到转置后的四列
+    float32x4x4_t rows = vld4q_f32(a.m);
+    Mat4 result;
+    vst1q_f32(result.m, rows.val[0]);
+    vst1q_f32(result.m + 4, rows.val[1]);
+    vst1q_f32(result.m + 8, rows.val[2]);
+    vst1q_f32(result.m + 12, rows.val[3]);
+    return result;
+#elif VECMATH_SSE
+    __m128 c0 = _mm_load_ps(a.m);
+    __m128 c1 = _mm_load_ps(a.m + 4);
+    __m128 c2 = _mm_load_ps(a.m + 8);
+    __m128 c3 = _mm_load_ps(a.m + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    Mat4 result;
+    _mm_store_ps(result.m, c0);
+    _mm_store_ps(result.m + 4, c1);
+    _mm_store_ps(result.m + 8, c2);
+    _mm_store_ps(result.m + 12, c3);
+    return result;
+#else
+    return transposeScalar(a);
+#endif
+}
+
+inline Vec4 operator*(const Mat4 &a, const Vec4 &v) {
+#if VECMATH_NEON
+    float32x4_t r = vmulq_n_f32(vld1q_f32(a.m), v.x);
+    r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(a.m + 4), v.y));
+    r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(a.m + 8), v.z));
+    r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(a.m + 12), v.w));
+    Vec4 result;
+    vst1q_f32(&result.x, r);
+    return result;
+#elif VECMATH_SSE
+    __m128 r = _mm_mul_ps(_mm_load_ps(a.m), _mm_set1_ps(v.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(a.m + 4), _mm_set1_ps(v.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(a.m + 8), _mm_set1_ps(v.z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(a.m + 12), _mm_set1_ps(v.w)));
+    Vec4 result;
+    _mm_store_ps(&result.x, r);
+    return result;
+#else
+    return transformScalar(a, v);
+#endif
+}
+
+/*!
+ * 变换一个点（w视为1），返回结果的xyz分量
+ */
+inline Vec3 transformPoint(const Mat4 &a, const Vec3 &p) {
+    Vec4 r = a * Vec4{p.x, p.y, p.z, 1.f};
+    return Vec3{r.x, r.y, r.z, 0.f};
+}
+
+/*!
+ * 批量变换。in和out可以是同一个数组
+ */
+void transformBatch(const Mat4 &a, const Vec4 *in, Vec4 *out, size_t count);
+
+/*!
+ * 求逆矩阵。SIMD实现用2x2分块的伴随矩阵计算，运算顺序与 inverseScalar 不同，结果不逐位一致，
+ * 误差与标量实现在同一量级
+ * @param a 输入矩阵
+ * @param out 输出的逆矩阵，矩阵奇异时不修改
+ * @return 矩阵可逆时返回true
+ */
+bool inverse(const Mat4 &a, Mat4 &out);
+
+Quat operator*(const Quat &a, const Quat &b);
+
+Quat normalize(const Quat &q);
+
+#endif //ANDROIDGLINVESTIGATIONS_VECMATH_H
@@ -0,0 +1,488 @@
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 属性字节数向上对齐到4
+constexpr uint32_t alignTo4(uint32_t size) {
+    return (size + 3u) & ~3u;
+}
+
+uint32_t positionSize(PositionFormat format) {
+    switch (format) {
+        case PositionFormat::Float32:
+            return 3 * sizeof(float);
+        case PositionFormat::Half:
+        case PositionFormat::Snorm16:
+            return 3 * sizeof(uint16_t);
+    }
+    return 0;
+}
+
+int16_t toSnorm16(float value) {
+    float clamped = std::min(1.f, std::max(-1.f, value));
+    return static_cast<int16_t>(std::lround(clamped * 32767.f));
+}
+
+// 与GLES 3.0的转换规则一致：max(c / 32767, -1)
+float fromSnorm16(int16_t value) {
+    return std::max(static_cast<float>(value) / 32767.f, -1.f);
+}
+
+uint16_t toUnorm16(float value) {
+    float clamped = std::min(1.f, std::max(0.f, value));
+    return static_cast<uint16_t>(std::lround(clamped * 65535.f));
+}
+
+float fromUnorm16(uint16_t value) {
+    return static_cast<float>(value) / 65535.f;
+}
+
+// 8/16位整数分量的最大值，归一化时除以它
+float integerMaximum(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+            return 127.f;
+        case GL_UNSIGNED_BYTE:
+            return 255.f;
+        case GL_SHORT:
+            return 32767.f;
+        default:
+            return 65535.f;
+    }
+}
+
+size_t componentBytes(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+int32_t readInteger(const uint8_t *in, GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+            return int8_t(in[0]);
+        case GL_UNSIGNED_BYTE:
+            return in[0];
+        case GL_SHORT: {
+            int16_t value;
+            memcpy(&value, in, sizeof(value));
+            return value;
+        }
+        default: {
+            uint16_t value;
+            memcpy(&value, in, sizeof(value));
+            return value;
+        }
+    }
+}
+
+// 按glTF的规则读取一个分量，有符号归一化整数的最小值与它加1等价
+float readComponent(const uint8_t *in, GLenum type, bool normalized) {
+    if (type == GL_FLOAT) {
+        float value;
+        memcpy(&value, in, sizeof(value));
+        return value;
+    }
+    auto value = static_cast<float>(readInteger(in, type));
+    return normalized ? std::max(value / integerMaximum(type), -1.f) : value;
+}
+
+// 还原位置用的参数：position = stored * scale + offset
+struct PositionTransform {
+    Vector3 scale;
+    Vector3 offset;
+};
+
+/*
+ * 整数位置每轴不超过65535个取值时，减去中点后落在[-32767, 32767]内，可以原样存成snorm16。
+ * 还原参数吸收了中点和归一化系数，浮点运算的误差远小于半个整数单位，四舍五入后正好得到原来的整数
+ */
+bool integerPositionTransform(const VertexStreams &streams, PositionTransform &transform) {
+    GLenum type = streams.positionType;
+    if (streams.count == 0
+        || (type != GL_BYTE && type != GL_UNSIGNED_BYTE && type != GL_SHORT && type != GL_UNSIGNED_SHORT)) {
+        return false;
+    }
+    bool clampMinimum = streams.positionNormalized && (type == GL_BYTE || type == GL_SHORT);
+    auto lowest = int32_t(-integerMaximum(type));
+    size_t size = componentBytes(type);
+    int32_t minimum[3] = {INT32_MAX, INT32_MAX, INT32_MAX};
+    int32_t maximum[3] = {INT32_MIN, INT32_MIN, INT32_MIN};
+    for (size_t i = 0; i < streams.count; i++) {
+        const uint8_t *in = streams.position + i * streams.positionStride;
+        for (int axis = 0; axis < 3; axis++) {
+            int32_t value = readInteger(in + axis * size, type);
+            value = clampMinimum ? std::max(value, lowest) : value;
+            minimum[axis] = std::min(minimum[axis], value);
+            maximum[axis] = std::max(maximum[axis], value);
+        }
+    }
+    float unit = streams.positionNormalized ? 1.f / integerMaximum(type) : 1.f;
+    for (int axis = 0; axis < 3; axis++) {
+        if (maximum[axis] - minimum[axis] > 65534) {
+            return false;
+        }
+        int32_t center = (minimum[axis] + maximum[axis]) / 2;
+        transform.scale.idx[axis] = 32767.f * unit;
+        transform.offset.idx[axis] = static_cast<float>(center) * unit;
+    }
+    return true;
+}
+
+// fetch(i)返回第i个输入顶点，两个公开的quantize共用这份实现。preset不为空时直接使用它作为位置的还原参数
+template<typename Fetch>
+QuantizedVertices quantizeFrom(size_t count, const VertexLayout &layout, Fetch fetch,
+                               const PositionTransform *preset = nullptr) {
+    QuantizedVertices result;
+    result.layout = layout;
+    result.vertexCount = count;
+    result.data.assign(count * layout.stride, 0);
+
+    if (layout.isPositionBoundsRelative() && preset) {
+        result.positionScale = preset->scale;
+        result.positionOffset = preset->offset;
+    } else if (layout.isPositionBoundsRelative() && count > 0) {
+        // 计算包围盒，量化后的位置相对包围盒中心并按半边长归一化
+        Vector3 minimum = fetch(0).position;
+        Vector3 maximum = minimum;
+        for (size_t i = 0; i < count; i++) {
+            const Vertex vertex = fetch(i);
+            for (int axis = 0; axis < 3; axis++) {
+                minimum.idx[axis] = std::min(minimum.idx[axis], vertex.position.idx[axis]);
+                maximum.idx[axis] = std::max(maximum.idx[axis], vertex.position.idx[axis]);
+            }
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            result.positionOffset.idx[axis] = 0.5f * (minimum.idx[axis] + maximum.idx[axis]);
+            result.positionScale.idx[axis] = 0.5f * (maximum.idx[axis] - minimum.idx[axis]);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const Vertex vertex = fetch(i);
+        uint8_t *out = result.data.data() + i * layout.stride;
+
+        uint8_t *position = out + layout.position.offset;
+        for (int axis = 0; axis < 3; axis++) {
+            float value = vertex.position.idx[axis];
+            float scale = result.positionScale.idx[axis];
+            float normalized = scale > 0.f ? (value - result.positionOffset.idx[axis]) / scale : 0.f;
+            switch (layout.positionFormat) {
+                case PositionFormat::Float32:
+                    memcpy(position + axis * sizeof(float), &value, sizeof(float));
+                    break;
+                case PositionFormat::Half: {
+                    uint16_t half = VertexFormat::floatToHalf(normalized);
+                    memcpy(position + axis * sizeof(uint16_t), &half, sizeof(uint16_t));
+                    break;
+                }
+                case PositionFormat::Snorm16: {
+                    int16_t snorm = toSnorm16(normalized);
+                    memcpy(position + axis * sizeof(int16_t), &snorm, sizeof(int16_t));
+                    break;
+                }
+            }
+        }
+
+        uint8_t *uv = out + layout.uv.offset;
+        for (int component = 0; component < 2; component++) {
+            float value = vertex.uv.idx[component];
+            if (layout.uvFormat == UVFormat::Unorm16) {
+                uint16_t unorm = toUnorm16(value);
+                memcpy(uv + component * sizeof(uint16_t), &unorm, sizeof(uint16_t));
+            } else {
+                memcpy(uv + component * sizeof(float), &value, sizeof(float));
+            }
+        }
+
+        if (layout.color.isPresent()) {
+            memcpy(out + layout.color.offset, &vertex.color, sizeof(uint32_t));
+        }
+    }
+
+    // 回读一遍，记录实际误差
+    for (size_t i = 0; i < count; i++) {
+        Vertex original = fetch(i);
+        Vertex restored = VertexFormat::dequantize(result, i);
+        for (int axis = 0; axis < 3; axis++) {
+            result.maxPositionError = std::max(
+                    result.maxPositionError,
+                    std::fabs(restored.position.idx[axis] - original.position.idx[axis]));
+        }
+        for (int component = 0; component < 2; component++) {
+            result.maxUVError = std::max(
+                    result.maxUVError,
+                    std::fabs(restored.uv.idx[component] - original.uv.idx[component]));
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+QuantizedVertices VertexFormat::quantize(
+        const std::vector<Vertex> &vertices,
+        const VertexLayout &layout) {
+    return quantizeFrom(vertices.size(), layout, [&](size_t i) -> const Vertex & { return vertices[i]; });
+}
+
+QuantizedVertices VertexFormat::quantize(const VertexStreams &streams, const VertexLayout &layout) {
+    auto fetch = [&](size_t i) { return streams.fetch(i); };
+    PositionTransform transform;
+    if (layout.positionFormat == PositionFormat::Snorm16 && integerPositionTransform(streams, transform)) {
+        return quantizeFrom(streams.count, layout, fetch, &transform);
+    }
+    return quantizeFrom(streams.count, layout, fetch);
+}
+
+Index IndexStream::fetch(size_t index) const {
+    if (!data) {
+        return static_cast<Index>(index);
+    }
+    switch (type) {
+        case GL_UNSIGNED_BYTE:
+            return data[index];
+        case GL_UNSIGNED_SHORT: {
+            uint16_t value;
+            memcpy(&value, data + index * sizeof(uint16_t), sizeof(value));
+            return value;
+        }
+        default: {
+            uint32_t value;
+            memcpy(&value, data + index * sizeof(uint32_t), sizeof(value));
+            return value;
+        }
+    }
+}
+
+Vertex VertexStreams::fetch(size_t index) const {
+    return Vertex(fetchPosition(index), fetchUV(index));
+}
+
+Vector3 VertexStreams::fetchPosition(size_t index) const {
+    const uint8_t *in = position + index * positionStride;
+    Vector3 out;
+    if (positionType == GL_FLOAT) {
+        memcpy(out.idx, in, sizeof(out.idx));
+        return out;
+    }
+    size_t size = componentBytes(positionType);
+    for (int axis = 0; axis < 3; axis++) {
+        out.idx[axis] = readComponent(in + axis * size, positionType, positionNormalized);
+    }
+    return out;
+}
+
+Vector2 VertexStreams::fetchUV(size_t index) const {
+    Vector2 out = {{0.f, 0.f}};
+    if (!uv) {
+        return out;
+    }
+    const uint8_t *in = uv + index * uvStride;
+    size_t size = componentBytes(uvType);
+    for (int component = 0; component < 2; component++) {
+        out.idx[component] = readComponent(in + component * size, uvType, uvNormalized);
+    }
+    return out;
+}
+
+VertexLayout VertexLayout::make(
+        PositionFormat positionFormat,
+        UVFormat uvFormat,
+        ColorFormat colorFormat) {
+    VertexLayout layout;
+    layout.positionFormat = positionFormat;
+    layout.uvFormat = uvFormat;
+    layout.colorFormat = colorFormat;
+
+    uint32_t offset = 0;
+
+    layout.position.components = 3;
+    layout.position.offset = offset;
+    switch (positionFormat) {
+        case PositionFormat::Float32:
+            layout.position.type = GL_FLOAT;
+            break;
+        case PositionFormat::Half:
+            layout.position.type = GL_HALF_FLOAT;
+            break;
+        case PositionFormat::Snorm16:
+            layout.position.type = GL_SHORT;
+            layout.position.normalized = GL_TRUE;
+            break;
+    }
+    offset += alignTo4(positionSize(positionFormat));
+
+    layout.uv.components = 2;
+    layout.uv.offset = offset;
+    if (uvFormat == UVFormat::Unorm16) {
+        layout.uv.type = GL_UNSIGNED_SHORT;
+        layout.uv.normalized = GL_TRUE;
+        offset += 2 * sizeof(uint16_t);
+    } else {
+        layout.uv.type = GL_FLOAT;
+        offset += 2 * sizeof(float);
+    }
+
+    if (colorFormat == ColorFormat::Rgba8) {
+        layout.color.components = 4;
+        layout.color.type = GL_UNSIGNED_BYTE;
+        layout.color.normalized = GL_TRUE;
+        layout.color.offset = offset;
+        offset += sizeof(uint32_t);
+    }
+
+    layout.stride = offset;
+    return layout;
+}
+
+
+Vertex VertexFormat::dequantize(const QuantizedVertices &quantized, size_t index) {
+    assert(index < quantized.vertexCount);
+    const VertexLayout &layout = quantized.layout;
+    const uint8_t *in = quantized.data.data() + index * layout.stride;
+
+    Vertex vertex(Vector3{{0.f, 0.f, 0.f}}, Vector2{{0.f, 0.f}});
+
+    const uint8_t *position = in + layout.position.offset;
+    for (int axis = 0; axis < 3; axis++) {
+        float stored = 0.f;
+        switch (layout.positionFormat) {
+            case PositionFormat::Float32:
+                memcpy(&stored, position + axis * sizeof(float), sizeof(float));
+                break;
+            case PositionFormat::Half: {
+                uint16_t half;
+                memcpy(&half, position + axis * sizeof(uint16_t), sizeof(uint16_t));
+                stored = halfToFloat(half);
+                break;
+            }
+            case PositionFormat::Snorm16: {
+                int16_t snorm;
+                memcpy(&snorm, position + axis * sizeof(int16_t), sizeof(int16_t));
+                stored = fromSnorm16(snorm);
+                break;
+            }
+        }
+        vertex.position.idx[axis] =
+                stored * quantized.positionScale.idx[axis] + quantized.positionOffset.idx[axis];
+    }
+
+    const uint8_t *uv = in + layout.uv.offset;
+    for (int component = 0; component < 2; component++) {
+        if (layout.uvFormat == UVFormat::Unorm16) {
+            uint16_t unorm;
+            memcpy(&unorm, uv + component * sizeof(uint16_t), sizeof(uint16_t));
+            vertex.uv.idx[component] = fromUnorm16(unorm);
+        } else {
+            memcpy(&vertex.uv.idx[component], uv + component * sizeof(float), sizeof(float));
+        }
+    }
+
+    if (layout.color.isPresent()) {
+        memcpy(&vertex.color, in + layout.color.offset, sizeof(uint32_t));
+    }
+    return vertex;
+}
+
+float VertexFormat::positionErrorBound(PositionFormat format, float halfExtent) {
+    // 上界包含半个量化步长以及还原时乘加的float舍入，因此取一个完整步长
+    switch (format) {
+        case PositionFormat::Float32:
+            return 0.f;
+        case PositionFormat::Half:
+            // 归一化坐标在[-1, 1]内，[0.5, 1)区间的half步长为2^-11
+            return halfExtent * std::ldexp(1.f, -11);
+        case PositionFormat::Snorm16:
+            return halfExtent / 32767.f;
+    }
+    return 0.f;
+}
+
+float VertexFormat::uvErrorBound(UVFormat format) {
+    return format == UVFormat::Unorm16 ? 1.f / 65535.f : 0.f;
+}
+
+uint16_t VertexFormat::floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    // NaN和无穷大
+    if (exponent == 0xFFu) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    // 溢出为无穷大
+    if (halfExponent >= 0x1F) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+
+    if (halfExponent <= 0) {
+        // 次正规数，或者小到舍入为0
+        if (halfExponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t halfMantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) {
+            halfMantissa++;
+        }
+        return static_cast<uint16_t>(sign | halfMantissa);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    // 就近舍入到偶数，进位可能自然地进到指数位（包括溢出到无穷大）
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        half++;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float VertexFormat::halfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // 次正规数：规格化后再转换
+        int32_t shift = 0;
+        while (!(mantissa & 0x400u)) {
+            mantissa <<= 1;
+            shift++;
+        }
+        mantissa &= 0x3FFu;
+        bits = sign | (static_cast<uint32_t>(127 - 15 + 1 - shift) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
@@ -0,0 +1,203 @@
+#ifndef ANDROIDGLINVESTIGATIONS_VERTEXFORMAT_H
+#define ANDROIDGLINVESTIGATIONS_VERTEXFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <GLES3/gl3.h>
+
+// 三维向量或位置数据的表示
+union Vector3 {
+    struct {
+        float x, y, z; // 代表三维空间中的坐标或向量的分量
+    };
+    float idx[3]; // 通过索引访问相同的数据
+};
+
+// 二维向量，常用于纹理坐标
+union Vector2 {
+    struct {
+        float x, y; // 二维空间中的点或向量的通用表示
+    };
+    struct {
+        float u, v; // 纹理坐标的表示，u为纹理的水平坐标，v为垂直坐标
+    };
+    float idx[2]; // 通过索引访问相同的数据
+};
+
+typedef uint32_t Index; // 编辑时的索引类型，上传时能用16位就会压缩成16位
+
+/*!
+ * 引用外部内存的索引（例如映射的glTF缓冲），元素紧密排列
+ */
+struct IndexStream {
+    const uint8_t *data = nullptr; // nullptr表示没有索引，第i个索引就是i
+    size_t count = 0;
+    GLenum type = GL_UNSIGNED_INT; // GL_UNSIGNED_BYTE、GL_UNSIGNED_SHORT或GL_UNSIGNED_INT
+
+    Index fetch(size_t index) const;
+};
+
+/*!
+ * 编辑时使用的顶点格式，上传前会按 @a VertexLayout 量化成紧凑格式
+ */
+struct Vertex {
+    Vector3 position; // 顶点位置
+    Vector2 uv;       // 纹理坐标
+    uint32_t color;   // 顶点颜色，RGBA8打包，R在最低字节
+
+    Vertex(const Vector3 &inPosition, const Vector2 &inUV, uint32_t inColor = 0xFFFFFFFFu)
+            : position(inPosition), uv(inUV), color(inColor) {}
+};
+
+/*!
+ * 引用外部内存的顶点流（例如映射的glTF缓冲），按步长逐个读取，不需要先拷贝成 Vertex 数组。
+ * 分量类型使用GL枚举，数值与glTF的componentType相同。整数分量按glTF的规则转换：
+ * 归一化时为 c / 最大值（有符号数不小于-1），否则直接转换成float
+ */
+struct VertexStreams {
+    size_t count = 0;
+    const uint8_t *position = nullptr; // 3个分量
+    size_t positionStride = 0;
+    GLenum positionType = GL_FLOAT;    // GL_FLOAT或8/16位整数（KHR_mesh_quantization）
+    bool positionNormalized = false;
+    const uint8_t *uv = nullptr;       // 2个分量，nullptr表示uv全为0
+    size_t uvStride = 0;
+    GLenum uvType = GL_FLOAT;          // GL_FLOAT或8/16位整数
+    bool uvNormalized = true;
+
+    //! 读取第 @a index 个顶点，颜色为白色
+    Vertex fetch(size_t index) const;
+
+    Vector3 fetchPosition(size_t index) const;
+
+    Vector2 fetchUV(size_t index) const;
+};
+
+//! 位置的存储格式。Half和Snorm16存储的是相对包围盒中心、按半边长归一化后的坐标
+enum class PositionFormat {
+    Float32,
+    Half,
+    Snorm16
+};
+
+//! 纹理坐标的存储格式。Unorm16要求uv在[0, 1]范围内，超出部分会被截断
+enum class UVFormat {
+    Float32,
+    Unorm16
+};
+
+//! 颜色的存储格式
+enum class ColorFormat {
+    None,
+    Rgba8
+};
+
+/*!
+ * 单个顶点属性在交错缓冲中的描述，直接对应 glVertexAttribPointer 的参数
+ */
+struct VertexAttribute {
+    GLint components = 0;          // 分量个数，0表示布局中没有这个属性
+    GLenum type = GL_FLOAT;
+    GLboolean normalized = GL_FALSE;
+    uint32_t offset = 0;           // 在顶点内的字节偏移
+
+    inline bool isPresent() const { return components != 0; }
+};
+
+/*!
+ * 交错顶点缓冲的布局。每个属性都按4字节对齐，这是大多数移动GPU取顶点数据的最小粒度。
+ */
+struct VertexLayout {
+    PositionFormat positionFormat = PositionFormat::Float32;
+    UVFormat uvFormat = UVFormat::Float32;
+    ColorFormat colorFormat = ColorFormat::None;
+
+    VertexAttribute position;
+    VertexAttribute uv;
+    VertexAttribute color;
+    uint32_t stride = 0;
+
+    /*!
+     * 根据各属性的格式计算偏移和步长
+     */
+    static VertexLayout make(PositionFormat positionFormat, UVFormat uvFormat, ColorFormat colorFormat);
+
+    //! 全精度布局：float位置 + float uv，20字节
+    static inline VertexLayout full() {
+        return make(PositionFormat::Float32, UVFormat::Float32, ColorFormat::None);
+    }
+
+    //! 紧凑布局：snorm16位置 + unorm16 uv，12字节
+    static inline VertexLayout compact() {
+        return make(PositionFormat::Snorm16, UVFormat::Unorm16, ColorFormat::None);
+    }
+
+    //! 位置是否以包围盒为基准归一化存储
+    inline bool isPositionBoundsRelative() const {
+        return positionFormat != PositionFormat::Float32;
+    }
+};
+
+/*!
+ * 量化后的顶点数据及还原所需的参数
+ */
+struct QuantizedVertices {
+    VertexLayout layout;
+    std::vector<uint8_t> data;
+    size_t vertexCount = 0;
+
+    // 还原位置：position = stored * positionScale + positionOffset
+    // Float32格式时scale为1、offset为0
+    Vector3 positionScale = {{1.f, 1.f, 1.f}};
+    Vector3 positionOffset = {{0.f, 0.f, 0.f}};
+
+    // 量化后实际测得的最大绝对误差（逐分量）
+    float maxPositionError = 0.f;
+    float maxUVError = 0.f;
+};
+
+/*!
+ * 顶点量化与反量化
+ */
+class VertexFormat {
+public:
+    /*!
+     * 按布局把顶点量化成交错缓冲
+     * @param vertices 输入顶点
+     * @param layout 目标布局
+     * @return 量化结果，其中包含实测误差
+     */
+    static QuantizedVertices quantize(const std::vector<Vertex> &vertices, const VertexLayout &layout);
+
+    /*!
+     * 直接从外部顶点流量化，不生成中间的 Vertex 数组。
+     * 位置是8/16位整数（KHR_mesh_quantization）且布局为Snorm16时，每轴的整数平移到snorm16范围内原样存储，
+     * 归一化系数和平移并入还原参数，不引入量化误差
+     */
+    static QuantizedVertices quantize(const VertexStreams &streams, const VertexLayout &layout);
+
+    /*!
+     * 从交错缓冲中还原单个顶点
+     */
+    static Vertex dequantize(const QuantizedVertices &quantized, size_t index);
+
+    /*!
+     * 位置量化误差的理论上界（逐分量绝对误差）
+     * @param format 位置格式
+     * @param halfExtent 包围盒在该轴上的半边长
+     */
+    static float positionErrorBound(PositionFormat format, float halfExtent);
+
+    /*!
+     * uv量化误差的理论上界（对[0, 1]范围内的输入）
+     */
+    static float uvErrorBound(UVFormat format);
+
+    //! float与半精度浮点之间的转换，舍入方式为就近舍入到偶数
+    static uint16_t floatToHalf(float value);
+
+    static float halfToFloat(uint16_t value);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_VERTEXFORMAT_H
@@ -1,7 +1,10 @@
 #include <jni.h>
+#include <string>
+#include <sys/system_properties.h>
 
-#include "AndroidOut.h"
+#include "Log.h"
 #include "Renderer.h"
+#include "Trace.h"
 
 #include <game-activity/GameActivity.cpp>
 #include <game-text-input/gametextinput.cpp>
@@ -16,7 +19,7 @@ extern "C" {
      * @param cmd 要处理的命令
      */
     void handle_cmd(android_app *pApp, int32_t cmd) {
-        aout << "执行函数 handle_cmd" << std::endl;
+        LOGV("执行函数 handle_cmd");
         switch (cmd) {
             case APP_CMD_INIT_WINDOW:
                 // 创建了一个新窗口，与之关联一个渲染器。你可以根据需要用“游戏”类替换这个渲染器。
@@ -29,7 +32,12 @@ extern "C" {
                 //
                 // 我们需要检查userData是否已分配，以防这个命令来得特别快
                 if (pApp->userData) {
-                    //
+                    // 如果开启了追踪，在窗口销毁时把最近的trace导出到应用私有目录，
+                    // 之后可以用 adb exec-out run-as 拉取
+                    if (Trace::isEnabled()) {
+                        Trace::exportJson(std::string(pApp->activity->internalDataPath) + "/trace.json");
+                    }
+
                     auto *pRenderer = reinterpret_cast<Renderer *>(pApp->userData);
                     pApp->userData = nullptr;
                     delete pRenderer;
@@ -49,7 +57,7 @@ extern "C" {
      *         对于所有其他输入设备，为false。
      */
     bool motion_event_filter_func(const GameActivityMotionEvent *motionEvent) {
-        aout << "欢迎来到 motion_event_filter_func" << std::endl;
+        LOGV("欢迎来到 motion_event_filter_func");
         auto sourceClass = motionEvent->source & AINPUT_SOURCE_CLASS_MASK;
         return (sourceClass == AINPUT_SOURCE_CLASS_POINTER ||
                 sourceClass == AINPUT_SOURCE_CLASS_JOYSTICK);
@@ -59,7 +67,15 @@ extern "C" {
      * 这是原生活动的主入口点
      */
     void android_main(struct android_app *pApp) {
-        aout << "欢迎来到 android_main" << std::endl;
+        LOGV("欢迎来到 android_main");
+
+        // 追踪默认编译进来但不记录，可以通过 adb shell setprop debug.openglesdemo.trace 1 打开
+        char traceProperty[PROP_VALUE_MAX] = {0};
+        if (__system_property_get("debug.openglesdemo.trace", traceProperty) > 0
+            && traceProperty[0] == '1') {
+            Trace::setEnabled(true);
+        }
+        Trace::setThreadName("android_main");
 
         // 为Android事件注册一个事件处理器
         pApp->onAppCmd = handle_cmd;
@@ -92,6 +108,8 @@ extern "C" {
                 // 渲染一帧
                 pRenderer->render();
             }
+
+            TRACE_FRAME_MARK();
         } while (!pApp->destroyRequested);
     }
 }
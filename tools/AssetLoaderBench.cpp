@@ -0,0 +1,219 @@
+/*
+ * assetloaderbench：比较同步加载和 AssetLoader 异步加载的首帧耗时。
+ *
+ * 没有GL上下文，上传由桩实现代替：把像素复制到模拟的显存中，代价与驱动拷贝数据相当。
+ * “解码”用程序生成纹理并逐级缩小生成mip代替，命令行给出glTF文件时再加上网格的读取、解析和量化。
+ * 另外检查 stop：还没执行的上传任务不会被调用，之后提交的任务被丢弃，待完成数归零。
+ * 用法：assetloaderbench [纹理数] [glTF文件...]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AssetLoader.h"
+#include "GltfLoader.h"
+#include "VertexFormat.h"
+
+namespace {
+
+constexpr int kTextureSize = 1024;
+constexpr uint64_t kUploadBudgetNs = 2000000;
+constexpr auto kFrameWork = std::chrono::milliseconds(4); // 模拟每帧其余的CPU工作
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Image {
+    int size = 0;
+    std::vector<uint8_t> pixels; // 所有mip层级依次排列
+};
+
+// 桩上传实现：记录每个资源的数据，代替glTexImage2D/glBufferData
+class StubUploadBackend {
+public:
+    uint32_t upload(const uint8_t *data, size_t size) {
+        memory_.emplace_back(data, data + size);
+        bytes_ += size;
+        return uint32_t(memory_.size());
+    }
+
+    inline size_t count() const { return memory_.size(); }
+
+    inline size_t bytes() const { return bytes_; }
+
+    inline const std::vector<uint8_t> &data(uint32_t id) const { return memory_[id - 1]; }
+
+private:
+    std::vector<std::vector<uint8_t>> memory_;
+    size_t bytes_ = 0;
+};
+
+// 代替PNG解码：生成有高频细节的纹理并用2x2平均生成mip链
+Image decodeTexture(int seed) {
+    Image image;
+    image.size = kTextureSize;
+    size_t total = 0;
+    for (int size = kTextureSize; size > 0; size /= 2) {
+        total += size_t(size) * size * 4;
+    }
+    image.pixels.resize(total);
+    uint8_t *level = image.pixels.data();
+    for (int y = 0; y < kTextureSize; y++) {
+        for (int x = 0; x < kTextureSize; x++) {
+            uint8_t *pixel = level + (size_t(y) * kTextureSize + x) * 4;
+            float v = std::sin(x * 0.05f + seed) * std::cos(y * 0.07f - seed);
+            pixel[0] = uint8_t(127.5f + 127.5f * v);
+            pixel[1] = uint8_t((x ^ y) + seed);
+            pixel[2] = uint8_t(x * y >> 4);
+            pixel[3] = 255;
+        }
+    }
+    for (int size = kTextureSize / 2; size > 0; size /= 2) {
+        uint8_t *next = level + size_t(size) * size * 16;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                for (int c = 0; c < 4; c++) {
+                    const uint8_t *row0 = level + (size_t(2 * y) * size * 2 + 2 * x) * 4 + c;
+                    const uint8_t *row1 = row0 + size_t(size) * 2 * 4;
+                    next[(size_t(y) * size + x) * 4 + c] = uint8_t((row0[0] + row0[4] + row1[0] + row1[4] + 2) / 4);
+                }
+            }
+        }
+        level = next;
+    }
+    return image;
+}
+
+// 网格资源：读取、解析并量化第一个图元
+std::vector<uint8_t> decodeMesh(const std::string &path) {
+    auto scene = GltfLoader::load(path);
+    if (!scene || scene->meshes.empty() || scene->meshes[0].primitives.empty()) {
+        return {};
+    }
+    auto quantized = VertexFormat::quantize(scene->meshes[0].primitives[0].vertexStreams(), VertexLayout::compact());
+    return std::move(quantized.data);
+}
+
+struct Result {
+    double firstFrameMs = 0;
+    double allReadyMs = 0;
+    double maxUploadMs = 0; // 单帧上传用时的最大值
+    size_t frames = 0;
+    size_t threads = 0;
+};
+
+Result runSync(int textureCount, const std::vector<std::string> &meshes, StubUploadBackend &backend) {
+    uint64_t start = nowNs();
+    for (int i = 0; i < textureCount; i++) {
+        Image image = decodeTexture(i);
+        backend.upload(image.pixels.data(), image.pixels.size());
+    }
+    for (const auto &path: meshes) {
+        auto data = decodeMesh(path);
+        backend.upload(data.data(), data.size());
+    }
+    std::this_thread::sleep_for(kFrameWork);
+    Result result;
+    result.firstFrameMs = result.allReadyMs = (nowNs() - start) / 1e6;
+    result.frames = 1;
+    return result;
+}
+
+Result runAsync(int textureCount, const std::vector<std::string> &meshes, StubUploadBackend &backend,
+                std::vector<uint32_t> &textureIds) {
+    uint64_t start = nowNs();
+    AssetLoader loader;
+    Result result;
+    result.threads = loader.threadCount();
+    // 句柄在上传前为0，绘制时用占位资源
+    textureIds.assign(textureCount, 0);
+    for (int i = 0; i < textureCount; i++) {
+        loader.submit([i, &backend, &textureIds]() -> AssetLoader::UploadTask {
+            auto image = std::make_shared<Image>(decodeTexture(i));
+            return [i, image, &backend, &textureIds]() {
+                textureIds[i] = backend.upload(image->pixels.data(), image->pixels.size());
+            };
+        });
+    }
+    for (const auto &path: meshes) {
+        loader.submit([path, &backend]() -> AssetLoader::UploadTask {
+            auto data = std::make_shared<std::vector<uint8_t>>(decodeMesh(path));
+            if (data->empty()) {
+                return nullptr;
+            }
+            return [data, &backend]() { backend.upload(data->data(), data->size()); };
+        });
+    }
+
+    while (true) {
+        uint64_t uploadStart = nowNs();
+        loader.pumpUploads(kUploadBudgetNs);
+        result.maxUploadMs = std::max(result.maxUploadMs, (nowNs() - uploadStart) / 1e6);
+        std::this_thread::sleep_for(kFrameWork);
+        result.frames++;
+        if (result.frames == 1) {
+            result.firstFrameMs = (nowNs() - start) / 1e6;
+        }
+        if (loader.pendingCount() == 0) {
+            break;
+        }
+    }
+    result.allReadyMs = (nowNs() - start) / 1e6;
+    return result;
+}
+
+bool checkStop() {
+    AssetLoader loader(2);
+    std::atomic<int> uploads{0};
+    for (int i = 0; i < 16; i++) {
+        loader.submit([&uploads]() -> AssetLoader::UploadTask {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            return [&uploads]() { uploads++; };
+        });
+    }
+    loader.waitForLoads();
+    loader.stop();
+    loader.submit([]() -> AssetLoader::UploadTask { return [] {}; });
+    bool ok = loader.pumpUploads(UINT64_MAX) == 0 && uploads == 0 && loader.pendingCount() == 0;
+    printf("停止后丢弃上传任务和新提交的任务：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int textureCount = argc > 1 ? std::max(1, atoi(argv[1])) : 32;
+    std::vector<std::string> meshes(argv + std::min(argc, 2), argv + argc);
+
+    StubUploadBackend syncBackend;
+    Result sync = runSync(textureCount, meshes, syncBackend);
+
+    StubUploadBackend asyncBackend;
+    std::vector<uint32_t> textureIds;
+    Result async = runAsync(textureCount, meshes, asyncBackend, textureIds);
+
+    // 异步结果必须与同步结果逐字节相同（纹理按完成顺序上传，按句柄比较）
+    bool ok = asyncBackend.count() == syncBackend.count() && asyncBackend.bytes() == syncBackend.bytes();
+    for (int i = 0; ok && i < textureCount; i++) {
+        ok = textureIds[i] != 0 && asyncBackend.data(textureIds[i]) == syncBackend.data(uint32_t(i + 1));
+    }
+
+    printf("%d 个 %dx%d 纹理，%zu 个网格，%zu 个工作线程，上传 %.1f MB\n", textureCount, kTextureSize, kTextureSize,
+           meshes.size(), async.threads, syncBackend.bytes() / 1e6);
+    printf("同步：首帧 %8.2f ms\n", sync.firstFrameMs);
+    printf("异步：首帧 %8.2f ms，全部就绪 %8.2f ms（%zu 帧），单帧上传最多 %.2f ms\n",
+           async.firstFrameMs, async.allReadyMs, async.frames, async.maxUploadMs);
+    printf(ok ? "上传结果一致\n" : "上传结果不一致\n");
+    ok = checkStop() && ok;
+    return ok ? 0 : 1;
+}
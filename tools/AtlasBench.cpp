@@ -0,0 +1,341 @@
+/*
+ * atlasbench：检查 TextureAtlas 的排布和间隔，测量两种排布算法的空间利用率和耗时。
+ *
+ * 检查项：每张图都在页面内，连同间隔的外框互不重叠且按对齐单位对齐；uv变换把[0, 1]映射到图的矩形；
+ * 第0层图的像素原样拷贝、间隔复制最近的边缘像素；截断后的每一层mip中，每个外框的内容与单独对这个外框
+ * 生成mip链的结果逐字节相同，即盒式滤波没有混入相邻的图；超出页面的图返回false。
+ * 基准测试对几组典型的小纹理分别用天际线和最大矩形排布，输出页数、利用率（图的像素数 / 页面像素数）、
+ * 排布耗时和生成页面（拷贝加mip链）的耗时，并按随机的绘制顺序统计纹理切换次数。
+ * 用法：atlasbench [页面边长] [间隔]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "TextureAtlas.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    int32_t range(int32_t low, int32_t high) {
+        return low + int32_t(next() % uint32_t(high - low + 1));
+    }
+};
+
+//! 一组测试用的图，像素由尺寸和序号决定
+struct ImageSet {
+    const char *name;
+    std::vector<std::vector<uint8_t>> pixels;
+    std::vector<AtlasImage> images;
+
+    void add(int32_t width, int32_t height, Random &random) {
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        for (auto &value: rgba) {
+            value = uint8_t(random.next());
+        }
+        pixels.push_back(std::move(rgba));
+        images.push_back(AtlasImage{width, height, nullptr});
+    }
+
+    // pixels 增长时会移动，最后再填指针
+    void finish() {
+        for (size_t i = 0; i < images.size(); i++) {
+            images[i].rgba = pixels[i].data();
+        }
+    }
+};
+
+// 图标：2的幂的正方形为主，夹杂一些长条
+ImageSet iconSet(uint32_t seed) {
+    ImageSet set{"图标", {}, {}};
+    Random random{seed};
+    const int32_t sizes[] = {16, 32, 32, 64, 64, 128};
+    for (int i = 0; i < 400; i++) {
+        int32_t size = sizes[random.range(0, 5)];
+        if (random.range(0, 4) == 0) {
+            set.add(size, size / 4, random);
+        } else {
+            set.add(size, size, random);
+        }
+    }
+    set.finish();
+    return set;
+}
+
+// 任意尺寸的小图
+ImageSet mixedSet(uint32_t seed) {
+    ImageSet set{"混合", {}, {}};
+    Random random{seed};
+    for (int i = 0; i < 300; i++) {
+        set.add(random.range(4, 200), random.range(4, 200), random);
+    }
+    set.finish();
+    return set;
+}
+
+// createSolidColorTexture 那样的1x1纯色
+ImageSet solidSet(uint32_t seed) {
+    ImageSet set{"纯色", {}, {}};
+    Random random{seed};
+    for (int i = 0; i < 1000; i++) {
+        set.add(1, 1, random);
+    }
+    set.finish();
+    return set;
+}
+
+int32_t alignmentFor(int32_t padding) {
+    int32_t alignment = 1;
+    while (alignment * 2 <= padding) {
+        alignment *= 2;
+    }
+    return alignment;
+}
+
+// 外框：图的矩形向外扩展间隔，尺寸补齐到对齐单位
+void boxOf(const AtlasRegion &region, int32_t padding, int32_t alignment, int32_t box[4]) {
+    box[0] = region.x - padding;
+    box[1] = region.y - padding;
+    box[2] = (region.width + padding * 2 + alignment - 1) / alignment * alignment;
+    box[3] = (region.height + padding * 2 + alignment - 1) / alignment * alignment;
+}
+
+bool checkLayout() {
+    bool ok = true;
+    const ImageSet sets[] = {iconSet(1), mixedSet(2), solidSet(3)};
+    const int32_t paddings[] = {0, 1, 3, 4, 8};
+    for (const ImageSet &set: sets) {
+        for (int packing = 0; packing < 2; packing++) {
+            for (int32_t padding: paddings) {
+                AtlasOptions options;
+                options.maxPageSize = 512;
+                options.padding = padding;
+                options.packing = packing ? AtlasPacking::MaxRects : AtlasPacking::Skyline;
+                AtlasLayout layout;
+                if (!TextureAtlas::pack(set.images, options, layout)) {
+                    printf("排布失败: %s 间隔%d\n", set.name, padding);
+                    ok = false;
+                    continue;
+                }
+                int32_t alignment = alignmentFor(padding);
+                std::vector<std::vector<uint8_t>> used(layout.pages.size());
+                for (size_t p = 0; p < layout.pages.size(); p++) {
+                    const AtlasPage &page = layout.pages[p];
+                    if (page.width > options.maxPageSize || page.height > options.maxPageSize
+                        || page.width % alignment || page.height % alignment) {
+                        printf("页面尺寸错误: %s %dx%d\n", set.name, page.width, page.height);
+                        ok = false;
+                    }
+                    used[p].assign(size_t(page.width) * page.height, 0);
+                }
+                bool overlap = false;
+                for (size_t i = 0; i < set.images.size(); i++) {
+                    const AtlasRegion &region = layout.regions[i];
+                    const AtlasPage &page = layout.pages[region.page];
+                    int32_t box[4];
+                    boxOf(region, padding, alignment, box);
+                    if (region.width != set.images[i].width || region.height != set.images[i].height
+                        || box[0] < 0 || box[1] < 0 || box[0] % alignment || box[1] % alignment
+                        || box[0] + box[2] > page.width || box[1] + box[3] > page.height) {
+                        printf("图的位置错误: %s 第%zu张\n", set.name, i);
+                        ok = false;
+                        continue;
+                    }
+                    for (int32_t y = box[1]; y < box[1] + box[3] && !overlap; y++) {
+                        for (int32_t x = box[0]; x < box[0] + box[2]; x++) {
+                            uint8_t &cell = used[region.page][size_t(y) * page.width + x];
+                            overlap |= cell != 0;
+                            cell = 1;
+                        }
+                    }
+                    Vector2 low = region.transform(Vector2{0.f, 0.f});
+                    Vector2 high = region.transform(Vector2{1.f, 1.f});
+                    float epsilon = 1e-5f;
+                    if (std::abs(low.u * page.width - region.x) > epsilon * page.width
+                        || std::abs(low.v * page.height - region.y) > epsilon * page.height
+                        || std::abs(high.u * page.width - (region.x + region.width)) > epsilon * page.width
+                        || std::abs(high.v * page.height - (region.y + region.height)) > epsilon * page.height) {
+                        printf("uv变换错误: %s 第%zu张\n", set.name, i);
+                        ok = false;
+                    }
+                }
+                if (overlap) {
+                    printf("外框重叠: %s %s 间隔%d\n", set.name, packing ? "MaxRects" : "Skyline", padding);
+                    ok = false;
+                }
+            }
+        }
+    }
+    printf("排布：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkPixels() {
+    bool ok = true;
+    ImageSet set = mixedSet(7);
+    for (int packing = 0; packing < 2; packing++) {
+        AtlasOptions options;
+        options.maxPageSize = 1024;
+        options.padding = 4;
+        options.packing = packing ? AtlasPacking::MaxRects : AtlasPacking::Skyline;
+        AtlasLayout layout;
+        std::vector<MipChain> pages;
+        if (!TextureAtlas::build(set.images, options, layout, pages) || layout.mipLevels != 3) {
+            printf("生成页面失败\n");
+            return false;
+        }
+        MipBakeOptions boxOptions = options.mipOptions;
+        boxOptions.filter = MipFilter::Box;
+        int32_t alignment = alignmentFor(options.padding);
+        for (size_t i = 0; i < set.images.size() && ok; i++) {
+            const AtlasImage &image = set.images[i];
+            const AtlasRegion &region = layout.regions[i];
+            const MipChain &chain = pages[region.page];
+            if (chain.levels.size() != layout.mipLevels) {
+                printf("mip链没有截断: %zu 层\n", chain.levels.size());
+                return false;
+            }
+            int32_t box[4];
+            boxOf(region, options.padding, alignment, box);
+
+            // 第0层：外框中每个像素都等于图中最近的像素
+            std::vector<uint8_t> expected(size_t(box[2]) * box[3] * 4);
+            for (int32_t y = 0; y < box[3]; y++) {
+                int32_t sy = std::min(std::max(y - options.padding, 0), image.height - 1);
+                for (int32_t x = 0; x < box[2]; x++) {
+                    int32_t sx = std::min(std::max(x - options.padding, 0), image.width - 1);
+                    memcpy(&expected[(size_t(y) * box[2] + x) * 4], image.rgba + (size_t(sy) * image.width + sx) * 4, 4);
+                }
+            }
+            // 单独对外框生成mip链，和页面中的同一块比较
+            MipChain alone = TextureBaker::buildMipChain(box[2], box[3], expected, boxOptions);
+            for (size_t level = 0; level < layout.mipLevels && ok; level++) {
+                const MipChain::Level &pageLevel = chain.levels[level];
+                const MipChain::Level &aloneLevel = alone.levels[level];
+                int32_t x0 = box[0] >> level;
+                int32_t y0 = box[1] >> level;
+                for (int32_t y = 0; y < aloneLevel.height; y++) {
+                    const uint8_t *got = chain.levelData(level) + (size_t(y0 + y) * pageLevel.width + x0) * 4;
+                    const uint8_t *want = alone.levelData(level) + size_t(y) * aloneLevel.width * 4;
+                    if (memcmp(got, want, size_t(aloneLevel.width) * 4) != 0) {
+                        printf("第%zu张图第%zu层与单独生成的mip不同（%s）\n", i, level,
+                               packing ? "MaxRects" : "Skyline");
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // 超出页面的图
+    std::vector<uint8_t> big(size_t(300) * 300 * 4);
+    AtlasOptions small;
+    small.maxPageSize = 256;
+    AtlasLayout layout;
+    if (TextureAtlas::pack({AtlasImage{300, 300, big.data()}}, small, layout)
+        || TextureAtlas::pack({AtlasImage{250, 10, big.data()}}, small, layout)) {
+        printf("超出页面的图没有失败\n");
+        ok = false;
+    }
+
+    // 改写uv时截断到[0, 1]
+    AtlasRegion region;
+    region.uvScale = Vector2{0.25f, 0.5f};
+    region.uvOffset = Vector2{0.5f, 0.25f};
+    std::vector<Vertex> vertices = {Vertex{Vector3{0.f, 0.f, 0.f}, Vector2{-1.f, 2.f}},
+                                    Vertex{Vector3{0.f, 0.f, 0.f}, Vector2{0.5f, 0.5f}}};
+    TextureAtlas::remapUVs(vertices, region);
+    if (vertices[0].uv.u != 0.5f || vertices[0].uv.v != 0.75f || vertices[1].uv.u != 0.625f
+        || vertices[1].uv.v != 0.5f) {
+        printf("uv改写错误\n");
+        ok = false;
+    }
+    printf("间隔和mip：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+void benchmark(int32_t pageSize, int32_t padding) {
+    printf("页面最大 %d，间隔 %d：\n", pageSize, padding);
+    const ImageSet sets[] = {iconSet(11), mixedSet(12), solidSet(13)};
+    for (const ImageSet &set: sets) {
+        for (int packing = 0; packing < 2; packing++) {
+            AtlasOptions options;
+            options.maxPageSize = pageSize;
+            options.padding = padding;
+            options.packing = packing ? AtlasPacking::MaxRects : AtlasPacking::Skyline;
+            AtlasLayout layout;
+
+            // 排布很快，重复多次取最快的一次
+            double packTime = 1e9;
+            for (int repeat = 0; repeat < 5; repeat++) {
+                double start = nowSeconds();
+                TextureAtlas::pack(set.images, options, layout);
+                packTime = std::min(packTime, nowSeconds() - start);
+            }
+            std::vector<MipChain> pages;
+            double start = nowSeconds();
+            TextureAtlas::build(set.images, options, layout, pages);
+            double buildTime = nowSeconds() - start;
+
+            size_t pagePixels = 0;
+            size_t imagePixels = 0;
+            for (const AtlasPage &page: layout.pages) {
+                pagePixels += size_t(page.width) * page.height;
+                imagePixels += page.imagePixels;
+            }
+
+            // 随机顺序绘制2000个模型，每个模型用集合中的一张图
+            Random random{99};
+            size_t textureSwitches = 0;
+            size_t pageSwitches = 0;
+            int32_t lastImage = -1;
+            int32_t lastPage = -1;
+            for (int draw = 0; draw < 2000; draw++) {
+                int32_t image = random.range(0, int32_t(set.images.size()) - 1);
+                int32_t page = int32_t(layout.regions[image].page);
+                textureSwitches += image != lastImage;
+                pageSwitches += page != lastPage;
+                lastImage = image;
+                lastPage = page;
+            }
+
+            printf("  %s %4zu张  %-8s %2zu页  利用率 %5.1f%%  排布 %7.3f ms  生成页面 %7.2f ms  "
+                   "纹理切换 %4zu -> %4zu\n",
+                   set.name, set.images.size(), packing ? "MaxRects" : "Skyline", layout.pages.size(),
+                   100.0 * double(imagePixels) / double(pagePixels), packTime * 1e3, buildTime * 1e3,
+                   textureSwitches, pageSwitches);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int32_t pageSize = argc > 1 ? std::max(64, atoi(argv[1])) : 2048;
+    int32_t padding = argc > 2 ? std::max(0, atoi(argv[2])) : 4;
+
+    bool ok = true;
+    ok = checkLayout() && ok;
+    ok = checkPixels() && ok;
+
+    benchmark(pageSize, padding);
+
+    printf(ok ? "图集检查通过\n" : "图集检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,460 @@
+/*
+ * bakedmeshbench：用 meshbaker 把glTF/GLB烘焙成.bmesh，检查烘焙结果与 GltfLoader 读出的数据一致，并对比两种方式的加载耗时。
+ *
+ * 输入是 tools/samples 中的 embedded.gltf、external.gltf、quantized.glb（不含稀疏访问器的样例）和生成的大网格GLB，
+ * 每个输入用三组选项烘焙：
+ * --full --lods 1 --no-meshlets --no-optimize：存储的位置和uv与glTF读出的float逐位相同，索引顺序相同；
+ * --lods 1 --no-meshlets --no-optimize：顶点字节与按文件中的布局量化glTF顶点的结果相同，包围盒、还原参数和索引相同；
+ * 默认选项（优化、细节层次、分簇）：第0层的三角形集合（按量化后的顶点内容比较，不计顶点顺序和三角形起点）
+ * 与glTF相同，非三角形列表的图元原样保存，其余层次的误差不递减。
+ * 基准测试比较大网格的glTF路径（GltfLoader::load、量化顶点、转换索引，即 Model 从glTF构造时在CPU上做的事）
+ * 与.bmesh路径（BakedMeshFile::open、读一遍顶点和索引、拷贝簇表；以及打开时校验全部数据）。
+ * 用法：bakedmeshbench [样例目录] [大网格的边长]
+ */
+
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BakedMesh.h"
+#include "GltfLoader.h"
+#include "Log.h"
+#include "MeshWelder.h"
+#include "VertexFormat.h"
+
+#ifndef GLTF_SAMPLE_DIR
+#define GLTF_SAMPLE_DIR "samples"
+#endif
+
+#ifndef MESHBAKER_PATH
+#define MESHBAKER_PATH "meshbaker"
+#endif
+
+namespace {
+
+// 基准测试读出的数据累加到这里，避免被编译器省略
+volatile uint32_t gSink = 0;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// glTF中的一个图元，顺序与 meshbaker 输出的网格相同
+struct SourcePrimitive {
+    GLenum mode = GL_TRIANGLES;
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+};
+
+bool loadSource(const std::string &path, std::vector<SourcePrimitive> &primitives) {
+    auto scene = GltfLoader::load(path);
+    if (!scene) {
+        return false;
+    }
+    for (const GltfMesh &mesh: scene->meshes) {
+        for (const GltfPrimitive &primitive: mesh.primitives) {
+            SourcePrimitive source;
+            source.mode = primitive.mode;
+            VertexStreams streams = primitive.vertexStreams();
+            for (size_t i = 0; i < streams.count; i++) {
+                source.vertices.push_back(streams.fetch(i));
+            }
+            IndexStream indices = primitive.indexStream();
+            for (size_t i = 0; i < indices.count; i++) {
+                source.indices.push_back(indices.fetch(i));
+            }
+            primitives.push_back(std::move(source));
+        }
+    }
+    return true;
+}
+
+// 运行同一构建目录中的 meshbaker，丢弃它的逐网格输出
+bool bake(const std::string &input, const std::string &output, std::vector<const char *> options) {
+    std::vector<char *> args;
+    args.push_back(const_cast<char *>("meshbaker"));
+    for (const char *option: options) {
+        args.push_back(const_cast<char *>(option));
+    }
+    args.push_back(const_cast<char *>(input.c_str()));
+    args.push_back(const_cast<char *>(output.c_str()));
+    args.push_back(nullptr);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) {
+            dup2(null, STDOUT_FILENO);
+        }
+        execv(MESHBAKER_PATH, args.data());
+        _exit(127);
+    }
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+std::vector<Index> bakedIndices(const BakedMeshFile &file, size_t mesh, uint32_t offset, uint32_t count) {
+    const uint8_t *data = file.getIndexData(mesh);
+    std::vector<Index> indices(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (file.getMesh(mesh).indexType == GL_UNSIGNED_SHORT) {
+            uint16_t value;
+            memcpy(&value, data + (size_t(offset) + i) * 2, 2);
+            indices[i] = value;
+        } else {
+            uint32_t value;
+            memcpy(&value, data + (size_t(offset) + i) * 4, 4);
+            indices[i] = value;
+        }
+    }
+    return indices;
+}
+
+QuantizedVertices bakedVertices(const BakedMeshFile &file, size_t mesh) {
+    QuantizedVertices vertices = file.getVertexFormat(mesh);
+    const uint8_t *data = file.getVertexData(mesh);
+    vertices.data.assign(data, data + size_t(vertices.layout.stride) * vertices.vertexCount);
+    return vertices;
+}
+
+bool sameFloat(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+bool sameBounds(const Aabb &a, const Aabb &b) {
+    return sameFloat(a.min.x, b.min.x) && sameFloat(a.min.y, b.min.y) && sameFloat(a.min.z, b.min.z)
+           && sameFloat(a.max.x, b.max.x) && sameFloat(a.max.y, b.max.y) && sameFloat(a.max.z, b.max.z);
+}
+
+// 一个三角形的三个顶点的量化字节，从字节最小的顶点开始，保持绕序
+std::string triangleKey(const QuantizedVertices &vertices, const Index *triangle) {
+    const uint32_t stride = vertices.layout.stride;
+    std::string corners[3];
+    for (int c = 0; c < 3; c++) {
+        corners[c].assign(reinterpret_cast<const char *>(vertices.data.data() + size_t(triangle[c]) * stride), stride);
+    }
+    int first = int(std::min_element(corners, corners + 3) - corners);
+    return corners[first] + corners[(first + 1) % 3] + corners[(first + 2) % 3];
+}
+
+std::vector<std::string> triangleSet(const QuantizedVertices &vertices, const std::vector<Index> &indices) {
+    std::vector<std::string> triangles;
+    triangles.reserve(indices.size() / 3);
+    for (size_t t = 0; t + 3 <= indices.size(); t += 3) {
+        triangles.push_back(triangleKey(vertices, &indices[t]));
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// 三种选项的共同部分：网格数量、绘制模式、包围盒和文件本身的完整性
+bool openBaked(const std::string &path, const std::vector<SourcePrimitive> &source, BakedMeshFile &file) {
+    if (!file.open(path, true) || file.getMeshCount() != source.size()) {
+        printf("  %s 无法打开或网格数量不同\n", path.c_str());
+        return false;
+    }
+    for (size_t m = 0; m < source.size(); m++) {
+        if (file.getMesh(m).mode != source[m].mode || file.getMesh(m).lodCount == 0
+            || !sameBounds(file.getBounds(m), Aabb::fromVertices(source[m].vertices))) {
+            printf("  %s 网格%zu的模式、层次或包围盒不同\n", path.c_str(), m);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkFull(const std::string &path, const std::vector<SourcePrimitive> &source) {
+    BakedMeshFile file;
+    if (!openBaked(path, source, file)) {
+        return false;
+    }
+    for (size_t m = 0; m < source.size(); m++) {
+        const SourcePrimitive &primitive = source[m];
+        QuantizedVertices vertices = bakedVertices(file, m);
+        bool same = vertices.vertexCount == primitive.vertices.size()
+                    && file.getMesh(m).indexCount == primitive.indices.size()
+                    && bakedIndices(file, m, 0, file.getMesh(m).indexCount) == primitive.indices;
+        // 直接比较存储的float：dequantize 加上为0的偏移会把-0变成+0
+        const VertexLayout &layout = vertices.layout;
+        for (size_t i = 0; i < vertices.vertexCount && same; i++) {
+            const uint8_t *vertex = vertices.data.data() + i * layout.stride;
+            const Vertex &expected = primitive.vertices[i];
+            same = memcmp(vertex + layout.position.offset, expected.position.idx, sizeof(float) * 3) == 0
+                   && memcmp(vertex + layout.uv.offset, expected.uv.idx, sizeof(float) * 2) == 0;
+        }
+        if (!same) {
+            printf("  %s 网格%zu的顶点或索引不同\n", path.c_str(), m);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkQuantized(const std::string &path, const std::vector<SourcePrimitive> &source) {
+    BakedMeshFile file;
+    if (!openBaked(path, source, file)) {
+        return false;
+    }
+    for (size_t m = 0; m < source.size(); m++) {
+        const SourcePrimitive &primitive = source[m];
+        QuantizedVertices vertices = bakedVertices(file, m);
+        QuantizedVertices expected = VertexFormat::quantize(primitive.vertices, vertices.layout);
+        bool same = vertices.data == expected.data
+                    && memcmp(vertices.positionScale.idx, expected.positionScale.idx, sizeof(float) * 3) == 0
+                    && memcmp(vertices.positionOffset.idx, expected.positionOffset.idx, sizeof(float) * 3) == 0
+                    && bakedIndices(file, m, 0, file.getMesh(m).indexCount) == primitive.indices;
+        if (!same) {
+            printf("  %s 网格%zu的量化顶点或索引不同\n", path.c_str(), m);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkOptimized(const std::string &path, const std::vector<SourcePrimitive> &source) {
+    BakedMeshFile file;
+    if (!openBaked(path, source, file)) {
+        return false;
+    }
+    for (size_t m = 0; m < source.size(); m++) {
+        const SourcePrimitive &primitive = source[m];
+        QuantizedVertices vertices = bakedVertices(file, m);
+        QuantizedVertices expected = VertexFormat::quantize(primitive.vertices, vertices.layout);
+        const BakedLod *lods = file.getLods(m);
+        std::vector<Index> lod0 = bakedIndices(file, m, lods[0].indexOffset, lods[0].indexCount);
+        bool same = lods[0].error == 0.f;
+        if (primitive.mode == GL_TRIANGLES && primitive.indices.size() >= 3) {
+            // 优化会重排顶点和三角形，分簇会改变三角形的顺序
+            same = same && triangleSet(vertices, lod0) == triangleSet(expected, primitive.indices);
+        } else {
+            same = same && file.getMesh(m).lodCount == 1 && vertices.data == expected.data && lod0 == primitive.indices;
+        }
+        for (uint32_t l = 1; l < file.getMesh(m).lodCount && same; l++) {
+            same = lods[l].error >= lods[l - 1].error && lods[l].indexCount % 3 == 0;
+        }
+        if (!same) {
+            printf("  %s 网格%zu的三角形或细节层次不同\n", path.c_str(), m);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkRoundTrip(const std::string &input, const std::string &output) {
+    std::vector<SourcePrimitive> source;
+    if (!loadSource(input, source)) {
+        printf("  无法加载 %s\n", input.c_str());
+        return false;
+    }
+    return bake(input, output, {"--full", "--lods", "1", "--no-meshlets", "--no-optimize"})
+           && checkFull(output, source)
+           && bake(input, output, {"--lods", "1", "--no-meshlets", "--no-optimize"})
+           && checkQuantized(output, source)
+           && bake(input, output, {}) && checkOptimized(output, source);
+}
+
+void appendPadded(std::string &out, const void *data, size_t size, char padding) {
+    out.append(static_cast<const char *>(data), size);
+    out.append((4 - size % 4) % 4, padding);
+}
+
+bool writeFile(const std::string &path, const std::string &data) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && ok;
+}
+
+// 边长为size的起伏网格：交错的float位置和uv，uint索引
+bool writeGrid(const std::string &path, uint32_t size) {
+    std::string binary;
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            const float vertex[5] = {float(x), float(y), std::sin(float(x) * 0.1f) * std::cos(float(y) * 0.1f),
+                                     float(x) / float(size), float(y) / float(size)};
+            binary.append(reinterpret_cast<const char *>(vertex), sizeof(vertex));
+        }
+    }
+    size_t vertexBytes = binary.size();
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t i = y * (size + 1) + x;
+            const uint32_t quad[6] = {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2};
+            binary.append(reinterpret_cast<const char *>(quad), sizeof(quad));
+        }
+    }
+    size_t indexBytes = binary.size() - vertexBytes;
+    size_t vertexCount = size_t(size + 1) * (size + 1);
+    std::string json =
+            "{\"asset\":{\"version\":\"2.0\"},"
+            "\"meshes\":[{\"name\":\"grid\",\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1},"
+            "\"indices\":2}]}],"
+            "\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}],"
+            "\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(vertexBytes) + ",\"byteStride\":20},"
+            "{\"buffer\":0,\"byteOffset\":" + std::to_string(vertexBytes) + ",\"byteLength\":"
+            + std::to_string(indexBytes) + "}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(vertexCount)
+            + ",\"type\":\"VEC3\"},"
+            "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":" + std::to_string(vertexCount)
+            + ",\"type\":\"VEC2\"},"
+            "{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(size_t(size) * size * 6)
+            + ",\"type\":\"SCALAR\"}]}";
+
+    std::string chunks;
+    uint32_t header[2] = {uint32_t((json.size() + 3) & ~size_t(3)), 0x4E4F534Au};
+    chunks.append(reinterpret_cast<const char *>(header), sizeof(header));
+    appendPadded(chunks, json.data(), json.size(), ' ');
+    header[0] = uint32_t((binary.size() + 3) & ~size_t(3));
+    header[1] = 0x004E4942u;
+    chunks.append(reinterpret_cast<const char *>(header), sizeof(header));
+    appendPadded(chunks, binary.data(), binary.size(), '\0');
+    const uint32_t glbHeader[3] = {0x46546C67u, 2u, uint32_t(12 + chunks.size())};
+    std::string glb(reinterpret_cast<const char *>(glbHeader), sizeof(glbHeader));
+    return writeFile(path, glb + chunks);
+}
+
+// glTF路径：与 GltfLoader::createModels 和 Model 的流构造函数在CPU上做的相同
+bool loadGltf(const std::string &path) {
+    auto scene = GltfLoader::load(path);
+    if (!scene) {
+        return false;
+    }
+    for (const GltfMesh &mesh: scene->meshes) {
+        for (const GltfPrimitive &primitive: mesh.primitives) {
+            VertexStreams streams = primitive.vertexStreams();
+            QuantizedVertices vertices = VertexFormat::quantize(streams, VertexLayout::compact());
+            Aabb bounds = Aabb::fromStreams(streams);
+            IndexStream stream = primitive.indexStream();
+            std::vector<uint8_t> indices;
+            if (streams.count <= MeshWelder::kMaxShortIndexVertices) {
+                indices.resize(stream.count * 2);
+                for (size_t i = 0; i < stream.count; i++) {
+                    auto value = uint16_t(stream.fetch(i));
+                    memcpy(indices.data() + i * 2, &value, 2);
+                }
+            } else {
+                indices.resize(stream.count * 4);
+                for (size_t i = 0; i < stream.count; i++) {
+                    uint32_t value = stream.fetch(i);
+                    memcpy(indices.data() + i * 4, &value, 4);
+                }
+            }
+            gSink = gSink + uint32_t(bounds.isEmpty());
+            gSink = gSink + uint32_t(vertices.data.size() + indices.size());
+        }
+    }
+    return true;
+}
+
+// .bmesh路径：映射后读一遍将要上传的数据，簇表按 Model 的方式拷贝
+bool loadBaked(const std::string &path, bool verifyData) {
+    BakedMeshFile file;
+    if (!file.open(path, verifyData)) {
+        return false;
+    }
+    uint32_t sum = 0;
+    for (size_t m = 0; m < file.getMeshCount(); m++) {
+        const BakedMeshRecord &record = file.getMesh(m);
+        size_t vertexBytes = size_t(file.getVertexFormat(m).layout.stride) * record.vertexCount;
+        size_t indexBytes = size_t(record.indexType == GL_UNSIGNED_SHORT ? 2 : 4) * record.indexCount;
+        const uint8_t *vertices = file.getVertexData(m);
+        const uint8_t *indices = file.getIndexData(m);
+        for (size_t i = 0; i < vertexBytes; i += 64) {
+            sum += vertices[i];
+        }
+        for (size_t i = 0; i < indexBytes; i += 64) {
+            sum += indices[i];
+        }
+        MeshletMesh meshlets;
+        file.getMeshlets(m, meshlets);
+        sum += uint32_t(meshlets.meshlets.size());
+    }
+    gSink = gSink + sum;
+    return true;
+}
+
+template<typename Function>
+double bestMs(int rounds, Function &&function) {
+    double best = 1e30;
+    for (int round = 0; round < rounds; round++) {
+        double start = nowSeconds();
+        function();
+        best = std::min(best, nowSeconds() - start);
+    }
+    return best * 1e3;
+}
+
+long fileSize(const std::string &path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Logger::instance().setLevel(LogLevel::Error);
+    std::string directory = argc > 1 ? argv[1] : GLTF_SAMPLE_DIR;
+    if (directory.back() != '/') {
+        directory += '/';
+    }
+    uint32_t size = argc > 2 ? uint32_t(std::max(1, atoi(argv[2]))) : 500;
+
+    char temporary[] = "/tmp/bakedmeshbench-XXXXXX";
+    if (!mkdtemp(temporary)) {
+        printf("无法创建临时目录\n");
+        return 1;
+    }
+    std::string benchDirectory = std::string(temporary) + "/";
+    std::string baked = benchDirectory + "out.bmesh";
+    std::string grid = benchDirectory + "grid.glb";
+
+    bool ok = true;
+    for (const char *sample: {"embedded.gltf", "external.gltf", "quantized.glb"}) {
+        bool same = checkRoundTrip(directory + sample, baked);
+        printf("%s 烘焙后的顶点和索引与glTF相同：%s\n", sample, same ? "正确" : "错误");
+        ok = same && ok;
+    }
+    bool written = writeGrid(grid, size);
+    bool same = written && checkRoundTrip(grid, baked);
+    printf("%ux%u网格烘焙后的顶点和索引与glTF相同：%s\n", size, size, same ? "正确" : "错误");
+    ok = same && ok;
+
+    // 最后一次烘焙使用默认选项，.bmesh中还有细节层次和簇表
+    if (same) {
+        const int rounds = 5;
+        bool loaded = true;
+        double gltfMs = bestMs(rounds, [&]() { loaded = loadGltf(grid) && loaded; });
+        double bakedMs = bestMs(rounds, [&]() { loaded = loadBaked(baked, false) && loaded; });
+        double verifiedMs = bestMs(rounds, [&]() { loaded = loadBaked(baked, true) && loaded; });
+        printf("%ux%u网格加载，%d次中最快的一次（GLB %.1f MB，.bmesh %.1f MB）：\n", size, size, rounds,
+               double(fileSize(grid)) / (1024.0 * 1024.0), double(fileSize(baked)) / (1024.0 * 1024.0));
+        printf("  glTF：解析、量化、转换索引     %8.2f ms\n", gltfMs);
+        printf("  .bmesh：映射、读取顶点和索引   %8.2f ms（%.1fx）\n", bakedMs, gltfMs / bakedMs);
+        printf("  .bmesh：同上并校验CRC和索引    %8.2f ms（%.1fx）\n", verifiedMs, gltfMs / verifiedMs);
+        ok = loaded && ok;
+    }
+
+    unlink(baked.c_str());
+    unlink(grid.c_str());
+    rmdir(temporary);
+
+    printf(ok ? "烘焙网格检查通过\n" : "烘焙网格检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+/*
+ * batchtransformbench：检查 BatchTransform 的精度和与标量实现的一致性，并测量单核吞吐量。
+ *
+ * 检查项：sinCos 在 |x| <= kSinCosMaxArgument 内与双精度 sin/cos 的最大绝对误差不超过 kSinCosMaxError，
+ * 输入包括均匀采样、0附近的小角度和π/4的整数倍（分象限的边界）；SIMD的 sinCos 与 sinCosScalar 逐位一致；
+ * 批量生成的欧拉角矩阵和四元数矩阵与逐个物体走标量尾部的结果逐位一致，欧拉角矩阵与
+ * Mat4::rotationEulerDegrees 的差在sincos误差范围内，四元数矩阵与 Mat4::fromQuat 逐位一致。
+ * 基准测试在一个线程上分别对1k、10k、100k个物体生成矩阵，与逐个调用 Mat4 的路径对比。
+ * 用法：batchtransformbench [轮数]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "BatchTransform.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    // [0, 1)
+    float unit() {
+        state = state * 1664525u + 1013904223u;
+        return float(state >> 8) / float(1u << 24);
+    }
+
+    float range(float low, float high) {
+        return low + (high - low) * unit();
+    }
+};
+
+bool checkSinCosAccuracy() {
+    std::vector<float> inputs;
+    const int kUniform = 1 << 20;
+    for (int i = 0; i <= kUniform; i++) {
+        inputs.push_back(BatchTransform::kSinCosMaxArgument * (2.f * float(i) / kUniform - 1.f));
+    }
+    for (int i = -1000; i <= 1000; i++) {
+        inputs.push_back(float(i) * 1e-4f);
+    }
+    // π/4的整数倍及其两侧相邻的浮点数
+    for (int k = -10430; k <= 10430; k++) {
+        float x = float(k * M_PI / 4.0);
+        inputs.push_back(std::nextafter(x, -INFINITY));
+        inputs.push_back(x);
+        inputs.push_back(std::nextafter(x, INFINITY));
+    }
+
+    std::vector<float> sines(inputs.size());
+    std::vector<float> cosines(inputs.size());
+    BatchTransform::sinCos(inputs.data(), sines.data(), cosines.data(), inputs.size());
+    double maxError = 0;
+    float worst = 0.f;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (std::fabs(inputs[i]) > BatchTransform::kSinCosMaxArgument) {
+            continue;
+        }
+        double x = inputs[i];
+        double error = std::max(std::fabs(sines[i] - std::sin(x)), std::fabs(cosines[i] - std::cos(x)));
+        if (error > maxError) {
+            maxError = error;
+            worst = inputs[i];
+        }
+    }
+    bool ok = maxError <= BatchTransform::kSinCosMaxError;
+    printf("sincos精度：%zu个输入，最大绝对误差 %.3g（x = %g），上限 %.3g：%s\n", inputs.size(), maxError,
+           double(worst), double(BatchTransform::kSinCosMaxError), ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkSinCosScalar() {
+    Random random{1};
+    std::vector<float> inputs(4099);
+    for (float &x: inputs) {
+        x = random.range(-2.f * BatchTransform::kSinCosMaxArgument, 2.f * BatchTransform::kSinCosMaxArgument);
+    }
+    inputs[0] = 0.f;
+    inputs[1] = -0.f;
+    std::vector<float> sines(inputs.size());
+    std::vector<float> cosines(inputs.size());
+    BatchTransform::sinCos(inputs.data(), sines.data(), cosines.data(), inputs.size());
+
+    bool ok = true;
+    for (size_t i = 0; i < inputs.size() && ok; i++) {
+        float s, c;
+        BatchTransform::sinCosScalar(inputs[i], s, c);
+        ok = memcmp(&s, &sines[i], sizeof(float)) == 0 && memcmp(&c, &cosines[i], sizeof(float)) == 0;
+        if (!ok) {
+            printf("x = %.9g 时SIMD与标量不一致\n", double(inputs[i]));
+        }
+    }
+    // 只要其中一个输出
+    std::vector<float> onlySines(inputs.size());
+    BatchTransform::sinCos(inputs.data(), onlySines.data(), nullptr, inputs.size());
+    ok = memcmp(onlySines.data(), sines.data(), sines.size() * sizeof(float)) == 0 && ok;
+    printf("sincos与标量一致：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+float maxDifference(const Mat4 &a, const Mat4 &b) {
+    float difference = 0.f;
+    for (int i = 0; i < 16; i++) {
+        difference = std::max(difference, std::fabs(a.m[i] - b.m[i]));
+    }
+    return difference;
+}
+
+bool checkMatrices() {
+    Random random{2};
+    bool ok = true;
+    float eulerDifference = 0.f;
+    // 覆盖不是4的倍数时的尾部
+    for (size_t count: {size_t(1), size_t(3), size_t(4), size_t(7), size_t(1001)}) {
+        std::vector<float> x(count), y(count), z(count);
+        std::vector<float> qx(count), qy(count), qz(count), qw(count);
+        for (size_t i = 0; i < count; i++) {
+            x[i] = random.range(-720.f, 720.f);
+            y[i] = random.range(-720.f, 720.f);
+            z[i] = random.range(-720.f, 720.f);
+            Quat q = Quat::fromEulerDegrees(x[i], y[i], z[i]);
+            qx[i] = q.x;
+            qy[i] = q.y;
+            qz[i] = q.z;
+            qw[i] = q.w;
+        }
+        std::vector<Mat4> euler(count);
+        std::vector<Mat4> quat(count);
+        BatchTransform::buildEulerRotations(x.data(), y.data(), z.data(), count, euler.data());
+        BatchTransform::buildQuatRotations(qx.data(), qy.data(), qz.data(), qw.data(), count, quat.data());
+        for (size_t i = 0; i < count && ok; i++) {
+            // 只有一个物体时走标量路径
+            Mat4 single;
+            BatchTransform::buildEulerRotations(&x[i], &y[i], &z[i], 1, &single);
+            if (memcmp(&single, &euler[i], sizeof(Mat4)) != 0) {
+                printf("%zu个物体中第%zu个欧拉角矩阵与标量不一致\n", count, i);
+                ok = false;
+            }
+            Mat4 fromQuat = Mat4::fromQuat(Quat{qx[i], qy[i], qz[i], qw[i]});
+            if (memcmp(&fromQuat, &quat[i], sizeof(Mat4)) != 0) {
+                printf("%zu个物体中第%zu个四元数矩阵与 Mat4::fromQuat 不一致\n", count, i);
+                ok = false;
+            }
+            eulerDifference = std::max(eulerDifference,
+                                       maxDifference(euler[i], Mat4::rotationEulerDegrees(x[i], y[i], z[i])));
+        }
+    }
+    // 每个元素最多是两个sincos之积的和，误差不超过几倍的sincos误差加上libm的舍入
+    const float kEulerTolerance = 4.f * BatchTransform::kSinCosMaxError + 4e-7f;
+    if (eulerDifference > kEulerTolerance) {
+        printf("欧拉角矩阵与 Mat4::rotationEulerDegrees 相差 %g\n", double(eulerDifference));
+        ok = false;
+    }
+    printf("批量矩阵与标量一致（与 rotationEulerDegrees 最大相差 %.3g）：%s\n",
+           double(eulerDifference), ok ? "正确" : "错误");
+    return ok;
+}
+
+// 结果累加到一个值里输出，避免被优化掉
+float gSink = 0.f;
+
+template<typename Function>
+double millionsPerSecond(int rounds, size_t count, Function function) {
+    double start = nowSeconds();
+    for (int r = 0; r < rounds; r++) {
+        function();
+    }
+    return double(rounds) * double(count) / (nowSeconds() - start) / 1e6;
+}
+
+void bench(size_t count, int rounds) {
+    Random random{3};
+    std::vector<float> x(count), y(count), z(count);
+    std::vector<float> qx(count), qy(count), qz(count), qw(count);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = random.range(-180.f, 180.f);
+        y[i] = random.range(-180.f, 180.f);
+        z[i] = random.range(-180.f, 180.f);
+        Quat q = Quat::fromEulerDegrees(x[i], y[i], z[i]);
+        qx[i] = q.x;
+        qy[i] = q.y;
+        qz[i] = q.z;
+        qw[i] = q.w;
+    }
+    std::vector<Mat4> out(count);
+
+    double batchEuler = millionsPerSecond(rounds, count, [&] {
+        BatchTransform::buildEulerRotations(x.data(), y.data(), z.data(), count, out.data());
+        gSink += out[count / 2].m[0];
+    });
+    double scalarEuler = millionsPerSecond(rounds, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = Mat4::rotationEulerDegrees(x[i], y[i], z[i]);
+        }
+        gSink += out[count / 2].m[0];
+    });
+    double batchQuat = millionsPerSecond(rounds, count, [&] {
+        BatchTransform::buildQuatRotations(qx.data(), qy.data(), qz.data(), qw.data(), count, out.data());
+        gSink += out[count / 2].m[0];
+    });
+    double scalarQuat = millionsPerSecond(rounds, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = Mat4::fromQuat(Quat{qx[i], qy[i], qz[i], qw[i]});
+        }
+        gSink += out[count / 2].m[0];
+    });
+    printf("  %6zu个物体  欧拉角 %6.1f M/s（逐个 %5.1f M/s，%.1fx）  四元数 %6.1f M/s（逐个 %5.1f M/s，%.1fx）\n",
+           count, batchEuler, scalarEuler, batchEuler / scalarEuler,
+           batchQuat, scalarQuat, batchQuat / scalarQuat);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    // 每个规模处理的物体总数相同
+    int rounds = argc > 1 ? std::max(1, atoi(argv[1])) : 2000;
+    printf("后端：%s\n", kVecMathBackend);
+
+    bool ok = true;
+    ok = checkSinCosAccuracy() && ok;
+    ok = checkSinCosScalar() && ok;
+    ok = checkMatrices() && ok;
+
+    printf("单线程每秒生成的矩阵数：\n");
+    for (size_t count: {size_t(1000), size_t(10000), size_t(100000)}) {
+        bench(count, std::max(1, int(rounds * 1000 / count)));
+    }
+    printf("（校验值 %g）\n", double(gSink));
+
+    printf(ok ? "批量变换检查通过\n" : "批量变换检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+/*
+ * bvhbench：检查 BoundingVolumeHierarchy 剔除出的可见集合与逐个物体的视锥测试相同，并测量剔除和更新的耗时。
+ *
+ * 场景是随机分布在立方体中的包围盒，大小不一。相机在场景中随机取位置和朝向，视角和远平面也随机，
+ * 可见比例从很小到接近一半都会覆盖。
+ * 检查项：Frustum::classify 与 classifyScalar 结果相同；每一帧剔除输出的userData集合等于对所有存活物体
+ * 逐个做 classify 不为 Outside 的集合，没有重复；连续多帧移动一部分物体（小幅移动和瞬移）并调用 update 后
+ * 仍然成立；树中扩大的包围盒包含物体的包围盒；销毁一半物体、再加入新物体、完整重建后仍然成立。
+ * 基准测试输出BVH剔除与逐个测试的耗时、每帧移动10%物体时 moveProxy + update 的耗时和完整重建的耗时。
+ * 用法：bvhbench [物体数] [帧数]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "BoundingVolumeHierarchy.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    float range(float low, float high) {
+        return low + (high - low) * (float(next()) / float(1u << 24));
+    }
+};
+
+constexpr float kSceneHalfSize = 100.f;
+
+Aabb boxAt(float x, float y, float z, float halfSize) {
+    return Aabb{Vec3{x - halfSize, y - halfSize, z - halfSize, 0.f}, Vec3{x + halfSize, y + halfSize, z + halfSize, 0.f}};
+}
+
+Aabb randomBox(Random &random) {
+    // 大多数物体很小，少数较大
+    float halfSize = random.next() % 16 == 0 ? random.range(1.f, 5.f) : random.range(0.05f, 1.f);
+    return boxAt(random.range(-kSceneHalfSize, kSceneHalfSize), random.range(-kSceneHalfSize, kSceneHalfSize),
+                 random.range(-kSceneHalfSize, kSceneHalfSize), halfSize);
+}
+
+Aabb offset(const Aabb &box, float dx, float dy, float dz) {
+    return Aabb{Vec3{box.min.x + dx, box.min.y + dy, box.min.z + dz, 0.f},
+                Vec3{box.max.x + dx, box.max.y + dy, box.max.z + dz, 0.f}};
+}
+
+// 相机在场景中的随机位置，看向随机方向
+Frustum randomFrustum(Random &random) {
+    float px = random.range(-kSceneHalfSize, kSceneHalfSize), py = random.range(-kSceneHalfSize, kSceneHalfSize);
+    float pz = random.range(-kSceneHalfSize, kSceneHalfSize);
+    float fx, fy, fz, length;
+    do {
+        fx = random.range(-1.f, 1.f), fy = random.range(-1.f, 1.f), fz = random.range(-1.f, 1.f);
+        length = std::sqrt(fx * fx + fy * fy + fz * fz);
+    } while (length < 0.1f || length > 1.f);
+    fx /= length, fy /= length, fz /= length;
+    float ux = 0.f, uy = 1.f, uz = 0.f;
+    if (std::fabs(fy) > 0.99f) {
+        uy = 0.f, uz = 1.f;
+    }
+    float rx = fy * uz - fz * uy, ry = fz * ux - fx * uz, rz = fx * uy - fy * ux;
+    length = std::sqrt(rx * rx + ry * ry + rz * rz);
+    rx /= length, ry /= length, rz /= length;
+    ux = ry * fz - rz * fy, uy = rz * fx - rx * fz, uz = rx * fy - ry * fx;
+    const float cameraWorld[16] = {rx, ry, rz, 0.f, ux, uy, uz, 0.f, -fx, -fy, -fz, 0.f, px, py, pz, 1.f};
+    Mat4 view;
+    inverse(Mat4::fromArray(cameraWorld), view);
+    Mat4 projection = Mat4::perspective(random.range(30.f, 100.f), random.range(0.5f, 2.f), 0.1f,
+                                        random.range(20.f, 300.f));
+    return Frustum::fromMatrix(projection * view);
+}
+
+struct Scene {
+    BoundingVolumeHierarchy bvh{0.5f};
+    std::vector<Aabb> boxes;                                  // 按userData索引
+    std::vector<BoundingVolumeHierarchy::ProxyId> proxies;    // 按userData索引，销毁后为kInvalidProxy
+
+    void add(const Aabb &box) {
+        proxies.push_back(bvh.createProxy(box, uint32_t(boxes.size())));
+        boxes.push_back(box);
+    }
+
+    void move(uint32_t object, const Aabb &box) {
+        boxes[object] = box;
+        bvh.moveProxy(proxies[object], box);
+    }
+};
+
+std::vector<uint32_t> bruteForce(const Scene &scene, const Frustum &frustum) {
+    std::vector<uint32_t> visible;
+    for (uint32_t object = 0; object < scene.boxes.size(); object++) {
+        if (scene.proxies[object] != BoundingVolumeHierarchy::kInvalidProxy
+            && frustum.classify(scene.boxes[object]) != Containment::Outside) {
+            visible.push_back(object);
+        }
+    }
+    return visible;
+}
+
+bool matchesBruteForce(const Scene &scene, Random &random, int frustums, const char *stage) {
+    std::vector<uint32_t> visible;
+    for (int f = 0; f < frustums; f++) {
+        Frustum frustum = randomFrustum(random);
+        size_t count = scene.bvh.cull(frustum, visible);
+        std::sort(visible.begin(), visible.end());
+        std::vector<uint32_t> expected = bruteForce(scene, frustum);
+        if (count != visible.size() || visible != expected) {
+            printf("%s：BVH剔除出%zu个物体，逐个测试为%zu个\n", stage, visible.size(), expected.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkClassify(Random &random) {
+    bool ok = true;
+    for (int f = 0; f < 200 && ok; f++) {
+        Frustum frustum = randomFrustum(random);
+        for (int i = 0; i < 5000 && ok; i++) {
+            Aabb box = randomBox(random);
+            ok = frustum.classify(box) == frustum.classifyScalar(box);
+        }
+    }
+    printf("classify 与标量实现一致：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkScene(uint32_t count, int frames) {
+    Random random{17};
+    Scene scene;
+    for (uint32_t i = 0; i < count; i++) {
+        scene.add(randomBox(random));
+    }
+    bool ok = matchesBruteForce(scene, random, 5, "逐个插入后");
+    scene.bvh.rebuild();
+    ok = ok && matchesBruteForce(scene, random, 10, "完整重建后");
+
+    // 每帧移动10%的物体：大多数小幅移动，留在扩大的盒内；少数瞬移到别处
+    for (int frame = 0; frame < frames && ok; frame++) {
+        for (uint32_t i = 0; i < count / 10; i++) {
+            uint32_t object = random.next() % count;
+            if (random.next() % 8 == 0) {
+                scene.move(object, randomBox(random));
+            } else {
+                scene.move(object, offset(scene.boxes[object], random.range(-0.3f, 0.3f), random.range(-0.3f, 0.3f),
+                                          random.range(-0.3f, 0.3f)));
+            }
+        }
+        ok = matchesBruteForce(scene, random, 2, "移动后、update前");
+        scene.bvh.update();
+        ok = ok && matchesBruteForce(scene, random, 2, "移动并update后");
+    }
+    for (uint32_t object = 0; object < count && ok; object++) {
+        if (!scene.bvh.getFatBounds(scene.proxies[object]).contains(scene.boxes[object])
+            || scene.bvh.getUserData(scene.proxies[object]) != object) {
+            printf("物体%u的扩大包围盒或userData错误\n", object);
+            ok = false;
+        }
+    }
+
+    // 销毁一半，再加入新物体（复用代理id）
+    for (uint32_t object = 0; object < count && ok; object += 2) {
+        scene.bvh.destroyProxy(scene.proxies[object]);
+        scene.proxies[object] = BoundingVolumeHierarchy::kInvalidProxy;
+    }
+    ok = ok && scene.bvh.getProxyCount() == count / 2 && matchesBruteForce(scene, random, 10, "销毁一半后");
+    for (uint32_t i = 0; i < count / 4 && ok; i++) {
+        scene.add(randomBox(random));
+    }
+    scene.bvh.update();
+    ok = ok && matchesBruteForce(scene, random, 10, "加入新物体后");
+    scene.bvh.rebuild();
+    ok = ok && matchesBruteForce(scene, random, 10, "再次完整重建后");
+
+    printf("%u个物体、%d帧移动，BVH剔除与逐个测试一致：%s\n", count, frames, ok ? "正确" : "错误");
+    return ok;
+}
+
+void bench(uint32_t count, int frames) {
+    Random random{99};
+    Scene scene;
+    for (uint32_t i = 0; i < count; i++) {
+        scene.add(randomBox(random));
+    }
+    double start = nowSeconds();
+    scene.bvh.rebuild();
+    double rebuildMs = (nowSeconds() - start) * 1e3;
+    printf("%u个物体：完整重建 %.2f ms，树高 %zu\n", count, rebuildMs, scene.bvh.computeHeight());
+
+    // 按可见比例分档统计
+    struct Bucket {
+        const char *name;
+        double maxFraction;
+        int frustums = 0;
+        double bvhMs = 0, bruteMs = 0, fraction = 0;
+    };
+    Bucket buckets[] = {{"可见<2%", 0.02}, {"可见2%-10%", 0.1}, {"可见>10%", 1.1}};
+    std::vector<uint32_t> visible;
+    for (int f = 0; f < 300; f++) {
+        Frustum frustum = randomFrustum(random);
+        start = nowSeconds();
+        size_t visibleCount = scene.bvh.cull(frustum, visible);
+        double bvhMs = (nowSeconds() - start) * 1e3;
+        start = nowSeconds();
+        size_t bruteCount = 0;
+        for (const Aabb &box: scene.boxes) {
+            bruteCount += frustum.classify(box) != Containment::Outside;
+        }
+        double bruteMs = (nowSeconds() - start) * 1e3;
+        double fraction = double(visibleCount) / double(count);
+        for (Bucket &bucket: buckets) {
+            if (fraction < bucket.maxFraction) {
+                bucket.frustums++;
+                bucket.bvhMs += bvhMs;
+                bucket.bruteMs += bruteMs;
+                bucket.fraction += fraction;
+                break;
+            }
+        }
+        if (bruteCount != visibleCount) {
+            printf("  可见数不一致：%zu / %zu\n", visibleCount, bruteCount);
+        }
+    }
+    for (const Bucket &bucket: buckets) {
+        if (bucket.frustums == 0) {
+            continue;
+        }
+        printf("  %-12s %3d个视锥，平均可见 %5.1f%%：BVH %.3f ms，逐个测试 %.3f ms\n", bucket.name, bucket.frustums,
+               100.0 * bucket.fraction / bucket.frustums, bucket.bvhMs / bucket.frustums,
+               bucket.bruteMs / bucket.frustums);
+    }
+
+    double moveSeconds = 0, updateSeconds = 0;
+    size_t reinserted = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        start = nowSeconds();
+        for (uint32_t i = 0; i < count / 10; i++) {
+            uint32_t object = random.next() % count;
+            scene.move(object, offset(scene.boxes[object], random.range(-0.3f, 0.3f), random.range(-0.3f, 0.3f),
+                                      random.range(-0.3f, 0.3f)));
+        }
+        double middle = nowSeconds();
+        reinserted += scene.bvh.update();
+        updateSeconds += nowSeconds() - middle;
+        moveSeconds += middle - start;
+    }
+    printf("  每帧移动10%%：moveProxy %.3f ms，update %.3f ms（平均重新插入 %.1f 个叶子），树高 %zu\n",
+           moveSeconds * 1e3 / frames, updateSeconds * 1e3 / frames, double(reinserted) / frames,
+           scene.bvh.computeHeight());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t count = argc > 1 ? uint32_t(std::max(100, atoi(argv[1]))) : 100000;
+    int frames = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+    printf("后端：%s\n", kVecMathBackend);
+
+    bool ok = true;
+    Random random{3};
+    ok = checkClassify(random) && ok;
+    ok = checkScene(count, frames) && ok;
+    bench(count, frames);
+
+    printf(ok ? "BVH剔除检查通过\n" : "BVH剔除检查失败\n");
+    return ok ? 0 : 1;
+}
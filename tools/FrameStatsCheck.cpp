@@ -0,0 +1,202 @@
+/*
+ * framestatscheck：用合成时钟驱动 FrameStats，检查百分位、直方图的桶计数和错过垂直同步的计数。
+ *
+ * 检查项：百分位返回样本所在桶的上界且不超过最大值，p50/p90/p99按样本数向上取整选择桶；
+ * 超出范围的样本落在最后一个桶但最大值精确；第一帧没有帧间隔；间隔超过1.5个周期才算卡顿，
+ * 错过的垂直同步数按四舍五入的周期数减一；修改垂直同步周期后按新的周期判断；
+ * dumpIfDue 只在间隔到期后输出并重置统计。
+ * 用法：framestatscheck
+ */
+
+#include <cstdio>
+
+#include "FrameStats.h"
+#include "Log.h"
+
+namespace {
+
+constexpr uint64_t kMs = 1000000;
+constexpr uint64_t kVsync60 = 16666667;
+
+bool expectEqual(const char *name, uint64_t actual, uint64_t expected) {
+    if (actual != expected) {
+        printf("%s 错误: %llu，应为 %llu\n", name, (unsigned long long) actual, (unsigned long long) expected);
+        return false;
+    }
+    return true;
+}
+
+bool expectMetric(const char *name, const FrameStats::Metric &metric,
+                  uint64_t p50, uint64_t p90, uint64_t p99, uint64_t max) {
+    char label[64];
+    bool ok = true;
+    snprintf(label, sizeof(label), "%s p50", name);
+    ok = expectEqual(label, metric.p50Ns, p50) && ok;
+    snprintf(label, sizeof(label), "%s p90", name);
+    ok = expectEqual(label, metric.p90Ns, p90) && ok;
+    snprintf(label, sizeof(label), "%s p99", name);
+    ok = expectEqual(label, metric.p99Ns, p99) && ok;
+    snprintf(label, sizeof(label), "%s max", name);
+    ok = expectEqual(label, metric.maxNs, max) && ok;
+    return ok;
+}
+
+//! 合成时钟，从非0开始：FrameStats 用0表示还没有前一帧
+struct SyntheticClock {
+    uint64_t now = 1000 * kMs;
+
+    FrameStats::Clock clock() {
+        return [this] { return now; };
+    }
+
+    /*!
+     * 按 Renderer::render 的顺序走完一帧
+     * @param gapNs 本帧开始到下一帧开始的时间
+     */
+    void frame(FrameStats &stats, uint64_t cpuNs, uint64_t swapNs, uint64_t gapNs) {
+        uint64_t begin = now;
+        stats.beginFrame();
+        now += cpuNs;
+        stats.beginSwap();
+        now += swapNs;
+        stats.endSwap();
+        now = begin + gapNs;
+    }
+};
+
+bool checkHistogram() {
+    bool ok = true;
+    FrameHistogram histogram;
+    ok = expectEqual("空直方图的百分位", histogram.percentile(50), 0) && ok;
+
+    const uint64_t values[] = {0, FrameHistogram::kBucketWidthNs - 1, FrameHistogram::kBucketWidthNs,
+                               99900000, 150 * kMs};
+    for (uint64_t value: values) {
+        histogram.add(value);
+    }
+    ok = expectEqual("第0个桶", histogram.getBucket(0), 2) && ok;
+    ok = expectEqual("第1个桶", histogram.getBucket(1), 1) && ok;
+    // 99.9毫秒在最后一个桶里，150毫秒超出范围也落在最后一个桶
+    ok = expectEqual("最后一个桶", histogram.getBucket(FrameHistogram::kBucketCount - 1), 2) && ok;
+    uint64_t total = 0;
+    for (size_t i = 0; i < FrameHistogram::kBucketCount; i++) {
+        total += histogram.getBucket(i);
+    }
+    ok = expectEqual("桶计数之和", total, histogram.getCount()) && ok;
+    ok = expectEqual("最大值", histogram.getMax(), 150 * kMs) && ok;
+    // p0返回第一个非空桶的上界；p100在最后一个桶，上界是100毫秒
+    ok = expectEqual("p0", histogram.percentile(0), FrameHistogram::kBucketWidthNs) && ok;
+    ok = expectEqual("p40", histogram.percentile(40), FrameHistogram::kBucketWidthNs) && ok;
+    ok = expectEqual("p41", histogram.percentile(41), 2 * FrameHistogram::kBucketWidthNs) && ok;
+    ok = expectEqual("p100", histogram.percentile(100), 100 * kMs) && ok;
+
+    histogram.reset();
+    ok = expectEqual("重置后的样本数", histogram.getCount(), 0) && ok;
+    ok = expectEqual("重置后的桶", histogram.getBucket(0), 0) && ok;
+    printf("直方图：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkFrames() {
+    bool ok = true;
+    SyntheticClock clock;
+    FrameStats stats(clock.clock(), kVsync60, 0);
+
+    // 100帧：90帧CPU 4.1毫秒，9帧10.1毫秒，最后一帧30.05毫秒；交换都是1毫秒。
+    // 帧间隔大多是一个周期，另有2个周期、3个周期、1.44个周期（不算卡顿）和1.56个周期（算错过1次）
+    for (int i = 0; i < 100; i++) {
+        uint64_t cpu = i < 90 ? 4100000 : i < 99 ? 10100000 : 30050000;
+        uint64_t gap = kVsync60;
+        switch (i) {
+            case 10:
+                gap = 2 * kVsync60;
+                break;
+            case 20:
+                gap = 50 * kMs;
+                break;
+            case 30:
+                gap = 24 * kMs;
+                break;
+            case 40:
+                gap = 26 * kMs;
+                break;
+            default:
+                break;
+        }
+        clock.frame(stats, cpu, kMs, gap);
+    }
+
+    FrameStats::Summary summary = stats.getSummary();
+    ok = expectEqual("帧数", summary.frameCount, 100) && ok;
+    ok = expectEqual("卡顿帧数", summary.jankFrames, 3) && ok;
+    ok = expectEqual("错过垂直同步次数", summary.missedVsyncs, 4) && ok;
+    // 4.1毫秒所在桶的上界是4.25毫秒；第99个样本是10.1毫秒
+    ok = expectMetric("CPU帧时间", summary.cpuTime, 4250000, 4250000, 10250000, 30050000) && ok;
+    // 桶上界1.25毫秒被截到真实的最大值
+    ok = expectMetric("交换时间", summary.swapTime, kMs, kMs, kMs, kMs) && ok;
+    // 第一帧没有间隔，共99个；第99个样本就是最大的50毫秒
+    ok = expectMetric("帧间隔", summary.frameInterval, 16750000, 16750000, 50 * kMs, 50 * kMs) && ok;
+
+    // 120Hz：一个60Hz的帧间隔是两个周期
+    stats.reset();
+    stats.setVsyncPeriod(8333333);
+    stats.recordFrame(4 * kMs, kMs, 16666667);
+    stats.recordFrame(4 * kMs, kMs, 12 * kMs);
+    stats.recordFrame(4 * kMs, kMs, 12600000);
+    summary = stats.getSummary();
+    ok = expectEqual("120Hz卡顿帧数", summary.jankFrames, 2) && ok;
+    ok = expectEqual("120Hz错过垂直同步次数", summary.missedVsyncs, 2) && ok;
+
+    // 间隔为0表示没有前一帧，只记录CPU和交换时间
+    stats.reset();
+    stats.recordFrame(4 * kMs, kMs, 0);
+    summary = stats.getSummary();
+    ok = expectEqual("没有前一帧时的帧数", summary.frameCount, 1) && ok;
+    ok = expectEqual("没有前一帧时的帧间隔", summary.frameInterval.maxNs, 0) && ok;
+    printf("帧统计：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkDump() {
+    bool ok = true;
+    SyntheticClock clock;
+    FrameStats stats(clock.clock(), kVsync60, 1000 * kMs);
+    clock.frame(stats, 4 * kMs, kMs, 500 * kMs);
+    if (stats.dumpIfDue()) {
+        printf("间隔未到就输出了汇总\n");
+        ok = false;
+    }
+    clock.frame(stats, 4 * kMs, kMs, 500 * kMs);
+    if (!stats.dumpIfDue() || stats.getSummary().frameCount != 0) {
+        printf("间隔到期后没有输出汇总或没有重置\n");
+        ok = false;
+    }
+    if (stats.dumpIfDue()) {
+        printf("刚输出过又输出了汇总\n");
+        ok = false;
+    }
+
+    FrameStats silent(clock.clock(), kVsync60, 0);
+    clock.now += 3600000 * kMs;
+    if (silent.dumpIfDue()) {
+        printf("间隔为0时输出了汇总\n");
+        ok = false;
+    }
+    printf("周期输出：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    // 汇总通过LOGI输出，检查时不需要
+    Logger::instance().setLevel(LogLevel::Warn);
+
+    bool ok = true;
+    ok = checkHistogram() && ok;
+    ok = checkFrames() && ok;
+    ok = checkDump() && ok;
+
+    printf(ok ? "帧统计检查通过\n" : "帧统计检查失败\n");
+    return ok ? 0 : 1;
+}
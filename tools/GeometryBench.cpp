@@ -0,0 +1,358 @@
+/*
+ * geometrybench：在记录GL实现上检查 MeshBuffers，统计客户端数组和GPU缓冲两种绘制方式每帧的调用和传输量。
+ *
+ * 检查项：各种顶点布局和属性位置下，VAO绘制与客户端数组绘制读到的顶点逐字节相同（包括按字节偏移绘制
+ * 第二个细节层次）；VAO第二次绑定只有一次GL调用，属性位置改变时重新创建；上传别的网格不会改掉
+ * 已绑定的VAO的索引缓冲；Dynamic的部分更新使用 glBufferSubData，Stream的整体更新重新分配存储，
+ * 更新后绘制读到新数据，越界的更新被忽略；移动和析构后GL对象不泄漏也不重复删除。
+ * 统计项：同一个场景按两种方式绘制若干帧，输出每帧的GL调用数、属性设置调用数、上传字节数和
+ * 驱动从客户端数组拷贝的字节数，以及每帧更新一个动画模型时 Dynamic 和 Stream 的传输量。
+ * 用法：geometrybench [模型数] [帧数]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "MeshBuffers.h"
+#include "RecordingGl.h"
+
+namespace {
+
+//! 测试用的网格：一块起伏的方形网格，索引依次是两个细节层次
+struct Mesh {
+    QuantizedVertices vertices;
+    std::vector<uint16_t> indices;
+    size_t lodOffset[2] = {}; // 每个细节层次在索引中的起点（索引个数）
+    size_t lodCount[2] = {};
+};
+
+std::vector<Vertex> gridVertices(int cells, float phase) {
+    std::vector<Vertex> vertices;
+    for (int y = 0; y <= cells; y++) {
+        for (int x = 0; x <= cells; x++) {
+            float u = float(x) / float(cells);
+            float v = float(y) / float(cells);
+            float height = 0.1f * std::sin(u * 6.f + phase) * std::cos(v * 5.f - phase);
+            uint32_t color = 0xFF000000u | uint32_t(x * 255 / cells) | uint32_t(y * 255 / cells) << 8;
+            vertices.emplace_back(Vector3{u * 2.f - 1.f, height, v * 2.f - 1.f}, Vector2{u, v}, color);
+        }
+    }
+    return vertices;
+}
+
+// cells 必须是偶数，第二个细节层次每隔一行一列取顶点
+Mesh makeGrid(int cells, const VertexLayout &layout, float phase) {
+    Mesh mesh;
+    mesh.vertices = VertexFormat::quantize(gridVertices(cells, phase), layout);
+    for (int lod = 0; lod < 2; lod++) {
+        int step = 1 << lod;
+        mesh.lodOffset[lod] = mesh.indices.size();
+        for (int y = 0; y < cells; y += step) {
+            for (int x = 0; x < cells; x += step) {
+                auto at = [&](int column, int row) {
+                    return uint16_t(row * (cells + 1) + column);
+                };
+                mesh.indices.insert(mesh.indices.end(), {
+                        at(x, y), at(x + step, y), at(x, y + step),
+                        at(x + step, y), at(x + step, y + step), at(x, y + step)});
+            }
+        }
+        mesh.lodCount[lod] = mesh.indices.size() - mesh.lodOffset[lod];
+    }
+    return mesh;
+}
+
+void upload(MeshBuffers &buffers, const Mesh &mesh, BufferUsage usage) {
+    buffers.upload(mesh.vertices.data.data(), mesh.vertices.data.size(),
+                   mesh.indices.data(), mesh.indices.size() * sizeof(uint16_t), usage);
+}
+
+// 与 Shader::drawModel 对两种模型发出的顶点相关调用相同
+
+uint64_t drawClientArrays(const Mesh &mesh, const VertexAttributeLocations &locations, int lod) {
+    MeshBuffers::bindClientArrays(mesh.vertices.layout, mesh.vertices.data.data(), locations);
+    glDrawElements(GL_TRIANGLES, GLsizei(mesh.lodCount[lod]), GL_UNSIGNED_SHORT,
+                   mesh.indices.data() + mesh.lodOffset[lod]);
+    uint64_t hash = RecordingGl::lastDrawHash();
+    MeshBuffers::unbindClientArrays(mesh.vertices.layout, locations);
+    return hash;
+}
+
+uint64_t drawBuffers(const Mesh &mesh, const MeshBuffers &buffers, const VertexAttributeLocations &locations,
+                     int lod) {
+    buffers.bindVertexArray(mesh.vertices.layout, locations);
+    glDrawElements(GL_TRIANGLES, GLsizei(mesh.lodCount[lod]), GL_UNSIGNED_SHORT,
+                   reinterpret_cast<const void *>(mesh.lodOffset[lod] * sizeof(uint16_t)));
+    return RecordingGl::lastDrawHash();
+}
+
+bool checkEquivalence() {
+    bool ok = true;
+    RecordingGl::reset();
+    const VertexLayout layouts[] = {
+            VertexLayout::full(),
+            VertexLayout::compact(),
+            VertexLayout::make(PositionFormat::Half, UVFormat::Unorm16, ColorFormat::Rgba8),
+            VertexLayout::make(PositionFormat::Float32, UVFormat::Float32, ColorFormat::Rgba8)};
+    const VertexAttributeLocations locationSets[] = {
+            {0, 1, 2},
+            {0, 1, -1},
+            {2, 0, 1},
+            {5, -1, 3}};
+    for (const VertexLayout &layout: layouts) {
+        Mesh mesh = makeGrid(16, layout, 0.3f);
+        MeshBuffers buffers;
+        upload(buffers, mesh, BufferUsage::Static);
+        for (const VertexAttributeLocations &locations: locationSets) {
+            for (int lod = 0; lod < 2; lod++) {
+                uint64_t expected = drawClientArrays(mesh, locations, lod);
+                uint64_t actual = drawBuffers(mesh, buffers, locations, lod);
+                glBindVertexArray(0);
+                if (expected != actual) {
+                    printf("VAO读到的顶点不同: 步长%u 位置(%d, %d, %d) 第%d层\n", layout.stride,
+                           locations.position, locations.uv, locations.color, lod);
+                    ok = false;
+                }
+            }
+        }
+    }
+    ok = ok && RecordingGl::errorCount() == 0;
+    printf("VAO与客户端数组一致：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkVertexArrayState() {
+    bool ok = true;
+    RecordingGl::reset();
+    VertexAttributeLocations locations{0, 1, -1};
+    Mesh first = makeGrid(8, VertexLayout::compact(), 0.f);
+    Mesh second = makeGrid(10, VertexLayout::compact(), 1.f);
+    uint64_t expected = drawClientArrays(first, locations, 0);
+
+    MeshBuffers firstBuffers;
+    upload(firstBuffers, first, BufferUsage::Static);
+    drawBuffers(first, firstBuffers, locations, 0);
+
+    // 再次绑定只有一次GL调用
+    RecordingGl::beginFrame();
+    drawBuffers(first, firstBuffers, locations, 0);
+    if (RecordingGl::frame().calls != 2 || RecordingGl::frame().attributeCalls != 0) {
+        printf("VAO再次绑定有多余的调用: %zu\n", RecordingGl::frame().calls);
+        ok = false;
+    }
+
+    // 第一个VAO还绑定着时上传第二个网格，第一个VAO的索引缓冲不能被改掉
+    MeshBuffers secondBuffers;
+    upload(secondBuffers, second, BufferUsage::Static);
+    if (drawBuffers(first, firstBuffers, locations, 0) != expected) {
+        printf("上传改掉了已绑定的VAO\n");
+        ok = false;
+    }
+
+    // 属性位置改变时重新创建VAO，旧的被删除
+    VertexAttributeLocations relocated{3, 4, -1};
+    if (drawBuffers(first, firstBuffers, relocated, 0) != drawClientArrays(first, relocated, 0)
+        || RecordingGl::liveVertexArrays() != 1) {
+        printf("属性位置改变后VAO错误\n");
+        ok = false;
+    }
+
+    // 移动后由新对象持有，原对象析构时不再删除
+    {
+        MeshBuffers moved(std::move(secondBuffers));
+        if (secondBuffers.isUploaded() || !moved.isUploaded()) {
+            printf("移动后的所有权错误\n");
+            ok = false;
+        }
+        firstBuffers = std::move(moved);
+    }
+    if (RecordingGl::liveBuffers() != 2) {
+        printf("移动赋值后缓冲个数错误: %zu\n", RecordingGl::liveBuffers());
+        ok = false;
+    }
+    firstBuffers.release();
+    if (RecordingGl::liveBuffers() != 0 || RecordingGl::liveVertexArrays() != 0) {
+        printf("释放后还有GL对象\n");
+        ok = false;
+    }
+
+    ok = ok && RecordingGl::errorCount() == 0;
+    printf("VAO状态：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkUpdates() {
+    bool ok = true;
+    RecordingGl::reset();
+    VertexAttributeLocations locations{0, 1, 2};
+    VertexLayout layout = VertexLayout::make(PositionFormat::Float32, UVFormat::Unorm16, ColorFormat::Rgba8);
+    for (BufferUsage usage: {BufferUsage::Dynamic, BufferUsage::Stream}) {
+        Mesh mesh = makeGrid(12, layout, 0.f);
+        MeshBuffers buffers;
+        upload(buffers, mesh, usage);
+        drawBuffers(mesh, buffers, locations, 0);
+
+        // 整体更新：Stream重新分配存储，Dynamic原地覆盖
+        Mesh changed = makeGrid(12, layout, 2.f);
+        RecordingGl::beginFrame();
+        buffers.updateVertices(0, changed.vertices.data.data(), changed.vertices.data.size());
+        const auto &frame = RecordingGl::frame();
+        size_t expectedOrphans = usage == BufferUsage::Stream ? 1 : 0;
+        if (frame.bufferUploads != 1 || frame.uploadBytes != changed.vertices.data.size()
+            || frame.bufferOrphans != expectedOrphans) {
+            printf("整体更新的调用错误: 上传%zu次 %zu字节 重新分配%zu次\n",
+                   frame.bufferUploads, frame.uploadBytes, frame.bufferOrphans);
+            ok = false;
+        }
+        if (drawBuffers(changed, buffers, locations, 1) != drawClientArrays(changed, locations, 1)) {
+            printf("整体更新后读到旧数据\n");
+            ok = false;
+        }
+
+        // 部分更新：后一半顶点换回原来的数据
+        size_t half = mesh.vertices.vertexCount / 2 * layout.stride;
+        std::vector<uint8_t> mixed = changed.vertices.data;
+        std::copy(mesh.vertices.data.begin() + long(half), mesh.vertices.data.end(), mixed.begin() + long(half));
+        RecordingGl::beginFrame();
+        buffers.updateVertices(half, mixed.data() + half, mixed.size() - half);
+        if (frame.bufferUploads != 1 || frame.bufferOrphans != 0 || frame.uploadBytes != mixed.size() - half) {
+            printf("部分更新的调用错误\n");
+            ok = false;
+        }
+        changed.vertices.data = mixed;
+        if (drawBuffers(changed, buffers, locations, 0) != drawClientArrays(changed, locations, 0)) {
+            printf("部分更新后读到的数据错误\n");
+            ok = false;
+        }
+
+        // 越界的更新不调用GL
+        RecordingGl::beginFrame();
+        buffers.updateVertices(half, mixed.data(), mixed.size());
+        if (frame.calls != 0) {
+            printf("越界的更新调用了GL\n");
+            ok = false;
+        }
+    }
+    ok = ok && RecordingGl::errorCount() == 0 && RecordingGl::liveBuffers() == 0;
+    printf("顶点更新：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+struct FrameTotals {
+    double calls = 0;
+    double attributeCalls = 0;
+    double uploadBytes = 0;
+    double clientArrayBytes = 0;
+
+    void add(const RecordingGl::FrameCounters &frame) {
+        calls += double(frame.calls);
+        attributeCalls += double(frame.attributeCalls);
+        uploadBytes += double(frame.uploadBytes);
+        clientArrayBytes += double(frame.clientArrayBytes);
+    }
+
+    void print(const char *name, int frames) const {
+        printf("  %-22s GL调用 %8.0f  属性调用 %7.0f  上传 %9.0f字节  客户端数组 %9.0f字节\n",
+               name, calls / frames, attributeCalls / frames, uploadBytes / frames, clientArrayBytes / frames);
+    }
+};
+
+/*!
+ * 同一个场景分别用两种方式绘制若干帧。第0帧单独统计：缓冲方式在这一帧上传并创建VAO
+ * @param animated 每帧更新顶点的模型用的用途，Static表示没有动画模型
+ */
+bool benchmark(int modelCount, int frameCount, BufferUsage animated) {
+    VertexLayout layout = VertexLayout::compact();
+    VertexAttributeLocations locations{0, 1, 2};
+    std::vector<Mesh> meshes;
+    for (int i = 0; i < modelCount; i++) {
+        meshes.push_back(makeGrid(i % 4 == 0 ? 48 : 16, layout, float(i)));
+    }
+    std::vector<Mesh> frames;
+    if (animated != BufferUsage::Static) {
+        for (int frame = 0; frame < frameCount; frame++) {
+            frames.push_back(makeGrid(48, layout, float(frame) * 0.1f));
+        }
+    }
+    auto meshFor = [&](int model, int frame) -> const Mesh & {
+        return model == 0 && !frames.empty() ? frames[size_t(frame)] : meshes[size_t(model)];
+    };
+
+    bool ok = true;
+    RecordingGl::reset();
+    FrameTotals clientFirst, clientSteady;
+    for (int frame = 0; frame < frameCount; frame++) {
+        RecordingGl::beginFrame();
+        for (int i = 0; i < modelCount; i++) {
+            drawClientArrays(meshFor(i, frame), locations, i % 2);
+        }
+        (frame == 0 ? clientFirst : clientSteady).add(RecordingGl::frame());
+    }
+
+    RecordingGl::reset();
+    FrameTotals buffersFirst, buffersSteady;
+    std::vector<MeshBuffers> buffers(meshes.size());
+    for (int frame = 0; frame < frameCount; frame++) {
+        RecordingGl::beginFrame();
+        for (int i = 0; i < modelCount; i++) {
+            const Mesh &mesh = meshFor(i, frame);
+            if (frame == 0) {
+                upload(buffers[size_t(i)], mesh, i == 0 && !frames.empty() ? animated : BufferUsage::Static);
+            } else if (i == 0 && !frames.empty()) {
+                buffers[0].updateVertices(0, mesh.vertices.data.data(), mesh.vertices.data.size());
+            }
+            uint64_t hash = drawBuffers(mesh, buffers[size_t(i)], locations, i % 2);
+            // 抽查几帧，与客户端数组读到的顶点相同
+            if (frame % 8 == 1 && i % 16 == 0) {
+                glBindVertexArray(0);
+                ok = drawClientArrays(mesh, locations, i % 2) == hash && ok;
+            }
+        }
+        if (frame % 8 != 1) {
+            (frame == 0 ? buffersFirst : buffersSteady).add(RecordingGl::frame());
+        }
+    }
+    int steadyFrames = frameCount - 1;
+    int sampledFrames = steadyFrames - (frameCount + 6) / 8;
+
+    const char *names[] = {"静态", "Dynamic动画", "Stream动画"};
+    printf("%s场景：%d个模型，%zu字节顶点和索引\n", names[int(animated)], modelCount, RecordingGl::bufferBytes());
+    clientFirst.print("客户端数组 第0帧", 1);
+    clientSteady.print("客户端数组 之后每帧", steadyFrames);
+    buffersFirst.print("缓冲+VAO 第0帧", 1);
+    buffersSteady.print("缓冲+VAO 之后每帧", sampledFrames);
+
+    // 静态场景上传后不再传输，动画场景每帧只传一个模型的顶点
+    double expectedBytes = frames.empty() ? 0. : double(frames[0].vertices.data.size());
+    if (buffersSteady.clientArrayBytes != 0 || buffersSteady.uploadBytes / sampledFrames != expectedBytes
+        || buffersSteady.attributeCalls != 0) {
+        printf("缓冲方式之后每帧的传输量错误\n");
+        ok = false;
+    }
+    buffers.clear();
+    ok = ok && RecordingGl::errorCount() == 0 && RecordingGl::liveBuffers() == 0;
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int modelCount = argc > 1 ? std::max(1, atoi(argv[1])) : 200;
+    int frameCount = argc > 2 ? std::max(3, atoi(argv[2])) : 30;
+
+    bool ok = true;
+    ok = checkEquivalence() && ok;
+    ok = checkVertexArrayState() && ok;
+    ok = checkUpdates() && ok;
+
+    for (BufferUsage animated: {BufferUsage::Static, BufferUsage::Dynamic, BufferUsage::Stream}) {
+        ok = benchmark(modelCount, frameCount, animated) && ok;
+    }
+
+    printf(ok ? "几何缓冲检查通过\n" : "几何缓冲检查失败\n");
+    return ok ? 0 : 1;
+}
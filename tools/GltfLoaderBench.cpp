@@ -0,0 +1,410 @@
+/*
+ * gltfloaderbench：用提交在 tools/samples 中的样例检查 GltfLoader 的解析结果，并测量大网格的加载耗时和峰值内存。
+ *
+ * 样例：embedded.gltf（base64内嵌缓冲、节点层级、材质颜色）、external.gltf + external.bin（外部缓冲，
+ * 位置和uv交错存放、访问器带byteOffset、uint索引、外部图像）、quantized.glb（KHR_mesh_quantization：
+ * 非归一化short位置、归一化ushort uv、归一化byte法线、ubyte索引，以及没有索引的归一化ubyte位置）、
+ * sparse.gltf（稀疏访问器不支持：作为POSITION时图元被跳过，作为TEXCOORD_0时被忽略）。
+ * 检查项：网格、图元、材质、图像、节点的数量和内容，每个顶点读出的位置、uv和每个索引都与写入样例的值相同。
+ * 基准测试生成约100万个顶点的网格，分别保存为GLB、.gltf + .bin和base64内嵌的.gltf，在新的子进程中
+ * 加载并量化全部顶点、读出全部索引，输出各阶段耗时和 getrusage 的峰值常驻内存（ru_maxrss）。
+ * 用法：gltfloaderbench [样例目录] [大网格的边长]
+ */
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GltfLoader.h"
+#include "Log.h"
+#include "VertexFormat.h"
+
+#ifndef GLTF_SAMPLE_DIR
+#define GLTF_SAMPLE_DIR "samples"
+#endif
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool near(float a, float b) {
+    return std::fabs(a - b) <= 1e-6f;
+}
+
+bool samePosition(const Vector3 &position, float x, float y, float z) {
+    return near(position.x, x) && near(position.y, y) && near(position.z, z);
+}
+
+bool sameUV(const Vector2 &uv, float u, float v) {
+    return near(uv.u, u) && near(uv.v, v);
+}
+
+bool sameIndices(const IndexStream &stream, const std::vector<Index> &expected) {
+    if (stream.count != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (stream.fetch(i) != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 检查失败时输出样例名和原因
+bool expect(bool condition, const char *sample, const char *what) {
+    if (!condition) {
+        printf("  %s：%s\n", sample, what);
+    }
+    return condition;
+}
+
+bool checkEmbedded(const std::string &directory) {
+    const char *name = "embedded.gltf";
+    auto scene = GltfLoader::load(directory + name);
+    if (!expect(scene != nullptr, name, "加载失败")) {
+        return false;
+    }
+    bool ok = expect(scene->meshes.size() == 1 && scene->meshes[0].name == "quad"
+                     && scene->meshes[0].primitives.size() == 1, name, "网格或图元数量错误");
+    ok = ok && expect(scene->decodedBuffers.size() == 1 && scene->files.size() == 1, name, "缓冲来源错误");
+    if (!ok) {
+        return false;
+    }
+    const GltfPrimitive &primitive = scene->meshes[0].primitives[0];
+    VertexStreams streams = primitive.vertexStreams();
+    const float positions[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    const float uvs[4][2] = {{0, 1}, {1, 1}, {1, 0}, {0, 0}};
+    ok = expect(streams.count == 4 && primitive.mode == GL_TRIANGLES, name, "顶点数或mode错误");
+    for (size_t i = 0; i < 4 && ok; i++) {
+        ok = expect(samePosition(streams.fetchPosition(i), positions[i][0], positions[i][1], positions[i][2])
+                    && sameUV(streams.fetchUV(i), uvs[i][0], uvs[i][1]), name, "顶点数据错误");
+    }
+    ok = ok && expect(primitive.normal.isValid() && primitive.normal.components == 3, name, "法线无效");
+    ok = ok && expect(primitive.indices.componentType == GL_UNSIGNED_SHORT
+                      && sameIndices(primitive.indexStream(), {0, 1, 2, 0, 2, 3}), name, "索引错误");
+
+    ok = ok && expect(scene->materials.size() == 1 && primitive.material == 0
+                      && scene->materials[0].name == "tinted" && scene->materials[0].baseColorImage == -1
+                      && scene->materials[0].baseColorFactor[0] == 0.5f
+                      && scene->materials[0].baseColorFactor[1] == 0.25f, name, "材质错误");
+    ok = ok && expect(scene->nodes.size() == 2 && scene->rootNodes == std::vector<uint32_t>{0}, name, "节点数量错误");
+    if (!ok) {
+        return false;
+    }
+    const GltfNode &root = scene->nodes[0];
+    const GltfNode &child = scene->nodes[1];
+    ok = expect(root.name == "root" && !root.hasMatrix && root.mesh == -1 && root.translation[0] == 1.f
+                && root.translation[1] == 2.f && root.translation[2] == 3.f && root.childCount == 1
+                && scene->nodeChildren[root.firstChild] == 1, name, "根节点错误");
+    ok = ok && expect(child.name == "child" && child.mesh == 0 && child.hasMatrix && child.matrix[0] == 2.f
+                      && child.matrix[12] == 5.f && child.matrix[13] == 6.f && child.matrix[14] == 7.f
+                      && child.childCount == 0, name, "子节点错误");
+    return ok;
+}
+
+bool checkExternal(const std::string &directory) {
+    const char *name = "external.gltf";
+    auto scene = GltfLoader::load(directory + name);
+    if (!expect(scene != nullptr, name, "加载失败")) {
+        return false;
+    }
+    bool ok = expect(scene->meshes.size() == 1 && scene->meshes[0].primitives.size() == 1, name, "图元数量错误");
+    // 外部.bin是映射的，不拷贝
+    ok = ok && expect(scene->files.size() == 2 && scene->decodedBuffers.empty(), name, "外部缓冲没有被映射");
+    ok = ok && expect(scene->baseDirectory == directory, name, "baseDirectory错误");
+    if (!ok) {
+        return false;
+    }
+    const GltfPrimitive &primitive = scene->meshes[0].primitives[0];
+    VertexStreams streams = primitive.vertexStreams();
+    ok = expect(streams.count == 9 && streams.positionStride == 20 && streams.uvStride == 20
+                && streams.uv == streams.position + 12, name, "交错存放的访问器错误");
+    for (size_t i = 0; i < 9 && ok; i++) {
+        float x = float(i % 3), y = float(i / 3);
+        ok = expect(samePosition(streams.fetchPosition(i), x, y, 0.5f * x * y)
+                    && sameUV(streams.fetchUV(i), x / 2.f, y / 2.f), name, "顶点数据错误");
+    }
+    std::vector<Index> indices;
+    for (Index y = 0; y < 2; y++) {
+        for (Index x = 0; x < 2; x++) {
+            Index i = y * 3 + x;
+            indices.insert(indices.end(), {i, i + 1, i + 4, i, i + 4, i + 3});
+        }
+    }
+    ok = ok && expect(primitive.indices.componentType == GL_UNSIGNED_INT
+                      && sameIndices(primitive.indexStream(), indices), name, "索引错误");
+    ok = ok && expect(scene->images.size() == 1 && scene->images[0].uri == "texture.png"
+                      && scene->images[0].data == nullptr, name, "外部图像错误");
+    ok = ok && expect(scene->materials.size() == 1 && scene->materials[0].baseColorImage == 0, name, "材质纹理错误");
+    return ok;
+}
+
+bool checkQuantized(const std::string &directory) {
+    const char *name = "quantized.glb";
+    auto scene = GltfLoader::load(directory + name);
+    if (!expect(scene != nullptr, name, "加载失败")) {
+        return false;
+    }
+    bool ok = expect(scene->meshes.size() == 1 && scene->meshes[0].primitives.size() == 2, name, "图元数量错误");
+    ok = ok && expect(scene->files.size() == 1 && scene->decodedBuffers.empty(), name, "GLB的BIN块没有被直接使用");
+    if (!ok) {
+        return false;
+    }
+    const GltfPrimitive &indexed = scene->meshes[0].primitives[0];
+    VertexStreams streams = indexed.vertexStreams();
+    ok = expect(streams.count == 3 && streams.positionType == GL_SHORT && !streams.positionNormalized
+                && streams.positionStride == 8 && streams.uvType == GL_UNSIGNED_SHORT && streams.uvNormalized,
+                name, "量化属性的类型错误");
+    const float positions[3][3] = {{-100, 0, 50}, {100, 0, 50}, {0, 300, -50}};
+    const float uvs[3][2] = {{0, 1}, {1, 1}, {32768.f / 65535.f, 0}};
+    for (size_t i = 0; i < 3 && ok; i++) {
+        ok = expect(samePosition(streams.fetchPosition(i), positions[i][0], positions[i][1], positions[i][2])
+                    && sameUV(streams.fetchUV(i), uvs[i][0], uvs[i][1]), name, "顶点数据错误");
+    }
+    ok = ok && expect(indexed.normal.isValid() && indexed.normal.componentType == GL_BYTE && indexed.normal.normalized,
+                      name, "归一化byte法线错误");
+    ok = ok && expect(indexed.indices.componentType == GL_UNSIGNED_BYTE
+                      && sameIndices(indexed.indexStream(), {0, 1, 2}), name, "ubyte索引错误");
+
+    const GltfPrimitive &unindexed = scene->meshes[0].primitives[1];
+    streams = unindexed.vertexStreams();
+    ok = ok && expect(!unindexed.indices.isValid() && sameIndices(unindexed.indexStream(), {0, 1, 2, 3, 4, 5})
+                      && streams.uv == nullptr, name, "没有索引的图元错误");
+    const uint8_t bytes[6][3] = {{0, 0, 0}, {255, 0, 0}, {0, 255, 0}, {255, 255, 255}, {0, 0, 255}, {128, 128, 128}};
+    for (size_t i = 0; i < 6 && ok; i++) {
+        ok = expect(samePosition(streams.fetchPosition(i), float(bytes[i][0]) / 255.f, float(bytes[i][1]) / 255.f,
+                                 float(bytes[i][2]) / 255.f), name, "归一化ubyte位置错误");
+    }
+    ok = ok && expect(scene->nodes.size() == 1 && near(scene->nodes[0].rotation[1], 0.7071068f)
+                      && scene->nodes[0].scale[0] == 0.01f, name, "节点的旋转或缩放错误");
+    return ok;
+}
+
+bool checkSparse(const std::string &directory) {
+    const char *name = "sparse.gltf";
+    auto scene = GltfLoader::load(directory + name);
+    if (!expect(scene != nullptr, name, "加载失败")) {
+        return false;
+    }
+    // 三个图元中只有POSITION不是稀疏访问器的那个保留，它的稀疏TEXCOORD_0被忽略
+    bool ok = expect(scene->meshes.size() == 1 && scene->meshes[0].primitives.size() == 1, name,
+                     "引用稀疏POSITION的图元没有被跳过");
+    if (!ok) {
+        return false;
+    }
+    const GltfPrimitive &primitive = scene->meshes[0].primitives[0];
+    VertexStreams streams = primitive.vertexStreams();
+    ok = expect(!primitive.uv.isValid() && streams.uv == nullptr, name, "稀疏TEXCOORD_0没有被忽略");
+    ok = ok && expect(streams.count == 3 && samePosition(streams.fetchPosition(1), 1.f, 0.f, 0.f), name,
+                      "顶点数据错误");
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// 基准测试
+
+void appendPadded(std::string &out, const void *data, size_t size, char fill) {
+    out.append(static_cast<const char *>(data), size);
+    out.append((4 - size % 4) % 4, fill);
+}
+
+std::string base64(const std::string &data) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t bits = uint32_t(uint8_t(data[i])) << 16;
+        bits |= i + 1 < data.size() ? uint32_t(uint8_t(data[i + 1])) << 8 : 0;
+        bits |= i + 2 < data.size() ? uint32_t(uint8_t(data[i + 2])) : 0;
+        out.push_back(kAlphabet[bits >> 18 & 63]);
+        out.push_back(kAlphabet[bits >> 12 & 63]);
+        out.push_back(i + 1 < data.size() ? kAlphabet[bits >> 6 & 63] : '=');
+        out.push_back(i + 2 < data.size() ? kAlphabet[bits & 63] : '=');
+    }
+    return out;
+}
+
+bool writeFile(const std::string &path, const std::string &data) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && ok;
+}
+
+// 边长为size的网格：交错的float位置和uv，uint索引。uri为空时是GLB的BIN块
+std::string gridJson(uint32_t size, size_t vertexBytes, size_t indexBytes, const std::string &uri) {
+    size_t vertexCount = size_t(size + 1) * (size + 1);
+    size_t indexCount = size_t(size) * size * 6;
+    std::string buffer = "{\"byteLength\":" + std::to_string(vertexBytes + indexBytes)
+                         + (uri.empty() ? "" : ",\"uri\":\"" + uri + "\"") + "}";
+    return "{\"asset\":{\"version\":\"2.0\"},"
+           "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1},\"indices\":2}]}],"
+           "\"buffers\":[" + buffer + "],"
+           "\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(vertexBytes) + ",\"byteStride\":20},"
+           "{\"buffer\":0,\"byteOffset\":" + std::to_string(vertexBytes) + ",\"byteLength\":"
+           + std::to_string(indexBytes) + "}],"
+           "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(vertexCount)
+           + ",\"type\":\"VEC3\"},"
+           "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":" + std::to_string(vertexCount)
+           + ",\"type\":\"VEC2\"},"
+           "{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(indexCount)
+           + ",\"type\":\"SCALAR\"}]}";
+}
+
+bool writeLargeMeshes(const std::string &directory, uint32_t size) {
+    std::string binary;
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            const float vertex[5] = {float(x), float(y), std::sin(float(x) * 0.1f) * std::cos(float(y) * 0.1f),
+                                     float(x) / float(size), float(y) / float(size)};
+            binary.append(reinterpret_cast<const char *>(vertex), sizeof(vertex));
+        }
+    }
+    size_t vertexBytes = binary.size();
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t i = y * (size + 1) + x;
+            const uint32_t quad[6] = {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2};
+            binary.append(reinterpret_cast<const char *>(quad), sizeof(quad));
+        }
+    }
+    size_t indexBytes = binary.size() - vertexBytes;
+
+    std::string json = gridJson(size, vertexBytes, indexBytes, "");
+    std::string glb;
+    std::string chunks;
+    uint32_t header[2] = {uint32_t((json.size() + 3) & ~size_t(3)), 0x4E4F534Au};
+    chunks.append(reinterpret_cast<const char *>(header), sizeof(header));
+    appendPadded(chunks, json.data(), json.size(), ' ');
+    header[0] = uint32_t((binary.size() + 3) & ~size_t(3));
+    header[1] = 0x004E4942u;
+    chunks.append(reinterpret_cast<const char *>(header), sizeof(header));
+    appendPadded(chunks, binary.data(), binary.size(), '\0');
+    const uint32_t glbHeader[3] = {0x46546C67u, 2u, uint32_t(12 + chunks.size())};
+    glb.append(reinterpret_cast<const char *>(glbHeader), sizeof(glbHeader));
+    glb += chunks;
+
+    return writeFile(directory + "large.glb", glb)
+           && writeFile(directory + "large.bin", binary)
+           && writeFile(directory + "large.gltf", gridJson(size, vertexBytes, indexBytes, "large.bin"))
+           && writeFile(directory + "large-embedded.gltf",
+                        gridJson(size, vertexBytes, indexBytes,
+                                 "data:application/octet-stream;base64," + base64(binary)));
+}
+
+long maxRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// 在子进程中运行：加载、量化、读出索引，输出一行结果
+int measure(const std::string &path) {
+    long startKb = maxRssKb();
+    double bestLoad = 1e30, bestQuantize = 1e30, bestIndices = 1e30;
+    size_t vertices = 0, indices = 0;
+    for (int round = 0; round < 5; round++) {
+        double start = nowSeconds();
+        auto scene = GltfLoader::load(path);
+        double loaded = nowSeconds();
+        if (!scene || scene->meshes.size() != 1 || scene->meshes[0].primitives.size() != 1) {
+            printf("  %s 加载失败\n", path.c_str());
+            return 1;
+        }
+        const GltfPrimitive &primitive = scene->meshes[0].primitives[0];
+        QuantizedVertices quantized = VertexFormat::quantize(primitive.vertexStreams(), VertexLayout::compact());
+        double quantizedTime = nowSeconds();
+        IndexStream stream = primitive.indexStream();
+        std::vector<Index> indexData(stream.count);
+        for (size_t i = 0; i < stream.count; i++) {
+            indexData[i] = stream.fetch(i);
+        }
+        double end = nowSeconds();
+        bestLoad = std::min(bestLoad, loaded - start);
+        bestQuantize = std::min(bestQuantize, quantizedTime - loaded);
+        bestIndices = std::min(bestIndices, end - quantizedTime);
+        vertices = quantized.data.size() / VertexLayout::compact().stride;
+        indices = indexData.size();
+    }
+    const char *fileName = strrchr(path.c_str(), '/');
+    printf("  %-20s %zu个顶点、%zu个索引：解析 %7.2f ms，量化 %6.2f ms，读索引 %6.2f ms；"
+           "峰值常驻内存 %6.1f MB（加载前 %.1f MB）\n", fileName ? fileName + 1 : path.c_str(), vertices, indices,
+           bestLoad * 1e3, bestQuantize * 1e3, bestIndices * 1e3, double(maxRssKb()) / 1024.0,
+           double(startKb) / 1024.0);
+    return 0;
+}
+
+// 每种格式在新的进程中测量，峰值内存互不影响
+bool runMeasure(const char *self, const std::string &path) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(self, self, "--measure", path.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Logger::instance().setLevel(LogLevel::Error);
+    if (argc == 3 && strcmp(argv[1], "--measure") == 0) {
+        return measure(argv[2]);
+    }
+    std::string directory = argc > 1 ? argv[1] : GLTF_SAMPLE_DIR;
+    if (directory.back() != '/') {
+        directory += '/';
+    }
+    uint32_t size = argc > 2 ? uint32_t(std::max(1, atoi(argv[2]))) : 1000;
+
+    bool ok = true;
+    bool embedded = checkEmbedded(directory);
+    printf("base64内嵌缓冲：%s\n", embedded ? "正确" : "错误");
+    bool external = checkExternal(directory);
+    printf("外部缓冲、交错访问器：%s\n", external ? "正确" : "错误");
+    bool quantized = checkQuantized(directory);
+    printf("GLB、量化和归一化访问器：%s\n", quantized ? "正确" : "错误");
+    bool sparse = checkSparse(directory);
+    printf("稀疏访问器被拒绝：%s\n", sparse ? "正确" : "错误");
+    ok = embedded && external && quantized && sparse;
+
+    char temporary[] = "/tmp/gltfloaderbench-XXXXXX";
+    if (!mkdtemp(temporary)) {
+        printf("无法创建临时目录\n");
+        return 1;
+    }
+    std::string benchDirectory = std::string(temporary) + "/";
+    if (writeLargeMeshes(benchDirectory, size)) {
+        printf("%ux%u网格，5次中最快的一次：\n", size, size);
+        const char *self = "/proc/self/exe";
+        for (const char *file: {"large.glb", "large.gltf", "large-embedded.gltf"}) {
+            ok = runMeasure(self, benchDirectory + file) && ok;
+        }
+    } else {
+        printf("无法写入 %s\n", temporary);
+        ok = false;
+    }
+    for (const char *file: {"large.glb", "large.bin", "large.gltf", "large-embedded.gltf"}) {
+        unlink((benchDirectory + file).c_str());
+    }
+    rmdir(temporary);
+
+    printf(ok ? "glTF加载检查通过\n" : "glTF加载检查失败\n");
+    return ok ? 0 : 1;
+}
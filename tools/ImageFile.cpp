@@ -0,0 +1,135 @@
+#include "ImageFile.h"
+#include "PngDecoder.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// 读取头部的下一个记号，跳过空白和注释
+bool readToken(FILE *file, std::string &token) {
+    token.clear();
+    int c = fgetc(file);
+    while (c != EOF) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') {
+                c = fgetc(file);
+            }
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            c = fgetc(file);
+        } else {
+            break;
+        }
+    }
+    while (c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+        token.push_back(char(c));
+        c = fgetc(file);
+    }
+    return !token.empty();
+}
+
+// 整个文件读入内存后用与设备相同的 PngDecoder 解码
+bool readPng(FILE *file, const char *path, int32_t &width, int32_t &height, std::vector<uint8_t> &rgba) {
+    std::vector<uint8_t> data;
+    uint8_t buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+    PngInfo info;
+    if (!PngDecoder::readInfo(data.data(), data.size(), info)) {
+        fprintf(stderr, "%s 不是有效的PNG图像\n", path);
+        return false;
+    }
+    width = info.width;
+    height = info.height;
+    rgba.resize(size_t(width) * size_t(height) * 4);
+    StagingBufferPool pool;
+    if (!PngDecoder::decode(data.data(), data.size(), rgba.data(), size_t(width) * 4, pool)) {
+        fprintf(stderr, "%s 的PNG数据损坏\n", path);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool ImageFile::read(const char *path, int32_t &width, int32_t &height, std::vector<uint8_t> &rgba) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "无法打开 %s\n", path);
+        return false;
+    }
+    uint8_t signature[8] = {};
+    bool png = fread(signature, 1, sizeof(signature), file) == sizeof(signature)
+               && PngDecoder::isPng(signature, sizeof(signature));
+    rewind(file);
+    if (png) {
+        bool ok = readPng(file, path, width, height, rgba);
+        fclose(file);
+        return ok;
+    }
+    std::string token;
+    int depth = 0;
+    int maxValue = 0;
+    width = height = 0;
+    readToken(file, token);
+    if (token == "P6") {
+        std::string w, h, m;
+        if (readToken(file, w) && readToken(file, h) && readToken(file, m)) {
+            width = atoi(w.c_str());
+            height = atoi(h.c_str());
+            maxValue = atoi(m.c_str());
+            depth = 3;
+        }
+    } else if (token == "P7") {
+        while (readToken(file, token) && token != "ENDHDR") {
+            std::string value;
+            readToken(file, value);
+            if (token == "WIDTH") {
+                width = atoi(value.c_str());
+            } else if (token == "HEIGHT") {
+                height = atoi(value.c_str());
+            } else if (token == "DEPTH") {
+                depth = atoi(value.c_str());
+            } else if (token == "MAXVAL") {
+                maxValue = atoi(value.c_str());
+            }
+        }
+    }
+    if (width <= 0 || height <= 0 || maxValue != 255 || (depth != 1 && depth != 3 && depth != 4)) {
+        fprintf(stderr, "%s 不是8位的PAM/PPM图像\n", path);
+        fclose(file);
+        return false;
+    }
+
+    size_t count = size_t(width) * size_t(height);
+    std::vector<uint8_t> raw(count * depth);
+    bool ok = fread(raw.data(), 1, raw.size(), file) == raw.size();
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "%s 的像素数据不完整\n", path);
+        return false;
+    }
+    rgba.resize(count * 4);
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *p = raw.data() + i * depth;
+        rgba[i * 4 + 0] = p[0];
+        rgba[i * 4 + 1] = depth >= 3 ? p[1] : p[0];
+        rgba[i * 4 + 2] = depth >= 3 ? p[2] : p[0];
+        rgba[i * 4 + 3] = depth == 4 ? p[3] : 255;
+    }
+    return true;
+}
+
+bool ImageFile::writePam(const std::string &path, int32_t width, int32_t height, const uint8_t *rgba) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "无法写入 %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+    size_t size = size_t(width) * size_t(height) * 4;
+    bool ok = fwrite(rgba, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
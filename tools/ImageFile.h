@@ -0,0 +1,24 @@
+#ifndef ANDROIDGLINVESTIGATIONS_IMAGEFILE_H
+#define ANDROIDGLINVESTIGATIONS_IMAGEFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * 主机工具读写的图像文件：8位的PAM（P7，RGB_ALPHA/RGB/GRAYSCALE）和PPM（P6），
+ * 以及任意格式的PNG（用设备上同一个 PngDecoder 读取，不预乘）
+ */
+class ImageFile {
+public:
+    /*!
+     * 读取图像并转换成逐行紧密排列的RGBA8，没有alpha的图像alpha为255
+     * @return 失败时返回false并在stderr输出原因
+     */
+    static bool read(const char *path, int32_t &width, int32_t &height, std::vector<uint8_t> &rgba);
+
+    //! 写出RGB_ALPHA的PAM文件
+    static bool writePam(const std::string &path, int32_t width, int32_t height, const uint8_t *rgba);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_IMAGEFILE_H
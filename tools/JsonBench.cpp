@@ -0,0 +1,370 @@
+/*
+ * jsonbench：比较流式的 JsonReader 与DOM解析器（jsoncpp，GltfLoader 原来使用的库）读取大型glTF清单的耗时和内存分配。
+ *
+ * 生成一个有大量节点、网格、访问器和材质的glTF（外部 .bin 缓冲），分两层比较：
+ * 只解析——JsonReader::skipValue 校验整个文档，对比 jsoncpp 构建 Json::Value 树；
+ * 读取glTF——GltfLoader::load 一遍读入类型化的描述并解析所有引用，对比 jsoncpp 构建树后按原来的方式
+ * 逐个成员取值填进同样的结构。内存分配通过替换全局 operator new 统计次数和字节数。
+ * 检查项：两种方式读出的节点名字、平移、子节点、网格和图元数量、材质名字（含转义字符）相同。
+ * 用法：jsonbench [节点数]
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include "GltfLoader.h"
+#include "JsonReader.h"
+#include "Log.h"
+
+namespace {
+
+size_t gAllocations = 0;
+size_t gAllocatedBytes = 0;
+
+} // namespace
+
+// 统计整个进程的堆分配
+void *operator new(size_t size) {
+    gAllocations++;
+    gAllocatedBytes += size;
+    if (void *p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string readFile(const std::string &path) {
+    std::string data;
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return data;
+    }
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, read);
+    }
+    fclose(file);
+    return data;
+}
+
+bool writeFile(const std::string &path, const std::string &data) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && ok;
+}
+
+// 每个网格2个图元，每个图元2个访问器（POSITION和索引）
+std::string makeDocument(uint32_t nodeCount, size_t &binarySize) {
+    const uint32_t meshCount = nodeCount / 4;
+    const uint32_t accessorCount = meshCount * 4;
+    const uint32_t materialCount = 256;
+    std::string json;
+    json.reserve(size_t(nodeCount) * 400);
+    json += "{\"asset\":{\"version\":\"2.0\",\"generator\":\"jsonbench\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],";
+
+    json += "\n\"nodes\":[";
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        json += i ? ",\n" : "\n";
+        json += "{\"name\":\"node_" + std::to_string(i) + "\",\"translation\":[" + std::to_string(i % 97) + ".5,"
+                + std::to_string(i % 13) + ".25,-" + std::to_string(i % 7) + ".125],"
+                "\"rotation\":[0,0.7071068,0,0.7071068],\"scale\":[1,1,1]";
+        // 每个节点最多4个子节点，组成一棵树
+        std::string children;
+        for (uint32_t c = i * 4 + 1; c <= i * 4 + 4 && c < nodeCount; c++) {
+            children += (children.empty() ? "" : ",") + std::to_string(c);
+        }
+        if (!children.empty()) {
+            json += ",\"children\":[" + children + "]";
+        }
+        if (i % 4 == 0) {
+            json += ",\"mesh\":" + std::to_string(i / 4 % meshCount);
+        }
+        json += ",\"extras\":{\"tag\":\"skipped\",\"weights\":[0.1,0.2,0.3]}}";
+    }
+    json += "],\n\"meshes\":[";
+    for (uint32_t m = 0; m < meshCount; m++) {
+        json += m ? ",\n" : "\n";
+        json += "{\"name\":\"mesh_" + std::to_string(m) + "\",\"primitives\":[";
+        for (uint32_t p = 0; p < 2; p++) {
+            uint32_t accessor = m * 4 + p * 2;
+            json += std::string(p ? "," : "") + "{\"attributes\":{\"POSITION\":" + std::to_string(accessor)
+                    + "},\"indices\":" + std::to_string(accessor + 1) + ",\"material\":"
+                    + std::to_string((m + p) % materialCount) + ",\"mode\":4}";
+        }
+        json += "]}";
+    }
+    json += "],\n\"materials\":[";
+    for (uint32_t i = 0; i < materialCount; i++) {
+        json += i ? ",\n" : "\n";
+        json += "{\"name\":\"material \\\"" + std::to_string(i) + "\\\" \\u00e9\\t\","
+                "\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.8,0.6,0.4,1],\"metallicFactor\":0}}";
+    }
+    // 每个POSITION访问器3个顶点（36字节），索引访问器3个ushort（按4字节对齐为8字节）
+    json += "],\n\"accessors\":[";
+    for (uint32_t a = 0; a < accessorCount; a++) {
+        json += a ? ",\n" : "\n";
+        if (a % 2 == 0) {
+            json += "{\"bufferView\":0,\"byteOffset\":" + std::to_string(size_t(a / 2) * 36)
+                    + ",\"componentType\":5126,\"count\":3,\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[1,1,0]}";
+        } else {
+            json += "{\"bufferView\":1,\"byteOffset\":" + std::to_string(size_t(a / 2) * 8)
+                    + ",\"componentType\":5123,\"count\":3,\"type\":\"SCALAR\"}";
+        }
+    }
+    size_t vertexBytes = size_t(accessorCount / 2) * 36;
+    size_t indexBytes = size_t(accessorCount / 2) * 8;
+    binarySize = vertexBytes + indexBytes;
+    json += "],\n\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(vertexBytes)
+            + ",\"byteStride\":12},{\"buffer\":0,\"byteOffset\":" + std::to_string(vertexBytes)
+            + ",\"byteLength\":" + std::to_string(indexBytes) + "}],\n"
+            "\"buffers\":[{\"byteLength\":" + std::to_string(binarySize) + ",\"uri\":\"bench.bin\"}]}\n";
+    return json;
+}
+
+// jsoncpp 读出的内容，与 GltfScene 中对应的部分比较
+struct DomNode {
+    std::string name;
+    float translation[3] = {0.f, 0.f, 0.f};
+    float rotation[4] = {0.f, 0.f, 0.f, 1.f};
+    float scale[3] = {1.f, 1.f, 1.f};
+    int mesh = -1;
+    std::vector<uint32_t> children;
+};
+
+struct DomAccessor {
+    int bufferView = -1;
+    size_t byteOffset = 0;
+    int componentType = 0;
+    size_t count = 0;
+    std::string type;
+};
+
+struct DomPrimitive {
+    int position = -1;
+    int indices = -1;
+    int material = -1;
+    int mode = 4;
+};
+
+struct DomScene {
+    std::vector<DomNode> nodes;
+    std::vector<std::vector<DomPrimitive>> meshes;
+    std::vector<std::string> materials;
+    std::vector<DomAccessor> accessors;
+};
+
+bool parseDom(const std::string &text, Json::Value &root) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errors;
+    return reader->parse(text.data(), text.data() + text.size(), &root, &errors);
+}
+
+// 与改用 JsonReader 之前的 GltfLoader 相同：先构建整棵树，再按成员名取值
+bool readDom(const std::string &path, DomScene &scene) {
+    std::string text = readFile(path);
+    Json::Value root;
+    if (!parseDom(text, root) || root["asset"]["version"].asString() != "2.0") {
+        return false;
+    }
+    const Json::Value &nodes = root["nodes"];
+    scene.nodes.resize(nodes.size());
+    for (Json::ArrayIndex i = 0; i < nodes.size(); i++) {
+        const Json::Value &node = nodes[i];
+        DomNode &out = scene.nodes[i];
+        out.name = node["name"].asString();
+        for (Json::ArrayIndex k = 0; k < 3 && k < node["translation"].size(); k++) {
+            out.translation[k] = node["translation"][k].asFloat();
+            out.scale[k] = node["scale"].isArray() ? node["scale"][k].asFloat() : 1.f;
+        }
+        for (Json::ArrayIndex k = 0; k < 4 && k < node["rotation"].size(); k++) {
+            out.rotation[k] = node["rotation"][k].asFloat();
+        }
+        out.mesh = node.isMember("mesh") ? node["mesh"].asInt() : -1;
+        for (const Json::Value &child: node["children"]) {
+            out.children.push_back(child.asUInt());
+        }
+    }
+    const Json::Value &meshes = root["meshes"];
+    scene.meshes.resize(meshes.size());
+    for (Json::ArrayIndex m = 0; m < meshes.size(); m++) {
+        for (const Json::Value &primitive: meshes[m]["primitives"]) {
+            DomPrimitive out;
+            out.position = primitive["attributes"].get("POSITION", -1).asInt();
+            out.indices = primitive.get("indices", -1).asInt();
+            out.material = primitive.get("material", -1).asInt();
+            out.mode = primitive.get("mode", 4).asInt();
+            scene.meshes[m].push_back(out);
+        }
+    }
+    for (const Json::Value &material: root["materials"]) {
+        scene.materials.push_back(material["name"].asString());
+    }
+    for (const Json::Value &accessor: root["accessors"]) {
+        DomAccessor out;
+        out.bufferView = accessor.get("bufferView", -1).asInt();
+        out.byteOffset = accessor.get("byteOffset", 0).asUInt64();
+        out.componentType = accessor["componentType"].asInt();
+        out.count = accessor["count"].asUInt64();
+        out.type = accessor["type"].asString();
+        scene.accessors.push_back(out);
+    }
+    return true;
+}
+
+bool sameScene(const GltfScene &streamed, const DomScene &dom) {
+    if (streamed.nodes.size() != dom.nodes.size() || streamed.meshes.size() != dom.meshes.size()
+        || streamed.materials.size() != dom.materials.size()) {
+        printf("  节点、网格或材质的数量不同\n");
+        return false;
+    }
+    for (size_t i = 0; i < dom.nodes.size(); i++) {
+        const GltfNode &node = streamed.nodes[i];
+        const DomNode &expected = dom.nodes[i];
+        bool same = node.name == expected.name && node.mesh == expected.mesh
+                    && node.childCount == expected.children.size()
+                    && std::equal(node.translation, node.translation + 3, expected.translation)
+                    && std::equal(node.rotation, node.rotation + 4, expected.rotation)
+                    && std::equal(node.scale, node.scale + 3, expected.scale);
+        for (uint32_t c = 0; c < node.childCount && same; c++) {
+            same = streamed.nodeChildren[node.firstChild + c] == expected.children[c];
+        }
+        if (!same) {
+            printf("  节点%zu不同\n", i);
+            return false;
+        }
+    }
+    for (size_t m = 0; m < dom.meshes.size(); m++) {
+        const std::vector<GltfPrimitive> &primitives = streamed.meshes[m].primitives;
+        if (primitives.size() != dom.meshes[m].size()) {
+            printf("  网格%zu的图元数量不同\n", m);
+            return false;
+        }
+        for (size_t p = 0; p < primitives.size(); p++) {
+            const DomPrimitive &expected = dom.meshes[m][p];
+            const DomAccessor &position = dom.accessors[size_t(expected.position)];
+            if (primitives[p].material != expected.material || primitives[p].mode != GLenum(expected.mode)
+                || primitives[p].position.count != position.count
+                || primitives[p].indices.count != dom.accessors[size_t(expected.indices)].count) {
+                printf("  网格%zu图元%zu不同\n", m, p);
+                return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < dom.materials.size(); i++) {
+        if (streamed.materials[i].name != dom.materials[i]) {
+            printf("  材质%zu的名字不同\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Measurement {
+    double bestMs = 1e30;
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+template<typename Function>
+Measurement measure(int rounds, Function &&function) {
+    Measurement result;
+    for (int round = 0; round < rounds; round++) {
+        size_t allocations = gAllocations;
+        size_t bytes = gAllocatedBytes;
+        double start = nowSeconds();
+        function();
+        result.bestMs = std::min(result.bestMs, (nowSeconds() - start) * 1e3);
+        result.allocations = gAllocations - allocations;
+        result.bytes = gAllocatedBytes - bytes;
+    }
+    return result;
+}
+
+void printMeasurement(const char *name, const Measurement &measurement, size_t documentBytes) {
+    printf("  %-26s %8.2f ms，%7.1f MB/s，分配 %8zu 次、%8.2f MB\n", name, measurement.bestMs,
+           double(documentBytes) / (1024.0 * 1024.0) / (measurement.bestMs * 1e-3), measurement.allocations,
+           double(measurement.bytes) / (1024.0 * 1024.0));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Logger::instance().setLevel(LogLevel::Error);
+    uint32_t nodeCount = argc > 1 ? uint32_t(std::max(8, atoi(argv[1]))) : 50000;
+    const int rounds = 3;
+
+    char temporary[] = "/tmp/jsonbench-XXXXXX";
+    if (!mkdtemp(temporary)) {
+        printf("无法创建临时目录\n");
+        return 1;
+    }
+    std::string directory = std::string(temporary) + "/";
+    size_t binarySize = 0;
+    std::string document = makeDocument(nodeCount, binarySize);
+    std::string gltfPath = directory + "bench.gltf";
+    bool ok = writeFile(gltfPath, document) && writeFile(directory + "bench.bin", std::string(binarySize, '\0'));
+
+    std::unique_ptr<GltfScene> streamed = ok ? GltfLoader::load(gltfPath) : nullptr;
+    DomScene dom;
+    ok = streamed && readDom(gltfPath, dom) && sameScene(*streamed, dom);
+    printf("%u个节点、%zu个网格、%zu个访问器，JSON %.1f MB：两种方式读出的内容相同：%s\n", nodeCount, dom.meshes.size(),
+           dom.accessors.size(), double(document.size()) / (1024.0 * 1024.0), ok ? "正确" : "错误");
+    streamed.reset();
+
+    printf("只解析（%d次中最快的一次）：\n", rounds);
+    printMeasurement("JsonReader::skipValue", measure(rounds, [&]() {
+        StringArena arena;
+        JsonReader reader(document.data(), document.size(), arena);
+        ok = reader.skipValue() && reader.finish() && ok;
+    }), document.size());
+    printMeasurement("jsoncpp 构建树", measure(rounds, [&]() {
+        Json::Value root;
+        ok = parseDom(document, root) && ok;
+    }), document.size());
+
+    printf("读取glTF（含读文件/映射）：\n");
+    printMeasurement("GltfLoader::load", measure(rounds, [&]() {
+        ok = GltfLoader::load(gltfPath) != nullptr && ok;
+    }), document.size());
+    printMeasurement("jsoncpp 构建树后逐个取值", measure(rounds, [&]() {
+        DomScene scene;
+        ok = readDom(gltfPath, scene) && ok;
+    }), document.size());
+
+    unlink(gltfPath.c_str());
+    unlink((directory + "bench.bin").c_str());
+    rmdir(temporary);
+
+    printf(ok ? "JSON读取检查通过\n" : "JSON读取检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+/*
+ * jsonfuzz：对 JsonReader 和 GltfLoader 做截断和随机变异测试，输入无效时必须干净地失败，不能崩溃或越界读写。
+ *
+ * 种子是 tools/samples 中的样例（.gltf 和 .glb），以及一段带转义字符、Unicode代理对和各种数字写法的JSON。
+ * JsonReader 的输入放在大小正好的堆内存中，越界读取能被AddressSanitizer发现；GltfLoader 的输入写成
+ * 临时文件后加载（外部 .bin 一起复制过去）。
+ * 检查项：有效JSON的每个真前缀都被 JsonReader 拒绝，GltfLoader 对每个截断的样例都返回nullptr；
+ * 逐值读取和 skipValue 对同一输入的接受/拒绝结果相同；变异后 GltfLoader 加载成功时，所有访问器、
+ * 内嵌图像都落在场景持有的内存中，所有下标都在范围内。
+ * 在AddressSanitizer下运行：
+ *   cmake -S tools -B build-asan -DCMAKE_BUILD_TYPE=Debug -DCMAKE_CXX_FLAGS="-fsanitize=address,undefined"
+ *   cmake --build build-asan --target jsonfuzz && build-asan/jsonfuzz
+ * 用法：jsonfuzz [每个种子的变异次数] [样例目录]
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GltfLoader.h"
+#include "JsonReader.h"
+#include "Log.h"
+
+#ifndef GLTF_SAMPLE_DIR
+#define GLTF_SAMPLE_DIR "samples"
+#endif
+
+namespace {
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+};
+
+// 转义、代理对、各种数字写法和深一点的嵌套
+const char kInlineSeed[] = R"({
+  "asset": {"version": "2.0", "generator": "tab\there \"quoted\" \\ \/ é中😀"},
+  "numbers": [0, -0, 1, -1.5, 3.25e2, 1E-7, 12345678901234567890123, 1.7976931348623157e308, -1e-400, 0.1, 9007199254740993],
+  "literals": [true, false, null, [], {}, [[[[[[{"a": [1, {"b": null}]}]]]]]]],
+  "nodes": [{"name": "n\u0000ul", "translation": [1, 2, 3], "children": [1]}, {"name": "leaf"}],
+  "scenes": [{"nodes": [0]}], "scene": 0
+})";
+
+std::string readFile(const std::string &path) {
+    std::string data;
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return data;
+    }
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, read);
+    }
+    fclose(file);
+    return data;
+}
+
+bool writeFile(const std::string &path, const std::string &data) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && ok;
+}
+
+// 按类型逐个读取所有值，用到 JsonReader 的全部读取接口
+bool walkValue(JsonReader &reader) {
+    switch (reader.peek()) {
+        case JsonType::Object: {
+            if (!reader.beginObject()) {
+                return false;
+            }
+            std::string_view key;
+            while (reader.nextKey(key)) {
+                if (!walkValue(reader)) {
+                    return false;
+                }
+            }
+            return reader.ok();
+        }
+        case JsonType::Array:
+            if (!reader.beginArray()) {
+                return false;
+            }
+            while (reader.nextElement()) {
+                if (!walkValue(reader)) {
+                    return false;
+                }
+            }
+            return reader.ok();
+        case JsonType::String: {
+            std::string_view text;
+            return reader.readString(text);
+        }
+        case JsonType::Number: {
+            double value;
+            return reader.readNumber(value);
+        }
+        case JsonType::Bool: {
+            bool value;
+            return reader.readBool(value);
+        }
+        case JsonType::Null:
+            return reader.skipValue();
+        case JsonType::Invalid:
+            break;
+    }
+    return reader.fail("无效的值");
+}
+
+//! 两种读取方式的结果，不一致时返回-1
+int parseJson(const std::string &text) {
+    // 大小正好的堆内存，越界读取一个字节也能被发现
+    std::unique_ptr<char[]> exact(new char[std::max<size_t>(text.size(), 1)]);
+    memcpy(exact.get(), text.data(), text.size());
+
+    StringArena arena;
+    JsonReader walker(exact.get(), text.size(), arena);
+    bool walked = walkValue(walker) && walker.finish();
+    JsonReader skipper(exact.get(), text.size(), arena);
+    bool skipped = skipper.skipValue() && skipper.finish();
+    if (walked != skipped || walked != walker.ok() || skipped != skipper.ok()) {
+        return -1;
+    }
+    return walked ? 1 : 0;
+}
+
+bool inside(const uint8_t *begin, const uint8_t *end, const uint8_t *data, size_t size) {
+    return data >= begin && data <= end && size <= size_t(end - data);
+}
+
+// 访问器和内嵌图像必须落在场景持有的某一块内存中
+bool ownedBySceneData(const GltfScene &scene, const uint8_t *data, size_t size) {
+    for (const MappedFile &file: scene.files) {
+        if (inside(file.data(), file.data() + file.size(), data, size)) {
+            return true;
+        }
+    }
+    for (const std::vector<uint8_t> &buffer: scene.decodedBuffers) {
+        if (inside(buffer.data(), buffer.data() + buffer.size(), data, size)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool accessorOwned(const GltfScene &scene, const GltfAccessor &accessor) {
+    if (!accessor.isValid()) {
+        return true;
+    }
+    size_t componentSize = accessor.componentType == GL_FLOAT || accessor.componentType == GL_UNSIGNED_INT ? 4
+                           : accessor.componentType == GL_SHORT || accessor.componentType == GL_UNSIGNED_SHORT ? 2 : 1;
+    size_t size = accessor.stride * (accessor.count - 1) + componentSize * accessor.components;
+    return accessor.count > 0 && ownedBySceneData(scene, accessor.data, size);
+}
+
+bool sceneConsistent(const GltfScene &scene) {
+    for (const GltfMesh &mesh: scene.meshes) {
+        for (const GltfPrimitive &primitive: mesh.primitives) {
+            if (!accessorOwned(scene, primitive.position) || !accessorOwned(scene, primitive.uv)
+                || !accessorOwned(scene, primitive.normal) || !accessorOwned(scene, primitive.indices)
+                || primitive.material >= int32_t(scene.materials.size())) {
+                return false;
+            }
+            IndexStream indices = primitive.indexStream();
+            for (size_t i = 0; i < indices.count; i++) {
+                if (indices.fetch(i) >= primitive.position.count) {
+                    return false;
+                }
+            }
+        }
+    }
+    for (const GltfImage &image: scene.images) {
+        if (image.data && !ownedBySceneData(scene, image.data, image.size)) {
+            return false;
+        }
+    }
+    for (const GltfMaterial &material: scene.materials) {
+        if (material.baseColorImage >= int32_t(scene.images.size())) {
+            return false;
+        }
+    }
+    for (const GltfNode &node: scene.nodes) {
+        if (node.mesh >= int32_t(scene.meshes.size())
+            || size_t(node.firstChild) + node.childCount > scene.nodeChildren.size()) {
+            return false;
+        }
+    }
+    for (uint32_t node: scene.nodeChildren) {
+        if (node >= scene.nodes.size()) {
+            return false;
+        }
+    }
+    for (uint32_t node: scene.rootNodes) {
+        if (node >= scene.nodes.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Seed {
+    std::string name;
+    std::string data;
+    bool isGlb;
+    size_t jsonBegin = 0; // JSON文本在data中的范围，GLB为JSON块
+    size_t jsonEnd = 0;
+};
+
+std::string mutate(const std::string &input, Random &random) {
+    static const char kInteresting[] = "{}[]\",:0123456789eE.-+\\tfnu \x00\xff";
+    std::string data = input;
+    int operations = 1 + int(random.next() % 4);
+    for (int op = 0; op < operations && !data.empty(); op++) {
+        size_t at = random.next() % data.size();
+        size_t length = 1 + random.next() % std::min<size_t>(32, data.size() - at);
+        switch (random.next() % 7) {
+            case 0:
+                data[at] = char(data[at] ^ (1 << (random.next() % 8)));
+                break;
+            case 1:
+                data[at] = kInteresting[random.next() % (sizeof(kInteresting) - 1)];
+                break;
+            case 2:
+                data.erase(at, length);
+                break;
+            case 3:
+                data.insert(at, data.substr(random.next() % data.size(), length));
+                break;
+            case 4:
+                data.insert(at, 1, kInteresting[random.next() % (sizeof(kInteresting) - 1)]);
+                break;
+            case 5:
+                // 很深的嵌套
+                data.insert(at, std::string(1 + random.next() % 300, random.next() & 1 ? '[' : '{'));
+                break;
+            default:
+                data.resize(at);
+                break;
+        }
+    }
+    return data;
+}
+
+// GLB的JSON块变异后重新写好块长度，使变异能到达JSON解析
+std::string rebuildGlb(const Seed &seed, const std::string &json) {
+    std::string glb = seed.data.substr(0, 12);
+    std::string padded = json;
+    padded.append((4 - padded.size() % 4) % 4, ' ');
+    const uint32_t header[2] = {uint32_t(padded.size()), 0x4E4F534Au};
+    glb.append(reinterpret_cast<const char *>(header), sizeof(header));
+    glb += padded;
+    glb += seed.data.substr(seed.jsonEnd);
+    auto length = uint32_t(glb.size());
+    memcpy(&glb[8], &length, sizeof(length));
+    return glb;
+}
+
+class LoaderHarness {
+public:
+    explicit LoaderHarness(const std::string &directory) : directory_(directory) {}
+
+    // 返回-1表示加载成功但场景不一致，0表示失败，1表示成功
+    int load(const std::string &data, bool isGlb) {
+        std::string path = directory_ + (isGlb ? "input.glb" : "input.gltf");
+        if (!writeFile(path, data)) {
+            return -1;
+        }
+        auto scene = GltfLoader::load(path);
+        if (!scene) {
+            return 0;
+        }
+        return sceneConsistent(*scene) ? 1 : -1;
+    }
+
+private:
+    std::string directory_;
+};
+
+bool checkTruncation(const Seed &seed, LoaderHarness &loader) {
+    std::string json = seed.data.substr(seed.jsonBegin, seed.jsonEnd - seed.jsonBegin);
+    while (!json.empty() && (json.back() == ' ' || json.back() == '\n')) {
+        json.pop_back();
+    }
+    if (parseJson(json) != 1) {
+        printf("  %s：完整的JSON没有被接受\n", seed.name.c_str());
+        return false;
+    }
+    for (size_t length = 0; length < json.size(); length++) {
+        if (parseJson(json.substr(0, length)) != 0) {
+            printf("  %s：截断到%zu字节的JSON没有被拒绝\n", seed.name.c_str(), length);
+            return false;
+        }
+    }
+    if (seed.name == "inline") {
+        return true;
+    }
+    // 截断整个文件（GLB截断后块长度对不上），以及只截断JSON但保持GLB结构有效
+    size_t fileSize = seed.data.size();
+    while (!seed.isGlb && fileSize > 0 && (seed.data[fileSize - 1] == ' ' || seed.data[fileSize - 1] == '\n')) {
+        fileSize--;
+    }
+    for (size_t length = 0; length < fileSize; length++) {
+        if (loader.load(seed.data.substr(0, length), seed.isGlb) != 0) {
+            printf("  %s：截断到%zu字节的文件没有被拒绝\n", seed.name.c_str(), length);
+            return false;
+        }
+    }
+    for (size_t length = 0; length < json.size() && seed.isGlb; length++) {
+        if (loader.load(rebuildGlb(seed, json.substr(0, length)), true) != 0) {
+            printf("  %s：JSON块截断到%zu字节时没有被拒绝\n", seed.name.c_str(), length);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkMutations(const Seed &seed, LoaderHarness &loader, int iterations, Random &random, size_t &accepted) {
+    std::string json = seed.data.substr(seed.jsonBegin, seed.jsonEnd - seed.jsonBegin);
+    for (int i = 0; i < iterations; i++) {
+        std::string mutated = mutate(json, random);
+        if (parseJson(mutated) < 0) {
+            printf("  %s：第%d次变异后逐值读取与skipValue的结果不同\n", seed.name.c_str(), i);
+            return false;
+        }
+        if (seed.name == "inline") {
+            continue;
+        }
+        int result = loader.load(seed.isGlb ? rebuildGlb(seed, mutated) : mutated, seed.isGlb);
+        if (result < 0) {
+            printf("  %s：第%d次变异后加载出的场景不一致\n", seed.name.c_str(), i);
+            return false;
+        }
+        accepted += size_t(result);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    // 无效输入会产生大量日志
+    Logger::instance().setLevel(LogLevel::Off);
+    int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 5000;
+    std::string samples = argc > 2 ? argv[2] : GLTF_SAMPLE_DIR;
+    if (samples.back() != '/') {
+        samples += '/';
+    }
+
+    std::vector<Seed> seeds;
+    seeds.push_back(Seed{"inline", kInlineSeed, false, 0, sizeof(kInlineSeed) - 1});
+    for (const char *name: {"embedded.gltf", "external.gltf", "sparse.gltf", "quantized.glb"}) {
+        Seed seed{name, readFile(samples + name), strstr(name, ".glb") != nullptr};
+        seed.jsonEnd = seed.data.size();
+        if (seed.isGlb && seed.data.size() >= 20) {
+            uint32_t jsonLength;
+            memcpy(&jsonLength, &seed.data[12], sizeof(jsonLength));
+            seed.jsonBegin = 20;
+            seed.jsonEnd = std::min(seed.data.size(), 20 + size_t(jsonLength));
+        }
+        if (seed.data.empty()) {
+            printf("无法读取样例 %s%s\n", samples.c_str(), name);
+            return 1;
+        }
+        seeds.push_back(seed);
+    }
+
+    char temporary[] = "/tmp/jsonfuzz-XXXXXX";
+    if (!mkdtemp(temporary)) {
+        printf("无法创建临时目录\n");
+        return 1;
+    }
+    std::string directory = std::string(temporary) + "/";
+    // external.gltf 引用的外部缓冲
+    writeFile(directory + "external.bin", readFile(samples + "external.bin"));
+    LoaderHarness loader(directory);
+
+    bool ok = true;
+    Random random{12345};
+    for (const Seed &seed: seeds) {
+        bool truncated = checkTruncation(seed, loader);
+        size_t accepted = 0;
+        bool mutated = checkMutations(seed, loader, iterations, random, accepted);
+        printf("%s：截断%s，%d次变异%s（加载成功%zu次）\n", seed.name.c_str(), truncated ? "正确" : "错误",
+               iterations, mutated ? "正确" : "错误", accepted);
+        ok = truncated && mutated && ok;
+    }
+
+    for (const char *name: {"input.gltf", "input.glb", "external.bin"}) {
+        unlink((directory + name).c_str());
+    }
+    rmdir(temporary);
+
+    printf(ok ? "JSON模糊测试通过\n" : "JSON模糊测试失败\n");
+    return ok ? 0 : 1;
+}
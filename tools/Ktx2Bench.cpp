@@ -0,0 +1,329 @@
+/*
+ * ktx2bench：检查KTX2容器、zstd超压缩和CPU回退解码器的正确性，并测量编解码吞吐量。
+ *
+ * 检查项：各格式的容器写出再解析后层级数据不变，层级从小到大存放且按块对齐；截断的文件全部被拒绝，
+ * 随机改写字节的文件要么被拒绝要么能安全读出；ETC2和ASTC编码再解码的PSNR不低于阈值；尺寸不是块的
+ * 整数倍时与补齐后编码再裁剪的结果相同；纯色图像经ASTC void extent往返后完全不变；随机的ASTC块
+ * （各种块尺寸）都能解码，不合法的块输出错误颜色。
+ * 用法：ktx2bench [边长]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "AstcDecoder.h"
+#include "Ktx2.h"
+#include "TextureEncoder.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+};
+
+/*
+ * 接近真实纹理的测试图像：平滑渐变、正弦条纹、硬边的色块和少量噪声，alpha是径向渐变加一个镂空
+ */
+std::vector<uint8_t> testImage(int32_t width, int32_t height, bool alpha) {
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    Random random{12345};
+    for (int32_t y = 0; y < height; y++) {
+        for (int32_t x = 0; x < width; x++) {
+            float u = float(x) / width, v = float(y) / height;
+            uint8_t *p = rgba.data() + (size_t(y) * width + x) * 4;
+            int noise = int(random.next() % 9) - 4;
+            bool tile = ((x / 24) + (y / 24)) % 3 == 0;
+            p[0] = uint8_t(std::min(255, std::max(0, int(255 * u) + noise)));
+            p[1] = uint8_t(std::min(255, std::max(0, int(128 + 100 * std::sin(u * 20.f + v * 7.f)) + noise)));
+            p[2] = tile ? 220 : uint8_t(255 * v);
+            float r = std::hypot(u - 0.5f, v - 0.5f);
+            p[3] = !alpha ? 255 : r < 0.1f ? 0 : uint8_t(std::min(255.f, r * 400.f));
+        }
+    }
+    return rgba;
+}
+
+double psnr(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b, int channel) {
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        int c = int(i % 4);
+        if (channel < 0 ? c < 3 : c == channel) {
+            double d = double(a[i]) - b[i];
+            sum += d * d;
+            count++;
+        }
+    }
+    return sum > 0.0 ? 10.0 * std::log10(255.0 * 255.0 * count / sum) : INFINITY;
+}
+
+int failures = 0;
+
+void check(bool condition, const char *what) {
+    if (!condition) {
+        printf("  失败: %s\n", what);
+        failures++;
+    }
+}
+
+std::vector<uint8_t> writeRandomFile(const TextureFormat &format, int32_t width, int32_t height, int zstdLevel,
+                                     std::vector<std::vector<uint8_t>> &levels) {
+    Random random{uint32_t(format.vkFormat)};
+    Ktx2Writer writer(format, width, height);
+    writer.setZstdLevel(zstdLevel);
+    levels.clear();
+    for (int32_t level = 0; (std::max(width, height) >> level) > 0; level++) {
+        std::vector<uint8_t> data(format.levelSize(std::max(1, width >> level), std::max(1, height >> level)));
+        // 一半是重复的字节，zstd能压缩
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = i % 2 ? uint8_t(random.next()) : uint8_t(i / 64);
+        }
+        levels.push_back(data);
+        writer.addLevel(std::move(data));
+    }
+    std::vector<uint8_t> file;
+    writer.serialize(file);
+    return file;
+}
+
+void checkContainer() {
+    printf("容器往返%s\n", Ktx2File::zstdSupported() ? "（含zstd）" : "（没有zstd支持）");
+    const uint32_t formats[] = {43, 147, 152, 157, 158 + 2 * 7};
+    for (uint32_t vkFormat: formats) {
+        const TextureFormat &format = *TextureFormat::find(vkFormat);
+        for (int zstdLevel: {0, 3}) {
+            if (zstdLevel > 0 && !Ktx2File::zstdSupported()) {
+                continue;
+            }
+            std::vector<std::vector<uint8_t>> levels;
+            std::vector<uint8_t> file = writeRandomFile(format, 37, 19, zstdLevel, levels);
+            Ktx2File ktx2;
+            bool parsed = ktx2.parse(file.data(), file.size());
+            check(parsed && ktx2.levelCount() == levels.size() && ktx2.width() == 37 && ktx2.height() == 19,
+                  "解析写出的文件");
+            if (!parsed) {
+                continue;
+            }
+            std::vector<uint8_t> scratch;
+            size_t previousOffset = file.size();
+            for (size_t level = 0; level < levels.size(); level++) {
+                const uint8_t *data = nullptr;
+                bool read = ktx2.levelData(level, scratch, data);
+                check(read && memcmp(data, levels[level].data(), levels[level].size()) == 0, "层级数据不变");
+                Ktx2Level entry;
+                memcpy(&entry, file.data() + sizeof(Ktx2Header) + level * sizeof(Ktx2Level), sizeof(entry));
+                check(entry.byteOffset < previousOffset, "层级从小到大存放");
+                check(zstdLevel > 0 || entry.byteOffset % std::max<size_t>(4, format.blockBytes) == 0,
+                      "层级按块对齐");
+                previousOffset = entry.byteOffset;
+            }
+            printf("  %-22s zstd %d: %zu 字节\n", format.name, zstdLevel, file.size());
+
+            // 截断的文件缺少最大的层级，必须全部被拒绝
+            bool truncatedRejected = true;
+            for (size_t size = 0; size < file.size(); size++) {
+                truncatedRejected = truncatedRejected && !Ktx2File().parse(file.data(), size);
+            }
+            check(truncatedRejected, "拒绝截断的文件");
+
+            // 随机改写：能通过解析的文件，每一层都必须能安全地读出和解码
+            Random random{vkFormat * 31u + uint32_t(zstdLevel)};
+            size_t accepted = 0;
+            std::vector<uint8_t> pixels;
+            for (int round = 0; round < 300; round++) {
+                std::vector<uint8_t> corrupt = file;
+                for (int i = 0; i < 4; i++) {
+                    // 偏向文件头和层级索引
+                    size_t limit = random.next() % 2 ? 160 : corrupt.size();
+                    corrupt[random.next() % std::min(limit, corrupt.size())] = uint8_t(random.next());
+                }
+                Ktx2File damaged;
+                if (!damaged.parse(corrupt.data(), corrupt.size())) {
+                    continue;
+                }
+                accepted++;
+                for (size_t level = 0; level < damaged.levelCount(); level++) {
+                    const uint8_t *data = nullptr;
+                    if (damaged.levelData(level, scratch, data)) {
+                        int32_t w = damaged.levelWidth(level), h = damaged.levelHeight(level);
+                        pixels.resize(size_t(w) * h * 4);
+                        damaged.format().decompress(data, damaged.format().levelSize(w, h), w, h, pixels.data());
+                    }
+                }
+            }
+            printf("    截断 %zu 种全部拒绝，300 个损坏文件中 %zu 个通过解析并安全读出\n", file.size(), accepted);
+        }
+    }
+    uint8_t notKtx2[80] = {};
+    check(!Ktx2File().parse(notKtx2, sizeof(notKtx2)), "拒绝没有KTX2标识的数据");
+}
+
+void checkCodec(const char *label, const TextureFormat &format, const std::vector<uint8_t> &image, int32_t width,
+                int32_t height, double minColorPsnr, double minAlphaPsnr) {
+    double start = nowSeconds();
+    std::vector<uint8_t> encoded = TextureEncoder::encodeImage(format, width, height, image.data());
+    double encodeSeconds = nowSeconds() - start;
+    std::vector<uint8_t> decoded(image.size());
+    start = nowSeconds();
+    int rounds = 0;
+    do {
+        format.decompress(encoded.data(), encoded.size(), width, height, decoded.data());
+        rounds++;
+    } while (nowSeconds() - start < 0.3);
+    double decodeSeconds = (nowSeconds() - start) / rounds;
+    double megapixels = double(width) * height / 1e6;
+    double colorPsnr = psnr(image, decoded, -1);
+    double alphaPsnr = format.hasAlpha ? psnr(image, decoded, 3) : INFINITY;
+    printf("  %-12s RGB %6.2f dB  alpha %6.2f dB  编码 %6.2f MP/s  解码 %7.1f MP/s  %.2f bpp\n", label,
+           colorPsnr, alphaPsnr, megapixels / encodeSeconds, megapixels / decodeSeconds,
+           encoded.size() * 8.0 / (double(width) * height));
+    check(colorPsnr >= minColorPsnr, "颜色PSNR达到阈值");
+    check(alphaPsnr >= minAlphaPsnr, "alpha PSNR达到阈值");
+}
+
+void checkCodecs(int32_t size) {
+    printf("编码质量与吞吐量（%dx%d，单线程）\n", size, size);
+    std::vector<uint8_t> opaque = testImage(size, size, false);
+    std::vector<uint8_t> translucent = testImage(size, size, true);
+    checkCodec("ETC2 RGB", *TextureFormat::find(147), opaque, size, size, 32.0, INFINITY);
+    checkCodec("ETC2 RGBA", *TextureFormat::find(151), translucent, size, size, 32.0, 38.0);
+    checkCodec("ASTC 4x4", *TextureFormat::find(157), opaque, size, size, 34.0, INFINITY);
+    checkCodec("ASTC 4x4 A", *TextureFormat::find(157), translucent, size, size, 30.0, 30.0);
+
+    // 尺寸不是块的整数倍时，边缘块重复边缘像素补齐，解码时丢弃超出的部分：
+    // 结果应与先把图像补齐到整块再编码、解码后裁剪完全相同
+    const int32_t oddWidth = 37, oddHeight = 23, paddedWidth = 40, paddedHeight = 24;
+    std::vector<uint8_t> odd = testImage(oddWidth, oddHeight, true);
+    std::vector<uint8_t> padded(size_t(paddedWidth) * paddedHeight * 4);
+    for (int32_t y = 0; y < paddedHeight; y++) {
+        for (int32_t x = 0; x < paddedWidth; x++) {
+            size_t source = (size_t(std::min(y, oddHeight - 1)) * oddWidth + std::min(x, oddWidth - 1)) * 4;
+            memcpy(&padded[(size_t(y) * paddedWidth + x) * 4], &odd[source], 4);
+        }
+    }
+    for (uint32_t vkFormat: {152u, 158u}) {
+        const TextureFormat &format = *TextureFormat::find(vkFormat);
+        std::vector<uint8_t> encodedOdd = TextureEncoder::encodeImage(format, oddWidth, oddHeight, odd.data());
+        std::vector<uint8_t> encodedPadded = TextureEncoder::encodeImage(format, paddedWidth, paddedHeight,
+                                                                         padded.data());
+        check(encodedOdd == encodedPadded, "边缘块按重复的边缘像素编码");
+        std::vector<uint8_t> decodedOdd(odd.size()), decodedPadded(padded.size());
+        format.decompress(encodedOdd.data(), encodedOdd.size(), oddWidth, oddHeight, decodedOdd.data());
+        format.decompress(encodedPadded.data(), encodedPadded.size(), paddedWidth, paddedHeight,
+                          decodedPadded.data());
+        bool cropped = true;
+        for (int32_t y = 0; y < oddHeight; y++) {
+            cropped = cropped && memcmp(&decodedOdd[size_t(y) * oddWidth * 4],
+                                        &decodedPadded[size_t(y) * paddedWidth * 4], size_t(oddWidth) * 4) == 0;
+        }
+        check(cropped, "边缘块解码后只保留图像内的像素");
+    }
+
+    // 纯色块用void extent，UNORM和sRGB解码都应完全还原
+    std::vector<uint8_t> solid(64 * 64 * 4);
+    for (size_t i = 0; i < solid.size(); i++) {
+        solid[i] = uint8_t(i % 4 == 0 ? 17 : i % 4 == 1 ? 200 : i % 4 == 2 ? 99 : 140);
+    }
+    for (uint32_t vkFormat: {157u, 158u}) {
+        const TextureFormat &format = *TextureFormat::find(vkFormat);
+        std::vector<uint8_t> encoded = TextureEncoder::encodeImage(format, 64, 64, solid.data());
+        std::vector<uint8_t> decoded(solid.size());
+        format.decompress(encoded.data(), encoded.size(), 64, 64, decoded.data());
+        check(decoded == solid, "纯色ASTC块完全还原");
+    }
+}
+
+void checkAstcFuzz() {
+    printf("随机ASTC块\n");
+    const int sizes[][2] = {{4, 4}, {5, 5}, {6, 6}, {8, 5}, {8, 8}, {10, 6}, {10, 10}, {12, 12}};
+    Random random{777};
+    uint8_t pixels[12 * 12 * 4];
+    for (const auto &size: sizes) {
+        size_t errors = 0;
+        const int blocks = 20000;
+        double start = nowSeconds();
+        for (int i = 0; i < blocks; i++) {
+            uint8_t block[16];
+            for (uint8_t &byte: block) {
+                byte = uint8_t(random.next());
+            }
+            if (!AstcDecoder::decodeBlock(block, size[0], size[1], i % 2, pixels, size_t(size[0]) * 4)) {
+                errors++;
+                bool magenta = true;
+                for (int p = 0; p < size[0] * size[1]; p++) {
+                    magenta = magenta && pixels[p * 4] == 255 && pixels[p * 4 + 1] == 0 && pixels[p * 4 + 2] == 255
+                              && pixels[p * 4 + 3] == 255;
+                }
+                check(magenta, "非法块输出错误颜色");
+            }
+        }
+        double seconds = nowSeconds() - start;
+        printf("  %2dx%-2d %d 块中 %5zu 个非法或HDR，%6.1f MP/s\n", size[0], size[1], blocks, errors,
+               blocks * size[0] * size[1] / seconds / 1e6);
+    }
+}
+
+void benchZstd(int32_t size) {
+    if (!Ktx2File::zstdSupported()) {
+        return;
+    }
+    printf("zstd超压缩（%dx%d，单个层级）\n", size, size);
+    std::vector<uint8_t> image = testImage(size, size, false);
+    for (uint32_t vkFormat: {147u, 157u}) {
+        const TextureFormat &format = *TextureFormat::find(vkFormat);
+        Ktx2Writer plain(format, size, size);
+        Ktx2Writer compressed(format, size, size);
+        compressed.setZstdLevel(19);
+        std::vector<uint8_t> data = TextureEncoder::encodeImage(format, size, size, image.data());
+        plain.addLevel(data);
+        compressed.addLevel(data);
+        std::vector<uint8_t> plainFile, compressedFile;
+        plain.serialize(plainFile);
+        compressed.serialize(compressedFile);
+        Ktx2File ktx2;
+        ktx2.parse(compressedFile.data(), compressedFile.size());
+        std::vector<uint8_t> scratch;
+        const uint8_t *level = nullptr;
+        double start = nowSeconds();
+        int rounds = 0;
+        do {
+            ktx2.levelData(0, scratch, level);
+            rounds++;
+        } while (nowSeconds() - start < 0.3);
+        double seconds = (nowSeconds() - start) / rounds;
+        printf("  %-22s %zu -> %zu 字节（%.1f%%），解压 %.0f MB/s\n", format.name, plainFile.size(),
+               compressedFile.size(), 100.0 * compressedFile.size() / plainFile.size(),
+               data.size() / seconds / 1e6);
+        check(memcmp(level, data.data(), data.size()) == 0, "zstd解压后数据不变");
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int32_t size = argc > 1 ? atoi(argv[1]) : 512;
+    checkContainer();
+    checkCodecs(size);
+    checkAstcFuzz();
+    benchZstd(size);
+    if (failures > 0) {
+        printf("%d 项检查失败\n", failures);
+        return 1;
+    }
+    printf("全部检查通过\n");
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * ktx2encoder：把图像编码成KTX2纹理。mip链由与运行时相同的 TextureBaker 生成，每一级再用
+ * TextureEncoder 编码成ETC2或ASTC 4x4，可选用zstd对每一级做超压缩。
+ *
+ * ETC2按图像是否有alpha选择RGB或RGBA（EAC）格式；ASTC总是带alpha。
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "ImageFile.h"
+#include "Ktx2.h"
+#include "TextureBaker.h"
+#include "TextureEncoder.h"
+
+namespace {
+
+struct Options {
+    const char *input = nullptr;
+    const char *output = nullptr;
+    TextureCodec codec = TextureCodec::Etc2;
+    bool mips = true;
+    int zstdLevel = 0;
+    MipBakeOptions bake;
+};
+
+void printUsage() {
+    fprintf(stderr,
+            "用法: ktx2encoder [选项] 输入.pam|.ppm|.png 输出.ktx2\n"
+            "  --format F       etc2（默认）、astc（4x4块）或rgba8\n"
+            "  --zstd N         用zstd压缩级别N做超压缩\n"
+            "  --no-mips        只写第0层\n"
+            "  --box            2x2盒式滤波（默认Kaiser）\n"
+            "  --linear         颜色不是sRGB编码（法线、粗糙度等数据纹理）\n"
+            "  --premultiplied  输入已经预乘alpha，输出也保持预乘\n"
+            "  --cutoff A       按alpha测试阈值A保持每一级的覆盖率\n");
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--format") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "etc2") == 0) {
+                options.codec = TextureCodec::Etc2;
+            } else if (strcmp(name, "astc") == 0) {
+                options.codec = TextureCodec::Astc;
+            } else if (strcmp(name, "rgba8") == 0) {
+                options.codec = TextureCodec::Rgba8;
+            } else {
+                fprintf(stderr, "未知格式 %s\n", name);
+                return false;
+            }
+        } else if (strcmp(arg, "--zstd") == 0 && i + 1 < argc) {
+            options.zstdLevel = atoi(argv[++i]);
+        } else if (strcmp(arg, "--no-mips") == 0) {
+            options.mips = false;
+        } else if (strcmp(arg, "--box") == 0) {
+            options.bake.filter = MipFilter::Box;
+        } else if (strcmp(arg, "--linear") == 0) {
+            options.bake.srgb = false;
+        } else if (strcmp(arg, "--premultiplied") == 0) {
+            options.bake.alphaMode = AlphaMode::Premultiplied;
+        } else if (strcmp(arg, "--cutoff") == 0 && i + 1 < argc) {
+            options.bake.alphaCutoff = float(atof(argv[++i]));
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "未知选项 %s\n", arg);
+            return false;
+        } else if (!options.input) {
+            options.input = arg;
+        } else if (!options.output) {
+            options.output = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.input && options.output;
+}
+
+//! 编码后再解码，与原图比较的峰值信噪比（dB），只统计格式中有的通道
+double encodedPsnr(const TextureFormat &format, int32_t width, int32_t height, const uint8_t *rgba,
+                   const std::vector<uint8_t> &encoded) {
+    std::vector<uint8_t> decoded(size_t(width) * height * 4);
+    if (!format.decompress(encoded.data(), encoded.size(), width, height, decoded.data())) {
+        return 0.0;
+    }
+    int channels = format.hasAlpha ? 4 : 3;
+    double sum = 0.0;
+    for (size_t i = 0; i < decoded.size(); i++) {
+        if (int(i % 4) < channels) {
+            double d = double(decoded[i]) - rgba[i];
+            sum += d * d;
+        }
+    }
+    double mse = sum / (double(width) * height * channels);
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    if (options.zstdLevel > 0 && !Ktx2File::zstdSupported()) {
+        fprintf(stderr, "构建时没有找到zstd，不能使用--zstd\n");
+        return 1;
+    }
+    int32_t width, height;
+    std::vector<uint8_t> rgba;
+    if (!ImageFile::read(options.input, width, height, rgba)) {
+        return 1;
+    }
+
+    bool hasAlpha = false;
+    for (size_t i = 3; i < rgba.size() && !hasAlpha; i += 4) {
+        hasAlpha = rgba[i] != 255;
+    }
+    int blockSize = options.codec == TextureCodec::Rgba8 ? 1 : 4;
+    const TextureFormat *format = TextureFormat::find(options.codec, blockSize, blockSize, options.bake.srgb,
+                                                      hasAlpha || options.codec == TextureCodec::Rgba8);
+    if (!format) {
+        fprintf(stderr, "没有对应的纹理格式\n");
+        return 1;
+    }
+
+    MipChain chain;
+    if (options.mips) {
+        chain = TextureBaker::buildMipChain(width, height, std::move(rgba), options.bake);
+    } else {
+        chain.levels.push_back({width, height, 0, rgba.size()});
+        chain.pixels = std::move(rgba);
+    }
+
+    Ktx2Writer writer(*format, width, height);
+    writer.setZstdLevel(options.zstdLevel);
+    size_t encodedBytes = 0;
+    for (size_t level = 0; level < chain.levels.size(); level++) {
+        const auto &mip = chain.levels[level];
+        std::vector<uint8_t> encoded = TextureEncoder::encodeImage(*format, mip.width, mip.height,
+                                                                   chain.levelData(level));
+        if (level == 0) {
+            printf("  第0层 %dx%d，PSNR %.2f dB\n", mip.width, mip.height,
+                   encodedPsnr(*format, mip.width, mip.height, chain.levelData(level), encoded));
+        }
+        encodedBytes += encoded.size();
+        writer.addLevel(std::move(encoded));
+    }
+    if (!writer.write(options.output)) {
+        return 1;
+    }
+    struct stat info = {};
+    stat(options.output, &info);
+    printf("%s: %s，%zu 个层级，数据 %zu 字节（RGBA8为 %zu 字节），文件 %lld 字节\n", options.output, format->name,
+           chain.levels.size(), encodedBytes, chain.bytesFrom(0), (long long) info.st_size);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * logbench：比较每帧日志在渲染线程上的开销，改动前的同步 aout 流对比异步的 Logger。
+ *
+ * 每帧写入与改动前 Renderer 相同的几行：render、每个模型一次 drawModel、handleInput。
+ * 同步路径按原来的 AndroidOut 实现：std::endl 触发 sync()，在调用线程上格式化并做一次 write 系统调用
+ * （设备上是 __android_log_print）。异步路径使用 LOGx 宏，记录写入本线程的环形缓冲区，
+ * 后台线程排空到 FileSink。每隔若干帧在计时之外调用 Logger::flush，保证环形缓冲区不会写满丢弃。
+ * 检查项：开启的级别每条记录都写进了文件且没有丢弃；运行期关闭的级别不产生记录。
+ * 输出每帧日志耗时的平均值和p99。
+ * 用法：logbench [帧数] [模型数]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "AndroidOut.h"
+#include "Log.h"
+
+namespace {
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! 改动前的 AndroidOut：sync() 在调用线程上同步输出，再重建字符串缓冲
+class SyncOut : public std::stringbuf {
+public:
+    SyncOut(const char *tag, int fd) : tag_(tag), fd_(fd) {}
+
+protected:
+    int sync() override {
+        // std::endl 写入的换行已经在 str() 中
+        dprintf(fd_, "D/%s: %s", tag_, str().c_str());
+        str("");
+        return 0;
+    }
+
+private:
+    const char *tag_;
+    int fd_;
+};
+
+// 每帧的日志调用不超过一个环形缓冲区（256条）时，在计时之外排空
+constexpr int kFramesPerFlush = 32;
+
+struct Result {
+    double meanNs = 0;
+    double p99Ns = 0;
+};
+
+/*!
+ * 逐帧调用 frame 并计时
+ * @param flush 每 kFramesPerFlush 帧在计时之外调用一次
+ */
+Result timeFrames(int frameCount, const std::function<void(int)> &frame, const std::function<void()> &flush) {
+    std::vector<uint64_t> times(static_cast<size_t>(frameCount));
+    for (int i = 0; i < frameCount; i++) {
+        uint64_t start = nowNs();
+        frame(i);
+        times[size_t(i)] = nowNs() - start;
+        if (i % kFramesPerFlush == kFramesPerFlush - 1) {
+            flush();
+        }
+    }
+    flush();
+    Result result;
+    for (uint64_t time: times) {
+        result.meanNs += double(time);
+    }
+    result.meanNs /= frameCount;
+    std::sort(times.begin(), times.end());
+    result.p99Ns = double(times[times.size() * 99 / 100]);
+    return result;
+}
+
+//! 非空的行数。aout 的消息自带换行，输出端再加一个换行，它的记录后面各跟着一个空行
+size_t countLines(const std::string &path) {
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file) {
+        return 0;
+    }
+    size_t lines = 0;
+    int c;
+    int previous = '\n';
+    while ((c = fgetc(file)) != EOF) {
+        lines += c == '\n' && previous != '\n';
+        previous = c;
+    }
+    fclose(file);
+    return lines;
+}
+
+void print(const char *name, const Result &result, int linesPerFrame) {
+    printf("  %-28s 每帧 %8.0f ns（p99 %8.0f ns），每条 %6.0f ns\n",
+           name, result.meanNs, result.p99Ns, result.meanNs / linesPerFrame);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int frameCount = argc > 1 ? std::max(kFramesPerFlush, atoi(argv[1])) : 20000;
+    int modelCount = argc > 2 ? std::max(1, atoi(argv[2])) : 4;
+    int linesPerFrame = modelCount + 2;
+    int64_t expectedLines = int64_t(frameCount) * linesPerFrame;
+
+    std::string base = "/tmp/logbench-" + std::to_string(getpid());
+    std::string syncPath = base + "-sync.log";
+    std::string asyncPath = base + "-async.log";
+    bool ok = true;
+    printf("%d帧，每帧%d行日志\n", frameCount, linesPerFrame);
+
+    // 计时本身的开销
+    Result empty = timeFrames(frameCount, [](int) {}, [] {});
+    print("空帧（计时开销）", empty, linesPerFrame);
+
+    // 改动前：同步的 aout
+    int fd = open(syncPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    SyncOut syncBuffer("AO", fd);
+    std::ostream syncOut(&syncBuffer);
+    Result sync = timeFrames(frameCount, [&](int) {
+        syncOut << "执行函数 render" << std::endl;
+        for (int m = 0; m < modelCount; m++) {
+            syncOut << "执行函数 drawModel" << std::endl;
+        }
+        syncOut << "执行函数 handleInput" << std::endl;
+    }, [] {});
+    close(fd);
+    print("同步aout（改动前）", sync, linesPerFrame);
+
+    // 异步：开启的级别全部写进文件
+    Logger &logger = Logger::instance();
+    logger.setSink(std::make_unique<FileSink>(asyncPath));
+    logger.setLevel(LogLevel::Info);
+    uint64_t droppedBefore = logger.getDroppedCount();
+    auto flush = [&] { logger.flush(); };
+    auto logFrame = [&](int frame) {
+        LOGI("执行函数 render %d", frame);
+        for (int m = 0; m < modelCount; m++) {
+            LOGI("执行函数 drawModel %d", m);
+        }
+        LOGI("执行函数 handleInput");
+    };
+    Result enabled = timeFrames(frameCount, logFrame, flush);
+    print("异步LOGI，级别开启", enabled, linesPerFrame);
+    // aout 兼容流使用Debug级别
+    logger.setLevel(LogLevel::Debug);
+    Result stream = timeFrames(frameCount, [&](int) {
+        aout << "执行函数 render" << std::endl;
+        for (int m = 0; m < modelCount; m++) {
+            aout << "执行函数 drawModel" << std::endl;
+        }
+        aout << "执行函数 handleInput" << std::endl;
+    }, flush);
+    print("异步aout兼容流", stream, linesPerFrame);
+
+    // 运行期关闭：只有一次原子读，不产生记录
+    logger.setLevel(LogLevel::Warn);
+    Result gated = timeFrames(frameCount, logFrame, flush);
+    print("异步LOGI，运行期关闭", gated, linesPerFrame);
+
+    // 低于编译期级别的调用点整体消失（Release构建中的LOGV）
+    Result compiled = timeFrames(frameCount, [&](int frame) {
+        LOGV("执行函数 render %d", frame);
+        for (int m = 0; m < modelCount; m++) {
+            LOGV("执行函数 drawModel %d", m);
+        }
+        LOGV("执行函数 handleInput");
+    }, flush);
+    print(kLogCompileLevel > LogLevel::Verbose ? "LOGV，编译期裁掉" : "LOGV，运行期关闭", compiled, linesPerFrame);
+
+    logger.setSink(std::make_unique<StdoutSink>());
+    logger.setLevel(LogLevel::Debug);
+
+    // 文件里是级别开启时LOGI和aout两轮的记录
+    int64_t asyncLines = int64_t(countLines(asyncPath));
+    uint64_t dropped = logger.getDroppedCount() - droppedBefore;
+    if (asyncLines != expectedLines * 2 || dropped != 0) {
+        printf("异步日志的记录数错误：文件中%lld行，应为%lld行，丢弃%llu条\n", (long long) asyncLines,
+               (long long) expectedLines * 2, (unsigned long long) dropped);
+        ok = false;
+    }
+    if (countLines(syncPath) != size_t(expectedLines)) {
+        printf("同步日志的记录数错误\n");
+        ok = false;
+    }
+    printf("异步/同步每帧耗时：%.1f%%\n", enabled.meanNs / sync.meanNs * 100.0);
+
+    unlink(syncPath.c_str());
+    unlink(asyncPath.c_str());
+    printf(ok ? "日志检查通过\n" : "日志检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/*
+ * meshbaker：把glTF/GLB转换成烘焙网格文件（.bmesh）。
+ *
+ * 每个图元成为文件中的一个网格。三角形列表在这里完成运行时原本要做的全部处理：
+ * 顶点缓存/过度绘制/取顶点优化、细节层次链、分簇和顶点量化，加载时直接映射使用。
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "BakedMesh.h"
+#include "GltfLoader.h"
+#include "LevelOfDetail.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+
+namespace {
+
+struct Options {
+    const char *input = nullptr;
+    const char *output = nullptr;
+    bool fullPrecision = false;
+    size_t maxLods = 4;
+    bool meshlets = true;
+    bool optimize = true;
+    bool verify = false;
+};
+
+void printUsage() {
+    fprintf(stderr,
+            "用法: meshbaker [选项] 输入.gltf|输入.glb 输出.bmesh\n"
+            "  --full          使用float位置和uv（默认snorm16位置 + unorm16 uv）\n"
+            "  --lods N        最多生成的细节层次，包括第0层（默认4，1表示不生成）\n"
+            "  --no-meshlets   不分簇\n"
+            "  --no-optimize   不做顶点缓存、过度绘制和取顶点优化\n"
+            "  --verify        写完后重新打开并校验全部数据\n");
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--full") == 0) {
+            options.fullPrecision = true;
+        } else if (strcmp(arg, "--lods") == 0 && i + 1 < argc) {
+            options.maxLods = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--no-meshlets") == 0) {
+            options.meshlets = false;
+        } else if (strcmp(arg, "--no-optimize") == 0) {
+            options.optimize = false;
+        } else if (strcmp(arg, "--verify") == 0) {
+            options.verify = true;
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "未知选项 %s\n", arg);
+            return false;
+        } else if (!options.input) {
+            options.input = arg;
+        } else if (!options.output) {
+            options.output = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.input && options.output;
+}
+
+uint32_t packColor(const float *factor) {
+    uint32_t color = 0;
+    for (int c = 0; c < 4; c++) {
+        auto value = uint32_t(std::lround(std::min(1.f, std::max(0.f, factor[c])) * 255.f));
+        color |= value << (8 * c);
+    }
+    return color;
+}
+
+// 与 GltfLoader::createModels 相同：uv超出[0, 1]时不能用unorm16
+VertexLayout chooseLayout(const std::vector<Vertex> &vertices, bool fullPrecision) {
+    if (fullPrecision) {
+        return VertexLayout::full();
+    }
+    bool uvInUnitRange = true;
+    for (const Vertex &vertex: vertices) {
+        uvInUnitRange = uvInUnitRange && vertex.uv.u >= 0.f && vertex.uv.u <= 1.f
+                        && vertex.uv.v >= 0.f && vertex.uv.v <= 1.f;
+    }
+    return VertexLayout::make(
+            PositionFormat::Snorm16,
+            uvInUnitRange ? UVFormat::Unorm16 : UVFormat::Float32,
+            ColorFormat::None);
+}
+
+BakedMeshInput bakePrimitive(const GltfScene &scene, const GltfPrimitive &primitive, const Options &options) {
+    VertexStreams streams = primitive.vertexStreams();
+    IndexStream indexStream = primitive.indexStream();
+    std::vector<Vertex> vertices;
+    vertices.reserve(streams.count);
+    for (size_t i = 0; i < streams.count; i++) {
+        vertices.push_back(streams.fetch(i));
+    }
+    std::vector<Index> indices(indexStream.count);
+    for (size_t i = 0; i < indexStream.count; i++) {
+        indices[i] = indexStream.fetch(i);
+    }
+
+    BakedMeshInput mesh;
+    mesh.mode = primitive.mode;
+    if (primitive.material >= 0) {
+        mesh.baseColor = packColor(scene.materials[primitive.material].baseColorFactor);
+    }
+
+    bool triangles = primitive.mode == GL_TRIANGLES && indices.size() >= 3;
+    if (triangles && options.optimize) {
+        auto report = MeshOptimizer::optimize(vertices, indices);
+        printf("    优化: ACMR %.3f -> %.3f\n", report.before.acmr, report.after.acmr);
+    }
+    if (triangles && options.maxLods > 1) {
+        mesh.lods = LevelOfDetail::buildChain(vertices, indices, options.maxLods);
+    } else {
+        mesh.lods.push_back(LodLevel{indices, 0.f});
+    }
+    if (triangles && options.meshlets) {
+        mesh.meshlets = MeshletBuilder::build(vertices, mesh.lods[0].indices);
+        mesh.lods[0].indices = mesh.meshlets.indices;
+    }
+    for (size_t level = 1; level < mesh.lods.size(); level++) {
+        if (options.optimize) {
+            MeshOptimizer::optimizeVertexCache(mesh.lods[level].indices, vertices.size());
+        }
+    }
+
+    mesh.bounds = Aabb::fromVertices(vertices);
+    mesh.vertices = VertexFormat::quantize(vertices, chooseLayout(vertices, options.fullPrecision));
+    printf("    %zu 顶点，%zu 个层次，第0层 %zu 索引，%zu 个簇，最大位置误差 %g\n",
+           vertices.size(), mesh.lods.size(), mesh.lods[0].indices.size(),
+           mesh.meshlets.meshlets.size(), mesh.vertices.maxPositionError);
+    return mesh;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    auto scene = GltfLoader::load(options.input);
+    if (!scene) {
+        fprintf(stderr, "无法加载 %s\n", options.input);
+        return 1;
+    }
+
+    BakedMeshWriter writer;
+    size_t meshCount = 0;
+    for (const GltfMesh &mesh: scene->meshes) {
+        for (size_t p = 0; p < mesh.primitives.size(); p++) {
+            std::string name(mesh.name);
+            if (mesh.primitives.size() > 1) {
+                name += "#" + std::to_string(p);
+            }
+            printf("  %s\n", name.c_str());
+            BakedMeshInput baked = bakePrimitive(*scene, mesh.primitives[p], options);
+            baked.name = std::move(name);
+            writer.addMesh(std::move(baked));
+            meshCount++;
+        }
+    }
+    if (!writer.write(options.output)) {
+        return 1;
+    }
+    printf("写入 %s: %zu 个网格\n", options.output, meshCount);
+
+    if (options.verify) {
+        BakedMeshFile file;
+        if (!file.open(options.output, true)) {
+            fprintf(stderr, "校验 %s 失败\n", options.output);
+            return 1;
+        }
+        printf("校验通过\n");
+    }
+    return 0;
+}
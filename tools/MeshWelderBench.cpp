@@ -0,0 +1,338 @@
+/*
+ * meshwelderbench：检查 MeshWelder 的焊接和切分结果，并测量耗时。
+ *
+ * 焊接的输入是每个三角形各自带3个顶点的规则网格，同一个网格点的各个副本加上不超过容差1/4的抖动，
+ * 两两之差在容差以内，不同网格点相距远大于容差，所以期望的结果与分块方式无关。
+ * 检查项：焊接后的顶点数等于网格点数；保留的是每个网格点第一次出现的顶点，顺序不变；
+ * 按网格点编号表示的三角形序列（保持绕序）不变；1、4、16个线程的结果完全相同；
+ * 间距为容差0.6倍的一串点（容差比较不具有传递性）在各线程数下都和顺序贪心焊接的结果一致，即保留偶数号的点；
+ * uv差异超过容差或颜色不同的副本不合并，关闭uv或颜色比较后合并；容差为0时按位比较，+0和-0视为相同。
+ * 切分的输入超过65535个顶点，检查项：每块不超过 maxVertices 个顶点，局部索引都能用16位表示且都在块内，
+ * 每个块内的顶点都被引用；按原顶点编号拼接各块的图元正好是原来的图元序列，每个图元只出现一次；
+ * 除最后一块外，下一个图元确实放不进当前块。三角形、线段和点都检查。
+ * 用法：meshwelderbench [大网格的边长]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "MeshWelder.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    // [-1, 1)
+    float symmetric() {
+        state = state * 1664525u + 1013904223u;
+        return float(state >> 8) / float(1u << 23) - 1.f;
+    }
+};
+
+constexpr float kEpsilon = 1e-4f;
+
+/*!
+ * 不共享顶点的规则网格。颜色记录顶点所在的网格点编号，焊接后用它检查三角形
+ * @param jitter 每个顶点副本在每个轴上的最大抖动
+ */
+void makeUnindexedGrid(uint32_t size, float jitter, Random &random,
+                       std::vector<Vertex> &vertices, std::vector<Index> &indices) {
+    vertices.clear();
+    indices.clear();
+    auto corner = [&](uint32_t x, uint32_t y) {
+        indices.push_back(Index(vertices.size()));
+        vertices.emplace_back(Vector3{{float(x) + jitter * random.symmetric(),
+                                       float(y) + jitter * random.symmetric(),
+                                       jitter * random.symmetric()}},
+                              Vector2{{float(x) / float(size), float(y) / float(size)}},
+                              y * (size + 1) + x);
+    };
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            corner(x, y);
+            corner(x + 1, y);
+            corner(x, y + 1);
+            corner(x + 1, y);
+            corner(x + 1, y + 1);
+            corner(x, y + 1);
+        }
+    }
+}
+
+// 按颜色记录的网格点编号列出索引指向的顶点
+std::vector<uint32_t> gridPoints(const std::vector<Vertex> &vertices, const std::vector<Index> &indices) {
+    std::vector<uint32_t> points;
+    points.reserve(indices.size());
+    for (Index index: indices) {
+        points.push_back(index < vertices.size() ? vertices[index].color : 0xFFFFFFFFu);
+    }
+    return points;
+}
+
+bool checkWeldGrid(uint32_t size) {
+    Random random{5};
+    std::vector<Vertex> source;
+    std::vector<Index> sourceIndices;
+    makeUnindexedGrid(size, kEpsilon / 4.f, random, source, sourceIndices);
+    const std::vector<uint32_t> expectedPoints = gridPoints(source, sourceIndices);
+    const size_t expectedCount = size_t(size + 1) * (size + 1);
+
+    // 每个网格点第一次出现的顶点
+    std::vector<uint32_t> firstOccurrence;
+    {
+        std::vector<uint8_t> seen(expectedCount, 0);
+        for (uint32_t v = 0; v < source.size(); v++) {
+            if (!seen[source[v].color]) {
+                seen[source[v].color] = 1;
+                firstOccurrence.push_back(v);
+            }
+        }
+    }
+
+    bool ok = true;
+    std::vector<Index> firstResult;
+    for (size_t threads: {size_t(1), size_t(4), size_t(16)}) {
+        std::vector<Vertex> vertices = source;
+        std::vector<Index> indices = sourceIndices;
+        WeldOptions options;
+        options.positionEpsilon = kEpsilon;
+        options.threadCount = threads;
+        size_t welded = MeshWelder::weld(vertices, indices, options);
+        bool weldOk = welded == expectedCount && vertices.size() == expectedCount;
+        for (size_t i = 0; i < vertices.size() && weldOk; i++) {
+            const Vertex &expected = source[firstOccurrence[i]];
+            weldOk = vertices[i].color == expected.color && vertices[i].position.x == expected.position.x
+                     && vertices[i].position.y == expected.position.y && vertices[i].position.z == expected.position.z;
+        }
+        weldOk = weldOk && gridPoints(vertices, indices) == expectedPoints;
+        if (firstResult.empty()) {
+            firstResult = indices;
+        } else {
+            weldOk = weldOk && indices == firstResult;
+        }
+        if (!weldOk) {
+            printf("%zu个线程：焊接后%zu个顶点，应为%zu\n", threads, welded, expectedCount);
+            ok = false;
+        }
+    }
+    printf("抖动网格的焊接：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkWeldChain() {
+    // 第i个点到第i-1个点的距离在容差内，到第i-2个点不在：顺序贪心时奇数号的点合并到前一个点上
+    const uint32_t count = 4096 * 16 * 2;
+    std::vector<Vertex> source;
+    std::vector<Index> sourceIndices;
+    for (uint32_t i = 0; i < count; i++) {
+        source.emplace_back(Vector3{{float(i) * kEpsilon * 0.6f, 1.f, 0.f}}, Vector2{{0.f, 0.f}}, i);
+        sourceIndices.push_back(Index(i));
+    }
+    bool ok = true;
+    for (size_t threads: {size_t(1), size_t(4), size_t(16)}) {
+        std::vector<Vertex> vertices = source;
+        std::vector<Index> indices = sourceIndices;
+        WeldOptions options;
+        options.positionEpsilon = kEpsilon;
+        options.compareColor = false;
+        options.threadCount = threads;
+        bool chainOk = MeshWelder::weld(vertices, indices, options) == count / 2;
+        for (uint32_t i = 0; i < vertices.size() && chainOk; i++) {
+            chainOk = vertices[i].color == i * 2;
+        }
+        for (uint32_t i = 0; i < count && chainOk; i++) {
+            chainOk = indices[i] == i / 2;
+        }
+        if (!chainOk) {
+            printf("%zu个线程：一串点的焊接结果与顺序贪心焊接不同\n", threads);
+            ok = false;
+        }
+    }
+    printf("不具有传递性的一串点的焊接：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+size_t weldCount(std::vector<Vertex> vertices, const WeldOptions &options) {
+    std::vector<Index> indices;
+    for (size_t i = 0; i < vertices.size(); i++) {
+        indices.push_back(Index(i));
+    }
+    return MeshWelder::weld(vertices, indices, options);
+}
+
+bool checkWeldAttributes() {
+    bool ok = true;
+    std::vector<Vertex> vertices;
+    // 同一位置：uv相差2倍容差、颜色不同，以及完全相同的副本
+    Vector3 position = {{1.f, 2.f, 3.f}};
+    vertices.emplace_back(position, Vector2{{0.5f, 0.5f}}, 0xFF0000FFu);
+    vertices.emplace_back(position, Vector2{{0.5f + 2e-3f, 0.5f}}, 0xFF0000FFu);
+    vertices.emplace_back(position, Vector2{{0.5f, 0.5f}}, 0xFF00FF00u);
+    vertices.emplace_back(position, Vector2{{0.5f, 0.5f}}, 0xFF0000FFu);
+
+    WeldOptions strict;
+    strict.positionEpsilon = kEpsilon;
+    strict.uvEpsilon = 1e-3f;
+    ok = weldCount(vertices, strict) == 3 && ok;
+    WeldOptions ignoreUV = strict;
+    ignoreUV.uvEpsilon = -1.f;
+    ok = weldCount(vertices, ignoreUV) == 2 && ok;
+    WeldOptions ignoreColor = strict;
+    ignoreColor.compareColor = false;
+    ok = weldCount(vertices, ignoreColor) == 2 && ok;
+    ignoreColor.uvEpsilon = -1.f;
+    ok = weldCount(vertices, ignoreColor) == 1 && ok;
+
+    // 容差为0：+0和-0相同，相邻的浮点数不同
+    std::vector<Vertex> exact;
+    exact.emplace_back(Vector3{{0.f, 1.f, 1.f}}, Vector2{{0.f, 0.f}});
+    exact.emplace_back(Vector3{{-0.f, 1.f, 1.f}}, Vector2{{0.f, 0.f}});
+    exact.emplace_back(Vector3{{0.f, std::nextafter(1.f, 2.f), 1.f}}, Vector2{{0.f, 0.f}});
+    WeldOptions bitwise;
+    bitwise.positionEpsilon = 0.f;
+    bitwise.uvEpsilon = 0.f;
+    ok = weldCount(exact, bitwise) == 2 && ok;
+    // 容差内的位置在格子边界两侧也能找到
+    std::vector<Vertex> boundary;
+    boundary.emplace_back(Vector3{{2.f * kEpsilon - 1e-5f, 0.f, 0.f}}, Vector2{{0.f, 0.f}});
+    boundary.emplace_back(Vector3{{2.f * kEpsilon + 1e-5f, 0.f, 0.f}}, Vector2{{0.f, 0.f}});
+    ok = weldCount(boundary, strict) == 1 && ok;
+
+    printf("uv、颜色和零容差的比较：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkSplit(const std::vector<Vertex> &vertices, const std::vector<Index> &indices,
+                GLenum mode, size_t stride, size_t maxVertices, const char *name) {
+    std::vector<MeshChunk> chunks = MeshWelder::split(vertices, indices, mode, maxVertices);
+    bool ok = !chunks.empty();
+    std::vector<uint32_t> joined;
+    joined.reserve(indices.size());
+    for (size_t c = 0; c < chunks.size() && ok; c++) {
+        const MeshChunk &chunk = chunks[c];
+        std::vector<uint8_t> used(chunk.vertices.size(), 0);
+        ok = chunk.vertices.size() <= maxVertices && chunk.indices.size() % stride == 0 && !chunk.indices.empty();
+        for (Index index: chunk.indices) {
+            ok = ok && index <= 0xFFFFu && index < chunk.vertices.size();
+            if (ok) {
+                used[index] = 1;
+                joined.push_back(chunk.vertices[index].color);
+            }
+        }
+        ok = ok && std::find(used.begin(), used.end(), 0) == used.end();
+        // 下一个图元新增的顶点放不进这一块
+        if (ok && c + 1 < chunks.size()) {
+            size_t next = joined.size();
+            size_t added = 0;
+            for (size_t corner = 0; corner < stride; corner++) {
+                uint32_t vertex = indices[next + corner];
+                bool present = std::find(joined.begin() + long(next - chunk.indices.size()), joined.end(), vertex)
+                               != joined.end();
+                for (size_t previous = 0; previous < corner; previous++) {
+                    present |= indices[next + previous] == vertex;
+                }
+                added += !present;
+            }
+            ok = chunk.vertices.size() + added > maxVertices;
+        }
+        if (!ok) {
+            printf("%s：第%zu块（%zu个顶点，%zu个索引）无效\n", name, c, chunk.vertices.size(), chunk.indices.size());
+        }
+    }
+    // 原顶点的颜色就是它的编号
+    if (ok && joined != std::vector<uint32_t>(indices.begin(), indices.end())) {
+        printf("%s：各块的图元拼接后与原图元序列不同\n", name);
+        ok = false;
+    }
+    printf("切分%s（%zu个顶点，每块最多%zu个）：%zu块，%s\n", name, vertices.size(), maxVertices, chunks.size(),
+           ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkSplits() {
+    // 共享顶点的网格，顶点超过16位索引的范围。三角形按行排列，后半部分整体反转（绕序也随之反转），
+    // 让切分从网格中间折返，后面的块会再次用到前面块里的顶点
+    const uint32_t size = 300;
+    std::vector<Vertex> vertices;
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            vertices.emplace_back(Vector3{{float(x), float(y), 0.f}}, Vector2{{0.f, 0.f}},
+                                  uint32_t(vertices.size()));
+        }
+    }
+    std::vector<Index> triangles;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            Index i = y * (size + 1) + x;
+            triangles.insert(triangles.end(), {i, i + 1, i + size + 1, i + 1, i + size + 2, i + size + 1});
+        }
+    }
+    std::reverse(triangles.begin() + long(triangles.size() / 2), triangles.end());
+
+    std::vector<Index> lines;
+    std::vector<Index> points;
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+        lines.insert(lines.end(), {triangles[i], triangles[i + 1]});
+        points.push_back(triangles[i + 2]);
+    }
+    // 退化三角形：同一个顶点出现多次只算一次
+    std::vector<Index> degenerate = {0, 0, 0, 1, 1, 2, 3, 4, 5, 5, 6, 6};
+
+    bool ok = true;
+    ok = checkSplit(vertices, triangles, GL_TRIANGLES, 3, MeshWelder::kMaxShortIndexVertices, "三角形") && ok;
+    ok = checkSplit(vertices, triangles, GL_TRIANGLES, 3, 1000, "三角形") && ok;
+    ok = checkSplit(vertices, lines, GL_LINES, 2, MeshWelder::kMaxShortIndexVertices, "线段") && ok;
+    ok = checkSplit(vertices, points, GL_POINTS, 1, MeshWelder::kMaxShortIndexVertices, "点") && ok;
+    ok = checkSplit(vertices, degenerate, GL_TRIANGLES, 3, 3, "退化三角形") && ok;
+    return ok;
+}
+
+void bench(uint32_t size) {
+    Random random{11};
+    std::vector<Vertex> source;
+    std::vector<Index> sourceIndices;
+    makeUnindexedGrid(size, kEpsilon / 4.f, random, source, sourceIndices);
+    printf("%zu个顶点的焊接：\n", source.size());
+    for (size_t threads: {size_t(1), size_t(2), size_t(4), size_t(8)}) {
+        std::vector<Vertex> vertices = source;
+        std::vector<Index> indices = sourceIndices;
+        WeldOptions options;
+        options.positionEpsilon = kEpsilon;
+        options.threadCount = threads;
+        double start = nowSeconds();
+        size_t welded = MeshWelder::weld(vertices, indices, options);
+        double ms = (nowSeconds() - start) * 1e3;
+        printf("  %zu个线程 %8.1f ms，剩余%zu个顶点\n", threads, ms, welded);
+    }
+    for (Index i = 0; i < source.size(); i++) {
+        source[i].color = i;
+    }
+    double start = nowSeconds();
+    std::vector<MeshChunk> chunks = MeshWelder::split(source, sourceIndices, GL_TRIANGLES);
+    printf("%zu个顶点的切分：%.1f ms，%zu块\n", source.size(), (nowSeconds() - start) * 1e3, chunks.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t largeSize = argc > 1 ? uint32_t(std::max(1, atoi(argv[1]))) : 408;
+    bool ok = true;
+    ok = checkWeldGrid(128) && ok;
+    ok = checkWeldChain() && ok;
+    ok = checkWeldAttributes() && ok;
+    ok = checkSplits() && ok;
+    // 约100万个顶点
+    bench(largeSize);
+
+    printf(ok ? "焊接检查通过\n" : "焊接检查失败\n");
+    return ok ? 0 : 1;
+}
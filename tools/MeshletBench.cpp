@@ -0,0 +1,453 @@
+/*
+ * meshletbench：检查 MeshletBuilder 的分簇结果和 MeshletCuller 的剔除结果，并测量构建和剔除的耗时。
+ *
+ * 测试网格：起伏的地形、UV球（两极带退化三角形）、互不相连的随机三角形，以及约100万个三角形的地形。
+ * 每个网格分别用默认上限和更小的上限构建。
+ * 检查项：簇在索引缓冲中首尾相接，每个三角形（保持绕序）恰好落在一个簇中；每个簇的顶点数和三角形数
+ * 不超过上限，vertexCount 等于簇实际引用的不同顶点数；包围球包含簇的所有顶点；法线锥包含簇内所有
+ * 非退化三角形的法线；按分量存放的剔除数据与 Meshlet 一致。
+ * 剔除在随机的透视和正交视角下进行，参考实现逐个三角形在世界空间中判断：至少有一个顶点在裁剪空间内、
+ * 并且正对相机的三角形所在的簇必须可见（剔除只能保守）。单线程与多线程的结果相同；
+ * buildDrawRanges 和 compactIndices 的结果覆盖且只覆盖可见簇的索引。
+ * 用法：meshletbench [大网格的边长]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    float range(float low, float high) {
+        return low + (high - low) * (float(next()) / float(1u << 24));
+    }
+};
+
+struct Mesh {
+    std::string name;
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+};
+
+Mesh makeTerrain(uint32_t size) {
+    Mesh mesh;
+    mesh.name = "地形" + std::to_string(size) + "x" + std::to_string(size);
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            float u = float(x) / float(size), v = float(y) / float(size);
+            float height = 0.1f * std::sin(9.f * u) * std::cos(7.f * v) + 0.03f * std::sin(31.f * u + 17.f * v);
+            mesh.vertices.emplace_back(Vector3{{2.f * u - 1.f, height, 2.f * v - 1.f}}, Vector2{{u, v}});
+        }
+    }
+    // 法线朝+y
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            Index i = y * (size + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2});
+        }
+    }
+    return mesh;
+}
+
+Mesh makeSphere(uint32_t rings, uint32_t segments) {
+    Mesh mesh;
+    mesh.name = "UV球";
+    for (uint32_t r = 0; r <= rings; r++) {
+        float theta = float(M_PI) * float(r) / float(rings);
+        for (uint32_t s = 0; s <= segments; s++) {
+            float phi = 2.f * float(M_PI) * float(s) / float(segments);
+            mesh.vertices.emplace_back(
+                    Vector3{{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)}},
+                    Vector2{{float(s) / float(segments), float(r) / float(rings)}});
+        }
+    }
+    // 法线朝外，两极的退化三角形保留
+    for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            Index i = r * (segments + 1) + s;
+            Index below = i + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {i, i + 1, below, i + 1, below + 1, below});
+        }
+    }
+    return mesh;
+}
+
+Mesh makeSoup(uint32_t count, Random &random) {
+    Mesh mesh;
+    mesh.name = "随机三角形";
+    for (uint32_t t = 0; t < count; t++) {
+        float cx = random.range(-1.f, 1.f), cy = random.range(-1.f, 1.f), cz = random.range(-1.f, 1.f);
+        for (int corner = 0; corner < 3; corner++) {
+            mesh.vertices.emplace_back(Vector3{{cx + random.range(-0.05f, 0.05f), cy + random.range(-0.05f, 0.05f),
+                                                cz + random.range(-0.05f, 0.05f)}},
+                                       Vector2{{0.f, 0.f}});
+            mesh.indices.push_back(Index(mesh.vertices.size() - 1));
+        }
+    }
+    return mesh;
+}
+
+struct Normal {
+    float x, y, z;
+    bool valid;
+};
+
+Normal triangleNormal(const std::vector<Vertex> &vertices, const Index *tri) {
+    const Vector3 &p0 = vertices[tri[0]].position;
+    const Vector3 &p1 = vertices[tri[1]].position;
+    const Vector3 &p2 = vertices[tri[2]].position;
+    float e1x = p1.x - p0.x, e1y = p1.y - p0.y, e1z = p1.z - p0.z;
+    float e2x = p2.x - p0.x, e2y = p2.y - p0.y, e2z = p2.z - p0.z;
+    float nx = e1y * e2z - e1z * e2y, ny = e1z * e2x - e1x * e2z, nz = e1x * e2y - e1y * e2x;
+    float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (length <= 0.f) {
+        return Normal{0.f, 0.f, 0.f, false};
+    }
+    return Normal{nx / length, ny / length, nz / length, true};
+}
+
+struct Triangle {
+    Index a, b, c;
+
+    bool operator<(const Triangle &other) const {
+        return a != other.a ? a < other.a : b != other.b ? b < other.b : c < other.c;
+    }
+
+    bool operator==(const Triangle &other) const {
+        return a == other.a && b == other.b && c == other.c;
+    }
+};
+
+std::vector<Triangle> sortedTriangles(const std::vector<Index> &indices) {
+    std::vector<Triangle> result;
+    result.reserve(indices.size() / 3);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        result.push_back(Triangle{indices[i], indices[i + 1], indices[i + 2]});
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool checkBuild(const Mesh &mesh, const MeshletMesh &meshlets, size_t maxVertices, size_t maxTriangles) {
+    // 簇首尾相接覆盖整个索引缓冲，三角形的多重集合不变
+    uint32_t offset = 0;
+    for (const Meshlet &meshlet: meshlets.meshlets) {
+        if (meshlet.indexOffset != offset || meshlet.triangleCount == 0) {
+            printf("  簇的索引范围不连续（偏移 %u，应为 %u）\n", meshlet.indexOffset, offset);
+            return false;
+        }
+        offset += meshlet.triangleCount * 3;
+    }
+    if (offset != meshlets.indices.size() || sortedTriangles(meshlets.indices) != sortedTriangles(mesh.indices)) {
+        printf("  三角形没有恰好分到一个簇中\n");
+        return false;
+    }
+
+    std::vector<uint32_t> seen(mesh.vertices.size(), ~0u);
+    for (size_t m = 0; m < meshlets.meshlets.size(); m++) {
+        const Meshlet &meshlet = meshlets.meshlets[m];
+        const Index *begin = &meshlets.indices[meshlet.indexOffset];
+        const Index *end = begin + meshlet.triangleCount * 3;
+        uint32_t distinct = 0;
+        float radius = meshlet.radius * (1.f + 1e-5f) + 1e-6f;
+        for (const Index *index = begin; index != end; index++) {
+            if (seen[*index] != m) {
+                seen[*index] = uint32_t(m);
+                distinct++;
+            }
+            const Vector3 &p = mesh.vertices[*index].position;
+            float dx = p.x - meshlet.center[0], dy = p.y - meshlet.center[1], dz = p.z - meshlet.center[2];
+            if (dx * dx + dy * dy + dz * dz > radius * radius) {
+                printf("  簇%zu的包围球不包含顶点%u\n", m, *index);
+                return false;
+            }
+        }
+        if (distinct != meshlet.vertexCount || distinct > maxVertices || meshlet.triangleCount > maxTriangles) {
+            printf("  簇%zu有%u个顶点（记录为%u）、%u个三角形，上限 %zu/%zu\n", m, distinct, meshlet.vertexCount,
+                   meshlet.triangleCount, maxVertices, maxTriangles);
+            return false;
+        }
+        if (meshlet.coneCutoff < 1.f) {
+            // 法线与轴的夹角不超过半角，留一点舍入余量
+            float minDot = std::sqrt(1.f - meshlet.coneCutoff * meshlet.coneCutoff) - 1e-4f;
+            for (const Index *tri = begin; tri != end; tri += 3) {
+                Normal n = triangleNormal(mesh.vertices, tri);
+                if (n.valid && n.x * meshlet.coneAxis[0] + n.y * meshlet.coneAxis[1] + n.z * meshlet.coneAxis[2]
+                               < minDot) {
+                    printf("  簇%zu的法线锥不包含三角形%zu的法线\n", m, size_t(tri - meshlets.indices.data()) / 3);
+                    return false;
+                }
+            }
+        }
+        if (meshlets.centerX[m] != meshlet.center[0] || meshlets.centerY[m] != meshlet.center[1]
+            || meshlets.centerZ[m] != meshlet.center[2] || meshlets.radius[m] != meshlet.radius
+            || meshlets.axisX[m] != meshlet.coneAxis[0] || meshlets.axisY[m] != meshlet.coneAxis[1]
+            || meshlets.axisZ[m] != meshlet.coneAxis[2] || meshlets.cutoff[m] != meshlet.coneCutoff) {
+            printf("  簇%zu按分量存放的剔除数据与 Meshlet 不一致\n", m);
+            return false;
+        }
+    }
+    if (meshlets.centerX.size() % 4 != 0 || meshlets.centerX.size() < meshlets.meshlets.size()) {
+        printf("  剔除数据没有补齐到4的倍数\n");
+        return false;
+    }
+    return true;
+}
+
+struct View {
+    Mat4 viewProjection;
+    Mat4 model;
+    Vec3 cameraPosition; // 世界空间
+    Vec3 viewDirection;  // 世界空间，单位向量
+    bool isOrthographic;
+};
+
+// 相机在包围网格的球面附近，看向原点附近的随机一点，有时背对网格
+View randomView(Random &random, bool orthographic) {
+    View view;
+    float theta = random.range(0.f, float(M_PI)), phi = random.range(0.f, 2.f * float(M_PI));
+    float distance = random.range(0.5f, 3.f);
+    float px = distance * std::sin(theta) * std::cos(phi), py = distance * std::cos(theta);
+    float pz = distance * std::sin(theta) * std::sin(phi);
+    float tx = random.range(-0.5f, 0.5f), ty = random.range(-0.5f, 0.5f), tz = random.range(-0.5f, 0.5f);
+    if (random.next() % 4 == 0) {
+        tx = 2.f * px, ty = 2.f * py, tz = 2.f * pz;
+    }
+    float fx = tx - px, fy = ty - py, fz = tz - pz;
+    float length = std::sqrt(fx * fx + fy * fy + fz * fz);
+    fx /= length, fy /= length, fz /= length;
+    // 右 = 前 x 上（上取y轴，前方接近y轴时取z轴）
+    float ux = 0.f, uy = 1.f, uz = 0.f;
+    if (std::fabs(fy) > 0.99f) {
+        uy = 0.f, uz = 1.f;
+    }
+    float rx = fy * uz - fz * uy, ry = fz * ux - fx * uz, rz = fx * uy - fy * ux;
+    length = std::sqrt(rx * rx + ry * ry + rz * rz);
+    rx /= length, ry /= length, rz /= length;
+    ux = ry * fz - rz * fy, uy = rz * fx - rx * fz, uz = rx * fy - ry * fx;
+    const float cameraWorld[16] = {rx, ry, rz, 0.f, ux, uy, uz, 0.f, -fx, -fy, -fz, 0.f, px, py, pz, 1.f};
+    Mat4 viewMatrix;
+    inverse(Mat4::fromArray(cameraWorld), viewMatrix);
+
+    view.isOrthographic = orthographic;
+    Mat4 projection = orthographic ? Mat4::orthographic(random.range(0.2f, 1.f), 1.5f, 0.1f, 10.f)
+                                   : Mat4::perspective(random.range(30.f, 90.f), 1.5f, 0.1f, 10.f);
+    view.viewProjection = projection * viewMatrix;
+    // 模型矩阵带旋转、平移和非均匀缩放（正的行列式）
+    view.model = Mat4::fromTRS(
+            Vec3{random.range(-0.2f, 0.2f), random.range(-0.2f, 0.2f), random.range(-0.2f, 0.2f), 0.f},
+            Quat::fromEulerDegrees(random.range(-180.f, 180.f), random.range(-180.f, 180.f),
+                                   random.range(-180.f, 180.f)),
+            Vec3{random.range(0.5f, 1.5f), random.range(0.5f, 1.5f), random.range(0.5f, 1.5f), 0.f});
+    view.cameraPosition = Vec3{px, py, pz, 0.f};
+    view.viewDirection = Vec3{fx, fy, fz, 0.f};
+    return view;
+}
+
+CullingView cullingView(const View &view) {
+    return view.isOrthographic ? CullingView::orthographic(view.viewProjection, view.model, view.viewDirection)
+                               : CullingView::perspective(view.viewProjection, view.model, view.cameraPosition);
+}
+
+// 参考实现：世界空间中逐个三角形判断，明确可见的三角形（留一点余量，避开舍入的边界情况）
+std::vector<uint8_t> surelyVisibleTriangles(const std::vector<Vertex> &vertices, const std::vector<Index> &indices,
+                                            const View &view, bool backfaceCulling) {
+    const Mat4 clip = view.viewProjection * view.model;
+    std::vector<uint8_t> visible(indices.size() / 3, 0);
+    for (size_t t = 0; t < visible.size(); t++) {
+        const Index *tri = &indices[t * 3];
+        bool inside = false;
+        Vec3 world[3];
+        for (int corner = 0; corner < 3; corner++) {
+            const Vector3 &p = vertices[tri[corner]].position;
+            Vec4 c = clip * Vec4{p.x, p.y, p.z, 1.f};
+            float margin = 0.999f * c.w;
+            inside |= c.w > 0.f && std::fabs(c.x) < margin && std::fabs(c.y) < margin && std::fabs(c.z) < margin;
+            world[corner] = transformPoint(view.model, Vec3{p.x, p.y, p.z, 0.f});
+        }
+        if (!inside) {
+            continue;
+        }
+        if (backfaceCulling) {
+            float e1x = world[1].x - world[0].x, e1y = world[1].y - world[0].y, e1z = world[1].z - world[0].z;
+            float e2x = world[2].x - world[0].x, e2y = world[2].y - world[0].y, e2z = world[2].z - world[0].z;
+            float nx = e1y * e2z - e1z * e2y, ny = e1z * e2x - e1x * e2z, nz = e1x * e2y - e1y * e2x;
+            float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+            float dx = view.viewDirection.x, dy = view.viewDirection.y, dz = view.viewDirection.z;
+            if (!view.isOrthographic) {
+                dx = world[0].x - view.cameraPosition.x;
+                dy = world[0].y - view.cameraPosition.y;
+                dz = world[0].z - view.cameraPosition.z;
+                float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                dx /= distance, dy /= distance, dz /= distance;
+            }
+            // 法线与视线的夹角明显大于90度才算正对相机。几乎退化的细长三角形（例如两极附近两个顶点只差
+            // 一点舍入误差）的法线方向由舍入决定，也光栅化不出像素，不作要求
+            float e1 = std::sqrt(e1x * e1x + e1y * e1y + e1z * e1z);
+            float e2 = std::sqrt(e2x * e2x + e2y * e2y + e2z * e2z);
+            if (length <= 1e-4f * e1 * e2 || (nx * dx + ny * dy + nz * dz) / length > -1e-3f) {
+                continue;
+            }
+        }
+        visible[t] = 1;
+    }
+    return visible;
+}
+
+bool checkCulling(const Mesh &mesh, const MeshletMesh &meshlets, Random &random) {
+    std::vector<uint8_t> visible, visibleThreads, visibleAll;
+    std::vector<DrawRange> ranges;
+    std::vector<Index> compact;
+    for (int v = 0; v < 40; v++) {
+        View view = randomView(random, v % 2 == 1);
+        CullingView culling = cullingView(view);
+        culling.backfaceCulling = v % 4 != 2;
+
+        size_t count = MeshletCuller::cull(meshlets, culling, visible, 1);
+        size_t countThreads = MeshletCuller::cull(meshlets, culling, visibleThreads, 3);
+        size_t countAll = MeshletCuller::cull(meshlets, culling, visibleAll, 0);
+        if (visibleThreads != visible || visibleAll != visible || countThreads != count || countAll != count
+            || size_t(std::count(visible.begin(), visible.end(), uint8_t(1))) != count) {
+            printf("  视角%d：多线程剔除的结果与单线程不同\n", v);
+            return false;
+        }
+
+        std::vector<uint8_t> reference = surelyVisibleTriangles(mesh.vertices, meshlets.indices, view,
+                                                                culling.backfaceCulling);
+        for (size_t m = 0; m < meshlets.meshlets.size(); m++) {
+            const Meshlet &meshlet = meshlets.meshlets[m];
+            for (uint32_t t = 0; t < meshlet.triangleCount && !visible[m]; t++) {
+                if (reference[meshlet.indexOffset / 3 + t]) {
+                    printf("  视角%d（%s）：簇%zu被剔除，但其中的三角形%u可见\n", v,
+                           view.isOrthographic ? "正交" : "透视", m, meshlet.indexOffset / 3 + t);
+                    return false;
+                }
+            }
+        }
+
+        // 绘制范围按顺序排列、互不相邻，并且恰好覆盖可见簇
+        size_t triangles = MeshletCuller::buildDrawRanges(meshlets, visible, ranges);
+        MeshletCuller::compactIndices(meshlets, visible, compact);
+        std::vector<Index> fromRanges;
+        size_t expectedTriangles = 0;
+        for (size_t m = 0; m < meshlets.meshlets.size(); m++) {
+            expectedTriangles += visible[m] ? meshlets.meshlets[m].triangleCount : 0;
+        }
+        bool rangesOk = triangles == expectedTriangles && compact.size() == triangles * 3;
+        for (size_t r = 0; r < ranges.size() && rangesOk; r++) {
+            rangesOk = ranges[r].indexCount > 0
+                       && (r == 0 || ranges[r].indexOffset > ranges[r - 1].indexOffset + ranges[r - 1].indexCount);
+            auto begin = meshlets.indices.begin() + ranges[r].indexOffset;
+            fromRanges.insert(fromRanges.end(), begin, begin + ranges[r].indexCount);
+        }
+        if (!rangesOk || fromRanges != compact) {
+            printf("  视角%d：绘制范围或紧凑索引与可见簇不一致\n", v);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkMesh(const Mesh &mesh, size_t maxVertices, size_t maxTriangles, Random &random) {
+    double start = nowSeconds();
+    MeshletMesh meshlets = MeshletBuilder::build(mesh.vertices, mesh.indices, maxVertices, maxTriangles);
+    double buildMs = (nowSeconds() - start) * 1e3;
+    bool ok = checkBuild(mesh, meshlets, maxVertices, maxTriangles);
+    ok = ok && checkCulling(mesh, meshlets, random);
+
+    size_t vertexSum = 0, triangleSum = 0;
+    for (const Meshlet &meshlet: meshlets.meshlets) {
+        vertexSum += meshlet.vertexCount;
+        triangleSum += meshlet.triangleCount;
+    }
+    double count = double(std::max<size_t>(1, meshlets.meshlets.size()));
+    printf("%s，上限 %zu/%zu：%zu个簇，平均 %.1f 个顶点、%.1f 个三角形，构建 %.2f ms：%s\n", mesh.name.c_str(),
+           maxVertices, maxTriangles, meshlets.meshlets.size(), double(vertexSum) / count,
+           double(triangleSum) / count, buildMs, ok ? "正确" : "错误");
+    return ok;
+}
+
+void benchLarge(uint32_t size, Random &random) {
+    Mesh mesh = makeTerrain(size);
+    MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    double start = nowSeconds();
+    MeshletMesh meshlets = MeshletBuilder::build(mesh.vertices, mesh.indices);
+    double buildMs = (nowSeconds() - start) * 1e3;
+    printf("%s（%zu个三角形）：构建 %.0f ms，%zu个簇\n", mesh.name.c_str(), mesh.indices.size() / 3, buildMs,
+           meshlets.meshlets.size());
+
+    const int rounds = 200;
+    std::vector<View> views;
+    for (int r = 0; r < rounds; r++) {
+        views.push_back(randomView(random, r % 2 == 1));
+    }
+    std::vector<uint8_t> visible;
+    std::vector<DrawRange> ranges;
+    const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts = {1};
+    if (hardwareThreads > 1) {
+        threadCounts.push_back(hardwareThreads);
+    }
+    for (size_t threads: threadCounts) {
+        size_t visibleMeshlets = 0, visibleTriangles = 0, rangeCount = 0;
+        double cullSeconds = 0, rangeSeconds = 0;
+        for (const View &view: views) {
+            CullingView culling = cullingView(view);
+            start = nowSeconds();
+            visibleMeshlets += MeshletCuller::cull(meshlets, culling, visible, threads);
+            cullSeconds += nowSeconds() - start;
+            start = nowSeconds();
+            visibleTriangles += MeshletCuller::buildDrawRanges(meshlets, visible, ranges);
+            rangeSeconds += nowSeconds() - start;
+            rangeCount += ranges.size();
+        }
+        printf("  %zu个线程：剔除 %.3f ms，合并绘制范围 %.3f ms；平均可见 %.1f%% 的簇、%.1f%% 的三角形，"
+               "%.0f 次绘制\n", threads, cullSeconds * 1e3 / rounds, rangeSeconds * 1e3 / rounds,
+               100.0 * double(visibleMeshlets) / double(rounds * meshlets.meshlets.size()),
+               100.0 * double(visibleTriangles) / double(rounds * (mesh.indices.size() / 3)),
+               double(rangeCount) / rounds);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t largeSize = argc > 1 ? uint32_t(std::max(2, atoi(argv[1]))) : 708;
+    printf("后端：%s\n", kVecMathBackend);
+    Random random{5};
+    bool ok = true;
+
+    const Mesh meshes[] = {makeTerrain(96), makeSphere(64, 128), makeSoup(5000, random)};
+    for (const Mesh &mesh: meshes) {
+        ok = checkMesh(mesh, MeshletBuilder::kMaxVertices, MeshletBuilder::kMaxTriangles, random) && ok;
+        ok = checkMesh(mesh, 32, 16, random) && ok;
+        ok = checkMesh(mesh, 3, 1, random) && ok;
+    }
+    // 簇数超过 kMinMeshletsPerThread 时才会用多个线程剔除
+    ok = checkMesh(makeTerrain(300), 3, 1, random) && ok;
+
+    benchLarge(largeSize, random);
+
+    printf(ok ? "簇构建与剔除检查通过\n" : "簇构建与剔除检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+/*
+ * meshoptbench：EXT_meshopt_compression编码/解码的往返校验和解码吞吐量测试。
+ *
+ * 按gltfpack的典型布局准备顶点流：uint16位置（8字节）、八面体int8法线（4字节）、unorm16 uv（4字节），
+ * 以及指数过滤的float位置。每个流编码后先解码并与原数据比较，再重复解码测量吞吐量。
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "GltfLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshoptEncoder.h"
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+struct Mesh {
+    std::vector<Vertex> vertices;
+    std::vector<Vector3> normals;
+    std::vector<Index> indices;
+};
+
+// 带起伏的球面，法线取径向
+Mesh makeSphere(int segments) {
+    Mesh mesh;
+    for (int j = 0; j <= segments; j++) {
+        for (int i = 0; i <= segments; i++) {
+            float u = float(i) / float(segments);
+            float v = float(j) / float(segments);
+            float theta = u * 2.f * kPi;
+            float phi = v * kPi;
+            Vector3 n = {{std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)}};
+            float r = 1.f + 0.05f * std::sin(8.f * theta) * std::sin(6.f * phi);
+            mesh.vertices.emplace_back(Vector3{{n.x * r, n.y * r, n.z * r}}, Vector2{{u, v}});
+            mesh.normals.push_back(n);
+        }
+    }
+    for (int j = 0; j < segments; j++) {
+        for (int i = 0; i < segments; i++) {
+            Index a = j * (segments + 1) + i;
+            Index c = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, c, a + 1, a + 1, c, c + 1});
+        }
+    }
+    return mesh;
+}
+
+bool loadMesh(const char *path, Mesh &mesh) {
+    auto scene = GltfLoader::load(path);
+    if (!scene || scene->meshes.empty() || scene->meshes[0].primitives.empty()) {
+        return false;
+    }
+    const GltfPrimitive &primitive = scene->meshes[0].primitives[0];
+    VertexStreams streams = primitive.vertexStreams();
+    IndexStream indices = primitive.indexStream();
+    for (size_t i = 0; i < streams.count; i++) {
+        mesh.vertices.push_back(streams.fetch(i));
+    }
+    for (size_t i = 0; i < indices.count; i++) {
+        mesh.indices.push_back(indices.fetch(i));
+    }
+    // 法线不在 VertexStreams 中，用面法线累加
+    mesh.normals.assign(mesh.vertices.size(), Vector3{{0.f, 0.f, 0.f}});
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        const Vector3 &a = mesh.vertices[mesh.indices[t]].position;
+        const Vector3 &b = mesh.vertices[mesh.indices[t + 1]].position;
+        const Vector3 &c = mesh.vertices[mesh.indices[t + 2]].position;
+        float e1[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+        float e2[3] = {c.x - a.x, c.y - a.y, c.z - a.z};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        for (size_t k = 0; k < 3; k++) {
+            for (int axis = 0; axis < 3; axis++) {
+                mesh.normals[mesh.indices[t + k]].idx[axis] += n[axis];
+            }
+        }
+    }
+    for (Vector3 &n: mesh.normals) {
+        float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        n = length > 0.f ? Vector3{{n.x / length, n.y / length, n.z / length}} : Vector3{{0.f, 0.f, 1.f}};
+    }
+    return true;
+}
+
+template<typename Decode>
+double bestSeconds(int repeats, Decode decode) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        decode();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+void report(const char *name, size_t rawSize, size_t encodedSize, double seconds) {
+    printf("%-22s %9zu -> %9zu 字节 (%5.1f%%)  解码 %7.3f ms  %6.2f GB/s\n", name, rawSize, encodedSize,
+           100.0 * double(encodedSize) / double(rawSize), seconds * 1e3, double(rawSize) / seconds / 1e9);
+}
+
+// 编码一个顶点流，校验往返结果并测量解码速度
+bool benchVertices(const char *name, const std::vector<uint8_t> &raw, size_t stride, int repeats) {
+    size_t count = raw.size() / stride;
+    std::vector<uint8_t> encoded = MeshoptEncoder::encodeVertexBuffer(raw.data(), count, stride);
+    std::vector<uint8_t> decoded(raw.size());
+    if (!MeshoptDecoder::decodeVertexBuffer(decoded.data(), count, stride, encoded.data(), encoded.size())
+        || decoded != raw) {
+        printf("%s: 往返结果不一致\n", name);
+        return false;
+    }
+    double seconds = bestSeconds(repeats, [&] {
+        MeshoptDecoder::decodeVertexBuffer(decoded.data(), count, stride, encoded.data(), encoded.size());
+    });
+    report(name, raw.size(), encoded.size(), seconds);
+    return true;
+}
+
+// 编码器会旋转三角形（保持绕序）来提高压缩率，逐个三角形比较时允许旋转
+bool sameTriangles(const std::vector<uint32_t> &a, const std::vector<Index> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i + 2 < a.size(); i += 3) {
+        bool match = false;
+        for (int rotation = 0; rotation < 3 && !match; rotation++) {
+            match = a[i] == b[i + rotation] && a[i + 1] == b[i + (rotation + 1) % 3]
+                    && a[i + 2] == b[i + (rotation + 2) % 3];
+        }
+        if (!match) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+std::vector<uint8_t> bytesOf(const std::vector<T> &values) {
+    auto *begin = reinterpret_cast<const uint8_t *>(values.data());
+    return std::vector<uint8_t>(begin, begin + values.size() * sizeof(T));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Mesh mesh;
+    int repeats = 20;
+    if (argc > 1) {
+        if (!loadMesh(argv[1], mesh)) {
+            fprintf(stderr, "无法加载 %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        mesh = makeSphere(700);
+    }
+    if (argc > 2) {
+        repeats = std::max(1, atoi(argv[2]));
+    }
+    MeshOptimizer::optimize(mesh.vertices, mesh.indices);
+    // optimize会重排顶点，法线按位置重新取径向或保持原样
+    if (argc <= 1) {
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            const Vector3 &p = mesh.vertices[i].position;
+            float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+            mesh.normals[i] = Vector3{{p.x / length, p.y / length, p.z / length}};
+        }
+    } else {
+        mesh.normals.resize(mesh.vertices.size(), Vector3{{0.f, 0.f, 1.f}});
+    }
+    size_t vertexCount = mesh.vertices.size();
+    printf("%zu 顶点，%zu 三角形\n", vertexCount, mesh.indices.size() / 3);
+
+    // KHR_mesh_quantization的典型布局：位置量化成uint16（第4个分量补齐），uv为unorm16
+    float minimum[3] = {1e30f, 1e30f, 1e30f};
+    float maximum[3] = {-1e30f, -1e30f, -1e30f};
+    for (const Vertex &vertex: mesh.vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            minimum[axis] = std::min(minimum[axis], vertex.position.idx[axis]);
+            maximum[axis] = std::max(maximum[axis], vertex.position.idx[axis]);
+        }
+    }
+    float extent = std::max({maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2], 1e-20f});
+    std::vector<uint16_t> positions;
+    std::vector<uint16_t> uvs;
+    std::vector<float> floatPositions;
+    std::vector<float> normals;
+    for (size_t i = 0; i < vertexCount; i++) {
+        const Vertex &vertex = mesh.vertices[i];
+        for (int axis = 0; axis < 3; axis++) {
+            float value = (vertex.position.idx[axis] - minimum[axis]) / extent;
+            positions.push_back(uint16_t(std::lround(value * 65535.f)));
+            floatPositions.push_back(vertex.position.idx[axis]);
+            normals.push_back(mesh.normals[i].idx[axis]);
+        }
+        positions.push_back(0);
+        normals.push_back(0.f);
+        for (int component = 0; component < 2; component++) {
+            float value = std::min(1.f, std::max(0.f, vertex.uv.idx[component]));
+            uvs.push_back(uint16_t(std::lround(value * 65535.f)));
+        }
+    }
+    std::vector<uint8_t> octNormals(vertexCount * 4);
+    MeshoptEncoder::encodeOctahedral(octNormals.data(), vertexCount, 4, 8, normals.data());
+    std::vector<uint8_t> expPositions(vertexCount * 12);
+    MeshoptEncoder::encodeExponential(expPositions.data(), vertexCount, 12, 15, floatPositions.data());
+
+    bool ok = benchVertices("位置 uint16x4", bytesOf(positions), 8, repeats)
+              && benchVertices("法线 八面体int8x4", octNormals, 4, repeats)
+              && benchVertices("uv unorm16x2", bytesOf(uvs), 4, repeats)
+              && benchVertices("位置 指数过滤float3", expPositions, 12, repeats);
+
+    // 过滤器：解码后与原始float比较
+    std::vector<uint8_t> filtered = octNormals;
+    double octSeconds = bestSeconds(repeats, [&] {
+        memcpy(filtered.data(), octNormals.data(), octNormals.size());
+        MeshoptDecoder::applyFilter(MeshoptFilter::Octahedral, filtered.data(), vertexCount, 4);
+    });
+    float octError = 0.f;
+    for (size_t i = 0; i < vertexCount; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            octError = std::max(octError, std::fabs(float(int8_t(filtered[i * 4 + axis])) / 127.f - normals[i * 4 + axis]));
+        }
+    }
+    filtered = expPositions;
+    double expSeconds = bestSeconds(repeats, [&] {
+        memcpy(filtered.data(), expPositions.data(), expPositions.size());
+        MeshoptDecoder::applyFilter(MeshoptFilter::Exponential, filtered.data(), vertexCount, 12);
+    });
+    float expError = 0.f;
+    for (size_t i = 0; i < floatPositions.size(); i++) {
+        float value;
+        memcpy(&value, filtered.data() + i * 4, sizeof(value));
+        expError = std::max(expError, std::fabs(value - floatPositions[i]));
+    }
+    printf("八面体过滤 %7.3f ms，最大误差 %g；指数过滤 %7.3f ms，最大误差 %g\n", octSeconds * 1e3, octError,
+           expSeconds * 1e3, expError);
+    ok = ok && octError < 0.02f && expError < extent * 1e-4f;
+
+    std::vector<uint8_t> encodedIndices = MeshoptEncoder::encodeIndexBuffer(
+            mesh.indices.data(), mesh.indices.size(), vertexCount);
+    std::vector<uint32_t> decodedIndices(mesh.indices.size());
+    bool indicesOk = MeshoptDecoder::decodeIndexBuffer(decodedIndices.data(), decodedIndices.size(), 4,
+                                                       encodedIndices.data(), encodedIndices.size())
+                     && sameTriangles(decodedIndices, mesh.indices);
+    if (!indicesOk) {
+        printf("三角形索引往返结果不一致\n");
+    } else {
+        double seconds = bestSeconds(repeats, [&] {
+            MeshoptDecoder::decodeIndexBuffer(decodedIndices.data(), decodedIndices.size(), 4,
+                                              encodedIndices.data(), encodedIndices.size());
+        });
+        report("三角形索引 uint32", mesh.indices.size() * 4, encodedIndices.size(), seconds);
+    }
+
+    std::vector<uint8_t> encodedSequence = MeshoptEncoder::encodeIndexSequence(
+            mesh.indices.data(), mesh.indices.size(), vertexCount);
+    bool sequenceOk = MeshoptDecoder::decodeIndexSequence(decodedIndices.data(), decodedIndices.size(), 4,
+                                                          encodedSequence.data(), encodedSequence.size())
+                      && decodedIndices == mesh.indices;
+    if (!sequenceOk) {
+        printf("索引序列往返结果不一致\n");
+    } else {
+        double seconds = bestSeconds(repeats, [&] {
+            MeshoptDecoder::decodeIndexSequence(decodedIndices.data(), decodedIndices.size(), 4,
+                                                encodedSequence.data(), encodedSequence.size());
+        });
+        report("索引序列 uint32", mesh.indices.size() * 4, encodedSequence.size(), seconds);
+    }
+
+    ok = ok && indicesOk && sequenceOk;
+    printf(ok ? "往返校验通过\n" : "往返校验失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+#include "MeshoptEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t kVertexHeader = 0xA0;
+constexpr uint8_t kIndexHeader = 0xE1;    // 第1版
+constexpr uint8_t kSequenceHeader = 0xD1; // 第1版
+
+constexpr size_t kVertexBlockSizeBytes = 8192;
+constexpr size_t kVertexBlockMaxSize = 256;
+constexpr size_t kByteGroupSize = 16;
+constexpr size_t kTailMinSize = 32;
+
+// 由训练网格统计出的辅助码表，与meshoptimizer相同，写在索引码流末尾
+constexpr uint8_t kCodeAuxTable[16] = {
+        0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xA9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00};
+
+constexpr int kTriangleIndexOrder[3][3] = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1}};
+
+size_t vertexBlockSize(size_t stride) {
+    size_t size = (kVertexBlockSizeBytes / stride) & ~(kByteGroupSize - 1);
+    return std::min(size, kVertexBlockMaxSize);
+}
+
+inline uint8_t zigzag8(uint8_t value) {
+    return uint8_t((int8_t(value) >> 7) ^ (value << 1));
+}
+
+// 一组16个值用bits位编码时的字节数，bits为0时只有全0才能编码
+size_t measureGroup(const uint8_t *values, int bits) {
+    if (bits == 0) {
+        return std::all_of(values, values + kByteGroupSize, [](uint8_t v) { return v == 0; }) ? 0 : SIZE_MAX;
+    }
+    if (bits == 8) {
+        return kByteGroupSize;
+    }
+    size_t size = kByteGroupSize * bits / 8;
+    auto sentinel = uint8_t((1u << bits) - 1u);
+    for (size_t i = 0; i < kByteGroupSize; i++) {
+        size += values[i] >= sentinel;
+    }
+    return size;
+}
+
+void encodeGroup(std::vector<uint8_t> &out, const uint8_t *values, int bits) {
+    if (bits == 0) {
+        return;
+    }
+    if (bits == 8) {
+        out.insert(out.end(), values, values + kByteGroupSize);
+        return;
+    }
+    int perByte = 8 / bits;
+    auto sentinel = uint8_t((1u << bits) - 1u);
+    for (size_t i = 0; i < kByteGroupSize; i += perByte) {
+        uint8_t byte = 0;
+        for (int k = 0; k < perByte; k++) {
+            byte = uint8_t((byte << bits) | std::min(values[i + k], sentinel));
+        }
+        out.push_back(byte);
+    }
+    for (size_t i = 0; i < kByteGroupSize; i++) {
+        if (values[i] >= sentinel) {
+            out.push_back(values[i]);
+        }
+    }
+}
+
+void encodeBytes(std::vector<uint8_t> &out, const uint8_t *values, size_t size) {
+    size_t header = out.size();
+    out.resize(out.size() + (size / kByteGroupSize + 3) / 4, 0);
+    static const int kBits[4] = {0, 2, 4, 8};
+    for (size_t i = 0; i < size; i += kByteGroupSize) {
+        int best = 3;
+        size_t bestSize = kByteGroupSize;
+        for (int option = 0; option < 3; option++) {
+            size_t groupSize = measureGroup(values + i, kBits[option]);
+            if (groupSize < bestSize) {
+                best = option;
+                bestSize = groupSize;
+            }
+        }
+        size_t group = i / kByteGroupSize;
+        out[header + group / 4] |= uint8_t(best << ((group % 4) * 2));
+        encodeGroup(out, values + i, kBits[best]);
+    }
+}
+
+void encodeVByte(std::vector<uint8_t> &out, uint32_t value) {
+    do {
+        out.push_back(uint8_t((value & 127u) | (value > 127 ? 128u : 0u)));
+        value >>= 7;
+    } while (value);
+}
+
+void encodeIndex(std::vector<uint8_t> &out, uint32_t index, uint32_t last) {
+    uint32_t delta = index - last;
+    encodeVByte(out, (delta << 1) ^ uint32_t(int32_t(delta) >> 31));
+}
+
+int findVertex(const uint32_t (&fifo)[16], uint32_t v, size_t offset) {
+    for (int i = 0; i < 16; i++) {
+        if (fifo[(offset - 1 - i) & 15] == v) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 返回 (FIFO位置 << 2) | 旋转，三角形的某条边与FIFO中的边相同时可以只编码第三个顶点
+int findEdge(const uint32_t (&fifo)[16][2], uint32_t a, uint32_t b, uint32_t c, size_t offset) {
+    for (int i = 0; i < 16; i++) {
+        size_t index = (offset - 1 - i) & 15;
+        uint32_t e0 = fifo[index][0];
+        uint32_t e1 = fifo[index][1];
+        if (e0 == a && e1 == b) return (i << 2) | 0;
+        if (e0 == b && e1 == c) return (i << 2) | 1;
+        if (e0 == c && e1 == a) return (i << 2) | 2;
+    }
+    return -1;
+}
+
+int quantizeSnorm(float value, int bits) {
+    auto scale = float((1 << (bits - 1)) - 1);
+    value = std::min(1.f, std::max(-1.f, value));
+    return int(value * scale + (value >= 0.f ? 0.5f : -0.5f));
+}
+
+} // namespace
+
+std::vector<uint8_t> MeshoptEncoder::encodeVertexBuffer(const void *vertices, size_t count, size_t stride) {
+    std::vector<uint8_t> out;
+    if (stride == 0 || stride > 256 || stride % 4 != 0) {
+        return out;
+    }
+    auto *data = static_cast<const uint8_t *>(vertices);
+    out.push_back(kVertexHeader);
+
+    // 第一个顶点作为基准写在尾部，第一块的差分相对它计算
+    uint8_t first[256] = {};
+    if (count > 0) {
+        memcpy(first, data, stride);
+    }
+    uint8_t last[256];
+    memcpy(last, first, stride);
+
+    size_t blockSize = vertexBlockSize(stride);
+    uint8_t deltas[kVertexBlockMaxSize];
+    for (size_t offset = 0; offset < count; offset += blockSize) {
+        size_t n = std::min(blockSize, count - offset);
+        size_t alignedCount = (n + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+        const uint8_t *block = data + offset * stride;
+        for (size_t k = 0; k < stride; k++) {
+            uint8_t previous = last[k];
+            for (size_t i = 0; i < n; i++) {
+                uint8_t value = block[i * stride + k];
+                deltas[i] = zigzag8(uint8_t(value - previous));
+                previous = value;
+            }
+            std::fill(deltas + n, deltas + alignedCount, 0);
+            encodeBytes(out, deltas, alignedCount);
+        }
+        memcpy(last, block + (n - 1) * stride, stride);
+    }
+
+    // 尾部至少32字节，解码器靠它省去组内的边界检查
+    if (stride < kTailMinSize) {
+        out.resize(out.size() + kTailMinSize - stride, 0);
+    }
+    out.insert(out.end(), first, first + stride);
+    return out;
+}
+
+std::vector<uint8_t> MeshoptEncoder::encodeIndexBuffer(const uint32_t *indices, size_t count, size_t vertexCount) {
+    std::vector<uint8_t> out;
+    if (count % 3 != 0) {
+        return out;
+    }
+    size_t triangleCount = count / 3;
+    out.reserve(1 + triangleCount * 3 + 16 + vertexCount / 8);
+    out.push_back(kIndexHeader);
+    // 每个三角形一个字节的码，码之后是变长数据，最后是码表
+    std::vector<uint8_t> codes;
+    codes.reserve(triangleCount);
+    std::vector<uint8_t> data;
+
+    uint32_t edgeFifo[16][2];
+    uint32_t vertexFifo[16];
+    memset(edgeFifo, 0xFF, sizeof(edgeFifo));
+    memset(vertexFifo, 0xFF, sizeof(vertexFifo));
+    size_t edgeOffset = 0;
+    size_t vertexOffset = 0;
+    auto pushEdge = [&](uint32_t a, uint32_t b) {
+        edgeFifo[edgeOffset][0] = a;
+        edgeFifo[edgeOffset][1] = b;
+        edgeOffset = (edgeOffset + 1) & 15;
+    };
+    auto pushVertex = [&](uint32_t v) {
+        vertexFifo[vertexOffset] = v;
+        vertexOffset = (vertexOffset + 1) & 15;
+    };
+
+    uint32_t next = 0;
+    uint32_t last = 0;
+    const int fecMax = 13;
+    for (size_t i = 0; i < count; i += 3) {
+        int edge = findEdge(edgeFifo, indices[i], indices[i + 1], indices[i + 2], edgeOffset);
+        if (edge >= 0 && (edge >> 2) < 15) {
+            // 旋转三角形让匹配的边成为ab
+            const int *order = kTriangleIndexOrder[edge & 3];
+            uint32_t a = indices[i + order[0]];
+            uint32_t b = indices[i + order[1]];
+            uint32_t c = indices[i + order[2]];
+            int fe = edge >> 2;
+            int fc = findVertex(vertexFifo, c, vertexOffset);
+            int fec;
+            if (fc >= 1 && fc < fecMax) {
+                fec = fc;
+            } else if (c == next) {
+                fec = 0;
+                next++;
+            } else if (c + 1 == last) {
+                fec = 13;
+                last = c;
+            } else if (c == last + 1) {
+                fec = 14;
+                last = c;
+            } else {
+                fec = 15;
+                encodeIndex(data, c, last);
+                last = c;
+            }
+            codes.push_back(uint8_t((fe << 4) | fec));
+            if (fec == 0 || fec >= fecMax) {
+                pushVertex(c);
+            }
+            pushEdge(c, b);
+            pushEdge(a, c);
+        } else {
+            // 旋转到让next出现在第一个位置，解码器假定b、c是next时a也是
+            int rotation = indices[i + 1] == next ? 1 : indices[i + 2] == next ? 2 : 0;
+            const int *order = kTriangleIndexOrder[rotation];
+            uint32_t a = indices[i + order[0]];
+            uint32_t b = indices[i + order[1]];
+            uint32_t c = indices[i + order[2]];
+
+            // 0 1 2在next不为0时编码成重新编号
+            bool reset = a == 0 && b == 1 && c == 2 && next > 0;
+            if (reset) {
+                next = 0;
+                memset(vertexFifo, 0xFF, sizeof(vertexFifo));
+            }
+            int fb = findVertex(vertexFifo, b, vertexOffset);
+            int fc = findVertex(vertexFifo, c, vertexOffset);
+            int fea = a == next ? (next++, 0) : 15;
+            int feb = fb >= 0 && fb < 14 ? fb + 1 : b == next ? (next++, 0) : 15;
+            int fec = fc >= 0 && fc < 14 ? fc + 1 : c == next ? (next++, 0) : 15;
+
+            auto codeAux = uint8_t((feb << 4) | fec);
+            int table = -1;
+            for (int t = 0; t < 16 && table < 0; t++) {
+                table = kCodeAuxTable[t] == codeAux ? t : -1;
+            }
+            if (fea == 0 && table >= 0 && table < 14 && !reset) {
+                codes.push_back(uint8_t(0xF0 | table));
+            } else {
+                codes.push_back(uint8_t(0xF0 | 14 | (fea == 15)));
+                data.push_back(codeAux);
+            }
+            if (fea == 15) {
+                encodeIndex(data, a, last);
+                last = a;
+            }
+            if (feb == 15) {
+                encodeIndex(data, b, last);
+                last = b;
+            }
+            if (fec == 15) {
+                encodeIndex(data, c, last);
+                last = c;
+            }
+            if (fea == 0 || fea == 15) pushVertex(a);
+            if (feb == 0 || feb == 15) pushVertex(b);
+            if (fec == 0 || fec == 15) pushVertex(c);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+    }
+    out.insert(out.end(), codes.begin(), codes.end());
+    out.insert(out.end(), data.begin(), data.end());
+    out.insert(out.end(), kCodeAuxTable, kCodeAuxTable + 16);
+    return out;
+}
+
+std::vector<uint8_t> MeshoptEncoder::encodeIndexSequence(const uint32_t *indices, size_t count, size_t vertexCount) {
+    std::vector<uint8_t> out;
+    out.reserve(1 + count + 4 + vertexCount / 8);
+    out.push_back(kSequenceHeader);
+    uint32_t last[2] = {0, 0};
+    uint32_t current = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t index = indices[i];
+        // 差值超出一个字节能表示的范围时换用另一个基准
+        auto delta = int32_t(index - last[current]);
+        current ^= uint32_t((delta < 0 ? -int64_t(delta) : int64_t(delta)) >= 30);
+        uint32_t d = index - last[current];
+        uint32_t value = (d << 1) ^ uint32_t(int32_t(d) >> 31);
+        encodeVByte(out, (value << 1) | current);
+        last[current] = index;
+    }
+    out.insert(out.end(), 4, 0);
+    return out;
+}
+
+void MeshoptEncoder::encodeOctahedral(void *destination, size_t count, size_t stride, int bits, const float *data) {
+    auto *out = static_cast<uint8_t *>(destination);
+    for (size_t i = 0; i < count; i++) {
+        const float *n = data + i * 4;
+        // 按L1范数归一化后投影到八面体，下半球折到外侧
+        float length = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+        float scale = length == 0.f ? 0.f : 1.f / length;
+        float x = n[0] * scale;
+        float y = n[1] * scale;
+        float u = n[2] >= 0.f ? x : (1.f - std::fabs(y)) * (x >= 0.f ? 1.f : -1.f);
+        float v = n[2] >= 0.f ? y : (1.f - std::fabs(x)) * (y >= 0.f ? 1.f : -1.f);
+        int values[4] = {quantizeSnorm(u, bits), quantizeSnorm(v, bits), quantizeSnorm(1.f, bits),
+                         quantizeSnorm(n[3], bits)};
+        if (stride == 4) {
+            int8_t packed[4];
+            std::transform(values, values + 4, packed, [](int value) { return int8_t(value); });
+            memcpy(out + i * 4, packed, sizeof(packed));
+        } else {
+            int16_t packed[4];
+            std::transform(values, values + 4, packed, [](int value) { return int16_t(value); });
+            memcpy(out + i * 8, packed, sizeof(packed));
+        }
+    }
+}
+
+void MeshoptEncoder::encodeQuaternion(void *destination, size_t count, int bits, const float *data) {
+    auto *out = static_cast<uint8_t *>(destination);
+    const float kScale = std::sqrt(2.f);
+    for (size_t i = 0; i < count; i++) {
+        const float *q = data + i * 4;
+        // 省略绝对值最大的分量，其余分量不超过1/sqrt(2)，放大后量化
+        int maxComponent = 0;
+        for (int c = 1; c < 4; c++) {
+            maxComponent = std::fabs(q[c]) > std::fabs(q[maxComponent]) ? c : maxComponent;
+        }
+        // q和-q表示同一个旋转，让最大分量为正
+        float sign = q[maxComponent] < 0.f ? -1.f : 1.f;
+        int16_t packed[4] = {
+                int16_t(quantizeSnorm(q[(maxComponent + 1) & 3] * kScale * sign, bits)),
+                int16_t(quantizeSnorm(q[(maxComponent + 2) & 3] * kScale * sign, bits)),
+                int16_t(quantizeSnorm(q[(maxComponent + 3) & 3] * kScale * sign, bits)),
+                int16_t((quantizeSnorm(1.f, bits) & ~3) | maxComponent)};
+        memcpy(out + i * 8, packed, sizeof(packed));
+    }
+}
+
+void MeshoptEncoder::encodeExponential(void *destination, size_t count, size_t stride, int bits, const float *data) {
+    auto *out = static_cast<uint8_t *>(destination);
+    size_t components = stride / 4;
+    for (size_t i = 0; i < count; i++) {
+        const float *v = data + i * components;
+        // 用最大的指数，尾数都在[-1, 1]内，再放大成bits位整数
+        int exponent = -100;
+        for (size_t c = 0; c < components; c++) {
+            int e;
+            std::frexp(v[c], &e);
+            exponent = std::max(exponent, e);
+        }
+        exponent -= bits - 1;
+        for (size_t c = 0; c < components; c++) {
+            int mantissa = int(std::ldexp(v[c], -exponent) + (v[c] >= 0.f ? 0.5f : -0.5f));
+            uint32_t packed = (uint32_t(mantissa) & 0xFFFFFFu) | (uint32_t(exponent) << 24);
+            memcpy(out + (i * components + c) * 4, &packed, sizeof(packed));
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef ANDROIDGLINVESTIGATIONS_MESHOPTENCODER_H
+#define ANDROIDGLINVESTIGATIONS_MESHOPTENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MeshoptDecoder.h"
+
+/*!
+ * EXT_meshopt_compression的编码器，只在主机工具中使用，输出可以由 MeshoptDecoder 和
+ * meshoptimizer库解码。属性按第0版编码，三角形和索引序列按第1版编码
+ */
+class MeshoptEncoder {
+public:
+    /*!
+     * @param stride 元素大小，4的倍数且不超过256
+     */
+    static std::vector<uint8_t> encodeVertexBuffer(const void *vertices, size_t count, size_t stride);
+
+    /*!
+     * 编码三角形列表。编码前用 MeshOptimizer 优化过顶点缓存和取顶点顺序的网格压缩率最高
+     * @param vertexCount 用于估计输出大小
+     */
+    static std::vector<uint8_t> encodeIndexBuffer(const uint32_t *indices, size_t count, size_t vertexCount);
+
+    static std::vector<uint8_t> encodeIndexSequence(const uint32_t *indices, size_t count, size_t vertexCount);
+
+    /*!
+     * 八面体编码单位向量，data是count个4分量float（第4个分量原样量化）
+     * @param stride 4（int8）或8（int16）
+     * @param bits 每个分量的精度，不超过8或16
+     */
+    static void encodeOctahedral(void *destination, size_t count, size_t stride, int bits, const float *data);
+
+    //! 编码单位四元数（xyzw），输出4个int16，bits为4到16
+    static void encodeQuaternion(void *destination, size_t count, int bits, const float *data);
+
+    /*!
+     * 每个元素的stride / 4个分量共享指数，尾数保留bits位（不超过24）
+     */
+    static void encodeExponential(void *destination, size_t count, size_t stride, int bits, const float *data);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_MESHOPTENCODER_H
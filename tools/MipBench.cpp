@@ -0,0 +1,238 @@
+/*
+ * mipbench：检查 TextureBaker 的正确性并测量每个核心每秒处理的百万像素数。
+ *
+ * 检查项：SIMD与标量实现逐位一致；纯色图像每一级保持不变；黑白棋盘格在线性空间平均后为sRGB的188
+ * （直接平均编码值是128）；完全透明的像素不会把颜色渗到相邻像素；保持覆盖率时每一级的alpha测试覆盖率
+ * 与原图接近。基准测试以第0层的像素数计算吞吐量，每个线程独立生成一条mip链。
+ * 用法：mipbench [边长] [线程数]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "TextureBaker.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 固定种子的伪随机图像，alpha在0和255附近的比例较高，覆盖透明和半透明的情况
+std::vector<uint8_t> noiseImage(int32_t width, int32_t height, uint32_t seed) {
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    uint32_t state = seed;
+    for (size_t i = 0; i < rgba.size(); i++) {
+        state = state * 1664525u + 1013904223u;
+        uint8_t value = uint8_t(state >> 24);
+        if (i % 4 == 3) {
+            value = value < 64 ? 0 : value > 192 ? 255 : value;
+        }
+        rgba[i] = value;
+    }
+    return rgba;
+}
+
+// 圆形的镂空：圆内alpha从边缘的128过渡到中心的255，圆外为0
+std::vector<uint8_t> cutoutImage(int32_t size) {
+    std::vector<uint8_t> rgba(size_t(size) * size * 4);
+    float center = size * 0.5f;
+    for (int32_t y = 0; y < size; y++) {
+        for (int32_t x = 0; x < size; x++) {
+            float dx = (x + 0.5f - center) / center;
+            float dy = (y + 0.5f - center) / center;
+            // 细的条纹让高层级的alpha被平均下去，不保持覆盖率时镂空会逐级变薄
+            bool stripe = (x / 3) % 3 == 0;
+            float r = std::sqrt(dx * dx + dy * dy);
+            uint8_t *p = rgba.data() + (size_t(y) * size + x) * 4;
+            p[0] = 40;
+            p[1] = 160;
+            p[2] = 60;
+            p[3] = r < 0.9f && stripe ? uint8_t(255 - 127 * r / 0.9f) : 0;
+        }
+    }
+    return rgba;
+}
+
+bool checkSimdMatchesScalar() {
+    const int32_t sizes[][2] = {{37, 23}, {1, 9}, {64, 1}, {128, 96}, {3, 3}};
+    const float cutoffs[] = {0.f, 0.5f};
+    bool ok = true;
+    for (auto size: sizes) {
+        for (int filter = 0; filter < 2; filter++) {
+            for (int srgb = 0; srgb < 2; srgb++) {
+                for (int alpha = 0; alpha < 2; alpha++) {
+                    for (float cutoff: cutoffs) {
+                        MipBakeOptions options;
+                        options.filter = filter ? MipFilter::Kaiser : MipFilter::Box;
+                        options.srgb = srgb != 0;
+                        options.alphaMode = alpha ? AlphaMode::Premultiplied : AlphaMode::Straight;
+                        options.alphaCutoff = cutoff;
+                        auto image = noiseImage(size[0], size[1], uint32_t(size[0] * 31 + size[1]));
+                        MipChain simd = TextureBaker::buildMipChain(size[0], size[1], image, options);
+                        MipChain scalar = TextureBaker::buildMipChainScalar(size[0], size[1], image, options);
+                        if (simd.pixels != scalar.pixels) {
+                            printf("SIMD与标量结果不一致：%dx%d 滤波%d sRGB%d 预乘%d 阈值%.1f\n",
+                                   size[0], size[1], filter, srgb, alpha, cutoff);
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+bool checkSolidColor() {
+    const int32_t width = 45, height = 30;
+    const uint8_t color[4] = {200, 100, 30, 180};
+    bool ok = true;
+    for (int filter = 0; filter < 2; filter++) {
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        for (size_t i = 0; i < rgba.size(); i++) {
+            rgba[i] = color[i % 4];
+        }
+        MipBakeOptions options;
+        options.filter = filter ? MipFilter::Kaiser : MipFilter::Box;
+        MipChain chain = TextureBaker::buildMipChain(width, height, std::move(rgba), options);
+        for (size_t i = 0; i < chain.pixels.size(); i++) {
+            if (std::abs(int(chain.pixels[i]) - int(color[i % 4])) > 0) {
+                printf("纯色图像第 %zu 字节为 %d，应为 %d（滤波%d）\n", i, chain.pixels[i], color[i % 4], filter);
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+bool checkGamma() {
+    // 2x2黑白棋盘格：线性空间的平均是0.5，sRGB编码为187.5
+    std::vector<uint8_t> rgba = {0, 0, 0, 255, 255, 255, 255, 255,
+                                 255, 255, 255, 255, 0, 0, 0, 255};
+    MipBakeOptions options;
+    options.filter = MipFilter::Box;
+    MipChain chain = TextureBaker::buildMipChain(2, 2, rgba, options);
+    MipChain naive = MipChain::build(2, 2, rgba);
+    const uint8_t *correct = chain.levelData(1);
+    printf("棋盘格第1层：gamma校正 %d，直接平均编码值 %d\n", correct[0], naive.levelData(1)[0]);
+    return correct[0] == 188 && correct[1] == 188 && correct[2] == 188 && correct[3] == 255;
+}
+
+bool checkTransparentBleed() {
+    // 左列是完全透明的红色，右列是不透明的绿色：按预乘滤波，结果里不应有红色
+    std::vector<uint8_t> rgba = {255, 0, 0, 0, 0, 255, 0, 255,
+                                 255, 0, 0, 0, 0, 255, 0, 255};
+    bool ok = true;
+    for (int filter = 0; filter < 2; filter++) {
+        MipBakeOptions options;
+        options.filter = filter ? MipFilter::Kaiser : MipFilter::Box;
+        MipChain chain = TextureBaker::buildMipChain(2, 2, rgba, options);
+        const uint8_t *p = chain.levelData(1);
+        if (p[0] != 0 || p[1] != 255 || p[2] != 0) {
+            printf("透明像素的颜色渗入了结果：(%d, %d, %d, %d)，滤波%d\n", p[0], p[1], p[2], p[3], filter);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool checkCoverage() {
+    const int32_t size = 256;
+    const float cutoff = 0.5f;
+    auto image = cutoutImage(size);
+    float target = TextureBaker::alphaCoverage(image.data(), size, size, cutoff);
+    MipBakeOptions plain;
+    MipBakeOptions preserved;
+    preserved.alphaCutoff = cutoff;
+    MipChain without = TextureBaker::buildMipChain(size, size, image, plain);
+    MipChain with = TextureBaker::buildMipChain(size, size, image, preserved);
+
+    bool ok = true;
+    printf("覆盖率（阈值 %.1f，原图 %.3f）：\n", cutoff, target);
+    for (size_t level = 1; level < with.levels.size(); level++) {
+        const auto &mip = with.levels[level];
+        float a = TextureBaker::alphaCoverage(without.levelData(level), mip.width, mip.height, cutoff);
+        float b = TextureBaker::alphaCoverage(with.levelData(level), mip.width, mip.height, cutoff);
+        printf("  %3dx%-3d  不保持 %.3f  保持 %.3f\n", mip.width, mip.height, a, b);
+        // 像素太少时覆盖率只能取离散值
+        if (mip.width >= 16 && std::abs(b - target) > 0.02f) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// 每个线程独立生成mip链，返回第0层的百万像素/秒/线程
+double measure(int32_t size, int threads, const std::function<MipChain(std::vector<uint8_t>)> &build) {
+    auto image = noiseImage(size, size, 7);
+    // 先运行一次，初始化查找表
+    build(image);
+    int repeats = std::max(1, int((8 << 20) / (int64_t(size) * size)));
+    std::vector<double> seconds(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            double start = nowSeconds();
+            for (int i = 0; i < repeats; i++) {
+                build(image);
+            }
+            seconds[t] = nowSeconds() - start;
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    double megapixels = double(size) * size * repeats / 1e6;
+    double total = 0.0;
+    for (double s: seconds) {
+        total += megapixels / s;
+    }
+    return total / threads;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int32_t size = argc > 1 ? std::max(16, atoi(argv[1])) : 2048;
+    int threads = argc > 2 ? std::max(1, atoi(argv[2])) : 1;
+
+    bool ok = true;
+    ok = checkSimdMatchesScalar() && ok;
+    ok = checkSolidColor() && ok;
+    ok = checkGamma() && ok;
+    ok = checkTransparentBleed() && ok;
+    ok = checkCoverage() && ok;
+
+    printf("%dx%d，%d 个线程，第0层的百万像素/秒/核：\n", size, size, threads);
+    double naive = measure(size, threads, [&](std::vector<uint8_t> image) {
+        return MipChain::build(size, size, std::move(image));
+    });
+    printf("  整数盒式（无gamma校正）      %8.1f\n", naive);
+    for (int filter = 0; filter < 2; filter++) {
+        for (int cutoff = 0; cutoff < 2; cutoff++) {
+            MipBakeOptions options;
+            options.filter = filter ? MipFilter::Kaiser : MipFilter::Box;
+            options.alphaCutoff = cutoff ? 0.5f : 0.f;
+            double scalar = measure(size, threads, [&](std::vector<uint8_t> image) {
+                return TextureBaker::buildMipChainScalar(size, size, std::move(image), options);
+            });
+            double simd = measure(size, threads, [&](std::vector<uint8_t> image) {
+                return TextureBaker::buildMipChain(size, size, std::move(image), options);
+            });
+            printf("  %-6s sRGB%s  标量 %8.1f  SIMD %8.1f  (%.2fx)\n", filter ? "Kaiser" : "Box",
+                   cutoff ? " 覆盖率" : "       ", scalar, simd, simd / scalar);
+        }
+    }
+
+    printf(ok ? "mip生成检查通过\n" : "mip生成检查失败\n");
+    return ok ? 0 : 1;
+}
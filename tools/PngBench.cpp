@@ -0,0 +1,548 @@
+/*
+ * pngbench：把内置的 PngDecoder 和 Inflate 与libpng、zlib逐字节对比，并测量解码吞吐量。
+ *
+ * 检查项：各种颜色类型、位深、tRNS、隔行和每种过滤方式的PNG由libpng编码后，内置解码器（SIMD和标量）
+ * 的输出与libpng按 expand + scale_16 + gray_to_rgb + 补alpha 解出的RGBA8完全相同；预乘和sRGB转换
+ * 与按公式逐像素计算的结果相同；zlib各压缩级别和策略的流都能正确解压；截断和损坏的输入返回false
+ * 且不越界（用ASan构建时检查）；临时缓冲从池中复用。
+ * 基准测试用带噪声的渐变图像，libpng默认的自适应过滤，比较内置解码器与libpng的百万像素/秒。
+ * 用法：pngbench [边长]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <png.h>
+#include <zlib.h>
+
+#include "Inflate.h"
+#include "PngDecoder.h"
+#include "StagingBufferPool.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t nextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+//! 编码用的图像描述，samples按PNG的行格式打包（16位为大端）
+struct TestImage {
+    int32_t width = 0;
+    int32_t height = 0;
+    int colorType = PNG_COLOR_TYPE_RGBA;
+    int bitDepth = 8;
+    bool interlaced = false;
+    int filters = PNG_ALL_FILTERS;
+    std::vector<png_color> palette;
+    std::vector<uint8_t> paletteAlpha;
+    bool hasKey = false;
+    png_color_16 key = {};
+    std::vector<uint8_t> rows;
+    size_t rowBytes = 0;
+};
+
+int channelsOf(int colorType) {
+    switch (colorType) {
+        case PNG_COLOR_TYPE_GRAY:
+        case PNG_COLOR_TYPE_PALETTE:
+            return 1;
+        case PNG_COLOR_TYPE_GRAY_ALPHA:
+            return 2;
+        case PNG_COLOR_TYPE_RGB:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+void putSample(TestImage &image, uint8_t *row, size_t index, uint32_t value) {
+    int depth = image.bitDepth;
+    if (depth == 16) {
+        row[index * 2] = uint8_t(value >> 8);
+        row[index * 2 + 1] = uint8_t(value);
+    } else if (depth == 8) {
+        row[index] = uint8_t(value);
+    } else {
+        size_t bit = index * depth;
+        int shift = 8 - depth - int(bit & 7);
+        row[bit >> 3] = uint8_t(row[bit >> 3] | (value << shift));
+    }
+}
+
+/*!
+ * 平滑渐变加噪声的图像，样本里混入与色键相同的值和0/最大值的alpha。
+ * 渐变让自适应过滤选到Sub、Up、Avg和Paeth，噪声让压缩不至于退化成全是回溯
+ */
+TestImage makeImage(int32_t width, int32_t height, int colorType, int bitDepth, uint32_t seed, int noise) {
+    TestImage image;
+    image.width = width;
+    image.height = height;
+    image.colorType = colorType;
+    image.bitDepth = bitDepth;
+    int channels = channelsOf(colorType);
+    image.rowBytes = (size_t(width) * channels * bitDepth + 7) / 8;
+    image.rows.assign(image.rowBytes * height, 0);
+    uint32_t maxValue = (1u << bitDepth) - 1;
+    uint32_t state = seed;
+    if (colorType == PNG_COLOR_TYPE_PALETTE) {
+        size_t entries = std::min<size_t>(size_t(1) << bitDepth, 200);
+        for (size_t i = 0; i < entries; i++) {
+            image.palette.push_back({uint8_t(nextRandom(state)), uint8_t(nextRandom(state)),
+                                     uint8_t(nextRandom(state))});
+        }
+    }
+    for (int32_t y = 0; y < height; y++) {
+        uint8_t *row = image.rows.data() + image.rowBytes * y;
+        for (int32_t x = 0; x < width; x++) {
+            for (int c = 0; c < channels; c++) {
+                double wave = 0.5 + 0.25 * std::sin(x * 0.05 + c) + 0.25 * std::cos(y * 0.037 + c * 2);
+                int32_t value = int32_t(wave * maxValue) + int32_t(nextRandom(state) % (2 * noise + 1)) - noise;
+                if (colorType == PNG_COLOR_TYPE_PALETTE) {
+                    value = int32_t(nextRandom(state) % image.palette.size());
+                }
+                if (c == channels - 1 && (colorType & PNG_COLOR_MASK_ALPHA) && nextRandom(state) % 8 == 0) {
+                    value = nextRandom(state) % 2 ? 0 : int32_t(maxValue);
+                }
+                putSample(image, row, size_t(x) * channels + c,
+                          uint32_t(std::min<int32_t>(std::max<int32_t>(value, 0), int32_t(maxValue))));
+            }
+        }
+    }
+    return image;
+}
+
+void writeCallback(png_structp png, png_bytep data, png_size_t size) {
+    auto *out = static_cast<std::vector<uint8_t> *>(png_get_io_ptr(png));
+    out->insert(out->end(), data, data + size);
+}
+
+void flushCallback(png_structp) {}
+
+std::vector<uint8_t> encodeWithLibpng(const TestImage &image, int level = 6) {
+    std::vector<uint8_t> out;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        return {};
+    }
+    png_set_write_fn(png, &out, writeCallback, flushCallback);
+    png_set_IHDR(png, info, uint32_t(image.width), uint32_t(image.height), image.bitDepth, image.colorType,
+                 image.interlaced ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+    if (!image.palette.empty()) {
+        png_set_PLTE(png, info, image.palette.data(), int(image.palette.size()));
+    }
+    if (!image.paletteAlpha.empty()) {
+        png_set_tRNS(png, info, image.paletteAlpha.data(), int(image.paletteAlpha.size()), nullptr);
+    } else if (image.hasKey) {
+        png_set_tRNS(png, info, nullptr, 0, &image.key);
+    }
+    png_set_filter(png, 0, image.filters);
+    png_set_compression_level(png, level);
+    png_write_info(png, info);
+    std::vector<png_bytep> rows(image.height);
+    for (int32_t y = 0; y < image.height; y++) {
+        rows[y] = const_cast<png_bytep>(image.rows.data() + image.rowBytes * y);
+    }
+    png_write_image(png, rows.data());
+    png_write_end(png, info);
+    png_destroy_write_struct(&png, &info);
+    return out;
+}
+
+struct ReadState {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+};
+
+void readCallback(png_structp png, png_bytep data, png_size_t size) {
+    auto *state = static_cast<ReadState *>(png_get_io_ptr(png));
+    if (size > state->size - state->offset) {
+        png_error(png, "读取越过末尾");
+    }
+    memcpy(data, state->data + state->offset, size);
+    state->offset += size;
+}
+
+void silentWarning(png_structp, png_const_charp) {}
+
+//! libpng解码成RGBA8，转换设置与 PngDecoder 的约定一致
+bool decodeWithLibpng(const std::vector<uint8_t> &file, std::vector<uint8_t> &rgba) {
+    ReadState state = {file.data(), file.size(), 0};
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, silentWarning);
+    png_infop info = png_create_info_struct(png);
+    std::vector<png_bytep> rows;
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+    png_set_read_fn(png, &state, readCallback);
+    png_read_info(png, info);
+    png_set_expand(png);
+    png_set_scale_16(png);
+    png_set_gray_to_rgb(png);
+    png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+    png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+    uint32_t width = png_get_image_width(png, info);
+    uint32_t height = png_get_image_height(png, info);
+    rgba.resize(size_t(width) * height * 4);
+    rows.resize(height);
+    for (uint32_t y = 0; y < height; y++) {
+        rows[y] = rgba.data() + size_t(y) * width * 4;
+    }
+    png_read_image(png, rows.data());
+    png_destroy_read_struct(&png, &info, nullptr);
+    return true;
+}
+
+bool decodeBuiltin(const std::vector<uint8_t> &file, std::vector<uint8_t> &rgba, StagingBufferPool &pool,
+                   bool scalar = false, const PngDecodeOptions &options = {}) {
+    PngInfo info;
+    if (!PngDecoder::readInfo(file.data(), file.size(), info)) {
+        return false;
+    }
+    size_t stride = size_t(info.width) * 4;
+    rgba.assign(stride * info.height, 0xCD);
+    auto decode = scalar ? PngDecoder::decodeScalar : PngDecoder::decode;
+    return decode(file.data(), file.size(), rgba.data(), stride, pool, options);
+}
+
+const char *colorTypeName(int colorType) {
+    switch (colorType) {
+        case PNG_COLOR_TYPE_GRAY:
+            return "灰度";
+        case PNG_COLOR_TYPE_PALETTE:
+            return "调色板";
+        case PNG_COLOR_TYPE_GRAY_ALPHA:
+            return "灰度+A";
+        case PNG_COLOR_TYPE_RGB:
+            return "RGB";
+        default:
+            return "RGBA";
+    }
+}
+
+bool checkAgainstLibpng(StagingBufferPool &pool) {
+    struct Format {
+        int colorType;
+        int bitDepth;
+    };
+    const Format formats[] = {{PNG_COLOR_TYPE_GRAY, 1}, {PNG_COLOR_TYPE_GRAY, 2}, {PNG_COLOR_TYPE_GRAY, 4},
+                              {PNG_COLOR_TYPE_GRAY, 8}, {PNG_COLOR_TYPE_GRAY, 16}, {PNG_COLOR_TYPE_RGB, 8},
+                              {PNG_COLOR_TYPE_RGB, 16}, {PNG_COLOR_TYPE_PALETTE, 1}, {PNG_COLOR_TYPE_PALETTE, 2},
+                              {PNG_COLOR_TYPE_PALETTE, 4}, {PNG_COLOR_TYPE_PALETTE, 8},
+                              {PNG_COLOR_TYPE_GRAY_ALPHA, 8}, {PNG_COLOR_TYPE_GRAY_ALPHA, 16},
+                              {PNG_COLOR_TYPE_RGBA, 8}, {PNG_COLOR_TYPE_RGBA, 16}};
+    const int filters[] = {PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH,
+                           PNG_ALL_FILTERS};
+    const int32_t sizes[][2] = {{1, 1}, {7, 5}, {37, 23}, {64, 3}};
+    bool ok = true;
+    int files = 0;
+    for (const Format &format: formats) {
+        for (int variant = 0; variant < 2; variant++) {
+            for (int interlaced = 0; interlaced < 2; interlaced++) {
+                for (int filter: filters) {
+                    for (auto size: sizes) {
+                        uint32_t seed = uint32_t(files * 7919 + 1);
+                        TestImage image = makeImage(size[0], size[1], format.colorType, format.bitDepth, seed,
+                                                    format.bitDepth >= 8 ? 3 : 0);
+                        image.interlaced = interlaced != 0;
+                        image.filters = filter;
+                        // 第二种变体加上tRNS：调色板的部分alpha，或者灰度/RGB的色键
+                        if (variant == 1) {
+                            if (format.colorType == PNG_COLOR_TYPE_PALETTE) {
+                                for (size_t i = 0; i < image.palette.size() / 2; i++) {
+                                    image.paletteAlpha.push_back(uint8_t(i * 37));
+                                }
+                            } else if (!(format.colorType & PNG_COLOR_MASK_ALPHA)) {
+                                // 用第一个像素的值作色键，保证图像中至少有一个透明像素
+                                image.hasKey = true;
+                                uint32_t maxValue = (1u << format.bitDepth) - 1;
+                                auto first = [&](int c) -> uint16_t {
+                                    if (format.bitDepth == 16) {
+                                        return uint16_t((image.rows[c * 2] << 8) | image.rows[c * 2 + 1]);
+                                    }
+                                    if (format.bitDepth == 8) {
+                                        return image.rows[c];
+                                    }
+                                    return uint16_t((image.rows[0] >> (8 - format.bitDepth)) & maxValue);
+                                };
+                                image.key.gray = first(0);
+                                image.key.red = first(0);
+                                if (format.colorType == PNG_COLOR_TYPE_RGB) {
+                                    image.key.green = first(1);
+                                    image.key.blue = first(2);
+                                }
+                            } else {
+                                continue;
+                            }
+                        }
+                        files++;
+                        std::vector<uint8_t> file = encodeWithLibpng(image);
+                        std::vector<uint8_t> expected, simd, scalar;
+                        bool decoded = decodeWithLibpng(file, expected) && decodeBuiltin(file, simd, pool)
+                                       && decodeBuiltin(file, scalar, pool, true);
+                        if (!decoded || simd != expected || scalar != expected) {
+                            size_t at = 0;
+                            while (at < expected.size() && at < simd.size() && simd[at] == expected[at]) {
+                                at++;
+                            }
+                            printf("  与libpng不一致: %s %d位 %dx%d 隔行%d 过滤%#x tRNS%d，第%zu字节\n",
+                                   colorTypeName(format.colorType), format.bitDepth, size[0], size[1], interlaced,
+                                   filter, variant, at);
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("与libpng对比：%d 个文件%s\n", files, ok ? "全部一致" : "有不一致");
+    return ok;
+}
+
+//! 预乘和sRGB转换与逐像素按公式计算的结果相同
+bool checkConversions(StagingBufferPool &pool) {
+    TestImage image = makeImage(61, 17, PNG_COLOR_TYPE_RGBA, 8, 99, 40);
+    std::vector<uint8_t> file = encodeWithLibpng(image);
+    std::vector<uint8_t> straight;
+    decodeBuiltin(file, straight, pool);
+    bool ok = true;
+    for (int mode = 1; mode < 4; mode++) {
+        PngDecodeOptions options;
+        options.premultiply = (mode & 1) != 0;
+        options.srgbToLinear = (mode & 2) != 0;
+        std::vector<uint8_t> simd, scalar;
+        ok = decodeBuiltin(file, simd, pool, false, options) && decodeBuiltin(file, scalar, pool, true, options)
+             && ok;
+        for (size_t i = 0; i < straight.size() && ok; i++) {
+            uint32_t value = straight[i];
+            uint32_t alpha = straight[i | 3];
+            if (i % 4 != 3) {
+                if (options.srgbToLinear) {
+                    double c = value / 255.0;
+                    value = uint32_t(std::lround(
+                            (c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4)) * 255.0));
+                }
+                if (options.premultiply) {
+                    value = uint32_t(std::lround(value * alpha / 255.0));
+                }
+            }
+            if (simd[i] != value || scalar[i] != value) {
+                printf("  转换结果错误: 预乘%d sRGB转换%d 第%zu字节 %u/%u，应为 %u\n", options.premultiply,
+                       options.srgbToLinear, i, simd[i], scalar[i], value);
+                ok = false;
+            }
+        }
+    }
+    printf("预乘和sRGB转换：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+//! zlib各级别和策略压缩的数据，包括存储块、固定Huffman、只有字面量和游程
+bool checkInflate() {
+    std::vector<uint8_t> source(300000);
+    uint32_t state = 5;
+    for (size_t i = 0; i < source.size(); i++) {
+        // 前半是低熵的文本式数据，后半带长距离重复
+        source[i] = i < source.size() / 2 ? uint8_t('a' + nextRandom(state) % 7)
+                                          : (i % 1000 < 600 ? source[i - 40000] : uint8_t(nextRandom(state)));
+    }
+    const int levels[] = {0, 1, 6, 9};
+    const int strategies[] = {Z_DEFAULT_STRATEGY, Z_FIXED, Z_HUFFMAN_ONLY, Z_RLE, Z_FILTERED};
+    bool ok = true;
+    std::vector<uint8_t> out(source.size());
+    for (size_t length: {size_t(0), size_t(1), size_t(258), size_t(70000), source.size()}) {
+        for (int level: levels) {
+            for (int strategy: strategies) {
+                z_stream stream = {};
+                deflateInit2(&stream, level, Z_DEFLATED, 15, 8, strategy);
+                std::vector<uint8_t> compressed(deflateBound(&stream, uLong(length)));
+                stream.next_in = const_cast<Bytef *>(source.data());
+                stream.avail_in = uInt(length);
+                stream.next_out = compressed.data();
+                stream.avail_out = uInt(compressed.size());
+                deflate(&stream, Z_FINISH);
+                compressed.resize(stream.total_out);
+                deflateEnd(&stream);
+
+                bool good = Inflate::zlib(compressed.data(), compressed.size(), out.data(), length)
+                            && memcmp(out.data(), source.data(), length) == 0;
+                // 期望的长度不符、截断和校验和错误都要失败
+                bool longer = !Inflate::zlib(compressed.data(), compressed.size(), out.data(), length + 1);
+                bool truncated = !Inflate::zlib(compressed.data(), compressed.size() - 1, out.data(), length);
+                compressed[compressed.size() - 1] ^= 1;
+                bool checksum = !Inflate::zlib(compressed.data(), compressed.size(), out.data(), length);
+                if (!good || !longer || !truncated || !checksum) {
+                    printf("  zlib流解压错误: 长度 %zu 级别 %d 策略 %d（%d%d%d%d）\n", length, level, strategy, good,
+                           longer, truncated, checksum);
+                    ok = false;
+                }
+            }
+        }
+    }
+    printf("zlib流解压：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+/*!
+ * 截断和随机损坏的PNG。损坏IDAT时重新计算CRC，让数据进入解压和反过滤；
+ * 结果可以成功也可以失败，要求的是不崩溃、不越界
+ */
+bool checkCorruption(StagingBufferPool &pool) {
+    TestImage image = makeImage(45, 31, PNG_COLOR_TYPE_RGB, 8, 3, 4);
+    image.interlaced = true;
+    std::vector<uint8_t> file = encodeWithLibpng(image);
+    std::vector<uint8_t> rgba;
+    bool ok = true;
+    for (size_t length = 0; length + 12 < file.size(); length += 7) {
+        std::vector<uint8_t> truncated(file.begin(), file.begin() + length);
+        if (decodeBuiltin(truncated, rgba, pool)) {
+            printf("  截断到 %zu 字节的PNG解码成功\n", length);
+            ok = false;
+        }
+    }
+    // 找到IDAT，翻转其中的随机位后重新计算CRC
+    size_t idat = 8;
+    while (memcmp(file.data() + idat + 4, "IDAT", 4) != 0) {
+        idat += 12 + ((size_t(file[idat]) << 24) | (file[idat + 1] << 16) | (file[idat + 2] << 8) | file[idat + 3]);
+    }
+    size_t idatLength = (size_t(file[idat]) << 24) | (file[idat + 1] << 16) | (file[idat + 2] << 8) | file[idat + 3];
+    uint32_t state = 11;
+    int decoded = 0;
+    const int trials = 3000;
+    for (int trial = 0; trial < trials; trial++) {
+        std::vector<uint8_t> damaged = file;
+        int flips = 1 + int(nextRandom(state) % 4);
+        for (int i = 0; i < flips; i++) {
+            damaged[idat + 8 + nextRandom(state) % idatLength] ^= uint8_t(1u << (nextRandom(state) % 8));
+        }
+        uLong crc = crc32(0, damaged.data() + idat + 4, uInt(idatLength + 4));
+        uint8_t *crcField = damaged.data() + idat + 8 + idatLength;
+        crcField[0] = uint8_t(crc >> 24);
+        crcField[1] = uint8_t(crc >> 16);
+        crcField[2] = uint8_t(crc >> 8);
+        crcField[3] = uint8_t(crc);
+        decoded += decodeBuiltin(damaged, rgba, pool) ? 1 : 0;
+    }
+    // 不重新计算CRC时，任何一位的损坏都由CRC发现
+    std::vector<uint8_t> damaged = file;
+    damaged[idat + 8 + idatLength / 2] ^= 0x10;
+    if (decodeBuiltin(damaged, rgba, pool)) {
+        printf("  CRC错误没有被发现\n");
+        ok = false;
+    }
+    printf("损坏的输入：截断全部失败，%d 次随机损坏中 %d 次仍能解码（Adler-32通过）\n", trials, decoded);
+    return ok;
+}
+
+bool checkPool(StagingBufferPool &pool) {
+    size_t before = pool.reuseCount();
+    TestImage image = makeImage(128, 64, PNG_COLOR_TYPE_RGBA, 8, 1, 3);
+    std::vector<uint8_t> file = encodeWithLibpng(image);
+    std::vector<uint8_t> rgba;
+    for (int i = 0; i < 10; i++) {
+        decodeBuiltin(file, rgba, pool);
+    }
+    // 每次解码借出过滤数据和行缓冲（多个IDAT时还有拼接缓冲），第一次之后全部来自池中
+    size_t reused = pool.reuseCount() - before;
+    bool ok = reused >= 18;
+    printf("缓冲池：10 次解码复用 %zu 次，池中 %zu 字节%s\n", reused, pool.pooledBytes(), ok ? "" : "（复用不足）");
+    return ok;
+}
+
+//! 多次解码取最快的一次，返回百万像素/秒
+double measure(int32_t width, int32_t height, const std::function<bool()> &decode) {
+    decode();
+    int repeats = std::max(3, int((32 << 20) / (int64_t(width) * height)));
+    double best = 1e30;
+    for (int i = 0; i < repeats; i++) {
+        double start = nowSeconds();
+        decode();
+        best = std::min(best, nowSeconds() - start);
+    }
+    return double(width) * height / 1e6 / best;
+}
+
+void benchmark(int32_t size, StagingBufferPool &pool) {
+    printf("%dx%d，百万像素/秒（zlib级别6，libpng自适应过滤）：\n", size, size);
+    const int colorTypes[] = {PNG_COLOR_TYPE_RGBA, PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_PALETTE};
+    for (int colorType: colorTypes) {
+        TestImage image = makeImage(size, size, colorType, 8, 17, 6);
+        std::vector<uint8_t> file = encodeWithLibpng(image);
+        std::vector<uint8_t> rgba(size_t(size) * size * 4);
+        std::vector<uint8_t> reference;
+        double libpng = measure(size, size, [&] { return decodeWithLibpng(file, reference); });
+        double scalar = measure(size, size, [&] {
+            return PngDecoder::decodeScalar(file.data(), file.size(), rgba.data(), size_t(size) * 4, pool);
+        });
+        double simd = measure(size, size, [&] {
+            return PngDecoder::decode(file.data(), file.size(), rgba.data(), size_t(size) * 4, pool);
+        });
+        PngDecodeOptions premultiplied;
+        premultiplied.premultiply = true;
+        double fused = measure(size, size, [&] {
+            return PngDecoder::decode(file.data(), file.size(), rgba.data(), size_t(size) * 4, pool, premultiplied);
+        });
+        printf("  %-6s %5.2f MB  libpng %7.1f  内置标量 %7.1f  内置SIMD %7.1f (%.2fx)  SIMD+预乘 %7.1f\n",
+               colorTypeName(colorType), file.size() / 1e6, libpng, scalar, simd, simd / libpng, fused);
+    }
+
+    // 单独比较解压：同一个zlib流
+    TestImage image = makeImage(size, size, PNG_COLOR_TYPE_RGBA, 8, 17, 6);
+    std::vector<uint8_t> raw(image.rows.size() + image.height);
+    for (int32_t y = 0; y < image.height; y++) {
+        raw[y * (image.rowBytes + 1)] = 4;
+        memcpy(raw.data() + y * (image.rowBytes + 1) + 1, image.rows.data() + y * image.rowBytes, image.rowBytes);
+    }
+    std::vector<uint8_t> compressed(compressBound(uLong(raw.size())));
+    uLongf compressedSize = compressed.size();
+    compress2(compressed.data(), &compressedSize, raw.data(), uLong(raw.size()), 6);
+    std::vector<uint8_t> out(raw.size());
+    double megabytes = raw.size() / 1e6;
+    double pixels = double(size) * size / 1e6;
+    double zlib = measure(size, size, [&] {
+        uLongf outSize = out.size();
+        return uncompress(out.data(), &outSize, compressed.data(), compressedSize) == Z_OK;
+    }) / pixels * megabytes;
+    double inflate = measure(size, size, [&] {
+        return Inflate::zlib(compressed.data(), compressedSize, out.data(), out.size());
+    }) / pixels * megabytes;
+    printf("  解压 %.1f MB 的过滤数据，MB/秒：zlib %7.1f  Inflate %7.1f (%.2fx)\n", megabytes, zlib, inflate,
+           inflate / zlib);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int32_t size = argc > 1 ? std::max(16, atoi(argv[1])) : 2048;
+    StagingBufferPool pool;
+
+    bool ok = true;
+    ok = checkInflate() && ok;
+    ok = checkAgainstLibpng(pool) && ok;
+    ok = checkConversions(pool) && ok;
+    ok = checkCorruption(pool) && ok;
+    ok = checkPool(pool) && ok;
+
+    benchmark(size, pool);
+
+    printf(ok ? "PNG解码检查通过\n" : "PNG解码检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,435 @@
+#include "RecordingGl.h"
+
+#include <GLES3/gl3.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// GLES 3.0 保证至少有16个顶点属性
+constexpr GLuint kMaxAttributes = 16;
+
+struct Buffer {
+    std::vector<uint8_t> data;
+    bool allocated = false; // 调用过 glBufferData
+};
+
+struct Attribute {
+    bool enabled = false;
+    GLint components = 4;
+    GLenum type = GL_FLOAT;
+    GLsizei stride = 0;
+    uintptr_t pointer = 0; // 绑定了缓冲时是缓冲内的偏移，否则是客户端数组的地址
+    GLuint buffer = 0;
+};
+
+//! VAO的状态，名字0是默认VAO
+struct VertexArray {
+    Attribute attributes[kMaxAttributes];
+    GLuint elementBuffer = 0;
+};
+
+struct State {
+    std::unordered_map<GLuint, Buffer> buffers;
+    std::unordered_map<GLuint, VertexArray> arrays{{0, VertexArray{}}};
+    GLuint nextBuffer = 1;
+    GLuint nextArray = 1;
+    GLuint arrayBuffer = 0;
+    GLuint boundArray = 0;
+
+    RecordingGl::FrameCounters frame;
+    size_t errors = 0;
+    uint64_t drawHash = 0;
+
+    VertexArray &currentArray() {
+        return arrays[boundArray];
+    }
+};
+
+State &state() {
+    static State instance;
+    return instance;
+}
+
+void fail(const char *function, const char *message) {
+    state().errors++;
+    printf("GL错误: %s: %s\n", function, message);
+}
+
+size_t typeSize(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+//! 一个顶点的属性占的字节数，打包格式的4个分量共用4字节
+size_t attributeSize(const Attribute &attribute) {
+    if (attribute.type == GL_INT_2_10_10_10_REV || attribute.type == GL_UNSIGNED_INT_2_10_10_10_REV) {
+        return 4;
+    }
+    return typeSize(attribute.type) * size_t(attribute.components);
+}
+
+//! 当前绑定在 target 上的缓冲，没有时返回空
+Buffer *boundBuffer(const char *function, GLenum target) {
+    State &s = state();
+    GLuint name = 0;
+    if (target == GL_ARRAY_BUFFER) {
+        name = s.arrayBuffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        name = s.currentArray().elementBuffer;
+    } else {
+        fail(function, "不支持的target");
+        return nullptr;
+    }
+    auto found = s.buffers.find(name);
+    if (name == 0 || found == s.buffers.end()) {
+        fail(function, "target上没有绑定缓冲");
+        return nullptr;
+    }
+    return &found->second;
+}
+
+void hashBytes(uint64_t &hash, const uint8_t *data, size_t size) {
+    // FNV-1a
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+}
+
+} // namespace
+
+void RecordingGl::reset() {
+    state() = State{};
+}
+
+void RecordingGl::beginFrame() {
+    state().frame = FrameCounters{};
+}
+
+const RecordingGl::FrameCounters &RecordingGl::frame() {
+    return state().frame;
+}
+
+size_t RecordingGl::errorCount() {
+    return state().errors;
+}
+
+uint64_t RecordingGl::lastDrawHash() {
+    return state().drawHash;
+}
+
+size_t RecordingGl::liveBuffers() {
+    return state().buffers.size();
+}
+
+size_t RecordingGl::liveVertexArrays() {
+    // 不算默认VAO
+    return state().arrays.size() - 1;
+}
+
+size_t RecordingGl::bufferBytes() {
+    size_t bytes = 0;
+    for (const auto &entry: state().buffers) {
+        bytes += entry.second.data.size();
+    }
+    return bytes;
+}
+
+// 以下是工具代替 libGLESv3 提供的GL函数，声明在 GLES3/gl3.h 中
+
+void GL_APIENTRY glGenBuffers(GLsizei n, GLuint *buffers) {
+    State &s = state();
+    s.frame.calls++;
+    for (GLsizei i = 0; i < n; i++) {
+        buffers[i] = s.nextBuffer++;
+        s.buffers[buffers[i]] = Buffer{};
+    }
+}
+
+void GL_APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers) {
+    State &s = state();
+    s.frame.calls++;
+    for (GLsizei i = 0; i < n; i++) {
+        GLuint name = buffers[i];
+        if (name == 0) {
+            continue;
+        }
+        if (s.buffers.erase(name) == 0) {
+            fail("glDeleteBuffers", "删除不存在的缓冲");
+            continue;
+        }
+        // 删除的缓冲从当前的绑定点解绑，其他VAO中的引用在绘制时报错
+        if (s.arrayBuffer == name) {
+            s.arrayBuffer = 0;
+        }
+        if (s.currentArray().elementBuffer == name) {
+            s.currentArray().elementBuffer = 0;
+        }
+    }
+}
+
+void GL_APIENTRY glBindBuffer(GLenum target, GLuint buffer) {
+    State &s = state();
+    s.frame.calls++;
+    if (buffer != 0 && s.buffers.find(buffer) == s.buffers.end()) {
+        fail("glBindBuffer", "绑定不存在的缓冲");
+        return;
+    }
+    if (target == GL_ARRAY_BUFFER) {
+        s.arrayBuffer = buffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        // 索引缓冲的绑定属于当前VAO
+        s.currentArray().elementBuffer = buffer;
+    } else {
+        fail("glBindBuffer", "不支持的target");
+    }
+}
+
+void GL_APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    State &s = state();
+    s.frame.calls++;
+    if (usage != GL_STATIC_DRAW && usage != GL_DYNAMIC_DRAW && usage != GL_STREAM_DRAW) {
+        fail("glBufferData", "不支持的usage");
+    }
+    Buffer *buffer = boundBuffer("glBufferData", target);
+    if (!buffer || size < 0) {
+        return;
+    }
+    if (buffer->allocated) {
+        s.frame.bufferOrphans++;
+    }
+    buffer->allocated = true;
+    buffer->data.assign(size_t(size), 0);
+    if (data) {
+        memcpy(buffer->data.data(), data, size_t(size));
+        s.frame.bufferUploads++;
+        s.frame.uploadBytes += size_t(size);
+    }
+}
+
+void GL_APIENTRY glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+    State &s = state();
+    s.frame.calls++;
+    Buffer *buffer = boundBuffer("glBufferSubData", target);
+    if (!buffer) {
+        return;
+    }
+    if (offset < 0 || size < 0 || size_t(offset + size) > buffer->data.size()) {
+        fail("glBufferSubData", "超出缓冲的范围");
+        return;
+    }
+    memcpy(buffer->data.data() + offset, data, size_t(size));
+    s.frame.bufferUploads++;
+    s.frame.uploadBytes += size_t(size);
+}
+
+void GL_APIENTRY glGenVertexArrays(GLsizei n, GLuint *arrays) {
+    State &s = state();
+    s.frame.calls++;
+    for (GLsizei i = 0; i < n; i++) {
+        arrays[i] = s.nextArray++;
+        s.arrays[arrays[i]] = VertexArray{};
+    }
+}
+
+void GL_APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint *arrays) {
+    State &s = state();
+    s.frame.calls++;
+    for (GLsizei i = 0; i < n; i++) {
+        GLuint name = arrays[i];
+        if (name == 0) {
+            continue;
+        }
+        if (s.arrays.erase(name) == 0) {
+            fail("glDeleteVertexArrays", "删除不存在的VAO");
+            continue;
+        }
+        if (s.boundArray == name) {
+            s.boundArray = 0;
+        }
+    }
+}
+
+void GL_APIENTRY glBindVertexArray(GLuint array) {
+    State &s = state();
+    s.frame.calls++;
+    s.frame.vertexArrayBinds++;
+    if (s.arrays.find(array) == s.arrays.end()) {
+        fail("glBindVertexArray", "绑定不存在的VAO");
+        return;
+    }
+    s.boundArray = array;
+}
+
+void GL_APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                                       GLsizei stride, const void *pointer) {
+    (void) normalized;
+    State &s = state();
+    s.frame.calls++;
+    s.frame.attributeCalls++;
+    if (index >= kMaxAttributes || size < 1 || size > 4 || stride < 0) {
+        fail("glVertexAttribPointer", "参数无效");
+        return;
+    }
+    // GLES 3.0：绑定了非默认VAO时不能使用客户端数组
+    if (s.boundArray != 0 && s.arrayBuffer == 0 && pointer != nullptr) {
+        fail("glVertexAttribPointer", "非默认VAO使用了客户端数组");
+        return;
+    }
+    Attribute &attribute = s.currentArray().attributes[index];
+    attribute.components = size;
+    attribute.type = type;
+    attribute.stride = stride;
+    attribute.pointer = reinterpret_cast<uintptr_t>(pointer);
+    attribute.buffer = s.arrayBuffer;
+    if (attributeSize(attribute) == 0) {
+        fail("glVertexAttribPointer", "不支持的type");
+    }
+}
+
+void GL_APIENTRY glEnableVertexAttribArray(GLuint index) {
+    State &s = state();
+    s.frame.calls++;
+    s.frame.attributeCalls++;
+    if (index >= kMaxAttributes) {
+        fail("glEnableVertexAttribArray", "位置无效");
+        return;
+    }
+    s.currentArray().attributes[index].enabled = true;
+}
+
+void GL_APIENTRY glDisableVertexAttribArray(GLuint index) {
+    State &s = state();
+    s.frame.calls++;
+    s.frame.attributeCalls++;
+    if (index >= kMaxAttributes) {
+        fail("glDisableVertexAttribArray", "位置无效");
+        return;
+    }
+    s.currentArray().attributes[index].enabled = false;
+}
+
+void GL_APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+    State &s = state();
+    s.frame.calls++;
+    s.frame.draws++;
+    s.drawHash = 0xcbf29ce484222325ull;
+    if (mode > GL_TRIANGLE_FAN || count < 0) {
+        fail("glDrawElements", "参数无效");
+        return;
+    }
+    size_t indexSize = type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT
+                       ? typeSize(type) : 0;
+    if (indexSize == 0) {
+        fail("glDrawElements", "不支持的索引类型");
+        return;
+    }
+    VertexArray &array = s.currentArray();
+    size_t indexBytes = size_t(count) * indexSize;
+
+    // 取索引：有索引缓冲时参数是缓冲内的偏移，否则是客户端数组
+    const uint8_t *indexData = nullptr;
+    if (array.elementBuffer != 0) {
+        auto found = s.buffers.find(array.elementBuffer);
+        uintptr_t offset = reinterpret_cast<uintptr_t>(indices);
+        if (found == s.buffers.end()) {
+            fail("glDrawElements", "索引缓冲已经删除");
+            return;
+        }
+        if (offset % indexSize || offset + indexBytes > found->second.data.size()) {
+            fail("glDrawElements", "索引超出索引缓冲的范围");
+            return;
+        }
+        indexData = found->second.data.data() + offset;
+    } else {
+        if (s.boundArray != 0 || indices == nullptr) {
+            fail("glDrawElements", "没有索引缓冲时必须使用默认VAO和客户端索引");
+            return;
+        }
+        indexData = static_cast<const uint8_t *>(indices);
+        s.frame.clientArrayBytes += indexBytes;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<uint32_t> values(static_cast<size_t>(count));
+    for (size_t i = 0; i < values.size(); i++) {
+        if (indexSize == 1) {
+            values[i] = indexData[i];
+        } else if (indexSize == 2) {
+            uint16_t value;
+            memcpy(&value, indexData + i * 2, 2);
+            values[i] = value;
+        } else {
+            memcpy(&values[i], indexData + i * 4, 4);
+        }
+    }
+    auto range = std::minmax_element(values.begin(), values.end());
+    size_t minIndex = *range.first;
+    size_t maxIndex = *range.second;
+
+    // 每个启用属性的数据来源，检查索引范围内的顶点都在缓冲之内
+    struct Source {
+        const uint8_t *base;
+        size_t stride;
+        size_t size;
+    };
+    std::vector<Source> sources;
+    uintptr_t clientLow = UINTPTR_MAX;
+    uintptr_t clientHigh = 0;
+    for (const Attribute &attribute: array.attributes) {
+        if (!attribute.enabled) {
+            continue;
+        }
+        size_t size = attributeSize(attribute);
+        size_t stride = attribute.stride ? size_t(attribute.stride) : size;
+        if (attribute.buffer != 0) {
+            auto found = s.buffers.find(attribute.buffer);
+            if (found == s.buffers.end()) {
+                fail("glDrawElements", "属性引用的顶点缓冲已经删除");
+                return;
+            }
+            if (attribute.pointer + maxIndex * stride + size > found->second.data.size()) {
+                fail("glDrawElements", "顶点超出顶点缓冲的范围");
+                return;
+            }
+            sources.push_back(Source{found->second.data.data() + attribute.pointer, stride, size});
+        } else {
+            if (attribute.pointer == 0) {
+                fail("glDrawElements", "启用的属性没有数据");
+                return;
+            }
+            // 驱动按索引范围拷贝客户端数组，交错的属性共用一段内存
+            clientLow = std::min(clientLow, attribute.pointer + minIndex * stride);
+            clientHigh = std::max(clientHigh, attribute.pointer + maxIndex * stride + size);
+            sources.push_back(Source{reinterpret_cast<const uint8_t *>(attribute.pointer), stride, size});
+        }
+    }
+    if (clientHigh > clientLow) {
+        s.frame.clientArrayBytes += clientHigh - clientLow;
+    }
+
+    for (uint32_t index: values) {
+        for (const Source &source: sources) {
+            hashBytes(s.drawHash, source.base + index * source.stride, source.size);
+        }
+    }
+}
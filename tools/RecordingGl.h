@@ -0,0 +1,54 @@
+#ifndef ANDROIDGLINVESTIGATIONS_RECORDINGGL_H
+#define ANDROIDGLINVESTIGATIONS_RECORDINGGL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * 主机上代替GLES驱动的记录实现，链接进工具后提供网格绘制用到的GL函数：
+ * 缓冲、VAO、顶点属性和 glDrawElements。
+ *
+ * 像驱动一样维护对象、绑定和VAO状态，缓冲内容真实保存。绘制时按当前状态读取每个索引和它引用的
+ * 每个启用属性，越界、用到已删除的对象或者缓冲和客户端数组混用不当都记为错误，
+ * 读到的字节序列累积成哈希，用来比较两种绑定方式是否取到了相同的顶点。
+ * 客户端数组按驱动的做法计数：每次绘制拷贝索引范围内的顶点（按步长连续拷贝）和全部索引。
+ * 不是线程安全的，与真正的GL上下文一样只在一个线程使用
+ */
+class RecordingGl {
+public:
+    //! 一帧内的计数，beginFrame 时清零
+    struct FrameCounters {
+        size_t calls = 0;            // 所有GL调用
+        size_t draws = 0;
+        size_t vertexArrayBinds = 0; // glBindVertexArray，包括绑定0
+        size_t attributeCalls = 0;   // glVertexAttribPointer 和启用、禁用属性
+        size_t bufferUploads = 0;    // 带数据的 glBufferData 和 glBufferSubData
+        size_t bufferOrphans = 0;    // 对已有存储的缓冲再次 glBufferData
+        size_t uploadBytes = 0;
+        size_t clientArrayBytes = 0; // 绘制时从客户端数组拷贝的顶点和索引字节数
+    };
+
+    //! 删除所有对象，恢复初始状态并清零计数
+    static void reset();
+
+    //! 开始新的一帧，清零帧计数
+    static void beginFrame();
+
+    static const FrameCounters &frame();
+
+    //! reset 以来的错误数，每个错误都会打印一行
+    static size_t errorCount();
+
+    //! 最近一次绘制读到的索引和属性字节的哈希
+    static uint64_t lastDrawHash();
+
+    //! 还没删除的缓冲和VAO个数
+    static size_t liveBuffers();
+
+    static size_t liveVertexArrays();
+
+    //! 所有缓冲当前存储的字节数
+    static size_t bufferBytes();
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_RECORDINGGL_H
@@ -0,0 +1,377 @@
+/*
+ * simplifierbench：测量 MeshSimplifier 简化后网格与原网格之间的实际距离，检查 SimplifyResult 报告的误差
+ * 确实是它的上界；并测量百万三角形网格的简化耗时。
+ *
+ * 实际距离取两个方向的最大值：原网格每个顶点到简化后表面的距离，以及简化后每个三角形上的采样点
+ * （顶点、边中点、重心和各角与重心的中点）到原表面的距离。最近三角形用均匀网格加速，找不到时退回逐个比较。
+ * 测试网格：闭合圆环、切开的圆环（有开放边界）、起伏的地形（开放的方形边界）和带凹凸的球，
+ * 球分别用逐位相同的极点和直接用float计算的极点（sin(π)不为0，两极是一圈边长约1e-7的开放边界），
+ * 每个网格简化到50%、25%和10%的三角形，分别只考虑几何和带uv权重；另外对每个网格生成5层的细节层次链，
+ * 检查每层相对原网格的实际距离。
+ * 检查项：所有情况下实际距离不超过报告误差（只留1e-6的舍入余量）；简化结果的索引都有效、没有退化三角形。
+ * 用法：simplifierbench [百万级网格的环向分段数]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LevelOfDetail.h"
+#include "MeshSimplifier.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Mesh {
+    std::string name;
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+};
+
+struct Point {
+    double x, y, z;
+};
+
+Point operator-(const Point &a, const Point &b) { return Point{a.x - b.x, a.y - b.y, a.z - b.z}; }
+
+Point operator+(const Point &a, const Point &b) { return Point{a.x + b.x, a.y + b.y, a.z + b.z}; }
+
+Point operator*(const Point &a, double s) { return Point{a.x * s, a.y * s, a.z * s}; }
+
+double dot(const Point &a, const Point &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+Point toPoint(const Vertex &vertex) {
+    return Point{vertex.position.x, vertex.position.y, vertex.position.z};
+}
+
+// 点到三角形的最近点（Ericson《Real-Time Collision Detection》5.1.5）
+Point closestOnTriangle(const Point &p, const Point &a, const Point &b, const Point &c) {
+    Point ab = b - a, ac = c - a, ap = p - a;
+    double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) {
+        return a;
+    }
+    Point bp = p - b;
+    double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) {
+        return b;
+    }
+    double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+    Point cp = p - c;
+    double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) {
+        return c;
+    }
+    double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+    double va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    double denominator = 1.0 / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+/*!
+ * 按三角形包围盒登记到均匀网格里，查询给定半径内的最近距离
+ */
+class TriangleGrid {
+public:
+    TriangleGrid(const std::vector<Vertex> &vertices, const std::vector<Index> &indices)
+            : vertices_(vertices), indices_(indices) {
+        double edgeSum = 0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            Point d = toPoint(vertices[indices[i + 1]]) - toPoint(vertices[indices[i]]);
+            edgeSum += std::sqrt(dot(d, d));
+        }
+        cellSize_ = std::max(1e-6, 2.0 * edgeSum / double(std::max<size_t>(1, indices.size() / 3)));
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            Point low = toPoint(vertices[indices[i]]);
+            Point high = low;
+            for (size_t corner = 1; corner < 3; corner++) {
+                Point p = toPoint(vertices[indices[i + corner]]);
+                low = Point{std::min(low.x, p.x), std::min(low.y, p.y), std::min(low.z, p.z)};
+                high = Point{std::max(high.x, p.x), std::max(high.y, p.y), std::max(high.z, p.z)};
+            }
+            forCells(low, high, [&](uint64_t key) { cells_[key].push_back(uint32_t(i / 3)); });
+        }
+    }
+
+    //! 到表面的距离。半径内没有三角形或最近距离超过半径时，逐个比较所有三角形
+    double distance(const Point &p, double radius) const {
+        double best = INFINITY;
+        forCells(p - Point{radius, radius, radius}, p + Point{radius, radius, radius}, [&](uint64_t key) {
+            auto it = cells_.find(key);
+            if (it != cells_.end()) {
+                for (uint32_t triangle: it->second) {
+                    best = std::min(best, triangleDistance(p, triangle));
+                }
+            }
+        });
+        if (best > radius) {
+            for (size_t t = 0; t < indices_.size() / 3; t++) {
+                best = std::min(best, triangleDistance(p, t));
+            }
+        }
+        return best;
+    }
+
+private:
+    double triangleDistance(const Point &p, size_t triangle) const {
+        const Index *tri = &indices_[triangle * 3];
+        Point closest = closestOnTriangle(p, toPoint(vertices_[tri[0]]), toPoint(vertices_[tri[1]]),
+                                          toPoint(vertices_[tri[2]]));
+        Point d = p - closest;
+        return std::sqrt(dot(d, d));
+    }
+
+    template<typename Function>
+    void forCells(const Point &low, const Point &high, Function function) const {
+        auto cell = [this](double value) { return int64_t(std::floor(value / cellSize_)); };
+        for (int64_t z = cell(low.z); z <= cell(high.z); z++) {
+            for (int64_t y = cell(low.y); y <= cell(high.y); y++) {
+                for (int64_t x = cell(low.x); x <= cell(high.x); x++) {
+                    function(uint64_t(x) * 0x9E3779B97F4A7C15ull ^ uint64_t(y) * 0xC2B2AE3D27D4EB4Full
+                             ^ uint64_t(z) * 0x165667B19E3779F9ull);
+                }
+            }
+        }
+    }
+
+    const std::vector<Vertex> &vertices_;
+    const std::vector<Index> &indices_;
+    double cellSize_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+};
+
+//! 两个方向上的最大距离。原网格和简化结果共用顶点
+double surfaceDistance(const std::vector<Vertex> &vertices, const std::vector<Index> &original,
+                       const std::vector<Index> &simplified, double searchRadius) {
+    double maxDistance = 0;
+    TriangleGrid simplifiedGrid(vertices, simplified);
+    std::vector<uint8_t> used(vertices.size(), 0);
+    for (Index index: original) {
+        if (!used[index]) {
+            used[index] = 1;
+            maxDistance = std::max(maxDistance, simplifiedGrid.distance(toPoint(vertices[index]), searchRadius));
+        }
+    }
+    TriangleGrid originalGrid(vertices, original);
+    for (size_t i = 0; i < simplified.size(); i += 3) {
+        Point a = toPoint(vertices[simplified[i]]);
+        Point b = toPoint(vertices[simplified[i + 1]]);
+        Point c = toPoint(vertices[simplified[i + 2]]);
+        Point center = (a + b + c) * (1.0 / 3.0);
+        const Point samples[] = {(a + b) * 0.5, (b + c) * 0.5, (c + a) * 0.5, center,
+                                 (a + center) * 0.5, (b + center) * 0.5, (c + center) * 0.5};
+        for (const Point &sample: samples) {
+            maxDistance = std::max(maxDistance, originalGrid.distance(sample, searchRadius));
+        }
+    }
+    return maxDistance;
+}
+
+bool validIndices(const std::vector<Index> &indices, size_t vertexCount) {
+    if (indices.size() % 3 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const Index *tri = &indices[i];
+        if (tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount
+            || tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! 圆环，uv在u = 1处有接缝
+Mesh makeTorus(uint32_t segments, uint32_t sides, bool open) {
+    Mesh mesh;
+    mesh.name = open ? "切开的圆环" : "圆环";
+    const float major = 1.f, minor = 0.35f;
+    for (uint32_t s = 0; s <= segments; s++) {
+        float u = 2.f * float(M_PI) * float(s) / float(segments);
+        for (uint32_t t = 0; t <= sides; t++) {
+            float v = 2.f * float(M_PI) * float(t) / float(sides);
+            float radius = major + minor * std::cos(v);
+            mesh.vertices.emplace_back(
+                    Vector3{{radius * std::cos(u), minor * std::sin(v), radius * std::sin(u)}},
+                    Vector2{{float(s) / float(segments), float(t) / float(sides)}});
+        }
+    }
+    // 切开的圆环少一圈四边形，两端是开放边界
+    uint32_t rings = open ? segments - segments / 8 : segments;
+    for (uint32_t s = 0; s < rings; s++) {
+        for (uint32_t t = 0; t < sides; t++) {
+            Index i = s * (sides + 1) + t;
+            Index next = i + sides + 1;
+            mesh.indices.insert(mesh.indices.end(), {i, i + 1, next, i + 1, next + 1, next});
+        }
+    }
+    return mesh;
+}
+
+Mesh makeTerrain(uint32_t size) {
+    Mesh mesh;
+    mesh.name = "地形";
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            float fx = float(x) / float(size), fy = float(y) / float(size);
+            float height = 0.08f * std::sin(6.f * fx) * std::cos(5.f * fy) + 0.02f * std::sin(23.f * fx + 17.f * fy);
+            mesh.vertices.emplace_back(Vector3{{fx, height, fy}}, Vector2{{fx, fy}});
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            Index i = y * (size + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2});
+        }
+    }
+    return mesh;
+}
+
+/*!
+ * @param exactPoles 为true时两极上重复的顶点位置逐位相同，否则直接用float计算
+ */
+Mesh makeBumpySphere(uint32_t rings, uint32_t segments, bool exactPoles) {
+    Mesh mesh;
+    mesh.name = exactPoles ? "凹凸球" : "float极点的凹凸球";
+    for (uint32_t r = 0; r <= rings; r++) {
+        float theta = float(M_PI) * float(r) / float(rings);
+        // 接缝和两极上重复的顶点位置必须逐位相同（导出工具也是这样做的），否则float的 sin(π) 不为0，
+        // 两极会变成一圈边长约1e-7的开放边界，而不是uv接缝
+        bool pole = exactPoles && (r == 0 || r == rings);
+        for (uint32_t s = 0; s <= segments; s++) {
+            float phi = 2.f * float(M_PI) * float(s % segments) / float(segments);
+            float radius = 1.f + 0.05f * std::sin(5.f * theta) * std::sin(4.f * phi);
+            Vector3 position = pole ? Vector3{{0.f, r == 0 ? 1.f : -1.f, 0.f}}
+                                    : Vector3{{radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+                                               radius * std::sin(theta) * std::sin(phi)}};
+            mesh.vertices.emplace_back(position, Vector2{{float(s) / float(segments), float(r) / float(rings)}});
+        }
+    }
+    // 两极各用一圈三角形，不生成退化三角形
+    for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            Index i = r * (segments + 1) + s;
+            Index below = i + segments + 1;
+            if (r != 0) {
+                mesh.indices.insert(mesh.indices.end(), {i, i + 1, below});
+            }
+            if (r != rings - 1) {
+                mesh.indices.insert(mesh.indices.end(), {i + 1, below + 1, below});
+            }
+        }
+    }
+    return mesh;
+}
+
+struct Worst {
+    double ratio = 0;
+    std::string where;
+
+    void update(double measured, double reported, const std::string &name) {
+        if (reported > 0 && measured / reported > ratio) {
+            ratio = measured / reported;
+            where = name;
+        }
+    }
+};
+
+bool checkMesh(const Mesh &mesh, Worst &worst) {
+    printf("%s：%zu个三角形\n", mesh.name.c_str(), mesh.indices.size() / 3);
+    bool ok = true;
+    for (float attributeWeight: {0.f, 0.5f}) {
+        for (int percent: {50, 25, 10}) {
+            SimplifyOptions options;
+            options.attributeWeight = attributeWeight;
+            // 由目标三角形数决定简化程度
+            options.targetError = 1.f;
+            size_t target = mesh.indices.size() / 3 * size_t(percent) / 100 * 3;
+            double start = nowSeconds();
+            SimplifyResult result = MeshSimplifier::simplify(mesh.vertices, mesh.indices, target, options);
+            double ms = (nowSeconds() - start) * 1e3;
+            if (!validIndices(result.indices, mesh.vertices.size())) {
+                printf("  简化结果的索引无效\n");
+                ok = false;
+                continue;
+            }
+            double measured = surfaceDistance(mesh.vertices, mesh.indices, result.indices,
+                                              3.0 * double(result.error) + 1e-6);
+            double ratio = result.error > 0.f ? measured / double(result.error) : 0.0;
+            bool caseOk = measured <= double(result.error) + 1e-6;
+            char name[128];
+            snprintf(name, sizeof(name), "%s %d%% uv权重%.1f", mesh.name.c_str(), percent, double(attributeWeight));
+            worst.update(measured, double(result.error), name);
+            printf("  目标%3d%%，uv权重%.1f：剩余%6zu个三角形，报告误差 %.5f，实际距离 %.5f（%.2fx），%.1f ms%s\n",
+                   percent, double(attributeWeight), result.indices.size() / 3, double(result.error), measured,
+                   ratio, ms, caseOk ? "" : "  超出报告误差");
+            ok = caseOk && ok;
+        }
+    }
+
+    std::vector<LodLevel> chain = LevelOfDetail::buildChain(mesh.vertices, mesh.indices, 5);
+    for (size_t level = 1; level < chain.size(); level++) {
+        const LodLevel &lod = chain[level];
+        double measured = surfaceDistance(mesh.vertices, mesh.indices, lod.indices, 3.0 * double(lod.error) + 1e-6);
+        bool levelOk = validIndices(lod.indices, mesh.vertices.size())
+                       && measured <= double(lod.error) + 1e-6;
+        worst.update(measured, double(lod.error), mesh.name + " 第" + std::to_string(level) + "层");
+        printf("  细节层次%zu：%6zu个三角形，误差 %.5f，实际距离 %.5f（%.2fx）%s\n", level, lod.indices.size() / 3,
+               double(lod.error), measured, lod.error > 0.f ? measured / double(lod.error) : 0.0,
+               levelOk ? "" : "  超出报告误差");
+        ok = levelOk && ok;
+    }
+    return ok;
+}
+
+void benchLarge(uint32_t segments) {
+    // 每段4个侧面分段对应8个三角形
+    Mesh mesh = makeTorus(segments, segments / 2, false);
+    printf("%zu个三角形的圆环：\n", mesh.indices.size() / 3);
+    SimplifyOptions options;
+    double start = nowSeconds();
+    SimplifyResult half = MeshSimplifier::simplify(mesh.vertices, mesh.indices, mesh.indices.size() / 2, options);
+    printf("  简化到50%%：%.0f ms，剩余%zu个三角形，误差 %.2e\n", (nowSeconds() - start) * 1e3,
+           half.indices.size() / 3, double(half.error));
+    start = nowSeconds();
+    std::vector<LodLevel> chain = LevelOfDetail::buildChain(mesh.vertices, mesh.indices, 5);
+    printf("  5层细节层次链：%.0f ms，", (nowSeconds() - start) * 1e3);
+    for (const LodLevel &level: chain) {
+        printf(" %zu", level.indices.size() / 3);
+    }
+    printf(" 个三角形\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t largeSegments = argc > 1 ? uint32_t(std::max(8, atoi(argv[1]))) : 1000;
+    bool ok = true;
+    Worst worst;
+    ok = checkMesh(makeTorus(160, 40, false), worst) && ok;
+    ok = checkMesh(makeTorus(160, 40, true), worst) && ok;
+    ok = checkMesh(makeTerrain(128), worst) && ok;
+    ok = checkMesh(makeBumpySphere(96, 192, true), worst) && ok;
+    ok = checkMesh(makeBumpySphere(96, 192, false), worst) && ok;
+    printf("实际距离与报告误差之比最大为 %.2f（%s）\n", worst.ratio, worst.where.c_str());
+
+    benchLarge(largeSegments);
+
+    printf(ok ? "网格简化检查通过\n" : "网格简化检查失败\n");
+    return ok ? 0 : 1;
+}
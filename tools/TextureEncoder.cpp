@@ -0,0 +1,508 @@
+#include "TextureEncoder.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 与 Etc2Decoder 中的表相同，像素索引0..3依次是 +a, +b, -a, -b
+const int kModifiers[8][2] = {
+        {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+const int kAlphaModifiers[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14},
+        {-3, -7, -10, -13, 2, 6, 9, 12},
+        {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12},
+        {-3, -6, -8, -12, 2, 5, 7, 11},
+        {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10},
+        {-3, -5, -8, -11, 2, 4, 7, 10},
+        {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},
+        {-2, -4, -8, -10, 1, 3, 7, 9},
+        {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},
+        {-1, -2, -3, -10, 0, 1, 2, 9},
+        {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+// ASTC的块模式：4x4权重网格、单平面。RGB块用3位权重，RGBA块用2位权重，端点都能放下8位
+constexpr int kAstcModeWeights3Bit = 0x53;
+constexpr int kAstcModeWeights2Bit = 0x42;
+constexpr int kAstcCemRgb = 8;
+constexpr int kAstcCemRgba = 12;
+// 按位复制反量化后的权重，0..64
+const int kAstcWeights3Bit[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+const int kAstcWeights2Bit[4] = {0, 21, 43, 64};
+
+inline int clamp255(int value) {
+    return std::min(255, std::max(0, value));
+}
+
+inline int square(int value) {
+    return value * value;
+}
+
+void writeBigEndian64(uint64_t value, uint8_t *out) {
+    for (int i = 7; i >= 0; i--) {
+        out[i] = uint8_t(value);
+        value >>= 8;
+    }
+}
+
+inline void setBits(uint8_t *block, int position, int count, uint32_t value) {
+    for (int i = 0; i < count; i++, position++) {
+        if ((value >> i) & 1) {
+            block[position >> 3] |= uint8_t(1 << (position & 7));
+        }
+    }
+}
+
+// ETC的一个2x4或4x2子块
+struct SubBlock {
+    int x[8];
+    int y[8];
+    int rgb[8][3];
+};
+
+void gatherSubBlocks(const uint8_t *rgba, size_t stride, bool flip, SubBlock sub[2]) {
+    int count[2] = {0, 0};
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            int s = flip ? (y >= 2) : (x >= 2);
+            int i = count[s]++;
+            sub[s].x[i] = x;
+            sub[s].y[i] = y;
+            const uint8_t *p = rgba + y * stride + x * 4;
+            for (int c = 0; c < 3; c++) {
+                sub[s].rgb[i][c] = p[c];
+            }
+        }
+    }
+}
+
+/*!
+ * 给定基色，穷举修正表并为每个像素选最近的修正值
+ * @param indices 输出每个像素的2位索引
+ * @return 平方误差
+ */
+int fitSubBlock(const SubBlock &sub, const int base[3], int &table, int indices[8]) {
+    int bestError = INT_MAX;
+    for (int t = 0; t < 8; t++) {
+        int error = 0;
+        int candidate[8];
+        for (int i = 0; i < 8 && error < bestError; i++) {
+            int bestPixel = INT_MAX;
+            for (int index = 0; index < 4; index++) {
+                int modifier = (index & 2) ? -kModifiers[t][index & 1] : kModifiers[t][index & 1];
+                int e = 0;
+                for (int c = 0; c < 3; c++) {
+                    e += square(clamp255(base[c] + modifier) - sub.rgb[i][c]);
+                }
+                if (e < bestPixel) {
+                    bestPixel = e;
+                    candidate[i] = index;
+                }
+            }
+            error += bestPixel;
+        }
+        if (error < bestError) {
+            bestError = error;
+            table = t;
+            std::copy(candidate, candidate + 8, indices);
+        }
+    }
+    return bestError;
+}
+
+void averageColor(const SubBlock &sub, float average[3]) {
+    for (int c = 0; c < 3; c++) {
+        int sum = 0;
+        for (int i = 0; i < 8; i++) {
+            sum += sub.rgb[i][c];
+        }
+        average[c] = sum / 8.f;
+    }
+}
+
+uint64_t packIndices(const SubBlock sub[2], const int indices[2][8]) {
+    uint64_t bits = 0;
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < 8; i++) {
+            int bit = sub[s].x[i] * 4 + sub[s].y[i];
+            bits |= uint64_t(indices[s][i] >> 1) << (bit + 16);
+            bits |= uint64_t(indices[s][i] & 1) << bit;
+        }
+    }
+    return bits;
+}
+
+/*!
+ * 用独立或差分模式编码，子块按flip划分
+ * @return 平方误差
+ */
+int encodeEtc1(const uint8_t *rgba, size_t stride, bool flip, bool differential, uint64_t &bits) {
+    SubBlock sub[2];
+    gatherSubBlocks(rgba, stride, flip, sub);
+    float average[2][3];
+    averageColor(sub[0], average[0]);
+    averageColor(sub[1], average[1]);
+
+    int quantized[2][3];
+    int base[2][3];
+    for (int c = 0; c < 3; c++) {
+        if (differential) {
+            quantized[0][c] = std::min(31, int(average[0][c] * 31.f / 255.f + 0.5f));
+            int second = std::min(31, int(average[1][c] * 31.f / 255.f + 0.5f));
+            // 差值只有3位，超出时第二个子块的颜色向第一个靠拢
+            quantized[1][c] = quantized[0][c] + std::min(3, std::max(-4, second - quantized[0][c]));
+            for (int s = 0; s < 2; s++) {
+                base[s][c] = (quantized[s][c] << 3) | (quantized[s][c] >> 2);
+            }
+        } else {
+            for (int s = 0; s < 2; s++) {
+                quantized[s][c] = std::min(15, int(average[s][c] * 15.f / 255.f + 0.5f));
+                base[s][c] = quantized[s][c] * 17;
+            }
+        }
+    }
+
+    int tables[2];
+    int indices[2][8];
+    int error = fitSubBlock(sub[0], base[0], tables[0], indices[0])
+                + fitSubBlock(sub[1], base[1], tables[1], indices[1]);
+
+    bits = packIndices(sub, indices);
+    for (int c = 0; c < 3; c++) {
+        int high = 63 - c * 8;
+        if (differential) {
+            bits |= uint64_t(quantized[0][c]) << (high - 4);
+            bits |= uint64_t((quantized[1][c] - quantized[0][c]) & 7) << (high - 7);
+        } else {
+            bits |= uint64_t(quantized[0][c]) << (high - 3);
+            bits |= uint64_t(quantized[1][c]) << (high - 7);
+        }
+    }
+    bits |= uint64_t(tables[0]) << 37 | uint64_t(tables[1]) << 34;
+    bits |= uint64_t(differential) << 33 | uint64_t(flip) << 32;
+    return error;
+}
+
+void encodeEtc2Rgb(const uint8_t *rgba, size_t stride, uint8_t *out) {
+    uint64_t best = 0;
+    int bestError = INT_MAX;
+    for (int flip = 0; flip < 2; flip++) {
+        for (int differential = 0; differential < 2; differential++) {
+            uint64_t bits;
+            int error = encodeEtc1(rgba, stride, flip, differential, bits);
+            if (error < bestError) {
+                bestError = error;
+                best = bits;
+            }
+        }
+    }
+    writeBigEndian64(best, out);
+}
+
+/*!
+ * @return 按给定参数编码alpha的平方误差，indices按列优先输出
+ */
+int fitAlpha(const int alpha[16], int base, int multiplier, int table, int indices[16]) {
+    int error = 0;
+    for (int i = 0; i < 16; i++) {
+        int bestPixel = INT_MAX;
+        for (int index = 0; index < 8; index++) {
+            int e = square(clamp255(base + kAlphaModifiers[table][index] * multiplier) - alpha[i]);
+            if (e < bestPixel) {
+                bestPixel = e;
+                indices[i] = index;
+            }
+        }
+        error += bestPixel;
+    }
+    return error;
+}
+
+void encodeEacAlpha(const uint8_t *rgba, size_t stride, uint8_t *out) {
+    int alpha[16]; // 按列优先，与块中的索引顺序一致
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            alpha[x * 4 + y] = rgba[y * stride + x * 4 + 3];
+        }
+    }
+    int low = *std::min_element(alpha, alpha + 16);
+    int high = *std::max_element(alpha, alpha + 16);
+
+    // 常量alpha：第13张表的第4项修正值为0
+    int bestBase = low, bestMultiplier = 1, bestTable = 13;
+    int bestIndices[16];
+    std::fill(bestIndices, bestIndices + 16, 4);
+    if (low != high) {
+        int bestError = INT_MAX;
+        for (int table = 0; table < 16; table++) {
+            int spread = kAlphaModifiers[table][7] - kAlphaModifiers[table][3];
+            int estimate = (high - low + spread / 2) / spread;
+            for (int multiplier = std::max(1, estimate - 1); multiplier <= std::min(15, estimate + 1); multiplier++) {
+                int center = (low + high) / 2
+                             - (kAlphaModifiers[table][3] + kAlphaModifiers[table][7]) * multiplier / 2;
+                int bases[2] = {clamp255(low - kAlphaModifiers[table][3] * multiplier), clamp255(center)};
+                for (int base: bases) {
+                    int indices[16];
+                    int error = fitAlpha(alpha, base, multiplier, table, indices);
+                    if (error < bestError) {
+                        bestError = error;
+                        bestBase = base;
+                        bestMultiplier = multiplier;
+                        bestTable = table;
+                        std::copy(indices, indices + 16, bestIndices);
+                    }
+                }
+            }
+        }
+    }
+
+    uint64_t bits = uint64_t(bestBase) << 56 | uint64_t(bestMultiplier) << 52 | uint64_t(bestTable) << 48;
+    for (int i = 0; i < 16; i++) {
+        bits |= uint64_t(bestIndices[i]) << (45 - i * 3);
+    }
+    writeBigEndian64(bits, out);
+}
+
+/*!
+ * 为每个像素选最近的ASTC权重
+ * @return 平方误差
+ */
+float fitAstcWeights(const float pixels[16][4], int channels, const int endpoints[2][4], const int *weights,
+                     int levels, int indices[16]) {
+    float error = 0.f;
+    for (int i = 0; i < 16; i++) {
+        float bestPixel = INFINITY;
+        for (int level = 0; level < levels; level++) {
+            float w = weights[level] / 64.f;
+            float e = 0.f;
+            for (int c = 0; c < channels; c++) {
+                float value = endpoints[0][c] + (endpoints[1][c] - endpoints[0][c]) * w - pixels[i][c];
+                e += value * value;
+            }
+            if (e < bestPixel) {
+                bestPixel = e;
+                indices[i] = level;
+            }
+        }
+        error += bestPixel;
+    }
+    return error;
+}
+
+void quantizeEndpoints(const float line[2][4], int channels, int endpoints[2][4]) {
+    for (int e = 0; e < 2; e++) {
+        for (int c = 0; c < 4; c++) {
+            endpoints[e][c] = c < channels ? clamp255(int(std::lround(line[e][c]))) : 255;
+        }
+    }
+}
+
+void encodeAstcVoidExtent(const uint8_t *color, uint8_t *out) {
+    // 块模式0x1FC，LDR，第10、11位为1，之后的坐标全为1表示整块都是这个颜色
+    memset(out, 0xFF, 8);
+    out[0] = 0xFC;
+    out[1] = 0xFD;
+    for (int c = 0; c < 4; c++) {
+        uint16_t value = uint16_t(color[c] * 257);
+        out[8 + c * 2] = uint8_t(value);
+        out[9 + c * 2] = uint8_t(value >> 8);
+    }
+}
+
+} // namespace
+
+void TextureEncoder::encodeEtc2Block(const uint8_t *rgba, size_t stride, bool hasAlpha, uint8_t *out) {
+    if (hasAlpha) {
+        encodeEacAlpha(rgba, stride, out);
+        out += 8;
+    }
+    encodeEtc2Rgb(rgba, stride, out);
+}
+
+void TextureEncoder::encodeAstc4x4Block(const uint8_t *rgba, size_t stride, uint8_t *out) {
+    float pixels[16][4];
+    bool constant = true;
+    bool alpha = false;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const uint8_t *p = rgba + y * stride + x * 4;
+            constant = constant && memcmp(p, rgba, 4) == 0;
+            alpha = alpha || p[3] != 255;
+            for (int c = 0; c < 4; c++) {
+                pixels[y * 4 + x][c] = p[c];
+            }
+        }
+    }
+    if (constant) {
+        encodeAstcVoidExtent(rgba, out);
+        return;
+    }
+    int channels = alpha ? 4 : 3;
+    const int *weights = alpha ? kAstcWeights2Bit : kAstcWeights3Bit;
+    int levels = alpha ? 4 : 8;
+
+    // 主轴：协方差矩阵的幂迭代，从包围盒的对角线开始
+    float mean[4] = {};
+    float low[4], high[4];
+    std::fill(low, low + 4, 255.f);
+    std::fill(high, high + 4, 0.f);
+    for (const auto &pixel: pixels) {
+        for (int c = 0; c < channels; c++) {
+            mean[c] += pixel[c] / 16.f;
+            low[c] = std::min(low[c], pixel[c]);
+            high[c] = std::max(high[c], pixel[c]);
+        }
+    }
+    float covariance[4][4] = {};
+    for (const auto &pixel: pixels) {
+        for (int i = 0; i < channels; i++) {
+            for (int j = 0; j < channels; j++) {
+                covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+            }
+        }
+    }
+    float axis[4] = {};
+    for (int c = 0; c < channels; c++) {
+        axis[c] = high[c] - low[c];
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        float length = 0.f;
+        for (int i = 0; i < channels; i++) {
+            for (int j = 0; j < channels; j++) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+            length += next[i] * next[i];
+        }
+        if (length <= 0.f) {
+            break;
+        }
+        length = std::sqrt(length);
+        for (int c = 0; c < channels; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+    float tMin = INFINITY, tMax = -INFINITY;
+    for (const auto &pixel: pixels) {
+        float t = 0.f;
+        for (int c = 0; c < channels; c++) {
+            t += (pixel[c] - mean[c]) * axis[c];
+        }
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+    float line[2][4];
+    for (int c = 0; c < channels; c++) {
+        line[0][c] = mean[c] + axis[c] * tMin;
+        line[1][c] = mean[c] + axis[c] * tMax;
+    }
+
+    int endpoints[2][4];
+    int indices[16];
+    quantizeEndpoints(line, channels, endpoints);
+    float error = fitAstcWeights(pixels, channels, endpoints, weights, levels, indices);
+
+    // 固定权重，按最小二乘重新求端点，误差变小时采用
+    for (int iteration = 0; iteration < 2; iteration++) {
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        float ap[4] = {}, bp[4] = {};
+        for (int i = 0; i < 16; i++) {
+            float w = weights[indices[i]] / 64.f;
+            aa += (1.f - w) * (1.f - w);
+            ab += (1.f - w) * w;
+            bb += w * w;
+            for (int c = 0; c < channels; c++) {
+                ap[c] += (1.f - w) * pixels[i][c];
+                bp[c] += w * pixels[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f) {
+            break;
+        }
+        float refined[2][4];
+        for (int c = 0; c < channels; c++) {
+            refined[0][c] = (ap[c] * bb - bp[c] * ab) / determinant;
+            refined[1][c] = (bp[c] * aa - ap[c] * ab) / determinant;
+        }
+        int candidate[2][4];
+        int candidateIndices[16];
+        quantizeEndpoints(refined, channels, candidate);
+        float candidateError = fitAstcWeights(pixels, channels, candidate, weights, levels, candidateIndices);
+        if (candidateError >= error) {
+            break;
+        }
+        error = candidateError;
+        memcpy(endpoints, candidate, sizeof(endpoints));
+        std::copy(candidateIndices, candidateIndices + 16, indices);
+    }
+
+    // 第二个端点的RGB和小于第一个时解码器会交换端点并做蓝色收缩，这里交换端点并反转权重避免它
+    if (endpoints[1][0] + endpoints[1][1] + endpoints[1][2] < endpoints[0][0] + endpoints[0][1] + endpoints[0][2]) {
+        for (int c = 0; c < 4; c++) {
+            std::swap(endpoints[0][c], endpoints[1][c]);
+        }
+        for (int &index: indices) {
+            index = levels - 1 - index;
+        }
+    }
+
+    memset(out, 0, 16);
+    int weightBits = alpha ? 2 : 3;
+    setBits(out, 0, 11, alpha ? kAstcModeWeights2Bit : kAstcModeWeights3Bit);
+    setBits(out, 11, 2, 0); // 单分区
+    setBits(out, 13, 4, alpha ? kAstcCemRgba : kAstcCemRgb);
+    // 端点按 r0 r1 g0 g1 b0 b1 [a0 a1] 的顺序存放，8位的范围不需要量化
+    for (int c = 0; c < channels; c++) {
+        setBits(out, 17 + c * 16, 8, uint32_t(endpoints[0][c]));
+        setBits(out, 25 + c * 16, 8, uint32_t(endpoints[1][c]));
+    }
+    // 权重从块的最高位开始逆序存放
+    for (int i = 0; i < 16; i++) {
+        for (int b = 0; b < weightBits; b++) {
+            if ((indices[i] >> b) & 1) {
+                int position = 127 - (i * weightBits + b);
+                out[position >> 3] |= uint8_t(1 << (position & 7));
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> TextureEncoder::encodeImage(const TextureFormat &format, int32_t width, int32_t height,
+                                                 const uint8_t *rgba) {
+    if (format.codec == TextureCodec::Rgba8) {
+        return std::vector<uint8_t>(rgba, rgba + size_t(width) * height * 4);
+    }
+    if (format.codec == TextureCodec::Astc && (format.blockWidth != 4 || format.blockHeight != 4)) {
+        return {};
+    }
+    std::vector<uint8_t> out(format.levelSize(width, height));
+    uint8_t *block = out.data();
+    uint8_t scratch[4 * 4 * 4];
+    for (int32_t by = 0; by < height; by += 4) {
+        for (int32_t bx = 0; bx < width; bx += 4, block += format.blockBytes) {
+            // 边缘的块重复最后一行和最后一列，解码时超出图像的像素被丢弃
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    int32_t sx = std::min(bx + x, width - 1);
+                    int32_t sy = std::min(by + y, height - 1);
+                    memcpy(scratch + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                }
+            }
+            if (format.codec == TextureCodec::Etc2) {
+                encodeEtc2Block(scratch, 16, format.hasAlpha, block);
+            } else {
+                encodeAstc4x4Block(scratch, 16, block);
+            }
+        }
+    }
+    return out;
+}
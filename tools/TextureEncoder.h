@@ -0,0 +1,40 @@
+#ifndef ANDROIDGLINVESTIGATIONS_TEXTUREENCODER_H
+#define ANDROIDGLINVESTIGATIONS_TEXTUREENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TextureFormat.h"
+
+/*!
+ * ETC2和ASTC的块编码器，只在主机工具中使用，输出由 Etc2Decoder、AstcDecoder 和GPU解码。
+ *
+ * 追求的是可以离线跑完整个资源目录的速度和合理的质量，不是最优压缩：
+ *  - ETC2只使用与ETC1兼容的独立/差分模式，每个子块穷举修正表；alpha按EAC穷举修正表和倍数
+ *  - ASTC只编码4x4块：单分区、单权重平面，端点用主轴拟合后按最小二乘修正一次；
+ *    不透明块用RGB端点和3位权重，带alpha的块用RGBA端点和2位权重，纯色块用void extent
+ */
+class TextureEncoder {
+public:
+    /*!
+     * 编码一个4x4块
+     * @param rgba 块左上角像素
+     * @param stride 输入的行距（字节）
+     * @param hasAlpha 为true时输出16字节（EAC alpha块在前），否则8字节
+     */
+    static void encodeEtc2Block(const uint8_t *rgba, size_t stride, bool hasAlpha, uint8_t *out);
+
+    //! 编码一个ASTC 4x4块，输出16字节
+    static void encodeAstc4x4Block(const uint8_t *rgba, size_t stride, uint8_t *out);
+
+    /*!
+     * 按format编码一个层级，不满一块的边缘用最近的边缘像素填充
+     * @param format RGBA8、ETC2或4x4块的ASTC
+     * @return 大小为 format.levelSize(width, height) 的数据；格式不支持时为空
+     */
+    static std::vector<uint8_t> encodeImage(const TextureFormat &format, int32_t width, int32_t height,
+                                            const uint8_t *rgba);
+};
+
+#endif //ANDROIDGLINVESTIGATIONS_TEXTUREENCODER_H
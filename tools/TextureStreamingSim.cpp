@@ -0,0 +1,284 @@
+/*
+ * texturestreamingsim：在没有GPU的主机上检查 TextureStreamer 的驻留策略。
+ *
+ * 桩后端记录每个句柄的存储、上传过的层级和基础层级，用来核对流送器的统计。模拟相机扫过一排纹理，
+ * 每帧检查：驻留字节数与后端一致、不超过预算、被淘汰的总是最久没用的纹理（可见纹理只会淘汰到需要的层级），
+ * 相机停下后可见纹理达到需要的层级。
+ * 存储只在加入时分配一次，每层最多上传一次，采样范围内的层级都已上传，
+ * CPU上只留着还没上传过的层级。
+ * 用法：texturestreamingsim [纹理数] [预算MB]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "TextureStreamer.h"
+
+namespace {
+
+constexpr int32_t kTextureSize = 1024;
+constexpr int kVisibleCount = 6; // 每帧可见的纹理数
+
+// 桩后端：记录每个句柄的存储、上传过的层级和基础层级
+class StubStreamBackend : public TextureStreamBackend {
+public:
+    uint32_t create(const std::vector<MipChain::Level> &levels) override {
+        uint32_t handle = nextHandle_++;
+        Texture &texture = live_[handle];
+        texture.levels = levels;
+        texture.uploaded.assign(levels.size(), false);
+        texture.baseLevel = 0;
+        for (const MipChain::Level &level: levels) {
+            storageBytes_ += level.size;
+        }
+        return handle;
+    }
+
+    void upload(uint32_t handle, size_t level, const MipChain::Level &mip, const uint8_t *pixels) override {
+        auto it = live_.find(handle);
+        if (it == live_.end() || level >= it->second.levels.size() || it->second.uploaded[level] || !pixels
+            || mip.size != it->second.levels[level].size) {
+            printf("句柄 %u 的第 %zu 层上传无效或重复上传\n", handle, level);
+            failed_ = true;
+            return;
+        }
+        it->second.uploaded[level] = true;
+        frameUploadBytes_ += mip.size;
+    }
+
+    void setBaseLevel(uint32_t handle, size_t level) override {
+        auto it = live_.find(handle);
+        if (it == live_.end() || level >= it->second.levels.size()) {
+            printf("句柄 %u 的基础层级 %zu 无效\n", handle, level);
+            failed_ = true;
+            return;
+        }
+        it->second.baseLevel = level;
+    }
+
+    void destroy(uint32_t handle) override {
+        auto it = live_.find(handle);
+        if (it == live_.end()) {
+            printf("重复释放句柄 %u\n", handle);
+            failed_ = true;
+            return;
+        }
+        for (const MipChain::Level &level: it->second.levels) {
+            storageBytes_ -= level.size;
+        }
+        live_.erase(it);
+    }
+
+    //! 所有句柄从基础层级到最后一层的字节数；采样范围内有没上传的层级时返回SIZE_MAX
+    size_t residentBytes() const {
+        size_t bytes = 0;
+        for (const auto &entry: live_) {
+            const Texture &texture = entry.second;
+            for (size_t level = texture.baseLevel; level < texture.levels.size(); level++) {
+                if (!texture.uploaded[level]) {
+                    return SIZE_MAX;
+                }
+                bytes += texture.levels[level].size;
+            }
+        }
+        return bytes;
+    }
+
+    inline size_t storageBytes() const { return storageBytes_; }
+
+    inline size_t liveCount() const { return live_.size(); }
+
+    inline size_t takeFrameUploadBytes() {
+        size_t bytes = frameUploadBytes_;
+        frameUploadBytes_ = 0;
+        return bytes;
+    }
+
+    inline bool failed() const { return failed_; }
+
+private:
+    struct Texture {
+        std::vector<MipChain::Level> levels;
+        std::vector<bool> uploaded;
+        size_t baseLevel;
+    };
+
+    std::map<uint32_t, Texture> live_;
+    uint32_t nextHandle_ = 1;
+    size_t storageBytes_ = 0;
+    size_t frameUploadBytes_ = 0;
+    bool failed_ = false;
+};
+
+bool check(bool condition, const char *what, int frame) {
+    if (!condition) {
+        printf("第 %d 帧：%s\n", frame, what);
+    }
+    return condition;
+}
+
+// 非2的幂尺寸的mip链：尺寸按下取整减半，每个像素是上一层对应2x2的平均
+bool checkMipChain() {
+    const int32_t width = 7, height = 3;
+    std::vector<uint8_t> rgba(width * height * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = uint8_t(i * 37);
+    }
+    MipChain chain = MipChain::build(width, height, rgba);
+    const int32_t expected[][2] = {{7, 3}, {3, 1}, {1, 1}};
+    if (chain.levels.size() != 3) {
+        return false;
+    }
+    for (size_t level = 0; level < 3; level++) {
+        if (chain.levels[level].width != expected[level][0] || chain.levels[level].height != expected[level][1]) {
+            return false;
+        }
+    }
+    // 第1层 (1, 0) 取第0层 (2..3, 0..1)
+    const uint8_t *top = chain.levelData(0);
+    for (int c = 0; c < 4; c++) {
+        int sum = top[(0 * width + 2) * 4 + c] + top[(0 * width + 3) * 4 + c]
+                  + top[(1 * width + 2) * 4 + c] + top[(1 * width + 3) * 4 + c];
+        if (chain.levelData(1)[4 + c] != uint8_t((sum + 2) / 4)) {
+            return false;
+        }
+    }
+    return chain.bytesFrom(0) == (21 + 3 + 1) * 4;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int textureCount = argc > 1 ? std::max(kVisibleCount, atoi(argv[1])) : 48;
+    size_t budget = (argc > 2 ? size_t(std::max(1, atoi(argv[2]))) : 24) << 20;
+
+    bool ok = checkMipChain();
+    if (!ok) {
+        printf("mip链尺寸或滤波错误\n");
+    }
+
+    // 策略只关心尺寸，每个纹理拷贝同一条mip链
+    std::vector<uint8_t> pixels(size_t(kTextureSize) * kTextureSize * 4, 128);
+    auto chain = std::make_shared<const MipChain>(MipChain::build(kTextureSize, kTextureSize, std::move(pixels)));
+    const size_t chainBytes = chain->bytesFrom(0);
+
+    StubStreamBackend backend;
+    TextureStreamerOptions options;
+    options.memoryBudget = budget;
+    options.uploadBytesPerFrame = 2u << 20;
+    auto streamer = std::make_unique<TextureStreamer>(backend, options);
+
+    std::vector<TextureStreamer::TextureId> ids;
+    for (int i = 0; i < textureCount; i++) {
+        ids.push_back(streamer->add(StreamedMipChain::split(*chain)));
+    }
+    size_t tailBytes = backend.residentBytes();
+    ok = check(tailBytes == streamer->stats().residentBytes, "加入后驻留字节数与后端不一致", 0) && ok;
+    ok = check(streamer->residentLevel(ids[0]) == 4, "加入时应只上传64x64及更小的mip尾", 0) && ok;
+    ok = check(backend.takeFrameUploadBytes() == tailBytes, "加入时上传了mip尾以外的层级", 0) && ok;
+    ok = check(backend.storageBytes() == chainBytes * textureCount
+               && streamer->stats().storageBytes == backend.storageBytes(), "加入时没有按整条mip链分配存储", 0) && ok;
+    ok = check(streamer->stats().cpuBytes == (chainBytes - chain->bytesFrom(4)) * textureCount,
+               "上传后的层级仍留在CPU上", 0) && ok;
+    size_t uploadedTotal = tailBytes;
+
+    // 相机每8帧右移一个纹理，可见纹理的屏幕尺寸从中间向两边递减
+    std::vector<uint64_t> lastUsed(textureCount, 0);
+    int frames = textureCount * 8 + 120;
+    size_t maxFrameUpload = 0;
+    size_t lastEvictions = 0;
+    int converged = 0;
+    for (int frame = 1; frame <= frames && ok; frame++) {
+        int first = std::min(frame / 8, textureCount - kVisibleCount);
+        std::vector<size_t> beforeLevels(textureCount);
+        for (int i = 0; i < textureCount; i++) {
+            beforeLevels[i] = streamer->residentLevel(ids[i]);
+        }
+        for (int v = 0; v < kVisibleCount; v++) {
+            float pixels = 1100.f / float(1 + std::abs(v - kVisibleCount / 2));
+            streamer->reportUsage(ids[first + v], pixels);
+            lastUsed[first + v] = frame;
+        }
+        streamer->update();
+        auto stats = streamer->stats();
+
+        size_t frameUpload = backend.takeFrameUploadBytes();
+        maxFrameUpload = std::max(maxFrameUpload, frameUpload);
+        uploadedTotal += frameUpload;
+        ok = check(stats.residentBytes == backend.residentBytes(), "驻留字节数与后端不一致或采样范围内有没上传的层级",
+                   frame) && ok;
+        // 每层只上传一次，上传过的字节数加上CPU上留着的字节数就是整条链
+        ok = check(stats.uploadedBytes == uploadedTotal
+                   && stats.uploadedBytes + stats.cpuBytes == chainBytes * textureCount,
+                   "上传的字节数与CPU上留着的层级对不上", frame) && ok;
+        ok = check(stats.residentBytes <= std::max(budget, tailBytes), "驻留字节数超出预算", frame) && ok;
+
+        // 可见纹理只能淘汰到需要的层级，不可见纹理按LRU淘汰：没有更久未用、仍可淘汰的纹理留着没动
+        if (stats.evictions != lastEvictions) {
+            uint64_t newestEvicted = 0;
+            uint64_t oldestKept = UINT64_MAX;
+            for (int i = 0; i < textureCount; i++) {
+                size_t level = streamer->residentLevel(ids[i]);
+                if (level > beforeLevels[i] && lastUsed[i] == uint64_t(frame)) {
+                    ok = check(level <= streamer->desiredLevel(ids[i]), "可见纹理被淘汰到需要的层级以下", frame) && ok;
+                } else if (level > beforeLevels[i]) {
+                    newestEvicted = std::max(newestEvicted, lastUsed[i]);
+                } else if (level < 4 && lastUsed[i] != uint64_t(frame)) {
+                    oldestKept = std::min(oldestKept, lastUsed[i]);
+                }
+            }
+            ok = check(newestEvicted <= oldestKept, "淘汰顺序不是LRU", frame) && ok;
+            lastEvictions = stats.evictions;
+        }
+
+        bool allDesired = true;
+        for (int v = 0; v < kVisibleCount; v++) {
+            TextureStreamer::TextureId id = ids[first + v];
+            allDesired = allDesired && streamer->residentLevel(id) <= streamer->desiredLevel(id);
+        }
+        converged += allDesired;
+    }
+
+    // 相机停下后，预算放得下时可见纹理必须全部达到需要的层级（驻留得更精细也可以）
+    int first = textureCount - kVisibleCount;
+    size_t needed = tailBytes;
+    for (int v = 0; v < kVisibleCount; v++) {
+        TextureStreamer::TextureId id = ids[first + v];
+        needed += chain->bytesFrom(streamer->desiredLevel(id)) - chain->bytesFrom(4);
+    }
+    for (int v = 0; ok && needed <= budget && v < kVisibleCount; v++) {
+        TextureStreamer::TextureId id = ids[first + v];
+        ok = check(streamer->residentLevel(id) <= streamer->desiredLevel(id), "可见纹理没有达到需要的层级", frames);
+    }
+
+    // 预算调小后下一帧淘汰到预算以内
+    streamer->setMemoryBudget(budget / 4);
+    streamer->update();
+    ok = check(streamer->stats().residentBytes <= std::max(budget / 4, tailBytes), "调小预算后没有淘汰", frames + 1)
+         && ok;
+
+    auto stats = streamer->stats();
+    printf("%d 个 %dx%d 纹理，预算 %zu MB，%d 帧\n", textureCount, kTextureSize, kTextureSize, budget >> 20, frames);
+    printf("驻留 %.2f MB（mip尾 %.2f MB），存储 %.1f MB，CPU上 %.1f MB，待上传 %zu，累计上传 %.1f MB，"
+           "提升 %zu 次，淘汰 %zu 次\n",
+           stats.residentBytes / 1048576.0, tailBytes / 1048576.0, stats.storageBytes / 1048576.0,
+           stats.cpuBytes / 1048576.0, stats.pendingUploads, stats.uploadedBytes / 1048576.0, stats.promotions,
+           stats.evictions);
+    printf("单帧上传最多 %.2f MB，可见纹理达到需要层级的帧占 %.0f%%\n", maxFrameUpload / 1048576.0,
+           100.0 * converged / frames);
+
+    for (auto id: ids) {
+        streamer->remove(id);
+    }
+    ok = check(backend.liveCount() == 0 && streamer->stats().residentBytes == 0 && streamer->stats().storageBytes == 0
+               && streamer->stats().cpuBytes == 0, "移除后仍有句柄、驻留字节或CPU上的层级", frames)
+         && ok && !backend.failed();
+    streamer.reset();
+    printf(ok ? "驻留策略检查通过\n" : "驻留策略检查失败\n");
+    return ok ? 0 : 1;
+}
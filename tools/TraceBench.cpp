@@ -0,0 +1,230 @@
+/*
+ * tracebench：Trace 的开销测试和导出检查。
+ *
+ * 开销：同一个循环体分别不加记录点、加上运行期关闭的 TRACE_ZONE、加上开启的 TRACE_ZONE，
+ * 比较每次迭代的耗时。关闭时每个记录点只有一次原子读和一个分支，额外耗时应接近0。
+ * 导出：多个线程持续记录区间、计数器（包括NaN和无穷大）和帧标记，缓冲区反复循环覆盖，
+ * 同时在主线程中反复导出和清空。每次导出都用 jsoncpp 解析。
+ * 检查项：导出的JSON有效；每个事件的名字、时间和持续时间/数值彼此吻合（没有读到一半被覆盖的事件）；
+ * 清空后的导出只包含之后记录的事件；关闭时每个记录点的额外耗时小于2ns。
+ * 用法：tracebench
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+
+#include "Log.h"
+#include "Trace.h"
+
+namespace {
+
+volatile uint64_t gSink = 0;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 每次迭代都写一次volatile变量，编译器不能合并或删掉循环
+__attribute__((noinline)) void emptyLoop(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        gSink = gSink + i;
+    }
+}
+
+__attribute__((noinline)) void zoneLoop(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        TRACE_ZONE("bench");
+        gSink = gSink + i;
+    }
+}
+
+template<typename Function>
+double bestNsPerIteration(uint64_t iterations, Function &&function) {
+    double best = 1e30;
+    for (int round = 0; round < 5; round++) {
+        double start = nowSeconds();
+        function(iterations);
+        best = std::min(best, (nowSeconds() - start) * 1e9 / double(iterations));
+    }
+    return best;
+}
+
+bool checkOverhead() {
+    const uint64_t iterations = 50000000;
+    Trace::setEnabled(false);
+    double empty = bestNsPerIteration(iterations, emptyLoop);
+    double disabled = bestNsPerIteration(iterations, zoneLoop);
+    Trace::setEnabled(true);
+    // 开启时缓冲区循环覆盖，迭代次数少一些
+    double enabled = bestNsPerIteration(iterations / 50, zoneLoop);
+    Trace::setEnabled(false);
+    Trace::clear();
+    bool ok = disabled - empty < 2.0;
+    printf("每次迭代：没有记录点 %.2f ns，关闭的TRACE_ZONE %.2f ns（+%.2f ns），开启的TRACE_ZONE %.2f ns\n",
+           empty, disabled, disabled - empty, enabled);
+    printf("关闭时的开销：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+const char *const kZoneNames[] = {"zone.a", "zone \"b\"", "zone\\c", "zone\nd"};
+const char *const kCounterNames[] = {"counter", "counter.inf", "counter.nan"};
+const char *const kWriterNames[] = {"writer 0", "writer \"1\"", "writer\\2", "writer\t3"};
+constexpr int kWriterCount = 4;
+
+/*
+ * 第k个区间的开始时间是 (k + 1) 微秒，持续时间是 k % 997 纳秒，名字是 kZoneNames[k % 4]；
+ * 第k个计数器的名字是 kCounterNames[k % 3]，数值依次是k、无穷大和NaN。
+ * 导出线程读到被撕裂的事件时这些关系不再成立
+ */
+void writeEvents(int writer, uint64_t count, std::atomic<bool> *stop) {
+    Trace::setThreadName(kWriterNames[writer]);
+    for (uint64_t k = 0; k < count && !(stop && stop->load(std::memory_order_relaxed)); k++) {
+        uint64_t start = (k + 1) * 1000;
+        Trace::recordZone(kZoneNames[k % 4], start, start + k % 997);
+        double value = k % 3 == 0 ? double(k)
+                                  : k % 3 == 1 ? std::numeric_limits<double>::infinity()
+                                               : std::numeric_limits<double>::quiet_NaN();
+        Trace::recordCounter(kCounterNames[k % 3], value);
+        if (k % 64 == 0) {
+            Trace::recordFrameMark();
+        }
+    }
+}
+
+bool parseJson(const std::string &path, Json::Value &root) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::string text;
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, read);
+    }
+    fclose(file);
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errors;
+    if (!reader->parse(text.data(), text.data() + text.size(), &root, &errors)) {
+        printf("  JSON无效：%s\n", errors.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool validEvent(const Json::Value &event) {
+    const std::string phase = event["ph"].asString();
+    const std::string name = event["name"].asString();
+    if (phase == "M") {
+        return name == "thread_name" && event["args"]["name"].isString();
+    }
+    if (!event["ts"].isNumeric() || !event["tid"].isNumeric()) {
+        return false;
+    }
+    if (phase == "X") {
+        auto k = uint64_t(std::llround(event["ts"].asDouble())) - 1;
+        return name == kZoneNames[k % 4] && std::llround(event["dur"].asDouble() * 1000.0) == int64_t(k % 997);
+    }
+    if (phase == "C") {
+        const Json::Value &value = event["args"][name];
+        if (value.isNull()) {
+            return name == kCounterNames[1] || name == kCounterNames[2];
+        }
+        return value.isNumeric() && name == kCounterNames[0] && uint64_t(value.asDouble()) % 3 == 0;
+    }
+    return phase == "i" && name == "Frame";
+}
+
+// 导出并检查所有事件，返回每个线程的事件数
+bool exportAndCheck(const std::string &path, std::map<uint32_t, size_t> &eventsPerThread) {
+    Json::Value root;
+    if (!Trace::exportJson(path) || !parseJson(path, root) || !root["traceEvents"].isArray()) {
+        return false;
+    }
+    eventsPerThread.clear();
+    for (const Json::Value &event: root["traceEvents"]) {
+        if (!validEvent(event)) {
+            printf("  无效的事件：%s\n", event.toStyledString().c_str());
+            return false;
+        }
+        if (event["ph"].asString() != "M") {
+            eventsPerThread[event["tid"].asUInt()]++;
+        }
+    }
+    return true;
+}
+
+bool checkConcurrentExport(const std::string &path) {
+    Trace::setEnabled(true);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < kWriterCount; writer++) {
+        writers.emplace_back(writeEvents, writer, std::numeric_limits<uint64_t>::max(), &stop);
+    }
+    bool ok = true;
+    size_t exports = 0;
+    std::map<uint32_t, size_t> eventsPerThread;
+    for (int round = 0; round < 20 && ok; round++) {
+        ok = exportAndCheck(path, eventsPerThread);
+        exports++;
+        if (round % 10 == 9) {
+            Trace::clear();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stop.store(true);
+    for (std::thread &writer: writers) {
+        writer.join();
+    }
+    printf("%d个线程记录时导出%zu次，JSON有效且没有被撕裂的事件：%s\n", kWriterCount, exports, ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkClear(const std::string &path) {
+    // 清空后只有新线程记录的事件：100个区间、100个计数器和2个帧标记
+    Trace::clear();
+    std::thread writer(writeEvents, 0, 100, nullptr);
+    writer.join();
+    std::map<uint32_t, size_t> eventsPerThread;
+    bool ok = exportAndCheck(path, eventsPerThread) && eventsPerThread.size() == 1
+              && eventsPerThread.begin()->second == 202;
+    Trace::setEnabled(false);
+    printf("清空后只导出之后记录的事件：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Warn);
+    char temporary[] = "/tmp/tracebench-XXXXXX";
+    if (!mkdtemp(temporary)) {
+        printf("无法创建临时目录\n");
+        return 1;
+    }
+    std::string path = std::string(temporary) + "/trace.json";
+
+    bool ok = checkOverhead();
+    ok = checkConcurrentExport(path) && ok;
+    ok = checkClear(path) && ok;
+
+    unlink(path.c_str());
+    rmdir(temporary);
+    printf(ok ? "Trace检查通过\n" : "Trace检查失败\n");
+    return ok ? 0 : 1;
+}
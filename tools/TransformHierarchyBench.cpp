@@ -0,0 +1,279 @@
+/*
+ * hierarchybench：检查 TransformHierarchy 展平后的世界矩阵与递归遍历的参考实现一致，并测量 update 的耗时。
+ *
+ * 场景是多棵树组成的森林：每棵树的根下先有一条骨骼式的长链，其余节点随机挂在树中更早创建的节点下，
+ * 创建顺序不是按层的，update 前要重排存储。参考实现按节点id保存子节点列表，从根递归计算世界矩阵，
+ * 乘法顺序与 update 相同，所以结果要求逐位一致。
+ * 检查项：首次 update 计算所有节点；没有修改时不重新计算；修改一部分节点后重新计算的节点数
+ * 等于被修改子树的并集大小，世界矩阵与参考实现逐位一致；getParent 与创建时的父节点一致。
+ * 基准测试输出全部节点、1%节点和没有节点被修改时一次 update 的耗时。
+ * 用法：hierarchybench [节点数] [轮数]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "TransformHierarchy.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    float range(float low, float high) {
+        return low + (high - low) * (float(next()) / float(1u << 24));
+    }
+};
+
+constexpr uint32_t kTreeSize = 1000;
+constexpr uint32_t kChainLength = 64;
+
+struct Local {
+    Vec3 translation;
+    Quat rotation;
+    Vec3 scale;
+};
+
+//! 递归遍历的参考实现，按节点id索引
+struct Reference {
+    std::vector<TransformHierarchy::NodeId> parent;
+    std::vector<std::vector<TransformHierarchy::NodeId>> children;
+    std::vector<Local> local;
+    std::vector<Mat4> world;
+
+    void computeSubtree(TransformHierarchy::NodeId node, const Mat4 *parentWorld) {
+        const Local &l = local[node];
+        Mat4 matrix = Mat4::fromTRS(l.translation, l.rotation, l.scale);
+        world[node] = parentWorld ? *parentWorld * matrix : matrix;
+        for (TransformHierarchy::NodeId child: children[node]) {
+            computeSubtree(child, &world[node]);
+        }
+    }
+
+    void computeAll() {
+        for (TransformHierarchy::NodeId node = 0; node < parent.size(); node++) {
+            if (parent[node] == TransformHierarchy::kInvalidNode) {
+                computeSubtree(node, nullptr);
+            }
+        }
+    }
+
+    //! 被修改节点的子树并集的大小
+    size_t affectedCount(const std::vector<uint8_t> &modified) const {
+        std::vector<uint8_t> affected(parent.size(), 0);
+        size_t count = 0;
+        // id总是大于父节点的id，按id顺序就能向下传播
+        for (TransformHierarchy::NodeId node = 0; node < parent.size(); node++) {
+            TransformHierarchy::NodeId p = parent[node];
+            affected[node] = modified[node] || (p != TransformHierarchy::kInvalidNode && affected[p]);
+            count += affected[node];
+        }
+        return count;
+    }
+};
+
+Local randomLocal(Random &random) {
+    Local l;
+    l.translation = Vec3{random.range(-2.f, 2.f), random.range(-2.f, 2.f), random.range(-2.f, 2.f), 0.f};
+    l.rotation = Quat::fromEulerDegrees(random.range(-30.f, 30.f), random.range(-30.f, 30.f),
+                                        random.range(-30.f, 30.f));
+    // 缩放接近1，长链上的矩阵不会溢出或变成0
+    l.scale = Vec3{random.range(0.95f, 1.05f), random.range(0.95f, 1.05f), random.range(0.95f, 1.05f), 0.f};
+    return l;
+}
+
+void build(uint32_t count, Random &random, TransformHierarchy &hierarchy, Reference &reference) {
+    hierarchy.reserve(count);
+    reference.parent.resize(count);
+    reference.children.resize(count);
+    reference.local.resize(count);
+    reference.world.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t inTree = i % kTreeSize;
+        TransformHierarchy::NodeId parent = TransformHierarchy::kInvalidNode;
+        if (inTree > 0 && inTree <= kChainLength) {
+            parent = i - 1;
+        } else if (inTree > kChainLength) {
+            parent = i - inTree + random.next() % inTree;
+        }
+        // id按创建顺序从0开始连续分配
+        hierarchy.createNode(parent);
+        reference.parent[i] = parent;
+        if (parent != TransformHierarchy::kInvalidNode) {
+            reference.children[parent].push_back(i);
+        }
+        Local l = randomLocal(random);
+        reference.local[i] = l;
+        hierarchy.setLocalTRS(i, l.translation, l.rotation, l.scale);
+    }
+}
+
+bool matchesReference(const TransformHierarchy &hierarchy, const Reference &reference) {
+    for (TransformHierarchy::NodeId node = 0; node < reference.world.size(); node++) {
+        if (memcmp(&hierarchy.getWorldMatrix(node), &reference.world[node], sizeof(Mat4)) != 0) {
+            printf("节点%u的世界矩阵与参考实现不一致\n", node);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool check(uint32_t count) {
+    Random random{42};
+    TransformHierarchy hierarchy;
+    Reference reference;
+    build(count, random, hierarchy, reference);
+    bool ok = true;
+
+    size_t recomputed = hierarchy.update();
+    reference.computeAll();
+    if (recomputed != count) {
+        printf("首次update计算了%zu个节点，应为%u\n", recomputed, count);
+        ok = false;
+    }
+    ok = matchesReference(hierarchy, reference) && ok;
+    for (TransformHierarchy::NodeId node = 0; node < count && ok; node++) {
+        if (hierarchy.getParent(node) != reference.parent[node]) {
+            printf("节点%u的父节点错误\n", node);
+            ok = false;
+        }
+    }
+    if (hierarchy.update() != 0) {
+        printf("没有修改时重新计算了节点\n");
+        ok = false;
+    }
+
+    // 三轮部分修改：叶子、链上的节点和根都会被选到
+    for (int round = 0; round < 3 && ok; round++) {
+        std::vector<uint8_t> modified(count, 0);
+        for (uint32_t i = 0; i < count / 100; i++) {
+            TransformHierarchy::NodeId node = random.next() % count;
+            modified[node] = 1;
+            Local l = randomLocal(random);
+            reference.local[node] = l;
+            switch (i % 3) {
+                case 0:
+                    hierarchy.setLocalTRS(node, l.translation, l.rotation, l.scale);
+                    break;
+                case 1:
+                    // 分开设置的结果与一次设置相同
+                    hierarchy.setLocalTranslation(node, l.translation);
+                    hierarchy.setLocalRotation(node, l.rotation);
+                    hierarchy.setLocalScale(node, l.scale);
+                    break;
+                default:
+                    hierarchy.setLocalTranslation(node, l.translation);
+                    hierarchy.setLocalTRS(node, l.translation, l.rotation, l.scale);
+                    break;
+            }
+        }
+        recomputed = hierarchy.update();
+        reference.computeAll();
+        size_t expected = reference.affectedCount(modified);
+        if (recomputed != expected) {
+            printf("第%d轮修改后重新计算了%zu个节点，应为%zu\n", round, recomputed, expected);
+            ok = false;
+        }
+        ok = matchesReference(hierarchy, reference) && ok;
+    }
+    printf("%u个节点的世界矩阵与递归参考一致：%s\n", count, ok ? "正确" : "错误");
+    return ok;
+}
+
+struct Timing {
+    double bestMs = 1e30;
+    double totalMs = 0;
+    size_t recomputed = 0;
+};
+
+void printTiming(const char *name, const Timing &timing, int rounds) {
+    printf("  %-20s 平均 %7.3f ms，最快 %7.3f ms，重新计算 %zu 个节点\n",
+           name, timing.totalMs / rounds, timing.bestMs, timing.recomputed);
+}
+
+void bench(uint32_t count, int rounds) {
+    Random random{7};
+    TransformHierarchy hierarchy;
+    Reference reference;
+    build(count, random, hierarchy, reference);
+    hierarchy.update();
+
+    std::vector<Local> animated(count);
+    for (Local &l: animated) {
+        l = randomLocal(random);
+    }
+    std::vector<TransformHierarchy::NodeId> some(count / 100);
+    for (TransformHierarchy::NodeId &node: some) {
+        node = random.next() % count;
+    }
+
+    Timing all, partial, unchanged, recursive;
+    for (int r = 0; r < rounds; r++) {
+        // 每个节点都被动画修改；设置局部变换不计入 update 的耗时
+        for (TransformHierarchy::NodeId node = 0; node < count; node++) {
+            const Local &l = animated[(node + uint32_t(r)) % count];
+            hierarchy.setLocalTRS(node, l.translation, l.rotation, l.scale);
+        }
+        double start = nowSeconds();
+        all.recomputed = hierarchy.update();
+        double ms = (nowSeconds() - start) * 1e3;
+        all.totalMs += ms;
+        all.bestMs = std::min(all.bestMs, ms);
+
+        for (TransformHierarchy::NodeId node: some) {
+            const Local &l = animated[(node + uint32_t(r) + 1) % count];
+            hierarchy.setLocalTRS(node, l.translation, l.rotation, l.scale);
+        }
+        start = nowSeconds();
+        partial.recomputed = hierarchy.update();
+        ms = (nowSeconds() - start) * 1e3;
+        partial.totalMs += ms;
+        partial.bestMs = std::min(partial.bestMs, ms);
+
+        start = nowSeconds();
+        unchanged.recomputed = hierarchy.update();
+        ms = (nowSeconds() - start) * 1e3;
+        unchanged.totalMs += ms;
+        unchanged.bestMs = std::min(unchanged.bestMs, ms);
+
+        start = nowSeconds();
+        reference.computeAll();
+        ms = (nowSeconds() - start) * 1e3;
+        recursive.totalMs += ms;
+        recursive.bestMs = std::min(recursive.bestMs, ms);
+        recursive.recomputed = count;
+    }
+    printf("%u个节点，%d轮：\n", count, rounds);
+    printTiming("全部修改", all, rounds);
+    printTiming("1%节点修改", partial, rounds);
+    printTiming("没有修改", unchanged, rounds);
+    printTiming("递归参考（全部）", recursive, rounds);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t count = argc > 1 ? uint32_t(std::max(int(kTreeSize), atoi(argv[1]))) : 100000;
+    int rounds = argc > 2 ? std::max(1, atoi(argv[2])) : 50;
+    printf("后端：%s\n", kVecMathBackend);
+
+    bool ok = true;
+    ok = check(count) && ok;
+    bench(count, rounds);
+
+    printf(ok ? "变换层级检查通过\n" : "变换层级检查失败\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+/*
+ * vertexformatcheck：随机顶点经过每一种 VertexLayout 量化再还原，检查误差不超过理论上界，
+ * 以及half和unorm16的取值能精确往返。
+ *
+ * 检查项：每种位置、uv、颜色格式的组合下，逐分量的位置误差不超过 positionErrorBound（按该轴的半边长），
+ * uv误差不超过 uvErrorBound，颜色原样保留，QuantizedVertices 记录的误差与实测一致；包围盒远离原点、
+ * 某一轴退化为平面的情况同样满足上界。所有非NaN的half取值经 halfToFloat/floatToHalf 往返后不变，
+ * NaN仍是NaN；随机float转换成half时选中的是最近的half，距离相同时选偶数。所有unorm16取值 k/65535
+ * 作为uv往返后存储值为k、还原值逐位不变。8/16位整数位置（KHR_mesh_quantization）走snorm16路径时
+ * 还原后四舍五入得到原来的整数。
+ * 用法：vertexformatcheck
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "VertexFormat.h"
+
+namespace {
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state;
+    }
+
+    // [0, 1)
+    float unit() {
+        return float(next() >> 8) / float(1u << 24);
+    }
+};
+
+struct Box {
+    const char *name;
+    Vector3 center;
+    Vector3 halfExtent;
+};
+
+const char *positionName(PositionFormat format) {
+    switch (format) {
+        case PositionFormat::Float32:
+            return "float";
+        case PositionFormat::Half:
+            return "half";
+        case PositionFormat::Snorm16:
+            return "snorm16";
+    }
+    return "?";
+}
+
+bool checkLayouts() {
+    const Box boxes[] = {
+            {"单位盒", {{0.f, 0.f, 0.f}}, {{1.f, 1.f, 1.f}}},
+            {"远离原点", {{1000.f, -250.f, 40.f}}, {{5.f, 0.25f, 80.f}}},
+            {"z轴退化", {{3.f, 2.f, 7.5f}}, {{2.f, 2.f, 0.f}}},
+    };
+    const PositionFormat positionFormats[] = {PositionFormat::Float32, PositionFormat::Half,
+                                              PositionFormat::Snorm16};
+    const UVFormat uvFormats[] = {UVFormat::Float32, UVFormat::Unorm16};
+    const ColorFormat colorFormats[] = {ColorFormat::None, ColorFormat::Rgba8};
+
+    Random random{2024};
+    bool ok = true;
+    for (const Box &box: boxes) {
+        std::vector<Vertex> vertices;
+        for (int i = 0; i < 20000; i++) {
+            Vector3 position;
+            for (int axis = 0; axis < 3; axis++) {
+                position.idx[axis] = box.center.idx[axis] + box.halfExtent.idx[axis] * (2.f * random.unit() - 1.f);
+            }
+            Vector2 uv = {{random.unit(), random.unit()}};
+            vertices.emplace_back(position, uv, random.next());
+        }
+        // 包围盒的角点，保证实际的半边长就是 box.halfExtent
+        for (int corner = 0; corner < 8; corner++) {
+            Vector3 position;
+            for (int axis = 0; axis < 3; axis++) {
+                float sign = (corner >> axis) & 1 ? 1.f : -1.f;
+                position.idx[axis] = box.center.idx[axis] + sign * box.halfExtent.idx[axis];
+            }
+            vertices.emplace_back(position, Vector2{{float(corner & 1), float(corner >> 1 & 1)}});
+        }
+
+        for (PositionFormat positionFormat: positionFormats) {
+            for (UVFormat uvFormat: uvFormats) {
+                for (ColorFormat colorFormat: colorFormats) {
+                    VertexLayout layout = VertexLayout::make(positionFormat, uvFormat, colorFormat);
+                    QuantizedVertices quantized = VertexFormat::quantize(vertices, layout);
+                    // 量化时的半边长由包围盒算出，与 box.halfExtent 可能有一点舍入差异
+                    float bound[3];
+                    for (int axis = 0; axis < 3; axis++) {
+                        float halfExtent = std::max(box.halfExtent.idx[axis], quantized.positionScale.idx[axis]);
+                        bound[axis] = VertexFormat::positionErrorBound(positionFormat, halfExtent);
+                    }
+                    float uvBound = VertexFormat::uvErrorBound(uvFormat);
+
+                    float positionError = 0.f;
+                    float uvError = 0.f;
+                    bool layoutOk = quantized.data.size() == vertices.size() * layout.stride;
+                    for (size_t i = 0; i < vertices.size() && layoutOk; i++) {
+                        Vertex restored = VertexFormat::dequantize(quantized, i);
+                        for (int axis = 0; axis < 3; axis++) {
+                            float error = std::fabs(restored.position.idx[axis] - vertices[i].position.idx[axis]);
+                            positionError = std::max(positionError, error);
+                            layoutOk = error <= bound[axis] && layoutOk;
+                        }
+                        for (int component = 0; component < 2; component++) {
+                            float error = std::fabs(restored.uv.idx[component] - vertices[i].uv.idx[component]);
+                            uvError = std::max(uvError, error);
+                            layoutOk = error <= uvBound && layoutOk;
+                        }
+                        uint32_t expectedColor = colorFormat == ColorFormat::Rgba8 ? vertices[i].color : 0xFFFFFFFFu;
+                        layoutOk = restored.color == expectedColor && layoutOk;
+                    }
+                    layoutOk = quantized.maxPositionError == positionError && quantized.maxUVError == uvError
+                               && layoutOk;
+                    if (!layoutOk) {
+                        printf("%s，位置%s、uv %s、%s颜色、步长%u：位置误差 %g（上界 %g/%g/%g），uv误差 %g（上界 %g）\n",
+                               box.name, positionName(positionFormat),
+                               uvFormat == UVFormat::Unorm16 ? "unorm16" : "float",
+                               colorFormat == ColorFormat::Rgba8 ? "有" : "无", layout.stride,
+                               double(positionError), double(bound[0]), double(bound[1]), double(bound[2]),
+                               double(uvError), double(uvBound));
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    printf("各布局的量化误差在上界内：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool isHalfNaN(uint16_t half) {
+    return (half & 0x7C00u) == 0x7C00u && (half & 0x3FFu) != 0;
+}
+
+bool checkHalf() {
+    bool ok = true;
+    for (uint32_t bits = 0; bits <= 0xFFFFu; bits++) {
+        auto half = uint16_t(bits);
+        uint16_t roundTrip = VertexFormat::floatToHalf(VertexFormat::halfToFloat(half));
+        bool same = isHalfNaN(half) ? isHalfNaN(roundTrip) && (roundTrip & 0x8000u) == (half & 0x8000u)
+                                    : roundTrip == half;
+        if (!same) {
+            printf("half 0x%04x 往返后为 0x%04x\n", half, roundTrip);
+            ok = false;
+            break;
+        }
+    }
+
+    // 随机float的舍入：相邻的half都不会更近，距离相同时结果是偶数。覆盖次正规数到溢出前的范围
+    Random random{77};
+    for (int i = 0; i < 1000000 && ok; i++) {
+        float value = std::ldexp(1.f + random.unit(), int(random.next() % 42) - 26);
+        if (random.next() & 1) {
+            value = -value;
+        }
+        if (std::fabs(value) >= 65504.f) {
+            continue;
+        }
+        uint16_t half = VertexFormat::floatToHalf(value);
+        double error = std::fabs(double(VertexFormat::halfToFloat(half)) - value);
+        for (int step: {-1, 1}) {
+            auto neighbor = uint16_t(half + step);
+            if ((neighbor & 0x8000u) != (half & 0x8000u) || (neighbor & 0x7C00u) == 0x7C00u) {
+                continue;
+            }
+            double neighborError = std::fabs(double(VertexFormat::halfToFloat(neighbor)) - value);
+            if (neighborError < error || (neighborError == error && (half & 1u))) {
+                printf("%.9g 转换成half 0x%04x，0x%04x 更近\n", double(value), half, neighbor);
+                ok = false;
+            }
+        }
+    }
+    printf("half往返和就近舍入到偶数：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+bool checkUnorm16() {
+    std::vector<Vertex> vertices;
+    for (uint32_t k = 0; k <= 0xFFFFu; k++) {
+        float u = float(k) / 65535.f;
+        vertices.emplace_back(Vector3{{0.f, 0.f, 0.f}}, Vector2{{u, 1.f - u}});
+    }
+    VertexLayout layout = VertexLayout::compact();
+    QuantizedVertices quantized = VertexFormat::quantize(vertices, layout);
+    bool ok = true;
+    for (uint32_t k = 0; k <= 0xFFFFu && ok; k++) {
+        uint16_t stored;
+        memcpy(&stored, quantized.data.data() + k * layout.stride + layout.uv.offset, sizeof(stored));
+        Vertex restored = VertexFormat::dequantize(quantized, k);
+        if (stored != k || memcmp(&restored.uv.u, &vertices[k].uv.u, sizeof(float)) != 0) {
+            printf("unorm16 %u 往返后存储为 %u，还原为 %.9g\n", k, stored, double(restored.uv.u));
+            ok = false;
+        }
+    }
+    printf("unorm16往返：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+template<typename T>
+bool checkIntegerPositions(GLenum type, bool normalized, int32_t low, int32_t high, const char *name) {
+    Random random{uint32_t(type) * 2 + normalized};
+    const size_t count = 5000;
+    std::vector<T> positions(count * 4);
+    for (size_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            positions[i * 4 + size_t(axis)] = T(low + int32_t(random.next() % uint32_t(high - low + 1)));
+        }
+    }
+    // 两端的值都出现
+    positions[0] = T(low);
+    positions[4] = T(high);
+
+    VertexStreams streams;
+    streams.count = count;
+    streams.position = reinterpret_cast<const uint8_t *>(positions.data());
+    streams.positionStride = 4 * sizeof(T);
+    streams.positionType = type;
+    streams.positionNormalized = normalized;
+    QuantizedVertices quantized = VertexFormat::quantize(streams, VertexLayout::compact());
+
+    float maximum = type == GL_BYTE ? 127.f : type == GL_UNSIGNED_BYTE ? 255.f : type == GL_SHORT ? 32767.f : 65535.f;
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        Vertex restored = VertexFormat::dequantize(quantized, i);
+        for (int axis = 0; axis < 3; axis++) {
+            float value = restored.position.idx[axis] * (normalized ? maximum : 1.f);
+            auto original = int32_t(positions[i * 4 + size_t(axis)]);
+            // 有符号归一化的最小值与它加1等价
+            if (normalized && original == -int32_t(maximum) - 1) {
+                original++;
+            }
+            if (std::lround(value) != original) {
+                printf("%s 第%zu个顶点：%d 还原为 %.9g\n", name, i, original, double(value));
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+bool checkIntegerStreams() {
+    bool ok = true;
+    ok = checkIntegerPositions<int8_t>(GL_BYTE, false, -128, 127, "byte") && ok;
+    ok = checkIntegerPositions<int8_t>(GL_BYTE, true, -128, 127, "normalized byte") && ok;
+    ok = checkIntegerPositions<uint8_t>(GL_UNSIGNED_BYTE, false, 0, 255, "ubyte") && ok;
+    ok = checkIntegerPositions<int16_t>(GL_SHORT, false, -32767, 32767, "short") && ok;
+    ok = checkIntegerPositions<int16_t>(GL_SHORT, true, -32768, 32766, "normalized short") && ok;
+    ok = checkIntegerPositions<uint16_t>(GL_UNSIGNED_SHORT, false, 100, 65534, "ushort") && ok;
+    ok = checkIntegerPositions<uint16_t>(GL_UNSIGNED_SHORT, true, 0, 65534, "normalized ushort") && ok;
+    printf("整数位置经snorm16往返：%s\n", ok ? "正确" : "错误");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    ok = checkLayouts() && ok;
+    ok = checkHalf() && ok;
+    ok = checkUnorm16() && ok;
+    ok = checkIntegerStreams() && ok;
+
+    printf(ok ? "顶点格式检查通过\n" : "顶点格式检查失败\n");
+    return ok ? 0 : 1;
+}